@@ -52,12 +52,18 @@
 #include <syslog.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -69,6 +75,7 @@
 #include "clixon_backend_plugin.h"
 #include "clixon_backend_commit.h"
 #include "backend_handle.h"
+#include "backend_startup.h"
 #include "backend_get.h"
 #include "backend_client.h"
 
@@ -88,6 +95,206 @@ ce_find_byid(struct client_entry *ce_list,
     return NULL;
 }
 
+/* Bound on bytes queued towards one client. A client that has stopped reading
+ * eventually hits it and is disconnected rather than wedging the backend
+ */
+#define CE_OUTQ_MAX (4*1024*1024)
+
+/* Queue threshold above which the notification overflow policy applies, see
+ * ce_event_cb. Below CE_OUTQ_MAX so that drop/coalesce leaves headroom for
+ * rpc replies before the hard disconnect bound is reached
+ */
+#define CE_NOTIFY_QMAX (CE_OUTQ_MAX/4)
+
+/*
+ * Per-RPC-type statistics, exposed by the stats RPC, see from_client_stats.
+ * Updated inline in from_client_msg at negligible cost: two gettimeofday
+ * calls and a handful of adds per dispatched RPC
+ */
+#define RPC_STATS_MAX     64 /* Distinct rpc names tracked, surplus is dropped */
+#define RPC_STATS_BUCKETS 20 /* Power-of-two microsecond latency buckets */
+#define RPC_STATS_NAMELEN 40
+
+struct rpc_stats{
+    char     rs_name[RPC_STATS_NAMELEN]; /* RPC name, eg get-config */
+    uint64_t rs_count;                   /* Number of calls dispatched */
+    uint64_t rs_in_bytes;                /* Sum of request message lengths */
+    uint64_t rs_out_bytes;               /* Sum of reply message lengths */
+    uint64_t rs_hist[RPC_STATS_BUCKETS]; /* Bucket i: latency in [2^i, 2^i+1) us */
+};
+static struct rpc_stats _rpc_stats[RPC_STATS_MAX] = {{{0,},},};
+static int              _rpc_stats_nr = 0;
+
+/*! Account one dispatched RPC in the per-RPC statistics
+ *
+ * @param[in]  name  RPC name
+ * @param[in]  usec  Latency from message receive to reply sent, in microseconds
+ * @param[in]  inb   Request message length in bytes
+ * @param[in]  outb  Reply message length in bytes
+ */
+static void
+rpc_stats_record(const char *name,
+                 uint64_t    usec,
+                 uint64_t    inb,
+                 uint64_t    outb)
+{
+    struct rpc_stats *rs = NULL;
+    int               i;
+    int               b = 0;
+
+    for (i = 0; i < _rpc_stats_nr; i++)
+        if (strcmp(_rpc_stats[i].rs_name, name) == 0){
+            rs = &_rpc_stats[i];
+            break;
+        }
+    if (rs == NULL){
+        if (_rpc_stats_nr >= RPC_STATS_MAX)
+            return;
+        rs = &_rpc_stats[_rpc_stats_nr++];
+        strncpy(rs->rs_name, name, RPC_STATS_NAMELEN-1);
+    }
+    rs->rs_count++;
+    rs->rs_in_bytes += inb;
+    rs->rs_out_bytes += outb;
+    while (usec >>= 1)
+        b++;
+    if (b >= RPC_STATS_BUCKETS)
+        b = RPC_STATS_BUCKETS-1;
+    rs->rs_hist[b]++;
+}
+
+static int client_send_drain(int s, void *arg);
+
+/*! Send an encoded message to a client without blocking the backend
+ *
+ * Writes what the socket accepts immediately; a remainder is queued on the
+ * client entry and drained as the socket becomes writable, so a slow or wedged
+ * client cannot stall rpc processing for other sessions. Messages are appended
+ * behind a non-empty queue which preserves their order. A client whose queue
+ * would exceed CE_OUTQ_MAX is disconnected.
+ * @param[in]  h     Clicon handle
+ * @param[in]  ce    Client entry
+ * @param[in]  data  Encoded message, ie struct clicon_msg header and body
+ * @param[in]  len   Length of data
+ * @retval     0     OK, sent, queued, or client removed on queue overflow
+ * @retval    -1     Error, eg EPIPE/ECONNRESET with errno set
+ * @see client_send_drain  which sends the queued remainder
+ */
+static int
+client_send(clicon_handle        h,
+            struct client_entry *ce,
+            void                *data,
+            size_t               len)
+{
+    char   *p = (char *)data;
+    ssize_t n;
+    size_t  qlen = 0;
+    int     ret;
+
+    if (ce->ce_outq)
+        qlen = cbuf_len(ce->ce_outq) - ce->ce_outq_off;
+    if (qlen == 0 &&
+        len - sizeof(struct clicon_msg) >= CLICON_MSG_FDPASS_MIN){
+        /* Pass a large body out-of-band, bypassing socket buffer and queue */
+        if ((ret = clicon_msg_fdpass_send(ce->ce_s, (struct clicon_msg *)data,
+                                          MSG_DONTWAIT)) < 0)
+            return -1;
+        if (ret == 1)
+            return 0; /* else inline: write or queue below */
+    }
+    if (qlen == 0){ /* Queue empty: try the socket directly */
+        while (len > 0){
+            if ((n = send(ce->ce_s, p, len, MSG_DONTWAIT)) < 0){
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                return -1;
+            }
+            p += n;
+            len -= n;
+        }
+        if (len == 0)
+            return 0;
+    }
+    if (qlen + len > CE_OUTQ_MAX){
+        clicon_log(LOG_WARNING, "client %d not reading, %zu bytes pending: closing",
+                   ce->ce_nr, qlen + len);
+        backend_client_rm(h, ce);
+        return 0;
+    }
+    if (ce->ce_outq == NULL &&
+        (ce->ce_outq = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        return -1;
+    }
+    if (cbuf_append_buf(ce->ce_outq, p, len) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    if (qlen == 0 && /* else already registered */
+        clixon_event_reg_fd_write(ce->ce_s, client_send_drain, ce,
+                                  "backend client outq") < 0)
+        return -1;
+    return 0;
+}
+
+/*! Write-readiness callback: drain queued output of a client
+ *
+ * @param[in]  s    Socket where the event occured
+ * @param[in]  arg  Client entry
+ * @retval     0    OK. A write error closes the client, it does not stop the backend
+ * @see client_send  which registers this callback
+ */
+static int
+client_send_drain(int   s,
+                  void *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    clicon_handle        h = ce->ce_handle;
+    char                *p;
+    size_t               len;
+    ssize_t              n;
+    struct clicon_msg   *pending;
+
+    p = cbuf_get(ce->ce_outq) + ce->ce_outq_off;
+    len = cbuf_len(ce->ce_outq) - ce->ce_outq_off;
+    while (len > 0){
+        if ((n = send(s, p, len, MSG_DONTWAIT)) < 0){
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            clicon_log(LOG_WARNING, "client %d write: %s", ce->ce_nr, strerror(errno));
+            backend_client_rm(h, ce);
+            return 0;
+        }
+        p += n;
+        len -= n;
+        ce->ce_outq_off += n;
+    }
+    if (len == 0){ /* Drained */
+        cbuf_reset(ce->ce_outq);
+        ce->ce_outq_off = 0;
+        clixon_event_unreg_fd_write(s, client_send_drain);
+        if ((pending = ce->ce_notify_pending) != NULL){
+            /* Coalesced event held back while the queue was full */
+            ce->ce_notify_pending = NULL;
+            client_send(h, ce, pending, ntohl(pending->op_len));
+            free(pending);
+        }
+    }
+    return 0;
+}
+
+/* Cache of the last encoded notification message.
+ * The shared encoding from stream_event_encoded() is identical for all
+ * subscribers of one event (session-id 0), so the message is encoded once per
+ * event and reused for each client, keyed by the fanout sequence number.
+ */
+static struct clicon_msg *_notify_msg = NULL;
+static uint64_t           _notify_seq = 0;
+
 /*! Stream callback for netconf stream notification (RFC 5277)
  * @param[in]  h     Clicon handle
  * @param[in]  op    0:event, 1:rm
@@ -102,7 +309,14 @@ ce_event_cb(clicon_handle h,
             void         *arg)
 {
     struct client_entry *ce = (struct client_entry *)arg;
-    
+    cbuf                *cb = NULL;
+    struct clicon_msg   *msg = NULL;
+    struct clicon_msg   *cp;
+    char                *str;
+    uint64_t             seq = 0;
+    uint32_t             mlen;
+    size_t               qlen = 0;
+
     clicon_debug(1, "%s op:%d", __FUNCTION__, op);
     switch (op){
     case 1:
@@ -111,13 +325,65 @@ ce_event_cb(clicon_handle h,
             backend_client_rm(h, ce);
         break;
     default:
-        if (send_msg_notify_xml(h, ce->ce_s, event) < 0){
+        if ((str = stream_event_encoded(event, &seq)) != NULL){
+            /* Event fanout: encode the message once, reuse for all clients */
+            if (_notify_msg == NULL || seq != _notify_seq){
+                if (_notify_msg){
+                    free(_notify_msg);
+                    _notify_msg = NULL;
+                }
+                if ((_notify_msg = clicon_msg_encode(0, "%s", str)) == NULL)
+                    break;
+                _notify_seq = seq;
+            }
+            msg = _notify_msg;
+        }
+        else {  /* Not in fanout, eg replay: encode privately */
+            if ((cb = cbuf_new()) == NULL){
+                clicon_err(OE_PLUGIN, errno, "cbuf_new");
+                break;
+            }
+            if (clixon_xml2cbuf(cb, event, 0, 0, -1, 0) < 0)
+                break;
+            if ((msg = clicon_msg_encode(0, "%s", cbuf_get(cb))) == NULL)
+                break;
+        }
+        /* Backpressure: if the queue is past the notification threshold,
+         * apply the subscription overflow policy instead of growing it
+         */
+        if (ce->ce_outq)
+            qlen = cbuf_len(ce->ce_outq) - ce->ce_outq_off;
+        if (qlen >= CE_NOTIFY_QMAX &&
+            ce->ce_notify_policy != NOTIFY_POLICY_DISCONNECT){
+            if (ce->ce_notify_policy == NOTIFY_POLICY_COALESCE){
+                mlen = ntohl(msg->op_len);
+                if ((cp = malloc(mlen)) == NULL){
+                    clicon_err(OE_UNIX, errno, "malloc");
+                    break;
+                }
+                memcpy(cp, msg, mlen);
+                if (ce->ce_notify_pending){
+                    free(ce->ce_notify_pending);
+                    ce->ce_notify_dropped++;
+                }
+                ce->ce_notify_pending = cp; /* sent when drained */
+            }
+            else
+                ce->ce_notify_dropped++;
+            break;
+        }
+        /* Queued if the client socket does not accept it, see client_send */
+        if (client_send(h, ce, msg, ntohl(msg->op_len)) < 0){
             if (errno == ECONNRESET || errno == EPIPE){
                 clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
             }
             break;
         }
     }
+    if (msg && msg != _notify_msg)
+        free(msg);
+    if (cb)
+        cbuf_free(cb);
     return 0;
 }
 
@@ -291,6 +557,7 @@ backend_client_rm(clicon_handle        h,
         if (c == ce){
             if (ce->ce_s){
                 clixon_event_unreg_fd(ce->ce_s, from_client);
+                clixon_event_unreg_fd_write(ce->ce_s, client_send_drain); /* may not be registered */
                 close(ce->ce_s);
                 ce->ce_s = 0;
                 if (release_all_dbs(h, ce->ce_id) < 0)
@@ -320,33 +587,32 @@ clixon_stats_datastore_get(clicon_handle h,
 {
     int       retval = -1;
     cxobj    *xt = NULL;
+    db_elmnt *de;
     uint64_t  nr = 0;
     size_t    sz = 0;
-    cxobj    *xn = NULL;
-    
-    /* This is the db cache */
 
-    if ((xt = xmldb_cache_get(h, dbname)) == NULL){
-        /* Trigger cache if no exist */
-        if (xmldb_get(h, dbname, NULL, "/", &xn) < 0)
-            goto done;
-        xt = xmldb_cache_get(h, dbname);
-    }
-    if (xt == NULL){
-        cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name><nr>0</nr><size>0</size></datastore>",
-                CLIXON_LIB_NS, dbname);
-    }
-    else{
-        if (xml_stats(xt, &nr, &sz) < 0)
-            goto done;
-        cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name><nr>%" PRIu64 "</nr>"
-                "<size>%zu</size></datastore>",
-                CLIXON_LIB_NS, dbname, nr, sz);
-    }
+    /* This is the db cache. Note an uncached db is reported as 0, it is NOT
+     * loaded just to be measured: the stats rpc is used to account for
+     * resident memory and must not itself grow it
+     */
+    cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name>", CLIXON_LIB_NS, dbname);
+    if ((xt = xmldb_cache_get(h, dbname)) != NULL &&
+        xml_stats(xt, &nr, &sz) < 0)
+        goto done;
+    cprintf(cb, "<nr>%" PRIu64 "</nr><size>%zu</size>", nr, sz);
+    if ((de = clicon_db_elmnt_get(h, dbname)) != NULL){
+        cprintf(cb, "<cached>%s</cached>", de->de_xml?"true":"false");
+        cprintf(cb, "<modified>%s</modified>", de->de_modified?"true":"false");
+        if (de->de_id)
+            cprintf(cb, "<locked-by>%u</locked-by>", de->de_id);
+        if (de->de_base) /* COW overlay: nr/size above is the shared base cache */
+            cprintf(cb, "<shared-with>%s</shared-with>", de->de_base);
+        if (de->de_pending)
+            cprintf(cb, "<write-pending>true</write-pending>");
+    }
+    cprintf(cb, "</datastore>");
     retval = 0;
  done:
-    if (xn)
-        xml_free(xn);
     return retval;
 }
 
@@ -533,6 +799,8 @@ from_client_edit_config(clicon_handle h,
     if (ret == 0)
         goto ok;
     xmldb_modified_set(h, target, 1); /* mark as dirty */
+    if (strcmp(target, "running") == 0)
+        nacm_decision_cache_invalidate(); /* access rules may have changed */
     /* Clixon extension: autocommit */
     if ((attr = xml_find_value(xn, "autocommit")) != NULL &&
         strcmp(attr,"true") == 0)
@@ -615,6 +883,165 @@ from_client_edit_config(clicon_handle h,
     
 } /* from_client_edit_config */
 
+/*! Apply a batch of edit-config payloads in one pass over the datastore
+ *
+ * Clixon-lib rpc: the edits are applied in order against the in-memory tree
+ * and the datastore is serialized once at the end, see xmldb_put_vec.
+ * On the first failing edit an rpc-error is returned and earlier edits
+ * remain, as if issued as separate edit-config RPCs.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_edit_config  for the same per-payload checks on one edit
+ */
+static int
+from_client_edit_config_batch(clicon_handle h,
+                              cxobj        *xe,
+                              cbuf         *cbret,
+                              void         *arg,
+                              void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t             myid = ce->ce_id;
+    uint32_t             iddb;
+    char                *target = NULL;
+    cxobj               *x;
+    cxobj               *xc;
+    cxobj              **vec = NULL;
+    size_t               veclen = 0;
+    enum operation_type *ops = NULL;
+    cxobj              **xvec = NULL;
+    char                *opstr;
+    yang_stmt           *yspec;
+    cbuf                *cbx = NULL; /* Assist cbuf */
+    int                  ret;
+    char                *username;
+    cxobj               *xret = NULL;
+    char                *val = NULL;
+    size_t               i;
+
+    username = clicon_username_get(h);
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec9");
+        goto done;
+    }
+    if ((x = xml_find_type(xe, NULL, "target", CX_ELMNT)) != NULL)
+        target = xml_body(x);
+    if (target == NULL){
+        if (netconf_missing_element(cbret, "protocol", "target", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (xmldb_validate_db(target) < 0){
+        cprintf(cbx, "No such database: %s", target);
+        if (netconf_invalid_value(cbret, "protocol", cbuf_get(cbx))< 0)
+            goto done;
+        goto ok;
+    }
+    /* Check if target locked by other client */
+    iddb = xmldb_islocked(h, target);
+    if (iddb && myid != iddb){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    if (xpath_vec(xe, NULL, "edit", &vec, &veclen) < 0)
+        goto done;
+    if (veclen == 0){
+        if (netconf_missing_element(cbret, "protocol", "edit", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ops = calloc(veclen, sizeof(*ops))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if ((xvec = calloc(veclen, sizeof(*xvec))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Per-payload checks, same as a single edit-config payload */
+    for (i=0; i<veclen; i++){
+        ops[i] = OP_MERGE;
+        if ((x = xml_find_type(vec[i], NULL, "operation", CX_ELMNT)) != NULL &&
+            xml_operation(xml_body(x), &ops[i]) < 0){
+            if (netconf_invalid_value(cbret, "protocol", "Wrong operation")< 0)
+                goto done;
+            goto ok;
+        }
+        if ((xc = xml_find_type(vec[i], NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+            if (netconf_missing_element(cbret, "protocol", NETCONF_INPUT_CONFIG, NULL) < 0)
+                goto done;
+            goto ok;
+        }
+        /* <config> yang spec may be set to anyxml by ingress yang check,...*/
+        if (xml_spec(xc) != NULL)
+            xml_spec_set(xc, NULL);
+        if ((ret = xml_bind_yang(xc, YB_MODULE, yspec, &xret)) < 0)
+            goto done;
+        if (ret && (ret = xml_non_config_data(xc, &xret)) < 0)
+            goto done;
+        if (ret && (ret = xml_yang_minmax_recurse(xc, &xret)) < 0)
+            goto done;
+        /* xmldb_put (difflist handling) requires list keys */
+        if (ret && (ret = xml_yang_validate_list_key_only(xc, &xret)) < 0)
+            goto done;
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (xml_sort_recurse(xc) < 0)
+            goto done;
+        xvec[i] = xc;
+    }
+    if ((ret = xmldb_put_vec(h, target, ops, xvec, veclen, username, cbret)) < 0){
+        if (netconf_operation_failed(cbret, "protocol", clicon_err_reason)< 0)
+            goto done;
+        goto ok;
+    }
+    xmldb_modified_set(h, target, 1); /* mark as dirty */
+    if (strcmp(target, "running") == 0)
+        nacm_decision_cache_invalidate(); /* access rules may have changed */
+    if (ret == 0)
+        goto ok;
+    if (cbuf_len(cbret) != 0){
+        clicon_err(OE_NETCONF, EINVAL, "Internal error: cbret is not empty");
+        goto done;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok", NETCONF_BASE_NAMESPACE);
+    if (clicon_data_get(h, "objectexisted", &val) == 0)
+        cprintf(cbret, " %s:objectexisted=\"%s\" xmlns:%s=\"%s\"",
+                CLIXON_LIB_PREFIX, val,
+                CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    cprintf(cbret, "/></rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    if (ops)
+        free(ops);
+    if (vec)
+        free(vec);
+    if (xret)
+        xml_free(xret);
+    if (cbx)
+        cbuf_free(cbx);
+    clicon_debug(1, "%s done cbret:%s", __FUNCTION__, cbuf_get(cbret));
+    return retval;
+} /* from_client_edit_config_batch */
+
 /*! Create or replace an entire config with another complete config db
  * @param[in]  h       Clicon handle 
  * @param[in]  xe      Request: <rpc><xn></rpc> 
@@ -689,6 +1116,8 @@ from_client_copy_config(clicon_handle h,
         goto ok;
     }
     xmldb_modified_set(h, target, 1); /* mark as dirty */
+    if (strcmp(target, "running") == 0)
+        nacm_decision_cache_invalidate(); /* access rules may have changed */
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
  ok:
     retval = 0;
@@ -1066,6 +1495,7 @@ from_client_create_subscription(clicon_handle h,
     char                *starttime = NULL;
     char                *stoptime = NULL;
     char                *selector = NULL;
+    char                *policy;
     struct timeval       start;
     struct timeval       stop;
     cvec                *nsc = NULL;
@@ -1113,6 +1543,15 @@ from_client_create_subscription(clicon_handle h,
                       starttime?&start:NULL, stoptime?&stop:NULL,
                       ce_event_cb, (void*)ce) < 0)
         goto done;
+    /* Overflow policy for this subscription, see ce_event_cb */
+    if ((policy = clicon_option_str(h, "CLICON_STREAM_OVERFLOW_POLICY")) != NULL){
+        if (strcmp(policy, "drop") == 0)
+            ce->ce_notify_policy = NOTIFY_POLICY_DROP;
+        else if (strcmp(policy, "coalesce") == 0)
+            ce->ce_notify_policy = NOTIFY_POLICY_COALESCE;
+        else
+            ce->ce_notify_policy = NOTIFY_POLICY_DISCONNECT;
+    }
     /* Replay of this stream to specific subscription according to start and 
      * stop (if present). 
      * RFC 5277: If <startTime> is not present, this is not a replay
@@ -1312,6 +1751,32 @@ from_client_ping(clicon_handle h,
     return 0;
 }
 
+/*! Return running datastore generation, bumped on each modification of running
+ * Cheap liveness+change query so that pollers can skip re-reading data when
+ * nothing has been committed.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xmldb_generation_get
+ */
+static int
+from_client_generation(clicon_handle h,
+                       cxobj        *xe,
+                       cbuf         *cbret,
+                       void         *arg,
+                       void         *regarg)
+{
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<generation xmlns=\"%s\">%" PRIu64 "</generation>",
+            CLIXON_LIB_NS, xmldb_generation_get());
+    cprintf(cbret, "</rpc-reply>");
+    return 0;
+}
+
 /*! Check liveness of backend daemon,  just send a reply
  * @param[in]  h       Clicon handle 
  * @param[in]  xe      Request: <rpc><xn></rpc> 
@@ -1331,7 +1796,14 @@ from_client_stats(clicon_handle h,
     int        retval = -1;
     uint64_t   nr;
     yang_stmt *ym;
-    
+    char     **keys = NULL;
+    size_t     klen;
+    int        i;
+    event_stream_t             *es;
+    struct stream_subscription *ss;
+    struct client_entry        *ce;
+    size_t                      qlen;
+
     cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
     xml_stats_global(&nr);
     cprintf(cbret, "<global xmlns=\"%s\">", CLIXON_LIB_NS);
@@ -1341,13 +1813,22 @@ from_client_stats(clicon_handle h,
     nr=0;
     yang_stats_global(&nr);
     cprintf(cbret, "<yangnr>%" PRIu64 "</yangnr>", nr);
+#ifdef HAVE_MALLINFO2
+    {
+        struct mallinfo2 mi;
+
+        mi = mallinfo2();
+        cprintf(cbret, "<heap-total>%zu</heap-total>", (size_t)(mi.arena + mi.hblkhd));
+        cprintf(cbret, "<heap-inuse>%zu</heap-inuse>", (size_t)(mi.uordblks + mi.hblkhd));
+    }
+#endif
     cprintf(cbret, "</global>");
-    if (clixon_stats_datastore_get(h, "running", cbret) < 0)
-        goto done;
-    if (clixon_stats_datastore_get(h, "candidate", cbret) < 0)
-        goto done;
-    if (clixon_stats_datastore_get(h, "startup", cbret) < 0)
+    /* All dbs ever touched, ie also tmp/rollback caches, not a fixed list */
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
         goto done;
+    for (i = 0; i < klen; i++)
+        if (clixon_stats_datastore_get(h, keys[i], cbret) < 0)
+            goto done;
     ym = NULL;
     while ((ym = yn_each(clicon_config_yang(h), ym)) != NULL) {    
         if (clixon_stats_module_get(h, ym, cbret) < 0)
@@ -1359,13 +1840,56 @@ from_client_stats(clicon_handle h,
             goto done;
     }
     ym = NULL;
-    while ((ym = yn_each(clicon_nacm_ext_yang(h), ym)) != NULL) {    
+    while ((ym = yn_each(clicon_nacm_ext_yang(h), ym)) != NULL) {
         if (clixon_stats_module_get(h, ym, cbret) < 0)
             goto done;
     }
+    for (i = 0; i < _rpc_stats_nr; i++){
+        struct rpc_stats *rs = &_rpc_stats[i];
+        int               b;
+
+        cprintf(cbret, "<rpc xmlns=\"%s\"><name>%s</name>"
+                "<count>%" PRIu64 "</count>"
+                "<in-bytes>%" PRIu64 "</in-bytes>"
+                "<out-bytes>%" PRIu64 "</out-bytes>",
+                CLIXON_LIB_NS, rs->rs_name,
+                rs->rs_count, rs->rs_in_bytes, rs->rs_out_bytes);
+        for (b = 0; b < RPC_STATS_BUCKETS; b++) /* only populated buckets */
+            if (rs->rs_hist[b])
+                cprintf(cbret, "<latency><bucket>%d</bucket>"
+                        "<count>%" PRIu64 "</count></latency>",
+                        b, rs->rs_hist[b]);
+        cprintf(cbret, "</rpc>");
+    }
+    /* Per-subscription delivery queue depth and drop counters */
+    if ((es = clicon_stream(h)) != NULL){
+        do {
+            if ((ss = es->es_subscription) != NULL)
+                do {
+                    if (ss->ss_fn == ce_event_cb){
+                        ce = (struct client_entry *)ss->ss_arg;
+                        qlen = 0;
+                        if (ce->ce_outq)
+                            qlen = cbuf_len(ce->ce_outq) - ce->ce_outq_off;
+                        cprintf(cbret, "<subscription xmlns=\"%s\">"
+                                "<stream>%s</stream>"
+                                "<session-id>%u</session-id>"
+                                "<queue-bytes>%zu</queue-bytes>"
+                                "<dropped>%u</dropped>"
+                                "</subscription>",
+                                CLIXON_LIB_NS, es->es_name, ce->ce_id,
+                                qlen, ce->ce_notify_dropped);
+                    }
+                    ss = NEXTQ(struct stream_subscription *, ss);
+                } while (ss && ss != es->es_subscription);
+            es = NEXTQ(event_stream_t *, es);
+        } while (es && es != clicon_stream(h));
+    }
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
+    if (keys)
+        free(keys);
     return retval;
 }
 
@@ -1460,6 +1984,130 @@ from_client_process_control(clicon_handle  h,
     return retval;
 }
 
+/*! Reload the YANG schema without restarting the backend
+ *
+ * Builds a fresh yang spec with the same load sequence as backend start,
+ * rebinds the cached datastore trees to the new spec in place and swaps the
+ * spec on the handle. The backend is single-threaded, so no other request is
+ * in flight during the swap: every session completes either fully on the old
+ * spec or fully on the new one, which is what a refcount would otherwise
+ * provide. On failure the caches are rebound back and the old spec restored.
+ * Freeing the old spec bumps the yang spec generation, which drops caches
+ * holding resolved yang pointers, see yspec_generation_get.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note Cached data that does not bind to the new spec fails the rpc:
+ *       backward-incompatible module upgrades (changelog / modstate) still
+ *       go through the startup upgrade path.
+ * @see backend_yang_load
+ */
+static int
+from_client_reload_yang(clicon_handle h,
+                        cxobj        *xe,
+                        cbuf         *cbret,
+                        void         *arg,
+                        void         *regarg)
+{
+    int         retval = -1;
+    yang_stmt  *yspec0;          /* old spec */
+    yang_stmt  *yspec1 = NULL;   /* new spec */
+    cvec       *nsctx0 = NULL;   /* old canonical namespace context */
+    char      **keys = NULL;
+    size_t      klen = 0;
+    int         i;
+    int         j;
+    db_elmnt   *de;
+    cxobj      *xerr = NULL;
+    int         ret;
+
+    if ((yspec0 = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    nsctx0 = clicon_nsctx_global_get(h);
+    if ((yspec1 = yspec_new()) == NULL)
+        goto done;
+    /* The loaders read the spec from the handle: point it at the new spec
+     * while loading, restored below on failure
+     */
+    clicon_dbspec_yang_set(h, yspec1);
+    if (backend_yang_load(h, yspec1) < 0){
+        clicon_dbspec_yang_set(h, yspec0);
+        clicon_nsctx_global_set(h, nsctx0);
+        if (netconf_operation_failed(cbret, "application",
+                                     clicon_err_reason) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    /* Rebind the cached datastore trees to the new spec in place */
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i=0; i<klen; i++){
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL ||
+            de->de_xml == NULL)
+            continue;
+        if ((ret = xml_bind_yang(de->de_xml, YB_MODULE, yspec1, &xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            break; /* does not bind to the new spec: roll back below */
+        if (xml_sort_recurse(de->de_xml) < 0)
+            goto done;
+    }
+    if (i < klen){ /* Rollback: rebind converted caches to the old spec */
+        cvec *nsctx1;
+
+        if (xerr){
+            xml_free(xerr);
+            xerr = NULL;
+        }
+        for (j=0; j<=i; j++){
+            if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[j], NULL)) == NULL ||
+                de->de_xml == NULL)
+                continue;
+            if (xml_bind_yang(de->de_xml, YB_MODULE, yspec0, &xerr) < 0)
+                goto done;
+            if (xml_sort_recurse(de->de_xml) < 0)
+                goto done;
+        }
+        if ((nsctx1 = clicon_nsctx_global_get(h)) != NULL && nsctx1 != nsctx0)
+            cvec_free(nsctx1); /* set by the successful load above */
+        clicon_dbspec_yang_set(h, yspec0);
+        clicon_nsctx_global_set(h, nsctx0);
+        if (netconf_operation_failed(cbret, "application",
+                                     "cached datastore does not bind to the new yang spec") < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    /* Success: refresh the module-state cache and drop derived caches */
+    if (startup_module_state(h, yspec1) < 0)
+        goto done;
+    clixon_statedata_cache_invalidate(h);
+    /* Freeing the old spec bumps the spec generation, invalidating caches
+     * of resolved yang pointers
+     */
+    ys_free(yspec0);
+    if (nsctx0)
+        cvec_free(nsctx0);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>",
+            NETCONF_BASE_NAMESPACE);
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    if (xerr)
+        xml_free(xerr);
+    if (yspec1 && clicon_dbspec_yang(h) != yspec1)
+        ys_free(yspec1);
+    return retval;
+}
+
 /*! Clixon hello to check liveness
  *
  * @param[in]  h       Clixon handle
@@ -1497,13 +2145,65 @@ from_client_hello(clicon_handle       h,
     }
     id++;
     clicon_session_id_set(h, id);
-    cprintf(cbret, "<hello xmlns=\"%s\"><session-id>%u</session-id></hello>",
-            NETCONF_BASE_NAMESPACE, id);
+    cprintf(cbret, "<hello xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    /* Advertise that binary serialized request payloads are accepted,
+     * see clicon_msg_decode / clicon_hello_req
+     */
+    cprintf(cbret, "<capabilities><capability>%s</capability></capabilities>",
+            CLIXON_BINARY_CAPABILITY);
+    cprintf(cbret, "<session-id>%u</session-id></hello>", id);
     retval = 0;
  done:
     return retval;
 }
 
+/*! Check if all operations in a netconf rpc message are read-only
+ * @param[in]  x   XML of netconf rpc element
+ * @retval     1   All operations are read-only (get, get-config, get-schema)
+ * @retval     0   At least one operation may modify state (or no operations)
+ * @see from_client_msg  where read-only messages may be offloaded to a worker
+ */
+static int
+rpc_msg_readonly(cxobj *x)
+{
+    cxobj *xe = NULL;
+    char  *rpc;
+    int    nr = 0;
+
+    while ((xe = xml_child_each(x, xe, CX_ELMNT)) != NULL) {
+        rpc = xml_name(xe);
+        if (strcmp(rpc, "get") != 0 &&
+            strcmp(rpc, "get-config") != 0 &&
+            strcmp(rpc, "get-schema") != 0)
+            return 0;
+        nr++;
+    }
+    return nr > 0;
+}
+
+/*! Check if a client session has any active event stream subscription
+ * @param[in]  h   Clicon handle
+ * @param[in]  ce  Client entry
+ * @retval     1   At least one subscription exists for this session
+ * @retval     0   No subscription
+ */
+static int
+ce_subscription_any(clicon_handle        h,
+                    struct client_entry *ce)
+{
+    event_stream_t *es;
+    event_stream_t *es0;
+
+    es0 = clicon_stream(h);
+    if ((es = es0) != NULL)
+        do {
+            if (stream_ss_find(es, ce_event_cb, (void*)ce) != NULL)
+                return 1;
+            es = NEXTQ(event_stream_t *, es);
+        } while (es && es != es0);
+    return 0;
+}
+
 /*! An internal clicon message has arrived from a client. Receive and dispatch.
  * @param[in]   h    Clicon handle
  * @param[in]   ce   Client entry (from)
@@ -1537,9 +2237,23 @@ from_client_msg(clicon_handle        h,
     char                *rpcprefix;
     char                *namespace = NULL;
     int                  nr = 0;
-    
+    pid_t                child;
+    int                  status;
+    int                  readonly_worker = 0;
+    struct clicon_msg   *msgret = NULL;
+    struct iovec         riov[1];
+    char                *stats_name = NULL;
+    struct timeval       t0;
+    struct timeval       t1;
+
     clicon_debug(2, "%s", __FUNCTION__);
-    yspec = clicon_dbspec_yang(h); 
+    CLIXON_PROBE1(from_client_msg_entry, ntohl(msg->op_len));
+    /* Adopt the frontend's correlation id: backend stages and the reply
+     * headers carry it until the next message arrives */
+    clixon_trace_id_set(ntohl(msg->op_tid));
+    clixon_trace_stage("backend-dispatch");
+    gettimeofday(&t0, NULL);
+    yspec = clicon_dbspec_yang(h);
     /* Return netconf message. Should be filled in by the dispatch(sub) functions 
      * as wither rpc-error or by positive response.
      */
@@ -1635,8 +2349,57 @@ from_client_msg(clicon_handle        h,
     username = xml_find_value(x, "username");
     /* May be used by callbacks, etc */
     clicon_username_set(h, username);
+    /* Offload read-only messages to a short-lived worker process, see
+     * CLICON_BACKEND_READONLY_FORK. fork(2) gives the worker a copy-on-write
+     * snapshot of the datastores and YANG trees so a slow get on a large
+     * subtree does not stall other sessions, while writes stay serialized
+     * here. The worker sends the reply on the inherited client socket and
+     * exits. A double fork makes the worker a child of init: it is then not
+     * mixed up with the processes tracked by clixon_process_waitpid().
+     * Sessions with subscriptions are excluded since this process could
+     * interleave a notification with the worker reply.
+     * Pipelining clients (several RPCs in flight, see clicon_rpc_netconf_send)
+     * are also excluded: a worker replying concurrently with this process
+     * would reorder or interleave replies on the shared socket. Once a client
+     * has been seen pipelining it stays on the in-order inline path.
+     */
+    if (!ce->ce_pipelined){
+        int pending = 0;
+
+        if (ioctl(ce->ce_s, FIONREAD, &pending) == 0 && pending > 0)
+            ce->ce_pipelined = 1;
+    }
+    if (clicon_option_bool(h, "CLICON_BACKEND_READONLY_FORK") &&
+        rpc_msg_readonly(x) &&
+        !ce->ce_pipelined &&
+        !ce_subscription_any(h, ce)){
+        if ((child = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (child > 0){ /* Main process: reap the intermediate, worker replies */
+            if (waitpid(child, &status, 0) < 0){
+                clicon_err(OE_UNIX, errno, "waitpid");
+                goto done;
+            }
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0){
+                retval = 0;
+                goto done;
+            }
+            /* Second fork failed in the intermediate: process inline instead */
+            clicon_log(LOG_WARNING, "%s: read-only worker fork failed, processing inline",
+                       __FUNCTION__);
+        }
+        else {
+            if ((child = fork()) != 0)
+                _exit(child < 0 ? 1 : 0); /* Intermediate exits immediately */
+            readonly_worker = 1;
+        }
+    }
     while ((xe = xml_child_each(x, xe, CX_ELMNT)) != NULL) {
         rpc = xml_name(xe);
+        if (stats_name == NULL)
+            stats_name = rpc; /* first operation names the message in rpc stats */
         if ((ye = xml_spec(xe)) == NULL){
             if (netconf_operation_not_supported(cbret, "protocol", rpc) < 0)
                 goto done;
@@ -1709,9 +2472,20 @@ from_client_msg(clicon_handle        h,
         if (netconf_operation_failed(cbret, "application", clicon_errno?clicon_err_reason:"unknown")< 0)
             goto done;
     clicon_debug(2, "%s cbret:%s", __FUNCTION__, cbuf_get(cbret));
-    /* XXX problem here is that cbret has not been parsed so may contain 
+    /* XXX problem here is that cbret has not been parsed so may contain
        parse errors */
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
+    if (!readonly_worker &&
+        (msgret = clicon_msg_encode(0, "%s", cbuf_get(cbret))) == NULL)
+        goto done;
+    /* The read-only fork worker (see above) exits right after the reply: it writes
+     * blocking, queueing in the worker would lose the data. Vectored write so the
+     * potentially large read reply is not copied again, see send_msg_reply_iov
+     */
+    riov[0].iov_base = cbuf_get(cbret);
+    riov[0].iov_len = cbuf_len(cbret);
+    if ((readonly_worker ?
+         send_msg_reply_iov(ce->ce_s, riov, 1) :
+         client_send(h, ce, msgret, ntohl(msgret->op_len))) < 0){
         switch (errno){
         case EPIPE:
             /* man (2) write: 
@@ -1728,9 +2502,22 @@ from_client_msg(clicon_handle        h,
             goto done;
         }
     }
+    /* The forked read-only worker exits right after, its stats are not
+     * folded back into this table
+     */
+    if (stats_name && !readonly_worker){
+        gettimeofday(&t1, NULL);
+        timersub(&t1, &t0, &t1);
+        rpc_stats_record(stats_name,
+                         (uint64_t)t1.tv_sec*1000000 + t1.tv_usec,
+                         ntohl(msg->op_len),
+                         cbuf_len(cbret));
+    }
     // ok:
     retval = 0;
-  done:  
+  done:
+    CLIXON_PROBE2(from_client_msg_exit, retval, cbret ? cbuf_len(cbret) : 0);
+    clixon_trace_stage("backend-reply");
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     if (xnacm){
         xml_free(xnacm);
@@ -1743,10 +2530,14 @@ from_client_msg(clicon_handle        h,
         xml_free(xt);
     if (cbret)
         cbuf_free(cbret);
+    if (msgret)
+        free(msgret);
     /* Sanity: log if clicon_err() is not called ! */
     if (retval < 0 && clicon_errno < 0) 
         clicon_log(LOG_NOTICE, "%s: Internal error: No clicon_err call on RPC error (message: %s)",
                    __FUNCTION__, rpc?rpc:"");
+    if (readonly_worker)
+        _exit(retval < 0 ? 1 : 0); /* The worker must not return into the event loop */
     //    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     return retval;// -1 here terminates backend
 }
@@ -1767,14 +2558,36 @@ from_client(int   s,
     struct client_entry *ce = (struct client_entry *)arg;
     clicon_handle        h = ce->ce_handle;
     int                  eof = 0;
+    cbuf                *cberr = NULL;
+    int                  ret;
+    int                  oneshot = 0;
 
     clicon_debug(2, "%s", __FUNCTION__);
     if (s != ce->ce_s){
         clicon_err(OE_NETCONF, EINVAL, "Internal error: s != ce->ce_s");
         goto done;
     }
-    if (clicon_msg_rcv(ce->ce_s, &msg, &eof) < 0)
+    ret = clicon_msg_rcv_buf(ce->ce_s, &ce->ce_rcvbuf, &msg, &eof);
+    /* msg normally aliases the reusable buffer and must not be freed,
+     * see clicon_msg_rcv_buf for the one-shot large-message case */
+    oneshot = (msg != NULL && msg != ce->ce_rcvbuf.mb_buf);
+    if (ret < 0){
+        /* A message over CLICON_MESSAGE_SIZE_LIMIT is drained and refused
+         * before allocation: answer with resource-denied and keep the session
+         * rather than terminate, see clicon_msg_rcv_limit_set */
+        if (clicon_errno == OE_PROTO && clicon_suberrno == EMSGSIZE){
+            if ((cberr = cbuf_new()) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_new");
+                goto done;
+            }
+            if (netconf_resource_denied(cberr, "protocol", clicon_err_reason) < 0)
+                goto done;
+            if (send_msg_reply(ce->ce_s, cbuf_get(cberr), cbuf_len(cberr)+1) < 0)
+                goto done;
+            retval = 0;
+        }
         goto done;
+    }
     if (eof)
         backend_client_rm(h, ce); 
     else
@@ -1783,7 +2596,9 @@ from_client(int   s,
     retval = 0;
   done:
     clicon_debug(1, "%s retval=%d", __FUNCTION__, retval);
-    if (msg)
+    if (cberr)
+        cbuf_free(cberr);
+    if (oneshot)
         free(msg);
     return retval; /* -1 here terminates backend */
 }
@@ -1860,12 +2675,27 @@ backend_rpc_init(clicon_handle h)
     if (rpc_callback_register(h, from_client_ping, NULL,
                               CLIXON_LIB_NS, "ping") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_generation, NULL,
+                              CLIXON_LIB_NS, "generation") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_stats, NULL,
                               CLIXON_LIB_NS, "stats") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_edit_config_batch, NULL,
+                              CLIXON_LIB_NS, "edit-config-batch") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_list_keys, NULL,
+                              CLIXON_LIB_NS, "list-keys") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_diff, NULL,
+                              CLIXON_LIB_NS, "datastore-diff") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_restart_plugin, NULL,
                               CLIXON_LIB_NS, "restart-plugin") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_reload_yang, NULL,
+                              CLIXON_LIB_NS, "reload-yang") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_process_control, NULL,
                               CLIXON_LIB_NS, "process-control") < 0)
         goto done;
@@ -39,7 +39,16 @@
 
 /*
  * Types
- */ 
+ */
+/* Policy when notifications for a slow client exceed the queue threshold,
+ * set from CLICON_STREAM_OVERFLOW_POLICY at subscribe time, see ce_event_cb
+ */
+enum notify_policy{
+    NOTIFY_POLICY_DISCONNECT, /* Close the client (default) */
+    NOTIFY_POLICY_DROP,       /* Drop new events while the queue is full */
+    NOTIFY_POLICY_COALESCE    /* Keep only the newest event, sent on drain */
+};
+
 /*
  * Backend client entry.
  * Keep state about every connected client.
@@ -62,6 +71,17 @@ struct client_entry{
     uint32_t              ce_in_rpcs ;       /* Number of correct <rpc> messages received. */
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
+    cbuf                 *ce_outq;     /* Output not yet accepted by the socket, drained on
+                                          write-readiness, see client_send */
+    size_t                ce_outq_off; /* Bytes of ce_outq already sent */
+    enum notify_policy    ce_notify_policy;  /* Notification overflow policy */
+    struct clicon_msg    *ce_notify_pending; /* COALESCE: newest event held
+                                                back while the queue is full */
+    uint32_t              ce_notify_dropped; /* Events dropped or coalesced away */
+    int                   ce_pipelined; /* Client has been seen with more than one RPC in
+                                           flight: process in order, no read-only fork */
+    struct msg_rcv_buf    ce_rcvbuf;   /* Receive buffer reused across messages, adapts
+                                          to this client's sizes, see clicon_msg_rcv_buf */
 };
 
 /*
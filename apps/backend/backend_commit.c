@@ -83,8 +83,10 @@
  * @param[in]   h       Clixon handle
  * @param[in]   yspec   Yang spec
  * @param[in]   td      Transaction data
+ * @param[in]   incremental  Validate only diff-touched and cross-referencing subtrees.
+ *                      Requires diff flags in td_target, see validate_common
  * @param[out]  xret    Error XML tree. Free with xml_free after use
- * @retval      1       Validation OK       
+ * @retval      1       Validation OK
  * @retval      0       Validation failed (with cbret set)
  * @retval     -1       Error
  */
@@ -92,6 +94,7 @@ static int
 generic_validate(clicon_handle       h,
                  yang_stmt          *yspec,
                  transaction_data_t *td,
+                 int                 incremental,
                  cxobj             **xret)
 {
     int        retval = -1;
@@ -100,8 +103,17 @@ generic_validate(clicon_handle       h,
     int        ret;
     cbuf      *cb = NULL;
 
-    /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
+    /* Build leafref target value sets once per pass instead of one scan per
+     * referring leaf. Tree must not change until the index is dropped below
+     */
+    if (xml_leafref_index_begin(td->td_target) < 0)
+        goto done;
+    /* All entries, or only diff-touched subtrees, see CLICON_VALIDATE_INCREMENTAL */
+    if (incremental)
+        ret = xml_yang_validate_changed_top(h, td->td_target, xret);
+    else
+        ret = xml_yang_validate_all_top(h, td->td_target, xret);
+    if (ret < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -125,6 +137,7 @@ generic_validate(clicon_handle       h,
     // ok:
     retval = 1;
  done:
+    xml_leafref_index_end();
     if (cb)
         cbuf_free(cb);
     return retval;
@@ -169,6 +182,7 @@ startup_common(clicon_handle       h,
     cxobj              *x;
     cxobj              *xret = NULL;
     cxobj              *xerr = NULL;
+    int                 skip_validate = 0;
 
     /* If CLICON_XMLDB_MODSTATE is enabled, then get the db XML with 
      * potentially non-matching module-state in msdiff
@@ -297,19 +311,29 @@ startup_common(clicon_handle       h,
     if (plugin_transaction_begin_all(h, td) < 0)
         goto done;
 
-    /* 5. Make generic validation on all new or changed data.
-       Note this is only call that uses 3-values */
-    clicon_debug(1, "Validating startup %s", db);
-    if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
+    /* If the file and the module set are unchanged since they last passed
+     * validation, skip steps 5-6, see CLICON_VALIDATE_CACHE
+     */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_CACHE") &&
+        (skip_validate = xmldb_validated_get(h, db)) < 0)
         goto done;
-    if (ret == 0){
-        if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
+    if (skip_validate)
+        clicon_log(LOG_INFO, "%s unchanged since last validation, skipping validation", db);
+    else {
+        /* 5. Make generic validation on all new or changed data.
+           Note this is only call that uses 3-values */
+        clicon_debug(1, "Validating startup %s", db);
+        if ((ret = generic_validate(h, yspec, td, 0, &xret)) < 0)
+            goto done;
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
+                goto done;
+            goto fail; /* STARTUP_INVALID */
+        }
+        /* 6. Call plugin transaction validate callbacks */
+        if (plugin_transaction_validate_all(h, td) < 0)
             goto done;
-        goto fail; /* STARTUP_INVALID */
     }
-    /* 6. Call plugin transaction validate callbacks */
-    if (plugin_transaction_validate_all(h, td) < 0)
-        goto done;
 
     /* 7. Call plugin transaction complete callbacks */
     if (plugin_transaction_complete_all(h, td) < 0)
@@ -443,6 +467,13 @@ startup_commit(clicon_handle  h,
         goto done;
     if (ret == 0)
         goto fail;
+    /* Record that db and running hold validated content, see CLICON_VALIDATE_CACHE */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_CACHE")){
+        if (xmldb_validated_set(h, db) < 0)
+            goto done;
+        if (xmldb_validated_set(h, "running") < 0)
+            goto done;
+    }
     /* 10. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
     retval = 1;
@@ -483,21 +514,29 @@ validate_common(clicon_handle       h,
     yang_stmt  *yspec;
     int         i;
     cxobj      *xn;
+    cxobj      *xp;
+    char       *xpath = NULL;
+    int         incremental;
+    int         skip_validate = 0;
+    cvec       *touched;
+    int         subtree;
     int         ret;
-    
+
+    incremental = clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL");
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_FATAL, 0, "No DB_SPEC");
         goto done;
-    }   
+    }
     /* This is the state we are going to */
     if ((ret = xmldb_get0(h, db, YB_MODULE, NULL, "/", 0, 0, &td->td_target, NULL, xret)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
-    /* Clear flags xpath for get */
+    /* Clear flags xpath for get. Also diff flags: stale ones would inflate
+     * incremental validation */
     xml_apply0(td->td_target, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
-    /* 2. Parse xml trees 
+               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE|XML_FLAG_ADD|XML_FLAG_DEL));
+    /* 2. Parse xml trees
      * This is the state we are going from */
     if ((ret = xmldb_get0(h, "running", YB_MODULE, NULL, "/", 0, 0, &td->td_src, NULL, xret)) < 0)
         goto done;
@@ -505,9 +544,26 @@ validate_common(clicon_handle       h,
         goto fail;
     /* Clear flags xpath for get */
     xml_apply0(td->td_src, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
-               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
-    /* 3. Compute differences */
-    if (xml_diff(yspec, 
+               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE|XML_FLAG_ADD|XML_FLAG_DEL));
+    /* 3. Compute differences. If the paths touched by edits since db last
+     * equalled running are on record, compare only those subtrees instead of
+     * walking the full trees, see xmldb_touched_get
+     */
+    if ((touched = xmldb_touched_get(h, db)) != NULL){
+        if (xml_diff_paths(yspec,
+                           td->td_src,
+                           td->td_target,
+                           touched,
+                           &td->td_dvec,      /* removed: only in running */
+                           &td->td_dlen,
+                           &td->td_avec,      /* added: only in candidate */
+                           &td->td_alen,
+                           &td->td_scvec,     /* changed: original values */
+                           &td->td_tcvec,     /* changed: wanted values */
+                           &td->td_clen) < 0)
+            goto done;
+    }
+    else if (xml_diff(yspec,
                  td->td_src,
                  td->td_target,
                  &td->td_dvec,      /* removed: only in running */
@@ -541,17 +597,68 @@ validate_common(clicon_handle       h,
         xml_flag_set(xn, XML_FLAG_CHANGE);
         xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
     }
+    if (incremental){
+        /* Deletions are only flagged in the source tree above. Mark the target
+         * counterpart of each deleted node's parent so that incremental
+         * validation revisits mandatory/min-element constraints there
+         */
+        for (i=0; i<td->td_dlen; i++){
+            if ((xp = xml_parent(td->td_dvec[i])) == NULL || xp == td->td_src)
+                continue;
+            /* If a key value has no xpath representation (contains both quote
+             * characters), retry at ancestors and mark that whole subtree so
+             * the node is still revisited
+             */
+            subtree = 0;
+            ret = 0;
+            while (xp != NULL && xp != td->td_src){
+                if ((ret = xml2xpath(xp, NULL, &xpath)) < 0)
+                    goto done;
+                if (ret == 1)
+                    break;
+                free(xpath);
+                xpath = NULL;
+                subtree = 1;
+                xp = xml_parent(xp);
+            }
+            if (ret != 1)
+                continue;
+            if ((xn = xpath_first(td->td_target, NULL, "%s", xpath)) != NULL){
+                xml_flag_set(xn, XML_FLAG_CHANGE);
+                if (subtree)
+                    xml_apply(xn, CX_ELMNT, (xml_applyfn_t*)xml_flag_set,
+                              (void*)XML_FLAG_CHANGE);
+                xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+            }
+            free(xpath);
+            xpath = NULL;
+        }
+    }
     /* 4. Call plugin transaction start callbacks */
     if (plugin_transaction_begin_all(h, td) < 0)
         goto done;
 
-    /* 5. Make generic validation on all new or changed data.
-       Note this is only call that uses 3-values */
-    if ((ret = generic_validate(h, yspec, td, xret)) < 0)
+    /* If the file and the module set are unchanged since they last passed
+     * validation, skip step 5 (generic YANG validation), see
+     * CLICON_VALIDATE_CACHE. Typical for retry loops and idempotent pushes
+     * re-validating the same candidate content. Plugin validate callbacks
+     * (step 6) are not skipped: they may depend on state outside the db
+     * content, which the fingerprint does not cover.
+     */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_CACHE") &&
+        (skip_validate = xmldb_validated_get(h, db)) < 0)
         goto done;
-    if (ret == 0)
-        goto fail;
-
+    if (skip_validate)
+        clicon_debug(1, "%s: %s unchanged since last validation, skipping validation",
+                     __FUNCTION__, db);
+    else {
+        /* 5. Make generic validation on all new or changed data.
+           Note this is only call that uses 3-values */
+        if ((ret = generic_validate(h, yspec, td, incremental, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
     /* 6. Call plugin transaction validate callbacks */
     if (plugin_transaction_validate_all(h, td) < 0)
         goto done;
@@ -561,6 +668,8 @@ validate_common(clicon_handle       h,
         goto done;
     retval = 1;
  done:
+    if (xpath)
+        free(xpath);
     return retval;
  fail:
     retval = 0;
@@ -621,6 +730,10 @@ candidate_validate(clicon_handle h,
     if (xmldb_get0_clear(h, td->td_src) < 0 ||
         xmldb_get0_clear(h, td->td_target) < 0)
         goto done;
+    /* Record that db holds validated content, see CLICON_VALIDATE_CACHE */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_CACHE") &&
+        xmldb_validated_set(h, db) < 0)
+        goto done;
 
     plugin_transaction_end_all(h, td);
     retval = 1;
@@ -640,11 +753,57 @@ candidate_validate(clicon_handle h,
     goto done;
 }
 
+/*! Check if a commit transaction touches NACM configuration
+ * Used to invalidate the NACM access decision cache only when the access
+ * rules may actually have changed, keeping it warm over ordinary commits.
+ * @param[in]  td   Transaction data with diff vectors computed
+ * @retval     1    NACM config in the diff (or node of unknown module)
+ * @retval     0    No NACM config changed
+ * @see nacm_decision_cache_invalidate
+ */
+static int
+nacm_config_changed(transaction_data_t *td)
+{
+    int        i;
+    cxobj     *xn;
+    yang_stmt *ys;
+    yang_stmt *ymod;
+
+    for (i=0; i<td->td_dlen + td->td_alen + td->td_clen; i++){
+        if (i < td->td_dlen)
+            xn = td->td_dvec[i];
+        else if (i < td->td_dlen + td->td_alen)
+            xn = td->td_avec[i - td->td_dlen];
+        else
+            xn = td->td_tcvec[i - td->td_dlen - td->td_alen];
+        if ((ys = xml_spec(xn)) == NULL)
+            return 1; /* Unknown node, be conservative */
+        if (ys_real_module(ys, &ymod) < 0 || ymod == NULL)
+            return 1;
+        if (strcmp(yang_argument_get(ymod), "ietf-netconf-acm") == 0)
+            return 1;
+    }
+    return 0;
+}
+
 /*! Do a diff between candidate and running, then start a commit transaction
  *
  * The code reverts changes if the commit fails. But if the revert
  * fails, we just ignore the errors and proceed. Maybe we should
  * do something more drastic?
+ *
+ * On pipelining: the stages validate -> plugin validate -> plugin commit ->
+ * copy to running run strictly serially per transaction, and the next
+ * transaction waits for all of them, even though a slow plugin commit (eg
+ * pushing to a dataplane) does not touch the datastore. This is deliberate:
+ * the plugin transaction API is synchronous, the backend is a single event
+ * process (the XML/YANG library mutates process-global state and cannot run
+ * in threads, see backend_startup.c), and a failed plugin commit of
+ * transaction N reverts running, invalidating anything transaction N+1 was
+ * validated against. What can be overlapped safely already is: clients may
+ * validate ahead with the <validate> rpc, and with CLICON_VALIDATE_CACHE set
+ * the subsequent commit skips re-validation of the unchanged candidate, so
+ * only the plugin phases remain on the commit path.
  * @param[in]  h          Clicon handle
  * @param[in]  xe         Request: <rpc><xn></rpc>  (or NULL)
  * @param[in]  db         A candidate database, not necessarily "candidate"
@@ -664,6 +823,8 @@ candidate_commit(clicon_handle h,
     int                 ret;
     cxobj              *xret = NULL;
     yang_stmt          *yspec;
+    int                 delta = 0;
+    int                 nacm_changed = 0;
 
      /* 1. Start transaction */
     if ((td = transaction_new()) == NULL)
@@ -672,6 +833,7 @@ candidate_commit(clicon_handle h,
     /* Common steps (with validate). Load candidate and running and compute diffs
      * Note this is only call that uses 3-values
      */
+    CLIXON_PROBE2(candidate_commit_phase, "validate", db);
     if ((ret = validate_common(h, db, td, &xret)) < 0)
         goto done;
 
@@ -703,21 +865,55 @@ candidate_commit(clicon_handle h,
     }
 
      /* 7. Call plugin transaction commit callbacks */
+     CLIXON_PROBE2(candidate_commit_phase, "commit", db);
      if (plugin_transaction_commit_all(h, td) < 0)
          goto done;
      /* After commit, make a post-commit call (sure that all plugins have committed) */
      if (plugin_transaction_commit_done_all(h, td) < 0)
          goto done;
-     
+
+     /* Must be checked before the diff vectors are freed below */
+     nacm_changed = nacm_config_changed(td);
+
+     /* In journal mode, persist the already computed diff as delta records
+      * against the running snapshot instead of rewriting it wholesale at the
+      * copy below. Must be done before the trees are cleared.
+      */
+     if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")){
+         if (xmldb_journal_delta(h, "running",
+                                 td->td_dvec, td->td_dlen,
+                                 td->td_avec, td->td_alen,
+                                 td->td_tcvec, td->td_clen) < 0)
+             goto done;
+         delta = 1;
+     }
      /* Clear cached trees from default values and marking */
      if (xmldb_get0_clear(h, td->td_target) < 0)
          goto done;
      if (xmldb_get0_clear(h, td->td_src) < 0)
          goto done;
 
-     /* 8. Success: Copy candidate to running 
+     /* 8. Success: Copy candidate to running.
+      * The source tree is stolen rather than deep-copied: the source is
+      * identical to running from here on so its cache entry can give up its
+      * tree, see xmldb_steal_cache
       */
-     if (xmldb_copy(h, db, "running") < 0)
+     CLIXON_PROBE2(candidate_commit_phase, "copy", db);
+     if (delta){
+         if (xmldb_steal_cache(h, db, "running") < 0)
+             goto done;
+         if (xmldb_journal_compact(h, "running") < 0)
+             goto done;
+     }
+     else if (xmldb_move(h, db, "running") < 0)
+         goto done;
+     /* Record that running now holds validated content, see CLICON_VALIDATE_CACHE.
+      * In delta mode the fingerprint covers snapshot plus journal, so the
+      * sidecar stays current at every commit and a crash-recovered running
+      * (snapshot + journal replay) skips revalidation at startup too.
+      */
+     if (clicon_option_bool(h, "CLICON_VALIDATE_CACHE") &&
+         xmldb_validated_set(h, "running") < 0)
          goto done;
      xmldb_modified_set(h, db, 0); /* reset dirty bit */
      /* Here pointers to old (source) tree are obsolete */
@@ -732,8 +928,16 @@ candidate_commit(clicon_handle h,
      }
 
     /* 9. Call plugin transaction end callbacks */
+    CLIXON_PROBE2(candidate_commit_phase, "end", db);
     plugin_transaction_end_all(h, td);
-    
+
+    /* Config change may change what state the plugins report, drop cached replies */
+    clixon_statedata_cache_invalidate(h);
+
+    /* Changed access rules invalidate cached per-node access decisions */
+    if (nacm_changed)
+        nacm_decision_cache_invalidate();
+
     retval = 1;
  done:
      /* In case of failure (or error), call plugin transaction termination callbacks */
@@ -887,12 +1091,20 @@ from_client_discard_changes(clicon_handle h,
 }
 
 /*! Validates the contents of the specified configuration.
- * @param[in]  h       Clicon handle 
- * @param[in]  xe      Request: <rpc><xn></rpc> 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ *
+ * With CLICON_VALIDATE_CACHE set, a successful validate also records a
+ * validated fingerprint for the db (xmldb_validated_set). A commit of the
+ * same untouched db then skips only the generic YANG re-validation inside
+ * validate_common, which serves the common NMS sequence of validate directly
+ * followed by commit; any edit in between invalidates the fingerprint.
+ * Plugin transaction validate callbacks are never skipped: they may depend
+ * on state outside the db content that the fingerprint does not cover.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
  * @param[in]  arg     client-entry
- * @param[in]  regarg  User argument given at rpc_callback_register() 
- * @retval     0       OK. This may indicate both ok and err msg back to client 
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK. This may indicate both ok and err msg back to client
  *                     (eg invalid)
  * @retval    -1       Error
  */
@@ -1014,7 +1226,7 @@ from_client_restart_one(clicon_handle h,
         goto fail;
     /* Make generic validation on all new or changed data.
        Note this is only call that uses 3-values */
-    if ((ret = generic_validate(h, yspec, td, &xerr)) < 0)
+    if ((ret = generic_validate(h, yspec, td, 0, &xerr)) < 0)
         goto done;
     if (ret == 0){
         if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
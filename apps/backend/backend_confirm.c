@@ -488,6 +488,11 @@ handle_confirmed_commit(clicon_handle h,
         clicon_err(OE_CFG, EINVAL, "xe is NULL");
         goto done;
     }
+    /* Durability barrier: confirmed-commit rollback semantics depend on the
+     * on-disk state, so fold any deferred snapshot writes first
+     */
+    if (xmldb_flush(h, NULL) < 0)
+        goto done;
     if (clicon_session_id_get(h, &session_id) < 0) {
         clicon_err(OE_DAEMON, 0,
                    "an ephemeral confirmed-commit was issued, but the session-id could not be determined");
@@ -582,6 +587,13 @@ handle_confirmed_commit(clicon_handle h,
             goto done;
         } else if (db_exists == 0) {
             // db does not yet exists
+            /* Cheap snapshot in the common setup: the cache copy is a shared
+             * COW overlay (datastore cache-cow, see xmldb_copy_cache) and the
+             * file copy a reflink clone where the filesystem supports it, see
+             * clicon_file_copy. The snapshot must remain a real db file and
+             * not only an in-memory handle: crash recovery at startup commits
+             * it, see the note above
+             */
             if (xmldb_copy(h, "running", "rollback") < 0) {
                 clicon_err(OE_DAEMON, 0, "there was an error while copying the running configuration to rollback database.");
                 goto done;
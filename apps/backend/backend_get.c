@@ -476,6 +476,125 @@ get_nacm_and_reply(clicon_handle h,
     return retval;
 }
 
+/*! Streamed state get: serialize one plugin statedata reply at a time
+ *
+ * Alternative to building one merged state tree: when every statedata plugin
+ * declares exclusive ownership of a distinct top-level subtree (see
+ * ca_statedata_subtree), each plugin reply can be filtered and serialized
+ * into the reply buffer on its own and freed before the next plugin runs.
+ * Peak tree memory drops from the sum of all plugin replies to the largest
+ * single one, and the merge step is skipped entirely.
+ * Global schema defaults of state nodes outside any plugin subtree are not
+ * added here, unlike the merged path (xml_global_defaults), which is the
+ * behavioral price of never materializing the full tree.
+ * @param[in]  h        Clicon handle
+ * @param[in]  cpv      Statedata plugins in reply order, see clixon_plugin_statedata_stream_plan
+ * @param[in]  cplen    Length of cpv
+ * @param[in]  xpath    XPath point to object to get
+ * @param[in]  nsc      Namespace context of xpath
+ * @param[in]  wdef     With-defaults parameter, see RFC 6243
+ * @param[in]  username User name for NACM access
+ * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
+ * @param[out] cbret    Complete rpc-reply (or rpc-error) message
+ * @retval     0        OK, cbret set
+ * @retval    -1        Error
+ */
+static int
+get_statedata_stream(clicon_handle     h,
+                     clixon_plugin_t **cpv,
+                     int               cplen,
+                     char             *xpath,
+                     cvec             *nsc,
+                     withdefaults_type wdef,
+                     char             *username,
+                     int32_t           depth,
+                     cbuf             *cbret)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xs = NULL;
+    cxobj     *xerr = NULL;
+    cxobj     *xnacm;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    cxobj     *xc;
+    int        i;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    xnacm = clicon_nacm_cache(h);
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><data>", NETCONF_BASE_NAMESPACE);
+    for (i = 0; i < cplen; i++){
+        if ((ret = clixon_plugin_statedata_get_one(h, cpv[i], yspec, nsc, xpath,
+                                                   &xs, &xerr)) < 0)
+            goto done;
+        if (ret == 0){ /* Error reply replaces everything written so far */
+            cbuf_reset(cbret);
+            if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (xs == NULL)
+            continue;
+        /* Same per-tree processing as the merged path, see get_common */
+        if (xml_non_config_data(xs, NULL) < 0)
+            goto done;
+        if (xml_tree_prune_flagged_sub(xs, XML_FLAG_MARK, 1, NULL) < 0)
+            goto done;
+        if (xml_apply(xs, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+            goto done;
+        switch (wdef){
+        case WITHDEFAULTS_REPORT_ALL:
+        case WITHDEFAULTS_EXPLICIT:
+            /* Apply default values */
+            if (xml_default_recurse(xs, 1) < 0)
+                goto done;
+            break;
+        case WITHDEFAULTS_TRIM:
+            /* Mark and remove nodes having schema default values */
+            if (xml_apply(xs, CX_ELMNT, (xml_applyfn_t*)xml_flag_state_default_value, (void*)XML_FLAG_MARK) < 0)
+                goto done;
+            if (xml_tree_prune_flags(xs, XML_FLAG_MARK, XML_FLAG_MARK) < 0)
+                goto done;
+            if (xml_defaults_nopresence(xs, 1) < 0)
+                goto done;
+            break;
+        default: /* REPORT_ALL_TAGGED is excluded by the caller */
+            break;
+        }
+        if (xpath_vec(xs, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
+            goto done;
+        if (filter_xpath_again(h, yspec, xs, xvec, xlen, xpath, nsc) < 0)
+            goto done;
+        if (xnacm != NULL &&
+            nacm_datanode_read(h, xs, xvec, xlen, username, xnacm) < 0)
+            goto done;
+        /* Serialize children: they sit at the same level as children of <data> */
+        xc = NULL;
+        while ((xc = xml_child_each(xs, xc, CX_ELMNT)) != NULL)
+            if (clixon_xml2cbuf(cbret, xc, 0, 0, depth, 0) < 0)
+                goto done;
+        free(xvec);
+        xvec = NULL;
+        xml_free(xs);
+        xs = NULL;
+    }
+    cprintf(cbret, "</data></rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    if (xs)
+        xml_free(xs);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
 /*! Help function for parsing restconf query parameter and setting netconf attribute
  *
  * If not "unbounded", parse and set a numeric value
@@ -585,9 +704,13 @@ get_list_pagination(clicon_handle        h,
     int             ret;
     uint32_t        iddb; /* DBs lock, if any */
     int             locked;
-    cbuf           *cberr = NULL; 
+    cbuf           *cberr = NULL;
     cxobj         **xvec = NULL;
     size_t          xlen;
+    cxobj          *xcache;
+    cxobj         **xvec0 = NULL;
+    size_t          xlen0;
+    size_t          i;
 #ifdef NOTYET
     cxobj          *x;
     char           *direction = NULL;
@@ -663,7 +786,27 @@ get_list_pagination(clicon_handle        h,
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
     case CONTENT_ALL:       /* both config and state */
-        /* Build a "predicate" cbuf 
+        /* Fast path: if the datastore cache is present and yang-bound, evaluate the plain
+         * xpath once over the cache and slice the match vector directly. Entries are in
+         * sorted child vector order so the offset seek is index arithmetic and only the
+         * limited window is copied, instead of an xpath position() predicate that is
+         * evaluated against every entry of the list.
+         */
+        if ((xcache = xmldb_cache_get(h, db)) != NULL &&
+            xml_spec(xcache) != NULL &&
+            wdef == WITHDEFAULTS_REPORT_ALL){
+            if (xpath_vec(xcache, nsc, "%s", &xvec0, &xlen0, xpath?xpath:"/") < 0)
+                goto done;
+            if ((xret = xml_new(xml_name(xcache), NULL, CX_ELMNT)) == NULL)
+                goto done;
+            xml_flag_set(xret, XML_FLAG_TOP);
+            xml_spec_set(xret, xml_spec(xcache));
+            for (i = offset; i < xlen0 && (limit == 0 || i < (size_t)offset + limit); i++)
+                if (xmldb_cow_copy(xcache, xvec0[i], xret) < 0)
+                    goto done;
+            break;
+        }
+        /* Build a "predicate" cbuf
          * This solution uses xpath predicates to translate "limit" and "offset" to
          * relational operators <>.
          */
@@ -793,6 +936,8 @@ get_list_pagination(clicon_handle        h,
  done:
     if (xvec)
         free(xvec);
+    if (xvec0)
+        free(xvec0);
     if (cbmsg)
         cbuf_free(cbmsg);
     if (cbpath)
@@ -852,6 +997,8 @@ get_common(clicon_handle        h,
     uint32_t        limit = 0;
     withdefaults_type wdef;
     char             *wdefstr;
+    clixon_plugin_t **cpvec = NULL;
+    int               cplen = 0;
 
 #ifdef NETCONF_DEFAULT_RETRIEVAL_REPORT_ALL
     /* Clixon 6.0 backward compatibly for NETCONF get/get-config behavior */
@@ -927,6 +1074,30 @@ get_common(clicon_handle        h,
             goto done;
         goto ok;
     }
+    /* Streamed state get: with CLICON_STATEDATA_STREAM, plugins declaring
+     * exclusive subtree ownership are filtered and serialized one at a time
+     * into the reply instead of merged into one tree, see get_statedata_stream.
+     * Internal state providers (stream discovery, yang library, netconf
+     * monitoring) still need the merged path, as does validation of state XML.
+     */
+    if (content == CONTENT_NONCONFIG &&
+        clicon_option_bool(h, "CLICON_STATEDATA_STREAM") &&
+        !clicon_option_bool(h, "CLICON_VALIDATE_STATE_XML") &&
+        !clicon_option_bool(h, "CLICON_STREAM_DISCOVERY_RFC5277") &&
+        !clicon_option_bool(h, "CLICON_STREAM_DISCOVERY_RFC8040") &&
+        !clicon_option_bool(h, "CLICON_YANG_LIBRARY") &&
+        !clicon_option_bool(h, "CLICON_NETCONF_MONITORING") &&
+        wdef != WITHDEFAULTS_REPORT_ALL_TAGGED){
+        if ((ret = clixon_plugin_statedata_stream_plan(h, yspec, &cpvec, &cplen)) < 0)
+            goto done;
+        if (ret == 1){
+            if (get_statedata_stream(h, cpvec, cplen, xpath?xpath:"/", nsc, wdef,
+                                     username, depth, cbret) < 0)
+                goto done;
+            goto ok;
+        }
+        /* Not streamable: fall through to the merged-tree path */
+    }
     /* Read configuration */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
@@ -1037,6 +1208,8 @@ get_common(clicon_handle        h,
     retval = 0;
  done:
     clicon_debug(2, "%s retval:%d", __FUNCTION__, retval);
+    if (cpvec)
+        free(cpvec);
     if (xvec)
         free(xvec);
     if (xret)
@@ -1105,15 +1278,289 @@ int
 from_client_get(clicon_handle h,
                 cxobj        *xe,
                 cbuf         *cbret,
-                void         *arg, 
+                void         *arg,
                 void         *regarg)
 {
     netconf_content      content = CONTENT_ALL;
     char                *attr;
     struct client_entry *ce = (struct client_entry *)arg;
-    
+
     /* Clixon extensions: content */
     if ((attr = xml_find_value(xe, "content")) != NULL)
         content = netconf_content_str2int(attr);
     return get_common(h, ce, xe, content, "running", cbret);
 }
+
+/*! Return the leaf values matching an xpath, typically list keys for completion
+ *
+ * Unlike get-config, the reply carries only the matched values, served
+ * straight from the resident datastore cache without tree copy, defaults or
+ * state, so completing a key among many entries is O(matches) in reply size.
+ * Namespace prefixes in the xpath are resolved against declarations in scope
+ * on the <xpath> element. Adjacent duplicate values are folded (sorted order).
+ * NACM data-node read rules are not applied here: with NACM enabled the rpc
+ * is refused so that clients fall back to the filtered get-config path.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see expand_dbvar  CLI completion client
+ */
+int
+from_client_list_keys(clicon_handle h,
+                      cxobj        *xe,
+                      cbuf         *cbret,
+                      void         *arg,
+                      void         *regarg)
+{
+    int        retval = -1;
+    char      *db;
+    cxobj     *xx;
+    char      *xpath0;
+    char      *xpath = NULL;
+    cvec      *nsc0 = NULL;
+    cvec      *nsc = NULL;
+    cbuf      *cbreason = NULL;
+    yang_stmt *yspec;
+    cxobj     *xt;
+    cxobj     *xcopy = NULL;
+    cxobj    **xvec = NULL;
+    size_t     xlen = 0;
+    char      *body;
+    char      *prev;
+    char      *nacm_mode;
+    int        ret;
+    int        i;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    nacm_mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    if (nacm_mode && strcmp(nacm_mode, "disabled") != 0){
+        if (netconf_operation_not_supported(cbret, "application",
+                                            "list-keys is not supported with NACM enabled") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((db = xml_find_body(xe, "datastore")) == NULL){
+        if (netconf_missing_element(cbret, "application", "datastore", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((xx = xml_find_type(xe, NULL, "xpath", CX_ELMNT)) == NULL ||
+        (xpath0 = xml_body(xx)) == NULL){
+        if (netconf_missing_element(cbret, "application", "xpath", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xml_nsctx_node(xx, &nsc0) < 0)
+        goto done;
+    if ((ret = xpath2canonical(xpath0, nsc0, yspec, &xpath, &nsc, &cbreason)) < 0)
+        goto done;
+    if (ret == 0){
+        if (netconf_bad_element(cbret, "application", "xpath", cbuf_get(cbreason)) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Serve from the datastore cache when resident, read-only: no copy needed */
+    if ((xt = xmldb_cache_get(h, db)) == NULL){
+        if (xmldb_get0(h, db, YB_MODULE, nsc, xpath, 1, WITHDEFAULTS_EXPLICIT, &xcopy, NULL, NULL) < 0){
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+                goto done;
+            goto ok;
+        }
+        xt = xcopy;
+    }
+    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, xpath) < 0)
+        goto done;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\" xmlns:%s=\"%s\">",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    prev = NULL;
+    for (i = 0; i < xlen; i++){
+        if ((body = xml_body(xvec[i])) == NULL)
+            continue;
+        if (prev && strcmp(prev, body) == 0)
+            continue; /* duplicate, adjacent in sorted order */
+        prev = body;
+        cprintf(cbret, "<%s:value>", CLIXON_LIB_PREFIX);
+        if (xml_chardata_cbuf_append(cbret, body) < 0)
+            goto done;
+        cprintf(cbret, "</%s:value>", CLIXON_LIB_PREFIX);
+    }
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    if (xcopy)
+        xml_free(xcopy);
+    if (cbreason)
+        cbuf_free(cbreason);
+    if (nsc0)
+        xml_nsctx_free(nsc0);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xpath)
+        free(xpath);
+    return retval;
+}
+
+/*! Return the delta between two datastores as pruned config trees
+ *
+ * The diff is computed in the backend with xml_diff over the resident trees
+ * and only the differing subtrees, with ancestors and list keys for context,
+ * are returned. A CLI "show compare" thereby transfers the pending change
+ * instead of two full configurations.
+ * As with list-keys, NACM data-node read rules are not applied here: with
+ * NACM enabled the rpc is refused so that clients fall back to get-config.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see compare_dbs  CLI client
+ * @see xml_copy_marked
+ */
+int
+from_client_datastore_diff(clicon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
+{
+    int        retval = -1;
+    char      *db1;
+    char      *db2;
+    char      *nacm_mode;
+    yang_stmt *yspec;
+    cxobj     *x1 = NULL;    /* source tree, possibly cache: do not prune */
+    cxobj     *x2 = NULL;    /* target tree, possibly cache: do not prune */
+    cxobj     *xc1 = NULL;   /* pruned copy of differing source subtrees */
+    cxobj     *xc2 = NULL;   /* pruned copy of differing target subtrees */
+    cxobj    **dvec = NULL;  /* removed: only in source */
+    int        dlen = 0;
+    cxobj    **avec = NULL;  /* added: only in target */
+    int        alen = 0;
+    cxobj    **scvec = NULL; /* changed: source values */
+    cxobj    **tcvec = NULL; /* changed: target values */
+    int        clen = 0;
+    cxobj     *xn;
+    int        i;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    nacm_mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    if (nacm_mode && strcmp(nacm_mode, "disabled") != 0){
+        if (netconf_operation_not_supported(cbret, "application",
+                                            "datastore-diff is not supported with NACM enabled") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((db1 = xml_find_body(xe, "source")) == NULL){
+        if (netconf_missing_element(cbret, "application", "source", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((db2 = xml_find_body(xe, "target")) == NULL){
+        if (netconf_missing_element(cbret, "application", "target", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if (xmldb_validate_db(db1) < 0 || xmldb_validate_db(db2) < 0){
+        if (netconf_bad_element(cbret, "application", "source", "No such database") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = xmldb_get0(h, db1, YB_MODULE, NULL, "/", 0, 0, &x1, NULL, NULL)) < 0 ||
+        ret == 0){
+        if (netconf_operation_failed(cbret, "application", "Failed to read source datastore") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = xmldb_get0(h, db2, YB_MODULE, NULL, "/", 0, 0, &x2, NULL, NULL)) < 0 ||
+        ret == 0){
+        if (netconf_operation_failed(cbret, "application", "Failed to read target datastore") < 0)
+            goto done;
+        goto ok;
+    }
+    /* Clear diff/mark flags: stale ones would inflate the copy below */
+    xml_apply0(x1, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE|XML_FLAG_ADD|XML_FLAG_DEL));
+    xml_apply0(x2, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+               (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE|XML_FLAG_ADD|XML_FLAG_DEL));
+    if (xml_diff(yspec, x1, x2,
+                 &dvec, &dlen,
+                 &avec, &alen,
+                 &scvec, &tcvec, &clen) < 0)
+        goto done;
+    /* Mark differing nodes, ancestors with CHANGE for xml_copy_marked */
+    for (i=0; i<dlen; i++){
+        xn = dvec[i];
+        xml_flag_set(xn, XML_FLAG_MARK);
+        xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    for (i=0; i<alen; i++){
+        xn = avec[i];
+        xml_flag_set(xn, XML_FLAG_MARK);
+        xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    for (i=0; i<clen; i++){
+        xn = scvec[i];
+        xml_flag_set(xn, XML_FLAG_MARK);
+        xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+        xn = tcvec[i];
+        xml_flag_set(xn, XML_FLAG_MARK);
+        xml_apply_ancestor(xn, (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+    }
+    if ((xc1 = xml_new("source-config", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_copy_marked(x1, xc1) < 0)
+        goto done;
+    if ((xc2 = xml_new("target-config", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_copy_marked(x2, xc2) < 0)
+        goto done;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    if (clixon_xml2cbuf(cbret, xc1, 0, 0, -1, 0) < 0)
+        goto done;
+    if (clixon_xml2cbuf(cbret, xc2, 0, 0, -1, 0) < 0)
+        goto done;
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    /* Clear flags set above: the trees may be shared with the cache */
+    if (x1)
+        xml_apply0(x1, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                   (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    if (x2)
+        xml_apply0(x2, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                   (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
+    if (x1)
+        xmldb_get0_free(h, &x1);
+    if (x2)
+        xmldb_get0_free(h, &x2);
+    if (xc1)
+        xml_free(xc1);
+    if (xc2)
+        xml_free(xc2);
+    if (dvec)
+        free(dvec);
+    if (avec)
+        free(avec);
+    if (scvec)
+        free(scvec);
+    if (tcvec)
+        free(tcvec);
+    return retval;
+}
@@ -132,7 +132,10 @@ backend_terminate(clicon_handle h)
     clixon_process_delete_all(h); 
 
     xpath_optimize_exit();
+    /* After all XML trees with interned names are freed */
+    xml_intern_exit();
     clixon_pagination_free(h);
+    clixon_statedata_cache_invalidate(h);
     if (pidfile)
         unlink(pidfile);   
     if (sockfamily==AF_UNIX && lstat(sockpath, &st) == 0)
@@ -243,9 +246,51 @@ nacm_load_external(clicon_handle h)
     return retval;
 }
 
-static int 
-xmldb_drop_priv(clicon_handle h, 
-                const char   *db, 
+/*! Hint the kernel to read the startup datastore into the page cache
+ *
+ * The yang spec parse that follows is CPU bound and the datastore parse after
+ * it cannot start earlier since binding needs the schema and the library is
+ * single-threaded, see xmldb_readfile. The file IO can overlap though: an
+ * asynchronous readahead issued before the yang parse has the db file resident
+ * by the time startup_mode_startup lexes it, taking the disk wait out of the
+ * serial restart path.
+ * @param[in]  h  Clicon handle
+ * @retval     0  OK, the hint itself is best effort
+ * @retval    -1  Error
+ */
+static int
+backend_db_readahead(clicon_handle h)
+{
+    int                  retval = -1;
+    enum startup_mode_t  mode;
+    const char          *db;
+    char                *filename = NULL;
+    int                  fd;
+
+    mode = clicon_startup_mode(h);
+    if (mode == SM_STARTUP || mode == SM_RUNNING_STARTUP)
+        db = "startup";
+    else if (mode == SM_RUNNING)
+        db = "running";
+    else
+        goto ok; /* SM_NONE/SM_INIT read no db at startup */
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((fd = open(filename, O_RDONLY)) >= 0){
+        (void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+ ok:
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+static int
+xmldb_drop_priv(clicon_handle h,
+                const char   *db,
                 uid_t         uid,
                 gid_t         gid)
 {
@@ -507,14 +552,12 @@ main(int    argc,
     char         *nacm_mode;
     int           logdst = CLICON_LOG_SYSLOG|CLICON_LOG_STDERR;
     yang_stmt    *yspec = NULL;
-    char         *str;
     int           ss = -1; /* server socket */
     cbuf         *cbret = NULL; /* startup cbuf if invalid */
     enum startup_status status = STARTUP_ERR; /* Startup status */
     int           ret;
     char         *dir;
     gid_t         gid = -1;
-    cvec         *nsctx_global = NULL; /* Global namespace context */
     size_t        cligen_buflen;
     size_t        cligen_bufthreshold;
     int           dbg;
@@ -703,7 +746,18 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(sz);
-    
+
+    /* Cap incoming IPC message size, oversized messages are rejected with a
+     * resource-denied error instead of being allocated, see from_client */
+    if ((sz = clicon_option_int(h, "CLICON_MESSAGE_SIZE_LIMIT")) > 0)
+        clicon_msg_rcv_limit_set(sz);
+
+    /* Intern XML element names/prefixes in a shared table, see xml_intern_set.
+     * Freed in backend_terminate after all trees are freed */
+    if (clicon_option_bool(h, "CLICON_XML_INTERN"))
+        if (xml_intern_set(1) < 0)
+            goto done;
+
 #ifndef HAVE_LIBXML2
     if (clicon_yang_regexp(h) ==  REGEXP_LIBXML2){
         clicon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to libxml2, but HAVE_LIBXML2 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-libxml2))");
@@ -772,6 +826,10 @@ main(int    argc,
     if (xmldb_connect(h) < 0)
         goto done;
 
+    /* Overlap the startup db file IO with the yang parse below */
+    if (backend_db_readahead(h) < 0)
+        goto done;
+
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
     
@@ -803,48 +861,10 @@ main(int    argc,
                             clicon_option_str(h, "CLICON_BACKEND_REGEXP")) < 0)
         goto done;
 
-    /* Load Yang modules
-     * 1. Load a yang module as a specific absolute filename */
-    if ((str = clicon_yang_main_file(h)) != NULL)
-        if (yang_spec_parse_file(h, str, yspec) < 0)
-            goto done;
-    /* 2. Load a (single) main module */
-    if ((str = clicon_yang_module_main(h)) != NULL)
-        if (yang_spec_parse_module(h, str, clicon_yang_module_revision(h),
-                                   yspec) < 0)
-            goto done;
-    /* 3. Load all modules in a directory (will not overwrite file loaded ^) */
-    if ((str = clicon_yang_main_dir(h)) != NULL)
-        if (yang_spec_load_dir(h, str, yspec) < 0)
-            goto done;
-    /* Load clixon lib yang module */
-    if (yang_spec_parse_module(h, "clixon-lib", NULL, yspec) < 0)
-        goto done;
-    /* Load yang module library, RFC7895 */
-    if (yang_modules_init(h) < 0)
-        goto done;
-    /* Add generic yang specs, used by netconf client and as internal protocol 
+    /* Load all yang modules and set the canonical namespace context,
+     * shared with the reload-yang RPC, see backend_yang_load
      */
-    if (netconf_module_load(h) < 0)
-        goto done;
-    /* Load yang restconf module */
-    if (yang_spec_parse_module(h, "ietf-restconf", NULL, yspec)< 0)
-        goto done;
-    /* Load yang YANG module state */
-    if (clicon_option_bool(h, "CLICON_XMLDB_MODSTATE") &&
-        yang_spec_parse_module(h, "ietf-yang-library", NULL, yspec)< 0)
-        goto done;
-    /* Check restconf start/stop from backend */
-    if (clicon_option_bool(h, "CLICON_BACKEND_RESTCONF_PROCESS")){
-        if (backend_plugin_restconf_register(h, yspec) < 0)
-            goto done;
-    }
-    /* Here all modules are loaded 
-     * Compute and set canonical namespace context
-     */
-    if (xml_nsctx_yangspec(yspec, &nsctx_global) < 0)
-        goto done;
-    if (clicon_nsctx_global_set(h, nsctx_global) < 0)
+    if (backend_yang_load(h, yspec) < 0)
         goto done;
 
     /* Initialize server socket and save it to handle */
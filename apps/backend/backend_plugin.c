@@ -51,6 +51,7 @@
 #include <syslog.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/param.h>
 #include <netinet/in.h>
 
@@ -249,6 +250,193 @@ clixon_plugin_daemon_all(clicon_handle h)
     return retval;
 }
 
+/*
+ * Cache of plugin statedata replies, for plugins that declare a TTL via
+ * ca_statedata_ttl. Entries hold the processed (yang-bound, sorted,
+ * default-stripped) tree so a hit skips both the plugin invocation and the
+ * post-processing. Keyed on plugin name, xpath and namespace context; stored
+ * on the handle, invalidated by TTL expiry and on commit
+ */
+#define STATEDATA_CACHE_MAX 32 /* Entries over all plugins, oldest is evicted */
+
+struct statedata_cache{
+    struct statedata_cache *sc_next;
+    char                   *sc_key;  /* plugin name + xpath + namespace context */
+    cxobj                  *sc_xml;  /* processed statedata tree */
+    struct timeval          sc_time; /* when cached, for TTL expiry */
+};
+
+/*! Build the cache key from plugin name, xpath and namespace context
+ */
+static int
+statedata_cache_key(cbuf       *cb,
+                    const char *plugin,
+                    const char *xpath,
+                    cvec       *nsc)
+{
+    cg_var *cv = NULL;
+
+    cprintf(cb, "%s|%s|", plugin, xpath?xpath:"");
+    while (nsc && (cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, "%s=%s;", cv_name_get(cv)?cv_name_get(cv):"", cv_string_get(cv));
+    return 0;
+}
+
+/*! Look up a fresh cached statedata reply for one plugin call
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  plugin  Plugin name
+ * @param[in]  xpath   XPath of the call
+ * @param[in]  nsc     Namespace context of the call
+ * @param[in]  ttl     Plugin-declared cache lifetime in seconds
+ * @param[out] xp      Copy of cached tree if hit, owned by caller
+ * @retval     0       OK, xp set on hit, untouched on miss
+ * @retval    -1       Error
+ */
+static int
+statedata_cache_get(clicon_handle h,
+                    const char   *plugin,
+                    const char   *xpath,
+                    cvec         *nsc,
+                    int           ttl,
+                    cxobj       **xp)
+{
+    int                     retval = -1;
+    struct statedata_cache *sc;
+    cbuf                   *cb = NULL;
+    struct timeval          now;
+    cxobj                  *x;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    statedata_cache_key(cb, plugin, xpath, nsc);
+    sc = NULL;
+    clicon_ptr_get(h, "statedata-cache", (void**)&sc);
+    gettimeofday(&now, NULL);
+    for (; sc; sc = sc->sc_next){
+        if (strcmp(sc->sc_key, cbuf_get(cb)) != 0)
+            continue;
+        if (now.tv_sec - sc->sc_time.tv_sec >= ttl)
+            break; /* expired, will be replaced at next set */
+        if ((x = xml_new(xml_name(sc->sc_xml), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_flag_set(x, XML_FLAG_TOP);
+        if (xml_copy(sc->sc_xml, x) < 0){
+            xml_free(x);
+            goto done;
+        }
+        *xp = x;
+        break;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Cache the processed statedata reply of one plugin call
+ *
+ * An existing entry with the same key is replaced; when the cache is full the
+ * last (oldest, entries are prepended) entry is evicted.
+ * @param[in]  h       Clixon handle
+ * @param[in]  plugin  Plugin name
+ * @param[in]  xpath   XPath of the call
+ * @param[in]  nsc     Namespace context of the call
+ * @param[in]  x       Processed statedata tree, a copy is stored
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+statedata_cache_set(clicon_handle h,
+                    const char   *plugin,
+                    const char   *xpath,
+                    cvec         *nsc,
+                    cxobj        *x)
+{
+    int                      retval = -1;
+    struct statedata_cache  *head = NULL;
+    struct statedata_cache  *sc;
+    struct statedata_cache **scp;
+    cbuf                    *cb = NULL;
+    cxobj                   *xcopy = NULL;
+    int                      nr = 0;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    statedata_cache_key(cb, plugin, xpath, nsc);
+    if ((xcopy = xml_new(xml_name(x), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_flag_set(xcopy, XML_FLAG_TOP);
+    if (xml_copy(x, xcopy) < 0)
+        goto done;
+    clicon_ptr_get(h, "statedata-cache", (void**)&head);
+    /* Remove existing entry with same key, count entries, find tail */
+    for (scp = &head; (sc = *scp) != NULL; ){
+        if (strcmp(sc->sc_key, cbuf_get(cb)) == 0 ||
+            (++nr >= STATEDATA_CACHE_MAX && sc->sc_next == NULL)){
+            *scp = sc->sc_next;
+            free(sc->sc_key);
+            xml_free(sc->sc_xml);
+            free(sc);
+            continue;
+        }
+        scp = &sc->sc_next;
+    }
+    if ((sc = malloc(sizeof(*sc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sc, 0, sizeof(*sc));
+    if ((sc->sc_key = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(sc);
+        goto done;
+    }
+    sc->sc_xml = xcopy;
+    xcopy = NULL;
+    gettimeofday(&sc->sc_time, NULL);
+    sc->sc_next = head;
+    if (clicon_ptr_set(h, "statedata-cache", sc) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xcopy)
+        xml_free(xcopy);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Drop all cached statedata replies
+ *
+ * Called on commit: configuration changes may change what the plugins would
+ * report, regardless of remaining TTL. Also used at backend termination.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+clixon_statedata_cache_invalidate(clicon_handle h)
+{
+    struct statedata_cache *sc = NULL;
+    struct statedata_cache *next;
+
+    clicon_ptr_get(h, "statedata-cache", (void**)&sc);
+    while (sc){
+        next = sc->sc_next;
+        free(sc->sc_key);
+        xml_free(sc->sc_xml);
+        free(sc);
+        sc = next;
+    }
+    clicon_ptr_set(h, "statedata-cache", NULL);
+    return 0;
+}
+
 /*! Call single backend statedata callback
  *
  * Create an xml state tree (xret) for one callback only on the form:
@@ -313,9 +501,107 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     goto done;
 }
 
+/*! Get and post-process the statedata reply of one plugin, via cache if declared
+ *
+ * Calls the statedata callback (or serves the processed reply from cache, see
+ * ca_statedata_ttl), binds the returned tree to yang, sorts it and strips
+ * global defaults and empty non-presence containers.
+ * @param[in]  h      Clixon handle
+ * @param[in]  cp     Plugin
+ * @param[in]  yspec  Yang spec
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  String with XPATH syntax, or NULL for all
+ * @param[out] xp     Processed state tree: <config>..., NULL if plugin returned none
+ * @param[out] xerr   Netconf error tree if retval is 0, owned by caller
+ * @retval     1      OK, xp set (or NULL)
+ * @retval     0      Statedata callback failed or returned invalid XML, xerr set
+ * @retval    -1      Error
+ */
+int
+clixon_plugin_statedata_get_one(clicon_handle    h,
+                                clixon_plugin_t *cp,
+                                yang_stmt       *yspec,
+                                cvec            *nsc,
+                                char            *xpath,
+                                cxobj          **xp,
+                                cxobj          **xerr)
+{
+    int    retval = -1;
+    int    ret;
+    int    ttl;
+    cxobj *x = NULL;
+    cbuf  *cberr = NULL;
+
+    *xp = NULL;
+    ttl = clixon_plugin_api_get(cp)->ca_statedata_ttl;
+    if (ttl > 0){
+        if (statedata_cache_get(h, clixon_plugin_name_get(cp), xpath, nsc, ttl, &x) < 0)
+            goto done;
+        if (x != NULL){ /* Cache hit: tree is already processed */
+            *xp = x;
+            x = NULL;
+            goto ok;
+        }
+    }
+    if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
+        goto done;
+    if (ret == 0){
+        if ((cberr = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        /* error reason should be in clicon_err_reason */
+        cprintf(cberr, "Internal error, state callback in plugin %s returned invalid XML: %s",
+                clixon_plugin_name_get(cp), clicon_err_reason);
+        if (netconf_operation_failed_xml(xerr, "application", cbuf_get(cberr)) < 0)
+            goto done;
+        goto fail;
+    }
+    if (x == NULL)
+        goto ok;
+    if (xml_child_nr(x) == 0){
+        xml_free(x);
+        x = NULL;
+        goto ok;
+    }
+    clicon_debug_xml(2, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
+    /* XXX: ret == 0 invalid yang binding should be handled as internal error */
+    if ((ret = xml_bind_yang(x, YB_MODULE, yspec, xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_netconf_internal_error(*xerr,
+                                          ". Internal error, state callback returned invalid XML from plugin: ",
+                                          clixon_plugin_name_get(cp)) < 0)
+            goto done;
+        goto fail;
+    }
+    if (xml_sort_recurse(x) < 0)
+        goto done;
+    /* Remove global defaults and empty non-presence containers */
+    /* XXX: only for state data and according to with-defaults setting */
+    if (xml_defaults_nopresence(x, 2) < 0)
+        goto done;
+    if (ttl > 0 &&
+        statedata_cache_set(h, clixon_plugin_name_get(cp), xpath, nsc, x) < 0)
+        goto done;
+    *xp = x;
+    x = NULL;
+ ok:
+    retval = 1;
+ done:
+    if (cberr)
+        cbuf_free(cberr);
+    if (x)
+        xml_free(x);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  * This is internal system call, plugin is invoked (does not call) this function
- * Backend plugins can register 
+ * Backend plugins can register
  * @param[in]     h       clicon handle
  * @param[in]     yspec   Yang spec
  * @param[in]     nsc     Namespace context
@@ -339,23 +625,13 @@ clixon_plugin_statedata_all(clicon_handle   h,
     int              ret;
     cxobj           *x = NULL;
     clixon_plugin_t *cp = NULL;
-    cbuf            *cberr = NULL; 
     cxobj           *xerr = NULL;
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
-        if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
+        if ((ret = clixon_plugin_statedata_get_one(h, cp, yspec, nsc, xpath, &x, &xerr)) < 0)
             goto done;
         if (ret == 0){
-            if ((cberr = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
-            /* error reason should be in clicon_err_reason */
-            cprintf(cberr, "Internal error, state callback in plugin %s returned invalid XML: %s",
-                    clixon_plugin_name_get(cp), clicon_err_reason);
-            if (netconf_operation_failed_xml(&xerr, "application", cbuf_get(cberr)) < 0)
-                goto done;
             xml_free(*xret);
             *xret = xerr;
             xerr = NULL;
@@ -363,46 +639,17 @@ clixon_plugin_statedata_all(clicon_handle   h,
         }
         if (x == NULL)
             continue;
-        if (xml_child_nr(x) == 0){
-            xml_free(x);
-            x = NULL;
-            continue;
-        }
-        clicon_debug_xml(2, x, "%s %s STATE:", __FUNCTION__, clixon_plugin_name_get(cp));
-        /* XXX: ret == 0 invalid yang binding should be handled as internal error */
-        if ((ret = xml_bind_yang(x, YB_MODULE, yspec, &xerr)) < 0)
-            goto done;
-        if (ret == 0){
-            if (clixon_netconf_internal_error(xerr,
-                                              ". Internal error, state callback returned invalid XML from plugin: ",
-                                              clixon_plugin_name_get(cp)) < 0)
-                goto done;
-            xml_free(*xret);
-            *xret = xerr;
-            xerr = NULL;
-            goto fail;
-        }
-        if (xml_sort_recurse(x) < 0)
-            goto done;
-        /* Remove global defaults and empty non-presence containers */
-        /* XXX: only for state data and according to with-defaults setting */
-        if (xml_defaults_nopresence(x, 2) < 0)
-            goto done;
         if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
-        if (x){
-            xml_free(x);
-            x = NULL;
-        }
+        xml_free(x);
+        x = NULL;
     } /* while plugin */
     retval = 1;
  done:
     if (xerr)
         xml_free(xerr);
-    if (cberr)
-        cbuf_free(cberr);
     if (x)
         xml_free(x);
     return retval;
@@ -411,6 +658,107 @@ clixon_plugin_statedata_all(clicon_handle   h,
     goto done;
 }
 
+/*! Order statedata plugins by the subtree they declare to own, if streamable
+ *
+ * The streamed state get serializes one plugin reply at a time instead of
+ * merging them into one tree, which is only correct if every statedata plugin
+ * declares exclusive ownership of a distinct top-level subtree, see
+ * ca_statedata_subtree. Plugins are returned ordered by the yang order of the
+ * declared node so the reply keeps the same element order as a sorted merged
+ * tree.
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @param[out] cpv    Malloced vector of statedata plugins in reply order
+ * @param[out] cplen  Length of cpv
+ * @retval     1      Streamable, cpv/cplen set (cpv NULL if no statedata plugins)
+ * @retval     0      Not streamable: some plugin declares no (or an unresolvable
+ *                    or duplicate) subtree, use the merged path
+ * @retval    -1      Error
+ */
+int
+clixon_plugin_statedata_stream_plan(clicon_handle     h,
+                                    yang_stmt        *yspec,
+                                    clixon_plugin_t ***cpv,
+                                    int              *cplen)
+{
+    int               retval = -1;
+    clixon_plugin_t  *cp = NULL;
+    clixon_plugin_t **vec = NULL;
+    int              *ordv = NULL;
+    int               len = 0;
+    int               nr = 0;
+    char             *subtree;
+    char             *node;
+    char             *modname = NULL;
+    yang_stmt        *ymod;
+    yang_stmt        *yn;
+    int               ord;
+    int               i;
+    int               j;
+
+    *cpv = NULL;
+    *cplen = 0;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL)
+        if (clixon_plugin_api_get(cp)->ca_statedata != NULL)
+            len++;
+    if (len == 0)
+        goto streamable;
+    if ((vec = calloc(len, sizeof(*vec))) == NULL ||
+        (ordv = calloc(len, sizeof(*ordv))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    cp = NULL;
+    while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        if (clixon_plugin_api_get(cp)->ca_statedata == NULL)
+            continue;
+        if ((subtree = clixon_plugin_api_get(cp)->ca_statedata_subtree) == NULL)
+            goto fail;
+        if ((node = strchr(subtree, ':')) == NULL)
+            goto fail;
+        if (modname)
+            free(modname);
+        if ((modname = strndup(subtree, node - subtree)) == NULL){
+            clicon_err(OE_UNIX, errno, "strndup");
+            goto done;
+        }
+        node++;
+        if ((ymod = yang_find_module_by_name(yspec, modname)) == NULL)
+            goto fail;
+        if ((yn = yang_find_datanode(ymod, node)) == NULL)
+            goto fail;
+        if ((ord = yang_order(yn)) < -1)
+            goto done;
+        for (i = 0; i < nr; i++)
+            if (ordv[i] == ord)
+                goto fail; /* duplicate declaration */
+        /* Insertion sort on yang order, few plugins expected */
+        for (i = nr; i > 0 && ordv[i-1] > ord; i--){
+            ordv[i] = ordv[i-1];
+            vec[i] = vec[i-1];
+        }
+        ordv[i] = ord;
+        vec[i] = cp;
+        nr++;
+    }
+    *cpv = vec;
+    vec = NULL;
+    *cplen = nr;
+ streamable:
+    retval = 1;
+ done:
+    if (modname)
+        free(modname);
+    if (ordv)
+        free(ordv);
+    if (vec)
+        free(vec);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Lock database status has changed status
  * @param[in]  cp      Plugin handle
  * @param[in]  h    Clixon handle
@@ -68,6 +68,7 @@
 #include "clixon_backend_transaction.h"
 #include "clixon_backend_plugin.h"
 #include "backend_handle.h"
+#include "backend_plugin_restconf.h"
 #include "clixon_backend_commit.h"
 #include "backend_startup.h"
 
@@ -96,6 +97,203 @@ db_merge(clicon_handle h,
     return retval;
 }
 
+/*! Write an XML tree as the complete contents of a database, without YANG binding
+ *
+ * Bypasses xmldb_put since the tree may not bind to YANG: failure to bind may
+ * be the very reason a subtree is being quarantined.
+ * @param[in] h   Clixon handle
+ * @param[in] db  Database name, previous content is overwritten
+ * @param[in] xt  XML tree, top node written as the datastore top symbol
+ * @retval    0   OK
+ * @retval   -1   Error
+ */
+static int
+db_write_unbound(clicon_handle h,
+                 const char   *db,
+                 cxobj        *xt)
+{
+    int   retval = -1;
+    char *filename = NULL;
+    FILE *f = NULL;
+
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((f = fopen(filename, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    if (clixon_xml2file(f, xt, 0, 0, fprintf, 0, 0) < 0)
+        goto done;
+    /* Drop any cached tree so the next read parses the file just written */
+    if (xmldb_clear(h, db) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Split an invalid startup db per top-level subtree and quarantine failures
+ *
+ * Called when the startup db failed validation as a whole and
+ * CLICON_STARTUP_QUARANTINE is enabled. Each top-level subtree is validated
+ * on its own in a scratch db through the full startup pipeline (upgrade
+ * callbacks, YANG bind, validation plugins). Failing subtrees are copied to
+ * the 'broken' datastore for operator inspection and repair, the remaining
+ * subtrees are committed to running so the system comes up with partial
+ * config instead of falling back to failsafe.
+ * The db file is read directly rather than via xmldb_get0 so that its
+ * recorded module-state is kept and replicated into every scratch db: the
+ * module-specific upgrade callbacks then see the same module set as a
+ * whole-db startup would.
+ * Validation is sequential: the backend is a single-threaded event loop.
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Startup db that failed validation as a whole
+ * @param[out] cbret  Error message if retval is 0
+ * @retval     1      OK, partial config committed, failures in 'broken' db
+ * @retval     0      Quarantine could not produce a committable config
+ * @retval    -1      Error
+ * @see startup_mode_startup  caller
+ */
+static int
+startup_quarantine(clicon_handle h,
+                   char         *db,
+                   cbuf         *cbret)
+{
+    int    retval = -1;
+    int    ret;
+    cxobj *xt = NULL;
+    cxobj *xval = NULL;
+    cxobj *xgood = NULL;
+    cxobj *xbroken = NULL;
+    cxobj *x;
+    cxobj *xc;
+    cxobj *xmodst;
+    cbuf  *cbsub = NULL;
+    char  *filename = NULL;
+    FILE  *fp = NULL;
+    char  *good_db = "quarantine";
+    char  *broken_db = "broken";
+    int    nbroken = 0;
+    int    ngood = 0;
+
+    if ((cbsub = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Read the db file raw: it did not bind as a whole, bind is per subtree */
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((fp = fopen(filename, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    if (clixon_xml_parse_file(fp, YB_NONE, NULL, &xt, NULL) < 0)
+        goto done;
+    /* Replace parse root with the single <config> top of the db file */
+    if (xml_rootchild(xt, 0, &xt) < 0)
+        goto done;
+    if (xt == NULL || xml_child_nr(xt) == 0)
+        goto fail;
+    /* Module-state of the file, replicated into every db written below */
+    xmodst = xml_find_type(xt, NULL, "modules-state", CX_ELMNT);
+    /* Validate each top-level subtree on its own in a scratch db */
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if (x == xmodst)
+            continue;
+        if ((xval = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xmodst){
+            if ((xc = xml_new(xml_name(xmodst), xval, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_copy(xmodst, xc) < 0)
+                goto done;
+        }
+        if ((xc = xml_new(xml_name(x), xval, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_copy(x, xc) < 0)
+            goto done;
+        if (db_write_unbound(h, good_db, xval) < 0)
+            goto done;
+        xml_free(xval);
+        xval = NULL;
+        cbuf_reset(cbsub);
+        if ((ret = startup_validate(h, good_db, NULL, cbsub)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_log(LOG_NOTICE, "Startup quarantine: top-level subtree %s is invalid, moving to db %s: %s",
+                       xml_name(x), broken_db, cbuf_get(cbsub));
+            xml_flag_set(x, XML_FLAG_MARK);
+            nbroken++;
+        }
+        else
+            ngood++;
+    }
+    if (nbroken == 0){
+        /* Whole-db validation failed but every subtree passes on its own:
+         * probably cross-subtree references, nothing useful to quarantine */
+        clicon_log(LOG_WARNING, "Startup quarantine: all %d top-level subtrees valid on their own, cannot quarantine", ngood);
+        goto fail;
+    }
+    /* Split into one tree per verdict, module-state goes into both */
+    if ((xgood = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((xbroken = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if (x == xmodst || !xml_flag(x, XML_FLAG_MARK)){
+            if ((xc = xml_new(xml_name(x), xgood, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_copy(x, xc) < 0)
+                goto done;
+        }
+        if (x == xmodst || xml_flag(x, XML_FLAG_MARK)){
+            if ((xc = xml_new(xml_name(x), xbroken, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_copy(x, xc) < 0)
+                goto done;
+        }
+    }
+    if (db_write_unbound(h, broken_db, xbroken) < 0)
+        goto done;
+    if (db_write_unbound(h, good_db, xgood) < 0)
+        goto done;
+    /* Commit the valid remainder through the normal startup pipeline */
+    if ((ret = startup_commit(h, good_db, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    clicon_log(LOG_NOTICE, "Startup quarantine: %d top-level subtree(s) committed, %d quarantined in db %s",
+               ngood, nbroken, broken_db);
+    cbuf_reset(cbret); /* holds the whole-db error, superseded by quarantine */
+    retval = 1;
+ done:
+    xmldb_delete(h, good_db);
+    if (fp)
+        fclose(fp);
+    if (filename)
+        free(filename);
+    if (cbsub)
+        cbuf_free(cbsub);
+    if (xval)
+        xml_free(xval);
+    if (xgood)
+        xml_free(xgood);
+    if (xbroken)
+        xml_free(xbroken);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Clixon startup startup mode: Commit startup configuration into running state
  * @param[in]  h       Clixon handle
  * @param[in]  db      tmp or startup
@@ -183,15 +381,29 @@ startup_mode_startup(clicon_handle        h,
         else {
             if ((ret = startup_commit(h, db, cbret)) < 0)
                 goto done;
-            if (ret == 0)
-                goto fail;
+            if (ret == 0){
+                if (!clicon_option_bool(h, "CLICON_STARTUP_QUARANTINE"))
+                    goto fail;
+                /* Re-validate per top-level subtree, quarantine failures */
+                if ((ret = startup_quarantine(h, db, cbret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
         }
     }
     else {
         if ((ret = startup_commit(h, db, cbret)) < 0)
             goto done;
-        if (ret == 0)
-            goto fail;
+        if (ret == 0){
+            if (!clicon_option_bool(h, "CLICON_STARTUP_QUARANTINE"))
+                goto fail;
+            /* Re-validate per top-level subtree, quarantine failures */
+            if ((ret = startup_quarantine(h, db, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
     }
  ok:
     retval = 1;
@@ -371,3 +583,76 @@ startup_module_state(clicon_handle h,
     retval = 0;
     goto done;
 }
+
+/*! Load all yang modules into a yang spec and set the canonical namespace context
+ *
+ * Factored from backend start so that the reload-yang RPC can build a fresh
+ * spec with the same load sequence. Several of the loaders read the spec
+ * from the handle, so clicon_dbspec_yang must point at yspec when called.
+ * @param[in]  h      Clicon handle, dbspec must be set to yspec
+ * @param[in]  yspec  Yang spec to load modules into
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see from_client_reload_yang
+ */
+int
+backend_yang_load(clicon_handle h,
+                  yang_stmt    *yspec)
+{
+    int   retval = -1;
+    char *str;
+    cvec *nsctx_global = NULL; /* Global namespace context */
+
+    /* Load Yang modules
+     * 1. Load a yang module as a specific absolute filename */
+    if ((str = clicon_yang_main_file(h)) != NULL)
+        if (yang_spec_parse_file(h, str, yspec) < 0)
+            goto done;
+    /* 2. Load a (single) main module */
+    if ((str = clicon_yang_module_main(h)) != NULL)
+        if (yang_spec_parse_module(h, str, clicon_yang_module_revision(h),
+                                   yspec) < 0)
+            goto done;
+    /* 3. Load all modules in a directory (will not overwrite file loaded ^) */
+    if ((str = clicon_yang_main_dir(h)) != NULL)
+        if (yang_spec_load_dir(h, str, yspec) < 0)
+            goto done;
+    /* Load clixon lib yang module */
+    if (yang_spec_parse_module(h, "clixon-lib", NULL, yspec) < 0)
+        goto done;
+    /* Load yang module library, RFC7895 */
+    if (yang_modules_init(h) < 0)
+        goto done;
+    /* Add generic yang specs, used by netconf client and as internal protocol 
+     */
+    if (netconf_module_load(h) < 0)
+        goto done;
+    /* Load yang restconf module */
+    if (yang_spec_parse_module(h, "ietf-restconf", NULL, yspec)< 0)
+        goto done;
+    /* Load yang YANG module state */
+    if (clicon_option_bool(h, "CLICON_XMLDB_MODSTATE") &&
+        yang_spec_parse_module(h, "ietf-yang-library", NULL, yspec)< 0)
+        goto done;
+    /* Check restconf start/stop from backend */
+    if (clicon_option_bool(h, "CLICON_BACKEND_RESTCONF_PROCESS")){
+        if (backend_plugin_restconf_register(h, yspec) < 0)
+            goto done;
+    }
+    /* Here all modules are loaded
+     * Optionally compact the spec: drop doc statements, revision history and
+     * expanded grouping bodies
+     */
+    if (clicon_option_bool(h, "CLICON_YANG_COMPACT") &&
+        yang_compact(h, yspec) < 0)
+        goto done;
+    /* Compute and set canonical namespace context
+     */
+    if (xml_nsctx_yangspec(yspec, &nsctx_global) < 0)
+        goto done;
+    if (clicon_nsctx_global_set(h, nsctx_global) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
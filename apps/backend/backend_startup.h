@@ -45,5 +45,6 @@
 int startup_mode_startup(clicon_handle h, char *db, cbuf *cbret);
 int startup_extraxml(clicon_handle h, char *file, cbuf *cbret);
 int startup_module_state(clicon_handle h, yang_stmt *yspec);
+int backend_yang_load(clicon_handle h, yang_stmt *yspec);
 
 #endif  /* _BACKEND_STARTUP_H_ */
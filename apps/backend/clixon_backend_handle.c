@@ -186,6 +186,11 @@ backend_client_delete(clicon_handle        h,
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
+            if (ce->ce_outq)
+                cbuf_free(ce->ce_outq);
+            if (ce->ce_notify_pending)
+                free(ce->ce_notify_pending);
+            clicon_msg_rcv_buf_reset(&ce->ce_rcvbuf);
             free(ce);
             break;
         }
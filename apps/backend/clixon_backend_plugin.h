@@ -98,8 +98,13 @@ int clixon_plugin_reset_all(clicon_handle h, char *db);
 int clixon_plugin_pre_daemon_all(clicon_handle h);
 int clixon_plugin_daemon_all(clicon_handle h);
 
+int clixon_plugin_statedata_get_one(clicon_handle h, clixon_plugin_t *cp, yang_stmt *yspec,
+                                    cvec *nsc, char *xpath, cxobj **xp, cxobj **xerr);
 int clixon_plugin_statedata_all(clicon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath,
                                 withdefaults_type wdef, cxobj **xtop);
+int clixon_plugin_statedata_stream_plan(clicon_handle h, yang_stmt *yspec,
+                                        clixon_plugin_t ***cpv, int *cplen);
+int clixon_statedata_cache_invalidate(clicon_handle h);
 int clixon_plugin_lockdb_all(clicon_handle h, char *db, int lock, int id);
 
 int clixon_pagination_cb_register(clicon_handle h, handler_function fn, char *path, void *arg);
@@ -258,9 +258,142 @@ identityref_add_ns(cxobj *x,
     return retval;
 }
 
+/*! Session-local buffer of pending configuration edits
+ *
+ * Used when CLICON_CLI_EDIT_BATCH is enabled: cli_dbxml appends each edit here
+ * instead of sending one edit-config rpc per CLI command. The buffer is sent
+ * as a single edit-config-batch rpc at commit/validate/show boundaries.
+ * Stored on the clicon handle, see edit_batch_get.
+ * @see cli_edit_batch_flush
+ */
+struct cli_edit_batch {
+    cbuf    *eb_cb;   /* Accumulated <edit>...</edit> payloads */
+    uint32_t eb_nr;   /* Number of buffered edits */
+};
+
+/*! Get the session edit buffer from the handle, create it on first use
+ * @param[in]  h    Clicon handle
+ * @param[out] ebp  Edit buffer
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+edit_batch_get(clicon_handle          h,
+               struct cli_edit_batch **ebp)
+{
+    int                    retval = -1;
+    struct cli_edit_batch *eb = NULL;
+
+    clicon_ptr_get(h, "cli-edit-batch", (void**)&eb);
+    if (eb == NULL){
+        if ((eb = malloc(sizeof(*eb))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(eb, 0, sizeof(*eb));
+        if ((eb->eb_cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            free(eb);
+            goto done;
+        }
+        if (clicon_ptr_set(h, "cli-edit-batch", eb) < 0){
+            cbuf_free(eb->eb_cb);
+            free(eb);
+            goto done;
+        }
+    }
+    *ebp = eb;
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Append one rendered config payload to the session edit buffer
+ * @param[in]  h          Clicon handle
+ * @param[in]  configxml  XML string: <config>...</config> with operation attrs
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+static int
+edit_batch_append(clicon_handle h,
+                  char         *configxml)
+{
+    int                    retval = -1;
+    struct cli_edit_batch *eb = NULL;
+
+    if (edit_batch_get(h, &eb) < 0)
+        goto done;
+    cprintf(eb->eb_cb, "<edit><nr>%u</nr><operation>none</operation>%s</edit>",
+            eb->eb_nr, configxml);
+    eb->eb_nr++;
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Flush pending buffered edits as a single edit-config-batch rpc
+ *
+ * No-op if batching is disabled or the buffer is empty. The buffer is cleared
+ * also on error so that a failed edit is not resent on the next flush.
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see cli_dbxml  where edits are buffered
+ */
+int
+cli_edit_batch_flush(clicon_handle h)
+{
+    int                    retval = -1;
+    int                    ret;
+    struct cli_edit_batch *eb = NULL;
+
+    clicon_ptr_get(h, "cli-edit-batch", (void**)&eb);
+    if (eb == NULL || eb->eb_nr == 0)
+        goto ok;
+    ret = clicon_rpc_edit_config_batch(h, "candidate", cbuf_get(eb->eb_cb));
+    cbuf_reset(eb->eb_cb);
+    eb->eb_nr = 0;
+    if (ret < 0)
+        goto done;
+  ok:
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Discard pending buffered edits without sending them
+ * @param[in]  h    Clicon handle
+ * @retval     0    OK
+ */
+int
+cli_edit_batch_discard(clicon_handle h)
+{
+    struct cli_edit_batch *eb = NULL;
+
+    clicon_ptr_get(h, "cli-edit-batch", (void**)&eb);
+    if (eb != NULL){
+        cbuf_reset(eb->eb_cb);
+        eb->eb_nr = 0;
+    }
+    return 0;
+}
+
+/*! Explicit flush of buffered edits, for binding in a clispec
+ * @param[in]  h     Clicon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables
+ * @param[in]  argv  No arguments expected
+ */
+int
+cli_edit_flush(clicon_handle h,
+               cvec         *cvv,
+               cvec         *argv)
+{
+    return cli_edit_batch_flush(h);
+}
+
 /*! Modify xml datastore from a callback using xml key format strings
  * @param[in]  h     Clicon handle
- * @param[in]  cvv   Vector of cli string and instantiated variables 
+ * @param[in]  cvv   Vector of cli string and instantiated variables
  * @param[in]  argv  Vector. First element xml key format string, eg "/aaa/%s"
  * @param[in]  op    Operation to perform on database
  * @param[in]  nsctx Namespace context for last value added
@@ -373,7 +506,12 @@ cli_dbxml(clicon_handle       h,
     }
     if (clixon_xml2cbuf(cb, xtop, 0, 0, -1, 0) < 0)
         goto done;
-    if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
+    if (clicon_option_bool(h, "CLICON_CLI_EDIT_BATCH")){
+        /* Defer: buffered edits are sent as one rpc at the next flush boundary */
+        if (edit_batch_append(h, cbuf_get(cb)) < 0)
+            goto done;
+    }
+    else if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cb)) < 0)
         goto done;
     retval = 0;
  done:
@@ -709,7 +847,9 @@ cli_commit(clicon_handle h,
 
     persist = cvec_find_str(vars, "persist-val");
     persist_id = cvec_find_str(vars, "persist-id-val");
-    
+
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (clicon_rpc_commit(h, confirmed, cancel, timeout, persist, persist_id) < 1)
         goto done;
     retval = 0;
@@ -726,6 +866,8 @@ cli_validate(clicon_handle h,
 {
     int     retval = -1;
 
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (clicon_rpc_validate(h, "candidate") < 1)
         goto done;
     retval = 0;
@@ -823,6 +965,7 @@ compare_dbs(clicon_handle h,
     cxobj *xc2 = NULL; /* candidate xml */
     cxobj *xerr = NULL;
     int    retval = -1;
+    int    ret;
     enum format_enum format;
 
     if (cvec_len(argv) > 1){
@@ -833,6 +976,20 @@ compare_dbs(clicon_handle h,
         format = FORMAT_TEXT;
     else
         format = FORMAT_XML;
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
+    /* First try the backend-side diff which returns only the delta; falls
+     * back to fetching both full databases if the backend does not support
+     * the rpc (old backend or NACM enabled)
+     */
+    if ((ret = clicon_rpc_datastore_diff(h, "running", "candidate", &xc1, &xc2)) < 0)
+        goto done;
+    if (ret == 1){
+        if (compare_xmls(xc1, xc2, format) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     if (clicon_rpc_get_config(h, NULL, "running", "/", NULL, NULL, &xc1) < 0)
         goto done;
     if ((xerr = xpath_first(xc1, NULL, "/rpc-error")) != NULL){
@@ -1180,6 +1337,8 @@ discard_changes(clicon_handle h,
                 cvec         *cvv, 
                 cvec         *argv)
 {
+    /* Unsent buffered edits are dropped, not flushed */
+    cli_edit_batch_discard(h);
     return clicon_rpc_discard_changes(h);
 
 }
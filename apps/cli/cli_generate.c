@@ -90,7 +90,10 @@ You can see which CLISPEC it generates via clixon_cli -D 2:
 #include <fcntl.h>
 #include <syslog.h>
 #include <signal.h>
+#include <unistd.h>
 #include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -347,9 +350,10 @@ yang2cli_var_pattern(clicon_handle h,
     cg_var *cvp;
     char   *pattern;
     int     invert;
-    char   *posix = NULL;
+    char   *posix;
+    size_t  len;
     int     i;
-    
+
     mode = clicon_yang_regexp(h);
     cvp = NULL; /* Loop over compiled regexps */
     while ((cvp = cvec_each(patterns, cvp)) != NULL){
@@ -357,22 +361,20 @@ yang2cli_var_pattern(clicon_handle h,
         invert = cv_flag(cvp, V_INVERT);
         cprintf(cb, " regexp:%s\"", invert?"!":"");
         if (mode == REGEXP_POSIX){
-            posix = NULL;
-            if (regexp_xsd2posix(pattern, &posix) < 0)
+            /* Shared process-wide translation cache: common patterns (eg
+             * inet:ip-address) are translated once, not once per leaf */
+            if (regexp_xsd2posix_shared(pattern, &posix) < 0)
                 goto done;
-            for (i=0; i<strlen(posix); i++){
+            len = strlen(posix);
+            for (i=0; i<len; i++){
                 if (posix[i] == '\"')
                     cbuf_append(cb, '\\');
                 cbuf_append(cb, posix[i]);
             }
-            if (posix){
-                free(posix);
-                posix = NULL;
-            }
-
         }
         else{
-            for (i=0; i<strlen(pattern); i++){
+            len = strlen(pattern);
+            for (i=0; i<len; i++){
                 if (pattern[i] == '\"')
                     cbuf_append(cb, '\\');
                 cbuf_append(cb, pattern[i]);
@@ -382,8 +384,6 @@ yang2cli_var_pattern(clicon_handle h,
     }
     retval = 0;
  done:
-    if (posix)
-        free(posix);
     return retval;
 }
 
@@ -1298,8 +1298,195 @@ yang2cli_post(clicon_handle h,
     return retval;
 }
 
+/*! Fold a byte buffer into a 32-bit FNV-1a fingerprint
+ */
+static uint32_t
+autocli_fp32(uint32_t             fp,
+             const unsigned char *buf,
+             size_t               len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++){
+        fp ^= buf[i];
+        fp *= 16777619u;
+    }
+    return fp;
+}
+
+/*! Compute cache key for generated clispecs: yang spec + autocli config
+ *
+ * Covers name, revision and source file identity (size+mtime) of every loaded
+ * module, the clixon-autocli configuration and the tree name, so a change in
+ * any of them invalidates all cached entries. A single spec-wide key is used
+ * even though entries are per-module, since augments and imports make one
+ * module's generated CLI depend on others.
+ * @param[in]  h         Clixon handle
+ * @param[in]  yspec     Top-level Yang statement of type Y_SPEC
+ * @param[in]  treename  Name of tree
+ * @param[out] fpp       Fingerprint
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+autocli_cache_fp(clicon_handle h,
+                 yang_stmt    *yspec,
+                 char         *treename,
+                 uint32_t     *fpp)
+{
+    int         retval = -1;
+    uint32_t    fp = 2166136261u; /* FNV-1a offset basis */
+    yang_stmt  *ymod = NULL;
+    yang_stmt  *yrev;
+    char       *str;
+    const char *filename;
+    struct stat st;
+    cxobj      *xautocli;
+    cbuf       *cb = NULL;
+
+    while ((ymod = yn_each(yspec, ymod)) != NULL){
+        if ((str = yang_argument_get(ymod)) != NULL)
+            fp = autocli_fp32(fp, (unsigned char*)str, strlen(str)+1);
+        if ((yrev = yang_find(ymod, Y_REVISION, NULL)) != NULL &&
+            (str = yang_argument_get(yrev)) != NULL)
+            fp = autocli_fp32(fp, (unsigned char*)str, strlen(str)+1);
+        if ((filename = yang_filename_get(ymod)) != NULL){
+            fp = autocli_fp32(fp, (unsigned char*)filename, strlen(filename)+1);
+            if (stat(filename, &st) == 0){
+                fp = autocli_fp32(fp, (unsigned char*)&st.st_size, sizeof(st.st_size));
+                fp = autocli_fp32(fp, (unsigned char*)&st.st_mtime, sizeof(st.st_mtime));
+            }
+        }
+    }
+    if ((xautocli = clicon_conf_autocli(h)) != NULL){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cb, xautocli, 0, 0, -1, 0) < 0)
+            goto done;
+        fp = autocli_fp32(fp, (unsigned char*)cbuf_get(cb), cbuf_len(cb));
+    }
+    fp = autocli_fp32(fp, (unsigned char*)treename, strlen(treename)+1);
+    *fpp = fp;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Map the generated clispec of one module from the disk cache
+ *
+ * The entry is mapped read-only and shared, not copied: concurrently starting
+ * CLI sessions then share the text pages via the page cache instead of each
+ * holding a private heap copy during parse. Entries are stored with a NUL
+ * trailer (see autocli_cache_store) so the mapping can be handed to
+ * cligen_parse_str in place; entries without it predate the trailer and are
+ * treated as misses so they get rewritten.
+ * @param[in]  dir      Cache directory
+ * @param[in]  modname  Yang module name
+ * @param[in]  fp       Cache key, see autocli_cache_fp
+ * @param[out] map      NUL-terminated clispec text on hit, munmap with maplen.
+ *                      NULL on a hit of a cached empty clispec.
+ * @param[out] maplen   Length of mapping in bytes
+ * @retval     1        Cache hit
+ * @retval     0        Cache miss
+ * @retval    -1        Error
+ */
+static int
+autocli_cache_load(const char *dir,
+                   const char *modname,
+                   uint32_t    fp,
+                   char      **map,
+                   size_t     *maplen)
+{
+    int         retval = -1;
+    char        filename[MAXPATHLEN];
+    int         fd = -1;
+    struct stat st;
+    char       *m;
+
+    *map = NULL;
+    *maplen = 0;
+    snprintf(filename, sizeof(filename), "%s/%s-%08x.cli", dir, modname, fp);
+    if ((fd = open(filename, O_RDONLY)) < 0){
+        retval = 0; /* miss */
+        goto done;
+    }
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", filename);
+        goto done;
+    }
+    if (st.st_size == 0){ /* cached empty clispec (pre-trailer format) */
+        retval = 1;
+        goto done;
+    }
+    if ((m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED){
+        clicon_err(OE_UNIX, errno, "mmap(%s)", filename);
+        goto done;
+    }
+    if (m[st.st_size-1] != '\0'){ /* entry without NUL trailer: rewrite it */
+        munmap(m, st.st_size);
+        retval = 0;
+        goto done;
+    }
+    *map = m;
+    *maplen = st.st_size;
+    retval = 1;
+ done:
+    if (fd != -1)
+        close(fd);
+    return retval;
+}
+
+/*! Store the generated clispec of one module in the disk cache
+ *
+ * Best effort: failures are logged and ignored, generation has already
+ * succeeded. Written via a temp file and rename so a concurrently starting
+ * CLI never sees a half-written entry.
+ * @param[in]  dir      Cache directory
+ * @param[in]  modname  Yang module name
+ * @param[in]  fp       Cache key, see autocli_cache_fp
+ * @param[in]  cb       Generated clispec text
+ * @retval     0        OK (including ignored write failure)
+ */
+static int
+autocli_cache_store(const char *dir,
+                    const char *modname,
+                    uint32_t    fp,
+                    cbuf       *cb)
+{
+    char  filename[MAXPATHLEN];
+    char  tmpfile[MAXPATHLEN];
+    FILE *f;
+
+    snprintf(filename, sizeof(filename), "%s/%s-%08x.cli", dir, modname, fp);
+    snprintf(tmpfile, sizeof(tmpfile), "%s.%u", filename, getpid());
+    if ((f = fopen(tmpfile, "w")) == NULL){
+        clicon_log(LOG_NOTICE, "autocli cache: fopen(%s): %s", tmpfile, strerror(errno));
+        return 0;
+    }
+    /* NUL trailer so the entry can be mapped and parsed in place,
+     * see autocli_cache_load */
+    if ((cbuf_len(cb) &&
+         fwrite(cbuf_get(cb), 1, cbuf_len(cb), f) != cbuf_len(cb)) ||
+        fputc('\0', f) == EOF){
+        clicon_log(LOG_NOTICE, "autocli cache: write %s failed", tmpfile);
+        fclose(f);
+        unlink(tmpfile);
+        return 0;
+    }
+    fclose(f);
+    if (rename(tmpfile, filename) < 0){
+        clicon_log(LOG_NOTICE, "autocli cache: rename(%s): %s", filename, strerror(errno));
+        unlink(tmpfile);
+    }
+    return 0;
+}
+
 /*! Generate clispec for all modules in yspec (except excluded)
- * 
+ *
  * @param[in]  h         Clixon handle
  * @param[in]  yspec     Top-level Yang statement of type Y_SPEC
  * @param[in]  treename  Name of tree
@@ -1324,7 +1511,13 @@ yang2cli_yspec(clicon_handle      h,
     cg_obj         *co;
     int             i;
     int             config;
-    
+    char           *cachedir;
+    uint32_t        fp = 0;
+    int             cached;
+    char           *map = NULL;
+    size_t          maplen = 0;
+    char           *spec;
+
     if ((pt0 = pt_new()) == NULL){
         clicon_err(OE_UNIX, errno, "pt_new");
         goto done;
@@ -1333,6 +1526,15 @@ yang2cli_yspec(clicon_handle      h,
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
+    /* Optional disk cache of generated clispec text, keyed by yang spec +
+     * autocli config, see autocli_cache_fp. On a hit, text generation
+     * (yang2cli_stmt) is skipped; the cligen parse and post-processing below
+     * still run.
+     */
+    cachedir = clicon_option_str(h, "CLICON_CLI_AUTOCLI_CACHE_DIR");
+    if (cachedir &&
+        autocli_cache_fp(h, yspec, treename, &fp) < 0)
+        goto done;
     /* Traverse YANG, loop through all modules and generate CLI */
     ymod = NULL;
     while ((ymod = yn_each(yspec, ymod)) != NULL){
@@ -1344,10 +1546,26 @@ yang2cli_yspec(clicon_handle      h,
         if (!enable)
             continue;
         cbuf_reset(cb);
-        if (yang2cli_stmt(h, ymod, 0, cb) < 0)
+        cached = 0;
+        if (cachedir &&
+            (cached = autocli_cache_load(cachedir, yang_argument_get(ymod), fp, &map, &maplen)) < 0)
             goto done;
-        if (cbuf_len(cb) == 0)
+        if (!cached){
+            if (yang2cli_stmt(h, ymod, 0, cb) < 0)
+                goto done;
+            if (cachedir)
+                autocli_cache_store(cachedir, yang_argument_get(ymod), fp, cb);
+        }
+        /* On a cache hit the spec is parsed straight out of the shared
+         * read-only mapping, without a private heap copy */
+        spec = map ? map : cbuf_get(cb);
+        if (spec == NULL || *spec == '\0'){
+            if (map){
+                munmap(map, maplen);
+                map = NULL;
+            }
             continue;
+        }
         /* Note Tie-break of same top-level symbol: prefix is NYI
          * Needs to move cligen_parse_str() call here instead of later
          */
@@ -1361,8 +1579,8 @@ yang2cli_yspec(clicon_handle      h,
         }
 
         /* Parse the buffer using cligen parser. load cli syntax */
-        if (cligen_parse_str(cli_cligen(h), cbuf_get(cb), "yang2cli", pt, NULL) < 0){
-            fprintf(stderr, "%s\n", cbuf_get(cb));
+        if (cligen_parse_str(cli_cligen(h), spec, "yang2cli", pt, NULL) < 0){
+            fprintf(stderr, "%s\n", spec);
             goto done;
         }
         /* Add prefix: assume new are appended */
@@ -1383,16 +1601,20 @@ yang2cli_yspec(clicon_handle      h,
         clicon_debug(1, "%s Generated auto-cli for %s", __FUNCTION__, yang_argument_get(ymod));
         if (printgen)
             clicon_log(LOG_NOTICE, "%s: Top-level cli-spec %s:\n%s",
-                       __FUNCTION__, treename, cbuf_get(cb));
+                       __FUNCTION__, treename, spec);
         else
             clicon_debug(2, "%s: Top-level cli-spec %s:\n%s",
-                         __FUNCTION__, treename, cbuf_get(cb));
+                         __FUNCTION__, treename, spec);
         if (cligen_parsetree_merge(pt0, NULL, pt) < 0){
             clicon_err(OE_YANG, errno, "cligen_parsetree_merge");
             goto done;
         }
         pt_free(pt, 1);
         pt = NULL;
+        if (map){
+            munmap(map, maplen);
+            map = NULL;
+        }
     } /* ymod */
     /* Resolve the expand callback functions in the generated syntax.
      * This "should" only be GENERATE_EXPAND_XMLDB
@@ -1415,6 +1637,8 @@ yang2cli_yspec(clicon_handle      h,
 #endif
     retval = 0;
  done:
+    if (map)
+        munmap(map, maplen);
     if (pt)
         pt_free(pt, 1);
     if (pt0)
@@ -53,6 +53,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <time.h>
 #include <netinet/in.h>
 #include <pwd.h>
 #include <libgen.h>
@@ -73,7 +74,7 @@
 #include "cli_handle.h"
 
 /* Command line options to be passed to getopt(3) */
-#define CLI_OPTS "+hD:f:E:l:F:1a:u:d:m:qp:GLy:c:U:o:"
+#define CLI_OPTS "+hD:f:E:l:F:1a:u:d:m:qp:GLy:c:U:o:P"
 
 /*! Check if there is a CLI history file and if so dump the CLI histiry to it
  * Just log if file does not exist or is not readable
@@ -223,6 +224,9 @@ cli_signal_init (clicon_handle h)
     return retval;
 }
 
+/* Forward, lazy autocli generation, see CLICON_CLI_AUTOCLI_LAZY */
+static int autocli_lazy_ensure(clicon_handle h);
+
 /*! Interactive CLI command loop
  * @param[in]  h    CLICON handle
  * @retval     0
@@ -240,6 +244,9 @@ cli_interactive(clicon_handle h)
 
     /* Loop through all commands */
     while(!cligen_exiting(cli_cligen(h))) {
+        /* Deferred autocli generation: the mode may have changed */
+        if (autocli_lazy_ensure(h) < 0)
+            goto done;
         new_mode = cli_syntax_mode(h);
         cmd = NULL;
         /* Read a CLI string, including expand handling */
@@ -251,6 +258,8 @@ cli_interactive(clicon_handle h)
             cligen_exiting_set(cli_cligen(h), 1);
             continue;
         }
+        /* New command: fresh correlation id, carried on backend messages */
+        clixon_trace_id_new();
         /* Here errors are handled */
         if (clicon_parse(h, cmd, &new_mode, &result, NULL) < 0)
             goto done;
@@ -379,11 +388,11 @@ autocli_start(clicon_handle h,
     int           retval = -1;
     yang_stmt    *yspec;
     int           enable = 0;
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
     /* There is no single "enable-autocli" flag,
-     * but set 
-     *   <module-default>false</module-default> 
+     * but set
+     *   <module-default>false</module-default>
      * with no rules:
      *   <rule><operation>enable</operation>
      * is disable
@@ -397,12 +406,97 @@ autocli_start(clicon_handle h,
     /* Init yang2cli */
     if (yang2cli_init(h) < 0)
         goto done;
+    if (clicon_option_bool(h, "CLICON_CLI_AUTOCLI_LAZY")){
+        /* Defer the expensive generation until a mode that can actually reach
+         * the generated trees is entered, see autocli_lazy_ensure. The
+         * reference trees below are cheap and created eagerly.
+         */
+        if (clicon_data_set(h, "autocli-lazy", "pending") < 0)
+            goto done;
+        if (clicon_data_set(h, "autocli-lazy-printgen", printgen?"1":"0") < 0)
+            goto done;
+    }
+    else{
+        yspec = clicon_dbspec_yang(h);
+        /* The actual generating call from yang to clispec for the complete yang spec */
+        if (yang2cli_yspec(h, yspec, AUTOCLI_TREENAME, printgen) < 0)
+            goto done;
+    }
+    /* XXX Create pre-5.5 tree-refs for backward compatibility */
+    if (autocli_trees_default(h) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if a parse-tree (transitively) references an autocli-generated tree
+ *
+ * @param[in]  pt  Cligen parse tree
+ * @retval     1   Tree references @basemodel or a @datamodel* tree
+ * @retval     0   No reference
+ */
+static int
+pt_refs_autocli(parse_tree *pt)
+{
+    cg_obj *co;
+    int     i;
+
+    for (i=0; i<pt_len_get(pt); i++){
+        if ((co = pt_vec_i_get(pt, i)) == NULL)
+            continue;
+        if (co->co_type == CO_REFERENCE &&
+            co->co_command != NULL &&
+            (strcmp(co->co_command, AUTOCLI_TREENAME) == 0 ||
+             strncmp(co->co_command, "datamodel", strlen("datamodel")) == 0))
+            return 1;
+        if (co_pt_get(co) != NULL &&
+            pt_refs_autocli(co_pt_get(co)))
+            return 1;
+    }
+    return 0;
+}
+
+/*! Run deferred autocli generation if the active mode can reach it
+ *
+ * With CLICON_CLI_AUTOCLI_LAZY, yang2cli generation is skipped at startup
+ * (see autocli_start) and run here, just before a command is read or parsed,
+ * but only once the active syntax mode contains a reference to @basemodel or
+ * one of the @datamodel trees. Modes that never touch the generated trees
+ * (operational-only modes, single commands like show version) never pay for
+ * generation; entering eg a configure mode triggers it once.
+ * @param[in]  h  Clixon handle
+ * @retval     0  OK (generated, still pending, or nothing deferred)
+ * @retval    -1  Error
+ */
+static int
+autocli_lazy_ensure(clicon_handle h)
+{
+    int         retval = -1;
+    char       *str = NULL;
+    char       *mode;
+    pt_head    *ph;
+    parse_tree *pt;
+    yang_stmt  *yspec;
+    int         printgen = 0;
+
+    if (clicon_data_get(h, "autocli-lazy", &str) < 0 ||
+        str == NULL ||
+        strcmp(str, "pending") != 0)
+        goto ok;
+    if ((mode = cli_syntax_mode(h)) == NULL ||
+        (ph = cligen_ph_find(cli_cligen(h), mode)) == NULL ||
+        (pt = cligen_ph_parsetree_get(ph)) == NULL)
+        goto ok;
+    if (!pt_refs_autocli(pt))
+        goto ok; /* stays pending until a referencing mode is entered */
+    if (clicon_data_get(h, "autocli-lazy-printgen", &str) == 0 && str)
+        printgen = atoi(str);
     yspec = clicon_dbspec_yang(h);
-    /* The actual generating call from yang to clispec for the complete yang spec */
     if (yang2cli_yspec(h, yspec, AUTOCLI_TREENAME, printgen) < 0)
         goto done;
-    /* XXX Create pre-5.5 tree-refs for backward compatibility */    
-    if (autocli_trees_default(h) < 0)
+    if (clicon_data_set(h, "autocli-lazy", "done") < 0)
         goto done;
  ok:
     retval = 0;
@@ -410,6 +504,16 @@ autocli_start(clicon_handle h,
     return retval;
 }
 
+/*! Monotonic time in seconds, for the -P startup profile */
+static double
+startup_time_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
 static void
 usage(clicon_handle h,
       char         *argv0)
@@ -437,7 +541,8 @@ usage(clicon_handle h,
             "\t-y <file>\tOverride yang spec file (dont include .yang suffix)\n"
             "\t-c <file>\tSpecify cli spec file.\n"
             "\t-U <user>\tOver-ride unix user with a pseudo user for NACM.\n"
-            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n",
+            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n"
+            "\t-P \t\tPrint a one-line startup phase timing breakdown on stderr\n",
             argv0,
             plgdir ? plgdir : "none"
         );
@@ -470,9 +575,20 @@ main(int    argc,
     size_t         cligen_bufthreshold;
     int            dbg=0;
     int            nr;
-    
+    int            profile = 0; /* -P: print startup phase timing */
+    double         t_begin;
+    double         t_options = 0.0;
+    double         t_plugins = 0.0;
+    double         t_yang = 0.0;
+    double         t_autocli = 0.0;
+    double         t_clispec = 0.0;
+    double         t_start = 0.0;
+
     /* Defaults */
     once = 0;
+    /* Timestamps are cheap and -P is not parsed until after the config file
+     * is loaded, so record phases unconditionally and print only if set */
+    t_begin = startup_time_now();
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, logdst);
@@ -545,6 +661,7 @@ main(int    argc,
             usage(h, argv[0]);
         goto done;
     }
+    t_options = startup_time_now();
     /* Now rest of options */   
     opterr = 0;
     optind = 1;
@@ -620,6 +737,9 @@ main(int    argc,
                 goto done;
             break;
         }
+        case 'P': /* Print startup phase timing breakdown */
+            profile++;
+            break;
         default:
             usage(h, argv[0]);
             break;
@@ -693,7 +813,8 @@ main(int    argc,
             goto done;
     }
 #endif
-    
+    t_plugins = startup_time_now();
+
     /* Add (hardcoded) netconf features in case ietf-netconf loaded here
      * Otherwise it is loaded in netconf_module_load below
      */
@@ -746,15 +867,18 @@ main(int    argc,
         goto done;
     if (clicon_nsctx_global_set(h, nsctx_global) < 0)
         goto done;
+    t_yang = startup_time_now();
 
     /* Create autocli from YANG */
     if (autocli_start(h, printgen) < 0)
         goto done;
+    t_autocli = startup_time_now();
 
-    /* Initialize cli syntax. 
+    /* Initialize cli syntax.
      * Plugins have already been loaded by clixon_plugins_load above */
     if (cli_syntax_load(h) < 0)
         goto done;
+    t_clispec = startup_time_now();
 
     /* Set syntax mode if specified from command-line or config-file. */
     if (clicon_option_exists(h, "CLICON_CLI_MODE"))
@@ -795,10 +919,22 @@ main(int    argc,
      */
     cligen_preference_mode_set(cli_cligen(h), 2);
 
-    /* Call start function in all plugins before we go interactive 
+    /* Call start function in all plugins before we go interactive
      */
     if (clixon_plugin_start_all(h) < 0)
         goto done;
+    t_start = startup_time_now();
+    if (profile)
+        /* plugin-start includes any backend connect/hello made by plugins.
+         * With CLICON_CLI_AUTOCLI_LAZY, autocli is deferred and shows ~0 */
+        fprintf(stderr, "startup-profile: options %.3fs plugin-load %.3fs yang %.3fs autocli %.3fs clispec %.3fs plugin-start %.3fs total %.3fs\n",
+                t_options - t_begin,
+                t_plugins - t_options,
+                t_yang - t_plugins,
+                t_autocli - t_yang,
+                t_clispec - t_autocli,
+                t_start - t_clispec,
+                t_start - t_begin);
 
     cligen_line_scrolling_set(cli_cligen(h), clicon_option_int(h,"CLICON_CLI_LINESCROLLING"));
     /*! Start CLI history and load from file */
@@ -818,6 +954,8 @@ main(int    argc,
         cligen_result result;            /* match result */
         int           evalresult = 0;    /* if result == 1, calback result */
 
+        if (autocli_lazy_ensure(h) < 0)
+            goto done;
         if (clicon_parse(h, restarg, &mode, &result, &evalresult) < 0)
             goto done;
         if (result != 1) /* Not unique match */
@@ -214,7 +214,9 @@ expand_dbvar(void   *h,
     cbuf            *cbxpath = NULL;
     yang_stmt       *ypath;
     yang_stmt       *ytype;
-    
+    cvec            *vals = NULL; /* list-keys reply values */
+    int              leafref = 0;
+
     if (argv == NULL || cvec_len(argv) != 2){
         clicon_err(OE_PLUGIN, EINVAL, "requires arguments: <db> <xmlkeyfmt>");
         goto done;
@@ -313,6 +315,45 @@ expand_dbvar(void   *h,
          */
         if (xpath_append(cbxpath, yang_argument_get(ypath), y, nsc) < 0)
             goto done;
+        leafref = 1;
+    }
+    /* Completion must see edits still pending in the session edit buffer */
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
+    /* First try the lighter list-keys rpc which returns only the matched
+     * values, not the whole subtree. Skipped for leafref where the matched
+     * nodes differ from y. Falls back to get-config below if the backend
+     * does not support the rpc (old backend or NACM enabled).
+     */
+    if (leafref == 0){
+        if ((vals = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((ret = clicon_rpc_list_keys(h, dbstr, cbuf_get(cbxpath), nsc, vals)) < 0)
+            goto done;
+        if (ret == 1){
+            /* ordered-by system is already deduplicated by the backend,
+             * for ordered-by user check the whole list as below */
+            yp = yang_parent_get(y);
+            cv = NULL;
+            while ((cv = cvec_each(vals, cv)) != NULL){
+                bodystr = cv_string_get(cv);
+                if (yp != NULL &&
+                    yang_keyword_get(yp) == Y_LIST &&
+                    yang_ordered_by_user(yp)){
+                    cg_var *cv1 = NULL;
+                    while ((cv1 = cvec_each(commands, cv1)) != NULL)
+                        if (strcmp(cv_string_get(cv1), bodystr) == 0)
+                            break;
+                    if (cv1 == NULL)
+                        cvec_add_string(commands, NULL, bodystr);
+                }
+                else
+                    cvec_add_string(commands, NULL, bodystr);
+            }
+            goto ok;
+        }
     }
     /* Get configuration based on cbxpath */
     if (clicon_rpc_get_config(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, &xt) < 0) 
@@ -340,7 +381,7 @@ expand_dbvar(void   *h,
         if ((y = xml_spec(x)) != NULL &&
             (yp = yang_parent_get(y)) != NULL &&
             yang_keyword_get(yp) == Y_LIST &&
-            yang_find(yp, Y_ORDERED_BY, "user") != NULL){
+            yang_ordered_by_user(yp)){
             /* Detect duplicates linearly in existing values */
             {
                 cg_var *cv = NULL;
@@ -362,6 +403,8 @@ expand_dbvar(void   *h,
  ok:
     retval = 0;
   done:
+    if (vals)
+        cvec_free(vals);
     if (cbxpath)
         cbuf_free(cbxpath);
     if (xerr)
@@ -451,6 +494,8 @@ cli_show_common(clicon_handle    h,
         clicon_err(OE_FATAL, 0, "Show state only for running database, not %s", db);
         goto done;
     }
+    if (cli_edit_batch_flush(h) < 0)
+        goto done;
     if (state == 0){     /* Get configuration-only from a database */
         if (clicon_rpc_get_config(h, NULL, db, xpath, nsc, withdefault, &xt) < 0)
             goto done;
@@ -480,14 +525,11 @@ cli_show_common(clicon_handle    h,
     if (veclen){
         /* Special case LIST */
         if (format == FORMAT_JSON){
-            switch (format){        
-            case FORMAT_JSON:
-                if (xml2json_vec(stdout, vec, veclen, pretty, skiptop) < 0) // XXX cligen_output
-                    goto done;
-                break;
-            default:
-                break;
-            }
+            /* Streamed in chunks so that a pager or pipe reader sees the
+             * head of the document before the full render completes */
+            if (clixon_json2file_vec(stdout, vec, veclen, pretty, skiptop, cligen_output) < 0)
+                goto done;
+            cligen_output(stdout, "\n");
         }
         else    /* Default */
             for (i=0; i<veclen; i++){
@@ -523,6 +565,9 @@ cli_show_common(clicon_handle    h,
                 default:
                     break;
                 }
+                /* Flush per top-level object: when output goes to a pager or
+                 * pipe, the first entries are visible while the rest render */
+                fflush(stdout);
             }
     }
     else if (format == FORMAT_JSON)
@@ -1224,6 +1269,8 @@ cli_pagination(clicon_handle h,
             }
             if (cli_output_status() < 0)
                 break;
+            /* Flush per object so a pager shows the page as it arrives */
+            fflush(stdout);
         } /* for j */
         if (cli_output_status() < 0)
             break;
@@ -86,6 +86,12 @@ int cli_dbxml(clicon_handle h, cvec *vars, cvec *argv, enum operation_type op, c
 
 int cli_dbxml(clicon_handle h, cvec *vars, cvec *argv, enum operation_type op, cvec *nsctx);
 
+int cli_edit_batch_flush(clicon_handle h);
+
+int cli_edit_batch_discard(clicon_handle h);
+
+int cli_edit_flush(clicon_handle h, cvec *vars, cvec *argv);
+
 int cli_set(clicon_handle h, cvec *vars, cvec *argv);
 
 int cli_merge(clicon_handle h, cvec *vars, cvec *argv);
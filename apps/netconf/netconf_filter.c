@@ -78,6 +78,9 @@
     CONTAINMENT      select 
  */
 
+/* Forward, for the indexed list fast path */
+static int xml_filter_recursive(cxobj *xfilter, cxobj *xparent, int *remove_me);
+
 /* return a string containing leafs value, NULL if no leaf or no value */
 static char*
 leafstring(cxobj *x)
@@ -96,6 +99,132 @@ leafstring(cxobj *x)
     return xml_value(c);
 }
 
+/*! Check if a filter child selects a yang list by key, build key vector if so
+ * @param[in]  f        Filter containment node
+ * @param[in]  xparent  Configuration parent, its yang binding gives the list spec
+ * @param[out] cvkp     Key name/value vector, NULL if not a key selection
+ * @retval  0  OK, see cvkp
+ * @retval -1  Error
+ * Only an in-order prefix of the list keys qualifies: that is what
+ * clixon_xml_find_index can find with binary search.
+ */
+static int
+filter_list_keys(cxobj *f,
+                 cxobj *xparent,
+                 cvec **cvkp)
+{
+    int        retval = -1;
+    yang_stmt *yp;
+    yang_stmt *yc;
+    cvec      *ycvk;
+    cvec      *cvk = NULL;
+    cg_var    *cvi = NULL;
+    cg_var    *cv;
+    cxobj     *xk;
+    char      *kname;
+    char      *kval;
+
+    *cvkp = NULL;
+    if ((yp = xml_spec(xparent)) == NULL)
+        goto ok;
+    if ((yc = yang_find_datanode(yp, xml_name(f))) == NULL)
+        goto ok;
+    if (yang_keyword_get(yc) != Y_LIST)
+        goto ok;
+    if ((ycvk = yang_cvec_get(yc)) == NULL) /* Y_LIST key cache, see ys_populate_list() */
+        goto ok;
+    while ((cvi = cvec_each(ycvk, cvi)) != NULL){
+        kname = cv_string_get(cvi);
+        if ((xk = xml_find(f, kname)) == NULL ||
+            (kval = leafstring(xk)) == NULL)
+            break; /* An in-order prefix of the keys is enough */
+        if (cvk == NULL &&
+            (cvk = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((cv = cvec_add(cvk, CGV_STRING)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+        cv_name_set(cv, kname);
+        cv_string_set(cv, kval);
+    }
+    *cvkp = cvk;
+    cvk = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cvk)
+        cvec_free(cvk);
+    return retval;
+}
+
+/*! Select list entries by key with indexed search instead of matching every sibling
+ * @param[in]  f        Filter containment node selecting a list by key
+ * @param[in]  xparent  Configuration parent node
+ * @param[in]  cvk      List key names/values from the filter, see filter_list_keys
+ * @retval  1  Handled: matching entries kept (and filtered recursively), others purged
+ * @retval  0  Not applicable (eg tree not fully yang bound), use the generic match
+ * @retval -1  Error
+ */
+static int
+xml_filter_list_keys(cxobj *f,
+                     cxobj *xparent,
+                     cvec  *cvk)
+{
+    int          retval = -1;
+    clixon_xvec *xvec = NULL;
+    cxobj       *s;
+    cxobj       *sprev;
+    int          remove_s;
+    int          i;
+
+    /* The indexed search requires the sibling vector to be yang bound, verify with
+     * one cheap scan (the generic match instead recurses into every entry)
+     */
+    s = NULL;
+    while ((s = xml_child_each(xparent, s, CX_ELMNT)) != NULL)
+        if (xml_spec(s) == NULL)
+            goto fallback;
+    if ((xvec = clixon_xvec_new()) == NULL)
+        goto done;
+    if (clixon_xml_find_index(xparent, xml_spec(xparent), NULL, xml_name(f), cvk, xvec) < 0)
+        goto done;
+    /* Apply the rest of the filter to the matched entries only */
+    for (i=0; i<clixon_xvec_len(xvec); i++){
+        s = clixon_xvec_i(xvec, i);
+        remove_s = 0;
+        if (xml_filter_recursive(f, s, &remove_s) < 0)
+            goto done;
+        if (!remove_s)
+            xml_flag_set(s, XML_FLAG_MARK);
+    }
+    /* Purge all same-name entries that did not match the keys (or were pruned above) */
+    sprev = s = NULL;
+    while ((s = xml_child_each(xparent, s, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(s), xml_name(f)) != 0){
+            sprev = s;
+            continue;
+        }
+        if (xml_flag(s, XML_FLAG_MARK)){
+            xml_flag_reset(s, XML_FLAG_MARK);
+            sprev = s;
+            continue;
+        }
+        xml_purge(s);
+        s = sprev;
+    }
+    retval = 1;
+ done:
+    if (xvec)
+        clixon_xvec_free(xvec);
+    return retval;
+ fallback:
+    retval = 0;
+    goto done;
+}
+
 /*! Internal recursive part where configuration xml tree is pruned from filter
  * assume parent has been selected and filter match (same name) as parent
  * parent is pruned according to selection.
@@ -119,6 +248,9 @@ xml_filter_recursive(cxobj *xfilter,
     char *sstr;
     int   containments;
     int   remove_s;
+    cvec *cvk = NULL;
+    int   marked = 0;
+    int   ret;
 
     *remove_me = 0;
     /* 1. Check selection */
@@ -159,6 +291,30 @@ xml_filter_recursive(cxobj *xfilter,
     /* If filter has no further specifiers, accept */
     if (!containments)
         goto match;
+    /* Fast path: a filter child selecting list entries by key need not be matched
+     * against every sibling, jump to the entries with indexed search and prune the
+     * rest of the list, see clixon_xml_find_index
+     */
+    f = NULL;
+    while ((f = xml_child_each(xfilter, f, CX_ELMNT)) != NULL) {
+        if (leafstring(f))
+            continue;
+        if (xml_find(xfilter, xml_name(f)) != f)
+            continue; /* Only first filter sibling of a name is used, as below */
+        if (filter_list_keys(f, xparent, &cvk) < 0)
+            return -1;
+        if (cvk == NULL)
+            continue;
+        ret = xml_filter_list_keys(f, xparent, cvk);
+        cvec_free(cvk);
+        cvk = NULL;
+        if (ret < 0)
+            return -1;
+        if (ret == 0)
+            continue;
+        xml_flag_set(f, XML_FLAG_MARK); /* Handled, skip in the loop below */
+        marked++;
+    }
     /* Check recursively the rest of the siblings */
     sprev = s = NULL;
     while ((s = xml_child_each(xparent, s, CX_ELMNT)) != NULL) {
@@ -167,6 +323,10 @@ xml_filter_recursive(cxobj *xfilter,
             s = sprev;
             continue;
         }
+        if (xml_flag(f, XML_FLAG_MARK)){ /* Handled by the fast path above */
+            sprev = s;
+            continue;
+        }
         if (leafstring(f)){
             sprev = s;
             continue; // unsure?sk=lf
@@ -183,6 +343,11 @@ xml_filter_recursive(cxobj *xfilter,
     }
 
   match:
+    if (marked){
+        f = NULL;
+        while ((f = xml_child_each(xfilter, f, CX_ELMNT)) != NULL)
+            xml_flag_reset(f, XML_FLAG_MARK);
+    }
     return 0;
   nomatch: /* prune this parent node (maybe only children?) */
     *remove_me = 1;
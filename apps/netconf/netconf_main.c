@@ -53,6 +53,7 @@
 #include <syslog.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -70,7 +71,7 @@
 #include "netconf_rpc.h"
 
 /* Command line options to be passed to getopt(3) */
-#define NETCONF_OPTS "hD:f:E:l:q01ca:u:d:p:y:U:t:eo:"
+#define NETCONF_OPTS "hD:f:E:l:q01ca:u:d:p:y:U:t:eo:A:C:"
 
 #define NETCONF_LOGFILE "/tmp/clixon_netconf.log"
 
@@ -88,6 +89,9 @@ static int ignore_packet_errors = 1;
 /* Hello request received */
 static int _netconf_hello_nr = 0;
 
+/* Cached netconf-framing option, read per message, changed by hello exchange */
+static clicon_option_cache _framing_opt = {0,};
+
 /*! Copy attributes from incoming request to reply. Skip already present (dont overwrite)
  *
  * RFC 6241:
@@ -208,7 +212,7 @@ netconf_rpc_message(clicon_handle h,
     cxobj               *xc;
     netconf_framing_type framing;
 
-    framing = clicon_option_int(h, "netconf-framing");
+    framing = clicon_option_int_cached(h, "netconf-framing", &_framing_opt);
     if (_netconf_hello_nr == 0 &&
         clicon_option_bool(h, "CLICON_NETCONF_HELLO_OPTIONAL") == 0){
         if (netconf_operation_failed_xml(&xret, "rpc", "Client must send an hello element before any RPC")< 0)
@@ -321,7 +325,7 @@ netconf_input_packet(clicon_handle h,
     clicon_debug(1, "%s", __FUNCTION__);
     rpcname = xml_name(xreq);
     rpcprefix = xml_prefix(xreq);
-    framing = clicon_option_int(h, "netconf-framing");
+    framing = clicon_option_int_cached(h, "netconf-framing", &_framing_opt);
     if (xml2ns(xreq, rpcprefix, &namespace) < 0)
         goto done;
     if (strcmp(rpcname, "rpc") == 0){
@@ -406,12 +410,12 @@ netconf_input_frame(clicon_handle h,
     
     clicon_debug(1, "%s", __FUNCTION__);
     clicon_debug(2, "%s: \"%s\"", __FUNCTION__, cbuf_get(cb));
-    framing = clicon_option_int(h, "netconf-framing");
+    framing = clicon_option_int_cached(h, "netconf-framing", &_framing_opt);
     yspec = clicon_dbspec_yang(h);
-    if ((str = strdup(cbuf_get(cb))) == NULL){
-        clicon_err(OE_UNIX, errno, "strdup");
-        goto done;
-    }
+    /* Parse directly from the accumulated buffer, the parser does not modify the string
+     * and the frame buffer is reset by the caller, so no copy is needed
+     */
+    str = cbuf_get(cb);
     /* Special case:  */
     if (strlen(str) == 0){
         if ((cbret = cbuf_new()) == NULL){ 
@@ -494,8 +498,6 @@ netconf_input_frame(clicon_handle h,
  ok:
     retval = 0;
  done:
-    if (str)
-        free(str);
     if (xtop)
         xml_free(xtop);
     if (xret)
@@ -530,6 +532,9 @@ netconf_input_cb(int   s,
     int            poll;
     int            i;
     int            len;
+    int            run;
+    int            chunked;
+    size_t         n;
     int            frame_state;
     size_t         frame_size;
     int            ret;
@@ -579,11 +584,28 @@ netconf_input_cb(int   s,
             clixon_exit_set(1);     
             goto ok;
         }
+        chunked = (clicon_option_int_cached(h, "netconf-framing", &_framing_opt) == NETCONF_SSH_CHUNKED);
+        run = 0; /* Start of data in buf not yet appended (end-of-message framing) */
         for (i=0; i<len; i++){
-            if (buf[i] == 0)
-                continue; /* Skip NULL chars (eg from terminals) */
-            if (clicon_option_int(h, "netconf-framing") == NETCONF_SSH_CHUNKED){
+            if (chunked){
+                if (buf[i] == 0)
+                    continue; /* Skip NULL chars (eg from terminals) */
                 /* Track chunked framing defined in RFC6242 */
+                if (frame_state == 4 && frame_size > 0){
+                    /* In chunk-data: append the rest of the chunk (or of buf) in one call
+                     * instead of feeding the state machine byte-by-byte
+                     */
+                    n = frame_size;
+                    if (n > (size_t)(len - i))
+                        n = (size_t)(len - i);
+                    if (cbuf_append_buf(cb, &buf[i], n) < 0){
+                        clicon_err(OE_XML, errno, "cbuf_append_buf");
+                        goto done;
+                    }
+                    frame_size -= n;
+                    i += n - 1;
+                    continue;
+                }
                 if ((ret = netconf_input_chunked_framing(buf[i], &frame_state, &frame_size)) < 0)
                     goto done;
                 switch (ret){
@@ -595,8 +617,8 @@ netconf_input_cb(int   s,
                      * Ignore packet errors, UNLESS an explicit termination request (eof)
                      */
                     if (netconf_input_frame(h, cb, &eof) < 0 &&
-                        !ignore_packet_errors) 
-                        goto done; 
+                        !ignore_packet_errors)
+                        goto done;
                     if (eof)
                         goto done;
                     cbuf_reset(cb);
@@ -606,21 +628,40 @@ netconf_input_cb(int   s,
                 }
             }
             else{
-                cprintf(cb, "%c", buf[i]);
+                if (buf[i] == 0){ /* Skip NULL chars (eg from terminals) */
+                    if (i > run &&
+                        cbuf_append_buf(cb, &buf[run], i - run) < 0){
+                        clicon_err(OE_XML, errno, "cbuf_append_buf");
+                        goto done;
+                    }
+                    run = i + 1;
+                    continue;
+                }
                 if (detect_endtag("]]>]]>", buf[i], &frame_state)){
                     frame_state = 0;
                     /* OK, we have an xml string from a client */
+                    if (cbuf_append_buf(cb, &buf[run], i - run + 1) < 0){
+                        clicon_err(OE_XML, errno, "cbuf_append_buf");
+                        goto done;
+                    }
+                    run = i + 1;
                     /* Remove trailer */
                     *(((char*)cbuf_get(cb)) + cbuf_len(cb) - strlen("]]>]]>")) = '\0';
                     if (netconf_input_frame(h, cb, &eof) < 0 &&
                         !ignore_packet_errors) // default is to ignore errors
-                        goto done; 
+                        goto done;
                     if (eof)
                         goto done;
                     cbuf_reset(cb);
                 }
             }
         }
+        /* Flush trailing run of bytes not yet appended (end-of-message framing) */
+        if (!chunked && len > run &&
+            cbuf_append_buf(cb, &buf[run], len - run) < 0){
+            clicon_err(OE_XML, errno, "cbuf_append_buf");
+            goto done;
+        }
         /* poll==1 if more, poll==0 if none */
         if ((poll = clixon_event_poll(s)) < 0)
             goto done;
@@ -663,7 +704,7 @@ send_hello(clicon_handle h,
     }
     if (netconf_hello_server(h, cb, id) < 0)
         goto done;
-    framing = clicon_option_int(h, "netconf-framing");
+    framing = clicon_option_int_cached(h, "netconf-framing", &_framing_opt);
     if (netconf_output_encap(framing, cb) < 0)
         goto done;
     if (netconf_output(s, cb, "hello") < 0)
@@ -706,6 +747,252 @@ netconf_terminate(clicon_handle h)
 }
 
 
+/*! Thin exec shim: hand stdin/stdout to a resident netconf agent and wait
+ *
+ * Connects to the unix socket of an agent started with -A, passes fds 0 and 1
+ * via SCM_RIGHTS and blocks until the agent closes the control socket when
+ * the session ends. The netconf session itself runs entirely in the agent on
+ * the handed-off fds: the shim does no config parsing, yang load or backend
+ * setup, so per-invocation cost is one connect and one sendmsg.
+ * @param[in]  sockpath  Unix socket path of the resident agent
+ * @retval     0         OK, session served and ended
+ * @retval    -1         Error
+ * @see netconf_agent  the serving side
+ */
+static int
+netconf_shim(char *sockpath)
+{
+    int                retval = -1;
+    int                s = -1;
+    struct sockaddr_un addr;
+    struct msghdr      msg = {0,};
+    struct iovec       iov;
+    struct cmsghdr    *cmsg;
+    char               cmsgbuf[CMSG_SPACE(2*sizeof(int))];
+    int                fds[2] = {0, 1};
+    char               c = 0;
+    char               buf[8];
+
+    if ((s = socket(AF_UNIX, SOCK_STREAM, 0)) < 0){
+        clicon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    if (connect(s, (struct sockaddr*)&addr, sizeof(addr)) < 0){
+        clicon_err(OE_UNIX, errno, "connect(%s)", sockpath);
+        goto done;
+    }
+    iov.iov_base = &c;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    memset(cmsgbuf, 0, sizeof(cmsgbuf));
+    msg.msg_control = cmsgbuf;
+    msg.msg_controllen = sizeof(cmsgbuf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2*sizeof(int));
+    memcpy(CMSG_DATA(cmsg), fds, 2*sizeof(int));
+    if (sendmsg(s, &msg, 0) < 0){
+        clicon_err(OE_UNIX, errno, "sendmsg");
+        goto done;
+    }
+    /* Session runs in the agent, block until it closes the control socket */
+    while (read(s, buf, sizeof(buf)) > 0)
+        ;
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    return retval;
+}
+
+/*! Serve one netconf session handed off by a -C shim
+ *
+ * Receives the shim's stdin/stdout via SCM_RIGHTS, takes the session username
+ * from the socket peer credentials (as the backend does for its clients),
+ * resets per-session state, opens a new backend session and runs the event
+ * loop until the session ends by EOF or close-session.
+ * @param[in]  h         Clixon handle
+ * @param[in]  s         Accepted control socket from the shim
+ * @param[in]  quiet     Do not send hello to the client
+ * @param[in]  framing0  Initial netconf-framing option, restored per session
+ * @retval     0         Session served (possibly with packet errors)
+ * @retval    -1         Error
+ */
+static int
+netconf_agent_session(clicon_handle h,
+                      int           s,
+                      int           quiet,
+                      int           framing0)
+{
+    int             retval = -1;
+    int             fds[2] = {-1, -1};
+    struct msghdr   msg = {0,};
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    char            cmsgbuf[CMSG_SPACE(2*sizeof(int))];
+    char            c;
+    char           *name = NULL;
+    uint32_t        id;
+#if defined(HAVE_SO_PEERCRED)
+    struct ucred    cr = {0,};
+    socklen_t       clen = sizeof(cr);
+#elif defined(HAVE_GETPEEREID)
+    uid_t           euid;
+    uid_t           guid;
+#endif
+
+    iov.iov_base = &c;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    memset(cmsgbuf, 0, sizeof(cmsgbuf));
+    msg.msg_control = cmsgbuf;
+    msg.msg_controllen = sizeof(cmsgbuf);
+    if (recvmsg(s, &msg, 0) < 1){
+        clicon_err(OE_UNIX, errno, "recvmsg");
+        goto done;
+    }
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(2*sizeof(int)))
+            memcpy(fds, CMSG_DATA(cmsg), 2*sizeof(int));
+    if (fds[0] == -1 || fds[1] == -1){
+        clicon_err(OE_PROTO, 0, "No stdio fds received from shim");
+        goto done;
+    }
+    /* Session username from peer credentials of the shim, used eg for NACM */
+#if defined(HAVE_SO_PEERCRED)
+    if (getsockopt(s, SOL_SOCKET, SO_PEERCRED, &cr, &clen) < 0){
+        clicon_err(OE_UNIX, errno, "getsockopt");
+        goto done;
+    }
+    if (uid2name(cr.uid, &name) < 0)
+        goto done;
+#elif defined(HAVE_GETPEEREID)
+    if (getpeereid(s, &euid, &guid) < 0)
+        goto done;
+    if (uid2name(euid, &name) < 0)
+        goto done;
+#endif
+    if (name && clicon_username_set(h, name) < 0)
+        goto done;
+    /* Session fds become 0/1: netconf output fds are hardcoded */
+    if (dup2(fds[0], 0) < 0 || dup2(fds[1], 1) < 0){
+        clicon_err(OE_UNIX, errno, "dup2");
+        goto done;
+    }
+    if (fds[0] != 0)
+        close(fds[0]);
+    if (fds[1] != 1)
+        close(fds[1]);
+    /* Reset per-session state from any previous session */
+    _netconf_hello_nr = 0;
+    clicon_option_int_set(h, NETCONF_FRAME_STATE, 0);
+    clicon_option_int_set(h, NETCONF_FRAME_SIZE, 0);
+    clicon_option_int_set(h, "netconf-framing", framing0);
+    clicon_hash_del(clicon_data(h), NETCONF_HASH_BUF);
+    /* New backend session for session-id semantics per RFC 6241 */
+    if (clicon_hello_req(h, "cl:netconf", NULL, &id) < 0)
+        goto done;
+    clicon_session_id_set(h, id);
+    if (!quiet &&
+        send_hello(h, 1, id) < 0)
+        goto done;
+    if (clixon_event_reg_fd(0, netconf_input_cb, h, "netconf socket") < 0)
+        goto done;
+    /* Returns when the session ends: EOF or close-session set the exit flag */
+    if (clixon_event_loop(h) < 0 &&
+        !ignore_packet_errors)
+        goto done;
+    retval = 0;
+ done:
+    clixon_exit_set(0); /* session exit is not process exit */
+    clixon_event_unreg_fd(0, netconf_input_cb);
+    close(0); /* already closed on the EOF path, then a no-op */
+    close(1);
+    clicon_rpc_close_session(h);
+    if (name)
+        free(name);
+    return retval;
+}
+
+/*! Resident netconf agent: accept session handoffs from -C exec shims
+ *
+ * Listens on a unix socket and serves one session at a time on the fds handed
+ * off by each shim, amortizing config parse, yang load, plugin load and
+ * backend hello across sessions: per-session setup is one accept, one
+ * recvmsg and a backend hello instead of full process startup. Sessions are
+ * serialized since output fds, framing state and the backend session are
+ * process-global; concurrent shims queue on the socket listen backlog.
+ * @param[in]  h         Clixon handle, fully initialized
+ * @param[in]  sockpath  Unix socket path to listen on, created mode 770
+ * @param[in]  quiet     Do not send hello to clients
+ * @retval     0         OK, terminated by signal
+ * @retval    -1         Error
+ * @see netconf_shim  the handoff side
+ */
+static int
+netconf_agent(clicon_handle h,
+              char         *sockpath,
+              int           quiet)
+{
+    int                retval = -1;
+    int                ss = -1;
+    int                s;
+    int                framing0;
+    struct sockaddr_un addr;
+    struct stat        st;
+    mode_t             old_mask;
+
+    framing0 = clicon_option_int(h, "netconf-framing");
+    if (lstat(sockpath, &st) == 0 && unlink(sockpath) < 0){
+        clicon_err(OE_UNIX, errno, "unlink(%s)", sockpath);
+        goto done;
+    }
+    if ((ss = socket(AF_UNIX, SOCK_STREAM, 0)) < 0){
+        clicon_err(OE_UNIX, errno, "socket");
+        goto done;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sockpath, sizeof(addr.sun_path)-1);
+    old_mask = umask(S_IRWXO);
+    if (bind(ss, (struct sockaddr*)&addr, SUN_LEN(&addr)) < 0){
+        clicon_err(OE_UNIX, errno, "bind");
+        umask(old_mask);
+        goto done;
+    }
+    umask(old_mask);
+    if (listen(ss, 5) < 0){
+        clicon_err(OE_UNIX, errno, "listen");
+        goto done;
+    }
+    clicon_log(LOG_NOTICE, "%s: %u Resident netconf agent on %s", __PROGRAM__, getpid(), sockpath);
+    while (clixon_exit_get() != 1){
+        if ((s = accept(ss, NULL, NULL)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "accept");
+            goto done;
+        }
+        /* Serve the session, keep the agent alive on per-session failures */
+        if (netconf_agent_session(h, s, quiet, framing0) < 0)
+            clicon_log(LOG_WARNING, "%s: session failed: %s", __FUNCTION__, clicon_err_reason);
+        close(s); /* unblocks the waiting shim */
+    }
+    retval = 0;
+ done:
+    if (ss != -1)
+        close(ss);
+    unlink(sockpath);
+    return retval;
+}
+
 /*! Setup signal handlers
  */
 static int
@@ -756,6 +1043,8 @@ usage(clicon_handle h,
             "\t-U <user>\tOver-ride unix user with a pseudo user for NACM.\n"
             "\t-t <sec>\tTimeout in seconds. Quit after this time.\n"
             "\t-e \t\tDont ignore errors on packet input.\n"
+            "\t-A <path>\tResident agent mode: serve sessions handed off by -C shims on unix socket\n"
+            "\t-C <path>\tHand off stdin/stdout to a resident agent (-A) on unix socket and wait\n"
             "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n",
             argv0,
             clicon_netconf_dir(h)
@@ -784,7 +1073,9 @@ main(int    argc,
     size_t           cligen_bufthreshold;
     int              dbg = 0;
     size_t           sz;
-    
+    char            *agent_sock = NULL;
+    char            *shim_sock = NULL;
+
     /* Create handle */
     if ((h = clicon_handle_init()) == NULL)
         return -1;
@@ -825,13 +1116,26 @@ main(int    argc,
                 clicon_log_file(optarg+1) < 0)
                 goto done;
              break;
+        case 'C': /* hand off stdin/stdout to resident agent */
+            if (!strlen(optarg))
+                usage(h, argv[0]);
+            shim_sock = optarg;
+            break;
         }
 
-    /* 
+    /*
      * Logs, error and debug to stderr or syslog, set debug level
      */
-    clicon_log_init(__PROGRAM__, dbg?LOG_DEBUG:LOG_INFO, logdst); 
-    clicon_debug_init(dbg, NULL); 
+    clicon_log_init(__PROGRAM__, dbg?LOG_DEBUG:LOG_INFO, logdst);
+    clicon_debug_init(dbg, NULL);
+    /* Thin handoff shim: no config parse, yang load or backend setup, the
+     * session runs in the resident agent, see netconf_shim
+     */
+    if (shim_sock != NULL){
+        retval = netconf_shim(shim_sock);
+        clicon_handle_exit(h);
+        return retval;
+    }
     yang_init(h);
     
     /* Find, read and parse configfile */
@@ -848,7 +1152,13 @@ main(int    argc,
         case 'f':  /* config file */
         case 'E': /* extra config dir */
         case 'l':  /* log  */
+        case 'C': /* shim, handled above */
             break; /* see above */
+        case 'A': /* resident agent mode */
+            if (!strlen(optarg))
+                usage(h, argv[0]);
+            agent_sock = optarg;
+            break;
         case 'q':  /* quiet: dont write hello */
             quiet++;
             break;
@@ -989,9 +1299,21 @@ main(int    argc,
         goto done;
 #if 1
     /* XXX get session id from backend hello */
-    clicon_session_id_set(h, getpid()); 
+    clicon_session_id_set(h, getpid());
 #endif
 
+    /* Resident agent: one long-lived process serves sessions handed off by
+     * -C shims, amortizing the whole setup above across sessions
+     */
+    if (agent_sock != NULL){
+        if (dbg)
+            clicon_option_dump(h, dbg);
+        if (netconf_agent(h, agent_sock, quiet) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+
     /* Send hello request to backend to get session-id back
      * This is done once at the beginning of the session and then this is
      * used by the client, even though new TCP sessions are created for
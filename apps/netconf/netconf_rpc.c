@@ -75,21 +75,39 @@
 
 /*
  * <rpc [attributes]> 
-    <!- - tag elements in a request from a client application - -> 
-    </rpc> 
+    <!- - tag elements in a request from a client application - ->
+    </rpc>
  */
 
+/* Cached netconf-framing option, read per notification sent */
+static clicon_option_cache _framing_opt = {0,};
+
 static int
-netconf_get_config_subtree(clicon_handle h, 
+netconf_get_config_subtree(clicon_handle h,
                            cxobj        *xfilter, 
                            cxobj       **xret)
 {
-    int    retval = -1;
-    cxobj *xdata;
-    
+    int        retval = -1;
+    cxobj     *xdata;
+    cxobj     *xerr = NULL;
+    yang_stmt *yspec;
+
     /* a subtree filter is comprised of zero or more element subtrees*/
     if ((xdata = xpath_first(*xret, NULL, "/rpc-reply/data")) == NULL)
         goto ok;
+    /* Bind yang to the reply so that key-selected list filters can use indexed
+     * search instead of matching every list entry, see xml_filter.
+     * A partial bind (eg augments from unknown modules) is OK: the filter falls
+     * back to the generic linear match where yang binding is missing.
+     */
+    if ((yspec = clicon_dbspec_yang(h)) != NULL){
+        if (xml_bind_yang(xdata, YB_MODULE, yspec, &xerr) < 0)
+            goto done;
+        if (xerr){
+            xml_free(xerr);
+            xerr = NULL;
+        }
+    }
     if (xml_filter(xfilter, xdata) < 0){
         clixon_xml_parse_va(YB_NONE, NULL, xret, NULL, "<rpc-reply xmlns=\"%s\"><rpc-error>"
                             "<error-tag>operation-failed</error-tag>"
@@ -102,7 +120,7 @@ netconf_get_config_subtree(clicon_handle h,
     }
 ok:
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -482,7 +500,8 @@ netconf_notification_cb(int   s,
     if (clixon_xml2cbuf(cb, xn, 0, 0, -1, 0) < 0)
         goto done;
     /* Send it to listening client on stdout */
-    if (netconf_output_encap(clicon_option_int(h, "netconf-framing"), cb) < 0){
+    if (netconf_output_encap(clicon_option_int_cached(h, "netconf-framing",
+                                                      &_framing_opt), cb) < 0){
         goto done;
     }
     if (netconf_output(1, cb, "notification") < 0){
@@ -698,7 +717,10 @@ netconf_rpc_dispatch(clicon_handle h,
     cxobj      *xe;
     char       *username;
     cxobj      *xa;
-    
+
+    /* New rpc: fresh correlation id, carried on backend messages */
+    clixon_trace_id_new();
+    clixon_trace_stage("netconf-rpc");
     /* Tag username on all incoming requests in case they are forwarded as internal messages
      * This may be unecesary since not all are forwarded. 
      * It may even be wrong if something else is done with the incoming message?
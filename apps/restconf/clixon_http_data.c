@@ -40,6 +40,8 @@
 #include "clixon_config.h" /* generated by config & autoconf */
 #endif
 
+#define _GNU_SOURCE /* strptime, timegm */
+
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -84,6 +86,12 @@ static const map_str2str mime_map[] = {
     { NULL,    NULL} /* if not found: application/octet-stream */
 };
 
+/* HTTP-date / IMF-fixdate, eg "Mon, 01 Jan 2024 00:00:00 GMT", see RFC 9110 Section 5.6.7 */
+#define HTTP_DATA_DATE_FMT "%a, %d %b %Y %H:%M:%S GMT"
+
+/* Read buffer size when copying file contents to the output cbuf */
+#define HTTP_DATA_BUFLEN 65536
+
 /*! Check if uri path denotes a data path
  *
  * @param[in]  h      Clixon handle
@@ -166,9 +174,10 @@ api_http_data_err(clicon_handle  h,
  * @param[in,out]  cbpath  Filepath as cbuf, internal redirection may change it
  * @param[out]     fp      Open file, if retval = 1
  * @param[out]     fsz     Size of file, if retval = 1
+ * @param[out]     mtime   Last modification time of file, if retval = 1
  * @retval        -1       Error
  * @retval         0       Invalid
- * @retval         1       OK, fp,fsz set
+ * @retval         1       OK, fp,fsz,mtime set
  */
 static int
 http_data_check_file_path(clicon_handle h,
@@ -176,7 +185,8 @@ http_data_check_file_path(clicon_handle h,
                           char         *prefix,
                           cbuf         *cbpath,
                           FILE        **fp,
-                          off_t        *fsz)
+                          off_t        *fsz,
+                          time_t       *mtime)
 {
     int         retval = -1;
     struct stat fstat;
@@ -247,6 +257,7 @@ http_data_check_file_path(clicon_handle h,
         goto invalid;
     }
     *fsz = fstat.st_size;
+    *mtime = fstat.st_mtime;
     if ((f = fopen(p, "rb")) == NULL){
         clicon_debug(1, "%s Error fopen(%s) %s", __FUNCTION__, p, strerror(errno));
         code = 403;
@@ -262,14 +273,34 @@ http_data_check_file_path(clicon_handle h,
     retval = 0;
     goto done;
 }
-                   
+
+/*! Format a timestamp as an HTTP-date, eg "Mon, 01 Jan 2024 00:00:00 GMT"
+ * @param[in]   t    Unix timestamp
+ * @param[out]  buf  Result buffer
+ * @param[in]   len  Length of buf, should be >= 30
+ * @retval      buf  Formatted date string
+ */
+static char *
+http_data_timestr(time_t  t,
+                  char   *buf,
+                  size_t  len)
+{
+    struct tm tm = {0,};
+
+    gmtime_r(&t, &tm);
+    strftime(buf, len, HTTP_DATA_DATE_FMT, &tm);
+    return buf;
+}
+
 /*! Read file data request
+ * Supports conditional requests via If-Modified-Since (304 not modified without reading
+ * the file) and single byte-ranges via Range (206 partial content), so clients
+ * revalidating or resuming large files do not pull the whole file through the daemon.
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
  * @param[in]  pathname  With stripped prefix (eg /data), ultimately a filename
  * @param[in]  head      HEAD not GET
- * @note: primitive file handling, just check if file exists and read it all
- * XXX 1: Buffer copying once too many, see #if 0 below
+ * @note: primitive file handling, just check if file exists and read it
  */
 static int
 api_http_data_file(clicon_handle h,
@@ -283,6 +314,7 @@ api_http_data_file(clicon_handle h,
     cbuf       *cbdata = NULL;
     FILE       *f = NULL;
     off_t       fsz = 0;
+    time_t      mtime = 0;
     long        fsize;
     char       *www_data_root = NULL;
     char       *suffix;
@@ -290,6 +322,15 @@ api_http_data_file(clicon_handle h,
     int         ret;
     char       *buf = NULL;
     size_t      sz;
+    char       *hdrval;
+    struct tm   tm = {0,};
+    char        timestr[32];
+    long        first;
+    long        last;
+    long        offset = 0;
+    long        len;
+    long        remaining;
+    int         code = 200;
 
     clicon_debug(1, "%s", __FUNCTION__);    
     if ((cbfile = cbuf_new()) == NULL){
@@ -312,11 +353,25 @@ api_http_data_file(clicon_handle h,
         }
         cprintf(cbfile, "%s", pathname); /* Assume pathname starts with '/' */
     }
-    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &f, &fsz)) < 0)
+    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &f, &fsz, &mtime)) < 0)
         goto done;
     if (ret == 0) /* Invalid, return code set */
         goto ok;
     filename = cbuf_get(cbfile);
+    /* Conditional request: if the client cache is still valid, reply 304 without reading
+     * the file at all
+     */
+    if ((hdrval = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL &&
+        strptime(hdrval, HTTP_DATA_DATE_FMT, &tm) != NULL &&
+        mtime <= timegm(&tm)){
+        if (restconf_reply_header(req, "Last-Modified", "%s",
+                                  http_data_timestr(mtime, timestr, sizeof(timestr))) < 0)
+            goto done;
+        if (restconf_reply_send(req, 304, NULL, head) < 0)
+            goto done;
+        clicon_debug(1, "%s %s not modified", __FUNCTION__, filename);
+        goto ok;
+    }
     /* Find media from file suffix, note there may have been internal indirection */
     if ((suffix = rindex(filename, '.')) == NULL){
         media = "application/octet-stream";
@@ -339,36 +394,75 @@ api_http_data_file(clicon_handle h,
             goto done;
         goto ok;
     }
-    fseek(f, 0, SEEK_SET);  /* same as rewind(f); */
-    if ((cbdata = cbuf_new_alloc(fsize+1)) == NULL){
+    /* Byte range: single range only, an unparsable Range header means the full file is sent */
+    len = fsize;
+    if ((hdrval = restconf_param_get(h, "HTTP_RANGE")) != NULL){
+        first = -1;
+        if (sscanf(hdrval, "bytes=%li-%li", &first, &last) == 2){
+            if (first > last)
+                first = -1; /* Invalid, ignore range */
+        }
+        else if (sscanf(hdrval, "bytes=%li-", &first) == 1)
+            last = fsize - 1;
+        else
+            first = -1;
+        if (first >= fsize){
+            if (restconf_reply_header(req, "Content-Range", "bytes */%li", fsize) < 0)
+                goto done;
+            if (api_http_data_err(h, req, 416) < 0) /* range not satisfiable */
+                goto done;
+            goto ok;
+        }
+        if (first >= 0){
+            if (last >= fsize)
+                last = fsize - 1;
+            offset = first;
+            len = last - first + 1;
+            code = 206;
+            if (restconf_reply_header(req, "Content-Range", "bytes %li-%li/%li",
+                                      first, last, fsize) < 0)
+                goto done;
+        }
+    }
+    if (fseek(f, offset, SEEK_SET) < 0){
+        clicon_err(OE_UNIX, errno, "fseek");
+        goto done;
+    }
+    if ((cbdata = cbuf_new_alloc(len+1)) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
         goto done;
     }
-    /* Unoptimized, no direct read but requires an extra copy,
-     * the cligen buf API should have some mechanism for this case without the extra copy.
+    /* Read in chunks via a fixed-size buffer, the cligen buf API has no mechanism for
+     * reading directly into the cbuf, but this way the extra copy does not double
+     * peak memory for large files.
      */
-    if ((buf = malloc(fsize)) == NULL){
+    if ((buf = malloc(HTTP_DATA_BUFLEN)) == NULL){
         clicon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    if ((ret = fread(buf, fsize, 1, f)) < 0){
-        clicon_err(OE_UNIX, errno, "fread");
-        goto done;
-    }
-    sz = (size_t)ret;
-    if (sz != 1){
-        clicon_debug(1, "%s Error fread(%s) sz:%zu", __FUNCTION__, filename, sz);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    remaining = len;
+    while (remaining > 0){
+        sz = remaining < HTTP_DATA_BUFLEN ? remaining : HTTP_DATA_BUFLEN;
+        if (fread(buf, 1, sz, f) != sz){
+            clicon_debug(1, "%s Error fread(%s) remaining:%li", __FUNCTION__, filename, remaining);
+            if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+                goto done;
+            goto ok;
+        }
+        if (cbuf_append_buf(cbdata, buf, sz) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
             goto done;
-        goto ok;
-    }
-    if (cbuf_append_buf(cbdata, buf, fsize) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
-        goto done;
+        }
+        remaining -= sz;
     }
     if (restconf_reply_header(req, "Content-Type", "%s", media) < 0)
         goto done;
-    if (restconf_reply_send(req, 200, cbdata, head) < 0)
+    if (restconf_reply_header(req, "Accept-Ranges", "bytes") < 0)
+        goto done;
+    if (restconf_reply_header(req, "Last-Modified", "%s",
+                              http_data_timestr(mtime, timestr, sizeof(timestr))) < 0)
+        goto done;
+    if (restconf_reply_send(req, code, cbdata, head) < 0)
         goto done;
     cbdata = NULL; /* consumed by reply-send */
     clicon_debug(1, "%s Read %s OK", __FUNCTION__, filename);
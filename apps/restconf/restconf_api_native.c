@@ -44,6 +44,7 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h> /* strncasecmp */
 #include <signal.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
@@ -53,6 +54,12 @@
 #ifdef HAVE_LIBNGHTTP2
 #include <nghttp2/nghttp2.h>
 #endif
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -120,13 +127,143 @@ restconf_reply_header(void       *req0,
     return retval;
 }
 
+#if defined(HAVE_LIBZ) || defined(HAVE_LIBZSTD)
+/* Do not compress bodies below this size, the encoding overhead is not worth it */
+#define RESTCONF_COMPRESS_MIN 1024
+
+/*! Check if a content coding is present in an Accept-Encoding header field
+ * Matches comma-separated tokens, qvalue parameters are ignored (a quality of
+ * 0 is thus treated as acceptance, which errs on the compressing side).
+ * @param[in]  hdr  Accept-Encoding field value, eg "gzip, deflate, br"
+ * @param[in]  enc  Content coding, eg "gzip"
+ * @retval     0    Not present
+ * @retval     1    Present
+ */
+static int
+accept_encoding_has(char       *hdr,
+                    const char *enc)
+{
+    char  *s = hdr;
+    size_t len = strlen(enc);
+
+    while (*s){
+        while (*s == ' ' || *s == ',')
+            s++;
+        if (strncasecmp(s, enc, len) == 0 &&
+            (s[len] == '\0' || s[len] == ',' || s[len] == ';' || s[len] == ' '))
+            return 1;
+        while (*s && *s != ',')
+            s++;
+    }
+    return 0;
+}
+#endif /* HAVE_LIBZ || HAVE_LIBZSTD */
+
+#ifdef HAVE_LIBZ
+/*! Compress a reply body to gzip format
+ * @param[in]  cb   Uncompressed body
+ * @param[out] cbz  Malloced compressed body, free with cbuf_free
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+reply_compress_gzip(cbuf  *cb,
+                    cbuf **cbz)
+{
+    int      retval = -1;
+    z_stream strm = {0,};
+    char    *buf = NULL;
+    size_t   max;
+    int      zret;
+
+    /* 15+16: max window with gzip wrapper, see deflateInit2 in zlib.h */
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK){
+        clicon_err(OE_RESTCONF, 0, "deflateInit2");
+        goto done;
+    }
+    max = deflateBound(&strm, cbuf_len(cb));
+    if ((buf = malloc(max)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    strm.next_in = (unsigned char*)cbuf_get(cb);
+    strm.avail_in = cbuf_len(cb);
+    strm.next_out = (unsigned char*)buf;
+    strm.avail_out = max;
+    if ((zret = deflate(&strm, Z_FINISH)) != Z_STREAM_END){
+        clicon_err(OE_RESTCONF, 0, "deflate: %d", zret);
+        goto done;
+    }
+    if ((*cbz = cbuf_new_alloc(strm.total_out+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    if (cbuf_append_buf(*cbz, buf, strm.total_out) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 0;
+ done:
+    deflateEnd(&strm);
+    if (buf)
+        free(buf);
+    return retval;
+}
+#endif /* HAVE_LIBZ */
+
+#ifdef HAVE_LIBZSTD
+/*! Compress a reply body to zstd format
+ * @param[in]  cb   Uncompressed body
+ * @param[out] cbz  Malloced compressed body, free with cbuf_free
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+reply_compress_zstd(cbuf  *cb,
+                    cbuf **cbz)
+{
+    int     retval = -1;
+    char   *buf = NULL;
+    size_t  max;
+    size_t  zret;
+
+    max = ZSTD_compressBound(cbuf_len(cb));
+    if ((buf = malloc(max)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    zret = ZSTD_compress(buf, max, cbuf_get(cb), cbuf_len(cb), ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(zret)){
+        clicon_err(OE_RESTCONF, 0, "ZSTD_compress: %s", ZSTD_getErrorName(zret));
+        goto done;
+    }
+    if ((*cbz = cbuf_new_alloc(zret+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    if (cbuf_append_buf(*cbz, buf, zret) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (buf)
+        free(buf);
+    return retval;
+}
+#endif /* HAVE_LIBZSTD */
+
 /*! Send HTTP reply with potential message body
  * @param[in]     req   http request handle
  * @param[in]     code  Status code
  * @param[in]     cb    Body as a cbuf if non-NULL. Note: is consumed
- * @param[in]     head  Only send headers, dont send body. 
- * 
+ * @param[in]     head  Only send headers, dont send body.
+ *
  * Prerequisites: status code set, headers given, body if wanted set
+ * If the client accepts it, bodies over a size threshold are compressed here
+ * (zstd preferred, then gzip) so that all reply paths negotiate Content-Encoding
+ * in one place.
  */
 int
 restconf_reply_send(void  *req0,
@@ -136,6 +273,12 @@ restconf_reply_send(void  *req0,
 {
     int                   retval = -1;
     restconf_stream_data *sd = (restconf_stream_data *)req0;
+#if defined(HAVE_LIBZ) || defined(HAVE_LIBZSTD)
+    restconf_conn        *rc;
+    cbuf                 *cbz = NULL;
+    char                 *aenc;
+    char                 *enc = NULL;
+#endif
 
     clicon_debug(1, "%s code:%d", __FUNCTION__, code);
     if (sd == NULL){
@@ -143,6 +286,37 @@ restconf_reply_send(void  *req0,
         goto done;
     }
     sd->sd_code = code;
+#if defined(HAVE_LIBZ) || defined(HAVE_LIBZSTD)
+    if (cb != NULL && !head &&
+        cbuf_len(cb) >= RESTCONF_COMPRESS_MIN &&
+        (rc = sd->sd_conn) != NULL &&
+        (aenc = restconf_param_get(rc->rc_h, "HTTP_ACCEPT_ENCODING")) != NULL){
+#ifdef HAVE_LIBZSTD
+        if (enc == NULL && accept_encoding_has(aenc, "zstd")){
+            if (reply_compress_zstd(cb, &cbz) < 0)
+                goto done;
+            enc = "zstd";
+        }
+#endif
+#ifdef HAVE_LIBZ
+        if (enc == NULL && accept_encoding_has(aenc, "gzip")){
+            if (reply_compress_gzip(cb, &cbz) < 0)
+                goto done;
+            enc = "gzip";
+        }
+#endif
+        /* Only use the encoded body if it actually shrank */
+        if (cbz != NULL && cbuf_len(cbz) < cbuf_len(cb)){
+            if (restconf_reply_header(sd, "Content-Encoding", "%s", enc) < 0)
+                goto done;
+            if (restconf_reply_header(sd, "Vary", "Accept-Encoding") < 0)
+                goto done;
+            cbuf_free(cb);
+            cb = cbz;
+            cbz = NULL;
+        }
+    }
+#endif /* HAVE_LIBZ || HAVE_LIBZSTD */
     if (cb != NULL){
         if (cbuf_len(cb)){
             sd->sd_body_len = cbuf_len(cb); 
@@ -160,9 +334,13 @@ restconf_reply_send(void  *req0,
         }
     }
     else
-        sd->sd_body_len = 0; 
+        sd->sd_body_len = 0;
     retval = 0;
  done:
+#if defined(HAVE_LIBZ) || defined(HAVE_LIBZSTD)
+    if (cbz)
+        cbuf_free(cbz);
+#endif
     return retval;
 }
 
@@ -95,6 +95,7 @@ struct restconf_handle {
     int                      rh_pretty;      /* pretty-print for http replies */
     int                      rh_http_data;   /* enable-http-data (and if-feature http-data) */
     char                    *rh_fcgi_socket; /* if-feature fcgi, XXX: use WITH_RESTCONF_FCGI ? */
+    int                      rh_workers;     /* worker-processes, nr of worker processes */
 };
 
 /*! Creates and returns a clicon config handle for other CLICON API calls
@@ -304,3 +305,30 @@ restconf_fcgi_socket_set(clicon_handle h,
     }
     return 0;
 }
+
+/*! Get number of restconf worker processes
+ * @param[in]  h         Clicon handle
+ * @retval     workers
+ */
+int
+restconf_workers_get(clicon_handle h)
+{
+    struct restconf_handle *rh = handle(h);
+
+    return rh->rh_workers;
+}
+
+/*! Set number of restconf worker processes
+ * @param[in]  h        Clicon handle
+ * @param[in]  workers  Number of worker processes
+ * @retval     0        OK
+ */
+int
+restconf_workers_set(clicon_handle h,
+                     int           workers)
+{
+    struct restconf_handle *rh = handle(h);
+
+    rh->rh_workers = workers;
+    return 0;
+}
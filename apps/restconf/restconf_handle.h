@@ -55,5 +55,7 @@ int           restconf_http_data_get(clicon_handle h);
 int           restconf_http_data_set(clicon_handle h, int http_data);
 char         *restconf_fcgi_socket_get(clicon_handle h);
 int           restconf_fcgi_socket_set(clicon_handle h, char *socketpath);
+int           restconf_workers_get(clicon_handle h);
+int           restconf_workers_set(clicon_handle h, int workers);
 
 #endif  /* _RESTCONF_HANDLE_H_ */
@@ -42,6 +42,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <ctype.h>
 #include <inttypes.h>
 #include <syslog.h>
 #include <errno.h>
@@ -69,7 +70,208 @@
 #include "clixon_http_data.h"
 
 /* Size of xml read buffer */
-#define BUFLEN 1024  
+#define BUFLEN 1024
+
+/* Max nr of header fields handled by the fast path, more falls back to the grammar */
+#define HTTP1_FAST_HDR_MAX 64
+
+/* Header field recorded by the fast-path validation pass, see http1_parse_fast */
+struct http1_fast_hdr{
+    char *fh_name;     /* field-name start */
+    char *fh_name_end; /* one past field-name, the ':' */
+    char *fh_val;      /* field-value start, leading OWS stripped */
+    char *fh_val_end;  /* one past field-value, trailing OWS stripped */
+};
+
+/*! Is c a token character (tchar), see the token rule in clixon_http1_parse.l
+ */
+static int
+http1_is_tchar(char c)
+{
+    if (c == '\0')
+        return 0;
+    if (isalnum((unsigned char)c))
+        return 1;
+    return strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+/*! Is c a single path character (pchar), percent-encoding handled by caller
+ */
+static int
+http1_is_pchar(char c)
+{
+    if (c == '\0')
+        return 0;
+    if (isalnum((unsigned char)c))
+        return 1;
+    return strchr("-._~!$&'()*+,;=:@", c) != NULL;
+}
+
+/*! Fast path: single-pass pointer/length HTTP/1 parse of a well-formed request
+ *
+ * Parses the common case without the flex/yacc machinery and without per-token
+ * string allocations. A first pass only validates and records pointers into
+ * str; anything the grammar would treat differently - unusual whitespace,
+ * percent-encoding errors, too many headers, a malformed request - returns 0
+ * with str untouched so the full grammar gets an unmodified buffer and error
+ * behavior is unchanged. The second pass NUL-terminates the recorded fields in
+ * place and feeds them to the same sinks as the grammar actions.
+ * @param[in]  h     Clixon handle
+ * @param[in]  rc    Restconf connection
+ * @param[in]  str   HTTP/1 message, modified in place on success
+ * @retval     1     Parsed OK, connection structs populated
+ * @retval     0     Not attempted, str untouched: use the grammar
+ * @retval    -1     Error with clicon_err called
+ * @see clixon_http1_parse.y  for the semantics replicated here: one trailing
+ *      slash is stripped from the path, header values have surrounding
+ *      whitespace stripped, empty header values are dropped
+ */
+static int
+http1_parse_fast(clicon_handle  h,
+                 restconf_conn *rc,
+                 char          *str)
+{
+    char                  *p = str;
+    char                  *method;
+    char                  *method_end;
+    char                  *path;
+    char                  *path_end;
+    char                  *query = NULL;
+    char                  *query_end = NULL;
+    char                  *run;
+    char                  *ows;
+    struct http1_fast_hdr  hdrs[HTTP1_FAST_HDR_MAX];
+    struct http1_fast_hdr *fh;
+    int                    nhdr = 0;
+    int                    d1;
+    int                    d2;
+    int                    i;
+    restconf_stream_data  *sd;
+
+    /* request-line: method SP path [? query] SP HTTP/D.D CRLF */
+    method = p;
+    while (http1_is_tchar(*p))
+        p++;
+    if (p == method || *p != ' ')
+        return 0;
+    method_end = p++;
+    path = p;
+    if (*p != '/')
+        return 0;
+    while (*p == '/' || http1_is_pchar(*p) || *p == '%'){
+        if (*p == '%'){
+            if (!isxdigit((unsigned char)p[1]) || !isxdigit((unsigned char)p[2]))
+                return 0;
+            p += 3;
+        }
+        else
+            p++;
+    }
+    path_end = p;
+    if (*p == '?'){
+        query = ++p;
+        while (http1_is_pchar(*p) || *p == '/' || *p == '?' || *p == '%'){
+            if (*p == '%'){
+                if (!isxdigit((unsigned char)p[1]) || !isxdigit((unsigned char)p[2]))
+                    return 0;
+                p += 3;
+            }
+            else
+                p++;
+        }
+        query_end = p;
+        if (query_end == query)
+            return 0;
+    }
+    if (*p++ != ' ')
+        return 0;
+    if (strncmp(p, "HTTP/", 5) != 0)
+        return 0;
+    p += 5;
+    if (!isdigit((unsigned char)p[0]) || p[1] != '.' || !isdigit((unsigned char)p[2]))
+        return 0;
+    d1 = p[0] - '0';
+    d2 = p[2] - '0';
+    p += 3;
+    if (p[0] != '\r' || p[1] != '\n')
+        return 0;
+    p += 2;
+    /* header-fields: token ":" OWS value OWS CRLF, until blank line */
+    while (p[0] != '\r' || p[1] != '\n'){
+        if (nhdr >= HTTP1_FAST_HDR_MAX)
+            return 0;
+        fh = &hdrs[nhdr];
+        fh->fh_name = p;
+        while (http1_is_tchar(*p))
+            p++;
+        if (p == fh->fh_name || *p != ':')
+            return 0;
+        fh->fh_name_end = p++;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        fh->fh_val = p;
+        fh->fh_val_end = p;
+        for (;;){
+            run = p;
+            while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                p++;
+            if (p > run)
+                fh->fh_val_end = p;
+            if (*p != ' ' && *p != '\t')
+                break;
+            ows = p;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (*p == '\r')
+                break; /* trailing OWS */
+            /* The grammar collapses internal whitespace runs to one space:
+             * only a plain single space leaves the value byte-identical
+             */
+            if (p - ows != 1 || *ows != ' ')
+                return 0;
+        }
+        if (p[0] != '\r' || p[1] != '\n')
+            return 0;
+        p += 2;
+        nhdr++;
+    }
+    p += 2; /* blank line, rest is body as-is */
+    if ((sd = restconf_stream_find(rc, 0)) == NULL)
+        return 0; /* let the grammar report it */
+    /* Validated: commit by NUL-terminating in place and populating the
+     * connection structs, same order and sinks as the grammar actions
+     */
+    *method_end = '\0';
+    if (restconf_param_set(h, "REQUEST_METHOD", method) < 0)
+        return -1;
+    if (path_end - path > 1 && path_end[-1] == '/')
+        path_end--; /* one trailing slash is dropped, see absolute_paths1 */
+    *path_end = '\0';
+    if (restconf_param_set(h, "REQUEST_URI", path) < 0)
+        return -1;
+    if (query){
+        *query_end = '\0';
+        if (uri_str2cvec(query, '&', '=', 1, &sd->sd_qvec) < 0)
+            return -1;
+    }
+    rc->rc_proto_d1 = d1;
+    rc->rc_proto_d2 = d2;
+    for (i = 0; i < nhdr; i++){
+        fh = &hdrs[i];
+        if (fh->fh_val_end == fh->fh_val)
+            continue; /* empty field-value is dropped, see header_field */
+        *fh->fh_name_end = '\0';
+        *fh->fh_val_end = '\0';
+        if (restconf_convert_hdr(h, fh->fh_name, fh->fh_val) < 0)
+            return -1;
+    }
+    if (*p != '\0' &&
+        cbuf_append_buf(sd->sd_indata, p, strlen(p)) < 0){
+        clicon_err(OE_RESTCONF, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 1;
+}
 
 /*! HTTP/1 parsing function. Input is string and side-effect is populating connection structs
  *
@@ -93,6 +295,13 @@ _http1_parse(clicon_handle  h,
     clicon_debug(1, "%s:\n%s", __FUNCTION__, str);
     if (strlen(str) == 0)
         goto ok;
+    /* Well-formed requests take a single-pass, allocation-free parse, see
+     * http1_parse_fast. Anything unusual falls back to the full grammar below
+     */
+    if ((ret = http1_parse_fast(h, rc, str)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
     hy.hy_parse_string = str;
     hy.hy_name = filename;
     hy.hy_h = h;
@@ -328,15 +537,11 @@ restconf_http1_reply(restconf_conn        *rc,
     while ((cv = cvec_each(sd->sd_outp_hdrs, cv)) != NULL)
         cprintf(sd->sd_outp_buf, "%s: %s\r\n", cv_name_get(cv), cv_string_get(cv));
     cprintf(sd->sd_outp_buf, "\r\n");
-    /* Write a body */
-    if (sd->sd_body){
-        if (cbuf_append_buf(sd->sd_outp_buf, cbuf_get(sd->sd_body), cbuf_len(sd->sd_body)) < 0){
-            clicon_err(OE_RESTCONF, errno, "cbuf_append_buf");
-            goto done;
-        }
-        cbuf_free(sd->sd_body);
-        sd->sd_body = NULL;
-    }
+    /* The body is left in sd_body and written to the socket after the header
+     * buffer rather than copied into it: a large GET reply then exists in a
+     * single copy only, see restconf_http1_process where it is freed once
+     * written
+     */
     retval = 0;
  done:
     return retval;
@@ -559,6 +559,153 @@ restconf_uripath(clicon_handle h)
     return path2;
 }
 
+/* Max number of cached api-path resolutions, oldest evicted when full */
+#define APIPATH_CACHE_MAX 64
+
+/* Cache of api-path to xpath resolutions, single-linked mru-first list.
+ * Resolving an api-path validates and walks the yang spec per path segment, but the result
+ * only depends on the path string and the spec, so hot paths (dashboards polling the same
+ * resources) can reuse earlier resolutions.
+ * @see restconf_apipath2xpath
+ */
+struct apipath_cache{
+    struct apipath_cache *ac_next;
+    char                 *ac_apipath; /* Key: uri-encoded api-path */
+    yang_stmt            *ac_yspec;   /* Key: yang spec resolved against */
+    int                   ac_strict;  /* Key: strict validation flag */
+    char                 *ac_xpath;   /* Resolved xpath, malloced */
+    cvec                 *ac_nsc;     /* Namespace context of xpath */
+    yang_stmt            *ac_y;       /* Yang node of last api-path segment */
+};
+static struct apipath_cache *_apipath_cache = NULL;
+
+/*! Translate api-path to xpath and yang node, with a cache of previous resolutions
+ *
+ * Combines the api_path2xml validation call and the api_path2xpath translation the
+ * method handlers otherwise make back-to-back. Successful resolutions are cached so
+ * repeated requests for the same resource cost one list lookup instead of two yang
+ * spec walks. Invalid paths are resolved (and fail) every time so that xerr is built.
+ * @param[in]  h         Clicon handle
+ * @param[in]  api_path  URI-encoded path expression (RFC8040 3.5.3)
+ * @param[in]  yspec     Yang spec
+ * @param[in]  strict    Strict validation of api-path, see api_path2xml
+ * @param[out] xpathp    Xpath (use free() to deallocate)
+ * @param[out] nscp      Namespace context of xpath (free w xml_nsctx_free)
+ * @param[out] yp        Yang node of last api-path segment
+ * @param[out] xerr      Netconf error message (if retval=0)
+ * @retval     1         OK
+ * @retval     0         Invalid api_path, xerr set
+ * @retval    -1         Error
+ * @see api_path2xpath  The uncached translation
+ */
+int
+restconf_apipath2xpath(clicon_handle h,
+                       char         *api_path,
+                       yang_stmt    *yspec,
+                       int           strict,
+                       char        **xpathp,
+                       cvec        **nscp,
+                       yang_stmt   **yp,
+                       cxobj       **xerr)
+{
+    int                    retval = -1;
+    struct apipath_cache  *ac;
+    struct apipath_cache **prev;
+    cxobj                 *xtop = NULL;
+    cxobj                 *xbot = NULL;
+    yang_stmt             *y = NULL;
+    char                  *xpath = NULL;
+    cvec                  *nsc = NULL;
+    int                    ret;
+    int                    nr = 0;
+
+    for (prev = &_apipath_cache; (ac = *prev) != NULL; prev = &ac->ac_next)
+        if (ac->ac_yspec == yspec &&
+            ac->ac_strict == strict &&
+            strcmp(ac->ac_apipath, api_path) == 0)
+            break;
+    if (ac != NULL){ /* Hit: move first, copy out */
+        *prev = ac->ac_next;
+        ac->ac_next = _apipath_cache;
+        _apipath_cache = ac;
+        if (xpathp && (*xpathp = strdup(ac->ac_xpath)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        if (nscp && ac->ac_nsc && (*nscp = cvec_dup(ac->ac_nsc)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_dup");
+            goto done;
+        }
+        if (yp)
+            *yp = ac->ac_y;
+        retval = 1;
+        goto done;
+    }
+    /* Miss: validate api-path (xtop/xbot needed by function but not used) and translate */
+    if ((xtop = xml_new("top", NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if ((ret = api_path2xml(api_path, yspec, xtop, YC_DATANODE, strict, &xbot, &y, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if ((ret = api_path2xpath(api_path, yspec, &xpath, &nsc, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Insert first in cache, evict last if full */
+    for (prev = &_apipath_cache; (ac = *prev) != NULL; prev = &ac->ac_next)
+        if (++nr >= APIPATH_CACHE_MAX && ac->ac_next == NULL){
+            *prev = NULL;
+            free(ac->ac_apipath);
+            free(ac->ac_xpath);
+            if (ac->ac_nsc)
+                cvec_free(ac->ac_nsc);
+            free(ac);
+            break;
+        }
+    if ((ac = malloc(sizeof(*ac))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ac, 0, sizeof(*ac));
+    if ((ac->ac_apipath = strdup(api_path)) == NULL ||
+        (ac->ac_xpath = strdup(xpath)) == NULL ||
+        (nsc && (ac->ac_nsc = cvec_dup(nsc)) == NULL)){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(ac->ac_apipath);
+        free(ac->ac_xpath);
+        free(ac);
+        goto done;
+    }
+    ac->ac_yspec = yspec;
+    ac->ac_strict = strict;
+    ac->ac_y = y;
+    ac->ac_next = _apipath_cache;
+    _apipath_cache = ac;
+    if (xpathp){
+        *xpathp = xpath;
+        xpath = NULL;
+    }
+    if (nscp){
+        *nscp = nsc;
+        nsc = NULL;
+    }
+    if (yp)
+        *yp = y;
+    retval = 1;
+ done:
+    if (xtop)
+        xml_free(xtop);
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Drop privileges from root to user (or already at user)
  * @param[in]  h    Clicon handle
  * Group set to CLICON_SOCK_GROUP to communicate with backend
@@ -801,6 +948,9 @@ restconf_config_init(clicon_handle h,
         if (restconf_fcgi_socket_set(h, bstr) < 0)
             goto done;
     }
+    if ((x = xpath_first(xrestconf, nsc, "worker-processes")) != NULL &&
+        (bstr = xml_body(x)) != NULL)
+        restconf_workers_set(h, atoi(bstr));
     retval = 1;
  done:
     return retval;
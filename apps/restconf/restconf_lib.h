@@ -93,6 +93,8 @@ int   restconf_terminate(clicon_handle h);
 int   restconf_insert_attributes(cxobj *xdata, cvec *qvec);
 int   restconf_main_extension_cb(clicon_handle h, yang_stmt *yext, yang_stmt *ys);
 char *restconf_uripath(clicon_handle h);
+int   restconf_apipath2xpath(clicon_handle h, char *api_path, yang_stmt *yspec, int strict,
+                             char **xpathp, cvec **nscp, yang_stmt **yp, cxobj **xerr);
 int   restconf_drop_privileges(clicon_handle h);
 int   restconf_authentication_cb(clicon_handle h, void *req, int pretty, restconf_media media_out);
 int   restconf_config_init(clicon_handle h, cxobj *xrestconf);
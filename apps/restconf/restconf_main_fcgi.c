@@ -254,6 +254,111 @@ restconf_sig_child(int arg)
         stream_child_free(_CLICON_HANDLE, pid);
 }
 
+/*
+ * Restconf worker processes, see restconf_start_workers
+ */
+#define RESTCONF_WORKERS_MAX 64
+
+static pid_t _worker_pids[RESTCONF_WORKERS_MAX] = {0};
+static int   _worker_nr = 0;
+
+/*! Supervisor signal handler: forward termination signals to all workers
+ */
+static void
+restconf_sig_supervisor(int sig)
+{
+    int i;
+
+    for (i = 0; i < RESTCONF_WORKERS_MAX; i++)
+        if (_worker_pids[i])
+            kill(_worker_pids[i], sig);
+}
+
+/*! Fork fcgi worker processes sharing the fcgi listen socket
+ *
+ * libfcgi does not multiplex requests within a connection, so a slow request
+ * serializes one accept loop. Each worker inherits the already opened fcgi
+ * socket and runs its own accept loop, so the reverse proxy sees a pool of
+ * upstream connections and slow requests only occupy one worker. Workers make
+ * their own backend sessions so replies are not interleaved. The parent stays
+ * behind as supervisor: it forwards SIGTERM/SIGINT to the workers and exits
+ * when the last worker has exited, so start/stop from the outside is
+ * unchanged.
+ * @param[in]  h       Clicon handle
+ * @param[in]  nrproc  Number of worker processes (>1)
+ * @retval     0       OK, in worker process: continue to the accept loop
+ * @retval    -1       Error
+ * @note Does not return in the parent
+ * @see clixon-restconf.yang worker-processes
+ */
+static int
+restconf_start_workers(clicon_handle h,
+                       int           nrproc)
+{
+    int      retval = -1;
+    int      i;
+    int      s;
+    pid_t    pid;
+    int      status;
+    uint32_t id = 0;
+
+    if (nrproc > RESTCONF_WORKERS_MAX)
+        nrproc = RESTCONF_WORKERS_MAX;
+    for (i = 0; i < nrproc; i++){
+        if ((pid = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pid == 0){ /* worker */
+            memset(_worker_pids, 0, sizeof(_worker_pids));
+            _worker_nr = 0;
+            /* Drop the backend connection inherited from the parent: each
+             * worker makes its own session so replies are not interleaved
+             */
+            if ((s = clicon_client_socket_get(h)) >= 0){
+                close(s);
+                clicon_client_socket_set(h, -1);
+            }
+            if (clicon_hello_req(h, "cl:restconf", NULL, &id) < 0)
+                goto done;
+            clicon_session_id_set(h, id);
+            clicon_log(LOG_NOTICE, "%s: %u Restconf worker %d started", __PROGRAM__, getpid(), i);
+            retval = 0;
+            goto done;
+        }
+        _worker_pids[i] = pid;
+        _worker_nr++;
+    }
+    /* Supervisor: serves no requests, drop the backend connection */
+    if ((s = clicon_client_socket_get(h)) >= 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    if (set_signal(SIGTERM, restconf_sig_supervisor, NULL) < 0 ||
+        set_signal(SIGINT, restconf_sig_supervisor, NULL) < 0 ||
+        set_signal(SIGCHLD, SIG_DFL, NULL) < 0){ /* let wait() below reap workers */
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    while (_worker_nr > 0){
+        if ((pid = wait(&status)) < 0){
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (i = 0; i < RESTCONF_WORKERS_MAX; i++)
+            if (_worker_pids[i] == pid){
+                _worker_pids[i] = 0;
+                _worker_nr--;
+                break;
+            }
+    }
+    clicon_log(LOG_NOTICE, "%s: %u All restconf workers exited", __PROGRAM__, getpid());
+    exit(0);
+ done:
+    return retval;
+}
+
 /*! Usage help routine
  * @param[in]  argv0  command line
  * @param[in]  h      Clicon handle
@@ -314,6 +419,7 @@ main(int    argc,
     char          *wwwuser;
     char          *inline_config = NULL;
     size_t         sz;
+    int            nrproc;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__PROGRAM__, LOG_INFO, logdst); 
@@ -582,7 +688,15 @@ main(int    argc,
      * @see clicon_hello_req
      */
     clicon_data_set(h, "session-transport", "cl:restconf");
-    
+
+    /* Prefork worker pool sharing the fcgi socket, see clixon-restconf.yang
+     * worker-processes
+     */
+    if ((nrproc = restconf_workers_get(h)) > 1){
+        if (restconf_start_workers(h, nrproc) < 0)
+            goto done;
+    }
+
     if (FCGX_InitRequest(req, sock, 0) != 0){
         clicon_err(OE_CFG, errno, "FCGX_InitRequest");
         goto done;
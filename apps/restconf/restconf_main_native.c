@@ -126,6 +126,7 @@
 #include <assert.h>
 #include <signal.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
@@ -177,6 +178,9 @@
 /* Cert verify depth: dont know what to set here? */
 #define VERIFY_DEPTH 5
 
+/* Max nr of cached TLS sessions for resumption, see restconf_ssl_context_configure */
+#define RESTCONF_SSL_SESS_CACHE_MAX 1024
+
 static int             session_id_context = 1;
 
 /*! Set restconf native handle
@@ -437,7 +441,13 @@ restconf_ssl_context_configure(clixon_handle h,
 
     SSL_CTX_set_session_id_context(ctx, (void *)&session_id_context, sizeof(session_id_context));
     SSL_CTX_set_app_data(ctx, h);
-    SSL_CTX_set_session_cache_mode(ctx, 0);
+    /* Session resumption: cache server-side sessions so pollers reconnecting every cycle
+     * get an abbreviated handshake (session ids for TLS<=1.2, tickets are issued by
+     * default for TLS1.3). The cache is bounded, oldest sessions are evicted, and
+     * worker processes forked after init share the ticket keys of this context.
+     */
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, RESTCONF_SSL_SESS_CACHE_MAX);
 
     /* Set the key and cert */
     if (SSL_CTX_use_certificate_chain_file(ctx, server_cert_path) != 1) {
@@ -635,7 +645,17 @@ restconf_native_terminate(clicon_handle h)
 }
 
 /*! Query backend of config.
- * Loop to wait for backend starting, try again if not done 
+ * Loop to wait for backend starting, try again if not done
+ *
+ * The hello here establishes the single long-lived backend session of this
+ * process: the socket is cached on the handle (clicon_client_socket_get) and
+ * reused by every clicon_rpc_* call until termination, so requests pay no
+ * per-operation session setup. A pool of sessions would buy nothing on top:
+ * the event loop is single-threaded so RPCs are issued one at a time anyway,
+ * and concurrency is scaled with worker processes (each with its own
+ * session, see restconf_start_workers) rather than with sessions. For
+ * issuing several RPCs back-to-back on this session without waiting for
+ * replies, see clicon_rpc_netconf_send/clicon_rpc_netconf_recv.
  * @param[in]  h         Clixon handle
  * @param[out] xrestconf XML restconf config, malloced (if retval = 1)
  * @retval     1         OK  (and xrestconf set)
@@ -1071,6 +1091,109 @@ restconf_clixon_init(clicon_handle h,
     goto done;
 }
 
+/*
+ * Restconf worker processes, see restconf_start_workers
+ */
+#define RESTCONF_WORKERS_MAX 64
+
+static pid_t _worker_pids[RESTCONF_WORKERS_MAX] = {0};
+static int   _worker_nr = 0;
+
+/*! Supervisor signal handler: forward termination signals to all workers
+ */
+static void
+restconf_sig_supervisor(int sig)
+{
+    int i;
+
+    for (i = 0; i < RESTCONF_WORKERS_MAX; i++)
+        if (_worker_pids[i])
+            kill(_worker_pids[i], sig);
+}
+
+/*! Fork restconf worker processes sharing the configured listen ports
+ *
+ * Each worker continues initialization on its own: it binds the configured
+ * sockets with SO_REUSEPORT so that the kernel balances incoming connections
+ * over the workers, runs its own event loop and makes its own backend
+ * session. The parent stays behind as supervisor: it forwards SIGTERM/SIGINT
+ * to the workers and exits when the last worker has exited, so start/stop of
+ * the daemon from the outside is unchanged.
+ * @param[in]  h       Clicon handle
+ * @param[in]  nrproc  Number of worker processes (>1)
+ * @retval     0       OK, in worker process: continue initialization
+ * @retval    -1       Error
+ * @note Does not return in the parent
+ */
+static int
+restconf_start_workers(clicon_handle h,
+                       int           nrproc)
+{
+    int      retval = -1;
+    int      i;
+    int      s;
+    pid_t    pid;
+    int      status;
+    uint32_t id = 0;
+
+    if (nrproc > RESTCONF_WORKERS_MAX)
+        nrproc = RESTCONF_WORKERS_MAX;
+    for (i = 0; i < nrproc; i++){
+        if ((pid = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pid == 0){ /* worker */
+            memset(_worker_pids, 0, sizeof(_worker_pids));
+            _worker_nr = 0;
+            /* Drop the backend connection inherited from the parent: each
+             * worker makes its own session so replies are not interleaved
+             */
+            if ((s = clicon_client_socket_get(h)) >= 0){
+                close(s);
+                clicon_client_socket_set(h, -1);
+            }
+            if (clicon_hello_req(h, "cl:restconf", NULL, &id) < 0)
+                goto done;
+            clicon_session_id_set(h, id);
+            /* Bind own listen sockets, kernel balances accepts over workers */
+            clixon_netns_reuseport_set(1);
+            clicon_log(LOG_NOTICE, "%s: %u Restconf worker %d started", __PROGRAM__, getpid(), i);
+            retval = 0;
+            goto done;
+        }
+        _worker_pids[i] = pid;
+        _worker_nr++;
+    }
+    /* Supervisor: serves no requests, drop the backend connection */
+    if ((s = clicon_client_socket_get(h)) >= 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+    }
+    if (set_signal(SIGTERM, restconf_sig_supervisor, NULL) < 0 ||
+        set_signal(SIGINT, restconf_sig_supervisor, NULL) < 0){
+        clicon_err(OE_DAEMON, errno, "Setting signal");
+        goto done;
+    }
+    while (_worker_nr > 0){
+        if ((pid = wait(&status)) < 0){
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (i = 0; i < RESTCONF_WORKERS_MAX; i++)
+            if (_worker_pids[i] == pid){
+                _worker_pids[i] = 0;
+                _worker_nr--;
+                break;
+            }
+    }
+    clicon_log(LOG_NOTICE, "%s: %u All restconf workers exited", __PROGRAM__, getpid());
+    exit(0);
+ done:
+    return retval;
+}
+
 /*! Signal terminates process
  * Just set exit flag for proper exit in event loop
  */
@@ -1132,6 +1255,9 @@ main(int    argc,
     restconf_native_handle *rn = NULL;
     int             ret;
     cxobj          *xrestconf = NULL;
+    cxobj          *x;
+    char           *bstr;
+    int             nrproc;
     char           *inline_config = NULL;
 
     /* In the startup, logs to stderr & debug flag set later */
@@ -1291,7 +1417,14 @@ main(int    argc,
         retval = 0;
         goto done;
     }
-    /* Create and stroe global openssl handle */ 
+    /* Multiple worker processes share the listen ports via SO_REUSEPORT */
+    if ((x = xpath_first(xrestconf, NULL, "worker-processes")) != NULL &&
+        (bstr = xml_body(x)) != NULL &&
+        (nrproc = atoi(bstr)) > 1){
+        if (restconf_start_workers(h, nrproc) < 0) /* returns in workers only */
+            goto done;
+    }
+    /* Create and stroe global openssl handle */
     if ((rn = malloc(sizeof *rn)) == NULL){
         clicon_err(OE_UNIX, errno, "malloc");
         goto done;
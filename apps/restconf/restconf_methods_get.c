@@ -48,6 +48,7 @@
 #include <time.h>
 #include <signal.h>
 #include <limits.h>
+#include <inttypes.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 
@@ -66,6 +67,167 @@
 /* Forward */
 static int api_data_pagination(clicon_handle h, void *req, char *api_path, int pi, cvec *qvec, int pretty, restconf_media media_out);
 
+/*
+ * Cache of rendered GET reply bodies with strong etags, see api_data_get2.
+ * The etag is a hash over the returned XML tree and the output encoding, so
+ * a poller sending If-None-Match gets a 304 without re-encoding, and an
+ * unchanged tree reuses the cached rendering instead of re-encoding it.
+ * The backend get is always performed: state data changes without commits so
+ * there is no safe invalidation short of fetching.
+ */
+#define DATA_CACHE_MAX 16 /* Rendered bodies kept per process, oldest evicted */
+
+struct data_cache{
+    struct data_cache *dc_next;
+    char              *dc_key;  /* request uri (incl query) + output media */
+    uint64_t           dc_hash; /* tree hash the body was rendered from */
+    cbuf              *dc_body; /* rendered reply body */
+};
+static struct data_cache *_data_cache = NULL;
+
+/*! Fold an XML tree into a 64-bit FNV-1a hash: names, values and attributes
+ * @param[in]  h0  Hash value to continue from (offset basis at top)
+ * @param[in]  xt  XML tree
+ * @retval     Updated hash
+ */
+static uint64_t
+data_tree_hash(uint64_t h0,
+               cxobj   *xt)
+{
+    uint64_t hash = h0;
+    cxobj   *x;
+    char    *s;
+
+    if ((s = xml_name(xt)) != NULL)
+        while (*s)
+            hash = (hash ^ (uint8_t)*s++) * 0x100000001b3ULL;
+    hash = (hash ^ '=') * 0x100000001b3ULL;
+    if ((s = xml_value(xt)) != NULL)
+        while (*s)
+            hash = (hash ^ (uint8_t)*s++) * 0x100000001b3ULL;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ANY)) != NULL)
+        hash = data_tree_hash(hash, x);
+    hash = (hash ^ '/') * 0x100000001b3ULL;
+    return hash;
+}
+
+/*! Look up a cached rendering of a GET reply body
+ * @param[in]  uri    Request uri including query string
+ * @param[in]  media  Output media
+ * @param[in]  hash   Tree hash of the current reply
+ * @param[out] cbp    Malloced copy of cached body on hit, untouched on miss
+ * @retval     0      OK, cbp set on hit
+ * @retval    -1      Error
+ */
+static int
+data_cache_get(const char    *uri,
+               restconf_media media,
+               uint64_t       hash,
+               cbuf         **cbp)
+{
+    int                retval = -1;
+    struct data_cache *dc;
+    cbuf              *cbkey = NULL;
+    cbuf              *cb = NULL;
+
+    if ((cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbkey, "%s|%d", uri, media);
+    for (dc = _data_cache; dc; dc = dc->dc_next){
+        if (strcmp(dc->dc_key, cbuf_get(cbkey)) != 0)
+            continue;
+        if (dc->dc_hash != hash)
+            break; /* stale, will be replaced at next set */
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cbuf_append_buf(cb, cbuf_get(dc->dc_body), cbuf_len(dc->dc_body));
+        *cbp = cb;
+        cb = NULL;
+        break;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cbkey)
+        cbuf_free(cbkey);
+    return retval;
+}
+
+/*! Cache the rendered body of a GET reply
+ * An existing entry with the same key is replaced; when the cache is full the
+ * last (oldest, entries are prepended) entry is evicted.
+ * @param[in]  uri    Request uri including query string
+ * @param[in]  media  Output media
+ * @param[in]  hash   Tree hash the body was rendered from
+ * @param[in]  body   Rendered body, a copy is stored
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+data_cache_set(const char    *uri,
+               restconf_media media,
+               uint64_t       hash,
+               cbuf          *body)
+{
+    int                 retval = -1;
+    struct data_cache  *dc;
+    struct data_cache **dcp;
+    cbuf               *cbkey = NULL;
+    cbuf               *cb = NULL;
+    int                 nr = 0;
+
+    if ((cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbkey, "%s|%d", uri, media);
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cbuf_append_buf(cb, cbuf_get(body), cbuf_len(body));
+    /* Remove existing entry with same key, evict tail when full */
+    for (dcp = &_data_cache; (dc = *dcp) != NULL; ){
+        if (strcmp(dc->dc_key, cbuf_get(cbkey)) == 0 ||
+            (++nr >= DATA_CACHE_MAX && dc->dc_next == NULL)){
+            *dcp = dc->dc_next;
+            free(dc->dc_key);
+            cbuf_free(dc->dc_body);
+            free(dc);
+            continue;
+        }
+        dcp = &dc->dc_next;
+    }
+    if ((dc = malloc(sizeof(*dc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(dc, 0, sizeof(*dc));
+    if ((dc->dc_key = strdup(cbuf_get(cbkey))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(dc);
+        goto done;
+    }
+    dc->dc_hash = hash;
+    dc->dc_body = cb;
+    cb = NULL;
+    dc->dc_next = _data_cache;
+    _data_cache = dc;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (cbkey)
+        cbuf_free(cbkey);
+    return retval;
+}
+
 /*! Generic GET (both HEAD and GET)
  * According to restconf 
  * @param[in]  h        Clixon handle
@@ -120,12 +282,13 @@ api_data_get2(clicon_handle  h,
     char      *attr; /* attribute value string */
     netconf_content content = CONTENT_ALL;
     int32_t    depth = -1;  /* Nr of levels to print, -1 is all, 0 is none */
-    cxobj     *xtop = NULL;
-    cxobj     *xbot = NULL;
     yang_stmt *y = NULL;
     char      *defaults = NULL;
     cvec      *nscd = NULL;
-    
+    uint64_t   hash;
+    char       etag[32];
+    char      *uri;
+
     clicon_debug(1, "%s", __FUNCTION__);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_FATAL, 0, "No DB_SPEC");
@@ -135,16 +298,10 @@ api_data_get2(clicon_handle  h,
     for (i=0; i<pi; i++)
         api_path = index(api_path+1, '/');
     if (api_path){
-        if ((xtop = xml_new("top", NULL, CX_ELMNT)) == NULL)
-            goto done;
-        /* Translate api-path to xml, but to validate the api-path, note: strict=1 
-         * xtop and xbot unnecessary for this function but needed by function
+        /* Validate api-path (strict=1) and translate to xpath (cbpath) and namespace
+         * context (nsc), cached over requests
          */
-        if ((ret = api_path2xml(api_path, yspec, xtop, YC_DATANODE, 1, &xbot, &y, &xerr)) < 0)
-            goto done;
-        /* Translate api-path to xpath: xpath (cbpath) and namespace context (nsc) */
-        if (ret != 0 &&
-            (ret = api_path2xpath(api_path, yspec, &xpath, &nsc, &xerr)) < 0)
+        if ((ret = restconf_apipath2xpath(h, api_path, yspec, 1, &xpath, &nsc, &y, &xerr)) < 0)
             goto done;
         if (ret == 0){ /* validation failed */
             if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
@@ -223,7 +380,26 @@ api_data_get2(clicon_handle  h,
             goto done;
         goto ok;
     }
+    /* Strong etag: hash of the returned tree and the output encoding */
+    hash = data_tree_hash(0xcbf29ce484222325ULL + 2*media_out + pretty, xret);
+    snprintf(etag, sizeof(etag), "\"%016" PRIx64 "\"", hash);
+    if ((attr = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL &&
+        strcmp(attr, etag) == 0){
+        /* RFC 7232: reply 304 with the etag and no body */
+        if (restconf_reply_header(req, "ETag", "%s", etag) < 0)
+            goto done;
+        if (restconf_reply_send(req, 304, NULL, head) < 0)
+            goto done;
+        goto ok;
+    }
+    uri = restconf_param_get(h, "REQUEST_URI");
     /* Normal return, no error */
+    if (uri != NULL){
+        if (data_cache_get(uri, media_out, hash, &cbx) < 0)
+            goto done;
+        if (cbx != NULL) /* Unchanged tree: reuse cached rendering */
+            goto send;
+    }
     if ((cbx = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -290,9 +466,15 @@ api_data_get2(clicon_handle  h,
             break;
         }
     }
+    if (uri != NULL &&
+        data_cache_set(uri, media_out, hash, cbx) < 0)
+        goto done;
+ send:
     clicon_debug(1, "%s cbuf:%s", __FUNCTION__, cbuf_get(cbx));
     if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
         goto done;
+    if (restconf_reply_header(req, "ETag", "%s", etag) < 0)
+        goto done;
     if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
         goto done;
     if (restconf_reply_send(req, 200, cbx, head) < 0)
@@ -308,8 +490,6 @@ api_data_get2(clicon_handle  h,
         cvec_free(nscd);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (xtop)
-        xml_free(xtop);
     if (cbx)
         cbuf_free(cbx);
     if (xret)
@@ -362,8 +542,6 @@ api_data_pagination(clicon_handle  h,
     cvec      *nsc = NULL;
     char      *attr; /* attribute value string */
     netconf_content content = CONTENT_ALL;
-    cxobj     *xtop = NULL;
-    cxobj     *xbot = NULL;
     cxobj     *xp;
     cxobj     *xpr = NULL;
     yang_stmt *y = NULL;
@@ -385,19 +563,11 @@ api_data_pagination(clicon_handle  h,
     for (i=0; i<pi; i++)
         api_path = index(api_path+1, '/');
     if (api_path){
-        if ((xtop = xml_new("top", NULL, CX_ELMNT)) == NULL)
-            goto done;
-        /* Translate api-path to xml, but to validate the api-path, note: strict=1 
-         * xtop and xbot unnecessary for this function but needed by function
-         * Set strict=0 to accept list uri:s with =keys syntax
-         */
-        if ((ret = api_path2xml(api_path, yspec, xtop, YC_DATANODE, 0, &xbot, &y, &xerr)) < 0)
-            goto done;
-        /* Translate api-path to xpath: xpath (cbpath) and namespace context (nsc) 
+        /* Validate api-path and translate to xpath (cbpath) and namespace context (nsc),
+         * cached over requests. Strict=0 to accept list uri:s with =keys syntax
          * XXX: xpath not used in collection?
          */
-        if (ret != 0 &&
-            (ret = api_path2xpath(api_path, yspec, &xpath, &nsc, &xerr)) < 0)
+        if ((ret = restconf_apipath2xpath(h, api_path, yspec, 0, &xpath, &nsc, &y, &xerr)) < 0)
             goto done;
         if (ret == 0){ /* validation failed */
             if ((xe = xpath_first(xerr, NULL, "rpc-error")) == NULL){
@@ -571,8 +741,6 @@ api_data_pagination(clicon_handle  h,
         xml_nsctx_free(nsc);
     if (xpr)
         xml_free(xpr);
-    if (xtop)
-        xml_free(xtop);
     if (cbx)
         cbuf_free(cbx);
     if (xret)
@@ -761,12 +761,22 @@ restconf_http1_process(restconf_conn *rc,
     if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
                                 rc, __FUNCTION__)) < 0)
         goto done;
+    /* The body is written after the headers instead of copied into the header
+     * buffer, and freed as soon as it is on the socket, so a large GET reply
+     * is held in one copy only and for no longer than the write takes
+     */
+    if (ret == 1 && sd->sd_body && cbuf_len(sd->sd_body))
+        if ((ret = native_buf_write(h, cbuf_get(sd->sd_body), cbuf_len(sd->sd_body),
+                                    rc, __FUNCTION__)) < 0)
+            goto done;
     cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
     cbuf_reset(sd->sd_outp_buf);
     cbuf_reset(sd->sd_inbuf);
     cbuf_reset(sd->sd_indata);
-    if (sd->sd_body)
-        cbuf_reset(sd->sd_body);
+    if (sd->sd_body){
+        cbuf_free(sd->sd_body);
+        sd->sd_body = NULL;
+    }
     if (sd->sd_qvec){
         cvec_free(sd->sd_qvec);
         sd->sd_qvec = NULL;
@@ -1094,6 +1104,12 @@ restconf_close_ssl_socket(restconf_conn *rc,
         SSL_free(rc->rc_ssl);
         rc->rc_ssl = NULL;
     }
+#ifdef HAVE_LIBNGHTTP2
+    if (rc->rc_ngwrite){ /* Pending deferred frames are dropped with the connection */
+        clixon_event_unreg_fd_write(rc->rc_s, http2_session_drain);
+        rc->rc_ngwrite = 0;
+    }
+#endif
     if (restconf_connection_close1(rc) < 0)
         goto done;
     if (restconf_conn_free(rc) < 0)
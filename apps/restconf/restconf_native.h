@@ -117,6 +117,8 @@ typedef struct restconf_conn {
      * drawback is specific includes need to go everywhere */
 #ifdef HAVE_LIBNGHTTP2
     nghttp2_session      *rc_ngsession; /* XXX Not sure it is needed */
+    int                   rc_ngwrite;   /* Write-readiness callback registered for deferred
+                                           frames, see http2_session_drain */
 #endif
     restconf_socket      *rc_socket;    /* Backpointer to restconf_socket needed for callhome */
     struct timeval        rc_t;         /* Timestamp of last read/write activity, used by callhome
@@ -148,14 +148,45 @@ nghttp2_print_headers(nghttp2_nv *nva,
 }
 #endif /* NOTUSED */
 
+/*! Resume sending deferred http/2 frames when the socket is writable again
+ *
+ * Registered by session_send_callback when a socket write would block.
+ * nghttp2 keeps the pending frames and re-offers them in priority order, so
+ * a small API reply is not queued behind a bulk download whose socket or
+ * stream window is full, and the event loop is never blocked on one slow
+ * peer.
+ * @param[in]  s    Socket
+ * @param[in]  arg  Restconf connection
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+http2_session_drain(int   s,
+                    void *arg)
+{
+    restconf_conn *rc = (restconf_conn *)arg;
+    nghttp2_error  ngerr;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    clixon_event_unreg_fd_write(s, http2_session_drain);
+    rc->rc_ngwrite = 0;
+    if (rc->rc_ngsession == NULL)
+        return 0;
+    clicon_err_reset();
+    if ((ngerr = nghttp2_session_send(rc->rc_ngsession)) != 0)
+        if (clicon_errno)
+            return -1;
+    return 0;
+}
+
 /*! Send data to remote peer, Send at most the |length| bytes of |data|.
  * This callback is required if the application uses
  * `nghttp2_session_send()` to send data to the remote endpoint.  If
  * the application uses solely `nghttp2_session_mem_send()` instead,
  * this callback function is unnecessary.
- * It must return the number of bytes sent if it succeeds.  
+ * It must return the number of bytes sent if it succeeds.
  * If it cannot send any single byte without blocking,
- * it must return :enum:`NGHTTP2_ERR_WOULDBLOCK`.  
+ * it must return :enum:`NGHTTP2_ERR_WOULDBLOCK`.
  * For other errors, it must return :enum:`NGHTTP2_ERR_CALLBACK_FAILURE`.
  */
 static ssize_t
@@ -184,8 +215,7 @@ session_send_callback(nghttp2_session *session,
                 switch (sslerr){
                 case SSL_ERROR_WANT_WRITE:           /* 3 */
                     clicon_debug(1, "%s write SSL_ERROR_WANT_WRITE", __FUNCTION__);
-                    usleep(1000);
-                    continue;
+                    goto wouldblock;
                     break;
                 case SSL_ERROR_SYSCALL:              /* 5 */
                     if (er == ECONNRESET || /* Connection reset by peer */
@@ -193,13 +223,12 @@ session_send_callback(nghttp2_session *session,
                         goto done; /* Cleanup in http2_recv() */
                     }
                     else if (er == EAGAIN){
-                        /* same as want_write above, but different behaviour on different 
+                        /* same as want_write above, but different behaviour on different
                          * platforms, linux here, freebsd want_write, or possibly differnt
                          * ssl lib versions?
                          */
                         clicon_debug(1, "%s write EAGAIN", __FUNCTION__);
-                        usleep(1000);
-                        continue;
+                        goto wouldblock;
                     }
                     else{
                         clicon_err(OE_RESTCONF, er, "SSL_write %d", sslerr);
@@ -218,8 +247,7 @@ session_send_callback(nghttp2_session *session,
             if ((len = write(s, buf+totlen, buflen-totlen)) < 0){
                 if (errno == EAGAIN){
                     clicon_debug(1, "%s write EAGAIN", __FUNCTION__);
-                    usleep(10000);
-                    continue;
+                    goto wouldblock;
                 }
 #if 1
                 else if (errno == ECONNRESET) {/* Connection reset by peer */
@@ -249,6 +277,19 @@ session_send_callback(nghttp2_session *session,
     }
     clicon_debug(1, "%s retval:%zd", __FUNCTION__, totlen);
     return retval == 0 ? totlen : retval;
+ wouldblock:
+    /* Let the event loop resume when the socket drains instead of busy-
+     * waiting here: nghttp2 keeps the remaining frames and they are
+     * re-offered in priority order by http2_session_drain. Partial progress
+     * is reported as such
+     */
+    if (rc->rc_ngwrite == 0){
+        if (clixon_event_reg_fd_write(s, http2_session_drain, rc, "http2 write drain") < 0)
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        rc->rc_ngwrite = 1;
+    }
+    clicon_debug(1, "%s wouldblock totlen:%zd", __FUNCTION__, totlen);
+    return totlen > 0 ? totlen : NGHTTP2_ERR_WOULDBLOCK;
 }
 
 /*! Invoked when |session| wants to receive data from the remote peer.  
@@ -471,6 +471,9 @@ api_root_restconf(clicon_handle        h,
         errno = EINVAL;
         goto done;
     }
+    /* New request: fresh correlation id, carried on backend messages */
+    clixon_trace_id_new();
+    clixon_trace_stage("restconf-request");
     request_method = restconf_param_get(h, "REQUEST_METHOD");
     if ((path = restconf_uripath(h)) == NULL)
         goto done;
@@ -208,9 +208,10 @@ restconf_stream_cb(int   s,
     cxobj             *xtop = NULL; /* top xml */
     cxobj             *xn;        /* notification xml */
     cbuf              *cb = NULL;
+    char              *body;
     int                pretty = 0; /* XXX should be via arg */
     int                ret;
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
     /* get msg (this is the reason this function is called) */
     if (clicon_msg_rcv(s, &reply, &eof) < 0){
@@ -229,6 +230,21 @@ restconf_stream_cb(int   s,
         clixon_exit_set(1); 
         goto done;
     }
+    /* The backend renders each event once and sends the same encoding to all
+     * subscribers, see stream_notify1. When the body is a bare notification
+     * element, frame it as-is: no per-client, per-event XML parse and
+     * re-rendering. Anything else falls through to the parsing path below.
+     */
+    body = reply->op_body;
+    while (*body == ' ' || *body == '\t' || *body == '\r' || *body == '\n')
+        body++;
+    if (strncmp(body, "<notification", 13) == 0 &&
+        (body[13] == '>' || body[13] == ' ')){
+        FCGX_FPrintF(r->out, "data: %s\r\n", body);
+        FCGX_FPrintF(r->out, "\r\n");
+        FCGX_FFlush(r->out);
+        goto ok;
+    }
     if ((ret = clicon_msg_decode(reply, NULL, NULL, &xtop, NULL)) < 0)  /* XXX pass yang_spec */
         goto done;
     if (ret == 0){
@@ -38,11 +38,13 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <pwd.h>
 #include <syslog.h>
 #include <errno.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <signal.h>
 
 /* net-snmp */
@@ -60,6 +62,13 @@
 #include "snmp_register.h"
 #include "snmp_handler.h"
 
+/*
+ * Forward declarations
+ */
+static int snmp_oidx_build(clicon_handle h, yang_stmt *ylist, clixon_snmp_handle *sh);
+static struct clixon_snmp_oidx *snmp_oidx_get(clixon_snmp_handle *sh);
+static struct clixon_snmp_oidx_ent *snmp_oidx_find(struct clixon_snmp_oidx *oix, oid *oids, size_t oidslen);
+
 /*! Common code for handling incoming SNMP request
  * 
  * Get clixon handle from snmp request, print debug data
@@ -829,7 +838,7 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
  * Create xpath with right keys from later part of OID
  * Query clixon if object exists, if so return value
  * @param[in]  h        Clixon handle
- * @param[in]  yt       Yang of table (of list type)
+ * @param[in]  sh       Clixon snmp handle of table (sh_ys is list yang)
  * @param[in]  oidt     OID of registered top container object (above list), may be different from yt
  * @param[in]  oidtlen  OID length of list object OID
  * @param[in]  oids     OID of ultimate scalar value
@@ -839,10 +848,14 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
  * @retval     -1       Error
  * @retval     0        Object not found
  * @retval     1        OK
+ * @note If a fresh OID index is cached in sh (prefetched per-PDU, see
+ *       clixon_snmp_table_handler) the object is resolved from it without a
+ *       backend round-trip; absent objects fall through to the per-object
+ *       fetch which handles SMI default values.
  */
 static int
 snmp_table_get(clicon_handle               h,
-               yang_stmt                  *yt,
+               clixon_snmp_handle         *sh,
                oid                        *oidt,
                size_t                      oidtlen,
                oid                        *oids,
@@ -851,6 +864,7 @@ snmp_table_get(clicon_handle               h,
                netsnmp_request_info       *request)
 {
     int        retval = -1;
+    yang_stmt *yt = sh->sh_ys;
     oid        oidleaf[MAX_OID_LEN] = {0,}; /* Leaf */
     size_t     oidleaflen = MAX_OID_LEN;
     oid       *oidi;
@@ -863,8 +877,19 @@ snmp_table_get(clicon_handle               h,
     int        i;
     cg_var    *cv;
     char      *defaultval = NULL;
+    struct clixon_snmp_oidx     *oix;
+    struct clixon_snmp_oidx_ent *oe;
     int        ret;
 
+    /* Resolve from cached OID index if one is fresh: no backend round-trip */
+    if ((oix = snmp_oidx_get(sh)) != NULL &&
+        (oe = snmp_oidx_find(oix, oids, oidslen)) != NULL){
+        if (snmp_scalar_return(oe->oe_xml, oe->oe_yang, oe->oe_oid, oe->oe_oidlen,
+                               reqinfo, request) < 0)
+            goto done;
+        retval = 1;
+        goto done;
+    }
     /* Get yang of leaf from first part of OID */
     ys = NULL;
     while ((ys = yn_each(yt, ys)) != NULL) {
@@ -1151,27 +1176,65 @@ snmp_table_set(clicon_handle               h,
     goto done;
 }
 
-/*! Find "next" object from oids minus key and return that.
- * @param[in]  h        Clixon handle
- * @param[in]  ylist    Yang of table (of list type)
- * @param[in]  oids     OID of ultimate scalar value
- * @param[in]  oidslen  OID length of scalar
- * @param[in]  reqinfo  Agent transaction request structure
- * @param[in]  request The netsnmp request info structure.
- * @retval     1        OK
- * @retval     0        Failed
- * @retval    -1        Error
- * XXX: merge with cache
+/*! qsort/bsearch compare of OID index entries, delegates to oid_eq
+ * @param[in]  p0  First entry
+ * @param[in]  p1  Second entry
+ * @retval     <0, 0, >0
  */
 static int
-snmp_table_getnext(clicon_handle               h,
-                   yang_stmt                  *ylist,
-                   oid                        *oids,
-                   size_t                      oidslen,
-                   netsnmp_agent_request_info *reqinfo,
-                   netsnmp_request_info       *request)
+snmp_oidx_cmp(const void *p0,
+              const void *p1)
+{
+    const struct clixon_snmp_oidx_ent *e0 = (const struct clixon_snmp_oidx_ent *)p0;
+    const struct clixon_snmp_oidx_ent *e1 = (const struct clixon_snmp_oidx_ent *)p1;
+
+    return oid_eq(e0->oe_oid, e0->oe_oidlen, e1->oe_oid, e1->oe_oidlen);
+}
+
+/*! Check that a yang subtree contains no state (config false) nodes
+ * @param[in]  yn  Yang node
+ * @retval     1   Config only
+ * @retval     0   Node or some descendant is state data
+ */
+static int
+yang_config_subtree(yang_stmt *yn)
+{
+    yang_stmt *ys = NULL;
+
+    if (yang_config(yn) == 0)
+        return 0;
+    while ((ys = yn_each(yn, ys)) != NULL){
+        if (!yang_datanode(ys))
+            continue;
+        if (yang_config_subtree(ys) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+/*! Build sorted OID index over current table contents and cache in handle
+ *
+ * Read the whole table from the datastore and construct a vector of all
+ * column instance OIDs sorted by oid_eq, so that the GETNEXT steps of a table
+ * walk can binary-search the next OID instead of re-reading the table and
+ * scanning all rows and columns per step.
+ * The index expires after CLIXON_SNMP_OIDX_TIMEOUT_MS and is dropped on any
+ * SET on the table, see clixon_snmp_table_handler1.
+ * @param[in]  h      Clixon handle
+ * @param[in]  ylist  Yang of table (of list type)
+ * @param[in]  sh     Clixon snmp handle where the index is cached
+ * @retval     0      OK, sh->sh_oidx replaced
+ * @retval    -1      Error
+ * @see snmp_oidx_next  for the lookup
+ */
+static int
+snmp_oidx_build(clicon_handle       h,
+                yang_stmt          *ylist,
+                clixon_snmp_handle *sh)
 {
     int        retval = -1;
+    struct clixon_snmp_oidx     *oix = NULL;
+    struct clixon_snmp_oidx_ent *oe;
     cvec      *nsc = NULL;
     char      *xpath = NULL;
     cxobj     *xt = NULL;
@@ -1181,20 +1244,16 @@ snmp_table_getnext(clicon_handle               h,
     cxobj     *xcol;
     yang_stmt *ycol;
     yang_stmt *ys;
-    int        ret;
     cvec      *cvk_name;
-    oid        oidc[MAX_OID_LEN] = {0,}; /* Table / list oid */
-    size_t     oidclen = MAX_OID_LEN;
+    oid        oidc[MAX_OID_LEN] = {0,}; /* Column oid */
+    size_t     oidclen;
     oid        oidk[MAX_OID_LEN] = {0,}; /* Key oid */
-    size_t     oidklen = MAX_OID_LEN;
-    oid        oidnext[MAX_OID_LEN] = {0x7fffffff,}; /* Next oid: start with high value */
-    size_t     oidnextlen = MAX_OID_LEN;
-    int        found = 0; 
-    cxobj     *xnext = NULL;
-    yang_stmt *ynext = NULL;
-    cbuf      *cb = NULL;
+    size_t     oidklen;
+    size_t     nalloc = 0;
+    int        config;
+    uint64_t   gen = 0;
+    int        ret;
 
-    clicon_debug(1, "%s", __FUNCTION__);
     if ((ys = yang_parent_get(ylist)) == NULL ||
         yang_keyword_get(ys) != Y_CONTAINER){
         clicon_err(OE_YANG, EINVAL, "ylist parent is not list");
@@ -1204,12 +1263,24 @@ snmp_table_getnext(clicon_handle               h,
         goto done;
     if (snmp_yang2xpath(ys, NULL, &xpath) < 0)
         goto done;
+    /* Config-only tables are kept across the timeout while the datastore
+     * generation holds, see snmp_oidx_get. Sample the generation before the
+     * fetch so a commit in between invalidates on the next check.
+     */
+    config = yang_config_ancestor(ylist) && yang_config_subtree(ylist);
+    if (config && clicon_rpc_generation(h, &gen) < 0)
+        config = 0;
     if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
         goto done;
     if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
         clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
         goto done;
     }
+    if ((oix = malloc(sizeof(*oix))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(oix, 0, sizeof(*oix));
     if ((xtable = xpath_first(xt, nsc, "%s", xpath)) != NULL) {
         /* Make a clone of key-list, but replace names with values */
         if ((cvk_name = yang_cvec_get(ylist)) == NULL){
@@ -1219,7 +1290,8 @@ snmp_table_getnext(clicon_handle               h,
         xrow = NULL;
         while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
             /* Get key part of OID from XML list entry */
-            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, /*&cvk_oid,*/ oidk, &oidklen)) < 0)
+            oidklen = MAX_OID_LEN;
+            if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, oidk, &oidklen)) < 0)
                 goto done;
             if (ret == 0)
                 continue; /* skip row, not all indexes */
@@ -1229,46 +1301,204 @@ snmp_table_getnext(clicon_handle               h,
                     continue;
                 if (yang_keyword_get(ycol) != Y_LEAF)
                     continue;
+                oidclen = MAX_OID_LEN;
                 if ((ret = yangext_oid_get(ycol, oidc, &oidclen, NULL)) < 0)
                     goto done;
+                if (ret == 0)
+                    continue;
                 /* Append key oid */
                 if (oid_append(oidc, &oidclen, oidk, oidklen) < 0)
                     goto done;
-                /* Get smallest larger */
-                if (oid_eq(oidc, oidclen, oids, oidslen) > 0 &&
-                    oid_eq(oidc, oidclen, oidnext, oidnextlen) < 0){
-                    memcpy(oidnext, oidc, oidclen*sizeof(*oidnext));
-                    oidnextlen = oidclen;
-                    xnext = xcol;
-                    ynext = ycol;
-                    found++;
+                if (oix->oix_len == nalloc){
+                    nalloc = nalloc ? 2*nalloc : 64;
+                    if ((oe = realloc(oix->oix_vec, nalloc*sizeof(*oe))) == NULL){
+                        clicon_err(OE_UNIX, errno, "realloc");
+                        goto done;
+                    }
+                    oix->oix_vec = oe;
                 }
+                oe = &oix->oix_vec[oix->oix_len++];
+                memset(oe, 0, sizeof(*oe));
+                memcpy(oe->oe_oid, oidc, oidclen*sizeof(oid));
+                oe->oe_oidlen = oidclen;
+                oe->oe_xml = xcol;
+                oe->oe_yang = ycol;
             } /* while xcol */
         } /* while xrow */
     }
-    if (found){
-        if (snmp_scalar_return(xnext, ynext, oidnext, oidnextlen, reqinfo, request) < 0)
-            goto done;
-        if ((cb = cbuf_new()) == NULL){
-            clicon_err(OE_UNIX, errno, "cbuf_new");
-            goto done;
-        }
-        oid_cbuf(cb, oidnext, oidnextlen);
-        clicon_debug(1, "%s next: %s", __FUNCTION__, cbuf_get(cb));
-    }
-    retval = found;
+    if (oix->oix_len)
+        qsort(oix->oix_vec, oix->oix_len, sizeof(*oix->oix_vec), snmp_oidx_cmp);
+    oix->oix_xml = xt; /* index entries point into this tree */
+    xt = NULL;
+    oix->oix_config = config;
+    oix->oix_gen = gen;
+    gettimeofday(&oix->oix_time, NULL);
+    if (sh->sh_oidx)
+        snmp_oidx_free(sh->sh_oidx);
+    sh->sh_oidx = oix;
+    oix = NULL;
+    retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
+    if (oix)
+        snmp_oidx_free(oix);
     if (xpath)
         free(xpath);
     if (xt)
         xml_free(xt);
     if (nsc)
-        xml_nsctx_free(nsc);    
+        xml_nsctx_free(nsc);
     return retval;
 }
 
+/*! Binary search for smallest indexed OID strictly larger than given OID
+ * @param[in]  oix      Sorted OID index, see snmp_oidx_build
+ * @param[in]  oids     OID to search from
+ * @param[in]  oidslen  OID length
+ * @retval     oe       Next entry
+ * @retval     NULL     No larger OID in index
+ */
+static struct clixon_snmp_oidx_ent *
+snmp_oidx_next(struct clixon_snmp_oidx *oix,
+               oid                     *oids,
+               size_t                   oidslen)
+{
+    size_t lo = 0;
+    size_t hi = oix->oix_len;
+    size_t mid;
+
+    while (lo < hi){
+        mid = (lo + hi) / 2;
+        if (oid_eq(oix->oix_vec[mid].oe_oid, oix->oix_vec[mid].oe_oidlen,
+                   oids, oidslen) > 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo < oix->oix_len ? &oix->oix_vec[lo] : NULL;
+}
+
+/*! Binary search for exact OID in sorted index
+ * @param[in]  oix      Sorted OID index, see snmp_oidx_build
+ * @param[in]  oids     OID to find
+ * @param[in]  oidslen  OID length
+ * @retval     oe       Matching entry
+ * @retval     NULL     Not in index
+ */
+static struct clixon_snmp_oidx_ent *
+snmp_oidx_find(struct clixon_snmp_oidx *oix,
+               oid                     *oids,
+               size_t                   oidslen)
+{
+    size_t lo = 0;
+    size_t hi = oix->oix_len;
+    size_t mid;
+    int    ret;
+
+    while (lo < hi){
+        mid = (lo + hi) / 2;
+        ret = oid_eq(oix->oix_vec[mid].oe_oid, oix->oix_vec[mid].oe_oidlen,
+                     oids, oidslen);
+        if (ret == 0)
+            return &oix->oix_vec[mid];
+        if (ret > 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+/*! Return cached OID index if still fresh, expire and free it otherwise
+ *
+ * On timeout, a config-only table first asks the backend for the running
+ * datastore generation: if nothing has been committed since the index was
+ * built it is kept, so steady-state polling costs one small generation RPC
+ * per timeout instead of a table fetch and conversion.
+ * @param[in]  sh   Clixon snmp handle of table
+ * @retval     oix  Fresh index
+ * @retval     NULL No index, or expired (then freed and cleared in sh)
+ */
+static struct clixon_snmp_oidx *
+snmp_oidx_get(clixon_snmp_handle *sh)
+{
+    struct clixon_snmp_oidx *oix;
+    struct timeval           now;
+    long                     age;
+    uint64_t                 gen;
+
+    if ((oix = sh->sh_oidx) == NULL)
+        return NULL;
+    gettimeofday(&now, NULL);
+    age = (now.tv_sec - oix->oix_time.tv_sec)*1000 +
+        (now.tv_usec - oix->oix_time.tv_usec)/1000;
+    if (age > CLIXON_SNMP_OIDX_TIMEOUT_MS){
+        if (oix->oix_config &&
+            clicon_rpc_generation(sh->sh_h, &gen) == 0 &&
+            gen == oix->oix_gen){
+            oix->oix_time = now; /* unchanged since build, keep index */
+            return oix;
+        }
+        snmp_oidx_free(oix);
+        sh->sh_oidx = NULL;
+        return NULL;
+    }
+    return oix;
+}
+
+/*! Find "next" object from oids minus key and return that.
+ * @param[in]  h        Clixon handle
+ * @param[in]  sh       Clixon snmp handle of table
+ * @param[in]  oids     OID of ultimate scalar value
+ * @param[in]  oidslen  OID length of scalar
+ * @param[in]  reqinfo  Agent transaction request structure
+ * @param[in]  request The netsnmp request info structure.
+ * @retval     1        OK
+ * @retval     0        Failed
+ * @retval    -1        Error
+ * @note Uses a sorted OID index cached in sh over the table contents, rebuilt
+ *       when older than CLIXON_SNMP_OIDX_TIMEOUT_MS, so a walk sees a table
+ *       snapshot at most that old.
+ */
+static int
+snmp_table_getnext(clicon_handle               h,
+                   clixon_snmp_handle         *sh,
+                   oid                        *oids,
+                   size_t                      oidslen,
+                   netsnmp_agent_request_info *reqinfo,
+                   netsnmp_request_info       *request)
+{
+    int                          retval = -1;
+    struct clixon_snmp_oidx     *oix;
+    struct clixon_snmp_oidx_ent *oe;
+    cbuf                        *cb = NULL;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if ((oix = snmp_oidx_get(sh)) == NULL){
+        if (snmp_oidx_build(h, sh->sh_ys, sh) < 0)
+            goto done;
+        oix = sh->sh_oidx;
+    }
+    if ((oe = snmp_oidx_next(oix, oids, oidslen)) == NULL)
+        goto fail;
+    if (snmp_scalar_return(oe->oe_xml, oe->oe_yang, oe->oe_oid, oe->oe_oidlen,
+                           reqinfo, request) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    oid_cbuf(cb, oe->oe_oid, oe->oe_oidlen);
+    clicon_debug(1, "%s next: %s", __FUNCTION__, cbuf_get(cb));
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! SNMP table operation handler
  *
  * @param[in]  handler Registered MIB handler structure
@@ -1298,13 +1528,19 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         clicon_debug(1, "%s Error table not registered", __FUNCTION__);
         goto ok;
     }
+    /* Any SET drops the cached GETNEXT index, see snmp_table_getnext */
+    if (reqinfo->mode != MODE_GET && reqinfo->mode != MODE_GETNEXT &&
+        sh->sh_oidx != NULL){
+        snmp_oidx_free(sh->sh_oidx);
+        sh->sh_oidx = NULL;
+    }
     requestvb = request->requestvb;
     switch(reqinfo->mode){
     case MODE_GET: // 160
         /* Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
          */
-        if ((ret = snmp_table_get(sh->sh_h, sh->sh_ys,
-                                  sh->sh_oid2, sh->sh_oid2len, 
+        if ((ret = snmp_table_get(sh->sh_h, sh,
+                                  sh->sh_oid2, sh->sh_oid2len,
                                   requestvb->name, requestvb->name_length,
                                   reqinfo, request)) < 0)
             goto done;
@@ -1318,7 +1554,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         break;
     case MODE_GETNEXT: // 161
         /* Register table sub-oid:s of existing entries in clixon */
-        if ((ret = snmp_table_getnext(sh->sh_h, sh->sh_ys,
+        if ((ret = snmp_table_getnext(sh->sh_h, sh,
                                       requestvb->name, requestvb->name_length,
                                       reqinfo, request)) < 0)
             goto done;
@@ -1409,9 +1645,22 @@ clixon_snmp_table_handler(netsnmp_mib_handler          *handler,
 {
     int                   retval = -1;
     netsnmp_request_info *req;
+    clixon_snmp_handle   *sh;
     int                   ret;
 
     clicon_debug(1, "%s", __FUNCTION__);
+    /* Batch: a GET with several varbinds on this table is resolved from one
+     * datastore fetch, prefetch the OID index here, see snmp_table_get.
+     * GETNEXT/GETBULK repetitions build and share it on demand.
+     */
+    if (reqinfo->mode == MODE_GET &&
+        requests && requests->next &&
+        (sh = (clixon_snmp_handle*)handler->myvoid) != NULL &&
+        sh->sh_ys != NULL &&
+        snmp_oidx_get(sh) == NULL){
+        if (snmp_oidx_build(sh->sh_h, sh->sh_ys, sh) < 0)
+            goto done;
+    }
     for (req = requests; req; req = req->next){
         ret = clixon_snmp_table_handler1(handler, nhreg, reqinfo, req);
         if (ret != SNMP_ERR_NOERROR){
@@ -318,7 +318,85 @@ snmp_yang_type_get(yang_stmt  *ys,
     return retval;
 }
 
-/*! Given a YANG node, return SMIv2 oid extension as OID 
+/* One entry of the MIB-YANG mapping cache, see snmp_ymap_get
+ */
+struct snmp_ymap_ent {
+    yang_stmt *ye_ys;               /* Yang node (key) */
+    oid        ye_oid[MAX_OID_LEN]; /* OID from smiv2:oid extension */
+    size_t     ye_oidlen;
+    char      *ye_oidstr;           /* Extension string (direct, not malloced) */
+    int        ye_found;            /* 0: node has no OID extension */
+    int        ye_asn1[2];          /* ASN.1 type per extended flag, -1: not set */
+};
+
+/* MIB-YANG mapping cache: flat vector sorted by yang node pointer.
+ * Populated during the startup registration traversal, which resolves the
+ * smiv2 extensions and types of every mapped node, so that per-request
+ * mapping work is a binary search only, see yangext_oid_get/type_yang2asn1.
+ */
+static struct snmp_ymap_ent *_ymap_vec = NULL;
+static size_t                _ymap_len = 0;
+static size_t                _ymap_size = 0;
+
+/*! Find cache entry of yang node, create it at sorted position if not found
+ * @param[in]  yn  Yang node
+ * @param[out] newent  Set to 1 if entry was created (uninitialized mapping)
+ * @retval     ye  Cache entry
+ * @retval     NULL Error
+ */
+static struct snmp_ymap_ent *
+snmp_ymap_get(yang_stmt *yn,
+              int       *newent)
+{
+    struct snmp_ymap_ent *ye;
+    size_t                lo = 0;
+    size_t                hi = _ymap_len;
+    size_t                mid;
+
+    while (lo < hi){
+        mid = (lo + hi) / 2;
+        if (_ymap_vec[mid].ye_ys == yn){
+            *newent = 0;
+            return &_ymap_vec[mid];
+        }
+        if (_ymap_vec[mid].ye_ys > yn)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    if (_ymap_len == _ymap_size){
+        _ymap_size = _ymap_size ? 2*_ymap_size : 512;
+        if ((ye = realloc(_ymap_vec, _ymap_size*sizeof(*ye))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return NULL;
+        }
+        _ymap_vec = ye;
+    }
+    ye = &_ymap_vec[lo];
+    memmove(ye+1, ye, (_ymap_len-lo)*sizeof(*ye));
+    _ymap_len++;
+    memset(ye, 0, sizeof(*ye));
+    ye->ye_ys = yn;
+    ye->ye_asn1[0] = -1;
+    ye->ye_asn1[1] = -1;
+    *newent = 1;
+    return ye;
+}
+
+/*! Free the MIB-YANG mapping cache, called at exit
+ * @see snmp_terminate
+ */
+void
+snmp_ymap_clear(void)
+{
+    if (_ymap_vec)
+        free(_ymap_vec);
+    _ymap_vec = NULL;
+    _ymap_len = 0;
+    _ymap_size = 0;
+}
+
+/*! Given a YANG node, return SMIv2 oid extension as OID
  * @param[in]  yn        Yang node
  * @param[out] objid     OID vector, assume allocated with MAX_OID_LEN > oidlen
  * @param[out] objidlen  Length of OID vector on return
@@ -326,6 +404,7 @@ snmp_yang_type_get(yang_stmt  *ys,
  * @retval     1         OK
  * @retval     0         Invalid, not found
  * @retval    -1         Error
+ * @note Resolved mappings are cached per yang node, repeated calls are lookups
  */
 int
 yangext_oid_get(yang_stmt *yn,
@@ -337,7 +416,21 @@ yangext_oid_get(yang_stmt *yn,
     int        exist = 0;
     char      *oidstr = NULL;
     yang_stmt *yref = NULL;
-    
+    struct snmp_ymap_ent *ye;
+    int        newent = 0;
+
+    if ((ye = snmp_ymap_get(yn, &newent)) == NULL)
+        goto done;
+    if (newent == 0){            /* cache hit */
+        if (ye->ye_found == 0)
+            goto fail;
+        memcpy(objid, ye->ye_oid, ye->ye_oidlen*sizeof(oid));
+        *objidlen = ye->ye_oidlen;
+        if (objidstrp)
+            *objidstrp = ye->ye_oidstr;
+        retval = 1;
+        goto done;
+    }
     if (yang_keyword_get(yn) == Y_LEAF){
         if (snmp_yang_type_get(yn, &yref, NULL, NULL, NULL) < 0)
             goto done;
@@ -355,6 +448,10 @@ yangext_oid_get(yang_stmt *yn,
         clicon_err(OE_XML, errno, "snmp_parse_oid");
         goto done;
     }
+    memcpy(ye->ye_oid, objid, *objidlen*sizeof(oid));
+    ye->ye_oidlen = *objidlen;
+    ye->ye_oidstr = oidstr;
+    ye->ye_found = 1;
     if (objidstrp)
         *objidstrp = oidstr;
     retval = 1;
@@ -390,6 +487,22 @@ snmp_handle_clone(void *arg)
     return (void*)sh1;
 }
 
+/*! Free sorted table OID index
+ * @param[in]  oix  OID index, malloced in snmp_oidx_build
+ * @see snmp_table_getnext  where the index is built and searched
+ */
+void
+snmp_oidx_free(struct clixon_snmp_oidx *oix)
+{
+    if (oix != NULL){
+        if (oix->oix_vec)
+            free(oix->oix_vec);
+        if (oix->oix_xml)
+            xml_free(oix->oix_xml);
+        free(oix);
+    }
+}
+
 /*! Free clixon snmp handler struct
  * Use signature of libnetsnmp data_free field of netsnmp_mib_handler in agent_handler.h
  * @param[in]  arg
@@ -402,6 +515,8 @@ snmp_handle_free(void *arg)
     if (sh != NULL){
         if (sh->sh_cvk_orig)
             cvec_free(sh->sh_cvk_orig);
+        if (sh->sh_oidx)
+            snmp_oidx_free(sh->sh_oidx);
         if (sh->sh_table_info){
             if (sh->sh_table_info->indexes){
                 snmp_free_varbind(sh->sh_table_info->indexes);
@@ -433,7 +548,18 @@ type_yang2asn1(yang_stmt    *ys,
     char      *origtype = NULL; /* original type */
     int        at;
     yang_stmt *yrestype = NULL;
+    struct snmp_ymap_ent *ye;
+    int        newent = 0;
 
+    /* Resolved types are cached per yang node and extended flag */
+    if ((ye = snmp_ymap_get(ys, &newent)) == NULL)
+        goto done;
+    if (ye->ye_asn1[extended?1:0] != -1){
+        if (asn1_type)
+            *asn1_type = ye->ye_asn1[extended?1:0];
+        retval = 0;
+        goto done;
+    }
     /* Get yang type of leaf and translate to ASN.1 */
     if (snmp_yang_type_get(ys, NULL, &origtype, &yrestype, &restype) < 0)
         goto done;
@@ -462,6 +588,7 @@ type_yang2asn1(yang_stmt    *ys,
              strcmp(display_hint, "255t")==0))
             at = CLIXON_ASN_FIXED_STRING;
     }
+    ye->ye_asn1[extended?1:0] = at;
     if (asn1_type)
         *asn1_type = at;
     retval = 0;
@@ -57,11 +57,40 @@ extern "C" {
 #define CLIXON_ASN_EXTRAS       253 /* Special case clixon address >= this */
 #define CLIXON_ASN_PHYS_ADDR    253 /* Special case phy-address */
 #define CLIXON_ASN_FIXED_STRING 254 /* RFC2578 Sec 7.7: String-valued, fixed-length */
-#define CLIXON_ASN_ROWSTATUS    255 
+#define CLIXON_ASN_ROWSTATUS    255
+
+/* Lifetime in ms of the sorted OID index cached for table GETNEXT walks,
+ * see snmp_table_getnext in snmp_handler.c */
+#define CLIXON_SNMP_OIDX_TIMEOUT_MS 1000
 
 /*
- * Types 
+ * Types
+ */
+/* One column instance in the sorted table OID index, see struct clixon_snmp_oidx
  */
+struct clixon_snmp_oidx_ent {
+    oid        oe_oid[MAX_OID_LEN]; /* Column OID + key suffix */
+    size_t     oe_oidlen;
+    cxobj     *oe_xml;              /* Value node, points into oix_xml */
+    yang_stmt *oe_yang;             /* Yang leaf of column */
+};
+
+/* Sorted OID index over a table's datastore contents.
+ * Built on demand by a GETNEXT and reused by the following steps of the same
+ * walk, so that next-oid computation is a binary search rather than a
+ * datastore read and scan of all rows per step, see snmp_table_getnext.
+ * Invalidated by SET operations on the table and by age.
+ */
+struct clixon_snmp_oidx {
+    struct clixon_snmp_oidx_ent *oix_vec; /* Entries sorted by oid_eq */
+    size_t                       oix_len; /* Number of entries */
+    cxobj                       *oix_xml; /* Datastore tree entries point into */
+    struct timeval               oix_time;/* Build timestamp for expiry */
+    int                          oix_config; /* Table is config-only: index valid
+                                              * while datastore generation holds */
+    uint64_t                     oix_gen; /* Running datastore generation at build */
+};
+
 /* Userdata to pass around in netsmp callbacks
  */
 struct clixon_snmp_handle {
@@ -73,8 +102,10 @@ struct clixon_snmp_handle {
     size_t        sh_oid2len;           
     char         *sh_default;          /* MIB default value leaf only */
     cvec         *sh_cvk_orig;         /* Index/Key variable values (original) */
-    netsnmp_table_registration_info *sh_table_info; /* To mimic table-handler in libnetsnmp code 
+    netsnmp_table_registration_info *sh_table_info; /* To mimic table-handler in libnetsnmp code
                                                      * save only to free properly */
+    struct clixon_snmp_oidx *sh_oidx;  /* Table only: sorted OID index for GETNEXT,
+                                        * see snmp_table_getnext */
 };
 typedef struct clixon_snmp_handle clixon_snmp_handle;
 
@@ -91,6 +122,8 @@ int    snmp_access_str2int(char *modes_str);
 const char *snmp_msg_int2str(int msg);
 void  *snmp_handle_clone(void *arg);
 void   snmp_handle_free(void *arg);
+void   snmp_oidx_free(struct clixon_snmp_oidx *oix);
+void   snmp_ymap_clear(void);
 int    type_yang2asn1(yang_stmt *ys, int *asn1_type, int extended);
 int    type_snmp2xml(yang_stmt                  *ys,
                      int                        *asn1type,
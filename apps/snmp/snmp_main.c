@@ -113,6 +113,7 @@ snmp_terminate(clicon_handle h)
     snmp_shutdown(__FUNCTION__);
     shutdown_agent();
     clixon_snmp_api_agent_cleanup();
+    snmp_ymap_clear();
     if (clicon_ptr_get(h, "snmp-rowstatus-tree", (void**)&x) == 0 && x){
         xml_free(x);
         x = NULL;
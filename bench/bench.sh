@@ -0,0 +1,169 @@
+#!/usr/bin/env bash
+# Project-wide performance benchmark driver.
+# Generates YANG+config corpora of three sizes (small/medium/huge), runs the
+# benchmark modes of the clixon_util_* programs over them and writes the
+# timings as JSON, one result object per line, for bench_compare.sh.
+#
+# Usage: ./bench.sh [-s small|medium|huge|all] [-o results.json]
+# The util programs are taken from ../util if built there, else from PATH.
+# Corpora are generated once under ./corpus/<size>/ and reused; remove the
+# corpus directory to force regeneration.
+
+set -u
+
+sizes="small medium huge"
+out=results.json
+
+usage(){
+    echo "usage: $0 [-s small|medium|huge|all] [-o results.json]" >&2
+    exit 1
+}
+
+while getopts "hs:o:" opt; do
+    case $opt in
+        s) if [ "$OPTARG" != all ]; then sizes="$OPTARG"; fi;;
+        o) out="$OPTARG";;
+        *) usage;;
+    esac
+done
+
+# Entries per corpus size
+nr_small=1000
+nr_medium=10000
+nr_huge=100000
+
+# Benchmark laps
+: ${xpathlaps:=1000}
+: ${validatelaps:=3}
+: ${datastorelaps:=3}
+
+# Locate util programs: prefer the in-tree build
+for u in xml xpath datastore validate; do
+    v=clixon_util_$u
+    if [ -x ../util/clixon_util_$u ]; then
+        eval "$v=../util/clixon_util_$u"
+    else
+        eval ": \${$v:=clixon_util_$u}"
+    fi
+done
+
+# Wallclock seconds of a command, output discarded
+# usage: t=$(elapsed <cmd> <args>*); rc=$?
+elapsed(){
+    local t0 t1
+    t0=$(date +%s.%N)
+    "$@" > /dev/null 2>&1
+    local rc=$?
+    t1=$(date +%s.%N)
+    echo "$t0 $t1" | awk '{printf "%.3f", $2-$1}'
+    return $rc
+}
+
+# Append one result line to the output file
+# usage: emit <name> <seconds>
+emit(){
+    echo "    {\"name\": \"$1\", \"seconds\": $2}," >> $out.tmp
+    echo "$1: $2s"
+}
+
+# Generate the corpus for one size unless it exists already
+# usage: gen_corpus <size> <nr>
+gen_corpus(){
+    local size=$1
+    local nr=$2
+    local dir=corpus/$size
+
+    if [ -f $dir/candidate_db ]; then
+        return 0
+    fi
+    echo "generating $size corpus ($nr entries)"
+    mkdir -p $dir
+    # Same "scaling" module shape as the test/test_perf_* scripts and the
+    # datastore bench command
+    cat <<EOF > $dir/scaling.yang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix sc;
+   container x{
+      list y{
+         key a;
+         leaf a{
+            type int32;
+         }
+         leaf b{
+            type string;
+         }
+      }
+   }
+}
+EOF
+    awk -v nr=$nr 'BEGIN{
+        printf "<config><x xmlns=\"urn:example:clixon\">";
+        for (i=0; i<nr; i++)
+            printf "<y><a>%d</a><b>value-%d-payload</b></y>", i, i;
+        printf "</x></config>\n";
+    }' > $dir/candidate_db
+    cat <<EOF > $dir/conf.xml
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$dir/conf.xml</CLICON_CONFIGFILE>
+  <CLICON_YANG_MAIN_FILE>$dir/scaling.yang</CLICON_YANG_MAIN_FILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+    cat <<EOF > $dir/xpaths.txt
+# xpath corpus: exact key match, full column scan, predicate scan
+/x/y[a=$((nr/2))]
+/x/y[a=$((nr/2))]/b
+/x/y/b
+/x/y[b='value-$((nr/3))-payload']
+EOF
+}
+
+# Run all benchmarks for one size
+# usage: run_size <size> <nr>
+run_size(){
+    local size=$1
+    local nr=$2
+    local dir=corpus/$size
+    local t
+
+    gen_corpus $size $nr
+
+    t=$(elapsed $clixon_util_xml -f $dir/candidate_db -y $dir/scaling.yang) ||
+        { echo "xml_parse_$size failed" >&2; exit 1; }
+    emit xml_parse_$size $t
+
+    t=$(elapsed $clixon_util_xpath -f $dir/candidate_db -y $dir/scaling.yang \
+                -B $dir/xpaths.txt -N $xpathlaps) ||
+        { echo "xpath_$size failed" >&2; exit 1; }
+    emit xpath_$size $t
+
+    t=$(elapsed $clixon_util_datastore -b $dir -d candidate -y $dir/scaling.yang \
+                bench $nr $datastorelaps) ||
+        { echo "datastore_$size failed" >&2; exit 1; }
+    emit datastore_$size $t
+
+    t=$(elapsed $clixon_util_validate -f $dir/conf.xml -d candidate -n $validatelaps) ||
+        { echo "validate_$size failed" >&2; exit 1; }
+    emit validate_$size $t
+}
+
+rm -f $out.tmp
+for size in $sizes; do
+    eval nr=\$nr_$size
+    run_size $size $nr
+done
+
+# Assemble the final JSON (strip the trailing comma of the last result)
+{
+    echo "{"
+    echo "  \"meta\": {\"date\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\", \"host\": \"$(hostname)\"},"
+    echo "  \"results\": ["
+    sed '$ s/},$/}/' $out.tmp
+    echo "  ]"
+    echo "}"
+} > $out
+rm -f $out.tmp
+echo "results written to $out"
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+# Compare two results files produced by bench.sh and flag regressions.
+# Exit status is 1 if any benchmark regressed by more than the threshold.
+#
+# Usage: ./bench_compare.sh <baseline.json> <new.json>
+# Environment: threshold - regression limit in percent (default 10)
+
+set -u
+
+: ${threshold:=10}
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 <baseline.json> <new.json>" >&2
+    exit 2
+fi
+old=$1
+new=$2
+if [ ! -f "$old" -o ! -f "$new" ]; then
+    echo "$0: no such file: $old / $new" >&2
+    exit 2
+fi
+
+awk -v threshold=$threshold -v oldfile="$old" '
+# Extract name/seconds pairs from the one-result-per-line JSON of bench.sh
+function parse(line){
+    if (match(line, /"name": "[^"]*"/) == 0)
+        return "";
+    name = substr(line, RSTART+9, RLENGTH-10);
+    match(line, /"seconds": [0-9.]*/);
+    secs = substr(line, RSTART+11, RLENGTH-11);
+    return name;
+}
+NR == FNR {
+    if (parse($0) != "")
+        base[name] = secs;
+    next;
+}
+{
+    if (parse($0) == "")
+        next;
+    if (!(name in base)){
+        printf "%-24s %10s %10.3f   (no baseline)\n", name, "-", secs;
+        next;
+    }
+    delta = (secs - base[name]) / base[name] * 100;
+    flag = "";
+    if (delta > threshold){
+        flag = " REGRESSION";
+        fail = 1;
+    }
+    else if (delta < -threshold)
+        flag = " improved";
+    printf "%-24s %10.3f %10.3f %+8.1f%%%s\n", name, base[name], secs, delta, flag;
+    seen[name] = 1;
+}
+END {
+    for (name in base)
+        if (!(name in seen))
+            printf "%-24s %10.3f %10s   (missing in new)\n", name, base[name], "-";
+    exit fail;
+}
+' "$old" "$new" | { echo "benchmark                  baseline        new    delta"; cat; }
+exit ${PIPESTATUS[0]}
@@ -0,0 +1,63 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * General-purpose arena allocator with push/pop scopes, for scratch memory
+ * with a clear lifetime such as parser temporaries.
+ * @see clixon_xml.h xml_arena for the cxobj-specific node arena
+ */
+
+#ifndef _CLIXON_ARENA_H_
+#define _CLIXON_ARENA_H_
+
+/*
+ * Types
+ */
+typedef struct clixon_arena clixon_arena; /* struct defined in clixon_arena.c */
+
+/*
+ * Prototypes
+ */
+clixon_arena *clixon_arena_create(size_t slabsz);
+int           clixon_arena_free(clixon_arena *ca);
+void         *clixon_arena_alloc(clixon_arena *ca, size_t sz);
+char         *clixon_arena_strdup(clixon_arena *ca, const char *str);
+int           clixon_arena_push(clixon_arena *ca);
+int           clixon_arena_pop(clixon_arena *ca);
+clixon_arena *clixon_arena_scratch(void);
+int           clixon_arena_scratch_free(void);
+int           clixon_arena_stats(clixon_arena *ca, uint64_t *nrslabs, size_t *used, size_t *total);
+
+#endif /* _CLIXON_ARENA_H_ */
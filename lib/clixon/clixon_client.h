@@ -63,6 +63,13 @@ typedef enum {
     CLIXON_CLIENT_SSH  
 } clixon_client_type;
 
+/* Async request completion callback, see clixon_client_rpc_send
+ * Invoked with the parsed reply tree (struct xml = cxobj), which is freed
+ * when the callback returns, or with xreply NULL on end-of-connection.
+ * Note struct tags are used here to keep this header self-contained
+ */
+typedef int (*clixon_client_rpc_cb)(clixon_client_handle ch, struct xml *xreply, void *arg);
+
 /*
  * Prototypes
  */
@@ -84,6 +91,14 @@ int   clixon_client_get_uint16(clixon_client_handle ch, uint16_t *rval, const ch
 int   clixon_client_get_uint32(clixon_client_handle ch, uint32_t *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint64(clixon_client_handle ch, uint64_t *rval, const char *xnamespace, const char *xpath);
     
+/* Async completion API: multiple outstanding requests per connection,
+ * completed in send order. Integrate with the clixon event loop, or use
+ * clixon_client_socket_get + clixon_client_rpc_process in an own poll loop
+ */
+int   clixon_client_rpc_send(clixon_client_handle ch, struct cbuf *msg, clixon_client_rpc_cb cb, void *arg);
+int   clixon_client_get_send(clixon_client_handle ch, const char *xnamespace, const char *xpath, clixon_client_rpc_cb cb, void *arg);
+int   clixon_client_rpc_process(clixon_client_handle ch);
+
 /* Access functions */
 int   clixon_client_socket_get(clixon_client_handle ch);
 
@@ -57,6 +57,16 @@ typedef struct {
     cxobj    *de_xml;      /* cache */
     int       de_modified; /* Dirty since loaded/copied/committed/etc XXX:nocache? */
     int       de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
+    int       de_pending;  /* Snapshot write deferred, see CLICON_XMLDB_WRITE_DEFER */
+    char     *de_base;     /* Unmaterialized copy-on-write overlay: share the cache of
+                              this base db until either side is modified, see
+                              xmldb_cow_materialize and cache mode cache-cow */
+    struct timeval de_atime; /* Last cache access, for idle eviction, see
+                                xmldb_cache_prune and CLICON_XMLDB_CACHE_TIMEOUT */
+    cvec     *de_touched;  /* Paths where this db may differ from running, recorded
+                              by xmldb_put as edits are applied. Restricts the commit
+                              diff to the touched subtrees, see xml_diff_paths.
+                              NULL means unknown: a full tree diff is needed */
 } db_elmnt;
 
 /*
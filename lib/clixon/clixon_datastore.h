@@ -56,8 +56,30 @@ int xmldb_get0(clicon_handle h, const char *db, yang_bind yb,
                cxobj **xtop, modstate_diff_t *msd, cxobj **xerr); 
 int xmldb_get0_clear(clicon_handle h, cxobj *x);
 int xmldb_get0_free(clicon_handle h, cxobj **xp);
+int xmldb_cow_copy(cxobj *x0t, cxobj *x0, cxobj *x1t);
+int xmldb_cow_materialize(clicon_handle h, const char *db);
+int xmldb_cow_break(clicon_handle h, const char *db);
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret); /* in clixon_datastore_write.[ch] */
+int xmldb_put_vec(clicon_handle h, const char *db, enum operation_type *ops, cxobj **x1vec, size_t x1len, char *username, cbuf *cbret);
+int xmldb_journal_file(clicon_handle h, const char *db, char **filep);
+int xmldb_journal_truncate(clicon_handle h, const char *db, size_t off);
+int xmldb_journal_flush(clicon_handle h, const char *db);
+int xmldb_journal_delta(clicon_handle h, const char *db, cxobj **dvec, int dlen, cxobj **avec, int alen, cxobj **cvec, int clen);
+int xmldb_journal_compact(clicon_handle h, const char *db);
+int xmldb_flush(clicon_handle h, const char *db);
+int xmldb_validated_set(clicon_handle h, const char *db);
+int xmldb_validated_get(clicon_handle h, const char *db);
+int xmldb_touched_clear(clicon_handle h, const char *db);
+int xmldb_touched_invalidate(clicon_handle h, const char *db);
+int xmldb_touched_invalidate_all(clicon_handle h);
+int xmldb_touched_add(clicon_handle h, const char *db, char *xpath, int depth);
+cvec *xmldb_touched_get(clicon_handle h, const char *db);
 int xmldb_copy(clicon_handle h, const char *from, const char *to);
+int xmldb_copy_cache(clicon_handle h, const char *from, const char *to);
+int xmldb_move(clicon_handle h, const char *from, const char *to);
+int xmldb_steal_cache(clicon_handle h, const char *from, const char *to);
+uint64_t xmldb_generation_get(void);
+int xmldb_generation_incr(const char *db);
 int xmldb_lock(clicon_handle h, const char *db, uint32_t id);
 int xmldb_unlock(clicon_handle h, const char *db);
 int xmldb_unlock_all(clicon_handle h, uint32_t id);
@@ -71,6 +93,8 @@ int xmldb_create(clicon_handle h, const char *db);
 int xmldb_db_reset(clicon_handle h, const char *db);
 
 cxobj *xmldb_cache_get(clicon_handle h, const char *db);
+int xmldb_cache_touch(clicon_handle h, const char *db);
+int xmldb_cache_prune(clicon_handle h, int idle);
 
 int xmldb_modified_get(clicon_handle h, const char *db);
 int xmldb_modified_set(clicon_handle h, const char *db, int value);
@@ -78,5 +102,10 @@ int xmldb_empty_get(clicon_handle h, const char *db);
 int xmldb_dump(clicon_handle h, FILE *f, cxobj *xt);
 int xmldb_print(clicon_handle h, FILE *f);
 int xmldb_rename(clicon_handle h, const char *db, const char *newdb, const char *suffix);
+int xmldb_file_compressed(FILE *fp);
+#ifdef HAVE_LIBZSTD
+int xmldb_zstd_write(FILE *f, const char *buf, size_t len);
+int xmldb_zstd_read(FILE *fp, char **bufp, size_t *lenp);
+#endif
 
 #endif /* _CLIXON_DATASTORE_H */
@@ -78,16 +78,33 @@ struct _dispatcher_entry {
     /*
      * peer_head points at leftmost peer at this level
      * if NULL, then this is the leftmost and first on the list
-     * XXX: it seems it points to itself if it is first on the list? 
+     * XXX: it seems it points to itself if it is first on the list?
      */
     dispatcher_entry_t *peer_head;
 
+    /*
+     * sorted index over this peer list, built lazily at first lookup
+     * and invalidated by registrations; only maintained on the head
+     * node of the list, see find_peer()
+     */
+    dispatcher_entry_t **peer_vec;
+    size_t peer_vec_len;
+
     /*
      * points at peer_head of children list
      * if NULL, then no children
      */
     dispatcher_entry_t *children;
 
+    /*
+     * most specific handler entry for this node: the node itself if a
+     * handler is registered on it, otherwise the closest ancestor with
+     * one; precomputed lazily at first dispatch after a registration.
+     * NULL on the tree root marks the tree as needing recompilation,
+     * see compile_best()
+     */
+    dispatcher_entry_t *best;
+
     /*
      * pointer to handler function for this node
      */
@@ -104,6 +121,7 @@ struct _dispatcher_entry {
  */
 int dispatcher_register_handler(dispatcher_entry_t **root, dispatcher_definition *x);
 int dispatcher_call_handlers(dispatcher_entry_t *root, void *handle, char *path, void *user_args);
+int dispatcher_call_handlers_vec(dispatcher_entry_t *root, void *handle, char **paths, size_t npaths, void *user_args);
 int dispatcher_free(dispatcher_entry_t *root);
 int dispatcher_print(FILE *f, int level, dispatcher_entry_t *root);
 
@@ -38,8 +38,13 @@
 #ifndef _CLIXON_HASH_H_
 #define _CLIXON_HASH_H_
 
+/* One hash entry: a slot in the table's open-addressing vector.
+ * h_key is individually malloced and stable over the table's lifetime;
+ * pointers to the entry itself are only valid until the next add or delete.
+ * h_vlen is 0 for entries added with clicon_hash_add_ptr: the value pointer
+ * is then stored as-is and not owned by the table.
+ */
 struct clicon_hash {
-    qelem_t     h_qelem;
     char       *h_key;
     size_t      h_vlen;
     void       *h_val;
@@ -51,13 +56,16 @@ int            clicon_hash_free (clicon_hash_t *);
 clicon_hash_t  clicon_hash_lookup (clicon_hash_t *head, const char *key);
 void          *clicon_hash_value (clicon_hash_t *head, const char *key, size_t *vlen);
 clicon_hash_t  clicon_hash_add (clicon_hash_t *head, const char *key, void *val, size_t vlen);
+clicon_hash_t  clicon_hash_add_ptr (clicon_hash_t *head, const char *key, void *val);
 int            clicon_hash_del (clicon_hash_t *head, const char *key);
 int            clicon_hash_dump(clicon_hash_t *head, FILE *f);
 int            clicon_hash_keys(clicon_hash_t *hash, char ***vector, size_t *nkeys);
+clicon_hash_t  clicon_hash_next(clicon_hash_t *hash, clicon_hash_t prev);
 
 /*
  *   Macros to iterate over hash contents.
- *   XXX A bit crude. Just as easy for app to loop through the keys itself.
+ *   Entry-based: no key snapshot is built. Do not add or delete entries in
+ *   the loop body, see clicon_hash_next.
  *
  *  Example:
  *     char *k;
@@ -66,18 +74,16 @@ int            clicon_hash_keys(clicon_hash_t *hash, char ***vector, size_t *nke
  *     clicon_hash_add(h, "colour", "red", 6);
  *     clicon_hash_add(h, "name", "rudolf" 7);
  *     clicon_hash_add(h, "species", "reindeer" 9);
- * 
+ *
  *     clicon_hash_each(h, k) {
  *       printf ("%s = %s\n", k, (char *)clicon_hash_value(h, k, NULL));
- *     } hash_each_end();
+ *     } clicon_hash_each_end();
 */
-#define clicon_hash_each(__hash__, __key__)                                     \
+#define clicon_hash_each(__hash__, __key__)                             \
 {                                                                       \
-    int __i__;                                                          \
-    size_t __n__;                                                       \
-    char **__k__ = hash_keys((__hash__),&__n__);                        \
-    if (__k__) {                                                        \
-        for(__i__ = 0; __i__ < __n__ && ((__key__) = __k__[__i__]); __i__++)
-#define clicon_hash_each_end(__hash__)   if (__k__) free(__k__);  } }
+    clicon_hash_t __h__ = NULL;                                         \
+    while ((__h__ = clicon_hash_next((__hash__), __h__)) != NULL &&     \
+           (((__key__) = __h__->h_key) != NULL))
+#define clicon_hash_each_end(__hash__)  }
 
 #endif /* _CLIXON_HASH_H_ */
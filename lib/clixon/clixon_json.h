@@ -45,7 +45,20 @@
  */
 int json2xml_decode(cxobj *x, cxobj **xerr);
 int clixon_json2cbuf(cbuf *cb, cxobj *x, int pretty, int skiptop, int autocliext);
+
+/*! Streaming JSON chunk callback, see clixon_json2stream
+ * @param[in]  arg   Callback argument
+ * @param[in]  chunk NUL-terminated chunk of serialized JSON
+ * @param[in]  len   Chunk length excluding the NUL
+ * @retval     0     OK
+ * @retval    -1     Error, abort serialization
+ */
+typedef int (clixon_json_stream_cb)(void *arg, const char *chunk, size_t len);
+
+int clixon_json2stream(cxobj *xt, int pretty, int skiptop, int autocliext,
+                       size_t chunksz, clixon_json_stream_cb *fn, void *arg);
 int xml2json_cbuf_vec(cbuf *cb, cxobj **vec, size_t veclen, int pretty, int skiptop);
+int clixon_json2file_vec(FILE *f, cxobj **vec, size_t veclen, int pretty, int skiptop, clicon_output_cb *fn);
 int clixon_json2file(FILE *f, cxobj *x, int pretty, clicon_output_cb *fn, int skiptop, int autocliext);
 int json_print(FILE *f, cxobj *x);
 int xml2json_vec(FILE *f, cxobj **vec, size_t veclen, int pretty, int skiptop);
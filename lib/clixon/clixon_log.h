@@ -58,6 +58,9 @@ int clicon_log_file(char *filename);
 int clicon_log_string_limit_set(size_t sz);
 size_t clicon_log_string_limit_get(void);
 int clicon_get_logflags(void);
+int clicon_log_async(int enable);
+int clicon_log_flush(void);
+uint64_t clicon_log_dropped_get(void);
 int clicon_log_str(int level, char *msg);
 int clicon_log(int level, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
 int clicon_debug(int dbglevel, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
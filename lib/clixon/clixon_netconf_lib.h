@@ -67,6 +67,12 @@
  */
 #define NETCONF_BASE_CAPABILITY_1_1 "urn:ietf:params:netconf:base:1.1"
 
+/* Clixon-internal capability: the backend accepts binary cxobj serialized
+ * request payloads on the IPC socket, see clixon_xml2bin. Advertised by the
+ * backend in the internal hello reply, never on NETCONF-facing sessions.
+ */
+#define CLIXON_BINARY_CAPABILITY "urn:clixon:capability:binary-encoding:1.0"
+
 /* See RFC 7950 Sec 5.3.1: YANG defines an XML namespace for NETCONF <edit-config> 
  * operations, <error-info> content, and the <action> element.
  */
@@ -90,7 +90,8 @@ enum nacm_credentials_t{
 enum datastore_cache{
     DATASTORE_NOCACHE,
     DATASTORE_CACHE,
-    DATASTORE_CACHE_ZEROCOPY
+    DATASTORE_CACHE_ZEROCOPY,
+    DATASTORE_CACHE_COW
 };
 
 /*! yang clixon regexp engine
@@ -129,6 +130,20 @@ int clicon_option_int_set(clicon_handle h, const char *name, int val);
 int clicon_option_bool(clicon_handle h, const char *name);
 int clicon_option_bool_set(clicon_handle h, const char *name, int val);
 
+/* Cached typed option access: one (static) cache per call site, revalidated
+ * only when some option has been written since the cached read.
+ * Zero-initialized means empty. */
+typedef struct {
+    uint32_t      oc_gen; /* options generation when cached, 0: empty */
+    clicon_handle oc_h;   /* handle the cache is valid for */
+    char         *oc_str; /* cached value string (into options store) */
+    int           oc_num; /* cached parsed int/bool/enum value */
+} clicon_option_cache;
+
+char *clicon_option_str_cached(clicon_handle h, const char *name, clicon_option_cache *oc);
+int clicon_option_int_cached(clicon_handle h, const char *name, clicon_option_cache *oc);
+int clicon_option_bool_cached(clicon_handle h, const char *name, clicon_option_cache *oc);
+
 /* Delete a single option via handle */
 int clicon_option_del(clicon_handle h, const char *name);
 
@@ -312,6 +312,16 @@ struct clixon_plugin_api{
             plgreset_t       *cb_reset;          /* Reset system status */
 
             plgstatedata_t   *cb_statedata;      /* Provide state data XML from plugin */
+            int               cb_statedata_ttl;  /* Seconds a statedata reply may be served
+                                                    from cache, 0 disables caching (default).
+                                                    Also invalidated on commit, see
+                                                    clixon_statedata_cache_invalidate */
+            char             *cb_statedata_subtree; /* Top-level datanode the statedata
+                                                    callback exclusively owns, on the form
+                                                    "module-name:node". Enables the streamed
+                                                    state get path when all statedata plugins
+                                                    declare disjoint subtrees, see
+                                                    CLICON_STATEDATA_STREAM */
             plglockdb_t      *cb_lockdb;         /* Database lock changed state */
             trans_cb_t       *cb_trans_begin;    /* Transaction start */
             trans_cb_t       *cb_trans_validate; /* Transaction validation */
@@ -334,6 +344,8 @@ struct clixon_plugin_api{
 #define ca_daemon         u.cau_backend.cb_daemon
 #define ca_reset          u.cau_backend.cb_reset
 #define ca_statedata      u.cau_backend.cb_statedata
+#define ca_statedata_ttl  u.cau_backend.cb_statedata_ttl
+#define ca_statedata_subtree u.cau_backend.cb_statedata_subtree
 #define ca_lockdb         u.cau_backend.cb_lockdb
 #define ca_trans_begin    u.cau_backend.cb_trans_begin
 #define ca_trans_validate u.cau_backend.cb_trans_validate
@@ -55,9 +55,32 @@ enum format_enum{
 struct clicon_msg {
     uint32_t    op_len;     /* length of whole message: body+header, network byte order. */
     uint32_t    op_id;      /* session-id. network byte order. */
+    uint32_t    op_tid;     /* trace correlation id, 0 if untraced, network byte
+                               order, see clixon_trace_id_new */
     char        op_body[0]; /* rest of message, actual data */
 };
 
+/* High bit of op_len on the wire: the body is passed out-of-band in a memfd
+ * whose descriptor rides on the header with SCM_RIGHTS, see
+ * clicon_msg_fdpass_send. Real message lengths never come near it and receivers
+ * strip it, see clicon_msg_rcv
+ */
+#define CLICON_MSG_FLAG_FDPASS 0x80000000
+
+/* Body size from which clicon_msg_send passes the body out-of-band */
+#define CLICON_MSG_FDPASS_MIN  (1024*1024)
+
+/* Reusable receive buffer retained across messages on one connection.
+ * Grows to the peer's observed message sizes and shrinks again when a
+ * window of messages stays well below capacity, see clicon_msg_rcv_buf
+ */
+struct msg_rcv_buf{
+    struct clicon_msg *mb_buf;  /* Message buffer, reused across receives */
+    uint32_t           mb_size; /* Allocated size of mb_buf */
+    uint32_t           mb_hwm;  /* Largest message seen in current window */
+    uint32_t           mb_n;    /* Messages received in current window */
+};
+
 /*
  * Prototypes
  */ 
@@ -81,19 +104,33 @@ int clicon_rpc_connect_inet(clicon_handle         h,
 
 int clicon_rpc(int sock, struct clicon_msg *msg, char **xret, int *eof);
 
+int clicon_rpc_cbuf(int sock, uint32_t id, cbuf *cb, char **ret, int *eof);
+
 int clicon_rpc1(int sock, cbuf *msgin, cbuf *msgret, int *eof);
 
 int clicon_msg_send(int s, struct clicon_msg *msg);
 
+int clicon_msg_send_cbuf(int s, uint32_t id, cbuf *cb);
+
+int clicon_msg_fdpass_send(int s, struct clicon_msg *msg, int flags);
+
 int clicon_msg_send1(int s, cbuf *cb);
 
+int clicon_msg_rcv_limit_set(uint32_t limit);
+
 int clicon_msg_rcv(int s, struct clicon_msg **msg, int *eof);
 
+int clicon_msg_rcv_buf(int s, struct msg_rcv_buf *mb, struct clicon_msg **msg, int *eof);
+
+int clicon_msg_rcv_buf_reset(struct msg_rcv_buf *mb);
+
 int clicon_msg_rcv1(int s, cbuf *cb, int *eof);
 
 int send_msg_notify_xml(clicon_handle h, int s, cxobj *xev);
 
 int send_msg_reply(int s, char *data, uint32_t datalen);
+struct iovec; /* sys/uio.h */
+int send_msg_reply_iov(int s, struct iovec *iov, int iovcnt);
 
 int detect_endtag(char *tag, char  ch, int  *state);
 
@@ -44,12 +44,19 @@
 
 int clicon_rpc_connect(clicon_handle h, int *sock0);
 int clicon_rpc_msg(clicon_handle h, struct clicon_msg *msg, cxobj **xret0);
+int clicon_rpc_msg_cbuf(clicon_handle h, uint32_t id, cbuf *cb, cxobj **xret0);
 int clicon_rpc_msg_persistent(clicon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
 int clicon_rpc_netconf(clicon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clicon_handle h, cxobj *xml, cxobj **xret, int *sp);
+int clicon_rpc_netconf_send(clicon_handle h, char *xmlstr);
+int clicon_rpc_netconf_xml_send(clicon_handle h, cxobj *xml);
+int clicon_rpc_netconf_recv(clicon_handle h, cxobj **xret);
 int clicon_rpc_get_config(clicon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, cxobj **xret);
-int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op, 
+int clicon_rpc_list_keys(clicon_handle h, char *db, char *xpath, cvec *nsc, cvec *values);
+int clicon_rpc_datastore_diff(clicon_handle h, char *db1, char *db2, cxobj **xs1, cxobj **xs2);
+int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op,
                            char *xml);
+int clicon_rpc_edit_config_batch(clicon_handle h, char *db, char *editsxml);
 int clicon_rpc_copy_config(clicon_handle h, char *db1, char *db2);
 int clicon_rpc_delete_config(clicon_handle h, char *db);
 int clicon_rpc_lock(clicon_handle h, char *db);
@@ -66,6 +73,7 @@ int clicon_rpc_validate(clicon_handle h, char *db);
 int clicon_rpc_commit(clicon_handle h, int confirmed, int cancel, uint32_t timeout, char *persist, char *persist_id);
 int clicon_rpc_discard_changes(clicon_handle h);
 int clicon_rpc_create_subscription(clicon_handle h, char *stream, char *filter, int *s);
+int clicon_rpc_generation(clicon_handle h, uint64_t *gen);
 int clicon_rpc_debug(clicon_handle h, int level);
 int clicon_rpc_restconf_debug(clicon_handle h, int level);
 int clicon_hello_req(clicon_handle h, char *transport, char *source_host, uint32_t *id);
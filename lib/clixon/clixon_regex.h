@@ -42,8 +42,10 @@
  * Prototypes
  */ 
 int regexp_xsd2posix(char *xsd, char **posix);
+int regexp_xsd2posix_shared(char *xsd, char **posix);
 int regex_compile(clicon_handle h, char *regexp, void **recomp);
 int regex_exec(clicon_handle h, void *recomp, char *string);
 int regex_free(clicon_handle h, void *recomp);
+int regex_cache_free(void);
 
 #endif  /* _CLIXON_REGEX_H_ */
@@ -41,6 +41,12 @@
 /*
  * Constants
  */
+/* Default bounds of a stream replay buffer, see struct stream_replay_buf.
+ * Oldest events are evicted first when a cap is exceeded.
+ * Override per stream with stream_replay_limits()
+ */
+#define STREAM_REPLAY_MAX_COUNT 8192
+#define STREAM_REPLAY_MAX_BYTES (4*1024*1024)
 
 /*
  * Types
@@ -54,21 +60,48 @@
  */
 typedef int (*stream_fn_t)(clicon_handle h, int op, cxobj *event, void *arg);
 
+/* Subscription filter classes, computed once at subscribe time so that event
+ * fanout avoids xpath evaluation per subscriber for the common filter forms
+ */
+enum subscription_filter{
+    SS_FILTER_ALL,   /* No or empty filter: matches every event */
+    SS_FILTER_EQ,    /* path or path[leaf='value']: direct tree match */
+    SS_FILTER_XPATH  /* General xpath, evaluated per event */
+};
+
 struct stream_subscription{
     qelem_t                     ss_q;   /* queue header */
     char                       *ss_stream; /* Name of associated stream */
     char                       *ss_xpath;  /* Filter selector as xpath */
+    enum subscription_filter    ss_fclass; /* Filter class, see subscription_filter */
+    char                       *ss_fpath;  /* SS_FILTER_EQ: relative node path */
+    char                       *ss_fleaf;  /* SS_FILTER_EQ: leaf of predicate or NULL */
+    char                       *ss_fval;   /* SS_FILTER_EQ: literal of predicate */
     struct timeval              ss_starttime; /* Replay starttime */
     struct timeval              ss_stoptime; /* Replay stoptime */
     stream_fn_t                 ss_fn;     /* Callback when event occurs */
     void                       *ss_arg;    /* Callback argument */
 };
 
-/* Replay time-series */
-struct stream_replay{
-    qelem_t        r_q;   /* queue header */
-    struct timeval r_tv;  /* time index */
-    cxobj         *r_xml; /* event in xml form */
+/* Replay buffer entry: one event with its time index */
+struct stream_replay_ev{
+    struct timeval re_tv;   /* time index */
+    cxobj         *re_xml;  /* event in xml form */
+    size_t         re_size; /* in-memory size of re_xml, for the byte cap */
+};
+
+/* Bounded replay ring buffer
+ * Entries are stored in time order, oldest first, with non-decreasing
+ * timestamps, so <startTime> positioning can binary search on the time index.
+ * Oldest entries are evicted when the count or byte cap is exceeded.
+ */
+struct stream_replay_buf{
+    struct stream_replay_ev *rb_ev;       /* entry slots, rb_maxcount long */
+    size_t                   rb_maxcount; /* count cap: nr of slots */
+    size_t                   rb_maxbytes; /* byte cap, 0: no byte cap */
+    size_t                   rb_start;    /* index of oldest entry */
+    size_t                   rb_len;      /* nr of entries in use */
+    size_t                   rb_bytes;    /* sum of re_size of stored entries */
 };
 
 /* See RFC8040 9.3, stream list, no replay support for now
@@ -80,7 +113,12 @@ struct event_stream{
     struct stream_subscription *es_subscription;
     int                  es_replay_enabled; /* set if replay is enables */
     struct timeval       es_retention; /* replay retention - how much to save */
-    struct stream_replay *es_replay;
+    struct stream_replay_buf *es_replay; /* bounded replay ring buffer */
+    char                *es_logpath; /* disk-backed replay: event log file */
+    char                *es_idxpath; /* disk-backed replay: time index file */
+    int                  es_logfd;   /* event log fd (append), -1 if heap mode */
+    int                  es_idxfd;   /* time index fd (append), -1 if heap mode */
+    off_t                es_logoff;  /* current end offset of event log */
 
 };
 typedef struct event_stream event_stream_t;
@@ -104,10 +142,13 @@ int stream_ss_delete_all(clicon_handle h, stream_fn_t fn, void *arg);
 int stream_ss_delete(clicon_handle h, char *name, stream_fn_t fn, void *arg);
 
 int stream_notify_xml(clicon_handle h, char *stream, cxobj *xml);
+char *stream_event_encoded(cxobj *xevent, uint64_t *seq);
 int stream_notify(clicon_handle h, char *stream, const char *event, ...)  __attribute__ ((format (printf, 3, 4)));
 
 /* Replay */
 int stream_replay_add(event_stream_t *es, struct timeval *tv, cxobj *xv);
+int stream_replay_limits(event_stream_t *es, size_t maxcount, size_t maxbytes);
+int stream_replay_log(clicon_handle h, char *stream, char *dir);
 int stream_replay_trigger(clicon_handle h, char *stream, stream_fn_t fn, void *arg);
 
 /* Experimental publish streams using SSE. CLIXON_PUBLISH_STREAMS should be set */
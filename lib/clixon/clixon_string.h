@@ -95,6 +95,10 @@ int    uri_str2cvec(char *string, char delim1, char delim2, int decode, cvec **c
 int    uri_percent_encode(char **encp, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
 int    xml_chardata_encode(char **escp, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
 int    xml_chardata_cbuf_append(cbuf *cb, char *str);
+size_t xml_chardata_clean_run(const char *str, size_t len);
+cbuf  *cbuf_pool_get(void);
+int    cbuf_pool_put(cbuf *cb);
+int    cbuf_pool_exit(void);
 int    xml_chardata_decode(char **escp, const char *fmt,...);
 int    uri_percent_decode(char *enc, char **str);
 
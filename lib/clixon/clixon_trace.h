@@ -0,0 +1,78 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * Static USDT tracepoints (provider "clixon") at hot choke points, for
+ * attaching bpftrace/perf/systemtap in production. Probes compile to a single
+ * nop instruction when no tracer is attached and to nothing at all when
+ * sys/sdt.h is absent at build time.
+ *
+ * Example:
+ *   bpftrace -e 'usdt:/usr/local/sbin/clixon_backend:clixon:msg_rcv
+ *                { @bytes = hist(arg1); }'
+ */
+
+#ifndef _CLIXON_TRACE_H_
+#define _CLIXON_TRACE_H_
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define CLIXON_PROBE(name)              DTRACE_PROBE(clixon, name)
+#define CLIXON_PROBE1(name, a1)         DTRACE_PROBE1(clixon, name, a1)
+#define CLIXON_PROBE2(name, a1, a2)     DTRACE_PROBE2(clixon, name, a1, a2)
+#define CLIXON_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(clixon, name, a1, a2, a3)
+
+#else /* HAVE_SYS_SDT_H */
+
+#define CLIXON_PROBE(name)
+#define CLIXON_PROBE1(name, a1)
+#define CLIXON_PROBE2(name, a1, a2)
+#define CLIXON_PROBE3(name, a1, a2, a3)
+
+#endif /* HAVE_SYS_SDT_H */
+
+/*
+ * Prototypes
+ * Request tracing with correlation ids, see clixon_trace.c
+ */
+uint32_t clixon_trace_id_new(void);
+uint32_t clixon_trace_id_get(void);
+int clixon_trace_id_set(uint32_t tid);
+int clixon_trace_log_enable(int enable);
+int clixon_trace_stage(const char *stage);
+
+#endif /* _CLIXON_TRACE_H_ */
@@ -40,15 +40,38 @@
 #ifndef _CLIXON_VALIDATE_H_
 #define _CLIXON_VALIDATE_H_
 
+/*
+ * Types
+ */
+/* Check categories for validation profiling, see xml_validate_profile */
+enum validate_profile_cat{
+    VP_WHEN = 0,
+    VP_MANDATORY,
+    VP_LEAFREF,
+    VP_IDENTITYREF,
+    VP_UNION,
+    VP_MUST,
+    VP_MINMAX,
+    VP_CAT_MAX
+};
+
 /*
  * Prototypes
  */
+int xml_validate_profile(int enable);
+int xml_validate_profile_begin(struct timeval *t0);
+int xml_validate_profile_end(enum validate_profile_cat cat, struct timeval *t0);
+int xml_validate_profile_report(FILE *f);
 int xml_yang_validate_rpc(clicon_handle h, cxobj *xrpc, int expanddefault, cxobj **xret);
 int xml_yang_validate_rpc_reply(clicon_handle h, cxobj *xrpc, cxobj **xret);
 int xml_yang_validate_add(clicon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_list_key_only(cxobj *xt, cxobj **xret);
 int xml_yang_validate_all(clicon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_all_top(clicon_handle h, cxobj *xt, cxobj **xret);
+int xml_yang_validate_changed(clicon_handle h, cxobj *xt, cxobj **xret);
+int xml_yang_validate_changed_top(clicon_handle h, cxobj *xt, cxobj **xret);
+int xml_leafref_index_begin(cxobj *xroot);
+int xml_leafref_index_end(void);
 int rpc_reply_check(clicon_handle h, char *rpcname, cbuf *cbret);
 
 #endif  /* _CLIXON_VALIDATE_H_ */
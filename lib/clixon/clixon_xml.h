@@ -174,6 +174,8 @@ typedef int (xml_applyfn_t)(cxobj *x, void *arg);
 
 typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c */
 
+typedef struct xml_arena xml_arena; /* struct defined in clixon_xml.c */
+
 /*
  * xml_flag() flags:
  */
@@ -187,11 +189,35 @@ typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c
 #define XML_FLAG_DEFAULT   0x40 /* Added when a value is set as default @see xml_default */
 #define XML_FLAG_TOP       0x80 /* Top datastore symbol */
 #define XML_FLAG_BODYKEY  0x100 /* Text parsing key to be translated from body to key */
+#define XML_FLAG_ARENA    0x200 /* Node struct is arena-allocated, do not free(3) the node
+                                 * itself, @see xml_arena_create */
+#define XML_FLAG_INTERN_NAME   0x400 /* x_name points into shared intern table, dont free */
+#define XML_FLAG_INTERN_PREFIX 0x800 /* x_prefix points into shared intern table, dont free */
+#define XML_FLAG_NS_SHARED    0x1000 /* Namespace cache points into shared refcounted pool,
+                                        see nscache_replace */
+#define XML_FLAG_PACKED       0x2000 /* Element children are leaf-list entries packed into a
+                                        compact value array, materialized on access,
+                                        see xml_leaflist_pack */
 
 /*
  * Prototypes
  */
 char     *xml_type2str(enum cxobj_type type);
+xml_arena *xml_arena_create(size_t slabsz);
+int       xml_arena_free(xml_arena *xa);
+int       xml_arena_begin(xml_arena *xa);
+int       xml_arena_end(void);
+int       xml_arena_stats(xml_arena *xa, uint64_t *nrslabs, size_t *used, size_t *total);
+int       xml_intern_set(int enable);
+int       xml_intern_exit(void);
+int       xml_gen_enable(int enable);
+uint32_t  xml_gen_current(void);
+uint32_t  xml_gen(cxobj *x);
+int       xml_tree_hash(cxobj *x, uint64_t *hp);
+int       xml_leaflist_pack(cxobj *xp);
+int       xml_leaflist_pack_recurse(cxobj *xt);
+int       xml_didx_get(cxobj *xt, const char *name, clixon_xvec **xvp);
+int       xml_didx_invalidate(cxobj *x);
 int       xml_stats_global(uint64_t *nr);
 int       xml_stats(cxobj *xt, uint64_t *nrp, size_t *szp);
 char     *xml_name(cxobj *xn);
@@ -232,6 +258,7 @@ int       xml_child_insert_pos(cxobj *x, cxobj *xc, int i);
 int       xml_childvec_set(cxobj *x, int len);
 cxobj   **xml_childvec_get(cxobj *x);
 int       clixon_child_xvec_append(cxobj *x, clixon_xvec *xv);
+int       clixon_child_splice(cxobj *xfrom, int i, int n, cxobj *xto);
 cxobj    *xml_new(char *name, cxobj *xn_parent, enum cxobj_type type);
 cxobj    *xml_new_body(char *name, cxobj *parent, char *val);
 yang_stmt *xml_spec(cxobj *x);
@@ -239,6 +266,11 @@ int       xml_spec_set(cxobj *x, yang_stmt *spec);
 cg_var   *xml_cv(cxobj *x);
 int       xml_cv_set(cxobj *x, cg_var *cv);
 cxobj    *xml_find(cxobj *xn_parent, char *name);
+int       xml_find_index_invalidate(cxobj *x);
+int       nscache_shared_exit(void);
+int       xml_key_index_p(cxobj *xp);
+int       xml_key_index_set(cxobj *xp, char *key, cxobj *xc);
+int       xml_key_index_get(cxobj *xp, char *key, cxobj **xcp);
 int       xml_addsub(cxobj *xp, cxobj *xc);
 cxobj    *xml_wrap_all(cxobj *xp, char *tag);
 cxobj    *xml_wrap(cxobj *xc, char *tag);
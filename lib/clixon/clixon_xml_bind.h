@@ -47,6 +47,7 @@ int xml_bind_yang_unknown_anydata(int val);
 int xml_bind_netconf_message_id_optional(int val);
 int xml_bind_yang_rpc(cxobj *xrpc, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang_rpc_reply(cxobj *xrpc, char *name, yang_stmt *yspec, cxobj **xerr);
+int xml_bind_yang_one(cxobj *xt, yang_bind yb, yang_stmt *yspec, cxobj *xsibling, cxobj **xerr);
 int xml_bind_yang0(cxobj *xt, yang_bind yb, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_yang(cxobj *xt, yang_bind yb, yang_stmt *yspec, cxobj **xerr);
 int xml_bind_special(cxobj *xd, yang_stmt *yspec, char *schema_nodeid);
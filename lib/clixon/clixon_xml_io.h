@@ -48,7 +48,27 @@ int   xml_print(FILE *f, cxobj *xn);
 int   xml_dump(FILE  *f, cxobj *x);
 int   clixon_xml2cbuf(cbuf *cb, cxobj *x, int level, int prettyprint, int32_t depth, int skiptop);
 int   xmltree2cbuf(cbuf *cb, cxobj *x, int level);
+
+/*! Streaming parse element callback, see clixon_xml_parse_string_stream
+ * @param[in]  x    Completed element, with attributes, bodies and children
+ * @param[in]  arg  Callback argument
+ * @retval     1    OK, prune x from the tree after the call
+ * @retval     0    OK, keep x
+ * @retval    -1    Error, abort parsing
+ */
+typedef int (clixon_xml_stream_cb)(cxobj *x, void *arg);
+
+/*! Incremental push parser handle, see clixon_xml_push_new */
+typedef struct clixon_xml_push clixon_xml_push;
+
 int   clixon_xml_parse_file(FILE *f, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
+int   clixon_xml_parse_mmap(int fd, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
+clixon_xml_push *clixon_xml_push_new(clixon_xml_stream_cb *cb, void *arg);
+int   clixon_xml_push_feed(clixon_xml_push *xp, const char *buf, size_t len);
+int   clixon_xml_push_done(clixon_xml_push *xp, cxobj **xt);
+int   clixon_xml_push_free(clixon_xml_push *xp);
+int   clixon_xml_parse_file_stream(FILE *fp, clixon_xml_stream_cb *cb, void *arg, cxobj **xt);
+int   clixon_xml_parse_string_stream(const char *str, clixon_xml_stream_cb *cb, void *arg, cxobj **xt);
 int   clixon_xml_parse_string(const char *str, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   clixon_xml_parse_va(yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr, 
                         const char *format, ...)  __attribute__ ((format (printf, 5, 6)));
@@ -136,6 +136,7 @@ int   xpath_parse(const char *xpath, xpath_tree **xptree);
 int   xpath_vec_ctx(cxobj *xcur, cvec *nsc, const char *xpath, int localonly, xp_ctx  **xrp);
 
 int    xpath_vec_bool(cxobj *xcur, cvec *nsc, const char *xpformat, ...) __attribute__ ((format (printf, 3, 4)));
+int    xpath_tree_bool(cxobj *xcur, cvec *nsc, xpath_tree *xptree);
 int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t flags, 
                    cxobj ***vec, size_t *veclen, ...) __attribute__ ((format (printf, 3, 7)));
 
@@ -42,6 +42,7 @@
 int  xpath_list_optimize_stats(int *hits);
 int  xpath_list_optimize_set(int enable); 
 void xpath_optimize_exit(void);
+int  xpath_optimize_predicates(xpath_tree *xt);
 int  xpath_optimize_check(xpath_tree *xs, cxobj *xv, cxobj ***xvec0, int *xlen0);
 
 #endif /* _CLIXON_XPATH_OPTIMIZE_H */
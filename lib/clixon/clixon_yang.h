@@ -66,11 +66,27 @@
 #define YANG_FLAG_CONFIG_VALUE 0x20  /* Ancestor config cache value */
 #endif
 
-#define YANG_FLAG_DISABLED     0x40  /* Disabled due to if-feature evaluate to false 
+#define YANG_FLAG_DISABLED     0x40  /* Disabled due to if-feature evaluate to false
                                       * Transformed to ANYDATA but some code may need to check
                                       * why it is an ANYDATA
                                       */
 
+#define YANG_FLAG_ORDER_CACHE  0x80  /* Ordered-by cache is active, see yang_ordered_by_user */
+#define YANG_FLAG_ORDER_USER   0x100 /* Ordered-by cache value: list/leaf-list is ordered-by user */
+#ifdef USE_CONFIG_FLAG_CACHE
+#define YANG_FLAG_MYCONFIG_CACHE 0x200 /* Own-node config cache is active, see yang_config */
+#define YANG_FLAG_MYCONFIG_VALUE 0x400 /* Own-node config cache value */
+#endif
+#define YANG_FLAG_XREF         0x800 /* Subtree contains a cross-referencing construct:
+                                      * when, must, leafref or instance-identifier.
+                                      * Set at load, used by incremental validation,
+                                      * see xml_yang_validate_changed
+                                      */
+#define YANG_FLAG_MAND_CACHE   0x1000 /* Mandatory cache is active: the yang_xml_mandatory result
+                                         is instance-independent, ie no when-conditional
+                                         participates in the decision */
+#define YANG_FLAG_MAND_VALUE   0x2000 /* Mandatory cache value: node is (recursively) mandatory */
+
 /*
  * Types
  */
@@ -214,6 +230,7 @@ cg_var    *yang_cv_get(yang_stmt *ys);
 int        yang_cv_set(yang_stmt *ys, cg_var *cv);
 cvec      *yang_cvec_get(yang_stmt *ys);
 int        yang_cvec_set(yang_stmt *ys, cvec *cvv);
+int        yang_identity_derived(yang_stmt *ybaseid, char *idref);
 uint16_t   yang_flag_get(yang_stmt *ys, uint16_t flag);
 int        yang_flag_set(yang_stmt *ys, uint16_t flag);
 int        yang_flag_reset(yang_stmt *ys, uint16_t flag);
@@ -221,6 +238,7 @@ char      *yang_when_xpath_get(yang_stmt *ys);
 int        yang_when_xpath_set(yang_stmt *ys, char *xpath);
 cvec      *yang_when_nsc_get(yang_stmt *ys);
 int        yang_when_nsc_set(yang_stmt *ys, cvec *nsc);
+struct xpath_tree *yang_xptree_get(yang_stmt *ys); /* Compiled when/must xpath */
 const char *yang_filename_get(yang_stmt *ys);
 int        yang_filename_set(yang_stmt *ys, const char *filename);
 int        yang_linenum_get(yang_stmt *ys);
@@ -237,6 +255,7 @@ yang_stmt *ys_prune(yang_stmt *yp, int i);
 int        ys_prune_self(yang_stmt *ys);
 int        ys_free1(yang_stmt *ys, int self);
 int        ys_free(yang_stmt *ys);
+uint64_t   yspec_generation_get(void);
 int        ys_cp(yang_stmt *nw, yang_stmt *old);
 yang_stmt *ys_dup(yang_stmt *old);
 int        yn_insert(yang_stmt *ys_parent, yang_stmt *ys_child);
@@ -275,18 +294,24 @@ int        yang_abs_schema_nodeid(yang_stmt *ys, char *schema_nodeid, yang_stmt
 int        yang_desc_schema_nodeid(yang_stmt *yn, char *schema_nodeid, yang_stmt **yres);
 int        yang_config(yang_stmt *ys);
 int        yang_config_ancestor(yang_stmt *ys);
+int        yang_ordered_by_user(yang_stmt *ys);
 int        yang_features(clicon_handle h, yang_stmt *yt);
 cvec      *yang_arg2cvec(yang_stmt *ys, char *delimi);
 int        yang_key_match(yang_stmt *yn, char *name, int *lastkey);
 int        yang_type_cache_regexp_set(yang_stmt *ytype, int rxmode, cvec *regexps);
 int        yang_type_cache_get(yang_stmt *ytype, yang_stmt **resolved, int *options,
                    cvec **cvv, cvec *patterns, int *rxmode, cvec *regexps, uint8_t *fraction);
+int        yang_type_cache_get2(yang_stmt *ytype, yang_stmt **resolved, int *options,
+                   cvec **cvv, cvec **patterns, int *rxmode, cvec **regexps, uint8_t *fraction);
 int        yang_type_cache_set(yang_stmt *ys, yang_stmt *resolved, int options, cvec *cvv,
                                cvec *patterns, uint8_t fraction);
+yang_stmt *yang_union_mru_get(yang_stmt *ytype);
+int        yang_union_mru_set(yang_stmt *ytype, yang_stmt *ymember);
 yang_stmt *yang_anydata_add(yang_stmt *yp, char *name);
 int        yang_extension_value(yang_stmt *ys, char *name, char *ns, int *exist, char **value);
 int        yang_sort_subelements(yang_stmt *ys);
 int        yang_init(clicon_handle h);
+int        yang_intern_exit(void);
 int        yang_single_child_type(yang_stmt *ys, enum rfc_6020 subkeyw);
 void      *yang_action_cb_get(yang_stmt *ys);
 int        yang_action_cb_add(yang_stmt *ys, void *rc);
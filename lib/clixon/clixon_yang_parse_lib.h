@@ -52,8 +52,10 @@
  * Prototypes
  */
 yang_stmt *yang_parse_file(FILE *fp, const char *name, yang_stmt *ysp);
+int        yang_cache_dir_set(const char *dir);
 yang_stmt *yang_parse_filename(const char *filename, yang_stmt  *ysp);
 int        yang_parse_post(clicon_handle h, yang_stmt *yspec, int modmin);
+int        yang_compact(clicon_handle h, yang_stmt *yspec);
 int        yang_spec_parse_module(clicon_handle h, const char *module,
                                   const char *revision, yang_stmt *yspec);
 yang_stmt *yang_parse_str(char *str, const char *name, yang_stmt *yspec);
@@ -40,11 +40,12 @@
 /*
  * Types
  */
-struct clixon_api_path_yacc { 
+struct clixon_api_path_yacc {
     const char   *ay_name;         /* Name of syntax (for error string) */
     int           ay_linenum;      /* Number of \n in parsed buffer */
     char         *ay_parse_string; /* original (copy of) parse string */
     void         *ay_lexbuf;       /* internal parse buffer from lex */
+    clixon_arena *ay_arena;        /* scratch arena owning token strings, popped by caller */
     clixon_path  *ay_top;
 };
 typedef struct clixon_api_path_yacc clixon_api_path_yacc;
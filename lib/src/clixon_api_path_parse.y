@@ -106,6 +106,7 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_queue.h"
+#include "clixon_arena.h"
 #include "clixon_string.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -271,9 +272,9 @@ element        : api_identifier { $$=$1;
                                  clicon_debug(2,"element = list_instance");}
                ;
 
-api_identifier : module_name COLON IDENTIFIER { $$ = path_new($1, $3); free($1); free($3);
+api_identifier : module_name COLON IDENTIFIER { $$ = path_new($1, $3); /* token strings are arena-owned */
                                 clicon_debug(2,"api_identifier = module_name : IDENTIFIER");}
-               | IDENTIFIER                 { $$ = path_new(NULL, $1); free($1);
+               | IDENTIFIER                 { $$ = path_new(NULL, $1);
                                 clicon_debug(2,"api_identifier = IDENTIFIER");}
                ;
 
@@ -291,7 +292,7 @@ key_values     : key_values COMMA key_value  { if (($$ = keyval_add($1, $3)) ==
                                              clicon_debug(2,"key_values->key_value");}
                ;
 
-key_value      : STRING { $$ = keyval_set(NULL, $1); free($1); clicon_debug(2,"keyvalue->STRING"); }
+key_value      : STRING { $$ = keyval_set(NULL, $1); clicon_debug(2,"keyvalue->STRING"); }
                |        { $$ = keyval_set(NULL, ""); clicon_debug(2,"keyvalue->"); }
                ;
 
@@ -0,0 +1,351 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ *
+ * General-purpose arena allocator with push/pop scopes.
+ * Allocations are carved from slabs by pointer bump and are not freed
+ * individually: clixon_arena_pop() reclaims everything allocated since the
+ * matching clixon_arena_push() in one step. Intended for scratch memory with
+ * a clear lifetime, such as parser temporaries, where per-string
+ * malloc/free is pure overhead.
+ * @see clixon_xml.c xml_arena for the cxobj-specific node arena
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+/* clicon */
+#include "clixon_err.h"
+#include "clixon_arena.h"
+
+/* Default slab payload size if 0 is given to clixon_arena_create */
+#define CLIXON_ARENA_SLABSZ_DEFAULT 8192
+
+/* Alignment of returned pointers */
+#define ARENA_ALIGN(sz) (((sz) + 7) & ~(size_t)7)
+
+/* A single slab of an arena, carved into allocations by pointer bump
+ * @see struct clixon_arena
+ */
+struct arena_slab{
+    struct arena_slab *as_next; /* Next (older) slab in arena */
+    size_t             as_size; /* Usable bytes in as_buf */
+    size_t             as_used; /* Bytes allocated by pointer bump */
+    char               as_buf[];
+};
+
+/* Scope mark recorded by clixon_arena_push, allocated from the arena itself
+ * so that pop reclaims it together with the scope's allocations
+ */
+struct arena_scope{
+    struct arena_scope *sc_prev; /* Enclosing (outer) scope */
+    struct arena_slab  *sc_slab; /* Newest slab when the scope was pushed */
+    size_t              sc_used; /* Its used offset when the scope was pushed */
+};
+
+/*! Arena allocator handle
+ * @see clixon_arena_create
+ */
+struct clixon_arena{
+    struct arena_slab  *ca_slabs;   /* Linked list of slabs, newest first */
+    struct arena_slab  *ca_spare;   /* One retired slab kept for reuse by pop */
+    size_t              ca_slabsz;  /* Default slab payload size */
+    struct arena_scope *ca_scopes;  /* Innermost open scope, or NULL */
+    uint64_t            ca_nrallocs;/* Number of allocations made */
+};
+
+/* Process-global scratch arena, lazily created
+ * @see clixon_arena_scratch
+ */
+static struct clixon_arena *_arena_scratch = NULL;
+
+/*! Create an arena
+ * @param[in]  slabsz  Slab payload size in bytes, 0 for default
+ * @retval     ca      New arena
+ * @retval     NULL    Error
+ * @see clixon_arena_free
+ */
+clixon_arena *
+clixon_arena_create(size_t slabsz)
+{
+    struct clixon_arena *ca;
+
+    if ((ca = malloc(sizeof(*ca))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ca, 0, sizeof(*ca));
+    ca->ca_slabsz = slabsz ? slabsz : CLIXON_ARENA_SLABSZ_DEFAULT;
+    return ca;
+}
+
+/*! Free an arena and all its slabs
+ * All memory obtained from the arena becomes invalid
+ * @param[in]  ca   Arena
+ * @retval     0    OK
+ */
+int
+clixon_arena_free(clixon_arena *ca)
+{
+    struct arena_slab *as;
+
+    while ((as = ca->ca_slabs) != NULL){
+        ca->ca_slabs = as->as_next;
+        free(as);
+    }
+    if (ca->ca_spare)
+        free(ca->ca_spare);
+    free(ca);
+    return 0;
+}
+
+/*! Add a new slab in front of the slab list, reusing the spare if it fits
+ * @param[in]  ca   Arena
+ * @param[in]  sz   Minimum payload size the slab must hold
+ * @retval     as   New current slab
+ * @retval     NULL Error
+ */
+static struct arena_slab *
+arena_slab_new(clixon_arena *ca,
+               size_t        sz)
+{
+    struct arena_slab *as;
+    size_t             slabsz;
+
+    if (ca->ca_spare && ca->ca_spare->as_size >= sz){
+        as = ca->ca_spare;
+        ca->ca_spare = NULL;
+        as->as_used = 0;
+    }
+    else{
+        slabsz = ca->ca_slabsz;
+        if (sz > slabsz) /* oversize allocation gets its own slab */
+            slabsz = sz;
+        if ((as = malloc(sizeof(*as) + slabsz)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            return NULL;
+        }
+        as->as_size = slabsz;
+        as->as_used = 0;
+    }
+    as->as_next = ca->ca_slabs;
+    ca->ca_slabs = as;
+    return as;
+}
+
+/*! Allocate sz bytes from the arena
+ * The memory is not zeroed and cannot be freed individually, it is reclaimed
+ * by the matching clixon_arena_pop (or clixon_arena_free)
+ * @param[in]  ca   Arena
+ * @param[in]  sz   Number of bytes
+ * @retval     ptr  Allocated memory, 8-byte aligned
+ * @retval     NULL Error
+ */
+void *
+clixon_arena_alloc(clixon_arena *ca,
+                   size_t        sz)
+{
+    struct arena_slab *as;
+    void              *ptr;
+
+    sz = ARENA_ALIGN(sz);
+    as = ca->ca_slabs;
+    if (as == NULL || as->as_used + sz > as->as_size)
+        if ((as = arena_slab_new(ca, sz)) == NULL)
+            return NULL;
+    ptr = as->as_buf + as->as_used;
+    as->as_used += sz;
+    ca->ca_nrallocs++;
+    return ptr;
+}
+
+/*! Duplicate a string into the arena
+ * @param[in]  ca   Arena
+ * @param[in]  str  NULL-terminated string
+ * @retval     new  Copy of str allocated from the arena
+ * @retval     NULL Error
+ */
+char *
+clixon_arena_strdup(clixon_arena *ca,
+                    const char   *str)
+{
+    size_t len;
+    char  *new;
+
+    len = strlen(str) + 1;
+    if ((new = clixon_arena_alloc(ca, len)) == NULL)
+        return NULL;
+    memcpy(new, str, len);
+    return new;
+}
+
+/*! Open a scope: record the current allocation mark
+ * Scopes nest, every push must be matched by a pop
+ * @param[in]  ca   Arena
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_arena_pop
+ */
+int
+clixon_arena_push(clixon_arena *ca)
+{
+    struct arena_slab  *slab;
+    size_t              used;
+    struct arena_scope *sc;
+
+    /* Record the mark before the scope struct itself is carved from the
+     * arena, so that pop reclaims the scope struct as well */
+    slab = ca->ca_slabs;
+    used = slab ? slab->as_used : 0;
+    if ((sc = clixon_arena_alloc(ca, sizeof(*sc))) == NULL)
+        return -1;
+    sc->sc_prev = ca->ca_scopes;
+    sc->sc_slab = slab;
+    sc->sc_used = used;
+    ca->ca_scopes = sc;
+    return 0;
+}
+
+/*! Close the innermost scope: reclaim everything allocated since its push
+ * One freed slab is kept as spare to avoid malloc churn on the next scope
+ * @param[in]  ca   Arena
+ * @retval     0    OK
+ * @retval    -1    Error: no open scope
+ * @see clixon_arena_push
+ */
+int
+clixon_arena_pop(clixon_arena *ca)
+{
+    struct arena_scope *sc;
+    struct arena_slab  *slab;
+    size_t              used;
+    struct arena_slab  *as;
+
+    if ((sc = ca->ca_scopes) == NULL){
+        clicon_err(OE_UNIX, EINVAL, "pop without push");
+        return -1;
+    }
+    /* Copy the mark before rewinding: the scope struct lives in reclaimed memory */
+    ca->ca_scopes = sc->sc_prev;
+    slab = sc->sc_slab;
+    used = sc->sc_used;
+    while ((as = ca->ca_slabs) != NULL && as != slab){
+        ca->ca_slabs = as->as_next;
+        if (ca->ca_spare == NULL)
+            ca->ca_spare = as; /* keep one for reuse */
+        else if (as->as_size > ca->ca_spare->as_size){
+            free(ca->ca_spare); /* keep the larger one */
+            ca->ca_spare = as;
+        }
+        else
+            free(as);
+    }
+    if (slab)
+        slab->as_used = used;
+    return 0;
+}
+
+/*! Get the process-global scratch arena, creating it on first use
+ * Callers bracket their use with push/pop so that nested users (eg a parser
+ * called from a plugin that also uses the scratch arena) compose
+ * @retval     ca    Scratch arena
+ * @retval     NULL  Error
+ * @code
+ *   clixon_arena *ca;
+ *   if ((ca = clixon_arena_scratch()) == NULL)
+ *      err;
+ *   clixon_arena_push(ca);
+ *   ...
+ *   clixon_arena_pop(ca);
+ * @endcode
+ */
+clixon_arena *
+clixon_arena_scratch(void)
+{
+    if (_arena_scratch == NULL)
+        _arena_scratch = clixon_arena_create(0);
+    return _arena_scratch;
+}
+
+/*! Free the process-global scratch arena, eg at exit
+ */
+int
+clixon_arena_scratch_free(void)
+{
+    if (_arena_scratch){
+        clixon_arena_free(_arena_scratch);
+        _arena_scratch = NULL;
+    }
+    return 0;
+}
+
+/*! Get arena allocation statistics
+ * @param[in]  ca       Arena
+ * @param[out] nrallocs Number of allocations made (or NULL)
+ * @param[out] used     Bytes allocated in current slabs (or NULL)
+ * @param[out] total    Bytes of slab capacity held (or NULL)
+ * @retval     0        OK
+ */
+int
+clixon_arena_stats(clixon_arena *ca,
+                   uint64_t     *nrallocs,
+                   size_t       *used,
+                   size_t       *total)
+{
+    struct arena_slab *as;
+    size_t             u = 0;
+    size_t             t = 0;
+
+    for (as = ca->ca_slabs; as; as = as->as_next){
+        u += as->as_used;
+        t += as->as_size;
+    }
+    if (ca->ca_spare)
+        t += ca->ca_spare->as_size;
+    if (nrallocs)
+        *nrallocs = ca->ca_nrallocs;
+    if (used)
+        *used = u;
+    if (total)
+        *total = t;
+    return 0;
+}
@@ -57,6 +57,7 @@
 #include "clixon_err.h"
 #include "clixon_yang.h"
 #include "clixon_options.h"
+#include "clixon_event.h"
 #include "clixon_proc.h"
 #include "clixon_xml.h"
 #include "clixon_xml_nsctx.h"
@@ -80,7 +81,15 @@
 
 #define chandle(ch) (assert(clixon_client_handle_check(ch)==0),(struct clixon_client_handle *)(ch))
 
-/*! Internal structure of clixon client handle. 
+/*! Outstanding async request, completion fifo entry, see clixon_client_rpc_send
+ */
+struct clixon_client_request{
+    struct clixon_client_request *cr_next;
+    clixon_client_rpc_cb          cr_cb;   /* completion callback */
+    void                         *cr_arg;  /* callback argument */
+};
+
+/*! Internal structure of clixon client handle.
  */
 struct clixon_client_handle{
     uint32_t           cch_magic;  /* magic number */
@@ -88,8 +97,16 @@ struct clixon_client_handle{
     int                cch_socket; /* Input/output socket */
     int                cch_pid;    /* Sub-process-id Only applies for NETCONF/SSH */
     int                cch_locked; /* State variable: 1 means locked */
+    /* Async completion api, see clixon_client_rpc_send */
+    struct clixon_client_request *cch_pending; /* fifo of outstanding requests */
+    cbuf              *cch_inbuf;  /* reply frame accumulation between reads */
+    int                cch_instate; /* end-of-message detection state */
+    int                cch_registered; /* socket registered with clixon_event */
 };
 
+/* Forward, event callback registered on async reply socket */
+static int clixon_client_event_cb(int s, void *arg);
+
 /*! Check struct magic number for sanity checks
  * @param[in]  h   Clicon client handle
  * @retval     0   Sanity check OK
@@ -393,7 +410,8 @@ clixon_client_disconnect(clixon_client_handle ch)
 {
     int   retval = -1;
     struct clixon_client_handle *cch = chandle(ch);
-    
+    struct clixon_client_request *cr;
+
     clicon_debug(1, "%s", __FUNCTION__);
     if (cch == NULL){
         clicon_err(OE_XML, EINVAL, "Expected cch handle");
@@ -402,7 +420,16 @@ clixon_client_disconnect(clixon_client_handle ch)
     /* unlock (if locked) */
     if (cch->cch_locked)
         ;//     (void)clixon_client_lock(cch->cch_socket, 0, "running");
-
+    /* Async state, see clixon_client_rpc_send. Note outstanding requests are
+     * dropped without completion: disconnect is caller-initiated */
+    if (cch->cch_registered)
+        clixon_event_unreg_fd(cch->cch_socket, clixon_client_event_cb);
+    while ((cr = cch->cch_pending) != NULL){
+        cch->cch_pending = cr->cr_next;
+        free(cr);
+    }
+    if (cch->cch_inbuf)
+        cbuf_free(cch->cch_inbuf);
     switch(cch->cch_type){
     case CLIXON_CLIENT_IPC:
         close(cch->cch_socket);
@@ -453,6 +480,44 @@ clixon_xml_bottom(cxobj  *xtop,
     return retval;
 }
 
+/*! Construct a get-config rpc message body
+ *
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpath. (Alt use nsc)
+ * @param[in]  xpath     XPath
+ * @param[out] msg       Message cbuf, rpc appended
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+clixon_client_get_msg(const char *namespace,
+                      const char *xpath,
+                      cbuf       *msg)
+{
+    int   retval = -1;
+    cvec *nsc = NULL;
+
+    cprintf(msg, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(msg, " xmlns:%s=\"%s\"",
+            NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    cprintf(msg, " %s", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(msg, "><get-config><source><running/></source>");
+    if (xpath && strlen(xpath)){
+        cprintf(msg, "<%s:filter %s:type=\"xpath\" xmlns=\"%s\" %s:select=\"%s\"",
+                NETCONF_BASE_PREFIX,
+                NETCONF_BASE_PREFIX,
+                namespace,
+                NETCONF_BASE_PREFIX,
+                xpath);
+        if (xml_nsctx_cbuf(msg, nsc) < 0)
+            goto done;
+        cprintf(msg, "/>");
+    }
+    cprintf(msg, "</get-config></rpc>");
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Internal function to construct a get-config and query a value from the backend
  *
  * @param[in]  sock      Socket
@@ -474,8 +539,6 @@ clixon_client_get_xdata(int         sock,
     cxobj       *xd;
     cbuf        *msg = NULL;
     cbuf        *msgret = NULL;
-    const char  *db = "running";
-    cvec        *nsc = NULL; 
     int          eof = 0;
     
     clicon_debug(1, "%s", __FUNCTION__);
@@ -487,23 +550,8 @@ clixon_client_get_xdata(int         sock,
         clicon_err(OE_PLUGIN, errno, "cbuf_new");
         goto done;
     }
-    cprintf(msg, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
-    cprintf(msg, " xmlns:%s=\"%s\"",
-            NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
-    cprintf(msg, " %s", NETCONF_MESSAGE_ID_ATTR);
-    cprintf(msg, "><get-config><source><%s/></source>", db);
-    if (xpath && strlen(xpath)){
-        cprintf(msg, "<%s:filter %s:type=\"xpath\" xmlns=\"%s\" %s:select=\"%s\"",
-                NETCONF_BASE_PREFIX,
-                NETCONF_BASE_PREFIX,
-                namespace,
-                NETCONF_BASE_PREFIX,
-                xpath);
-        if (xml_nsctx_cbuf(msg, nsc) < 0)
-            goto done;
-        cprintf(msg, "/>");
-    }
-    cprintf(msg, "</get-config></rpc>");
+    if (clixon_client_get_msg(namespace, xpath, msg) < 0)
+        goto done;
     if (netconf_output_encap(0, msg) < 0) // XXX configurable session
         goto done;
     if (clicon_msg_send1(sock, msg) < 0)
@@ -543,6 +591,235 @@ clixon_client_get_xdata(int         sock,
     return retval;
 }
 
+/*! Complete the oldest outstanding request with a reply tree (or NULL on eof)
+ *
+ * Replies are served in send order by the peer, so the completion fifo head
+ * always matches the incoming frame.
+ * @param[in]  cch     Clixon client handle
+ * @param[in]  xreply  Parsed reply tree, freed after the callback returns. NULL on eof
+ * @retval     0       OK (including callback returning error: it owns that handling)
+ * @retval    -1       Error, eg reply with no outstanding request
+ */
+static int
+clixon_client_complete(struct clixon_client_handle *cch,
+                       cxobj                       *xreply)
+{
+    int                           retval = -1;
+    struct clixon_client_request *cr;
+
+    if ((cr = cch->cch_pending) == NULL){
+        clicon_err(OE_PROTO, 0, "Reply with no outstanding request");
+        goto done;
+    }
+    cch->cch_pending = cr->cr_next;
+    if (cr->cr_cb)
+        (*cr->cr_cb)((clixon_client_handle)cch, xreply, cr->cr_arg);
+    free(cr);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Process incoming reply data on an async client socket
+ *
+ * Read what is available, and for each complete end-of-message frame parse the
+ * reply and invoke the completion callback of the oldest outstanding request.
+ * Call this when the socket (see clixon_client_socket_get) is readable: it is
+ * called from the clixon event loop via clixon_client_rpc_send registration,
+ * or directly by a caller integrating the socket in its own poll/epoll loop.
+ * On eof all outstanding requests are completed with a NULL reply.
+ * @param[in]  ch   Clixon client handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_client_rpc_send
+ */
+int
+clixon_client_rpc_process(clixon_client_handle ch)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    unsigned char                buf[BUFSIZ];
+    int                          len;
+    int                          i;
+    int                          run;
+    cxobj                       *xret = NULL;
+    cbuf                        *cb;
+
+    if (cch->cch_inbuf == NULL &&
+        (cch->cch_inbuf = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cb = cch->cch_inbuf;
+    if ((len = read(cch->cch_socket, buf, sizeof(buf))) < 0){
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+            goto ok;
+        if (errno == ECONNRESET)
+            len = 0; /* emulate EOF */
+        else{
+            clicon_err(OE_UNIX, errno, "read");
+            goto done;
+        }
+    }
+    if (len == 0){ /* EOF: complete all outstanding with NULL reply */
+        if (cch->cch_registered){
+            clixon_event_unreg_fd(cch->cch_socket, clixon_client_event_cb);
+            cch->cch_registered = 0;
+        }
+        while (cch->cch_pending)
+            if (clixon_client_complete(cch, NULL) < 0)
+                goto done;
+        goto ok;
+    }
+    run = 0;
+    for (i=0; i<len; i++){
+        if (buf[i] == 0){ /* Skip NULL chars (eg from terminals) */
+            if (i > run &&
+                cbuf_append_buf(cb, &buf[run], i - run) < 0){
+                clicon_err(OE_XML, errno, "cbuf_append_buf");
+                goto done;
+            }
+            run = i + 1;
+            continue;
+        }
+        if (detect_endtag("]]>]]>", buf[i], &cch->cch_instate)){
+            if (cbuf_append_buf(cb, &buf[run], i - run + 1) < 0){
+                clicon_err(OE_XML, errno, "cbuf_append_buf");
+                goto done;
+            }
+            run = i + 1;
+            /* Remove trailer */
+            *(((char*)cbuf_get(cb)) + cbuf_len(cb) - strlen("]]>]]>")) = '\0';
+            if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xret, NULL) < 0)
+                goto done;
+            if (clixon_client_complete(cch, xret) < 0)
+                goto done;
+            xml_free(xret);
+            xret = NULL;
+            cbuf_reset(cb);
+        }
+    }
+    if (len > run &&
+        cbuf_append_buf(cb, &buf[run], len - run) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Event callback on reply data, see clixon_client_rpc_send registration
+ */
+static int
+clixon_client_event_cb(int   s,
+                       void *arg)
+{
+    return clixon_client_rpc_process((clixon_client_handle)arg);
+}
+
+/*! Send an rpc asynchronously, completion callback invoked with the reply
+ *
+ * Several requests may be outstanding on the same connection: replies are
+ * completed in send order. The reply is delivered by the clixon event loop
+ * (the socket is registered here), or by the caller invoking
+ * clixon_client_rpc_process when its own poll loop reports the socket
+ * readable.
+ * @param[in]  ch    Clixon client handle
+ * @param[in]  msg   Rpc message body (no framing), consumed but not freed
+ * @param[in]  cb    Completion callback, invoked with parsed reply tree,
+ *                   or NULL reply on eof. The tree is freed on return
+ * @param[in]  arg   Callback argument
+ * @retval     0     OK, request sent and queued for completion
+ * @retval    -1     Error
+ * @code
+ *   if (clixon_client_rpc_send(ch, msg, mycb, myarg) < 0)
+ *      err;
+ *   if (clixon_event_loop() < 0)  // or own epoll + clixon_client_rpc_process
+ *      err;
+ * @endcode
+ * @note sending blocks until the message is written to the socket buffer
+ */
+int
+clixon_client_rpc_send(clixon_client_handle  ch,
+                       cbuf                 *msg,
+                       clixon_client_rpc_cb  cb,
+                       void                 *arg)
+{
+    int                           retval = -1;
+    struct clixon_client_handle  *cch = chandle(ch);
+    struct clixon_client_request *cr = NULL;
+    struct clixon_client_request **crp;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if ((cr = malloc(sizeof(*cr))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(cr, 0, sizeof(*cr));
+    cr->cr_cb = cb;
+    cr->cr_arg = arg;
+    if (netconf_output_encap(0, msg) < 0) // XXX configurable session
+        goto done;
+    if (clicon_msg_send1(cch->cch_socket, msg) < 0)
+        goto done;
+    /* Append to completion fifo */
+    for (crp = &cch->cch_pending; *crp; crp = &(*crp)->cr_next)
+        ;
+    *crp = cr;
+    cr = NULL;
+    if (!cch->cch_registered){
+        if (clixon_event_reg_fd(cch->cch_socket, clixon_client_event_cb,
+                                ch, "client async reply") < 0)
+            goto done;
+        cch->cch_registered = 1;
+    }
+    retval = 0;
+ done:
+    if (cr)
+        free(cr);
+    return retval;
+}
+
+/*! Send a get-config asynchronously, completion callback invoked with the reply
+ *
+ * @param[in]  ch        Clixon client handle
+ * @param[in]  namespace Default namespace used for non-prefixed entries in xpath
+ * @param[in]  xpath     XPath
+ * @param[in]  cb        Completion callback, see clixon_client_rpc_send
+ * @param[in]  arg       Callback argument
+ * @retval     0         OK, request sent and queued for completion
+ * @retval    -1         Error
+ * @see clixon_client_get_bool  and friends for the blocking variants
+ */
+int
+clixon_client_get_send(clixon_client_handle  ch,
+                       const char           *namespace,
+                       const char           *xpath,
+                       clixon_client_rpc_cb  cb,
+                       void                 *arg)
+{
+    int   retval = -1;
+    cbuf *msg = NULL;
+
+    if ((msg = cbuf_new()) == NULL){
+        clicon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_client_get_msg(namespace, xpath, msg) < 0)
+        goto done;
+    if (clixon_client_rpc_send(ch, msg, cb, arg) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (msg)
+        cbuf_free(msg);
+    return retval;
+}
+
 /*! Generic get value of body
  * @param[in]  sock      Open socket
  * @param[in]  namespace Default namespace used for non-prefixed entries in xpath.
@@ -41,6 +41,7 @@
 #include "clixon_config.h" /* generated by config & autoconf */
 #endif
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -61,6 +62,10 @@
 /* cligen */
 #include <cligen/cligen.h>
 
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
 /* clixon */
 #include "clixon_err.h"
 #include "clixon_log.h"
@@ -69,6 +74,7 @@
 #include "clixon_handle.h"
 #include "clixon_string.h"
 #include "clixon_file.h"
+#include "clixon_event.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_yang_module.h"
@@ -80,6 +86,8 @@
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
 
+/* Forward */
+static int xmldb_validate_file(clicon_handle h, const char *db, char **filep);
 
 /*! Translate from symbolic database name to actual filename in file-system
  * @param[in]   th       text handle handle
@@ -138,6 +146,145 @@ xmldb_validate_db(const char *db)
     return 0;
 }
 
+/*
+ * Datastore cache eviction, see CLICON_XMLDB_CACHE_TIMEOUT
+ * Cached trees of idle databases are freed periodically to bound resident
+ * memory. The running cache is pinned, as are locked databases, caches with
+ * deferred snapshot writes, and bases shared by copy-on-write overlays.
+ */
+static int _xmldb_evict_registered = 0;
+
+static int xmldb_evict_timeout(int fd, void *arg);
+
+/*! Touch last-access time of a database cache, for idle eviction
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     0   OK
+ * @see xmldb_cache_prune
+ */
+int
+xmldb_cache_touch(clicon_handle h,
+                  const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+        gettimeofday(&de->de_atime, NULL);
+    return 0;
+}
+
+/*! Evict cached trees of databases that have been idle longer than a limit
+ * The file (plus journal, if any) remains authoritative so an evicted cache
+ * is simply re-read on next access.
+ * @param[in]  h     Clicon handle
+ * @param[in]  idle  Evict caches not accessed for this many seconds
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_cache_prune(clicon_handle h,
+                  int           idle)
+{
+    int            retval = -1;
+    char         **keys = NULL;
+    size_t         klen;
+    int            i;
+    int            j;
+    int            shared;
+    db_elmnt      *de;
+    db_elmnt      *de2;
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++){
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL)
+            continue;
+        if (de->de_xml == NULL)
+            continue;
+        if (strcmp(keys[i], "running") == 0) /* pinned */
+            continue;
+        if (de->de_id != 0)                  /* locked */
+            continue;
+        if (de->de_pending)                  /* snapshot write deferred */
+            continue;
+        /* Pinned if some overlay shares this cache as its base */
+        shared = 0;
+        for (j = 0; j < klen; j++)
+            if ((de2 = clicon_hash_value(clicon_db_elmnt(h), keys[j], NULL)) != NULL &&
+                de2->de_base && strcmp(de2->de_base, keys[i]) == 0){
+                shared++;
+                break;
+            }
+        if (shared)
+            continue;
+        if (de->de_atime.tv_sec == 0){ /* populated outside the access paths */
+            de->de_atime = now;
+            continue;
+        }
+        if (now.tv_sec - de->de_atime.tv_sec < idle)
+            continue;
+        clicon_debug(1, "%s: evicting idle cache of %s", __FUNCTION__, keys[i]);
+        xml_free(de->de_xml);
+        de->de_xml = NULL;
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Register the periodic cache eviction scan, if enabled and not yet done
+ * The scan period equals the idle limit, so a cache lives at most two
+ * periods beyond its last access.
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK (including eviction disabled)
+ * @retval    -1   Error
+ */
+static int
+xmldb_evict_register(clicon_handle h)
+{
+    struct timeval now;
+    struct timeval t;
+    struct timeval d = {0,};
+    int            idle;
+
+    if (_xmldb_evict_registered)
+        return 0;
+    if ((idle = clicon_option_int(h, "CLICON_XMLDB_CACHE_TIMEOUT")) <= 0)
+        return 0;
+    gettimeofday(&now, NULL);
+    d.tv_sec = idle;
+    timeradd(&now, &d, &t);
+    if (clixon_event_reg_timeout(t, xmldb_evict_timeout, h, "datastore cache eviction") < 0)
+        return -1;
+    _xmldb_evict_registered = 1;
+    return 0;
+}
+
+/*! Timeout callback of the periodic cache eviction scan
+ * @param[in]  fd   Ignored
+ * @param[in]  arg  Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_evict_timeout(int   fd,
+                    void *arg)
+{
+    clicon_handle h = (clicon_handle)arg;
+    int           idle;
+
+    _xmldb_evict_registered = 0;
+    if ((idle = clicon_option_int(h, "CLICON_XMLDB_CACHE_TIMEOUT")) <= 0)
+        return 0;
+    if (xmldb_cache_prune(h, idle) < 0)
+        return -1;
+    return xmldb_evict_register(h);
+}
+
 /*! Connect to a datastore plugin, allocate resources to be used in API calls
  * @param[in]  h    Clicon handle
  * @retval     0    OK
@@ -146,7 +293,7 @@ xmldb_validate_db(const char *db)
 int
 xmldb_connect(clicon_handle h)
 {
-    return 0;
+    return xmldb_evict_register(h);
 }
 
 /*! Disconnect from a datastore plugin and deallocate resources
@@ -163,14 +310,25 @@ xmldb_disconnect(clicon_handle h)
     int       i;
     db_elmnt *de;
     
+    /* Write out any deferred snapshots before the trees are freed */
+    if (xmldb_flush(h, NULL) < 0)
+        goto done;
     if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
         goto done;
-    for(i = 0; i < klen; i++) 
+    for(i = 0; i < klen; i++)
         if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL){
             if (de->de_xml){
                 xml_free(de->de_xml);
                 de->de_xml = NULL;
             }
+            if (de->de_base){
+                free(de->de_base);
+                de->de_base = NULL;
+            }
+            if (de->de_touched){
+                cvec_free(de->de_touched);
+                de->de_touched = NULL;
+            }
         }
     retval = 0;
  done:
@@ -179,29 +337,177 @@ xmldb_disconnect(clicon_handle h)
     return retval;
 }
 
-/*! Copy database from db1 to db2
+/*! Materialize an unmaterialized copy-on-write overlay database
+ *
+ * In cache mode cache-cow, xmldb_copy_cache defers the cache duplication:
+ * the destination only records its base db in de_base and reads resolve to
+ * the base cache. This function performs the deferred deep copy. Must be
+ * called before the overlay or its base is modified. A no-op unless db is
+ * an unmaterialized overlay.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_cow_break  for materializing all overlays of a base
+ */
+int
+xmldb_cow_materialize(clicon_handle h,
+                      const char   *db)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    db_elmnt *deb;
+    cxobj    *x1 = NULL;
+    cxobj    *x2 = NULL;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || de->de_base == NULL)
+        return 0;
+    if (de->de_xml == NULL &&
+        (deb = clicon_db_elmnt_get(h, de->de_base)) != NULL &&
+        (x1 = deb->de_xml) != NULL){
+        if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_flag_set(x2, XML_FLAG_TOP);
+        if (xml_copy(x1, x2) < 0){
+            xml_free(x2);
+            goto done;
+        }
+        de->de_xml = x2;
+    }
+    /* If the base cache is empty the overlay falls back to its own file,
+     * which was copied when the share was set up
+     */
+    free(de->de_base);
+    de->de_base = NULL;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Materialize all copy-on-write overlays that share the cache of a base db
+ * Must be called before the base cache is modified, replaced or freed.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Base database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_cow_materialize
+ */
+int
+xmldb_cow_break(clicon_handle h,
+                const char   *db)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    int       i;
+    db_elmnt *de;
+
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++){
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL)
+            continue;
+        if (de->de_base == NULL || strcmp(de->de_base, db) != 0)
+            continue;
+        if (xmldb_cow_materialize(h, keys[i]) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Maintain touched-path logs over a database copy
+ * The logs are relative to running: a copy to running makes them all stale,
+ * and after any copy the destination equals the source, see xmldb_touched_get
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+touched_after_copy(clicon_handle h,
+                   const char   *from,
+                   const char   *to)
+{
+    if (strcmp(to, "running") == 0){
+        if (xmldb_touched_invalidate_all(h) < 0)
+            return -1;
+        if (xmldb_touched_clear(h, from) < 0)
+            return -1;
+    }
+    else if (strcmp(from, "running") == 0){
+        if (xmldb_touched_clear(h, to) < 0)
+            return -1;
+    }
+    else if (xmldb_touched_invalidate(h, to) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Copy database cache from db1 to db2, leaving the files untouched
+ * Used at commit in journal mode where the diff is persisted as delta
+ * records instead of a file copy, see xmldb_journal_delta
  * @param[in]  h     Clicon handle
  * @param[in]  from  Source database
  * @param[in]  to    Destination database
  * @retval -1  Error
  * @retval  0  OK
-  */
-int 
-xmldb_copy(clicon_handle h, 
-           const char   *from, 
-           const char   *to)
+ * @see xmldb_copy  which also copies the files
+ */
+int
+xmldb_copy_cache(clicon_handle h,
+                 const char   *from,
+                 const char   *to)
 {
     int                 retval = -1;
-    char               *fromfile = NULL;
-    char               *tofile = NULL;
     db_elmnt           *de1 = NULL; /* from */
     db_elmnt           *de2 = NULL; /* to */
     db_elmnt            de0 = {0,};
     cxobj              *x1 = NULL;  /* from */
     cxobj              *x2 = NULL;  /* to */
 
-    clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
     /* XXX lock */
+    if (clicon_datastore_cache(h) == DATASTORE_CACHE_COW){
+        const char *base = from;
+
+        /* Defer the cache duplication: record the base db and share its
+         * cache until either side is modified, see xmldb_cow_materialize.
+         * If from is itself an unmaterialized overlay, share its base
+         * instead so chains do not form
+         */
+        if ((de1 = clicon_db_elmnt_get(h, from)) != NULL &&
+            de1->de_xml == NULL && de1->de_base)
+            base = de1->de_base;
+        /* from is an unmaterialized overlay of to: content already identical */
+        if (strcmp(base, to) == 0){
+            retval = 0;
+            goto done;
+        }
+        /* Overlays of "to" lose their base when it is overwritten */
+        if (xmldb_cow_break(h, to) < 0)
+            goto done;
+        if ((de2 = clicon_db_elmnt_get(h, to)) != NULL)
+            de0 = *de2;
+        if (de0.de_xml){
+            xml_free(de0.de_xml);
+            de0.de_xml = NULL;
+        }
+        if (de0.de_base)
+            free(de0.de_base);
+        if ((de0.de_base = strdup(base)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        clicon_db_elmnt_set(h, to, &de0);
+        if (touched_after_copy(h, from, to) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     if (clicon_datastore_cache(h) != DATASTORE_NOCACHE){
         /* Copy in-memory cache */
         /* 1. "to" xml tree in x1 */
@@ -223,13 +529,22 @@ xmldb_copy(clicon_handle h,
             if (xml_copy(x1, x2) < 0) 
                 goto done;
         }
-        else{ /* copy x1 to x2 */
-            xml_free(x2);
-            if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
+        else{ /* copy x1 to x2: build the new tree aside, then swap.
+               * The old tree is freed only after the copy succeeded, so the
+               * cache entry never points at a freed or half-built tree, and
+               * an error here leaves the previous snapshot intact
+               */
+            cxobj *xnew;
+
+            if ((xnew = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
                 goto done;
-            xml_flag_set(x2, XML_FLAG_TOP);
-            if (xml_copy(x1, x2) < 0) 
+            xml_flag_set(xnew, XML_FLAG_TOP);
+            if (xml_copy(x1, xnew) < 0){
+                xml_free(xnew);
                 goto done;
+            }
+            xml_free(x2);
+            x2 = xnew;
         }
         /* always set cache although not strictly necessary in case 1
          * above, but logic gets complicated due to differences with
@@ -239,20 +554,252 @@ xmldb_copy(clicon_handle h,
         de0.de_xml = x2; /* The new tree */
     }
     clicon_db_elmnt_set(h, to, &de0);
+    if (touched_after_copy(h, from, to) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/* Running datastore generation: incremented on every modification of the
+ * running db (put, copy-to, delete), so that pollers can detect actual
+ * commits with a cheap query instead of re-reading data,
+ * see the clixon-lib generation RPC
+ */
+static uint64_t _xmldb_generation = 0;
+
+/*! Get the running datastore generation
+ * @retval gen  Current generation, bumped on each modification of running
+ * @see xmldb_generation_incr
+ */
+uint64_t
+xmldb_generation_get(void)
+{
+    return _xmldb_generation;
+}
+
+/*! Bump the datastore generation if db is the running datastore
+ * Called from the datastore modification entry points.
+ * @param[in]  db  Database name
+ * @retval     0   OK
+ */
+int
+xmldb_generation_incr(const char *db)
+{
+    if (db && strcmp(db, "running") == 0)
+        _xmldb_generation++;
+    return 0;
+}
+
+/*! Move database cache from db1 to db2, leaving the files untouched
+ *
+ * Ownership-transferring variant of xmldb_copy_cache: the source tree is
+ * spliced into the destination entry instead of deep-copied, which is the
+ * dominant in-memory cost when committing a large candidate. The source
+ * cache entry is cleared: in cache mode cache-cow it becomes an
+ * unmaterialized overlay of the destination so reads stay cheap, otherwise
+ * the next read re-parses the source file. Only valid when the source and
+ * destination are known to hold equal content afterwards, eg commit where
+ * candidate equals running once the accompanying file copy is done.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval -1  Error
+ * @retval  0  OK
+ * @see xmldb_copy_cache  which duplicates the tree and leaves the source
+ */
+int
+xmldb_steal_cache(clicon_handle h,
+                  const char   *from,
+                  const char   *to)
+{
+    int                 retval = -1;
+    db_elmnt           *de1 = NULL; /* from */
+    db_elmnt           *de2 = NULL; /* to */
+    db_elmnt            de0 = {0,}; /* new to */
+    db_elmnt            def = {0,}; /* new from */
+
+    if (clicon_datastore_cache(h) == DATASTORE_NOCACHE)
+        return 0; /* Nothing cached to move */
+    /* Fold any deferred snapshot write before the tree moves away */
+    if (xmldb_flush(h, from) < 0)
+        goto done;
+    de1 = clicon_db_elmnt_get(h, from);
+    if (clicon_datastore_cache(h) == DATASTORE_CACHE_COW){
+        /* An unmaterialized overlay has no tree of its own to steal */
+        if (de1 && de1->de_xml == NULL && de1->de_base){
+            if (strcmp(de1->de_base, to) == 0){
+                retval = 0; /* from is an overlay of to: already identical */
+                goto done;
+            }
+            retval = xmldb_copy_cache(h, from, to);
+            goto done;
+        }
+        /* Overlays sharing either cache must materialize before it changes */
+        if (xmldb_cow_break(h, from) < 0)
+            goto done;
+        if (xmldb_cow_break(h, to) < 0)
+            goto done;
+        de1 = clicon_db_elmnt_get(h, from);
+    }
+    if (de1)
+        def = *de1;
+    if (def.de_base){ /* materialized above: the base record is stale */
+        free(def.de_base);
+        def.de_base = NULL;
+    }
+    if ((de2 = clicon_db_elmnt_get(h, to)) != NULL)
+        de0 = *de2;
+    /* Splice the source tree into the destination entry */
+    if (de0.de_xml)
+        xml_free(de0.de_xml);
+    de0.de_xml = def.de_xml;
+    de0.de_empty = def.de_empty;
+    if (de0.de_base){
+        free(de0.de_base);
+        de0.de_base = NULL;
+    }
+    clicon_db_elmnt_set(h, to, &de0);
+    /* Clear the source cache; in cache-cow it can keep reading the moved
+     * tree as an overlay of the destination
+     */
+    def.de_xml = NULL;
+    if (clicon_datastore_cache(h) == DATASTORE_CACHE_COW){
+        if ((def.de_base = strdup(to)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    clicon_db_elmnt_set(h, from, &def);
+    if (touched_after_copy(h, from, to) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Copy the datastore files from db1 to db2, cache handled by caller
+ * Shared tail of xmldb_copy and xmldb_move: snapshot file, destination
+ * journal truncation and validation fingerprint sidecar
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval -1  Error
+ * @retval  0  OK
+ */
+static int
+xmldb_copy_files(clicon_handle h,
+                 const char   *from,
+                 const char   *to)
+{
+    int                 retval = -1;
+    char               *fromfile = NULL;
+    char               *tofile = NULL;
+    char               *fromvfile = NULL;
+    char               *tovfile = NULL;
+    struct stat         sb;
 
-    /* Copy the files themselves (above only in-memory cache) */
     if (xmldb_db2file(h, from, &fromfile) < 0)
         goto done;
     if (xmldb_db2file(h, to, &tofile) < 0)
         goto done;
     if (clicon_file_copy(fromfile, tofile) < 0)
         goto done;
+    if (xmldb_journal_truncate(h, to, 0) < 0)
+        goto done;
+    /* The validation fingerprint is content-keyed so the source sidecar, if
+     * any, is valid for the destination after the copy
+     */
+    if (xmldb_validate_file(h, from, &fromvfile) < 0)
+        goto done;
+    if (xmldb_validate_file(h, to, &tovfile) < 0)
+        goto done;
+    if (lstat(fromvfile, &sb) == 0){
+        if (clicon_file_copy(fromvfile, tovfile) < 0)
+            goto done;
+    }
+    else if (unlink(tovfile) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "unlink(%s)", tovfile);
+        goto done;
+    }
+    xmldb_generation_incr(to);
     retval = 0;
  done:
     if (fromfile)
         free(fromfile);
     if (tofile)
         free(tofile);
+    if (fromvfile)
+        free(fromvfile);
+    if (tovfile)
+        free(tovfile);
+    return retval;
+}
+
+/*! Copy database from db1 to db2
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval -1  Error
+ * @retval  0  OK
+  */
+int
+xmldb_copy(clicon_handle h,
+           const char   *from,
+           const char   *to)
+{
+    int                 retval = -1;
+
+    clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
+    if (xmldb_copy_cache(h, from, to) < 0)
+        goto done;
+    /* Fold any deferred write and write-ahead journal into the source
+     * snapshot before the file copy, and drop the destination journal which
+     * is stale after it
+     */
+    if (xmldb_flush(h, from) < 0)
+        goto done;
+    if (xmldb_journal_flush(h, from) < 0)
+        goto done;
+    if (xmldb_copy_files(h, from, to) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Move database from db1 to db2: steal the cache, copy the files
+ * As xmldb_copy but transfers ownership of the source cache tree instead of
+ * deep-copying it, see xmldb_steal_cache for when this is valid. Used at
+ * commit where copying a large candidate tree dominates the copy step.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval -1  Error
+ * @retval  0  OK
+ * @see xmldb_copy
+ */
+int
+xmldb_move(clicon_handle h,
+           const char   *from,
+           const char   *to)
+{
+    int                 retval = -1;
+
+    clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
+    /* Deferred write and journal must fold into the source snapshot before
+     * the cache steal empties the source entry
+     */
+    if (xmldb_flush(h, from) < 0)
+        goto done;
+    if (xmldb_journal_flush(h, from) < 0)
+        goto done;
+    if (xmldb_steal_cache(h, from, to) < 0)
+        goto done;
+    if (xmldb_copy_files(h, from, to) < 0)
+        goto done;
+    retval = 0;
+ done:
     return retval;
 }
 
@@ -414,18 +961,27 @@ xmldb_exists(clicon_handle h,
  * @retval -1  Error
  * @retval  0  OK
  */
-int 
-xmldb_clear(clicon_handle h, 
+int
+xmldb_clear(clicon_handle h,
             const char   *db)
 {
     cxobj    *xt = NULL;
     db_elmnt *de = NULL;
-    
+
+    /* Copy-on-write overlays of this db must be materialized before the
+     * shared cache is freed
+     */
+    if (xmldb_cow_break(h, db) < 0)
+        return -1;
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
         if ((xt = de->de_xml) != NULL){
             xml_free(xt);
             de->de_xml = NULL;
         }
+        if (de->de_base){
+            free(de->de_base);
+            de->de_base = NULL;
+        }
     }
     return 0;
 }
@@ -437,14 +993,15 @@ xmldb_clear(clicon_handle h,
  * @retval  0  OK
  * @note  Datastore is not actually deleted so that a backend after dropping priviliges can re-create it
  */
-int 
-xmldb_delete(clicon_handle h, 
+int
+xmldb_delete(clicon_handle h,
              const char   *db)
 {
     int                 retval = -1;
     char               *filename = NULL;
+    char               *vfile = NULL;
     struct stat         sb;
-    
+
     clicon_debug(2, "%s %s", __FUNCTION__, db);
     if (xmldb_clear(h, db) < 0)
         goto done;
@@ -455,10 +1012,27 @@ xmldb_delete(clicon_handle h,
             clicon_err(OE_DB, errno, "truncate %s", filename);
             goto done;
         }
+    if (xmldb_journal_truncate(h, db, 0) < 0)
+        goto done;
+    if (xmldb_validate_file(h, db, &vfile) < 0)
+        goto done;
+    if (unlink(vfile) < 0 && errno != ENOENT){
+        clicon_err(OE_UNIX, errno, "unlink(%s)", vfile);
+        goto done;
+    }
+    if (strcmp(db, "running") == 0){
+        if (xmldb_touched_invalidate_all(h) < 0)
+            goto done;
+    }
+    else if (xmldb_touched_invalidate(h, db) < 0)
+        goto done;
+    xmldb_generation_incr(db);
     retval = 0;
  done:
     if (filename)
         free(filename);
+    if (vfile)
+        free(vfile);
     return retval;
 }
 
@@ -673,3 +1247,541 @@ xmldb_rename(clicon_handle h,
         free(old);
     return retval;
 }
+
+/*
+ * Datastore validation cache, see CLICON_VALIDATE_CACHE
+ * A fingerprint of the datastore file and the loaded YANG module set is
+ * written to a sidecar file after successful validation. Startup can then
+ * skip re-validating a file whose fingerprint still matches. The cache is
+ * content-keyed and needs no explicit invalidation: writing different
+ * content (or loading other modules) simply no longer matches the sidecar.
+ */
+
+/*! Return validation-cache sidecar filename of a database
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Database name
+ * @param[out] filep  Sidecar filename, unallocate after use with free()
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_journal_file  for the same naming convention
+ */
+static int
+xmldb_validate_file(clicon_handle h,
+                    const char   *db,
+                    char        **filep)
+{
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s_valid", dbfile);
+    if ((*filep = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Fold a byte buffer into a 32-bit FNV-1a fingerprint
+ */
+static uint32_t
+xmldb_fp32(uint32_t             fp,
+           const unsigned char *buf,
+           size_t               len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++){
+        fp ^= buf[i];
+        fp *= 16777619u;
+    }
+    return fp;
+}
+
+/*! Fold the bytes of a file into a 32-bit FNV-1a fingerprint
+ * @param[in]     filename  File to read
+ * @param[in]     optional  If set, a missing file folds nothing instead of failing
+ * @param[in,out] fpp       Fingerprint
+ * @retval        0         OK
+ * @retval       -1         Error, eg file not found
+ */
+static int
+xmldb_fp32_file(const char *filename,
+                int         optional,
+                uint32_t   *fpp)
+{
+    int            retval = -1;
+    FILE          *f = NULL;
+    unsigned char  buf[BUFSIZ];
+    size_t         len;
+
+    if ((f = fopen(filename, "r")) == NULL){
+        if (optional && errno == ENOENT)
+            goto ok;
+        clicon_err(OE_UNIX, errno, "open(%s)", filename);
+        goto done;
+    }
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+        *fpp = xmldb_fp32(*fpp, buf, len);
+    if (ferror(f)){
+        clicon_err(OE_UNIX, errno, "read(%s)", filename);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    return retval;
+}
+
+/*! Compute fingerprint of a database file and the loaded YANG module set
+ * Covers the raw snapshot file bytes, any pending write-ahead journal bytes
+ * and the name and revision of every loaded (sub)module, so the fingerprint
+ * changes whenever the configuration or the model set does. Including the
+ * journal means the fingerprint identifies the full replayed content, so a
+ * database restored after a crash (snapshot + journal replay) still matches
+ * a sidecar recorded at the last commit.
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name
+ * @param[out] fpp  Fingerprint
+ * @retval     0    OK
+ * @retval    -1    Error, eg file not found
+ */
+static int
+xmldb_fingerprint(clicon_handle h,
+                  const char   *db,
+                  uint32_t     *fpp)
+{
+    int            retval = -1;
+    yang_stmt     *yspec = clicon_dbspec_yang(h);
+    yang_stmt     *ym = NULL;
+    yang_stmt     *yrev;
+    char          *filename = NULL;
+    char          *jfile = NULL;
+    char          *str;
+    uint32_t       fp = 2166136261u; /* FNV-1a offset basis */
+
+    if (yspec != NULL)
+        while ((ym = yn_each(yspec, ym)) != NULL){
+            if ((str = yang_argument_get(ym)) != NULL)
+                fp = xmldb_fp32(fp, (unsigned char*)str, strlen(str)+1);
+            if ((yrev = yang_find(ym, Y_REVISION, NULL)) != NULL &&
+                (str = yang_argument_get(yrev)) != NULL)
+                fp = xmldb_fp32(fp, (unsigned char*)str, strlen(str)+1);
+        }
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if (xmldb_fp32_file(filename, 0, &fp) < 0)
+        goto done;
+    if (xmldb_journal_file(h, db, &jfile) < 0)
+        goto done;
+    if (xmldb_fp32_file(jfile, 1, &fp) < 0)
+        goto done;
+    *fpp = fp;
+    retval = 0;
+ done:
+    if (jfile)
+        free(jfile);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Record that the current content of a database has passed validation
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_validated_get  where the fingerprint is checked at startup
+ */
+int
+xmldb_validated_set(clicon_handle h,
+                    const char   *db)
+{
+    int       retval = -1;
+    char     *vfile = NULL;
+    FILE     *f = NULL;
+    uint32_t  fp = 0;
+
+    if (xmldb_fingerprint(h, db, &fp) < 0)
+        goto done;
+    if (xmldb_validate_file(h, db, &vfile) < 0)
+        goto done;
+    if ((f = fopen(vfile, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "open(%s)", vfile);
+        goto done;
+    }
+    fprintf(f, "%08x\n", fp);
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (vfile)
+        free(vfile);
+    return retval;
+}
+
+/*! Check if database content is unchanged since it last passed validation
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     1   Unchanged, validation can be skipped
+ * @retval     0   No sidecar or fingerprint mismatch
+ * @retval    -1   Error
+ */
+int
+xmldb_validated_get(clicon_handle h,
+                    const char   *db)
+{
+    int          retval = -1;
+    char        *vfile = NULL;
+    FILE        *f = NULL;
+    unsigned int fp0;
+    uint32_t     fp = 0;
+
+    /* Pending journal records are covered by the fingerprint itself, see
+     * xmldb_fingerprint, so a crash-recovered db (snapshot + journal) can
+     * still match a sidecar recorded at the last commit */
+    if (xmldb_validate_file(h, db, &vfile) < 0)
+        goto done;
+    if ((f = fopen(vfile, "r")) == NULL){
+        if (errno == ENOENT)
+            goto nomatch;
+        clicon_err(OE_UNIX, errno, "open(%s)", vfile);
+        goto done;
+    }
+    if (fscanf(f, "%x", &fp0) != 1)
+        goto nomatch;
+    if (xmldb_fingerprint(h, db, &fp) < 0)
+        goto done;
+    if (fp != (uint32_t)fp0)
+        goto nomatch;
+    retval = 1;
+ done:
+    if (f)
+        fclose(f);
+    if (vfile)
+        free(vfile);
+    return retval;
+ nomatch:
+    retval = 0;
+    goto done;
+}
+
+/*
+ * Touched-path log: xmldb_put records the paths its edits touch so that the
+ * commit diff can be restricted to those subtrees instead of walking the
+ * full trees, see xml_diff_paths. The log on a db means "paths where this db
+ * may differ from running". NULL means unknown and forces a full diff; an
+ * empty log means the db equals running. Writes to running and copies from
+ * other sources invalidate the logs.
+ */
+#define XMLDB_TOUCHED_MAX 256 /* Above this many paths a full diff is cheaper */
+
+/*! Reset the touched-path log of a database to empty (known equal to running)
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_touched_clear(clicon_handle h,
+                    const char   *db)
+{
+    db_elmnt  *de;
+    db_elmnt   de0 = {0,};
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+        de0 = *de;
+    if (de0.de_touched)
+        cvec_reset(de0.de_touched);
+    else if ((de0.de_touched = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        return -1;
+    }
+    clicon_db_elmnt_set(h, db, &de0);
+    return 0;
+}
+
+/*! Invalidate the touched-path log of a database (unknown: full diff needed)
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     0   OK
+ */
+int
+xmldb_touched_invalidate(clicon_handle h,
+                         const char   *db)
+{
+    db_elmnt  *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL &&
+        de->de_touched != NULL){
+        cvec_free(de->de_touched);
+        de->de_touched = NULL;
+        clicon_db_elmnt_set(h, db, de);
+    }
+    return 0;
+}
+
+/*! Invalidate the touched-path logs of all databases
+ * Used when running changes by other means than a tracked commit: all logs
+ * are relative to running and become stale.
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_touched_invalidate_all(clicon_handle h)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    int       i;
+
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++)
+        if (xmldb_touched_invalidate(h, keys[i]) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Append a path to the touched-path log of a database
+ * No-op if the log is invalid. On overflow or duplicate handling failure the
+ * log is invalidated so correctness falls back to the full diff.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Database name
+ * @param[in]  xpath  Path of the touched node (copied)
+ * @param[in]  depth  Depth of the node, used to diff ancestors before descendants
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xmldb_touched_add(clicon_handle h,
+                  const char   *db,
+                  char         *xpath,
+                  int           depth)
+{
+    db_elmnt  *de;
+    cg_var    *cv;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL ||
+        de->de_touched == NULL)
+        return 0;
+    if (cvec_find(de->de_touched, xpath) != NULL) /* Already recorded */
+        return 0;
+    if (cvec_len(de->de_touched) >= XMLDB_TOUCHED_MAX)
+        return xmldb_touched_invalidate(h, db);
+    if ((cv = cvec_add(de->de_touched, CGV_INT32)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_add");
+        return -1;
+    }
+    if (cv_name_set(cv, xpath) == NULL){
+        clicon_err(OE_UNIX, errno, "cv_name_set");
+        return -1;
+    }
+    cv_int32_set(cv, depth);
+    return 0;
+}
+
+/*! Get the touched-path log of a database
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Database name
+ * @retval     cvec  Log of touched paths (may be empty: db equals running)
+ * @retval     NULL  Log is invalid, a full diff is needed
+ */
+cvec *
+xmldb_touched_get(clicon_handle h,
+                  const char   *db)
+{
+    db_elmnt  *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return NULL;
+    return de->de_touched;
+}
+
+/*
+ * Datastore file compression, see CLICON_XMLDB_COMPRESS
+ * Files are compressed as a single zstd frame; reading auto-detects by the
+ * zstd frame magic so plain and compressed files can be mixed freely.
+ */
+
+/*! Check if a datastore file is zstd-compressed by its magic
+ * Works also when built without zstd so a compressed file gives a clear
+ * error instead of a parse failure.
+ * @param[in]  fp   Open datastore file, position is restored
+ * @retval     1    Compressed
+ * @retval     0    Not compressed (or too short)
+ * @retval    -1    Error
+ */
+int
+xmldb_file_compressed(FILE *fp)
+{
+    unsigned char magic[4];
+    size_t        n;
+
+    n = fread(magic, 1, sizeof(magic), fp);
+    if (ferror(fp)){
+        clicon_err(OE_UNIX, errno, "fread");
+        return -1;
+    }
+    rewind(fp);
+    /* zstd frame magic, little-endian 0xFD2FB528 */
+    return n == 4 &&
+        magic[0] == 0x28 && magic[1] == 0xb5 &&
+        magic[2] == 0x2f && magic[3] == 0xfd;
+}
+
+#ifdef HAVE_LIBZSTD
+/*! Compress a buffer to an open file as one zstd frame, streamed chunk-wise
+ * @param[in]  f    Output file
+ * @param[in]  buf  Serialized datastore content
+ * @param[in]  len  Length of buf
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xmldb_zstd_write(FILE       *f,
+                 const char *buf,
+                 size_t      len)
+{
+    int             retval = -1;
+    ZSTD_CCtx      *cctx = NULL;
+    ZSTD_inBuffer   in;
+    ZSTD_outBuffer  out = {0,};
+    size_t          outmax = ZSTD_CStreamOutSize();
+    size_t          ret;
+
+    if ((cctx = ZSTD_createCCtx()) == NULL){
+        clicon_err(OE_UNIX, errno, "ZSTD_createCCtx");
+        goto done;
+    }
+    if ((out.dst = malloc(outmax)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    out.size = outmax;
+    in.src = buf;
+    in.size = len;
+    in.pos = 0;
+    do {
+        out.pos = 0;
+        ret = ZSTD_compressStream2(cctx, &out, &in, ZSTD_e_end);
+        if (ZSTD_isError(ret)){
+            clicon_err(OE_XML, 0, "ZSTD_compressStream2: %s", ZSTD_getErrorName(ret));
+            goto done;
+        }
+        if (out.pos &&
+            fwrite(out.dst, out.pos, 1, f) != 1){
+            clicon_err(OE_UNIX, errno, "fwrite");
+            goto done;
+        }
+    } while (ret != 0);
+    retval = 0;
+ done:
+    if (out.dst)
+        free(out.dst);
+    if (cctx)
+        ZSTD_freeCCtx(cctx);
+    return retval;
+}
+
+/*! Decompress a zstd datastore file into a NUL-terminated buffer, streamed
+ * @param[in]  fp    Open datastore file positioned at start
+ * @param[out] bufp  Decompressed content, NUL-terminated, malloced
+ * @param[out] lenp  Length excluding the NUL
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+xmldb_zstd_read(FILE   *fp,
+                char  **bufp,
+                size_t *lenp)
+{
+    int             retval = -1;
+    ZSTD_DCtx      *dctx = NULL;
+    ZSTD_inBuffer   in = {0,};
+    ZSTD_outBuffer  out = {0,};
+    char           *inbuf = NULL;
+    char           *outbuf = NULL;
+    size_t          inmax = ZSTD_DStreamInSize();
+    size_t          outlen = 0;
+    size_t          outmax = 0;
+    size_t          n;
+    size_t          ret;
+    char           *b;
+
+    if ((dctx = ZSTD_createDCtx()) == NULL){
+        clicon_err(OE_UNIX, errno, "ZSTD_createDCtx");
+        goto done;
+    }
+    if ((inbuf = malloc(inmax)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    outmax = 4*inmax;
+    if ((outbuf = malloc(outmax+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    while ((n = fread(inbuf, 1, inmax, fp)) > 0){
+        in.src = inbuf;
+        in.size = n;
+        in.pos = 0;
+        while (in.pos < in.size){
+            if (outlen == outmax){
+                if ((b = realloc(outbuf, 2*outmax+1)) == NULL){
+                    clicon_err(OE_UNIX, errno, "realloc");
+                    goto done;
+                }
+                outbuf = b;
+                outmax *= 2;
+            }
+            out.dst = outbuf;
+            out.size = outmax;
+            out.pos = outlen;
+            ret = ZSTD_decompressStream(dctx, &out, &in);
+            if (ZSTD_isError(ret)){
+                clicon_err(OE_XML, 0, "ZSTD_decompressStream: %s", ZSTD_getErrorName(ret));
+                goto done;
+            }
+            outlen = out.pos;
+        }
+    }
+    if (ferror(fp)){
+        clicon_err(OE_UNIX, errno, "fread");
+        goto done;
+    }
+    outbuf[outlen] = '\0';
+    *bufp = outbuf;
+    outbuf = NULL;
+    if (lenp)
+        *lenp = outlen;
+    retval = 0;
+ done:
+    if (inbuf)
+        free(inbuf);
+    if (outbuf)
+        free(outbuf);
+    if (dctx)
+        ZSTD_freeDCtx(dctx);
+    return retval;
+}
+#endif /* HAVE_LIBZSTD */
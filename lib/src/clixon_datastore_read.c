@@ -62,6 +62,7 @@
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_log.h"
+#include "clixon_trace.h"
 #include "clixon_file.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
@@ -80,12 +81,17 @@
 #include "clixon_xml_map.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
 #include "clixon_xml_nsctx.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_write.h"
 
 #define handle(xh) (assert(text_handle_check(xh)==0),(struct text_handle *)(xh))
 
+/* Cached CLICON_XMLDB_FORMAT option, read per datastore file read */
+static clicon_option_cache _format_opt = {0,};
+
 /*! Ensure that xt only has a single sub-element and that is "config" 
  * @retval    -1     Top element not "config" or "config" element not unique or
  *                   other error, check specific clicon_errno, clicon_suberrno
@@ -443,6 +449,10 @@ disable_nacm_on_empty(cxobj     *xt,
  * @param[in]  db     Symbolic database name, eg "candidate", "running"
  * @param[in]  yb     How to bind yang to XML top-level when parsing
  * @param[in]  yspec  Top-level yang spec
+ * @param[in]  nsc    Namespace context of xpath, or NULL
+ * @param[in]  xpath  If set, prune non-matching subtrees before YANG bind so
+ *                    only the result set is bound and sorted (xpath pushdown).
+ *                    Only for callers that do not cache the returned tree
  * @param[out] xp     XML tree read from file
  * @param[out] de     If set, return db-element status (eg empty flag)
  * @param[out] msdiff If set, return modules-state differences
@@ -453,12 +463,22 @@ disable_nacm_on_empty(cxobj     *xt,
  * @note Use of 1 for OK
  * @note retval 0 is NYI because calling functions cannot handle it yet
  * XXX if this code pass tests this code can be rewritten, esp the modstate stuff
+ * @note Parallel (multi-threaded) parse of the db file was evaluated for large
+ *       startup datastores and rejected: the library is single-threaded by
+ *       design and parsing/binding mutate process-global state (clicon_err,
+ *       string intern and namespace-context pools, cbuf pool, yang cvec
+ *       caches populated during bind), so worker threads would race unless
+ *       all of those became thread-safe first. The single-threaded load path
+ *       is instead kept lean via clixon_xml_parse_mmap (in-place parse) and
+ *       the binary datastore format (no lexing), see CLICON_XMLDB_FORMAT.
  */
 int
 xmldb_readfile(clicon_handle    h,
                const char      *db,
                yang_bind        yb,
                yang_stmt       *yspec,
+               cvec            *nsc,
+               const char      *xpath,
                cxobj          **xp,
                db_elmnt        *de,
                modstate_diff_t *msdiff0,
@@ -466,6 +486,9 @@ xmldb_readfile(clicon_handle    h,
 {
     int              retval = -1;
     cxobj           *x0 = NULL;
+    cxobj          **xvec = NULL;
+    size_t           xlen;
+    int              i;
     char            *dbfile = NULL;
     FILE            *fp = NULL;
     char            *format;
@@ -480,6 +503,8 @@ xmldb_readfile(clicon_handle    h,
     cxobj           *xmodfile = NULL;
     cxobj           *x;
     yang_stmt       *yspec1 = NULL;
+    char            *zbuf = NULL;
+    FILE            *zfp = NULL;
 
     if (yb != YB_MODULE && yb != YB_NONE){
         clicon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
@@ -491,7 +516,7 @@ xmldb_readfile(clicon_handle    h,
         clicon_err(OE_XML, 0, "dbfile NULL");
         goto done;
     }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+    if ((format = clicon_option_str_cached(h, "CLICON_XMLDB_FORMAT", &_format_opt)) == NULL){
         clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
         goto done;
     }
@@ -506,12 +531,43 @@ xmldb_readfile(clicon_handle    h,
      *   config*
      * </config>
      * ret == 0 should not happen with YB_NONE. Binding is done later */
-    if (strcmp(format, "json")==0){
+    if ((ret = xmldb_file_compressed(fp)) < 0)
+        goto done;
+    if (ret == 1){
+#ifdef HAVE_LIBZSTD
+        /* Decompress to memory, then parse by format as usual */
+        if (xmldb_zstd_read(fp, &zbuf, NULL) < 0)
+            goto done;
+        if (strcmp(format, "json")==0){
+            if (clixon_json_parse_string(zbuf, 1, YB_NONE, yspec, &x0, xerr) < 0)
+                goto done;
+        }
+        else if (strcmp(format, "binary")==0){
+            if ((zfp = fmemopen(zbuf, strlen(zbuf), "r")) == NULL){
+                clicon_err(OE_UNIX, errno, "fmemopen");
+                goto done;
+            }
+            if (clixon_bin2xml(zfp, &x0) < 0)
+                goto done;
+        }
+        else if (clixon_xml_parse_string(zbuf, YB_NONE, yspec, &x0, xerr) < 0)
+            goto done;
+#else
+        clicon_err(OE_DB, 0, "%s is zstd-compressed but clixon is built without --enable-zstd", dbfile);
+        goto done;
+#endif
+    }
+    else if (strcmp(format, "json")==0){
         if (clixon_json_parse_file(fp, 1, YB_NONE, yspec, &x0, xerr) < 0) 
             goto done;
     }
+    else if (strcmp(format, "binary")==0){
+        if (clixon_bin2xml(fp, &x0) < 0)
+            goto done;
+    }
     else {
-        if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0){
+        /* mmap and parse the db file in place, see clixon_xml_parse_mmap */
+        if (clixon_xml_parse_mmap(fileno(fp), YB_NONE, yspec, &x0, xerr) < 0){
             goto done;
         }
     }
@@ -553,6 +609,25 @@ xmldb_readfile(clicon_handle    h,
      */
     if (text_read_modstate(h, yspec, x0, msdiff) < 0)
         goto done;
+    /* XPath pushdown: prune non-matching subtrees on the still unbound tree
+     * so that the YANG bind and sort below only process the result set.
+     * Evaluation before bind is equivalent to the caller:s evaluation after:
+     * namespaces come from the document and defaults are not yet present in
+     * either case. Skipped with a write-ahead journal whose replay needs the
+     * full tree.
+     */
+    if (xpath && strcmp(xpath, "/") != 0 &&
+        !clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")){
+        if (xpath_vec(x0, nsc, "%s", &xvec, &xlen, xpath) < 0)
+            goto done;
+        for (i=0; i<xlen; i++)
+            xml_flag_set(xvec[i], XML_FLAG_MARK);
+        if (!xml_flag(x0, XML_FLAG_MARK))
+            if (xml_tree_prune_flagged_sub(x0, XML_FLAG_MARK, 1, NULL) < 0)
+                goto done;
+        if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+            goto done;
+    }
     if (yb == YB_MODULE){
         if (msdiff){
             /* Check if old/deleted yangs not present in the loaded/running yangspec.
@@ -624,6 +699,9 @@ xmldb_readfile(clicon_handle    h,
             goto fail;
         if (xml_sort_recurse(x0) < 0)
             goto done;
+        /* Replay write-ahead journal edits on top of the snapshot, if any */
+        if (xmldb_journal_replay(h, db, yspec, x0) < 0)
+            goto done;
     }
     if (xp){
         *xp = x0;
@@ -638,10 +716,16 @@ xmldb_readfile(clicon_handle    h,
  done:
     if (yspec1)
         ys_free1(yspec1, 1);
+    if (xvec)
+        free(xvec);
     if (xmodfile)
         xml_free(xmodfile);
     if (msdiff)
         modstate_diff_free(msdiff);
+    if (zfp)
+        fclose(zfp);
+    if (zbuf)
+        free(zbuf);
     if (fp)
         fclose(fp);
     if (dbfile)
@@ -701,7 +785,7 @@ xmldb_get_nocache(clicon_handle    h,
         goto done;
     }
     /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-    if ((ret = xmldb_readfile(h, db, yb, yspec, &xt, &de0, msdiff, xerr)) < 0)
+    if ((ret = xmldb_readfile(h, db, yb, yspec, nsc, xpath, &xt, &de0, msdiff, xerr)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -858,29 +942,47 @@ xmldb_get_cache(clicon_handle     h,
     cxobj     *x1t = NULL;
     db_elmnt   de0 = {0,};
     int        ret;
+    int        defaults_added = 0;
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
     de = clicon_db_elmnt_get(h, db);
-    if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
+    /* An unmaterialized copy-on-write overlay shares the cache of its base db,
+     * see xmldb_cow_materialize
+     */
+    if (de && de->de_xml == NULL && de->de_base){
+        db_elmnt *deb;
+
+        if ((deb = clicon_db_elmnt_get(h, de->de_base)) != NULL)
+            x0t = deb->de_xml;
+    }
+    if (x0t != NULL)
+        ;
+    else if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
         /* If there is no xml x0 tree (in cache), then read it from file */
         /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-        if ((ret = xmldb_readfile(h, db, yb, yspec, &x0t, &de0, msdiff, xerr)) < 0)
+        if ((ret = xmldb_readfile(h, db, yb, yspec, NULL, NULL, &x0t, &de0, msdiff, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
-        /* Should we validate file if read from disk? 
+        /* Should we validate file if read from disk?
          * No, argument against: we may want to have a semantically wrong file and wish to edit?
          */
         de0.de_xml = x0t;
-        if (de)
+        if (de){
             de0.de_id = de->de_id;
+            if (de->de_base){ /* Overlay is now materialized from its own file */
+                free(de->de_base);
+                de->de_base = NULL;
+            }
+        }
         clicon_db_elmnt_set(h, db, &de0); /* Content is copied */
     } /* x0t == NULL */
     else
         x0t = de->de_xml;
+    xmldb_cache_touch(h, db); /* For idle eviction, see xmldb_cache_prune */
 
     if (yb == YB_MODULE && !xml_spec(x0t)){
         if ((ret = xml_bind_yang(x0t, YB_MODULE, yspec, xerr)) < 0)
@@ -894,6 +996,7 @@ xmldb_get_cache(clicon_handle     h,
             /* Add default recursive values */
             if (xml_default_recurse(x0t, 0) < 0)
                 goto done;
+            defaults_added = 1;
         }
     }
     /* Here x0t looks like: <config>...</config> */
@@ -937,13 +1040,32 @@ xmldb_get_cache(clicon_handle     h,
         }
         if (xml_copy_marked(x0t, x1t) < 0) /* config */
             goto done;
-        if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
-            goto done;
+        /* Reset only the flags set above: the matched nodes and their
+         * ancestors, not the whole cached tree
+         */
+        for (i=0; i<xlen; i++){
+            x0 = xvec[i];
+            xml_flag_reset(x0, XML_FLAG_MARK);
+            xml_apply_ancestor(x0, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CHANGE);
+        }
         if (xml_apply(x1t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
             goto done;
     }
-    /* Original tree: Remove global defaults and empty non-presence containers */
-    if (xml_defaults_nopresence(x0t, 2) < 0)
+    /* Original tree: Remove global defaults and empty non-presence containers.
+     * Only needed if defaults were added to the cached tree above (first read
+     * after bind): the cache is otherwise kept defaults-free by xmldb_put and
+     * this pass over the full tree dominated read cost for xpaths touching
+     * only one subtree
+     */
+    if (defaults_added &&
+        xml_defaults_nopresence(x0t, 2) < 0)
+        goto done;
+    /* First read after bind: compact large homogeneous leaf-lists in the
+     * cached tree. Reads copy them in packed form (see xml_copy), edits
+     * materialize only the lists they touch
+     */
+    if (defaults_added &&
+        xml_leaflist_pack_recurse(x0t) < 0)
         goto done;
     switch (wdef){
     case WITHDEFAULTS_REPORT_ALL:
@@ -1057,23 +1179,40 @@ xmldb_get_zerocopy(clicon_handle    h,
         goto done;
     }
     de = clicon_db_elmnt_get(h, db);
-    if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
+    /* An unmaterialized copy-on-write overlay shares the cache of its base db,
+     * see xmldb_cow_materialize
+     */
+    if (de && de->de_xml == NULL && de->de_base){
+        db_elmnt *deb;
+
+        if ((deb = clicon_db_elmnt_get(h, de->de_base)) != NULL)
+            x0t = deb->de_xml;
+    }
+    if (x0t != NULL)
+        ;
+    else if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
         /* If there is no xml x0 tree (in cache), then read it from file */
         /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-        if ((ret = xmldb_readfile(h, db, yb, yspec, &x0t, &de0, msdiff, xerr)) < 0)
+        if ((ret = xmldb_readfile(h, db, yb, yspec, NULL, NULL, &x0t, &de0, msdiff, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
-        /* Should we validate file if read from disk? 
+        /* Should we validate file if read from disk?
          * No, argument against: we may want to have a semantically wrong file and wish to edit?
          */
         de0.de_xml = x0t;
-        if (de)
+        if (de){
             de0.de_id = de->de_id;
+            if (de->de_base){ /* Overlay is now materialized from its own file */
+                free(de->de_base);
+                de->de_base = NULL;
+            }
+        }
         clicon_db_elmnt_set(h, db, &de0);
     } /* x0t == NULL */
     else
         x0t = de->de_xml;
+    xmldb_cache_touch(h, db); /* For idle eviction, see xmldb_cache_prune */
 
     /* Here xt looks like: <config>...</config> */
     if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
@@ -1255,6 +1394,8 @@ xmldb_get0(clicon_handle    h,
 {
     int               retval = -1;
 
+    CLIXON_PROBE2(xmldb_get, db, xpath);
+    clixon_trace_stage("xmldb-get");
     if (xret == NULL){
         clicon_err(OE_DB, EINVAL, "xret is NULL");
         goto done;
@@ -1277,6 +1418,15 @@ xmldb_get0(clicon_handle    h,
             break;
         }
         /* fall through */
+    case DATASTORE_CACHE_COW:
+        /* Copy-on-write: reads share the cache like zerocopy, writers
+         * materialize only the subtrees they touch, see xmldb_cow_copy
+         */
+        if (clicon_datastore_cache(h) == DATASTORE_CACHE_COW && !copy){
+            retval = xmldb_get_zerocopy(h, db, yb, nsc, xpath, wdef, xret, msdiff, xerr);
+            break;
+        }
+        /* fall through */
     case DATASTORE_CACHE:
         /* Get cache (file if empty) mark xpath match and copy marked into copy 
          * Add default values in copy, return copy
@@ -1335,9 +1485,32 @@ xmldb_get0_free(clicon_handle    h,
         return 0;
     /* Note that if clicon_datastore_cache(h) fails (returns -1), the following
      * xml_free can fail (if **xp not obtained using xmldb_get0) */
-    if (clicon_datastore_cache(h) != DATASTORE_CACHE_ZEROCOPY)
+    if (clicon_datastore_cache(h) != DATASTORE_CACHE_ZEROCOPY &&
+        clicon_datastore_cache(h) != DATASTORE_CACHE_COW)
         xml_free(*xp);
     *xp = NULL;
     return 0;
 }
 
+/*! Materialize a subtree of a shared (copy-on-write) datastore tree
+ *
+ * With CLICON_DATASTORE_CACHE cache-cow, xmldb_get0 returns a reference to the
+ * cached tree. A caller that needs to modify part of the result (eg NACM
+ * pruning, default tagging) copies just that subtree, including its ancestor
+ * spine, into a private tree x1t and edits the copy, leaving the cache intact.
+ * @param[in]  x0t   Top of shared (cached) tree as returned by xmldb_get0
+ * @param[in]  x0    Node in x0t whose subtree is to be modified
+ * @param[in]  x1t   Top of private result tree (created by caller, may be
+ *                   partially populated by earlier calls)
+ * @retval     0     OK, x0:s subtree and ancestors exist in x1t
+ * @retval    -1     General error, check specific clicon_errno, clicon_suberrno
+ * @see xmldb_get0  With the cache-cow datastore cache mode
+ */
+int
+xmldb_cow_copy(cxobj *x0t,
+               cxobj *x0,
+               cxobj *x1t)
+{
+    return xml_copy_from_bottom(x0t, x0, x1t);
+}
+
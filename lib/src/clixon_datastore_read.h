@@ -42,6 +42,7 @@
  * Prototypes
  */
 int xmldb_readfile(clicon_handle h, const char *db, yang_bind yb, yang_stmt *yspec,
+                   cvec *nsc, const char *xpath,
                    cxobj **xp, db_elmnt *de, modstate_diff_t *msd, cxobj **xerr);
 
 #endif /* _CLIXON_DATASTORE_READ_H */
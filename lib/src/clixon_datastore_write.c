@@ -47,6 +47,7 @@
 #include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <dirent.h>
 #include <syslog.h>       
@@ -62,7 +63,9 @@
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_log.h"
+#include "clixon_trace.h"
 #include "clixon_file.h"
+#include "clixon_event.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_xml_sort.h"
@@ -76,13 +79,34 @@
 #include "clixon_yang_type.h"
 #include "clixon_yang_module.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_path.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
+#include "clixon_xml_bind.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_map.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
 
+/* Edit payloads with at least this many XML nodes are merged in deferred-sort
+ * (build-then-sort) mode, see xml_sort_defer_begin
+ */
+#define XMLDB_PUT_DEFER_SORT_NR 10000
+
+/* When the write-ahead journal of a database grows beyond this many bytes,
+ * the snapshot file is rewritten and the journal removed, see xmldb_put
+ */
+#define XMLDB_JOURNAL_MAXSIZE (1024*1024)
+
+/* How long a deferred snapshot write may stay pending before the event loop
+ * flushes it to file, ie the bounded crash window of CLICON_XMLDB_WRITE_DEFER
+ */
+#define XMLDB_FLUSH_DELAY_MS 200
+
+/* Cached CLICON_XMLDB_FORMAT option, read per datastore file write */
+static clicon_option_cache _format_opt = {0,};
+
 /*! Given an attribute name and its expected namespace, find its value
  * 
  * An attribute may have a prefix(or NULL). The routine finds the associated
@@ -287,6 +311,7 @@ check_when_condition(cxobj              *x0p,
     int       retval = -1;
     char      *xpath = NULL;
     cvec      *nsc = NULL;
+    xpath_tree *xptree;
     int        nr;
     yang_stmt *y = NULL;
     cbuf      *cberr = NULL;
@@ -294,14 +319,23 @@ check_when_condition(cxobj              *x0p,
 
     if ((y = y0) != NULL ||
         (y = (yang_stmt*)xml_spec(x1)) != NULL){
-        if ((xpath = yang_when_xpath_get(y)) != NULL){ 
+        if ((xpath = yang_when_xpath_get(y)) != NULL){
             nsc = yang_when_nsc_get(y);
+            xptree = yang_xptree_get(y); /* Compiled at load, see yang_xptree_get */
             x1p = xml_parent(x1);
-            if ((nr = xpath_vec_bool(x1p, nsc, "%s", xpath)) < 0) /* Try request */
+            if (xptree)
+                nr = xpath_tree_bool(x1p, nsc, xptree);
+            else
+                nr = xpath_vec_bool(x1p, nsc, "%s", xpath);
+            if (nr < 0) /* Try request */
                 goto done;
             if (nr == 0){
                 /* Try existing tree */
-                if ((nr = xpath_vec_bool(x0p, nsc, "%s", xpath)) < 0)
+                if (xptree)
+                    nr = xpath_tree_bool(x0p, nsc, xptree);
+                else
+                    nr = xpath_vec_bool(x0p, nsc, "%s", xpath);
+                if (nr < 0)
                     goto done;
                 if (nr == 0){
                     if ((cberr = cbuf_new()) == NULL){
@@ -541,7 +575,7 @@ text_modify(clicon_handle       h,
          * See RFC 7950 Sec 7.7.9
          */
         if (yang_keyword_get(y0) == Y_LEAF_LIST &&
-            yang_find(y0, Y_ORDERED_BY, "user") != NULL){
+            yang_ordered_by_user(y0)){
             if ((ret = attr_ns_value(x1,
                                      "insert", YANG_XML_NAMESPACE,
                                      cbret, &instr)) < 0)
@@ -730,7 +764,7 @@ text_modify(clicon_handle       h,
          * See RFC 7950 Sec 7.8.6
          */
         if (yang_keyword_get(y0) == Y_LIST &&
-            yang_find(y0, Y_ORDERED_BY, "user") != NULL){
+            yang_ordered_by_user(y0)){
             if ((ret = attr_ns_value(x1,
                                      "insert", YANG_XML_NAMESPACE,
                                      cbret, &instr)) < 0)
@@ -1130,56 +1164,818 @@ text_modify_top(clicon_handle       h,
     goto done;
 } /* text_modify_top */
 
-/*! Modify database given an xml tree and an operation
+/*! Write a datastore XML tree to its snapshot file in the configured format
+ *
+ * Module revision info is added before writing (and removed again) if a
+ * modstate cache is set, see CLICON_XMLDB_MODSTATE.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name
+ * @param[in]  x0    Top-level XML tree, on the form <config>...
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_writefile(clicon_handle h,
+                const char   *db,
+                cxobj        *x0)
+{
+    int    retval = -1;
+    char  *dbfile = NULL;
+    FILE  *f = NULL;
+    cbuf  *cbz = NULL;
+    cxobj *xmodst = NULL;
+    cxobj *x;
+    char  *format;
+    int    pretty;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if (dbfile==NULL){
+        clicon_err(OE_XML, 0, "dbfile NULL");
+        goto done;
+    }
+    /* Add module revision info before writing to file)
+     * Only if CLICON_XMLDB_MODSTATE is set
+     */
+    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
+        if ((xmodst = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(x0, xmodst) < 0)
+            goto done;
+    }
+    if ((format = clicon_option_str_cached(h, "CLICON_XMLDB_FORMAT", &_format_opt)) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        goto done;
+    }
+    if ((f = fopen(dbfile, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+        goto done;
+    }
+    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
+    if (clicon_option_bool(h, "CLICON_XMLDB_COMPRESS")){
+#ifdef HAVE_LIBZSTD
+        /* Serialize to buffer, then stream-compress to file */
+        if ((cbz = cbuf_pool_get()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_pool_get");
+            goto done;
+        }
+        if (strcmp(format,"json")==0){
+            if (clixon_json2cbuf(cbz, x0, pretty, 0, 0) < 0)
+                goto done;
+        }
+        else if (clixon_xml2cbuf(cbz, x0, 0, pretty, -1, 0) < 0)
+            goto done;
+        if (xmldb_zstd_write(f, cbuf_get(cbz), cbuf_len(cbz)) < 0)
+            goto done;
+#else
+        clicon_err(OE_DB, 0, "CLICON_XMLDB_COMPRESS set but clixon is built without --enable-zstd");
+        goto done;
+#endif
+    }
+    else if (strcmp(format,"json")==0){
+        if (clixon_json2file(f, x0, pretty, fprintf, 0, 0) < 0)
+            goto done;
+    }
+    else if (strcmp(format,"binary")==0){
+        if (clixon_xml2bin(f, x0, 0) < 0)
+            goto done;
+    }
+    else if (clixon_xml2file(f, x0, 0, pretty, fprintf, 0, 0) < 0)
+        goto done;
+    /* Remove modules state after writing to file
+     */
+    if (xmodst && xml_purge(xmodst) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (f != NULL)
+        fclose(f);
+    if (cbz)
+        cbuf_pool_put(cbz);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Return write-ahead journal filename of a database
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Database name
+ * @param[out] filep  Malloced journal filename, free after use
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xmldb_db2file  for the snapshot filename
+ */
+int
+xmldb_journal_file(clicon_handle h,
+                   const char   *db,
+                   char        **filep)
+{
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s_journal", dbfile);
+    if ((*filep = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Append one edit record to the write-ahead journal of a database
+ *
+ * The record wraps the modification tree x1 (as given to xmldb_put) in an
+ * <edit> element carrying the top-level operation and the namespace bindings
+ * in scope at x1, since embedded attributes such as nc:operation depend on
+ * prefixes that may be declared on ancestors of x1.
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Database name
+ * @param[in]  op       Top-level operation
+ * @param[in]  x1       Modification tree, see xmldb_put
+ * @param[in]  username User name of requestor, recorded for audit only
+ * @param[out] offp     Journal length before the record (for rollback), or NULL
+ * @param[out] szp      Journal length after the record, or NULL
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xmldb_journal_replay  for how records are applied on load
+ */
+int
+xmldb_journal_append(clicon_handle       h,
+                     const char         *db,
+                     enum operation_type op,
+                     cxobj              *x1,
+                     char               *username,
+                     size_t             *offp,
+                     size_t             *szp)
+{
+    int     retval = -1;
+    char   *jfile = NULL;
+    FILE   *f = NULL;
+    cvec   *nsc = NULL;
+    cg_var *cv;
+    char   *pf;
+    long    off;
+
+    if (xmldb_journal_file(h, db, &jfile) < 0)
+        goto done;
+    if ((f = fopen(jfile, "a")) == NULL){
+        clicon_err(OE_UNIX, errno, "open(%s)", jfile);
+        goto done;
+    }
+    if ((off = ftell(f)) < 0){
+        clicon_err(OE_UNIX, errno, "ftell");
+        goto done;
+    }
+    if (offp)
+        *offp = off;
+    if (xml_nsctx_node(x1, &nsc) < 0)
+        goto done;
+    fprintf(f, "<edit op=\"%s\"", xml_operation2str(op));
+    if (username)
+        fprintf(f, " user=\"%s\"", username);
+    cv = NULL;
+    while ((cv = cvec_each(nsc, cv)) != NULL){
+        if ((pf = cv_name_get(cv)) == NULL || strlen(pf) == 0)
+            fprintf(f, " xmlns=\"%s\"", cv_string_get(cv));
+        else
+            fprintf(f, " xmlns:%s=\"%s\"", pf, cv_string_get(cv));
+    }
+    fprintf(f, ">");
+    if (clixon_xml2file(f, x1, 0, 0, fprintf, 1, 0) < 0)
+        goto done;
+    fprintf(f, "</edit>\n");
+    if ((off = ftell(f)) < 0){
+        clicon_err(OE_UNIX, errno, "ftell");
+        goto done;
+    }
+    if (szp)
+        *szp = off;
+    retval = 0;
+ done:
+    if (f != NULL)
+        fclose(f);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Truncate or remove the write-ahead journal of a database
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name
+ * @param[in]  off  Truncate journal to this length, remove the file if 0
+ * @retval     0    OK (including no journal present)
+ * @retval    -1    Error
+ */
+int
+xmldb_journal_truncate(clicon_handle h,
+                       const char   *db,
+                       size_t        off)
+{
+    int   retval = -1;
+    char *jfile = NULL;
+
+    if (xmldb_journal_file(h, db, &jfile) < 0)
+        goto done;
+    if (off == 0){
+        if (unlink(jfile) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", jfile);
+            goto done;
+        }
+    }
+    else if (truncate(jfile, off) < 0){
+        clicon_err(OE_UNIX, errno, "truncate(%s)", jfile);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Replay journaled edits on top of a base tree read from the snapshot file
+ *
+ * The edits passed NACM when first applied, so they are replayed with permit
+ * set. Records that no longer apply (eg after a yang upgrade) are logged and
+ * skipped.
+ * @param[in]     h      Clicon handle
+ * @param[in]     db     Database name
+ * @param[in]     yspec  Top-level yang spec
+ * @param[in,out] x0     Base tree parsed from the snapshot, on the form <config>...
+ * @retval        0      OK (including no journal present)
+ * @retval       -1      Error
+ * @see xmldb_journal_append  for the record format
+ * @see xmldb_readfile        from where it is called
+ */
+int
+xmldb_journal_replay(clicon_handle h,
+                     const char   *db,
+                     yang_stmt    *yspec,
+                     cxobj        *x0)
+{
+    int                 retval = -1;
+    char               *jfile = NULL;
+    FILE               *fp = NULL;
+    cxobj              *xj = NULL;
+    cxobj              *xedit;
+    cxobj              *xa;
+    cbuf               *cbret = NULL;
+    enum operation_type op;
+    struct stat         st;
+    int                 ret;
+
+    if (xmldb_journal_file(h, db, &jfile) < 0)
+        goto done;
+    if (stat(jfile, &st) < 0){
+        if (errno == ENOENT)
+            goto ok;
+        clicon_err(OE_UNIX, errno, "stat(%s)", jfile);
+        goto done;
+    }
+    if (st.st_size == 0)
+        goto ok;
+    if ((fp = fopen(jfile, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "open(%s)", jfile);
+        goto done;
+    }
+    /* The journal is a sequence of <edit> records: parse them all under one top */
+    if (clixon_xml_parse_file(fp, YB_NONE, yspec, &xj, NULL) < 0)
+        goto done;
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    xedit = NULL;
+    while ((xedit = xml_child_each(xj, xedit, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xedit), "edit"))
+            continue;
+        op = OP_MERGE;
+        if ((xa = xml_find_type(xedit, NULL, "op", CX_ATTR)) != NULL &&
+            xml_operation(xml_value(xa), &op) < 0)
+            goto done;
+        if ((ret = xml_bind_yang(xedit, YB_MODULE, yspec, NULL)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_log(LOG_WARNING, "%s: %s: journal record does not bind to yang, skipped",
+                       __FUNCTION__, db);
+            continue;
+        }
+        cbuf_reset(cbret);
+        if ((ret = text_modify_top(h, x0, x0, xedit, xedit, yspec, op,
+                                   NULL, NULL, 1, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            clicon_log(LOG_WARNING, "%s: %s: journal record could not be applied, skipped: %s",
+                       __FUNCTION__, db, cbuf_get(cbret));
+    }
+    /* Same post-modify cleanup as xmldb_put */
+    if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) < 0)
+        goto done;
+    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                  (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
+        goto done;
+    if (xml_defaults_nopresence(x0, 2) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    if (xj)
+        xml_free(xj);
+    if (fp)
+        fclose(fp);
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/* Set if a deferred-flush timeout is registered in the event loop */
+static int _xmldb_flush_registered = 0;
+
+/*! Write out deferred datastore snapshots
+ *
+ * Acts as the durability barrier of the deferred write mode: after return,
+ * the snapshot files reflect the in-memory trees.
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name, or NULL for all databases with pending writes
+ * @retval     0    OK (including nothing pending)
+ * @retval    -1    Error
+ * @see CLICON_XMLDB_WRITE_DEFER
+ */
+int
+xmldb_flush(clicon_handle h,
+            const char   *db)
+{
+    int        retval = -1;
+    char     **keys = NULL;
+    size_t     klen;
+    int        i;
+    db_elmnt  *de;
+
+    if (db != NULL){
+        if ((de = clicon_db_elmnt_get(h, db)) != NULL &&
+            de->de_pending && de->de_xml){
+            if (xmldb_writefile(h, db, de->de_xml) < 0)
+                goto done;
+            de->de_pending = 0;
+        }
+    }
+    else{
+        if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+            goto done;
+        for (i = 0; i < klen; i++){
+            if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) == NULL)
+                continue;
+            if (de->de_pending == 0 || de->de_xml == NULL)
+                continue;
+            if (xmldb_writefile(h, keys[i], de->de_xml) < 0)
+                goto done;
+            de->de_pending = 0;
+        }
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Event loop timeout callback flushing all pending deferred writes
+ * @param[in]  fd   Dummy, see clixon_event_reg_timeout
+ * @param[in]  arg  Clicon handle
+ */
+static int
+xmldb_flush_timeout(int   fd,
+                    void *arg)
+{
+    clicon_handle h = (clicon_handle)arg;
+
+    _xmldb_flush_registered = 0;
+    return xmldb_flush(h, NULL);
+}
+
+/*! Mark a database write-pending and schedule a deferred snapshot flush
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name, must be cached
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xmldb_flush
+ */
+static int
+xmldb_flush_defer(clicon_handle h,
+                  const char   *db)
+{
+    int            retval = -1;
+    db_elmnt      *de;
+    struct timeval now;
+    struct timeval t;
+    struct timeval delay = {0, XMLDB_FLUSH_DELAY_MS*1000};
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+        clicon_err(OE_DB, 0, "%s not cached", db);
+        goto done;
+    }
+    de->de_pending = 1;
+    if (!_xmldb_flush_registered){
+        gettimeofday(&now, NULL);
+        timeradd(&now, &delay, &t);
+        if (clixon_event_reg_timeout(t, xmldb_flush_timeout, h,
+                                     "datastore deferred flush") < 0)
+            goto done;
+        _xmldb_flush_registered = 1;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Build api-path of an XML node including ancestors and list keys
+ * @param[in]     x   XML node in a bound datastore tree
+ * @param[in,out] cb  Initialized cligen buffer where path is appended
+ * @retval        0   OK
+ * @retval       -1   Error
+ * @see xml2api_path_1  for the single-level encoding
+ */
+static int
+xmldb_delta_path(cxobj *x,
+                 cbuf  *cb)
+{
+    int retval = -1;
+
+    if (x == NULL || xml_spec(x) == NULL) /* datastore root */
+        goto ok;
+    if (xmldb_delta_path(xml_parent(x), cb) < 0)
+        goto done;
+    if (xml2api_path_1(x, cb) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Append the diff of a commit as delta records to the write-ahead journal
  *
+ * Instead of rewriting the target snapshot wholesale at commit, persist the
+ * diff computed by xml_diff: one merge record carrying added and changed
+ * nodes (with ancestor and list-key scaffolding) and one record carrying
+ * remove operations for deleted nodes. The records are replayed on load like
+ * any journaled edit, see xmldb_journal_replay.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Target database, eg "running"
+ * @param[in]  dvec  Deleted nodes, pointers into the source tree
+ * @param[in]  dlen  Length of dvec
+ * @param[in]  avec  Added nodes, pointers into the target tree
+ * @param[in]  alen  Length of avec
+ * @param[in]  cvec  Changed nodes, target values
+ * @param[in]  clen  Length of cvec
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see candidate_commit  from where it is called
+ */
+int
+xmldb_journal_delta(clicon_handle h,
+                    const char   *db,
+                    cxobj       **dvec,
+                    int           dlen,
+                    cxobj       **avec,
+                    int           alen,
+                    cxobj       **cvec,
+                    int           clen)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *xd = NULL; /* remove record */
+    cxobj     *xm = NULL; /* merge record */
+    cxobj     *xbot;
+    cxobj     *xn;
+    cxobj     *x;
+    cbuf      *cb = NULL;
+    int        i;
+    int        ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (dlen > 0){
+        if ((xd = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_add_attr(xd, "nc", NETCONF_BASE_NAMESPACE, "xmlns", NULL) < 0)
+            goto done;
+        for (i=0; i<dlen; i++){
+            cbuf_reset(cb);
+            if (xmldb_delta_path(dvec[i], cb) < 0)
+                goto done;
+            xbot = NULL;
+            if ((ret = api_path2xml(cbuf_get(cb), yspec, xd, YC_DATANODE, 0,
+                                    &xbot, NULL, NULL)) < 0)
+                goto done;
+            if (ret == 0 || xbot == NULL){
+                clicon_err(OE_DB, 0, "Invalid delta path %s", cbuf_get(cb));
+                goto done;
+            }
+            if (xml_add_attr(xbot, "operation", "remove", "nc", NULL) < 0)
+                goto done;
+        }
+        if (xmldb_journal_append(h, db, OP_NONE, xd, NULL, NULL, NULL) < 0)
+            goto done;
+    }
+    if (alen + clen > 0){
+        if ((xm = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        for (i=0; i<alen+clen; i++){
+            x = i<alen ? avec[i] : cvec[i-alen];
+            cbuf_reset(cb);
+            if (xmldb_delta_path(xml_parent(x), cb) < 0)
+                goto done;
+            if (cbuf_len(cb) == 0) /* top-level node */
+                xbot = xm;
+            else{
+                xbot = NULL;
+                if ((ret = api_path2xml(cbuf_get(cb), yspec, xm, YC_DATANODE, 0,
+                                        &xbot, NULL, NULL)) < 0)
+                    goto done;
+                if (ret == 0 || xbot == NULL){
+                    clicon_err(OE_DB, 0, "Invalid delta path %s", cbuf_get(cb));
+                    goto done;
+                }
+            }
+            if ((xn = xml_dup(x)) == NULL)
+                goto done;
+            if (xml_addsub(xbot, xn) < 0){
+                xml_free(xn);
+                goto done;
+            }
+            /* The xmlns declaration may have sat on an ancestor of x */
+            if (xmlns_assign(xn) < 0)
+                goto done;
+        }
+        if (xmldb_journal_append(h, db, OP_MERGE, xm, NULL, NULL, NULL) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xd)
+        xml_free(xd);
+    if (xm)
+        xml_free(xm);
+    return retval;
+}
+
+/*! Compact the write-ahead journal of a database if it exceeds the threshold
+ *
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name
+ * @retval     0    OK (compacted or below threshold)
+ * @retval    -1    Error
+ * @see xmldb_journal_flush  which does the snapshot rewrite
+ */
+int
+xmldb_journal_compact(clicon_handle h,
+                      const char   *db)
+{
+    int         retval = -1;
+    char       *jfile = NULL;
+    struct stat st;
+
+    if (xmldb_journal_file(h, db, &jfile) < 0)
+        goto done;
+    if (stat(jfile, &st) < 0){
+        if (errno == ENOENT)
+            goto ok;
+        clicon_err(OE_UNIX, errno, "stat(%s)", jfile);
+        goto done;
+    }
+    if (st.st_size >= XMLDB_JOURNAL_MAXSIZE &&
+        xmldb_journal_flush(h, db) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Fold the write-ahead journal of a database into its snapshot file
+ *
+ * Rewrites the snapshot from the current tree (reading the snapshot and
+ * replaying the journal first if the database is not cached) and removes the
+ * journal. No-op if no journal exists.
+ * @param[in]  h    Clicon handle
+ * @param[in]  db   Database name
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xmldb_copy  from where it is called before the file copy
+ */
+int
+xmldb_journal_flush(clicon_handle h,
+                    const char   *db)
+{
+    int         retval = -1;
+    char       *jfile = NULL;
+    cxobj      *x0 = NULL;
+    cxobj      *xerr = NULL;
+    db_elmnt   *de;
+    yang_stmt  *yspec;
+    struct stat st;
+    int         freex0 = 0;
+    int         ret;
+
+    if (xmldb_journal_file(h, db, &jfile) < 0)
+        goto done;
+    if (stat(jfile, &st) < 0){
+        if (errno == ENOENT)
+            goto ok;
+        clicon_err(OE_UNIX, errno, "stat(%s)", jfile);
+        goto done;
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if (clicon_datastore_cache(h) != DATASTORE_NOCACHE &&
+        (de = clicon_db_elmnt_get(h, db)) != NULL)
+        x0 = de->de_xml;
+    if (x0 == NULL){
+        /* Reading replays the journal, see xmldb_readfile */
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, NULL, NULL, &x0, NULL, NULL, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_DB, 0, "Yang binding of %s failed when flushing journal", db);
+            goto done;
+        }
+        freex0 = 1;
+    }
+    if (xmldb_writefile(h, db, x0) < 0)
+        goto done;
+    if (xmldb_journal_truncate(h, db, 0) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (freex0 && x0)
+        xml_free(x0);
+    if (xerr)
+        xml_free(xerr);
+    if (jfile)
+        free(jfile);
+    return retval;
+}
+
+/*! Record the paths an edit tree touches into the touched-path log of db
+ *
+ * Walks the edit tree: a node with an explicit subtree operation (create,
+ * replace, delete, remove) or a node without element children is one touched
+ * point covering its subtree, otherwise the children are descended. Must run
+ * before the edit is applied since text_modify consumes the operation
+ * attributes. Recording a path whose edit then fails to apply is harmless:
+ * equal subtrees contribute nothing to the diff. If a node is not yang bound,
+ * or a key value cannot be represented as an xpath literal, its path
+ * predicates cannot be built and the log is invalidated, falling back to the
+ * full tree diff.
+ * @param[in]  h      CLICON handle
+ * @param[in]  db     Database name
+ * @param[in]  x1     Edit tree node whose children are walked
+ * @param[in]  op     Operation inherited from the parent
+ * @param[in]  depth  Depth of the children of x1
+ * @retval     0      OK (including log invalidated)
+ * @retval    -1      Error
+ * @see xml_diff_paths  where the log restricts the commit diff
+ */
+static int
+put_touched_record(clicon_handle       h,
+                   const char         *db,
+                   cxobj              *x1,
+                   enum operation_type op,
+                   int                 depth)
+{
+    int    retval = -1;
+    cxobj *xc = NULL;
+    cxobj *xa;
+    char  *opstr;
+    char  *xpath = NULL;
+    int    subtree;
+    int    ret;
+
+    while ((xc = xml_child_each(x1, xc, CX_ELMNT)) != NULL){
+        subtree = (op != OP_MERGE && op != OP_NONE);
+        if ((xa = xml_find_type(xc, NULL, "operation", CX_ATTR)) != NULL &&
+            (opstr = xml_value(xa)) != NULL)
+            subtree = (strcmp(opstr, "merge") != 0 && strcmp(opstr, "none") != 0);
+        /* Without yang binding list-key predicates cannot be built, and a
+         * native prefix would not resolve against the datastore trees where
+         * the path is later looked up: fall back to the full tree diff
+         */
+        if (xml_spec(xc) == NULL || xml_prefix(xc) != NULL){
+            if (xmldb_touched_invalidate(h, db) < 0)
+                goto done;
+            break;
+        }
+        if (subtree || xml_child_nr_type(xc, CX_ELMNT) == 0){
+            if ((ret = xml2xpath(xc, NULL, &xpath)) < 0)
+                goto done;
+            if (ret == 0){ /* Key value has no xpath representation */
+                if (xmldb_touched_invalidate(h, db) < 0)
+                    goto done;
+                break;
+            }
+            if (xmldb_touched_add(h, db, xpath, depth) < 0)
+                goto done;
+            free(xpath);
+            xpath = NULL;
+            if (xmldb_touched_get(h, db) == NULL) /* Overflowed */
+                break;
+            continue;
+        }
+        /* Effective operation here is merge/none: an explicit attribute
+         * overrides the inherited op for the subtree
+         */
+        if (put_touched_record(h, db, xc, OP_MERGE, depth+1) < 0)
+            goto done;
+        if (xmldb_touched_get(h, db) == NULL)
+            break;
+    }
+    retval = 0;
+ done:
+    if (xpath)
+        free(xpath);
+    return retval;
+}
+
+/*! Modify database given a vector of xml trees and operations
+ *
+ * Batch variant of xmldb_put: the edits are applied in order against the
+ * in-memory tree in one pass and the result is serialized to file once,
+ * instead of the full read-merge-serialize cycle per edit. Edits are applied
+ * in order; on the first failing edit, later edits are not applied but
+ * earlier ones remain, as if issued as separate xmldb_put calls.
  * @param[in]  h      CLICON handle
  * @param[in]  db     running or candidate
- * @param[in]  op     Top-level operation, can be superceded by other op in tree
- * @param[in]  x1     xml-tree. Top-level symbol is dummy
+ * @param[in]  ops    Vector of top-level operations, one per edit
+ * @param[in]  x1vec  Vector of xml-trees. Top-level symbols are dummy
+ * @param[in]  x1len  Length of ops and x1vec
  * @param[in]  username User name for nacm
  * @param[out] cbret  Initialized cligen buffer. On exit contains XML if retval == 0
  * @retval     1      OK
- * @retval     0      Failed, cbret contains error xml message
+ * @retval     0      One edit failed, cbret contains error xml message
  * @retval     -1     Error
- * The xml may contain the "operation" attribute which defines the operation.
- * @code
- *   cxobj     *xt;
- *   cxobj     *xret = NULL;
- *   if (clixon_xml_parse_string("<a>17</a>", YB_NONE, NULL, &xt, NULL) < 0)
- *     err;
- *   if ((ret = xmldb_put(h, "running", OP_MERGE, xt, username, cbret)) < 0)
- *     err;
- *   if (ret==0)
- *     cbret contains netconf error message
- * @endcode
- * @note if xret is non-null, it may contain error message
+ * @see xmldb_put  for the single-edit API and an example
  */
 int
-xmldb_put(clicon_handle       h,
-          const char         *db, 
-          enum operation_type op,
-          cxobj              *x1,
-          char               *username,
-          cbuf               *cbret)
+xmldb_put_vec(clicon_handle        h,
+              const char          *db,
+              enum operation_type *ops,
+              cxobj              **x1vec,
+              size_t               x1len,
+              char                *username,
+              cbuf                *cbret)
 {
     int         retval = -1;
-    char       *dbfile = NULL;
-    FILE       *f = NULL;
     cbuf       *cb = NULL;
     yang_stmt  *yspec;
     cxobj      *x0 = NULL;
+    cxobj      *x1;
     db_elmnt   *de = NULL;
     int         ret;
     cxobj      *xnacm = NULL;
-    cxobj      *xmodst = NULL;
-    cxobj      *x;
     int         permit = 0; /* nacm permit all */
-    char       *format;
     cvec       *nsc = NULL; /* nacm namespace context */
     int         firsttime = 0;
-    int         pretty;
     cxobj      *xerr = NULL;
+    int         defer_sort = 0;
+    uint64_t    x1nr;
+    size_t      i;
+    int         applied = 0;
+    int         failed = 0;
+    int         journal = 0;
+    size_t      joff = 0;
+    size_t      jsz = 0;
 
+    CLIXON_PROBE2(xmldb_put, db, x1len);
+    clixon_trace_stage("xmldb-put");
     if (cbret == NULL){
         clicon_err(OE_XML, EINVAL, "cbret is NULL");
         goto done;
@@ -1188,11 +1984,27 @@ xmldb_put(clicon_handle       h,
         clicon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
-    if (x1 && strcmp(xml_name(x1), NETCONF_INPUT_CONFIG) != 0){
-        clicon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"%s\"",
-                   xml_name(x1), NETCONF_INPUT_CONFIG);
-        goto done;
+    for (i = 0; i < x1len; i++)
+        if (x1vec[i] && strcmp(xml_name(x1vec[i]), NETCONF_INPUT_CONFIG) != 0){
+            clicon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"%s\"",
+                       xml_name(x1vec[i]), NETCONF_INPUT_CONFIG);
+            goto done;
+        }
+    /* Copy-on-write: a write breaks cache sharing in both directions, see
+     * xmldb_copy_cache. Both are no-ops unless db is or has an overlay
+     */
+    if (clicon_datastore_cache(h) == DATASTORE_CACHE_COW){
+        if (xmldb_cow_materialize(h, db) < 0)
+            goto done;
+        if (xmldb_cow_break(h, db) < 0)
+            goto done;
     }
+    xmldb_cache_touch(h, db); /* For idle eviction, see xmldb_cache_prune */
+    /* Touched-path logs are relative to running: a direct write to running
+     * makes them all stale, see xmldb_touched_get
+     */
+    if (strcmp(db, "running") == 0 && xmldb_touched_invalidate_all(h) < 0)
+        goto done;
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
         if (clicon_datastore_cache(h) != DATASTORE_NOCACHE)
             x0 = de->de_xml; /* XXX flag is not XML_FLAG_TOP */
@@ -1201,7 +2013,7 @@ xmldb_put(clicon_handle       h,
     if (x0 == NULL){
         firsttime++; /* to avoid leakage on error, see fail from text_modify */
         /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &x0, de, NULL, &xerr)) < 0)
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, NULL, NULL, &x0, de, NULL, &xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -1222,16 +2034,72 @@ xmldb_put(clicon_handle       h,
     xnacm = clicon_nacm_cache(h);
     permit = (xnacm==NULL);
 
-    /* Here assume if xnacm is set and !permit do NACM */
-    clicon_data_del(h, "objectexisted");
-    /* 
-     * Modify base tree x with modification x1. This is where the
-     * new tree is made.
-     */
-    if ((ret = text_modify_top(h, x0, x0, x1, x1, yspec, op, username, xnacm, permit, cbret)) < 0)
-        goto done;
-    /* If xml return - ie netconf error xml tree, then stop and return OK */
-    if (ret == 0){
+    for (i = 0; i < x1len; i++){
+        x1 = x1vec[i];
+        /* Here assume if xnacm is set and !permit do NACM */
+        clicon_data_del(h, "objectexisted");
+        /* Write-ahead journal: record the edit before applying it so that the
+         * snapshot rewrite below can be deferred, see xmldb_journal_replay
+         */
+        if (x1 && clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")){
+            if (xmldb_journal_append(h, db, ops[i], x1, username, &joff, &jsz) < 0)
+                goto done;
+            journal = 1;
+        }
+        /* Record the paths this edit touches for the commit diff, see
+         * xml_diff_paths. Must be before the apply which consumes the
+         * operation attributes
+         */
+        if (x1 && xmldb_touched_get(h, db) != NULL){
+            if ((ops[i] == OP_REPLACE || ops[i] == OP_DELETE || ops[i] == OP_REMOVE) &&
+                xml_child_nr_type(x1, CX_ELMNT) == 0){
+                /* Whole-db operation with unknown scope */
+                if (xmldb_touched_invalidate(h, db) < 0)
+                    goto done;
+            }
+            else if (put_touched_record(h, db, x1, ops[i], 1) < 0)
+                goto done;
+        }
+        /* Bulk edit: append children unsorted during the merge and restore
+         * sort order with a single pass afterwards, see xml_sort_defer_begin.
+         * The window is scoped to one edit: a later edit matches against the
+         * base with sorted binary search (see xml_search_yang), which must
+         * not see entries a previous edit appended unsorted
+         */
+        if (x1){
+            x1nr = 0;
+            xml_stats(x1, &x1nr, NULL);
+            if (x1nr >= XMLDB_PUT_DEFER_SORT_NR){
+                xml_sort_defer_begin();
+                defer_sort = 1;
+            }
+        }
+        /*
+         * Modify base tree x with modification x1. This is where the
+         * new tree is made.
+         */
+        ret = text_modify_top(h, x0, x0, x1, x1, yspec, ops[i], username, xnacm, permit, cbret);
+        if (defer_sort){
+            defer_sort = 0;
+            if (xml_sort_defer_end(x0) < 0)
+                goto done;
+        }
+        if (ret < 0)
+            goto done;
+        /* If xml return - ie netconf error xml tree, then stop: later edits
+         * are not applied but the earlier ones remain
+         */
+        if (ret == 0){
+            /* The journaled record was not applied: roll back that record only */
+            if (journal && xmldb_journal_truncate(h, db, joff) < 0)
+                goto done;
+            jsz = joff;
+            failed = 1;
+            break;
+        }
+        applied++;
+    }
+    if (failed && applied == 0){
         /* If first time and quit here, x0 is not written back into cache and leaks */
         if (firsttime && x0){
             xml_free(x0);
@@ -1264,50 +2132,36 @@ xmldb_put(clicon_handle       h,
         de0.de_empty = (xml_child_nr(de0.de_xml) == 0);
         clicon_db_elmnt_set(h, db, &de0);
     }
-    if (xmldb_db2file(h, db, &dbfile) < 0)
-        goto done;
-    if (dbfile==NULL){
-        clicon_err(OE_XML, 0, "dbfile NULL");
-        goto done;
-    }
-    /* Add module revision info before writing to file)
-     * Only if CLICON_XMLDB_MODSTATE is set
+    /* Defer the snapshot rewrite while the journal is below threshold: the
+     * edit is durable in the journal and folded in on flush or replay
      */
-    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
-        if ((xmodst = xml_dup(x)) == NULL)
+    if (journal && jsz < XMLDB_JOURNAL_MAXSIZE)
+        ;
+    else if (!journal &&
+             clicon_datastore_cache(h) != DATASTORE_NOCACHE &&
+             clicon_option_bool(h, "CLICON_XMLDB_WRITE_DEFER")){
+        /* Defer the snapshot write to the event loop, see xmldb_flush */
+        if (xmldb_flush_defer(h, db) < 0)
             goto done;
-        if (xml_addsub(x0, xmodst) < 0)
-            goto done;
-    }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
-        goto done;
     }
-    if ((f = fopen(dbfile, "w")) == NULL){
-        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
-        goto done;
-    } 
-    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    if (strcmp(format,"json")==0){
-        if (clixon_json2file(f, x0, pretty, fprintf, 0, 0) < 0)
+    else{
+        if (xmldb_writefile(h, db, x0) < 0)
+            goto done;
+        if (journal && xmldb_journal_truncate(h, db, 0) < 0)
             goto done;
     }
-    else if (clixon_xml2file(f, x0, 0, pretty, fprintf, 0, 0) < 0)
-        goto done;
-    /* Remove modules state after writing to file
-     */
-    if (xmodst && xml_purge(xmodst) < 0)
-        goto done;
+    xmldb_generation_incr(db);
+    /* A later edit failed but earlier ones were applied and persisted above */
+    if (failed)
+        goto fail;
     retval = 1;
  done:
-    if (f != NULL)
-        fclose(f);
+    if (defer_sort)
+        xml_sort_defer_end(NULL);
     if (xerr)
         xml_free(xerr);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (dbfile)
-        free(dbfile);
     if (cb)
         cbuf_free(cb);
     if (x0 && clicon_datastore_cache(h) == DATASTORE_NOCACHE)
@@ -1318,6 +2172,42 @@ xmldb_put(clicon_handle       h,
     goto done;
 }
 
+/*! Modify database given an xml tree and an operation
+ *
+ * @param[in]  h      CLICON handle
+ * @param[in]  db     running or candidate
+ * @param[in]  op     Top-level operation, can be superceded by other op in tree
+ * @param[in]  x1     xml-tree. Top-level symbol is dummy
+ * @param[in]  username User name for nacm
+ * @param[out] cbret  Initialized cligen buffer. On exit contains XML if retval == 0
+ * @retval     1      OK
+ * @retval     0      Failed, cbret contains error xml message
+ * @retval     -1     Error
+ * The xml may contain the "operation" attribute which defines the operation.
+ * @code
+ *   cxobj     *xt;
+ *   cxobj     *xret = NULL;
+ *   if (clixon_xml_parse_string("<a>17</a>", YB_NONE, NULL, &xt, NULL) < 0)
+ *     err;
+ *   if ((ret = xmldb_put(h, "running", OP_MERGE, xt, username, cbret)) < 0)
+ *     err;
+ *   if (ret==0)
+ *     cbret contains netconf error message
+ * @endcode
+ * @note if xret is non-null, it may contain error message
+ * @see xmldb_put_vec  for applying several edits in one pass
+ */
+int
+xmldb_put(clicon_handle       h,
+          const char         *db,
+          enum operation_type op,
+          cxobj              *x1,
+          char               *username,
+          cbuf               *cbret)
+{
+    return xmldb_put_vec(h, db, &op, &x1, 1, username, cbret);
+}
+
 /* Dump a datastore to file including modstate
  */
 int
@@ -1341,7 +2231,7 @@ xmldb_dump(clicon_handle   h,
         if (xml_child_insert_pos(xt, xmodst, 0) < 0)
             goto done;
     }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+    if ((format = clicon_option_str_cached(h, "CLICON_XMLDB_FORMAT", &_format_opt)) == NULL){
         clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
         goto done;
     }
@@ -1350,6 +2240,10 @@ xmldb_dump(clicon_handle   h,
         if (clixon_json2file(f, xt, pretty, fprintf, 0, 0) < 0)
             goto done;
     }
+    else if (strcmp(format,"binary")==0){
+        if (clixon_xml2bin(f, xt, 0) < 0)
+            goto done;
+    }
     else if (clixon_xml2file(f, xt, 0, pretty, fprintf, 0, 0) < 0)
         goto done;
     retval = 0;
@@ -46,5 +46,14 @@
  * Prototypes
  */
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret);
+int xmldb_put_vec(clicon_handle h, const char *db, enum operation_type *ops, cxobj **x1vec, size_t x1len, char *username, cbuf *cbret);
+int xmldb_journal_file(clicon_handle h, const char *db, char **filep);
+int xmldb_journal_append(clicon_handle h, const char *db, enum operation_type op, cxobj *x1, char *username, size_t *offp, size_t *szp);
+int xmldb_journal_truncate(clicon_handle h, const char *db, size_t off);
+int xmldb_journal_replay(clicon_handle h, const char *db, yang_stmt *yspec, cxobj *x0);
+int xmldb_journal_flush(clicon_handle h, const char *db);
+int xmldb_journal_delta(clicon_handle h, const char *db, cxobj **dvec, int dlen, cxobj **avec, int alen, cxobj **cvec, int clen);
+int xmldb_journal_compact(clicon_handle h, const char *db);
+int xmldb_flush(clicon_handle h, const char *db);
 
 #endif /* _CLIXON_DATASTORE_WRITE_H */
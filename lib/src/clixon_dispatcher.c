@@ -180,8 +180,21 @@ split_path_free(char **list,
     free(list);
 }
 
+/*! qsort/bsearch comparison on node_name for the sorted peer index
+ */
+static int
+peer_vec_cmp(const void *a, const void *b)
+{
+    dispatcher_entry_t *ea = *(dispatcher_entry_t **)a;
+    dispatcher_entry_t *eb = *(dispatcher_entry_t **)b;
+
+    return strcmp(ea->node_name, eb->node_name);
+}
+
 /*! Find a peer of this node by name
- * search through the list pointed at by peer
+ * binary search over a sorted index of the peer list; the index is built
+ * lazily on first lookup and invalidated by add_peer_node(), so the cost
+ * of keeping it sorted is paid at registration time, not per dispatch
  *
  * @param[in] node       Pointer to a node in the peer list
  * @param[in] node_name  Name of node we're looking for
@@ -192,22 +205,47 @@ static dispatcher_entry_t *
 find_peer(dispatcher_entry_t *node, char *node_name)
 {
     dispatcher_entry_t *i;
-    
+    dispatcher_entry_t *head;
+    dispatcher_entry_t **match;
+    dispatcher_entry_t key_entry;
+    dispatcher_entry_t *key = &key_entry;
+
     if ((node == NULL) || (node_name == NULL)) {
         /*  protect against idiot users */
         return NULL;
     }
 
-    i = node->peer_head;
+    head = node->peer_head;
 
-    while (i != NULL) {
-        if (strcmp(node_name, i->node_name) == 0) {
-            break;
+    if (head->peer_vec == NULL) {
+        /* (re)build the sorted index over this peer list */
+        size_t len = 0;
+
+        for (i = head; i != NULL; i = i->peer) {
+            len++;
         }
-        i = i->peer;
+        if ((head->peer_vec = malloc(len * sizeof(dispatcher_entry_t *))) == NULL) {
+            /* no index, fall back to a linear scan */
+            for (i = head; i != NULL; i = i->peer) {
+                if (strcmp(node_name, i->node_name) == 0) {
+                    break;
+                }
+            }
+            return i;
+        }
+        len = 0;
+        for (i = head; i != NULL; i = i->peer) {
+            head->peer_vec[len++] = i;
+        }
+        head->peer_vec_len = len;
+        qsort(head->peer_vec, len, sizeof(dispatcher_entry_t *), peer_vec_cmp);
     }
 
-    return i;
+    key_entry.node_name = node_name;
+    match = bsearch(&key, head->peer_vec, head->peer_vec_len,
+                    sizeof(dispatcher_entry_t *), peer_vec_cmp);
+
+    return match ? *match : NULL;
 }
 
 /*! Add a node as the last node in peer list
@@ -261,6 +299,13 @@ add_peer_node(dispatcher_entry_t *node,
 
         eptr->peer = new_node;
 
+        /* the sorted index over this list, if any, is now stale */
+        if (node->peer_head->peer_vec != NULL) {
+            free(node->peer_head->peer_vec);
+            node->peer_head->peer_vec = NULL;
+            node->peer_head->peer_vec_len = 0;
+        }
+
         return new_node;
     }
 }
@@ -290,54 +335,86 @@ add_child_node(dispatcher_entry_t *node,
     return child_ptr;
 }
 
-/**
+/*! Precompute the most specific handler for every node in a (sub)tree
  *
- * @param root
- * @param path
- * @retval
- * @retval NULL Error
+ * A node's "best" entry is the node itself if a handler is registered
+ * on it, otherwise the closest ancestor with one (falling back to the
+ * tree root). Deriving this at registration time means a dispatch only
+ * has to walk down to the deepest matching node and read its best
+ * pointer, instead of re-checking every node's handler on the way down.
+ *
+ * @param[in] head    Head of a peer list
+ * @param[in] inherit Best entry of the parent (tree root at top level)
+ */
+static void
+compile_best(dispatcher_entry_t *head,
+             dispatcher_entry_t *inherit)
+{
+    dispatcher_entry_t *i;
+
+    for (i = head; i != NULL; i = i->peer) {
+        i->best = i->handler ? i : inherit;
+        if (i->children != NULL) {
+            compile_best(i->children, i->best);
+        }
+    }
+}
+
+/*! Find the entry with the most specific handler for a path
+ *
+ * Walks the tree over the path elements (keys stripped) and returns the
+ * precomputed best entry of the deepest matching node; if the path runs
+ * past the tree, the best entry of the last match is used. The path is
+ * copied once and tokenized in place, so a dispatch does not pay the
+ * per-element allocations of split_path().
+ *
+ * @param[in] root Dispatch tree
+ * @param[in] path Path string
+ * @retval    ptr  Entry whose handler (and subtree) should be called
+ * @retval    NULL Error
  */
 static dispatcher_entry_t *
 get_entry(dispatcher_entry_t *root,
           char               *path)
 {
-    char              **split_path_list = NULL;
-    size_t              split_path_len = 0;
-    dispatcher_entry_t *ptr = root;
-    dispatcher_entry_t *best = root;
-
-    /* cut the path up into individual elements */
-    if (split_path(path, &split_path_list, &split_path_len) < 0)
+    char               *work;
+    char               *ptr;
+    char               *seg;
+    char               *kptr;
+    dispatcher_entry_t *de = root;
+    dispatcher_entry_t *last = root;
+
+    if (root->best == NULL) {
+        /* a registration has been made since the last dispatch */
+        compile_best(root->peer_head, root);
+    }
+    if ((work = strdup(path)) == NULL)
         return NULL;
-
-    /* some elements may have keys defined, strip them off */
-    for (int i = 0; i < split_path_len; i++) {
-        char *kptr = split_path_list[i];
-        strsep(&kptr, "=[]");
+    ptr = work;
+    if (*ptr == '/') {
+        /* a leading / is an element of its own, cf split_path() */
+        if ((de = find_peer(de, "/")) == NULL)
+            goto out;
+        last = de;
+        de = de->children;
+        ptr++;
     }
-
-    /* search down the tree */
-    for (int i = 0; i < split_path_len; i++) {
-
-        char *query = split_path_list[i];
-        if ((ptr = find_peer(ptr, query)) == NULL) {
-            split_path_free(split_path_list, split_path_len);
-            /* we ran out of matches, use last found handler */
-            return best;
-        }
-        if (ptr->handler != NULL) {
-            /* if handler is defined, save it */
-            best = ptr;
+    while ((seg = strsep(&ptr, "/")) != NULL) {
+        if (*seg == '\0')
+            continue;
+        /* the element may have a key defined, strip it off */
+        kptr = seg;
+        strsep(&kptr, "=[]");
+        if ((de = find_peer(de, seg)) == NULL) {
+            /* we ran out of matches, use last found entry */
+            break;
         }
-
-        /* skip to next element */
-        ptr = ptr->children;
+        last = de;
+        de = de->children;
     }
-
-    /* clean up */
-    split_path_free(split_path_list, split_path_len);
-    
-    return best;
+ out:
+    free(work);
+    return last->best;
 }
 
 /**
@@ -420,6 +497,9 @@ dispatcher_register_handler(dispatcher_entry_t   **root,
     ptr->handler = x->dd_handler;
     ptr->arg = x->dd_arg;
 
+    /* the precomputed best entries, if any, are now stale */
+    (*root)->best = NULL;
+
     /* clean up */
     split_path_free(split_path_list, split_path_len);
 
@@ -462,6 +542,66 @@ dispatcher_call_handlers(dispatcher_entry_t *root,
     return ret;
 }
 
+/*! Resolve many paths and call each distinct set of handlers once
+ *
+ * Batch variant of dispatcher_call_handlers(): all paths are resolved
+ * first and paths that land on the same entry are called only once,
+ * which a caller merging state for many paths would otherwise do
+ * itself. Handlers may still be called more than once when one resolved
+ * entry lies within the subtree of another; the handler contract above
+ * allows duplicated work.
+ *
+ * @param[in]  handle
+ * @param[in]  root
+ * @param[in]  paths   Paths on the form: /a/b (no keys)
+ * @param[in]  npaths  Number of paths
+ * @retval     1       OK
+ * @retval    -1       Error
+ */
+int
+dispatcher_call_handlers_vec(dispatcher_entry_t *root,
+                             void               *handle,
+                             char              **paths,
+                             size_t              npaths,
+                             void               *user_args)
+{
+    int                  retval = -1;
+    dispatcher_entry_t **best = NULL;
+    size_t               i;
+    size_t               j;
+
+    if (npaths == 0)
+        return 1;
+    if ((best = malloc(npaths * sizeof(dispatcher_entry_t *))) == NULL)
+        return -1;
+    for (i = 0; i < npaths; i++) {
+        if ((best[i] = get_entry(root, paths[i])) == NULL) {
+            errno = ENOENT;
+            goto done;
+        }
+    }
+    for (i = 0; i < npaths; i++) {
+        /* skip entries already called for an earlier path */
+        for (j = 0; j < i; j++) {
+            if (best[j] == best[i])
+                break;
+        }
+        if (j < i)
+            continue;
+        if (best[i]->children != NULL) {
+            call_handler_helper(best[i]->children, handle, paths[i], user_args);
+        }
+        if (best[i]->handler != NULL) {
+            if ((*best[i]->handler)(handle, paths[i], user_args, best[i]->arg) < 0)
+                goto done;
+        }
+    }
+    retval = 1;
+ done:
+    free(best);
+    return retval;
+}
+
 /*! Free a dispatcher tree
  */
 int
@@ -475,6 +615,8 @@ dispatcher_free(dispatcher_entry_t *root)
         dispatcher_free(root->peer);
     if (root->node_name)
         free(root->node_name);
+    if (root->peer_vec)
+        free(root->peer_vec);
     free(root);
     return 0;
 }
@@ -35,6 +35,10 @@
 
  *
  * Event handling and loop
+ * The fd wait/dispatch mechanism is epoll on Linux and kqueue on BSD (checked
+ * at configure time), with select as portable fallback. The kernel event
+ * instance gives O(1) dispatch and no FD_SETSIZE ceiling; the registration
+ * API (clixon_event_reg_fd et al) is the same for all three.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -50,8 +54,14 @@
 #include <string.h>
 #include <signal.h>
 #include <syslog.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#elif defined(HAVE_SYS_EVENT_H)
+#include <sys/event.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -69,6 +79,18 @@
  */
 #define EVENT_STRLEN 32
 
+/* Max kernel events fetched per epoll_wait/kevent wakeup */
+#define EVENT_NEVENTS 64
+
+/* Name of the wait primitive, for logs and error messages */
+#ifdef HAVE_SYS_EPOLL_H
+#define EVENT_WAIT_NAME "epoll_wait"
+#elif defined(HAVE_SYS_EVENT_H)
+#define EVENT_WAIT_NAME "kevent"
+#else
+#define EVENT_WAIT_NAME "select"
+#endif
+
 /*
  * Types
  */
@@ -77,7 +99,9 @@ struct event_data{
     int (*e_fn)(int, void*);            /* function */
     enum {EVENT_FD, EVENT_TIME} e_type;        /* type of event */
     int e_fd;                      /* File descriptor */
+    int e_write;                   /* 0: read-readiness, 1: write-readiness */
     struct timeval e_time;         /* Timeout */
+    uint64_t e_seq;                /* Registration order, tiebreak for equal timeouts */
     void *e_arg;                   /* function argument */
     char e_string[EVENT_STRLEN];             /* string for debugging */
 };
@@ -87,11 +111,272 @@ struct event_data{
  * XXX consider use handle variables instead of global
  */
 static struct event_data *ee = NULL;
-static struct event_data *ee_timers = NULL;
+
+/* Timers: binary min-heap ordered by (e_time, e_seq), see tt_push/tt_pop.
+ * Registration and expiry are O(log n); the sorted-list predecessor made
+ * registration O(n) which turns quadratic with thousands of live timers */
+static struct event_data **_tt_heap = NULL;
+static int                 _tt_len = 0;
+static int                 _tt_size = 0;
+static uint64_t            _tt_seq = 0;
 
 /* Set if element in ee is deleted (clixon_event_unreg_fd). Check in ee loops */
 static int _ee_unreg = 0;
 
+/* Self-pipe waking the event loop on signal flags, see ee_sigpipe_wake.
+ * The signal flag setters write one byte; the read end is part of the waited
+ * fd set, so a signal arriving between the top-of-loop flag checks and the
+ * blocking wait makes the wait return immediately instead of relying on the
+ * wait being EINTR-interrupted (which is racy and backend-dependent)
+ */
+static int _ee_sigpipe[2] = {-1, -1};
+
+/*! Create the signal self-pipe, nonblocking and close-on-exec
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+ee_sigpipe_init(void)
+{
+    int i;
+
+    if (_ee_sigpipe[0] != -1)
+        return 0;
+    if (pipe(_ee_sigpipe) < 0){
+        clicon_err(OE_EVENTS, errno, "pipe");
+        return -1;
+    }
+    for (i = 0; i < 2; i++){
+        fcntl(_ee_sigpipe[i], F_SETFL, O_NONBLOCK);
+        fcntl(_ee_sigpipe[i], F_SETFD, FD_CLOEXEC);
+    }
+    return 0;
+}
+
+/*! Wake the event loop, async-signal-safe
+ * Called from the signal flag setters which in turn are called from signal
+ * handlers. A full pipe means a wakeup is already pending: nothing to do.
+ */
+static void
+ee_sigpipe_wake(void)
+{
+    char c = 0;
+
+    if (_ee_sigpipe[1] != -1 &&
+        write(_ee_sigpipe[1], &c, 1) < 0)
+        ; /* EAGAIN: wakeup already pending */
+}
+
+/*! Drain pending wakeup bytes so the pipe does not stay readable */
+static void
+ee_sigpipe_drain(void)
+{
+    char buf[64];
+
+    while (read(_ee_sigpipe[0], buf, sizeof(buf)) > 0)
+        ;
+}
+
+#if defined(HAVE_SYS_EPOLL_H) || defined(HAVE_SYS_EVENT_H)
+/* Kernel event instance (epoll/kqueue fd), created lazily, see ee_poll_init */
+static int _ee_pollfd = -1;
+
+/*! Lazily create the kernel event instance (epoll / kqueue)
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+ee_poll_init(void)
+{
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event ev = {0,};
+#else
+    struct kevent      ev;
+#endif
+
+    if (_ee_pollfd != -1)
+        return 0;
+    if (ee_sigpipe_init() < 0)
+        return -1;
+#ifdef HAVE_SYS_EPOLL_H
+    if ((_ee_pollfd = epoll_create1(0)) < 0){
+        clicon_err(OE_EVENTS, errno, "epoll_create1");
+        return -1;
+    }
+    /* Signal self-pipe is part of the interest set, see ee_sigpipe_wake */
+    ev.events = EPOLLIN;
+    ev.data.fd = _ee_sigpipe[0];
+    if (epoll_ctl(_ee_pollfd, EPOLL_CTL_ADD, _ee_sigpipe[0], &ev) < 0){
+        clicon_err(OE_EVENTS, errno, "epoll_ctl");
+        return -1;
+    }
+#else
+    if ((_ee_pollfd = kqueue()) < 0){
+        clicon_err(OE_EVENTS, errno, "kqueue");
+        return -1;
+    }
+    EV_SET(&ev, _ee_sigpipe[0], EVFILT_READ, EV_ADD, 0, 0, NULL);
+    if (kevent(_ee_pollfd, &ev, 1, NULL, 0, NULL) < 0){
+        clicon_err(OE_EVENTS, errno, "kevent");
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+/*! Update the kernel event registration of fd to match the callback list
+ * The interest set is recomputed from the registered callbacks so that
+ * several read and/or write registrations on the same fd coexist.
+ * @param[in]  fd   File descriptor
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+ee_poll_update(int fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event ev = {0,};
+#else
+    struct kevent      ev;
+#endif
+    struct event_data *e;
+    int                rd = 0;
+    int                wr = 0;
+
+    for (e = ee; e; e = e->e_next)
+        if (e->e_type == EVENT_FD && e->e_fd == fd){
+            if (e->e_write)
+                wr = 1;
+            else
+                rd = 1;
+        }
+#ifdef HAVE_SYS_EPOLL_H
+    ev.events = (rd?EPOLLIN:0) | (wr?EPOLLOUT:0);
+    ev.data.fd = fd;
+    if (rd || wr){
+        if (epoll_ctl(_ee_pollfd, EPOLL_CTL_MOD, fd, &ev) == 0)
+            return 0;
+        if (errno == ENOENT &&
+            epoll_ctl(_ee_pollfd, EPOLL_CTL_ADD, fd, &ev) == 0)
+            return 0;
+    }
+    else{
+        if (epoll_ctl(_ee_pollfd, EPOLL_CTL_DEL, fd, &ev) == 0)
+            return 0;
+        if (errno == ENOENT || errno == EBADF)
+            return 0; /* fd closed by callback: kernel already dropped it */
+    }
+    clicon_err(OE_EVENTS, errno, "epoll_ctl");
+    return -1;
+#else
+    EV_SET(&ev, fd, EVFILT_READ, rd?EV_ADD:EV_DELETE, 0, 0, NULL);
+    if (kevent(_ee_pollfd, &ev, 1, NULL, 0, NULL) < 0 &&
+        !(rd && errno == EEXIST) &&
+        !(!rd && (errno == ENOENT || errno == EBADF))){
+        clicon_err(OE_EVENTS, errno, "kevent");
+        return -1;
+    }
+    EV_SET(&ev, fd, EVFILT_WRITE, wr?EV_ADD:EV_DELETE, 0, 0, NULL);
+    if (kevent(_ee_pollfd, &ev, 1, NULL, 0, NULL) < 0 &&
+        !(wr && errno == EEXIST) &&
+        !(!wr && (errno == ENOENT || errno == EBADF))){
+        clicon_err(OE_EVENTS, errno, "kevent");
+        return -1;
+    }
+    return 0;
+#endif
+}
+#endif /* HAVE_SYS_EPOLL_H || HAVE_SYS_EVENT_H */
+
+/*! Timer heap order: earlier deadline first, registration order as tiebreak
+ * @retval 1  a expires before b
+ * @retval 0  b expires before (or same as) a
+ */
+static int
+tt_before(struct event_data *a,
+          struct event_data *b)
+{
+    if (timercmp(&a->e_time, &b->e_time, !=))
+        return timercmp(&a->e_time, &b->e_time, <);
+    return a->e_seq < b->e_seq;
+}
+
+/*! Restore the heap property for entry i against its ancestors */
+static void
+tt_siftup(int i)
+{
+    struct event_data *e;
+    int                p;
+
+    while (i > 0){
+        p = (i-1)/2;
+        if (!tt_before(_tt_heap[i], _tt_heap[p]))
+            break;
+        e = _tt_heap[i];
+        _tt_heap[i] = _tt_heap[p];
+        _tt_heap[p] = e;
+        i = p;
+    }
+}
+
+/*! Restore the heap property for entry i against its descendants */
+static void
+tt_siftdown(int i)
+{
+    struct event_data *e;
+    int                c;
+
+    while ((c = 2*i+1) < _tt_len){
+        if (c+1 < _tt_len && tt_before(_tt_heap[c+1], _tt_heap[c]))
+            c++;
+        if (!tt_before(_tt_heap[c], _tt_heap[i]))
+            break;
+        e = _tt_heap[i];
+        _tt_heap[i] = _tt_heap[c];
+        _tt_heap[c] = e;
+        i = c;
+    }
+}
+
+/*! Insert a timer into the heap, growing the array as needed
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+tt_push(struct event_data *e)
+{
+    struct event_data **tt;
+    int                 size;
+
+    if (_tt_len == _tt_size){
+        size = _tt_size ? 2*_tt_size : 16;
+        if ((tt = realloc(_tt_heap, size*sizeof(*tt))) == NULL){
+            clicon_err(OE_EVENTS, errno, "realloc");
+            return -1;
+        }
+        _tt_heap = tt;
+        _tt_size = size;
+    }
+    _tt_heap[_tt_len++] = e;
+    tt_siftup(_tt_len-1);
+    return 0;
+}
+
+/*! Remove and return entry i from the heap (0 is the nearest deadline) */
+static struct event_data *
+tt_remove(int i)
+{
+    struct event_data *e;
+
+    e = _tt_heap[i];
+    if (i != --_tt_len){
+        _tt_heap[i] = _tt_heap[_tt_len];
+        tt_siftdown(i);
+        tt_siftup(i);
+    }
+    return e;
+}
+
 /* If set (eg by signal handler) exit select loop on next run and return 0 */
 static int _clicon_exit = 0;
 
@@ -114,6 +399,8 @@ int
 clixon_exit_set(int nr)
 {
     _clicon_exit = nr;
+    if (nr)
+        ee_sigpipe_wake();
     return 0;
 }
 
@@ -139,6 +426,8 @@ int
 clicon_sig_child_set(int val)
 {
     _clicon_sig_child = val;
+    if (val)
+        ee_sigpipe_wake();
     return 0;
 }
 
@@ -152,6 +441,8 @@ int
 clicon_sig_ignore_set(int val)
 {
     _clicon_sig_ignore = val;
+    if (val)
+        ee_sigpipe_wake();
     return 0;
 }
 
@@ -161,24 +452,15 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
-/*! Register a callback function to be called on input on a file descriptor.
- *
- * @param[in]  fd  File descriptor
- * @param[in]  fn  Function to call when input available on fd
- * @param[in]  arg Argument to function fn
- * @param[in]  str Describing string for logging
- * @code
- * int fn(int fd, void *arg){
- * }
- * clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd");
- * @endcode 
- * @see clixon_event_unreg_fd
+/*! Register a file descriptor callback, common read/write part
+ * @see clixon_event_reg_fd  clixon_event_reg_fd_write
  */
-int
-clixon_event_reg_fd(int   fd, 
-                    int (*fn)(int, void*), 
-                    void *arg, 
-                    char *str)
+static int
+event_reg_fd1(int   fd,
+              int (*fn)(int, void*),
+              void *arg,
+              char *str,
+              int   write)
 {
     struct event_data *e;
 
@@ -189,32 +471,79 @@ clixon_event_reg_fd(int   fd,
     memset(e, 0, sizeof(struct event_data));
     strncpy(e->e_string, str, EVENT_STRLEN-1);
     e->e_fd = fd;
+    e->e_write = write;
     e->e_fn = fn;
     e->e_arg = arg;
     e->e_type = EVENT_FD;
     e->e_next = ee;
     ee = e;
-    clicon_debug(2, "%s, registering %s", __FUNCTION__, e->e_string);
+#if defined(HAVE_SYS_EPOLL_H) || defined(HAVE_SYS_EVENT_H)
+    if (ee_poll_init() < 0 ||
+        ee_poll_update(fd) < 0){
+        ee = e->e_next;
+        free(e);
+        return -1;
+    }
+#endif
+    clicon_debug(2, "%s, registering %s", __FUNCTION__, str);
     return 0;
 }
 
-/*! Deregister a file descriptor callback
- * @param[in]  s   File descriptor
+/*! Register a callback function to be called on input on a file descriptor.
+ *
+ * @param[in]  fd  File descriptor
  * @param[in]  fn  Function to call when input available on fd
- * Note: deregister when exactly function and socket match, not argument
- * @see clixon_event_reg_fd
- * @see clixon_event_unreg_timeout
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @code
+ * int fn(int fd, void *arg){
+ * }
+ * clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd");
+ * @endcode
+ * @see clixon_event_unreg_fd
  */
 int
-clixon_event_unreg_fd(int   s, 
-                      int (*fn)(int, void*))
+clixon_event_reg_fd(int   fd,
+                    int (*fn)(int, void*),
+                    void *arg,
+                    char *str)
+{
+    return event_reg_fd1(fd, fn, arg, str, 0);
+}
+
+/*! Register a callback function to be called when fd is writable
+ *
+ * Used to drain buffered output without blocking: write what the socket
+ * accepts, register for write-readiness, and unregister when drained.
+ * @param[in]  fd  File descriptor
+ * @param[in]  fn  Function to call when fd accepts writes
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @see clixon_event_unreg_fd_write
+ */
+int
+clixon_event_reg_fd_write(int   fd,
+                          int (*fn)(int, void*),
+                          void *arg,
+                          char *str)
+{
+    return event_reg_fd1(fd, fn, arg, str, 1);
+}
+
+/*! Deregister a file descriptor callback, common read/write part
+ * @see clixon_event_unreg_fd  clixon_event_unreg_fd_write
+ */
+static int
+event_unreg_fd1(int   s,
+                int (*fn)(int, void*),
+                int   write)
 {
     struct event_data *e, **e_prev;
     int found = 0;
 
     e_prev = &ee;
     for (e = ee; e; e = e->e_next){
-        if (fn == e->e_fn && s == e->e_fd) {
+        if (fn == e->e_fn && s == e->e_fd && write == e->e_write) {
             found++;
             *e_prev = e->e_next;
             _ee_unreg++;
@@ -223,9 +552,40 @@ clixon_event_unreg_fd(int   s,
         }
         e_prev = &e->e_next;
     }
+#if defined(HAVE_SYS_EPOLL_H) || defined(HAVE_SYS_EVENT_H)
+    /* Recompute kernel interest: other callbacks may still use the fd */
+    if (found && ee_poll_update(s) < 0)
+        return -1;
+#endif
     return found?0:-1;
 }
 
+/*! Deregister a file descriptor callback
+ * @param[in]  s   File descriptor
+ * @param[in]  fn  Function to call when input available on fd
+ * Note: deregister when exactly function and socket match, not argument
+ * @see clixon_event_reg_fd
+ * @see clixon_event_unreg_timeout
+ */
+int
+clixon_event_unreg_fd(int   s,
+                      int (*fn)(int, void*))
+{
+    return event_unreg_fd1(s, fn, 0);
+}
+
+/*! Deregister a write-readiness callback
+ * @param[in]  s   File descriptor
+ * @param[in]  fn  Function registered with clixon_event_reg_fd_write
+ * @see clixon_event_reg_fd_write
+ */
+int
+clixon_event_unreg_fd_write(int   s,
+                            int (*fn)(int, void*))
+{
+    return event_unreg_fd1(s, fn, 1);
+}
+
 /*! Call a callback function at an absolute time
  * @param[in]  t   Absolute (not relative!) timestamp when callback is called
  * @param[in]  fn  Function to call at time t
@@ -255,7 +615,7 @@ clixon_event_reg_timeout(struct timeval t,
                          void          *arg, 
                          char          *str)
 {
-    struct event_data *e, *e1, **e_prev;
+    struct event_data *e;
 
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clicon_err(OE_EVENTS, errno, "malloc");
@@ -267,16 +627,12 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &ee_timers;
-    for (e1=ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
+    e->e_seq = _tt_seq++;
+    if (tt_push(e) < 0){
+        free(e);
+        return -1;
     }
-    e->e_next = e1;
-    *e_prev = e;
-    clicon_debug(2, "%s: %s", __FUNCTION__, str); 
+    clicon_debug(2, "%s: %s", __FUNCTION__, str);
     return 0;
 }
 
@@ -292,21 +648,18 @@ clixon_event_reg_timeout(struct timeval t,
  * @see clixon_event_unreg_fd
  */
 int
-clixon_event_unreg_timeout(int (*fn)(int, void*), 
+clixon_event_unreg_timeout(int (*fn)(int, void*),
                            void *arg)
 {
-    struct event_data *e, **e_prev;
     int found = 0;
+    int i;
 
-    e_prev = &ee_timers;
-    for (e = ee_timers; e; e = e->e_next){
-        if (fn == e->e_fn && arg == e->e_arg) {
+    for (i = 0; i < _tt_len; i++){
+        if (fn == _tt_heap[i]->e_fn && arg == _tt_heap[i]->e_arg) {
             found++;
-            *e_prev = e->e_next;
-            free(e);
+            free(tt_remove(i));
             break;
         }
-        e_prev = &e->e_next;
     }
     return found?0:-1;
 }
@@ -317,17 +670,16 @@ clixon_event_unreg_timeout(int (*fn)(int, void*),
  * @retval     0    Nothing to read/empty fd
  * @retval     1    Something to read on fd
  */
-int 
+int
 clixon_event_poll(int fd)
 {
-    int            retval = -1;
-    fd_set         fdset;
-    struct timeval tnull = {0,};
-
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-    if ((retval = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull)) < 0)
-        clicon_err(OE_EVENTS, errno, "select");
+    int           retval = -1;
+    struct pollfd pfd = {0,};
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if ((retval = poll(&pfd, 1, 0)) < 0)
+        clicon_err(OE_EVENTS, errno, "poll");
     return retval;
 }
 
@@ -348,31 +700,79 @@ clixon_event_loop(clicon_handle h)
     int                n;
     struct timeval     t;
     struct timeval     t0;
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event evs[EVENT_NEVENTS];
+    int                i;
+#elif defined(HAVE_SYS_EVENT_H)
+    struct kevent      evs[EVENT_NEVENTS];
+    struct timespec    ts;
+    int                i;
+#else
     struct timeval     tnull = {0,};
     fd_set             fdset;
+    fd_set             wrset;
+#endif
     int                retval = -1;
 
+#if defined(HAVE_SYS_EPOLL_H) || defined(HAVE_SYS_EVENT_H)
+    if (ee_poll_init() < 0) /* in case no fd was registered yet */
+        return retval;
+#else
+    if (ee_sigpipe_init() < 0)
+        return retval;
+#endif
     while (clixon_exit_get() != 1){
-        FD_ZERO(&fdset);
+        clicon_log_flush(); /* drain async-buffered log messages before blocking */
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
                 goto err;
             clicon_sig_child_set(0);
         }
+        if (clicon_sig_ignore_get())
+            clicon_sig_ignore_set(0);
+#ifdef HAVE_SYS_EPOLL_H
+        if (_tt_len > 0){
+            gettimeofday(&t0, NULL);
+            timersub(&_tt_heap[0]->e_time, &t0, &t);
+            if (t.tv_sec < 0)
+                n = epoll_wait(_ee_pollfd, evs, EVENT_NEVENTS, 0);
+            else
+                n = epoll_wait(_ee_pollfd, evs, EVENT_NEVENTS,
+                               t.tv_sec*1000 + (t.tv_usec+999)/1000);
+        }
+        else
+            n = epoll_wait(_ee_pollfd, evs, EVENT_NEVENTS, -1);
+#elif defined(HAVE_SYS_EVENT_H)
+        if (_tt_len > 0){
+            gettimeofday(&t0, NULL);
+            timersub(&_tt_heap[0]->e_time, &t0, &t);
+            if (t.tv_sec < 0)
+                t.tv_sec = t.tv_usec = 0;
+            ts.tv_sec = t.tv_sec;
+            ts.tv_nsec = t.tv_usec*1000;
+            n = kevent(_ee_pollfd, NULL, 0, evs, EVENT_NEVENTS, &ts);
+        }
+        else
+            n = kevent(_ee_pollfd, NULL, 0, evs, EVENT_NEVENTS, NULL);
+#else
+        FD_ZERO(&fdset);
+        FD_ZERO(&wrset);
+        FD_SET(_ee_sigpipe[0], &fdset); /* signal wakeup, see ee_sigpipe_wake */
         for (e=ee; e; e=e->e_next)
             if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
-        if (ee_timers != NULL){
+                FD_SET(e->e_fd, e->e_write?&wrset:&fdset);
+        if (_tt_len > 0){
             gettimeofday(&t0, NULL);
-            timersub(&ee_timers->e_time, &t0, &t); 
+            timersub(&_tt_heap[0]->e_time, &t0, &t);
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull); 
+                n = select(FD_SETSIZE, &fdset, &wrset, NULL, &tnull);
             else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t); 
+                n = select(FD_SETSIZE, &fdset, &wrset, NULL, &t);
         }
         else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+            n = select(FD_SETSIZE, &fdset, &wrset, NULL, NULL);
+#endif
         if (clixon_exit_get() == 1){
             break;
         }
@@ -388,9 +788,9 @@ clixon_event_loop(clicon_handle h)
                  *     New select loop is called
                  * (3) Other signals result in an error and return -1.
                  */
-                clicon_debug(1, "%s select: %s", __FUNCTION__, strerror(errno));
+                clicon_debug(1, "%s " EVENT_WAIT_NAME ": %s", __FUNCTION__, strerror(errno));
                 if (clixon_exit_get() == 1){
-                    clicon_err(OE_EVENTS, errno, "select");
+                    clicon_err(OE_EVENTS, errno, EVENT_WAIT_NAME);
                     retval = 0;
                 }
                 else if (clicon_sig_child_get()){
@@ -405,15 +805,14 @@ clixon_event_loop(clicon_handle h)
                     continue;
                 }
                 else
-                    clicon_err(OE_EVENTS, errno, "select");
+                    clicon_err(OE_EVENTS, errno, EVENT_WAIT_NAME);
             }
             else
-                clicon_err(OE_EVENTS, errno, "select");
+                clicon_err(OE_EVENTS, errno, EVENT_WAIT_NAME);
             goto err;
         }
         if (n==0){ /* Timeout */
-            e = ee_timers;
-            ee_timers = ee_timers->e_next;
+            e = tt_remove(0);
             clicon_debug(2, "%s timeout: %s", __FUNCTION__, e->e_string);
             if ((*e->e_fn)(0, e->e_arg) < 0){
                 free(e);
@@ -422,12 +821,56 @@ clixon_event_loop(clicon_handle h)
             free(e);
         }
         _ee_unreg = 0;
+#if defined(HAVE_SYS_EPOLL_H) || defined(HAVE_SYS_EVENT_H)
+        for (i=0; i<n; i++){
+            if (clixon_exit_get() == 1 || _ee_unreg)
+                break;
+#ifdef HAVE_SYS_EPOLL_H
+            if (evs[i].data.fd == _ee_sigpipe[0])
+#else
+            if ((int)evs[i].ident == _ee_sigpipe[0])
+#endif
+            {
+                /* Signal wakeup: drain, flags are handled at the top of the loop */
+                ee_sigpipe_drain();
+                continue;
+            }
+            for (e=ee; e; e=e_next){
+                e_next = e->e_next;
+#ifdef HAVE_SYS_EPOLL_H
+                if (e->e_type != EVENT_FD || e->e_fd != evs[i].data.fd)
+                    continue;
+                /* Errors and hangups are delivered to both directions */
+                if ((evs[i].events &
+                     ((e->e_write?EPOLLOUT:EPOLLIN)|EPOLLERR|EPOLLHUP)) == 0)
+                    continue;
+#else
+                if (e->e_type != EVENT_FD || e->e_fd != (int)evs[i].ident)
+                    continue;
+                if (evs[i].filter != (e->e_write?EVFILT_WRITE:EVFILT_READ))
+                    continue;
+#endif
+                clicon_debug(2, "%s: ready: %s", __FUNCTION__, e->e_string);
+                if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
+                    clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
+                    goto err;
+                }
+                if (_ee_unreg)
+                    break;
+            }
+        }
+        /* Unhandled ready fds are level-triggered: reported again next lap */
+        _ee_unreg = 0;
+#else
+        if (FD_ISSET(_ee_sigpipe[0], &fdset))
+            /* Signal wakeup: drain, flags are handled at the top of the loop */
+            ee_sigpipe_drain();
         for (e=ee; e; e=e_next){
             if (clixon_exit_get() == 1){
                 break;
             }
             e_next = e->e_next;
-            if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset)){
+            if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, e->e_write?&wrset:&fdset)){
                 clicon_debug(2, "%s: FD_ISSET: %s", __FUNCTION__, e->e_string);
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                     clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
@@ -439,6 +882,7 @@ clixon_event_loop(clicon_handle h)
                 }
             }
         }
+#endif
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
         continue;
       err:
@@ -462,11 +906,23 @@ clixon_event_exit(void)
         free(e);
     }
     ee = NULL;
-    e_next = ee_timers;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
+    while (_tt_len > 0)
+        free(tt_remove(_tt_len-1));
+    if (_tt_heap){
+        free(_tt_heap);
+        _tt_heap = NULL;
+        _tt_size = 0;
+    }
+#if defined(HAVE_SYS_EPOLL_H) || defined(HAVE_SYS_EVENT_H)
+    if (_ee_pollfd != -1){
+        close(_ee_pollfd);
+        _ee_pollfd = -1;
+    }
+#endif
+    if (_ee_sigpipe[0] != -1){
+        close(_ee_sigpipe[0]);
+        close(_ee_sigpipe[1]);
+        _ee_sigpipe[0] = _ee_sigpipe[1] = -1;
     }
-    ee_timers = NULL;
     return 0;
 }
@@ -1,7 +1,7 @@
 /*
  *
   ***** BEGIN LICENSE BLOCK *****
- 
+
   Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
   Copyright (C) 2017-2019 Olof Hagsand
   Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
@@ -25,7 +25,7 @@
   in which case the provisions of the GPL are applicable instead
   of those above. If you wish to allow use of your version of this file only
   under the terms of the GPL, and not to allow others to
-  use your version of this file under the terms of Apache License version 2, 
+  use your version of this file under the terms of Apache License version 2,
   indicate your decision by deleting the provisions above and replace them with
   the  notice and other provisions required by the GPL. If you do not delete
   the provisions above, a recipient may use your version of this file under
@@ -41,6 +41,13 @@
  * are always strings while values can be some arbitrary data referenced
  * by void*.
  *
+ * Implemented as an open-addressing table with linear probing that doubles
+ * in size at 3/4 load. Entries are slots in one vector: no per-entry malloc
+ * beyond the key string (and the value copy, unless added with
+ * clicon_hash_add_ptr). Keys are individually malloced so key pointers
+ * returned via h_key are stable over the table's lifetime; entry pointers
+ * returned by lookup/add are only valid until the next add or delete.
+ *
  * XXX: functions such as hash_keys(), hash_value() etc are currently returning
  * pointers to the actual data storage. Should probably make copies.
  *
@@ -62,7 +69,7 @@
  *    hash_add(hash, "BEPA", "hoppla Polle!", strlen("hoppla Polle!")+1);
  *    puts((char *)hash_value(hash, "BEPA", NULL));
  *    hash_dump(hash, stdout);
- *    
+ *
  *    puts("----");
  *
  *    n = 33;
@@ -70,7 +77,7 @@
  *    hash_dump(hash, stdout);
  *
  *    puts("----");
- *    
+ *
  *    hash_del(hash, "APA");
  *    hash_dump(hash, stdout);
  *
@@ -94,23 +101,102 @@
 #include <cligen/cligen.h>
 
 /* clixon */
-#include "clixon_queue.h"
 #include "clixon_err.h"
 #include "clixon_hash.h"
 
-#define HASH_SIZE       1031    /* Number of hash buckets. Should be a prime */ 
+#define HASH_INIT_SIZE  16      /* Initial number of slots, power of two */
 #define align4(s) (((s)/4)*4 + 4)
 
-/*! A very simplistic algorithm to calculate a hash bucket index
+/* Tombstone marker for deleted slots: empty slots have h_key NULL, deleted
+ * slots h_key == HASH_TOMB so probe sequences continue past them
+ */
+static char _hash_tomb_marker;
+#define HASH_TOMB (&_hash_tomb_marker)
+
+#define slot_live(s) ((s)->h_key != NULL && (s)->h_key != HASH_TOMB)
+
+/* Internal table header, cast to/from the public clicon_hash_t* handle */
+struct hash_table {
+    struct clicon_hash *ht_slots;   /* Slot vector, ht_size entries */
+    size_t              ht_size;    /* Number of slots, power of two */
+    size_t              ht_entries; /* Live entries */
+    size_t              ht_tombs;   /* Deleted (tombstone) slots */
+};
+
+#define hash_tbl(h) ((struct hash_table *)(h))
+
+/*! FNV-1a string hash
  */
 static uint32_t
-hash_bucket(const char *str)
+hash_str(const char *str)
+{
+    uint32_t n = 2166136261u;
+
+    while (*str){
+        n ^= (uint32_t)(unsigned char)*str++;
+        n *= 16777619u;
+    }
+    return n;
+}
+
+/*! Find slot of key, or the insertion slot if not present
+ * @param[in]  ht   Hash table
+ * @param[in]  key  Variable name
+ * @retval     s    Slot: live with matching key, or first reusable slot
+ */
+static struct clicon_hash *
+hash_slot(struct hash_table *ht,
+          const char        *key)
 {
-    uint32_t n = 0;
+    size_t              i = hash_str(key) & (ht->ht_size - 1);
+    struct clicon_hash *s;
+    struct clicon_hash *tomb = NULL;
+
+    for (;;){
+        s = &ht->ht_slots[i];
+        if (s->h_key == NULL)
+            return tomb ? tomb : s;
+        if (s->h_key == HASH_TOMB){
+            if (tomb == NULL)
+                tomb = s; /* remember first reusable, keep probing for key */
+        }
+        else if (strcmp(s->h_key, key) == 0)
+            return s;
+        i = (i + 1) & (ht->ht_size - 1);
+    }
+}
 
-    while(*str)
-        n += (uint32_t)*str++;
-    return n % HASH_SIZE;
+/*! Grow slot vector to newsize and rehash all live entries
+ * @param[in]  ht       Hash table
+ * @param[in]  newsize  New number of slots, power of two
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+hash_resize(struct hash_table *ht,
+            size_t             newsize)
+{
+    struct clicon_hash *oldslots = ht->ht_slots;
+    size_t              oldsize = ht->ht_size;
+    struct clicon_hash *s;
+    size_t              i;
+
+    if ((ht->ht_slots = calloc(newsize, sizeof(struct clicon_hash))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        ht->ht_slots = oldslots;
+        return -1;
+    }
+    ht->ht_size = newsize;
+    ht->ht_tombs = 0;
+    for (i = 0; i < oldsize; i++){
+        if (!slot_live(&oldslots[i]))
+            continue;
+        s = hash_slot(ht, oldslots[i].h_key);
+        *s = oldslots[i];
+    }
+    if (oldslots)
+        free(oldslots);
+    return 0;
 }
 
 /*! Initialize hash table.
@@ -122,14 +208,20 @@ hash_bucket(const char *str)
 clicon_hash_t *
 clicon_hash_init(void)
 {
-  clicon_hash_t *hash;
-
-  if ((hash = (clicon_hash_t *)malloc(sizeof(clicon_hash_t) * HASH_SIZE)) == NULL){
-      clicon_err(OE_UNIX, errno, "malloc");
-      return NULL;
-  }
-  memset(hash, 0, sizeof(clicon_hash_t)*HASH_SIZE);
-  return hash;
+    struct hash_table *ht;
+
+    if ((ht = malloc(sizeof(*ht))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ht, 0, sizeof(*ht));
+    if ((ht->ht_slots = calloc(HASH_INIT_SIZE, sizeof(struct clicon_hash))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        free(ht);
+        return NULL;
+    }
+    ht->ht_size = HASH_INIT_SIZE;
+    return (clicon_hash_t *)ht;
 }
 
 /*! Free hash table.
@@ -141,18 +233,20 @@ clicon_hash_init(void)
 int
 clicon_hash_free(clicon_hash_t *hash)
 {
-    int i;
-    clicon_hash_t tmp;
-    for (i = 0; i < HASH_SIZE; i++) {
-        while (hash[i]) {
-            tmp = hash[i];
-            DELQ(tmp, hash[i], clicon_hash_t);
-            free(tmp->h_key);
-            free(tmp->h_val);
-            free(tmp);
-        }
+    struct hash_table  *ht = hash_tbl(hash);
+    struct clicon_hash *s;
+    size_t              i;
+
+    for (i = 0; i < ht->ht_size; i++){
+        s = &ht->ht_slots[i];
+        if (!slot_live(s))
+            continue;
+        free(s->h_key);
+        if (s->h_vlen && s->h_val)
+            free(s->h_val);
     }
-    free(hash);
+    free(ht->ht_slots);
+    free(ht);
     return 0;
 }
 
@@ -162,23 +256,19 @@ clicon_hash_free(clicon_hash_t *hash)
  * @param[in] key      Variable name
  * @retval    variable Hash variable structure on success
  * @retval    NULL     Not found
+ * @note The returned pointer is into the slot vector: valid until the next
+ *       add or delete on the table. h_key itself is stable.
  */
 clicon_hash_t
-clicon_hash_lookup(clicon_hash_t *hash, 
+clicon_hash_lookup(clicon_hash_t *hash,
                    const char    *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
+    struct hash_table  *ht = hash_tbl(hash);
+    struct clicon_hash *s;
 
-    bkt = hash_bucket(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (!strcmp(h->h_key, key))
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
-    }
+    s = hash_slot(ht, key);
+    if (slot_live(s))
+        return s;
     return NULL;
 }
 
@@ -186,12 +276,12 @@ clicon_hash_lookup(clicon_hash_t *hash,
  * @param[in]  hash   Hash table
  * @param[in]  key    Variable name
  * @param[out] vlen   Length of value (as returned by function if != NULL)
- * @retval     value  Hash value, length given in vlen 
+ * @retval     value  Hash value, length given in vlen
  * @retval     NULL   Key not found or value NULL
  */
 void *
-clicon_hash_value(clicon_hash_t *hash, 
-                  const char    *key, 
+clicon_hash_value(clicon_hash_t *hash,
+                  const char    *key,
                   size_t        *vlen)
 {
     clicon_hash_t h;
@@ -209,6 +299,48 @@ clicon_hash_value(clicon_hash_t *hash,
     return h->h_val;
 }
 
+/*! Find slot for key, creating it (and growing the table) if not present
+ * @param[in]  ht   Hash table
+ * @param[in]  key  Variable name
+ * @param[out] new  Set to 1 if slot was created
+ * @retval     s    Slot
+ * @retval     NULL Error
+ */
+static struct clicon_hash *
+hash_slot_new(struct hash_table *ht,
+              const char        *key,
+              int               *new)
+{
+    struct clicon_hash *s;
+    char               *keydup;
+
+    s = hash_slot(ht, key);
+    if (slot_live(s)){
+        *new = 0;
+        return s;
+    }
+    /* Grow at 3/4 load including tombstones, so probes stay short */
+    if ((ht->ht_entries + ht->ht_tombs + 1)*4 >= ht->ht_size*3){
+        if (hash_resize(ht, ht->ht_size*2) < 0)
+            return NULL;
+        s = hash_slot(ht, key);
+    }
+    /* Copy the key before touching the slot: clearing a tombstone and then
+     * failing would break probe chains running through it
+     */
+    if ((keydup = strdup(key)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return NULL;
+    }
+    if (s->h_key == HASH_TOMB)
+        ht->ht_tombs--;
+    memset(s, 0, sizeof(*s));
+    s->h_key = keydup;
+    ht->ht_entries++;
+    *new = 1;
+    return s;
+}
+
 /*! Copy value and add hash entry.
  *
  * @param[in] hash   Hash table
@@ -220,15 +352,16 @@ clicon_hash_value(clicon_hash_t *hash,
  * @note special case val is NULL and vlen==0
  */
 clicon_hash_t
-clicon_hash_add(clicon_hash_t *hash, 
-                const char    *key, 
-                void          *val, 
+clicon_hash_add(clicon_hash_t *hash,
+                const char    *key,
+                void          *val,
                 size_t         vlen)
 {
-    void         *newval = NULL;
-    clicon_hash_t h;
-    clicon_hash_t new = NULL;
-    
+    struct hash_table  *ht = hash_tbl(hash);
+    void               *newval = NULL;
+    struct clicon_hash *s;
+    int                 new = 0;
+
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return NULL;
@@ -237,56 +370,61 @@ clicon_hash_add(clicon_hash_t *hash,
     if ((val == NULL && vlen != 0) ||
         (val != NULL && vlen == 0)){
         clicon_err(OE_UNIX, EINVAL, "Mismatch in value and length, only one is zero");
-        goto catch;
-    }
-    /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL) {
-        if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
-            clicon_err(OE_UNIX, errno, "malloc");
-            goto catch;
-        }
-        memset(new, 0, sizeof(*new));
-        
-        new->h_key = strdup(key);
-        if (new->h_key == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
-            goto catch;
-        }
-        
-        h = new;
+        return NULL;
     }
-    
     if (vlen){
         /* Make copy of value. aligned */
-        newval = malloc(align4(vlen+3)); 
+        newval = malloc(align4(vlen+3));
         if (newval == NULL){
             clicon_err(OE_UNIX, errno, "malloc");
-            goto catch;
+            return NULL;
         }
         memcpy(newval, val, vlen);
     }
-    
-    /* Free old value if existing variable */
-    if (h->h_val)
-        free(h->h_val);
-    h->h_val = newval;
-    h->h_vlen =  vlen;
-
-    /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_bucket(key)]);
-
-    return h;
-
-catch:
-    if (new) {
-        if (new->h_key)
-            free(new->h_key);
-        free(new);
+    if ((s = hash_slot_new(ht, key, &new)) == NULL){
+        if (newval)
+            free(newval);
+        return NULL;
     }
+    /* Free old value if existing variable */
+    if (!new && s->h_vlen && s->h_val)
+        free(s->h_val);
+    s->h_val = newval;
+    s->h_vlen = vlen;
+    return s;
+}
 
-    return NULL;
+/*! Add hash entry referencing val directly, without copying it
+ *
+ * The pointer itself is stored: the table does not free it on delete/free and
+ * the caller keeps ownership. Such entries have h_vlen 0.
+ * @param[in] hash   Hash table
+ * @param[in] key    Variable name
+ * @param[in] val    Variable value pointer, may be NULL
+ * @retval    hash   New hash structure on success
+ * @retval    NULL   Error
+ * @see clicon_hash_add  which stores a copy of the value
+ */
+clicon_hash_t
+clicon_hash_add_ptr(clicon_hash_t *hash,
+                    const char    *key,
+                    void          *val)
+{
+    struct hash_table  *ht = hash_tbl(hash);
+    struct clicon_hash *s;
+    int                 new = 0;
+
+    if (hash == NULL){
+        clicon_err(OE_UNIX, EINVAL, "hash is NULL");
+        return NULL;
+    }
+    if ((s = hash_slot_new(ht, key, &new)) == NULL)
+        return NULL;
+    if (!new && s->h_vlen && s->h_val)
+        free(s->h_val);
+    s->h_val = val;
+    s->h_vlen = 0;
+    return s;
 }
 
 /*! Delete hash entry.
@@ -298,28 +436,57 @@ catch:
  * @retval   -1       Key not found
  */
 int
-clicon_hash_del(clicon_hash_t *hash, 
+clicon_hash_del(clicon_hash_t *hash,
                 const char    *key)
 {
-    clicon_hash_t h;
+    struct hash_table  *ht = hash_tbl(hash);
+    struct clicon_hash *s;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL)
+    s = hash_slot(ht, key);
+    if (!slot_live(s))
         return -1;
-    
-    DELQ(h, hash[hash_bucket(key)], clicon_hash_t);
-  
-    free(h->h_key);
-    free(h->h_val);
-    free(h);
-
+    free(s->h_key);
+    if (s->h_vlen && s->h_val)
+        free(s->h_val);
+    memset(s, 0, sizeof(*s));
+    s->h_key = HASH_TOMB;
+    ht->ht_entries--;
+    ht->ht_tombs++;
     return 0;
 }
 
+/*! Iterate over hash entries without building a key snapshot
+ *
+ * @param[in]  hash  Hash table
+ * @param[in]  prev  Previous entry, or NULL to start iteration
+ * @retval     h     Next entry (read key via h_key, value via h_val/h_vlen)
+ * @retval     NULL  No more entries
+ * @note Invalidated by add or delete on the table: to mutate while iterating,
+ *       use clicon_hash_keys and loop over the snapshot instead.
+ */
+clicon_hash_t
+clicon_hash_next(clicon_hash_t *hash,
+                 clicon_hash_t  prev)
+{
+    struct hash_table  *ht = hash_tbl(hash);
+    struct clicon_hash *s;
+    size_t              i;
+
+    if (hash == NULL)
+        return NULL;
+    i = prev ? (size_t)(prev - ht->ht_slots) + 1 : 0;
+    for (; i < ht->ht_size; i++){
+        s = &ht->ht_slots[i];
+        if (slot_live(s))
+            return s;
+    }
+    return NULL;
+}
+
 /*! Return vector of keys in hash table
  *
  * @param[in]   hash    Hash table
@@ -328,48 +495,41 @@ clicon_hash_del(clicon_hash_t *hash,
  * @retval      0       OK
  * @retval     -1       Error
  * @note: vector needs to be deallocated with free
+ * @see clicon_hash_next  for iteration without the snapshot malloc
  */
 int
-clicon_hash_keys(clicon_hash_t *hash, 
+clicon_hash_keys(clicon_hash_t *hash,
                  char        ***vector,
                  size_t        *nkeys)
 {
-    int           retval = -1;
-    int           bkt;
-    clicon_hash_t h;
-    char        **tmp;
-    char        **keys = NULL;
+    struct hash_table  *ht = hash_tbl(hash);
+    struct clicon_hash *s;
+    size_t              i;
+    char              **keys = NULL;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
     *nkeys = 0;
-    for (bkt = 0; bkt < HASH_SIZE; bkt++) {
-        h = hash[bkt];
-        do {
-            if (h == NULL)
-                break;
-            tmp = realloc(keys, ((*nkeys)+1) * sizeof(char *));
-            if (tmp == NULL){
-                clicon_err(OE_UNIX, errno, "realloc");
-                goto catch;
-            }
-            keys = tmp;
-            keys[*nkeys] = h->h_key;
-            (*nkeys)++;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+    if (ht->ht_entries &&
+        (keys = malloc(ht->ht_entries * sizeof(char *))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    for (i = 0; i < ht->ht_size; i++){
+        s = &ht->ht_slots[i];
+        if (!slot_live(s))
+            continue;
+        keys[(*nkeys)++] = s->h_key;
     }
     if (vector){
         *vector = keys;
         keys = NULL;
     }
-    retval = 0;
-catch:
     if (keys)
         free(keys);
-    return retval;
+    return 0;
 }
 
 /*! Dump contents of hash to FILE pointer.
@@ -380,29 +540,14 @@ catch:
  * @retval     -1       Error
  */
 int
-clicon_hash_dump(clicon_hash_t *hash, 
+clicon_hash_dump(clicon_hash_t *hash,
                  FILE          *f)
 {
-    int    retval = -1;
-    int    i;
-    char **keys = NULL;
-    void  *val;
-    size_t klen;
-    size_t vlen;
-    
-    if (hash == NULL)
-        goto ok;
-    if (clicon_hash_keys(hash, &keys, &klen) < 0)
-        goto done;
-    for(i = 0; i < klen; i++) {
-        val = clicon_hash_value(hash, keys[i], &vlen);
-        printf("%s =\t 0x%p , length %zu\n", keys[i], val, vlen);
-    }
+    clicon_hash_t h = NULL;
 
- ok:
-    retval = 0;
- done:
-    if (keys)
-        free(keys);
-    return retval;
+    if (hash == NULL)
+        return 0;
+    while ((h = clicon_hash_next(hash, h)) != NULL)
+        printf("%s =\t 0x%p , length %zu\n", h->h_key, h->h_val, h->h_vlen);
+    return 0;
 }
@@ -45,6 +45,7 @@ struct clixon_instance_id_yacc {
     int           iy_linenum;      /* Number of \n in parsed buffer */
     char         *iy_parse_string; /* original (copy of) parse string */
     void         *iy_lexbuf;       /* internal parse buffer from lex */
+    clixon_arena *iy_arena;        /* scratch arena owning token strings, popped by caller */
     clixon_path  *iy_top;
     int           iy_lex_state;    /* lex return state */
 };
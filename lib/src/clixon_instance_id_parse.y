@@ -118,6 +118,7 @@
 #include "clixon_err.h"
 #include "clixon_log.h"
 #include "clixon_queue.h"
+#include "clixon_arena.h"
 #include "clixon_string.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -320,9 +321,9 @@ element        : node_id element2   { $$ = path_add_keyvalue($1, $2);
                                       clicon_debug(3,"element = node_id element2");}
                ;
 
-node_id        : IDENTIFIER               { $$ = path_new(NULL, $1); free($1);
+node_id        : IDENTIFIER               { $$ = path_new(NULL, $1); /* token strings are arena-owned */
                                             clicon_debug(3,"node_id = IDENTIFIER");}
-               | prefix COLON IDENTIFIER  { $$ = path_new($1, $3); free($1); free($3);
+               | prefix COLON IDENTIFIER  { $$ = path_new($1, $3);
                                             clicon_debug(3,"node_id = prefix : IDENTIFIER");} 
                ;
 
@@ -339,11 +340,11 @@ leaf_list_pred : LSQBR leaf_list_pred_expr RSQBR
                                    clicon_debug(3,"leaf_list_pred = [ leaf_list_pred_expr ]"); }
                ;
 
-leaf_list_pred_expr : DOT EQUAL qstring  { $$ = keyval_set(".", $3); free($3);
+leaf_list_pred_expr : DOT EQUAL qstring  { $$ = keyval_set(".", $3);
                                            clicon_debug(3,"leaf_list_pred_expr = '.=' qstring"); }
                ;
 
-pos            : LSQBR UINT RSQBR        { $$ = keyval_pos($2); free($2);
+pos            : LSQBR UINT RSQBR        { $$ = keyval_pos($2);
                                            clicon_debug(3,"pos = [ UINT ]"); }
                ;
 
@@ -357,23 +358,23 @@ key_pred       : LSQBR key_pred_expr RSQBR  { $$ = $2;
                                               clicon_debug(3,"key_pred = [ key_pred_expr ]"); }
                ;
 
-key_pred_expr  : node_id_k EQUAL qstring   { $$ = keyval_set($1, $3); free($1); free($3);
+key_pred_expr  : node_id_k EQUAL qstring   { $$ = keyval_set($1, $3);
                           clicon_debug(3,"key_pred_expr = node_id_k = qstring");  }
                ;
 
 node_id_k      : IDENTIFIER               { $$ = $1; 
                                             clicon_debug(3,"node_id_k = IDENTIFIER %s", $1); }
                | prefix COLON IDENTIFIER  { $$ = $3;  /* ignore prefix in key? */
-                          clicon_debug(3,"node_id_k = prefix %s : IDENTIFIER %s", $1, $3); free($1);} 
+                          clicon_debug(3,"node_id_k = prefix %s : IDENTIFIER %s", $1, $3);} 
                ;
 
 qstring        : DQUOTE STRING DQUOTE { $$=$2;
                                         clicon_debug(3,"qstring = \" string \""); }
-               | DQUOTE DQUOTE        { $$=strdup("");
+               | DQUOTE DQUOTE        { $$=clixon_arena_strdup(_IY->iy_arena, "");
                                              clicon_debug(3,"qstring = \" \""); }
                | SQUOTE STRING SQUOTE { $$=$2;
                                              clicon_debug(3,"qstring = ' string '"); }
-               | SQUOTE SQUOTE        { $$=strdup("");
+               | SQUOTE SQUOTE        { $$=clixon_arena_strdup(_IY->iy_arena, "");
                                              clicon_debug(3,"qstring = ''"); }
                ;
 
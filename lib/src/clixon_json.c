@@ -240,6 +240,42 @@ array_eval(cxobj *xprev,
     return arraytype;
 }
 
+/*! Length of leading run without JSON-escaped characters, SWAR-accelerated
+ *
+ * Same word-at-a-time technique as xml_chardata_clean_run but for the JSON
+ * escape set of json_str_escape_cdata: newline, double quote and backslash.
+ * @param[in]  str  Input string, need not be NUL-terminated
+ * @param[in]  len  Number of bytes to scan
+ * @retval     n    Length of prefix containing no escaped character
+ */
+static size_t
+json_str_clean_run(const char *str,
+                   size_t      len)
+{
+    size_t   i = 0;
+    uint64_t w;
+    uint64_t m;
+#define SWAR_ONES  0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+#define SWAR_BCAST(c) (SWAR_ONES * (unsigned char)(c))
+
+    while (i + sizeof(w) <= len){
+        memcpy(&w, str + i, sizeof(w)); /* compiles to one unaligned load */
+        m  = ((w ^ SWAR_BCAST('\n')) - SWAR_ONES) & ~(w ^ SWAR_BCAST('\n')) & SWAR_HIGHS;
+        m |= ((w ^ SWAR_BCAST('\"')) - SWAR_ONES) & ~(w ^ SWAR_BCAST('\"')) & SWAR_HIGHS;
+        m |= ((w ^ SWAR_BCAST('\\')) - SWAR_ONES) & ~(w ^ SWAR_BCAST('\\')) & SWAR_HIGHS;
+        if (m != 0)
+            break;
+        i += sizeof(w);
+    }
+#undef SWAR_BCAST
+#undef SWAR_HIGHS
+#undef SWAR_ONES
+    while (i < len && str[i] != '\n' && str[i] != '\"' && str[i] != '\\')
+        i++;
+    return i;
+}
+
 /*! Escape a json string as well as decode xml cdata
  * @param[out] cb   cbuf   (encoded)
  * @param[in]  str  string (unencoded)
@@ -251,25 +287,37 @@ json_str_escape_cdata(cbuf *cb,
     int   retval = -1;
     int   i;
     size_t len;
-    
+    size_t n;
+
     len = strlen(str);
-    for (i=0; i<len; i++)
+    for (i=0; i<len; i++){
+        /* Bulk-copy the run up to the next escaped character */
+        if ((n = json_str_clean_run(&str[i], len-i)) > 0){
+            if (cbuf_append_buf(cb, &str[i], n) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+            i += n;
+            if (i >= len)
+                break;
+        }
         switch (str[i]){
         case '\n':
-            cprintf(cb, "\\n");
+            cbuf_append_str(cb, "\\n");
             break;
         case '\"':
-            cprintf(cb, "\\\"");
+            cbuf_append_str(cb, "\\\"");
             break;
         case '\\':
-            cprintf(cb, "\\\\");
+            cbuf_append_str(cb, "\\\\");
             break;
-        default: /* fall thru */
-            cprintf(cb, "%c", str[i]);
+        default: /* cannot happen: clean run stops only on the above */
+            cbuf_append(cb, str[i]);
             break;
         }
+    }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -1141,6 +1189,76 @@ clixon_json2cbuf(cbuf  *cb,
     return retval;
 }
 
+/*! Translate an XML tree to JSON delivered as bounded-size chunks
+ *
+ * Streaming variant of clixon_json2cbuf: the document is serialized one
+ * top-level subtree at a time into a scratch buffer which is handed to the
+ * callback and reset whenever it exceeds chunksz. Peak memory is therefore
+ * bounded by chunksz plus the largest single subtree rendering instead of
+ * the whole document, which matters for RESTCONF GETs of large lists.
+ * @param[in]  xt      Top-level xml object
+ * @param[in]  pretty  Set if output is pretty-printed
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @param[in]  autocliext How to handle autocli extensions: 0: ignore 1: follow
+ * @param[in]  chunksz Flush threshold in bytes, 0 for a default
+ * @param[in]  fn      Chunk callback, called with NUL-terminated chunk
+ * @param[in]  arg     Callback argument
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_json2cbuf for the buffering variant
+ */
+int
+clixon_json2stream(cxobj                 *xt,
+                   int                    pretty,
+                   int                    skiptop,
+                   int                    autocliext,
+                   size_t                 chunksz,
+                   clixon_json_stream_cb *fn,
+                   void                  *arg)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cxobj *xc;
+    int    i=0;
+
+    if (fn == NULL){
+        clicon_err(OE_JSON, EINVAL, "fn is NULL");
+        return -1;
+    }
+    if (chunksz == 0)
+        chunksz = 65536;
+    if ((cb = cbuf_pool_get()) == NULL){
+        clicon_err(OE_JSON, errno, "cbuf_pool_get");
+        goto done;
+    }
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
+            if (i++)
+                cprintf(cb, ",");
+            if (xml2json_cbuf1(cb, xc, pretty, autocliext) < 0)
+                goto done;
+            if (cbuf_len(cb) >= chunksz){
+                if ((*fn)(arg, cbuf_get(cb), cbuf_len(cb)) < 0)
+                    goto done;
+                cbuf_reset(cb);
+            }
+        }
+    }
+    else {
+        if (xml2json_cbuf1(cb, xt, pretty, autocliext) < 0)
+            goto done;
+    }
+    if (cbuf_len(cb) > 0 &&
+        (*fn)(arg, cbuf_get(cb), cbuf_len(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_pool_put(cb);
+    return retval;
+}
+
 /*! Translate a vector of xml objects to JSON Cligen buffer.
  * This is done by adding a top pseudo-object, and add the vector as subs,
  * and then not printing the top pseudo-object using the 'flat' option.
@@ -1240,30 +1358,136 @@ xml2json_cbuf_vec(cbuf      *cb,
  *   goto err;
  * @endcode
  */
-int 
-clixon_json2file(FILE             *f, 
+/*! Adapter context from the streaming writer to a clicon_output_cb
+ */
+struct json2file_arg{
+    FILE             *ja_f;
+    clicon_output_cb *ja_fn;
+};
+
+/*! Chunk callback of clixon_json2file, see clixon_json2stream
+ */
+static int
+json2file_chunk(void       *arg,
+                const char *chunk,
+                size_t      len)
+{
+    struct json2file_arg *ja = (struct json2file_arg *)arg;
+
+    (void)len; /* chunk is NUL-terminated */
+    (*ja->ja_fn)(ja->ja_f, "%s", chunk);
+    return 0;
+}
+
+int
+clixon_json2file(FILE             *f,
                  cxobj            *xn,
                  int               pretty,
                  clicon_output_cb *fn,
                  int               skiptop,
                  int               autocliext)
 {
-    int   retval = 1;
-    cbuf *cb = NULL;
+    struct json2file_arg ja;
 
     if (fn == NULL)
         fn = fprintf;
-    if ((cb = cbuf_new()) ==NULL){
-        clicon_err(OE_XML, errno, "cbuf_new");
+    ja.ja_f = f;
+    ja.ja_fn = fn;
+    return clixon_json2stream(xn, pretty, skiptop, autocliext, 0,
+                              json2file_chunk, &ja);
+}
+
+/*! Chunk callback as json2file_chunk but flushes the stream after each chunk
+ *
+ * For interactive consumers (pager, pipe) where the first chunks should be
+ * visible before the full document is rendered.
+ */
+static int
+json2file_chunk_flush(void       *arg,
+                      const char *chunk,
+                      size_t      len)
+{
+    struct json2file_arg *ja = (struct json2file_arg *)arg;
+
+    if (json2file_chunk(arg, chunk, len) < 0)
+        return -1;
+    fflush(ja->ja_f);
+    return 0;
+}
+
+/*! Translate a vector of xml objects to JSON on a file, streamed in chunks
+ *
+ * Streaming variant of xml2json_vec: the vector is serialized one subtree at
+ * a time and written (and flushed) to the file as chunks fill up, instead of
+ * materializing the whole document in a cbuf first. A downstream pager or
+ * pipe reader thereby sees the first entries of a large list immediately.
+ * @param[in]  f       File to print to
+ * @param[in]  vec     Vector of xml objects
+ * @param[in]  veclen  Length of vector
+ * @param[in]  pretty  Set if output is pretty-printed
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @param[in]  fn      File print function (if NULL, use fprintf)
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @note This only works if the vector is uniform, ie same object name.
+ * @see xml2json_cbuf_vec  for the buffering variant
+ */
+int
+clixon_json2file_vec(FILE             *f,
+                     cxobj           **vec,
+                     size_t            veclen,
+                     int               pretty,
+                     int               skiptop,
+                     clicon_output_cb *fn)
+{
+    int                  retval = -1;
+    cxobj               *xp = NULL;
+    int                  i;
+    cxobj               *xc0;
+    cxobj               *xc;
+    cvec                *nsc = NULL;
+    struct json2file_arg ja;
+
+    if (fn == NULL)
+        fn = fprintf;
+    if ((xp = xml_new("xml2json", NULL, CX_ELMNT)) == NULL)
         goto done;
+    /* Make a copy of old and graft it into new top-object
+     * Also copy namespace context */
+    for (i=0; i<veclen; i++){
+        xc0 = vec[i];
+        if (xml_nsctx_node(xc0, &nsc) < 0)
+            goto done;
+        if (skiptop){
+            cxobj *x = NULL;
+            while ((x = xml_child_each(xc0, x, CX_ELMNT)) != NULL) {
+                if ((xc = xml_dup(x)) == NULL)
+                    goto done;
+                xml_addsub(xp, xc);
+                xmlns_set_all(xc, nsc); // ?
+            }
+            cvec_free(nsc);
+        }
+        else {
+            if ((xc = xml_dup(xc0)) == NULL)
+                goto done;
+            xml_addsub(xp, xc);
+            nscache_replace(xc, nsc);
+        }
+        nsc = NULL; /* nsc consumed */
     }
-    if (clixon_json2cbuf(cb, xn, pretty, skiptop, autocliext) < 0)
+    ja.ja_f = f;
+    ja.ja_fn = fn;
+    /* Small chunks: get the head of the document onto the file early */
+    if (clixon_json2stream(xp, pretty, 1, 0, 8192,
+                           json2file_chunk_flush, &ja) < 0)
         goto done;
-    (*fn)(f, "%s", cbuf_get(cb));
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xp)
+        xml_free(xp);
     return retval;
 }
 
@@ -1383,6 +1607,120 @@ json_xmlns_translate(yang_stmt *yspec,
     goto done;
 }
 
+/*! One-pass yang-directed JSON post-processing: translate, bind and decode
+ *
+ * Fuses the three per-node passes run after JSON parsing - module-prefix to
+ * namespace translation, yang binding and identityref value decoding - into a
+ * single recursion, instead of walking the new tree once per pass. Used for
+ * the YB_MODULE and YB_PARENT bindings, ie when the target yang context is
+ * known, such as RESTCONF PUT/POST with a resolved api-path. Keeps the
+ * previous-sibling role model of the bind pass so massive lists still skip
+ * the per-entry namespace resolution and yang lookup.
+ * @param[in]     yspec    Yang spec
+ * @param[in,out] x        XML tree, translated and bound in-line
+ * @param[in]     yb       YB_MODULE or YB_PARENT, children always YB_PARENT
+ * @param[in]     xsibling Already processed sibling with same name/prefix or NULL
+ * @param[out]    xerr     Reason for invalid tree returned as netconf err msg
+ * @retval        1        OK
+ * @retval        0        Invalid, xerr set
+ * @retval       -1        Error
+ * @see json_xmlns_translate, xml_bind_yang0, json2xml_decode  the fused passes
+ */
+static int
+json_trans_bind_decode(yang_stmt *yspec,
+                       cxobj     *x,
+                       yang_bind  yb,
+                       cxobj     *xsibling,
+                       cxobj    **xerr)
+{
+    int           retval = -1;
+    yang_stmt    *ymod;
+    yang_stmt    *y;
+    yang_stmt    *ytype = NULL;
+    char         *namespace;
+    char         *modname;
+    enum rfc_6020 keyword;
+    cxobj        *xc;
+    cxobj        *xc0 = NULL;
+    yang_stmt    *yc0 = NULL;
+    char         *name0 = NULL;
+    char         *prefix0 = NULL;
+    char         *name;
+    char         *prefix;
+    int           ret;
+
+    /* Module prefix to default namespace, see json_xmlns_translate */
+    if ((modname = xml_prefix(x)) != NULL){
+        if (strcmp(modname, "ietf-restconf") == 0)
+            modname = "ietf-netconf";
+        if ((ymod = yang_find_module_by_name(yspec, modname)) == NULL){
+            if (xerr &&
+                netconf_unknown_namespace_xml(xerr, "application",
+                                              modname,
+                                              "No yang module found corresponding to prefix") < 0)
+                goto done;
+            goto fail;
+        }
+        namespace = yang_find_mynamespace(ymod);
+        if (xml_namespace_change(x, namespace, NULL) < 0)
+            goto done;
+    }
+    if ((ret = xml_bind_yang_one(x, yb, yspec, xsibling, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (ret == 2){ /* Under anyxml/anydata: children get namespaces only */
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+            if ((ret = json_xmlns_translate(yspec, xc, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        goto ok;
+    }
+    /* Decode identityref leaf values, see json2xml_decode */
+    if ((y = xml_spec(x)) != NULL){
+        keyword = yang_keyword_get(y);
+        if (keyword == Y_LEAF || keyword == Y_LEAF_LIST){
+            if (yang_type_get(y, NULL, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+                goto done;
+            if (ytype && strcmp(yang_argument_get(ytype), "identityref") == 0){
+                if ((ret = json2xml_decode_identityref(x, y, xerr)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
+        }
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        name = xml_name(xc);
+        prefix = xml_prefix(xc);
+        if (yc0 != NULL &&
+            clicon_strcmp(name0, name) == 0 &&
+            clicon_strcmp(prefix0, prefix) == 0)
+            ret = json_trans_bind_decode(yspec, xc, YB_PARENT, xc0, xerr);
+        else
+            ret = json_trans_bind_decode(yspec, xc, YB_PARENT, NULL, xerr);
+        if (ret < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        xc0 = xc;
+        yc0 = xml_spec(xc);
+        name0 = name;
+        prefix0 = prefix;
+    }
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Parse a string containing JSON and return an XML tree
  *
  * Parsing using yacc according to JSON syntax. Names with <prefix>:<id>
@@ -1452,43 +1790,43 @@ _json_parse(char      *str,
                 goto fail;
             }
         }
+        /* Yang context known: fused single-pass translate/bind/decode,
+         * see json_trans_bind_decode
+         */
+        if (yb == YB_PARENT || yb == YB_MODULE){
+            if ((ret = json_trans_bind_decode(yspec, x, yb, NULL, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            continue;
+        }
         /* Names are split into name/prefix, but now add namespace info */
         if ((ret = json_xmlns_translate(yspec, x, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
-        /* Now assign yang stmts to each XML node 
+        /* Now assign yang stmts to each XML node
          * XXX should be xml_bind_yang0_parent() sometimes.
          */
         switch (yb){
-        case YB_PARENT:
-            if ((ret = xml_bind_yang0(x, yb, yspec, xerr)) < 0)
-                    goto done;
-            if (ret == 0)
-                failed++;
-            break;
         case YB_MODULE_NEXT:
             if ((ret = xml_bind_yang(x, YB_MODULE, yspec, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
             break;
-        case YB_MODULE:
-            if ((ret = xml_bind_yang0(x, yb, yspec, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
         case YB_NONE:
             break;
-        case YB_RPC: 
+        case YB_RPC:
             if ((ret = xml_bind_yang_rpc(x, yspec, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
             break;
+        default:
+            break;
         }
-        /* Now find leafs with identityrefs (+transitive) and translate 
+        /* Now find leafs with identityrefs (+transitive) and translate
          * prefixes in values to XML namespaces */
         if ((ret = json2xml_decode(x, xerr)) < 0)
             goto done;
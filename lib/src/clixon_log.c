@@ -44,6 +44,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <syslog.h>
@@ -76,6 +78,26 @@ static FILE *_logfile = NULL;
 /* Truncate debug strings to this length. 0 means unlimited */
 static int _clixon_log_trunc = 0;
 
+/* Log priority ceiling given to clicon_log_init, used to skip formatting early */
+static int _logupto = LOG_DEBUG;
+
+/* Async log ring: formatted messages are queued here and drained by
+ * clicon_log_flush() from the event loop instead of being written inline.
+ * Head/tail are free-running counters, masked into the ring on access.
+ */
+#define CLICON_LOG_RING_SLOTS  1024 /* Number of buffered messages, power of two */
+#define CLICON_LOG_RING_MSGLEN  512 /* Longer messages are truncated */
+
+struct log_ring_ent{
+    int  le_level;
+    char le_msg[CLICON_LOG_RING_MSGLEN];
+};
+
+static struct log_ring_ent *_log_ring = NULL; /* NULL means synchronous logging */
+static unsigned int         _log_ring_head = 0; /* Next slot to write (producer) */
+static unsigned int         _log_ring_tail = 0; /* Next slot to drain (consumer) */
+static uint64_t             _log_ring_dropped = 0; /* Messages lost to ring overflow */
+
 /*! Initialize system logger.
  *
  * Make syslog(3) calls with specified ident and gates calls of level upto specified level (upto).
@@ -97,6 +119,7 @@ clicon_log_init(char         *ident,
                 int           flags)
 {
     _logflags = flags;
+    _logupto = upto;
     if (flags & CLICON_LOG_SYSLOG){
         if (setlogmask(LOG_UPTO(upto)) < 0)
             /* Cant syslog here */
@@ -109,6 +132,7 @@ clicon_log_init(char         *ident,
 int
 clicon_log_exit(void)
 {
+    clicon_log_async(0); /* flush and free any async ring */
     if (_logfile)
         fclose(_logfile);
     closelog(); /* optional */
@@ -230,17 +254,17 @@ slogtime(void)
 }
 #endif
 
-/*! Make a logging call to syslog (or stderr).
+/*! Write a single message to the configured log destinations
  *
- * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. Thisis OR:d with facility == LOG_USER
+ * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. This is OR:d with facility == LOG_USER
  * @param[in]   msg   Message to print as argv.
  * This is the _only_ place the actual syslog (or stderr) logging is made in clicon,..
  * @note syslog makes its own filtering, but if log to stderr we do it here
- * @see  clicon_debug
+ * @see  clicon_log_str which queues the message instead in async mode
  */
-int
-clicon_log_str(int           level, 
-               char         *msg)
+static int
+log_output(int   level,
+           char *msg)
 {
     if (_logflags & CLICON_LOG_SYSLOG)
         syslog(LOG_MAKEPRI(LOG_USER, level), "%s", msg);
@@ -262,13 +286,131 @@ clicon_log_str(int           level,
         fprintf(_logfile, "%s\n", msg);
         fflush(_logfile);
     }
-    /* Enable this if you want syslog in a stream. But there are problems with 
+    /* Enable this if you want syslog in a stream. But there are problems with
      * recursion
      */
  done:
     return 0;
 }
 
+/*! Check whether a message at this level would reach any log destination
+ *
+ * Cheap gate evaluated before a message is formatted, mirrors the filtering
+ * in log_output and the syslog mask set by clicon_log_init.
+ * @param[in] level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG
+ * @retval    1     Message would be written somewhere
+ * @retval    0     Message would be discarded everywhere
+ */
+static int
+log_would_output(int level)
+{
+    if ((_logflags & CLICON_LOG_SYSLOG) && level <= _logupto)
+        return 1;
+    if ((_logflags & (CLICON_LOG_STDERR|CLICON_LOG_STDOUT|CLICON_LOG_FILE)) &&
+        (_clixon_debug != 0 || level < LOG_DEBUG))
+        return 1;
+    return 0;
+}
+
+/*! Enable or disable asynchronous buffered logging
+ *
+ * When enabled, formatted log messages are queued on a fixed-size ring and
+ * written out by clicon_log_flush(), which the event loop calls before
+ * blocking. This keeps syslog/file writes out of hot paths; when the ring is
+ * full further messages are dropped and counted rather than blocking.
+ * @param[in]  enable  1: buffer messages, 0: flush and return to synchronous
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clicon_log_flush
+ */
+int
+clicon_log_async(int enable)
+{
+    if (enable){
+        if (_log_ring != NULL)
+            return 0;
+        if ((_log_ring = calloc(CLICON_LOG_RING_SLOTS, sizeof(*_log_ring))) == NULL){
+            fprintf(stderr, "calloc: %s\n", strerror(errno)); /* dont use clicon_err here due to recursion */
+            return -1;
+        }
+        _log_ring_head = _log_ring_tail = 0;
+        _log_ring_dropped = 0;
+    }
+    else if (_log_ring != NULL){
+        clicon_log_flush();
+        free(_log_ring);
+        _log_ring = NULL;
+    }
+    return 0;
+}
+
+/*! Drain queued log messages to their destinations
+ *
+ * No-op in synchronous mode. If messages were dropped on ring overflow since
+ * the last flush, a warning with the count is emitted and the counter reset.
+ * @retval  n  Number of messages written
+ * @see clicon_log_async
+ */
+int
+clicon_log_flush(void)
+{
+    struct log_ring_ent *le;
+    char                 buf[64];
+    int                  n = 0;
+
+    if (_log_ring == NULL)
+        return 0;
+    while (_log_ring_tail != _log_ring_head){
+        le = &_log_ring[_log_ring_tail % CLICON_LOG_RING_SLOTS];
+        log_output(le->le_level, le->le_msg);
+        _log_ring_tail++;
+        n++;
+    }
+    if (_log_ring_dropped){
+        snprintf(buf, sizeof(buf), "%" PRIu64 " log messages dropped (ring overflow)",
+                 _log_ring_dropped);
+        log_output(LOG_WARNING, buf);
+        _log_ring_dropped = 0;
+    }
+    return n;
+}
+
+/*! Get number of log messages dropped on ring overflow since the last flush
+ */
+uint64_t
+clicon_log_dropped_get(void)
+{
+    return _log_ring_dropped;
+}
+
+/*! Make a logging call to syslog (or stderr).
+ *
+ * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. Thisis OR:d with facility == LOG_USER
+ * @param[in]   msg   Message to print as argv.
+ * In async mode the message is queued and written by the next clicon_log_flush
+ * @see  clicon_debug
+ */
+int
+clicon_log_str(int           level,
+               char         *msg)
+{
+    struct log_ring_ent *le;
+
+    if (_log_ring != NULL){
+        if (_log_ring_head - _log_ring_tail >= CLICON_LOG_RING_SLOTS){
+            _log_ring_dropped++;
+            return 0;
+        }
+        le = &_log_ring[_log_ring_head % CLICON_LOG_RING_SLOTS];
+        le->le_level = level;
+        strncpy(le->le_msg, msg, CLICON_LOG_RING_MSGLEN-1);
+        le->le_msg[CLICON_LOG_RING_MSGLEN-1] = '\0';
+        _log_ring_head++;
+        return 0;
+    }
+    return log_output(level, msg);
+}
+
 /*! Make a logging call to syslog using variable arg syntax.
  *
  * @param[in]   level    log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. This 
@@ -290,6 +432,8 @@ clicon_log(int         level,
     int     retval = -1;
     size_t  trunc;
 
+    if (!log_would_output(level)) /* skip formatting if discarded everywhere */
+        return 0;
     /* first round: compute length of debug message */
     va_start(args, format);
     len = vsnprintf(NULL, 0, format, args);
@@ -386,6 +530,8 @@ clicon_debug(int         dbglevel,
     
     if (dbglevel > clicon_debug_get()) /* compare debug level with global variable */
         return 0;
+    if (!log_would_output(LOG_DEBUG)) /* skip formatting if discarded everywhere */
+        return 0;
     /* first round: compute length of debug message */
     va_start(args, format);
     len = vsnprintf(NULL, 0, format, args);
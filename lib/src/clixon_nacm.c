@@ -78,7 +78,103 @@
 /* NACM namespace for use with xml namespace contexts and xpath */
 #define NACM_NS "urn:ietf:params:xml:ns:yang:ietf-netconf-acm"
 
-/*! Match nacm access operations according to RFC8341 3.4.4.  
+/*! Process-wide cache of resolved user group memberships
+ *
+ * Maps username to a cvec of group names, so the per-request xpath scan over
+ * all group entries runs once per user instead of once per rpc. Values are
+ * name strings, not nodes in the NACM tree, so entries are valid for any
+ * instance of the same NACM config. Invalidated together with the access
+ * decision cache, see nacm_decision_cache_invalidate.
+ */
+static clicon_hash_t *_nacm_group_cache = NULL;
+
+/*! Resolve the group names a user is member of, cached across requests
+ * @param[in]  xnacm    NACM xml tree
+ * @param[in]  nsc      Namespace context with NACM default namespace
+ * @param[in]  username User making access
+ * @param[out] groups   cvec of group names, cache-owned, do not free
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @note RFC8341 defines no wildcard user-name, matching is exact
+ */
+static int
+nacm_user_groups(cxobj  *xnacm,
+                 cvec   *nsc,
+                 char   *username,
+                 cvec  **groups)
+{
+    int     retval = -1;
+    cvec   *cvv = NULL;
+    void   *p;
+    size_t  len;
+    cxobj **gvec = NULL;
+    size_t  glen;
+    char   *gname;
+    int     i;
+
+    if (_nacm_group_cache == NULL &&
+        (_nacm_group_cache = clicon_hash_init()) == NULL)
+        goto done;
+    if ((p = clicon_hash_value(_nacm_group_cache, username, &len)) != NULL){
+        *groups = *(cvec**)p;
+        retval = 0;
+        goto done;
+    }
+    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+        goto done;
+    if ((cvv = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    for (i=0; i<glen; i++){
+        if ((gname = xml_find_body(gvec[i], "name")) == NULL)
+            continue;
+        if (cvec_add_string(cvv, NULL, gname) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    if (clicon_hash_add(_nacm_group_cache, username, &cvv, sizeof(cvv)) == NULL)
+        goto done;
+    *groups = cvv;
+    cvv = NULL;
+    retval = 0;
+  done:
+    if (cvv)
+        cvec_free(cvv);
+    if (gvec)
+        free(gvec);
+    return retval;
+}
+
+/*! Free all cached group membership cvecs and the cache itself
+ * @retval  0  OK
+ */
+static int
+nacm_group_cache_free(void)
+{
+    char  **keys = NULL;
+    size_t  klen = 0;
+    void   *p;
+    size_t  len;
+    int     i;
+
+    if (_nacm_group_cache == NULL)
+        return 0;
+    if (clicon_hash_keys(_nacm_group_cache, &keys, &klen) == 0){
+        for (i=0; i<klen; i++){
+            if ((p = clicon_hash_value(_nacm_group_cache, keys[i], &len)) != NULL)
+                cvec_free(*(cvec**)p);
+        }
+    }
+    if (keys)
+        free(keys);
+    clicon_hash_free(_nacm_group_cache);
+    _nacm_group_cache = NULL;
+    return 0;
+}
+
+/*! Match nacm access operations according to RFC8341 3.4.4.
  * Incoming RPC Message Validation Step 7 (c)
  *  The rule's "access-operations" leaf has the "exec" bit set or
  *  has the special value "*".
@@ -187,8 +283,7 @@ nacm_rpc(char         *rpc,
 {
     int     retval = -1;
     cxobj  *xrule;
-    cxobj **gvec = NULL; /* groups */
-    size_t  glen;
+    cvec   *groups = NULL; /* group names, cache-owned */
     cxobj  *rlist;
     cxobj **rlistvec = NULL; /* rule-list */
     size_t  rlistlen;
@@ -218,10 +313,10 @@ nacm_rpc(char         *rpc,
         goto step10;
 
     /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    if (nacm_user_groups(xnacm, nsc, username, &groups) < 0)
         goto done;
     /* 5. If no groups are found, continue with step 10. */
-    if (glen == 0)
+    if (cvec_len(groups) == 0)
         goto step10;
     /* 6. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
@@ -232,16 +327,16 @@ nacm_rpc(char         *rpc,
     for (i=0; i<rlistlen; i++){
         rlist = rlistvec[i];
         /* Loop through user's group to find match in this rule-list */
-        for (j=0; j<glen; j++){
-            gname = xml_find_body(gvec[j], "name");
+        for (j=0; j<cvec_len(groups); j++){
+            gname = cv_string_get(cvec_i(groups, j));
             if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
                 break; /* found */
         }
-        if (j==glen) /* not found */
+        if (j==cvec_len(groups)) /* not found */
             continue;
         /* 7. For each rule-list entry found, process all rules, in order,
            until a rule that matches the requested access operation is
-           found. 
+           found.
         */
         if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
             goto done;
@@ -298,8 +393,6 @@ nacm_rpc(char         *rpc,
     clicon_debug(1, "%s retval:%d (0:deny 1:permit)", __FUNCTION__, retval);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
     if (rlistvec)
         free(rlistvec);
     if (rvec)
@@ -311,11 +404,25 @@ nacm_rpc(char         *rpc,
     goto done;
 }
 
-/* Local struct for keeping preparation/compiled data in NACM data path code */
+/* Rule action, pre-decoded from the rule's action leaf */
+enum nacm_action{
+    NACM_ACTION_NONE = 0,
+    NACM_ACTION_PERMIT,
+    NACM_ACTION_DENY
+};
+
+/* Local struct for keeping preparation/compiled data in NACM data path code
+ * The rule leafs consulted for every node access decision are decoded once
+ * here so that the per-node matching loops do not re-walk the rule XML.
+ */
 struct prepvec{
-    qelem_t       pv_q;
-    cxobj        *pv_xrule;
-    clixon_xvec  *pv_xpathvec;
+    qelem_t          pv_q;
+    cxobj           *pv_xrule;
+    clixon_xvec     *pv_xpathvec;
+    char            *pv_module;   /* Cached module-name leaf, NULL never matches */
+    int              pv_modwild;  /* module-name is "*" */
+    enum nacm_action pv_action;   /* Pre-decoded action leaf */
+    int              pv_haspath;  /* Rule has a path leaf */
 };
 typedef struct prepvec prepvec;
 
@@ -340,6 +447,7 @@ prepvec_add(prepvec  **pv_listp,
             cxobj     *xrule)
 {
     prepvec *pv;
+    char    *action;
 
     if ((pv = malloc(sizeof(*pv))) == NULL){
         clicon_err(OE_UNIX, errno, "malloc");
@@ -348,11 +456,148 @@ prepvec_add(prepvec  **pv_listp,
     memset(pv, 0, sizeof(*pv));
     ADDQ(pv, *pv_listp);
     pv->pv_xrule = xrule;
+    /* Decode the rule leafs once, the match loops only read these fields */
+    if ((pv->pv_module = xml_find_body(xrule, "module-name")) != NULL)
+        pv->pv_modwild = (strcmp(pv->pv_module, "*") == 0);
+    if ((action = xml_find_body(xrule, "action")) != NULL){
+        if (strcmp(action, "deny") == 0)
+            pv->pv_action = NACM_ACTION_DENY;
+        else
+            pv->pv_action = NACM_ACTION_PERMIT;
+    }
+    pv->pv_haspath = (xml_find_type(xrule, NULL, "path", CX_ELMNT) != NULL);
     if ((pv->pv_xpathvec = clixon_xvec_new()) == NULL)
         return NULL;
     return pv;
 }
 
+/*! Process-wide cache of per-node NACM access decisions
+ *
+ * Keyed by username, access operation and the yang_stmt pointer of the node,
+ * so repeated gets by the same user re-use the decision for each schema node
+ * instead of re-running the rule loop. Only used when no applicable rule has
+ * an instance path, since path rules match specific instances, not schema
+ * nodes. Invalidated on commit of NACM config, see candidate_commit.
+ * @see _regex_cache  same process-wide cache idiom
+ */
+static clicon_hash_t *_nacm_dec_cache = NULL;
+
+/*! Look up a cached access decision for a (user, access, yang node) triple
+ * @param[in]  cbkey    Scratch buffer for key formatting
+ * @param[in]  username User making access
+ * @param[in]  access   NACM access operation
+ * @param[in]  ys       Yang spec of the node
+ * @param[out] dec      Cached decision
+ * @retval     1        Hit, dec set
+ * @retval     0        Miss
+ */
+static int
+nacm_dec_cache_lookup(cbuf             *cbkey,
+                      char             *username,
+                      enum nacm_access  access,
+                      yang_stmt        *ys,
+                      int              *dec)
+{
+    void   *p;
+    size_t  len;
+
+    if (_nacm_dec_cache == NULL)
+        return 0;
+    cbuf_reset(cbkey);
+    cprintf(cbkey, "%s;%d;%p", username, access, ys);
+    if ((p = clicon_hash_value(_nacm_dec_cache, cbuf_get(cbkey), &len)) == NULL)
+        return 0;
+    *dec = *(int*)p;
+    return 1;
+}
+
+/*! Store an access decision for a (user, access, yang node) triple
+ * @param[in]  cbkey    Scratch buffer for key formatting
+ * @param[in]  username User making access
+ * @param[in]  access   NACM access operation
+ * @param[in]  ys       Yang spec of the node
+ * @param[in]  dec      Decision to cache
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_dec_cache_store(cbuf             *cbkey,
+                     char             *username,
+                     enum nacm_access  access,
+                     yang_stmt        *ys,
+                     int               dec)
+{
+    if (_nacm_dec_cache == NULL &&
+        (_nacm_dec_cache = clicon_hash_init()) == NULL)
+        return -1;
+    cbuf_reset(cbkey);
+    cprintf(cbkey, "%s;%d;%p", username, access, ys);
+    if (clicon_hash_add(_nacm_dec_cache, cbuf_get(cbkey), &dec, sizeof(dec)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Drop all cached NACM access decisions and group memberships
+ * Called when the NACM configuration may have changed, eg at commit.
+ * @retval  0  OK
+ */
+int
+nacm_decision_cache_invalidate(void)
+{
+    if (_nacm_dec_cache != NULL){
+        clicon_hash_free(_nacm_dec_cache);
+        _nacm_dec_cache = NULL;
+    }
+    nacm_group_cache_free();
+    return 0;
+}
+
+/*! Check if schema-keyed decision caching is sound for a compiled rule list
+ * Rules with an instance path match specific instances, not schema nodes,
+ * so any such rule disables the decision cache for the request.
+ * @param[in]  pv_list  Compiled rule list
+ * @retval     1        Cacheable
+ * @retval     0        Not cacheable
+ */
+static int
+nacm_dec_cacheable(prepvec *pv_list)
+{
+    prepvec *pv;
+
+    if ((pv = pv_list) != NULL){
+        do {
+            if (pv->pv_haspath)
+                return 0;
+            pv = NEXTQ(prepvec *, pv);
+        } while (pv && pv != pv_list);
+    }
+    return 1;
+}
+
+/*! Check if any rule in a compiled rule list carries a given action
+ * Used to label whole rule sets: if no applicable rule can deny (or permit),
+ * the per-node traversal can be short-circuited for the entire request.
+ * @param[in]  pv_list  Compiled rule list
+ * @param[in]  action   Action to look for
+ * @retval     1        Some rule has the action
+ * @retval     0        No rule has the action
+ */
+static int
+nacm_rules_have_action(prepvec          *pv_list,
+                       enum nacm_action  action)
+{
+    prepvec *pv;
+
+    if ((pv = pv_list) != NULL){
+        do {
+            if (pv->pv_action == action)
+                return 1;
+            pv = NEXTQ(prepvec *, pv);
+        } while (pv && pv != pv_list);
+    }
+    return 0;
+}
+
 /*! Prepare datastructures before running through XML tree
  * Save rules in a "cache"
  * These rules match:
@@ -364,8 +609,7 @@ static int
 nacm_datanode_prepare(clicon_handle     h,
                       cxobj            *xt,
                       enum nacm_access  access,
-                      cxobj           **gvec,
-                      size_t            glen,
+                      cvec             *groups,
                       cxobj           **rlistvec,
                       size_t            rlistlen,
                       cvec             *nsc,
@@ -395,12 +639,12 @@ nacm_datanode_prepare(clicon_handle     h,
     for (i=0; i<rlistlen; i++){         /* Loop through rule list */
         rlist = rlistvec[i];
         /* Loop through user's group to find match in this rule-list */
-        for (j=0; j<glen; j++){
-            gname = xml_find_body(gvec[j], "name");
+        for (j=0; j<cvec_len(groups); j++){
+            gname = cv_string_get(cvec_i(groups, j));
             if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
                 break; /* found */
         }
-        if (j==glen) /* not found */
+        if (j==cvec_len(groups)) /* not found */
             continue;
         /* 6. For each rule-list entry found, process all rules, in order,
            until a rule that matches the requested access operation is
@@ -518,53 +762,45 @@ nacm_datanode_prepare(clicon_handle     h,
 
 /*! Match specific rule to specific requested node
  * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  xp       Xpath match
- * @param[in]  yspec    YANG spec
+ * @param[in]  modname  Name of YANG module where xn is defined, NULL if none
+ * @param[in]  pv       Compiled NACM rule
  * @retval -1  Error
  * @retval  0  OK and rule does not match
  * @retval  1  OK and rule matches deny
  * @retval  2  OK and rule matches permit
  */
 static int
-nacm_data_write_xrule_xml(cxobj       *xn,
-                          cxobj       *xrule,
-                          clixon_xvec *xpathvec,
-                          yang_stmt   *yspec)
+nacm_data_write_xrule_xml(cxobj   *xn,
+                          char    *modname,
+                          prepvec *pv)
 {
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    char      *action;
-    cxobj     *xp;
-    int        i;
+    int    retval = -1;
+    cxobj *xp;
+    int    i;
 
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
+    if (pv->pv_module == NULL)
         goto nomatch;
     /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
+     * the YANG module where the requested data node is defined.
      */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        /* ymod is NULL (xn is "config") Can this breach the NACM rule? */
-        if (ymod && strcmp(yang_argument_get(ymod), module_pattern) != 0)
+    if (!pv->pv_modwild){
+        /* modname is NULL (xn is "config") Can this breach the NACM rule? */
+        if (modname && strcmp(modname, pv->pv_module) != 0)
             goto nomatch;
     }
-    action = xml_find_body(xrule, "action"); /* mandatory */
     /*  6b) Either (1) the rule does not have a "rule-type" defined or
         (2) the "rule-type" is "data-node" and the "path" matches the
-        Requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (strcmp(action, "deny")==0)
+        Requested data node, action node, or notification node. */
+    if (!pv->pv_haspath){
+        if (pv->pv_action == NACM_ACTION_DENY)
             goto deny;
         goto permit;
     }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
+    for (i=0; i<clixon_xvec_len(pv->pv_xpathvec); i++){
+        xp = clixon_xvec_i(pv->pv_xpathvec, i);
         /* Check if ancestor is xp (for every xpathvec?) */
         if (xn == xp || xml_isancestor(xn, xp)){
-            if (strcmp(action, "deny")==0)
+            if (pv->pv_action == NACM_ACTION_DENY)
                 goto deny;
             goto permit;
         }
@@ -588,7 +824,11 @@ nacm_data_write_xrule_xml(cxobj       *xn,
  * @param[in]  rulevec   Precomputed rules that apply to this user group
  * @param[in]  xpathvec  Precomputed xpath results that apply to this XML tree
  * @param[in]  defpermit 0 if default deny, 1 is default permit
+ * @param[in]  cacheable Decisions may use the schema-keyed decision cache
+ * @param[in]  username  User making access, key in decision cache
+ * @param[in]  access    NACM access operation, key in decision cache
  * @param[in]  yspec     YANG spec
+ * @param[in]  cbkey     Scratch buffer for decision cache keys, NULL if not cacheable
  * @param[out] cbret     Error message if retval = 0
  * @retval     1         OK and accept
  * @retval     0         Deny and cbret set
@@ -599,40 +839,71 @@ nacm_data_write_xrule_xml(cxobj       *xn,
  * deny:    Send error message
  */
 static int
-nacm_datanode_write_recurse(clicon_handle h,
-                            cxobj        *xn,
-                            prepvec      *pv_list,
-                            int           defpermit,
-                            yang_stmt    *yspec,
-                            cbuf         *cbret)
+nacm_datanode_write_recurse(clicon_handle    h,
+                            cxobj           *xn,
+                            prepvec         *pv_list,
+                            int              defpermit,
+                            int              cacheable,
+                            char            *username,
+                            enum nacm_access access,
+                            yang_stmt       *yspec,
+                            cbuf            *cbkey,
+                            cbuf            *cbret)
 {
-    int       retval = -1;
-    cxobj   *x;
-    int      ret = 0;
-    prepvec *pv;
-    
+    int        retval = -1;
+    cxobj     *x;
+    int        ret = 0;
+    prepvec   *pv;
+    yang_stmt *ymod;
+    yang_stmt *ys;
+    char      *modname = NULL;
+    int        hit = 0;
+
     pv = pv_list;
     if (pv){
-        do {
-            /* return values: -1:Error /0:no match /1: deny /2: permit
-             */
-            if ((ret = nacm_data_write_xrule_xml(xn, pv->pv_xrule, pv->pv_xpathvec, yspec)) < 0) 
-                goto done;
-            switch(ret){
-            case 0: /* No match, continue with next rule */
-                break;
-            case 1: /* Match and deny: break all traversal and send error back to client */
+        ys = xml_spec(xn);
+        if (cacheable && ys)
+            hit = nacm_dec_cache_lookup(cbkey, username, access, ys, &ret);
+        if (hit){
+            if (ret == 1){ /* Cached deny */
                 if (netconf_access_denied(cbret, "application", "access denied") < 0)
                     goto done;
                 goto deny;
-                break;
-            case 2: /* Match and permit: break rule processing but continue recursion */
-                break;
             }
-            if (ret == 2)
-                break;
-            pv = NEXTQ(prepvec *, pv);
-        } while (pv && pv != pv_list);
+        }
+        else {
+            /* Resolve the node's module once, checked against each rule below */
+            if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+                goto done;
+            if (ymod)
+                modname = yang_argument_get(ymod);
+            do {
+                /* return values: -1:Error /0:no match /1: deny /2: permit
+                 */
+                if ((ret = nacm_data_write_xrule_xml(xn, modname, pv)) < 0)
+                    goto done;
+                switch(ret){
+                case 0: /* No match, continue with next rule */
+                    break;
+                case 1: /* Match and deny: break all traversal and send error back to client */
+                    if (cacheable && ys &&
+                        nacm_dec_cache_store(cbkey, username, access, ys, ret) < 0)
+                        goto done;
+                    if (netconf_access_denied(cbret, "application", "access denied") < 0)
+                        goto done;
+                    goto deny;
+                    break;
+                case 2: /* Match and permit: break rule processing but continue recursion */
+                    break;
+                }
+                if (ret == 2)
+                    break;
+                pv = NEXTQ(prepvec *, pv);
+            } while (pv && pv != pv_list);
+            if (cacheable && ys &&
+                nacm_dec_cache_store(cbkey, username, access, ys, ret) < 0)
+                goto done;
+        }
     }
     /* If no rule match, check default rule: if deny then break traversal and send error */
     if (ret == 0 && !defpermit){
@@ -644,7 +915,8 @@ nacm_datanode_write_recurse(clicon_handle h,
     x = NULL;   /* Recursively check XML */
     while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
         if ((ret = nacm_datanode_write_recurse(h, x, pv_list,
-                                               defpermit, yspec, cbret)) < 0)
+                                               defpermit, cacheable, username,
+                                               access, yspec, cbkey, cbret)) < 0)
             goto done;
         if (ret == 0)
             goto deny;
@@ -684,8 +956,7 @@ nacm_datanode_write(clicon_handle    h,
                     cbuf            *cbret)
 {
     int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
+    cvec           *groups = NULL; /* group names, cache-owned */
     cxobj         **rlistvec = NULL; /* rule-list */
     size_t          rlistlen;
     cxobj         **rvec = NULL; /* rules */
@@ -693,6 +964,8 @@ nacm_datanode_write(clicon_handle    h,
     cvec           *nsc = NULL;
     int             ret;
     prepvec        *pv_list = NULL;
+    int             cacheable = 0;
+    cbuf           *cbkey = NULL;
 
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
@@ -712,10 +985,10 @@ nacm_datanode_write(clicon_handle    h,
     if (username == NULL)
         goto step9;
     /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    if (nacm_user_groups(xnacm, nsc, username, &groups) < 0)
         goto done;
     /* 4. If no groups are found, continue with step 9. */
-    if (glen == 0)
+    if (cvec_len(groups) == 0)
         goto step9;
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
@@ -723,15 +996,27 @@ nacm_datanode_write(clicon_handle    h,
         entry. */
     if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
         goto done;
-    /* First run through rules and cache rules as well as lookup objects in xt. 
+    /* First run through rules and cache rules as well as lookup objects in xt.
      */
-    if (nacm_datanode_prepare(h, xt, access, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(h, xt, access, groups, rlistvec, rlistlen, nsc, &pv_list) < 0)
+        goto done;
+    /* If neither the applicable rules nor the default can deny anything,
+     * access is permitted without traversing the request */
+    if (strcmp(write_default, "deny") != 0 &&
+        !nacm_rules_have_action(pv_list, NACM_ACTION_DENY))
+        goto permit;
+    /* Schema-keyed decision cache only sound without instance path rules */
+    if ((cacheable = nacm_dec_cacheable(pv_list)) != 0 &&
+        (cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
+    }
     /* Then recursivelyy traverse all requested nodes */
     if ((ret = nacm_datanode_write_recurse(h, xreq, pv_list,
                                            strcmp(write_default, "deny"),
+                                           cacheable, username, access,
                                            clicon_dbspec_yang(h),
-                                           cbret)) < 0)
+                                           cbkey, cbret)) < 0)
         goto done;
     if (ret == 0) /* deny */
         goto deny;
@@ -760,12 +1045,12 @@ nacm_datanode_write(clicon_handle    h,
     retval = 1;
  done:
     clicon_debug(1, "%s retval:%d (0:deny 1:permit)", __FUNCTION__, retval);
+    if (cbkey)
+        cbuf_free(cbkey);
     if (pv_list)
         prepvec_free(pv_list);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
     if (rlistvec)
         free(rlistvec);
     if (rvec)
@@ -781,34 +1066,11 @@ nacm_datanode_write(clicon_handle    h,
  * Datanode read
  */
 
-/*! Perform NACM action: mark if permit, del if deny
- * @param[in] xrule    NACM rule
- * @param[in] xn       XML node (requested node)
- * @retval    -1       Error
- * @retval    0        OK
- */
-static int
-nacm_data_read_action(cxobj *xrule,
-                      cxobj *xn)
-{
-    int   retval = -1;
-    char *action;
-
-    if ((action = xml_find_body(xrule, "action")) != NULL){
-        if (strcmp(action, "deny")==0)
-            xml_flag_set(xn, XML_FLAG_DEL);
-        else if (strcmp(action, "permit")==0)
-            xml_flag_set(xn, XML_FLAG_MARK);
-    }
-    retval = 0;
-    //done:
-    return retval;
-}
-
 /*! Match specific rule to specific requested node
+ * On match, perform NACM action: mark if permit, del if deny
  * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  yspec    YANG spec
+ * @param[in]  modname  Name of YANG module where xn is defined, NULL if none
+ * @param[in]  pv       Compiled NACM rule
  * @retval -1  Error
  * @retval  0  OK and rule does not match
  * @retval  1  OK and rule matches
@@ -819,60 +1081,56 @@ nacm_data_read_action(cxobj *xrule,
  *     mark all permit rules and ancestors, remove everything else
  */
 static int
-nacm_data_read_xrule_xml(cxobj        *xn,
-                         cxobj        *xrule,
-                         clixon_xvec  *xpathvec,
-                         yang_stmt    *yspec)
+nacm_data_read_xrule_xml(cxobj   *xn,
+                         char    *modname,
+                         prepvec *pv)
 {
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    cxobj     *xp;
-    int        i;
-    
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
+    int    retval = -1;
+    cxobj *xp;
+    int    i;
+
+    if (pv->pv_module == NULL)
         goto nomatch;
     /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
+     * the YANG module where the requested data node is defined.
      */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        if (strcmp(yang_argument_get(ymod), module_pattern) != 0)
+    if (!pv->pv_modwild){
+        if (modname == NULL || strcmp(modname, pv->pv_module) != 0)
             goto nomatch;
     }
     /*  6b) Either (1) the rule does not have a "rule-type" defined or
         (2) the "rule-type" is "data-node" and the "path" matches the
-        requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (nacm_data_read_action(xrule, xn) < 0)
-            goto done;
+        requested data node, action node, or notification node. */
+    if (!pv->pv_haspath)
         goto match;
-    }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
+    for (i=0; i<clixon_xvec_len(pv->pv_xpathvec); i++){
+        xp = clixon_xvec_i(pv->pv_xpathvec, i);
         /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (nacm_data_read_action(xrule, xn) < 0)
-                goto done;
+        if (xn == xp || xml_isancestor(xn, xp))
             goto match;
-        }
     }
  nomatch:
     retval = 0;
- done:
+    // done:
     return retval;
  match:
+    if (pv->pv_action == NACM_ACTION_DENY)
+        xml_flag_set(xn, XML_FLAG_DEL);
+    else if (pv->pv_action == NACM_ACTION_PERMIT)
+        xml_flag_set(xn, XML_FLAG_MARK);
     retval = 1; /* match */
-    goto done;
+    return retval;
 }
 
 /*! Recursive check for NACM read rules among all XML nodes
- * @param[in]  h        Clicon handle
- * @param[in]  xn       XML node (requested node)
- * @param[in]  rulevec  Precomputed rules that apply to this user group
- * @param[in]  xpathvec Precomputed xpath results that apply to this XML tree
- * @param[in]  yspec    YANG spec
+ * @param[in]  h         Clicon handle
+ * @param[in]  xn        XML node (requested node)
+ * @param[in]  rulevec   Precomputed rules that apply to this user group
+ * @param[in]  xpathvec  Precomputed xpath results that apply to this XML tree
+ * @param[in]  yspec     YANG spec
+ * @param[in]  cacheable Decisions may use the schema-keyed decision cache
+ * @param[in]  username  User making access, key in decision cache
+ * @param[in]  cbkey     Scratch buffer for decision cache keys, NULL if not cacheable
  * @retval  0  OK
  * @retval -1  Error
  */
@@ -880,27 +1138,58 @@ static int
 nacm_datanode_read_recurse(clicon_handle h,
                            cxobj        *xn,
                            prepvec      *pv_list,
-                           yang_stmt    *yspec)
+                           yang_stmt    *yspec,
+                           int           cacheable,
+                           char         *username,
+                           cbuf         *cbkey)
 {
-    int      retval = -1;
-    cxobj   *x;
-    cxobj   *xprev;
-    int      ret;
-    prepvec *pv;
-    
-    if (xml_spec(xn)){ /* Check this node */
+    int        retval = -1;
+    cxobj     *x;
+    cxobj     *xprev;
+    int        ret;
+    prepvec   *pv;
+    yang_stmt *ymod;
+    yang_stmt *ys;
+    char      *modname = NULL;
+    int        dec;
+    int        hit = 0;
+
+    if ((ys = xml_spec(xn)) != NULL){ /* Check this node */
         pv = pv_list;
         if (pv){
-            do {
-                if ((ret = nacm_data_read_xrule_xml(xn,
-                                                    pv->pv_xrule,
-                                                    pv->pv_xpathvec,
-                                                    yspec)) < 0) 
-                    goto done;      
-                if (ret == 1)
-                    break; /* stop at first match */                
-                pv = NEXTQ(prepvec *, pv);
-            } while (pv && pv != pv_list);
+            if (cacheable)
+                hit = nacm_dec_cache_lookup(cbkey, username, NACM_READ, ys, &dec);
+            if (hit){
+                if (dec == NACM_ACTION_DENY)
+                    xml_flag_set(xn, XML_FLAG_DEL);
+                else if (dec == NACM_ACTION_PERMIT)
+                    xml_flag_set(xn, XML_FLAG_MARK);
+            }
+            else {
+                /* Resolve the node's module once, checked against each rule below */
+                if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+                    goto done;
+                if (ymod)
+                    modname = yang_argument_get(ymod);
+                do {
+                    if ((ret = nacm_data_read_xrule_xml(xn, modname, pv)) < 0)
+                        goto done;
+                    if (ret == 1)
+                        break; /* stop at first match */
+                    pv = NEXTQ(prepvec *, pv);
+                } while (pv && pv != pv_list);
+                if (cacheable){
+                    /* Derive the decision from the flags set by the matched rule */
+                    if (xml_flag(xn, XML_FLAG_DEL))
+                        dec = NACM_ACTION_DENY;
+                    else if (xml_flag(xn, XML_FLAG_MARK))
+                        dec = NACM_ACTION_PERMIT;
+                    else
+                        dec = NACM_ACTION_NONE;
+                    if (nacm_dec_cache_store(cbkey, username, NACM_READ, ys, dec) < 0)
+                        goto done;
+                }
+            }
         }
 
 #if 0 /* 6(A) in algorithm 
@@ -916,7 +1205,8 @@ nacm_datanode_read_recurse(clicon_handle h,
         x = NULL;       /* Recursively check XML */
         xprev = NULL;
         while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-            if (nacm_datanode_read_recurse(h, x, pv_list, yspec) < 0)
+            if (nacm_datanode_read_recurse(h, x, pv_list, yspec,
+                                           cacheable, username, cbkey) < 0)
                 goto done;
             /* check for delayed remove */
             if (xml_flag(x, XML_FLAG_DEL)){
@@ -988,15 +1278,16 @@ nacm_datanode_read(clicon_handle h,
                    cxobj        *xnacm)
 {
     int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
+    cvec           *groups = NULL; /* group names, cache-owned */
     cxobj         **rlistvec = NULL; /* rule-list */
     size_t          rlistlen;
     int             i;
     char           *read_default = NULL;
     cvec           *nsc = NULL;
     prepvec        *pv_list = NULL;
-    
+    int             cacheable = 0;
+    cbuf           *cbkey = NULL;
+
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
         goto done;
@@ -1008,9 +1299,9 @@ nacm_datanode_read(clicon_handle h,
     if (username == NULL)
         goto step9;
     /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    if (nacm_user_groups(xnacm, nsc, username, &groups) < 0)
         goto done;
-    /* 4. If no groups are found (glen=0), continue and check read-default 
+    /* 4. If no groups are found, continue and check read-default
           in step 11. */
     /* 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
@@ -1026,10 +1317,31 @@ nacm_datanode_read(clicon_handle h,
     /* First run through rules and cache rules as well as lookup objects in xt. 
      * DANGER: objects could be stale if they are removed?
      */
-    if (nacm_datanode_prepare(h, xt, NACM_READ, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_datanode_prepare(h, xt, NACM_READ, groups, rlistvec, rlistlen, nsc, &pv_list) < 0)
+        goto done;
+    /* Whole-request short-circuits from rule-set labels computed at prepare:
+     * if neither the applicable rules nor the default can deny anything,
+     * filtering cannot change the tree and the per-node traversal is skipped;
+     * if nothing can be permitted, everything is pruned directly.
+     */
+    if (strcmp(read_default, "deny") != 0){
+        if (!nacm_rules_have_action(pv_list, NACM_ACTION_DENY))
+            goto ok;
+    }
+    else if (!nacm_rules_have_action(pv_list, NACM_ACTION_PERMIT)){
+        if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Schema-keyed decision cache only sound without instance path rules */
+    if ((cacheable = nacm_dec_cacheable(pv_list)) != 0 &&
+        (cbkey = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
+    }
     /* Then recursivelyy traverse all nodes */
-    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h)) < 0)
+    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h),
+                                   cacheable, username, cbkey) < 0)
         goto done;
 #if 1
     /* Step 8(B) above:
@@ -1060,12 +1372,12 @@ nacm_datanode_read(clicon_handle h,
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (cbkey)
+        cbuf_free(cbkey);
     if (pv_list)
         prepvec_free(pv_list);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
     if (rlistvec)
         free(rlistvec);
     return retval;
@@ -1761,14 +1761,32 @@ netconf_content_int2str(netconf_content nr)
  */
 int
 netconf_capabilites(clicon_handle h,
-                    cbuf         *cb)
+                    cbuf         *cb0)
 {
     int        retval = -1;
     char      *encstr = NULL;
     char      *ietf_yang_library_revision;
     yang_stmt *yspec = clicon_dbspec_yang(h);
     char      *module_set_id;
+    cbuf      *cb = NULL;
+    char      *cached = NULL;
+    void      *capspec = NULL;
 
+    /* The rendered capability list only changes with the yang spec. Cache it
+     * on the handle keyed by spec identity: a rebuilt spec (new pointer)
+     * invalidates the cache. Saves re-rendering per hello / monitoring get.
+     */
+    if (clicon_ptr_get(h, "netconf-capabilities-yspec", &capspec) == 0 &&
+        capspec == (void*)yspec &&
+        clicon_data_get(h, "netconf-capabilities", &cached) == 0 &&
+        cached != NULL){
+        cbuf_append_str(cb0, cached);
+        return 0;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
     module_set_id = clicon_option_str(h, "CLICON_MODULE_SET_ID");
     cprintf(cb, "<capabilities>");
     if (clicon_option_int(h, "CLICON_NETCONF_BASE_CAPABILITY") > 0){
@@ -1819,8 +1837,18 @@ netconf_capabilites(clicon_handle h,
     if (if_feature(yspec, "ietf-netconf", "confirmed-commit"))
         cprintf(cb, "<capability>urn:ietf:params:netconf:capability:confirmed-commit:1.1</capability>");
     cprintf(cb, "</capabilities>");
+    if (clicon_data_set(h, "netconf-capabilities", cbuf_get(cb)) < 0)
+        goto done;
+    if (clicon_ptr_set(h, "netconf-capabilities-yspec", yspec) < 0)
+        goto done;
+    if (cbuf_append_buf(cb0, cbuf_get(cb), cbuf_len(cb)) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     if (encstr)
         free(encstr);
     return retval;
@@ -108,6 +108,27 @@ get_sock(int  usock,
 
 #endif /* HAVE_SETNS */
 
+/* If set, server sockets are created with SO_REUSEPORT so that several worker
+ * processes can bind the same address and the kernel balances accepted
+ * connections between them, @see clixon_netns_reuseport_set
+ */
+static int _socket_reuseport = 0;
+
+/*! Enable SO_REUSEPORT on subsequently created server sockets
+ *
+ * Lets several processes bind the same address/port, each with its own accept
+ * queue. Used by multi-process daemons where every worker binds its own
+ * listen socket. A no-op on platforms without SO_REUSEPORT.
+ * @param[in]  enable  0 or 1
+ * @retval     0       OK
+ */
+int
+clixon_netns_reuseport_set(int enable)
+{
+    _socket_reuseport = enable;
+    return 0;
+}
+
 /*! Create and bind stream socket
  * @param[in]  sa       Socketaddress
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
@@ -162,6 +183,13 @@ create_socket(struct sockaddr *sa,
         clicon_err(OE_UNIX, errno, "setsockopt SO_REUSEADDR");
         goto done;
     }
+#ifdef SO_REUSEPORT
+    if (_socket_reuseport &&
+        setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (void *)&on, sizeof(on)) == -1) {
+        clicon_err(OE_UNIX, errno, "setsockopt SO_REUSEPORT");
+        goto done;
+    }
+#endif
 
     /* only bind ipv6, otherwise it may bind to ipv4 as well which is strange but seems default */
     if (sa->sa_family == AF_INET6 &&
@@ -69,6 +69,7 @@
 #include "clixon_handle.h"
 #include "clixon_file.h"
 #include "clixon_log.h"
+#include "clixon_trace.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_options.h"
@@ -117,6 +118,7 @@ static const map_str2int datastore_cache_map[] = {
     {"nocache",               DATASTORE_NOCACHE},
     {"cache",                 DATASTORE_CACHE},
     {"cache-zerocopy",        DATASTORE_CACHE_ZEROCOPY},
+    {"cache-cow",             DATASTORE_CACHE_COW},
     {NULL,                    -1}
 };
 
@@ -128,6 +130,13 @@ static const map_str2int yang_regexp_map[] = {
     {NULL,                 -1}
 };
 
+/* Options change generation: bumped on every option write so that the cached
+ * typed accessors can revalidate with two compares instead of a hash lookup
+ * and string conversion, see clicon_option_str_cached and friends. Starts at
+ * 1 so a zero-initialized clicon_option_cache is always stale.
+ */
+static uint32_t _options_gen = 1;
+
 /*! Print registry on file. For debugging.
  * @param[in] h        Clicon handle
  * @param[in] dbglevel Debug level
@@ -390,11 +399,12 @@ parse_configfile(clicon_handle  h,
             continue;
         if (strcmp(name,"CLICON_SNMP_MIB")==0)
             continue;
-        if (clicon_hash_add(copt, 
+        if (clicon_hash_add(copt,
                             name,
                             body,
                             strlen(body)+1) == NULL)
             goto done;
+        _options_gen++;
     }
     retval = 0;
     *xconfig = xt;
@@ -443,11 +453,12 @@ clicon_option_add(clicon_handle h,
                                 name, value, name) < 0)
             goto done;
     }
-    if (clicon_hash_add(copt, 
+    if (clicon_hash_add(copt,
                  name,
                  value,
                  strlen(value)+1) == NULL)
         goto done;
+    _options_gen++;
     retval = 0;
  done:
     return retval;
@@ -556,6 +567,8 @@ clicon_options_main(clicon_handle h)
     /* Set clixon_conf pointer to handle */
     if (clicon_conf_xml_set(h, xconfig) < 0)
         goto done;
+    /* Opt-in request trace log, see clixon_trace_stage */
+    clixon_trace_log_enable(clicon_option_bool(h, "CLICON_LOG_TRACE"));
 
     retval = 0;
  done:
@@ -610,12 +623,13 @@ clicon_option_str(clicon_handle h,
  * @retval   -1       Error
  */
 int
-clicon_option_str_set(clicon_handle h, 
-                      const char   *name, 
+clicon_option_str_set(clicon_handle h,
+                      const char   *name,
                       char         *val)
 {
     clicon_hash_t *copt = clicon_options(h);
 
+    _options_gen++;
     return clicon_hash_add(copt, (char*)name, val, strlen(val)+1)==NULL?-1:0;
 }
 
@@ -727,9 +741,112 @@ clicon_option_del(clicon_handle h,
 {
     clicon_hash_t *copt = clicon_options(h);
 
+    _options_gen++;
     return clicon_hash_del(copt, (char*)name);
 }
 
+/*! Check if a cached typed option is still valid for handle h
+ * @param[in]  h   Clicon handle
+ * @param[in]  oc  Option cache, zero-initialized at first use
+ * @retval     1   Cache valid
+ * @retval     0   Empty, stale or cached for another handle
+ */
+static int
+option_cache_valid(clicon_handle        h,
+                   clicon_option_cache *oc)
+{
+    return oc->oc_gen == _options_gen && oc->oc_h == h;
+}
+
+/*! Mark a typed option cache as (re)loaded for handle h
+ * @param[in]  h   Clicon handle
+ * @param[in]  oc  Option cache
+ */
+static void
+option_cache_update(clicon_handle        h,
+                    clicon_option_cache *oc)
+{
+    oc->oc_h = h;
+    oc->oc_gen = _options_gen;
+}
+
+/*! Get string option via a per-callsite cache
+ *
+ * Same semantics as clicon_option_str, but the hash lookup is skipped while
+ * no option has been written since the cached read. Declare one static
+ * clicon_option_cache per call site (ie per option name).
+ * @param[in]     h     clicon_handle
+ * @param[in]     name  Option name, must be the same on every call with oc
+ * @param[in,out] oc    Option cache, zero-initialized at first use
+ * @retval        string Value of option if found
+ * @retval        NULL  Option not found, or value is NULL
+ * @see clicon_option_str
+ */
+char *
+clicon_option_str_cached(clicon_handle        h,
+                         const char          *name,
+                         clicon_option_cache *oc)
+{
+    if (!option_cache_valid(h, oc)){
+        oc->oc_str = clicon_option_str(h, name);
+        option_cache_update(h, oc);
+    }
+    return oc->oc_str;
+}
+
+/*! Get integer option via a per-callsite cache
+ * Same semantics as clicon_option_int: -1 if the option does not exist.
+ * @param[in]     h     clicon_handle
+ * @param[in]     name  Option name, must be the same on every call with oc
+ * @param[in,out] oc    Option cache, zero-initialized at first use
+ * @retval        int   Value as result of atoi, -1 if not found
+ * @see clicon_option_int  and clicon_option_str_cached for the caching
+ */
+int
+clicon_option_int_cached(clicon_handle        h,
+                         const char          *name,
+                         clicon_option_cache *oc)
+{
+    char *s;
+
+    if (!option_cache_valid(h, oc)){
+        if ((s = clicon_option_str(h, name)) == NULL)
+            oc->oc_num = -1;
+        else
+            oc->oc_num = atoi(s);
+        oc->oc_str = s;
+        option_cache_update(h, oc);
+    }
+    return oc->oc_num;
+}
+
+/*! Get boolean option via a per-callsite cache
+ * Same semantics as clicon_option_bool: 0 if the option does not exist.
+ * @param[in]     h     clicon_handle
+ * @param[in]     name  Option name, must be the same on every call with oc
+ * @param[in,out] oc    Option cache, zero-initialized at first use
+ * @retval        1     True
+ * @retval        0     False, not found, or not a boolean
+ * @see clicon_option_bool  and clicon_option_str_cached for the caching
+ */
+int
+clicon_option_bool_cached(clicon_handle        h,
+                          const char          *name,
+                          clicon_option_cache *oc)
+{
+    char *s;
+
+    if (!option_cache_valid(h, oc)){
+        if ((s = clicon_option_str(h, name)) == NULL)
+            oc->oc_num = 0;
+        else
+            oc->oc_num = strcmp(s, "true") == 0 || strcmp(s, "1") == 0;
+        oc->oc_str = s;
+        option_cache_update(h, oc);
+    }
+    return oc->oc_num;
+}
+
 /*-----------------------------------------------------------------
  * Specific option access functions for YANG configuration variables.
  * Sometimes overridden by command-line options, 
@@ -873,12 +990,18 @@ clicon_nacm_credentials(clicon_handle h)
 enum datastore_cache
 clicon_datastore_cache(clicon_handle h)
 {
+    static clicon_option_cache oc = {0,};
     char *str;
 
-    if ((str = clicon_option_str(h, "CLICON_DATASTORE_CACHE")) == NULL)
-        return DATASTORE_CACHE;
-    else
-        return clicon_str2int(datastore_cache_map, str);
+    if (!option_cache_valid(h, &oc)){
+        if ((str = clicon_option_str(h, "CLICON_DATASTORE_CACHE")) == NULL)
+            oc.oc_num = DATASTORE_CACHE;
+        else
+            oc.oc_num = clicon_str2int(datastore_cache_map, str);
+        oc.oc_str = str;
+        option_cache_update(h, &oc);
+    }
+    return oc.oc_num;
 }
 
 /*! Which Yang regexp/pattern engine to use
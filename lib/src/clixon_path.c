@@ -100,6 +100,7 @@
 #include "clixon_netconf_lib.h"
 #include "clixon_xml_map.h"
 #include "clixon_yang_module.h" 
+#include "clixon_arena.h"
 #include "clixon_path.h"
 #include "clixon_api_path_parse.h"
 #include "clixon_instance_id_parse.h"
@@ -128,11 +129,19 @@ api_path_parse(char         *api_path,
 {
     int                  retval = -1;
     clixon_api_path_yacc ay = {0,};
+    int                  pushed = 0;
 
     clicon_debug(1, "%s api_path:%s", __FUNCTION__, api_path);
     ay.ay_parse_string = api_path;
     ay.ay_name = "api-path parser";
     ay.ay_linenum = 1;
+    /* Token strings are scratch: allocated from an arena scope and reclaimed
+     * in one step at the end of the parse */
+    if ((ay.ay_arena = clixon_arena_scratch()) == NULL)
+        goto done;
+    if (clixon_arena_push(ay.ay_arena) < 0)
+        goto done;
+    pushed++;
     if (api_path_scan_init(&ay) < 0)
         goto done;
     if (api_path_parse_init(&ay) < 0)
@@ -148,6 +157,8 @@ api_path_parse(char         *api_path,
     *cplist = ay.ay_top;
     retval = 0;
  done:
+    if (pushed)
+        clixon_arena_pop(ay.ay_arena);
     return retval;
 }
 
@@ -173,11 +184,19 @@ instance_id_parse(char         *path,
 {
     int                     retval = -1;
     clixon_instance_id_yacc iy = {0,};
+    int                     pushed = 0;
 
     clicon_debug(1, "%s path:%s", __FUNCTION__, path);
     iy.iy_parse_string = path;
     iy.iy_name = "instance-id parser";
     iy.iy_linenum = 1;
+    /* Token strings are scratch: allocated from an arena scope and reclaimed
+     * in one step at the end of the parse */
+    if ((iy.iy_arena = clixon_arena_scratch()) == NULL)
+        goto done;
+    if (clixon_arena_push(iy.iy_arena) < 0)
+        goto done;
+    pushed++;
     if (instance_id_scan_init(&iy) < 0)
         goto done;
     if (instance_id_parse_init(&iy) < 0)
@@ -193,6 +212,8 @@ instance_id_parse(char         *path,
     *cplist = iy.iy_top;
     retval = 0;
  done:
+    if (pushed)
+        clixon_arena_pop(iy.iy_arena);
     return retval;
 }
 
@@ -1581,6 +1602,171 @@ clixon_path_search(cxobj        *xt,
     goto done;
 }
 
+/*
+ * Parsed-path cache
+ * RESTCONF pollers and NACM checks present the same api-path / instance-id
+ * strings over and over, and each lookup re-runs the yacc path parser and
+ * re-resolves the yang node chain. Cache the parsed and resolved clixon_path
+ * lists keyed by path string, resolve root and syntax, with LRU eviction.
+ * The lists are shared read-only: clixon_path_search and the namespace
+ * binding walk do not modify them. Entries record the yang spec generation
+ * at insert and are dropped once any spec is freed, so a schema reload
+ * invalidates the cache, see yspec_generation_get. Entries are pinned while
+ * in use so eviction cannot free a list under an ongoing search.
+ */
+#define PATH_CACHE_NR 128
+
+struct path_cache_ent{
+    char        *pe_str;    /* path string (copy), NULL if free slot */
+    yang_stmt   *pe_yt;     /* resolve root, part of the key */
+    int          pe_instid; /* 1: instance-id syntax, 0: api-path, part of the key */
+    uint64_t     pe_gen;    /* yang spec generation at insert */
+    clixon_path *pe_cplist; /* parsed and resolved list, shared read-only */
+    uint64_t     pe_tick;   /* last use, for LRU eviction */
+    int          pe_inuse;  /* nr of ongoing uses, do not evict if > 0 */
+};
+static struct path_cache_ent _path_cache[PATH_CACHE_NR] = {{0,},};
+static uint64_t _path_cache_tick = 0;
+
+/*! Parse and yang-resolve a path via the parsed-path cache
+ *
+ * @param[in]  path    Path string, api-path or instance-id syntax
+ * @param[in]  yt      Yang statement of top symbol, resolve root
+ * @param[in]  instid  0: api-path syntax, 1: instance-id syntax
+ * @param[out] cplistp Parsed and resolved clixon-path list
+ * @param[out] pep     Cache entry if *cplistp is shared, NULL if caller owns it
+ * @retval    -1       Error
+ * @retval     0       Resolve failure, clicon_err set, see api_path_resolve
+ * @retval     1       OK
+ * On a hit the cached list is returned pinned and *pep is set: the caller
+ * must release it with path_cache_put and must not free the list. On a miss
+ * the path is parsed, resolved and inserted, evicting the least recently
+ * used unpinned entry. Only successfully resolved paths are cached. If every
+ * entry is pinned the list is not inserted and the caller owns it.
+ */
+static int
+path_cache_get(char                   *path,
+               yang_stmt              *yt,
+               int                     instid,
+               clixon_path           **cplistp,
+               struct path_cache_ent **pep)
+{
+    int                    retval = -1;
+    struct path_cache_ent *pe;
+    clixon_path           *cplist = NULL;
+    char                  *str = NULL;
+    uint64_t               gen;
+    int                    victim = -1;
+    int                    ret;
+    int                    i;
+
+    *pep = NULL;
+    gen = yspec_generation_get();
+    for (i=0; i<PATH_CACHE_NR; i++){
+        pe = &_path_cache[i];
+        if (pe->pe_str == NULL){
+            if (victim < 0)
+                victim = i;
+            continue;
+        }
+        if (pe->pe_gen != gen){ /* schema reload: resolved pointers are stale */
+            if (pe->pe_inuse > 0)
+                continue;
+            free(pe->pe_str);
+            pe->pe_str = NULL;
+            clixon_path_free(pe->pe_cplist);
+            pe->pe_cplist = NULL;
+            if (victim < 0)
+                victim = i;
+            continue;
+        }
+        if (pe->pe_yt == yt && pe->pe_instid == instid &&
+            strcmp(pe->pe_str, path) == 0){
+            pe->pe_tick = ++_path_cache_tick;
+            pe->pe_inuse++;
+            *cplistp = pe->pe_cplist;
+            *pep = pe;
+            retval = 1;
+            goto done;
+        }
+        if (pe->pe_inuse > 0)
+            continue;
+        if (victim < 0 ||
+            (_path_cache[victim].pe_str != NULL &&
+             pe->pe_tick < _path_cache[victim].pe_tick))
+            victim = i;
+    }
+    if (instid){
+        if (instance_id_parse(path, &cplist) < 0)
+            goto done;
+    }
+    else if (api_path_parse(path, &cplist) < 0)
+        goto done;
+    if (clicon_debug_get())
+        clixon_path_print(stderr, cplist);
+    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
+    if (instid)
+        ret = instance_id_resolve(cplist, yt);
+    else
+        ret = api_path_resolve(cplist, yt);
+    if (ret < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (victim < 0){ /* all entries pinned: hand the list to the caller */
+        *cplistp = cplist;
+        cplist = NULL;
+        retval = 1;
+        goto done;
+    }
+    if ((str = strdup(path)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    pe = &_path_cache[victim];
+    if (pe->pe_str){
+        free(pe->pe_str);
+        clixon_path_free(pe->pe_cplist);
+    }
+    pe->pe_str = str;
+    str = NULL;
+    pe->pe_yt = yt;
+    pe->pe_instid = instid;
+    pe->pe_gen = gen;
+    pe->pe_cplist = cplist;
+    cplist = NULL;
+    pe->pe_tick = ++_path_cache_tick;
+    pe->pe_inuse = 1;
+    *cplistp = pe->pe_cplist;
+    *pep = pe;
+    retval = 1;
+ done:
+    if (str)
+        free(str);
+    if (cplist)
+        clixon_path_free(cplist);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Release a parsed-path cache entry, or free a caller-owned list
+ * @param[in]  pe      Cache entry from path_cache_get, or NULL
+ * @param[in]  cplist  Path list from path_cache_get, freed if pe is NULL
+ * @see path_cache_get
+ */
+static int
+path_cache_put(struct path_cache_ent *pe,
+               clixon_path           *cplist)
+{
+    if (pe)
+        pe->pe_inuse--;
+    else if (cplist)
+        clixon_path_free(cplist);
+    return 0;
+}
+
 /*! Given RESTCONF api-path and an XML tree, return matching xml node vector using stdarg
  *
  * @param[in]  xt       Top xml-tree where to search
@@ -1620,6 +1806,7 @@ clixon_xml_find_api_path(cxobj        *xt,
     size_t           len;
     char            *api_path = NULL;
     clixon_path     *cplist = NULL;
+    struct path_cache_ent *pe = NULL;
     int              ret;
     clixon_xvec     *xv = NULL;
     
@@ -1639,13 +1826,8 @@ clixon_xml_find_api_path(cxobj        *xt,
         goto done;
     }
     va_end(ap);
-    /* Parse api-path string to structured clixon-path data */
-    if (api_path_parse(api_path, &cplist) < 0)
-        goto done;
-    if (clicon_debug_get())
-        clixon_path_print(stderr, cplist);
-    /* Resolve module:name to yang-stmt, fail if not successful */
-    if ((ret = api_path_resolve(cplist, yt)) < 0)
+    /* Parse and yang-resolve via the parsed-path cache */
+    if ((ret = path_cache_get(api_path, yt, 0, &cplist, &pe)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -1660,8 +1842,7 @@ clixon_xml_find_api_path(cxobj        *xt,
  done:
     if (xv)
         clixon_xvec_free(xv);
-    if (cplist)
-        clixon_path_free(cplist);
+    path_cache_put(pe, cplist);
     if (api_path)
         free(api_path);
     return retval;
@@ -1714,6 +1895,7 @@ clixon_xml_find_instance_id(cxobj     *xt,
     size_t       len;
     char        *path = NULL;
     clixon_path *cplist = NULL;
+    struct path_cache_ent *pe = NULL;
     int          ret;
     clixon_xvec *xv = NULL;
     
@@ -1733,12 +1915,8 @@ clixon_xml_find_instance_id(cxobj     *xt,
         goto done;
     }
     va_end(ap);
-    if (instance_id_parse(path, &cplist) < 0)
-        goto done;
-    if (clicon_debug_get())
-        clixon_path_print(stderr, cplist);
-    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
-    if ((ret = instance_id_resolve(cplist, yt)) < 0)
+    /* Parse and yang-resolve via the parsed-path cache */
+    if ((ret = path_cache_get(path, yt, 1, &cplist, &pe)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -1753,8 +1931,7 @@ clixon_xml_find_instance_id(cxobj     *xt,
  done:
     if (xv)
         clixon_xvec_free(xv);
-    if (cplist)
-        clixon_path_free(cplist);
+    path_cache_put(pe, cplist);
     if (path)
         free(path);
     return retval;
@@ -1801,6 +1978,7 @@ clixon_instance_id_bind(yang_stmt  *yt,
     size_t       len;
     char        *path = NULL;
     clixon_path *cplist = NULL;
+    struct path_cache_ent *pe = NULL;
     clixon_path *cp;
     int          ret;
     char        *namespace;
@@ -1821,12 +1999,8 @@ clixon_instance_id_bind(yang_stmt  *yt,
         goto done;
     }
     va_end(ap);
-    if (instance_id_parse(path, &cplist) < 0)
-        goto done;
-    if (clicon_debug_get())
-        clixon_path_print(stderr, cplist);
-    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
-    if ((ret = instance_id_resolve(cplist, yt)) < 0)
+    /* Parse and yang-resolve via the parsed-path cache */
+    if ((ret = path_cache_get(path, yt, 1, &cplist, &pe)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -1845,8 +2019,7 @@ clixon_instance_id_bind(yang_stmt  *yt,
     }
     retval = 1;
  done:
-    if (cplist)
-        clixon_path_free(cplist);
+    path_cache_put(pe, cplist);
     if (path)
         free(path);
     return retval;
@@ -98,6 +98,9 @@
 #ifdef HAVE_SETNS /* linux network namespaces */
 #include <sched.h> /* setns / unshare */
 #endif
+#ifdef HAVE_POSIX_SPAWN
+#include <spawn.h>
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -125,6 +128,17 @@
 #include "clixon_netconf_lib.h"
 #include "clixon_proc.h"
 
+#ifdef HAVE_POSIX_SPAWN
+extern char **environ; /* for posix_spawnp */
+/* Spawn background processes without copying the parent image, provided the
+ * child setup (chdir, close all descriptors) can be expressed as file actions.
+ * The netns case always needs fork since setns/unshare run in the child.
+ */
+#if defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP) && defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP)
+#define PROC_SPAWN_BACKGROUND 1
+#endif
+#endif /* HAVE_POSIX_SPAWN */
+
 /*
  * Types
  */
@@ -184,6 +198,12 @@ clixon_proc_socket(char **argv,
     sigfn_t  oldhandler = NULL;
     sigset_t oset;
     int      sig = 0;
+#ifdef HAVE_POSIX_SPAWN
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t          attr;
+    sigset_t                   eset;
+    int                        err;
+#endif
 
     if (argv == NULL){
         clicon_err(OE_UNIX, EINVAL, "argv is NULL");
@@ -197,6 +217,27 @@ clixon_proc_socket(char **argv,
     sigprocmask(0, NULL, &oset);
     set_signal(SIGINT, clixon_proc_sigint, &oldhandler);
     sig++;
+#ifdef HAVE_POSIX_SPAWN
+    /* Spawn-and-exec without copying the parent image (fork of a large
+     * backend costs page-table copy). Child setup as file actions/attrs.
+     */
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_addclose(&fa, sp[0]);
+    posix_spawn_file_actions_adddup2(&fa, sp[1], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&fa, sp[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&fa, sp[1]);
+    posix_spawnattr_init(&attr);
+    sigemptyset(&eset);
+    posix_spawnattr_setsigmask(&attr, &eset); /* as clicon_signal_unblock in the fork path */
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+    err = posix_spawnp(&child, argv[0], &fa, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&fa);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0){
+        clicon_err(OE_UNIX, err, "posix_spawnp(%s)", argv[0]);
+        goto done;
+    }
+#else /* fork fallback */
     if ((child = fork()) < 0) {
         clicon_err(OE_UNIX, errno, "fork");
         goto done;
@@ -217,14 +258,15 @@ clixon_proc_socket(char **argv,
             perror("dup2");
             return -1;
         }
-        close(sp[1]); 
-        
+        close(sp[1]);
+
         if (execvp(argv[0], argv) < 0){
             perror("execvp");
             return -1;
         }
         exit(-1);        /* Shouldnt reach here */
     }
+#endif /* HAVE_POSIX_SPAWN */
     /* Parent */
     close(sp[1]);
     *pid = child;
@@ -277,6 +319,12 @@ clixon_proc_background(char       **argv,
     sigset_t      oset;
     struct rlimit rlim = {0, };
     struct stat   fstat;
+#ifdef PROC_SPAWN_BACKGROUND
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t          attr;
+    sigset_t                   eset;
+    int                        err;
+#endif
 
     clicon_debug(1, "%s", __FUNCTION__);
     if (argv == NULL){
@@ -299,6 +347,28 @@ clixon_proc_background(char       **argv,
     sigprocmask(0, NULL, &oset);
     set_signal(SIGINT, clixon_proc_sigint, &oldhandler);
     /* Now call done on error */
+#ifdef PROC_SPAWN_BACKGROUND
+    if (netns == NULL){
+        /* Spawn-and-exec without copying the parent image: the child setup
+         * (chdir /, close all descriptors) is expressed as file actions
+         */
+        posix_spawn_file_actions_init(&fa);
+        posix_spawn_file_actions_addchdir_np(&fa, "/");
+        posix_spawn_file_actions_addclosefrom_np(&fa, 0); /* as the close loop in the fork path */
+        posix_spawnattr_init(&attr);
+        sigemptyset(&eset);
+        posix_spawnattr_setsigmask(&attr, &eset); /* as clicon_signal_unblock in the fork path */
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+        err = posix_spawnp(&child, argv[0], &fa, &attr, argv, environ);
+        posix_spawn_file_actions_destroy(&fa);
+        posix_spawnattr_destroy(&attr);
+        if (err != 0){
+            clicon_err(OE_UNIX, err, "posix_spawnp(%s)", argv[0]);
+            child = 0;
+        }
+        goto done;
+    }
+#endif /* PROC_SPAWN_BACKGROUND */
     if ((child = fork()) < 0) {
         clicon_err(OE_UNIX, errno, "fork");
         goto done;
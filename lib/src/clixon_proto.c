@@ -52,10 +52,15 @@
 #include <syslog.h>
 #include <signal.h>
 #include <ctype.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/stat.h>
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 #include <netinet/in.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
@@ -71,10 +76,14 @@
 #include "clixon_handle.h"
 #include "clixon_event.h"
 #include "clixon_log.h"
+#include "clixon_trace.h"
 #include "clixon_yang.h"
 #include "clixon_sig.h"
 #include "clixon_xml.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_sort.h"
 #include "clixon_netconf_lib.h"
 #include "clixon_options.h"
 #include "clixon_proto.h"
@@ -159,6 +168,7 @@ clicon_msg_encode(uint32_t      id,
     /* hdr */
     msg->op_len = htonl(len);
     msg->op_id = htonl(id);
+    msg->op_tid = htonl(clixon_trace_id_get());
     
     /* body */
     va_start(args, format);
@@ -185,13 +195,47 @@ clicon_msg_decode(struct clicon_msg *msg,
                   cxobj            **xml,
                   cxobj            **xerr)
 {
-    int    retval = -1;
-    char  *xmlstr;
-    int    ret;
+    int      retval = -1;
+    char    *xmlstr;
+    int      ret;
+    uint32_t blen;
+    FILE    *f;
+    cxobj   *x;
 
     /* hdr */
     if (id)
         *id = ntohl(msg->op_id);
+    blen = ntohl(msg->op_len) - sizeof(*msg);
+    /* Binary cxobj serialization, negotiated in the hello exchange: materialize
+     * the tree directly instead of parsing XML text, see clixon_xml2bin
+     */
+    if (clixon_bin_detect(msg->op_body, blen)){
+        if ((f = fmemopen(msg->op_body, blen, "r")) == NULL){
+            clicon_err(OE_UNIX, errno, "fmemopen");
+            goto done;
+        }
+        ret = clixon_bin2xml(f, xml);
+        fclose(f);
+        if (ret <= 0) /* invalid input: clicon_err set by clixon_bin2xml */
+            goto done;
+        if (yspec){
+            x = NULL;
+            while ((x = xml_child_each(*xml, x, CX_ELMNT)) != NULL){
+                if ((ret = xml_bind_yang_rpc(x, yspec, xerr)) < 0)
+                    goto done;
+                if (ret == 0){ /* Add message-id, see clixon_xml_parse_string */
+                    if (xerr && *xerr &&
+                        clixon_xml_attr_copy(x, *xerr, "message-id") < 0)
+                        goto done;
+                    goto fail;
+                }
+            }
+            if (xml_sort_recurse(*xml) < 0)
+                goto done;
+        }
+        retval = 1;
+        goto done;
+    }
     /* body */
     xmlstr = msg->op_body;
     clicon_debug(2, "%s %s", __FUNCTION__, xmlstr);
@@ -326,6 +370,106 @@ msg_dump(struct clicon_msg *msg)
     return retval;
 }
 
+/*! Send message body out-of-band in a memfd, the socket carries only the header
+ *
+ * The receiver gets the descriptor with the header and reads the body from it,
+ * see msg_hdr_rcv. Large state transfers thus bypass the socket buffer and its
+ * backpressure on the sender. The high bit of op_len marks such a message on
+ * the wire, see CLICON_MSG_FLAG_FDPASS. Both peers must run a library built
+ * with HAVE_MEMFD_CREATE, which holds for the supported deployment of backend
+ * and clients on one host.
+ * @param[in]   s      Socket to communicate with peer, must be AF_UNIX
+ * @param[in]   id     Session id of client
+ * @param[in]   body   Message body
+ * @param[in]   blen   Length of body
+ * @param[in]   flags  Flags to sendmsg(2), eg MSG_DONTWAIT
+ * @retval      1      Sent
+ * @retval      0      Not applicable, eg inet socket or EAGAIN: caller sends inline
+ * @retval     -1      Error
+ * @note A short header write with MSG_DONTWAIT desyncs the stream and is treated
+ *       as a hard error; it needs a socket buffer with less than 12 free bytes
+ */
+static int
+msg_fdpass_body_send(int      s,
+                     uint32_t id,
+                     char    *body,
+                     uint32_t blen,
+                     int      flags)
+{
+#if defined(HAVE_MEMFD_CREATE) && defined(SCM_RIGHTS)
+    int                     retval = -1;
+    int                     fd = -1;
+    struct clicon_msg       hdr = {0,};
+    struct msghdr           mhdr = {0,};
+    struct iovec            iov;
+    struct cmsghdr         *cmsg;
+    char                    cmsgbuf[CMSG_SPACE(sizeof(int))] = {0,};
+    struct sockaddr_storage ss = {0,};
+    socklen_t               sslen = sizeof(ss);
+
+    /* Descriptor passing needs a unix socket */
+    if (getsockname(s, (struct sockaddr *)&ss, &sslen) < 0 ||
+        ss.ss_family != AF_UNIX)
+        goto fail;
+    if ((fd = memfd_create("clixon_msg", MFD_CLOEXEC)) < 0)
+        goto fail; /* eg old kernel: send inline */
+    if (atomicio((ssize_t (*)(int, void *, size_t))write,
+                 fd, body, blen) < 0){
+        clicon_err(OE_CFG, errno, "memfd write");
+        goto done;
+    }
+    hdr.op_id = htonl(id);
+    hdr.op_tid = htonl(clixon_trace_id_get());
+    hdr.op_len = htonl((sizeof(hdr) + blen) | CLICON_MSG_FLAG_FDPASS);
+    iov.iov_base = &hdr;
+    iov.iov_len = sizeof(hdr);
+    mhdr.msg_iov = &iov;
+    mhdr.msg_iovlen = 1;
+    mhdr.msg_control = cmsgbuf;
+    mhdr.msg_controllen = sizeof(cmsgbuf);
+    cmsg = CMSG_FIRSTHDR(&mhdr);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    if (sendmsg(s, &mhdr, flags) != sizeof(hdr)){
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            goto fail; /* nothing written: caller may queue inline */
+        clicon_err(OE_CFG, errno, "sendmsg");
+        goto done;
+    }
+    retval = 1; /* the in-flight descriptor keeps the memfd alive */
+ done:
+    if (fd != -1)
+        close(fd);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+#else
+    return 0; /* caller sends inline */
+#endif /* HAVE_MEMFD_CREATE && SCM_RIGHTS */
+}
+
+/*! Send a pre-assembled clicon_msg body out-of-band in a memfd
+ *
+ * @param[in]   s      Socket to communicate with peer, must be AF_UNIX
+ * @param[in]   msg    CLICON msg
+ * @param[in]   flags  Flags to sendmsg(2), eg MSG_DONTWAIT
+ * @retval      1      Sent
+ * @retval      0      Not applicable, eg inet socket or EAGAIN: caller sends inline
+ * @retval     -1      Error
+ * @see msg_fdpass_body_send
+ */
+int
+clicon_msg_fdpass_send(int                s,
+                       struct clicon_msg *msg,
+                       int                flags)
+{
+    return msg_fdpass_body_send(s, ntohl(msg->op_id), msg->op_body,
+                                ntohl(msg->op_len) - sizeof(*msg), flags);
+}
+
 /*! Send a CLICON netconf message using internal IPC message
  *
  * @param[in]   s      socket (unix or inet) to communicate with backend
@@ -333,17 +477,28 @@ msg_dump(struct clicon_msg *msg)
  * @see clicon_msg_send1  using plain NETCONF
  */
 int
-clicon_msg_send(int                s, 
+clicon_msg_send(int                s,
                 struct clicon_msg *msg)
-{ 
+{
     int retval = -1;
     int e;
+    int ret;
 
-    clicon_debug(2, "%s: send msg len=%d", 
+    clicon_debug(2, "%s: send msg len=%d",
                  __FUNCTION__, ntohl(msg->op_len));
+    CLIXON_PROBE2(msg_send, s, ntohl(msg->op_len));
+    clixon_trace_stage("ipc-send");
     if (clicon_debug_get() > 2)
         msg_dump(msg);
-    if (atomicio((ssize_t (*)(int, void *, size_t))write, 
+    if (ntohl(msg->op_len) - sizeof(*msg) >= CLICON_MSG_FDPASS_MIN){
+        if ((ret = clicon_msg_fdpass_send(s, msg, 0)) < 0)
+            goto done;
+        if (ret == 1){
+            retval = 0;
+            goto done;
+        } /* else fall through: send inline */
+    }
+    if (atomicio((ssize_t (*)(int, void *, size_t))write,
                  s, msg, ntohl(msg->op_len)) < 0){
         e = errno;
         clicon_err(OE_CFG, e, "atomicio");
@@ -356,6 +511,107 @@ clicon_msg_send(int                s,
     return retval;
 }
 
+/* Upper bound on accepted message length, 0 means no limit.
+ * A peer announcing an absurd length in the header would otherwise make the
+ * receiver malloc whatever the header says, see clicon_msg_rcv
+ */
+static uint32_t _msg_rcv_limit = 0;
+
+/*! Set upper bound on accepted incoming message length
+ *
+ * Enforced in clicon_msg_rcv before the body is allocated: an oversized
+ * inline body is drained off the socket to keep the stream in sync and the
+ * call fails with suberrno EMSGSIZE, so the caller can answer with a
+ * resource-denied error and keep the session rather than be killed by the
+ * allocation.
+ * @param[in]  limit  Max message length in bytes including header, 0: no limit
+ * @retval     0      OK
+ * @see clicon_msg_rcv
+ */
+int
+clicon_msg_rcv_limit_set(uint32_t limit)
+{
+    _msg_rcv_limit = limit;
+    return 0;
+}
+
+/*! Read and discard a message body to keep the byte stream in sync
+ * @param[in]  s    Socket to communicate with peer
+ * @param[in]  len  Number of body bytes to discard
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+msg_body_drain(int    s,
+               size_t len)
+{
+    char    buf[BUFSIZ];
+    ssize_t n;
+
+    while (len > 0){
+        if ((n = atomicio(read, s, buf, len < sizeof(buf) ? len : sizeof(buf))) < 0)
+            return -1;
+        if (n == 0)
+            break; /* eof */
+        len -= n;
+    }
+    return 0;
+}
+
+/*! Read the fixed message header, capturing a passed body descriptor if present
+ *
+ * SCM_RIGHTS ancillary data is only delivered to recvmsg(2) on the read of the
+ * bytes it was attached to, hence the header cannot be read with plain read(2)
+ * when a peer may pass the body out-of-band, see msg_send_fdpass.
+ * @param[in]   s       Socket to communicate with peer
+ * @param[out]  buf     Header buffer
+ * @param[in]   len     Length of buf
+ * @param[out]  bodyfd  Body descriptor if one was passed, otherwise untouched
+ * @retval      n       Number of bytes read, 0 on eof
+ * @retval     -1       Error with errno set
+ */
+static int
+msg_hdr_rcv(int    s,
+            void  *buf,
+            size_t len,
+            int   *bodyfd)
+{
+    ssize_t         n;
+    size_t          off = 0;
+    struct msghdr   mhdr;
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    char            cmsgbuf[CMSG_SPACE(sizeof(int))];
+
+    while (off < len){
+        memset(&mhdr, 0, sizeof(mhdr));
+        memset(cmsgbuf, 0, sizeof(cmsgbuf));
+        iov.iov_base = (char *)buf + off;
+        iov.iov_len = len - off;
+        mhdr.msg_iov = &iov;
+        mhdr.msg_iovlen = 1;
+        mhdr.msg_control = cmsgbuf;
+        mhdr.msg_controllen = sizeof(cmsgbuf);
+        if ((n = recvmsg(s, &mhdr, 0)) < 0){
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOTSOCK){ /* eg pipe: no descriptors can arrive */
+                if ((n = atomicio(read, s, (char *)buf + off, len - off)) < 0)
+                    return -1;
+                return off + n;
+            }
+            return -1;
+        }
+        if (n == 0)
+            break; /* eof */
+        for (cmsg = CMSG_FIRSTHDR(&mhdr); cmsg; cmsg = CMSG_NXTHDR(&mhdr, cmsg))
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+                memcpy(bodyfd, CMSG_DATA(cmsg), sizeof(int));
+        off += n;
+    }
+    return off;
+}
+
 /*! Receive a CLICON message using IPC message struct
  *
  * XXX: timeout? and signals?
@@ -383,13 +639,15 @@ clicon_msg_rcv(int                s,
     ssize_t   len2;
     sigfn_t   oldhandler;
     uint32_t  mlen;
+    int       bodyfd = -1;
+    int       fdpass = 0;
 
     *eof = 0;
     if (0)
         set_signal(SIGINT, atomicio_sig_handler, &oldhandler);
 
-    if ((hlen = atomicio(read, s, &hdr, sizeof(hdr))) < 0){ 
-        clicon_err(OE_CFG, errno, "atomicio");
+    if ((hlen = msg_hdr_rcv(s, &hdr, sizeof(hdr), &bodyfd)) < 0){
+        clicon_err(OE_CFG, errno, "recvmsg");
         goto done;
     }
     if (hlen == 0){
@@ -402,14 +660,49 @@ clicon_msg_rcv(int                s,
         goto done;
     }
     mlen = ntohl(hdr.op_len);
-    clicon_debug(2, "%s: rcv msg len=%d",  
+    if (mlen & CLICON_MSG_FLAG_FDPASS){
+        mlen &= ~CLICON_MSG_FLAG_FDPASS;
+        fdpass = 1;
+        if (bodyfd == -1){
+            clicon_err(OE_CFG, 0, "out-of-band body announced but no descriptor passed");
+            goto done;
+        }
+    }
+    clicon_debug(2, "%s: rcv msg len=%d",
                  __FUNCTION__, mlen);
+    CLIXON_PROBE2(msg_rcv, s, mlen);
+    if (mlen < sizeof(hdr)){
+        clicon_err(OE_PROTO, 0, "message length %u shorter than header", mlen);
+        goto done;
+    }
+    if (_msg_rcv_limit && mlen > _msg_rcv_limit){
+        /* a passed body lives in a descriptor closed below, only an inline
+         * body occupies the socket stream */
+        if (!fdpass && msg_body_drain(s, mlen - sizeof(hdr)) < 0){
+            clicon_err(OE_PROTO, errno, "read");
+            goto done;
+        }
+        clicon_err(OE_PROTO, EMSGSIZE, "message length %u exceeds limit %u",
+                   mlen, _msg_rcv_limit);
+        goto done;
+    }
     if ((*msg = (struct clicon_msg *)malloc(mlen)) == NULL){
         clicon_err(OE_CFG, errno, "malloc");
         goto done;
     }
     memcpy(*msg, &hdr, hlen);
-    if ((len2 = atomicio(read, s, (*msg)->op_body, mlen - sizeof(hdr))) < 0){ 
+    (*msg)->op_len = htonl(mlen); /* callers never see the out-of-band flag */
+    if (fdpass){
+        if (lseek(bodyfd, 0, SEEK_SET) < 0){
+            clicon_err(OE_CFG, errno, "lseek");
+            goto done;
+        }
+        if ((len2 = atomicio(read, bodyfd, (*msg)->op_body, mlen - sizeof(hdr))) < 0){
+            clicon_err(OE_CFG, errno, "read");
+            goto done;
+        }
+    }
+    else if ((len2 = atomicio(read, s, (*msg)->op_body, mlen - sizeof(hdr))) < 0){
         clicon_err(OE_CFG, errno, "read");
         goto done;
     }
@@ -421,11 +714,196 @@ clicon_msg_rcv(int                s,
         msg_dump(*msg);
     retval = 0;
   done:
+    if (bodyfd != -1)
+        close(bodyfd);
     if (0)
         set_signal(SIGINT, oldhandler, NULL);
     return retval;
 }
 
+/* Messages above this size are not retained in a reusable receive buffer but
+ * take a one-shot allocation, so a single huge edit does not pin memory for
+ * the lifetime of a connection, see clicon_msg_rcv_buf
+ */
+#define MSG_RCV_KEEP_MAX (256*1024)
+
+/* Number of messages between reusable receive buffer shrink decisions */
+#define MSG_RCV_WINDOW   32
+
+/*! Make a reusable receive buffer fit a message, adapting to observed sizes
+ *
+ * Every MSG_RCV_WINDOW messages the buffer is dropped if the largest message
+ * in the window used less than a quarter of it, so capacity follows the peer
+ * when it goes from huge edits back to tiny RPCs. Growth doubles from the
+ * current size, so a peer alternating sizes below its high-water mark never
+ * reallocates.
+ * @param[in,out] mb    Reusable receive buffer
+ * @param[in]     mlen  Message length (header+body) that must fit
+ * @retval        0     OK, mb->mb_buf holds at least mlen bytes
+ * @retval       -1     Error
+ * @note Previous buffer contents are not preserved
+ */
+static int
+msg_rcv_buf_fit(struct msg_rcv_buf *mb,
+                uint32_t            mlen)
+{
+    uint32_t sz;
+
+    if (mb->mb_n >= MSG_RCV_WINDOW){
+        if (mb->mb_buf != NULL && mb->mb_size > 4*mb->mb_hwm){
+            free(mb->mb_buf);
+            mb->mb_buf = NULL;
+            mb->mb_size = 0;
+        }
+        mb->mb_hwm = 0;
+        mb->mb_n = 0;
+    }
+    if (mlen > mb->mb_size){
+        sz = mb->mb_size ? mb->mb_size : 1024;
+        while (sz < mlen)
+            sz *= 2;
+        if (mb->mb_buf)
+            free(mb->mb_buf); /* old message is consumed, no need to copy */
+        mb->mb_size = 0;
+        if ((mb->mb_buf = (struct clicon_msg *)malloc(sz)) == NULL){
+            clicon_err(OE_CFG, errno, "malloc");
+            return -1;
+        }
+        mb->mb_size = sz;
+    }
+    return 0;
+}
+
+/*! Receive a CLICON message into a reusable per-connection buffer
+ *
+ * As clicon_msg_rcv but instead of allocating a fresh buffer per message the
+ * caller keeps a struct msg_rcv_buf per connection which adapts to the peer's
+ * message sizes, see msg_rcv_buf_fit. Messages above MSG_RCV_KEEP_MAX get a
+ * one-shot allocation. Out-of-band bodies arriving over the memfd channel
+ * (see clicon_msg_fdpass_send) land in the same buffer.
+ * @param[in]   s      Socket (unix or inet) to communicate with peer
+ * @param[in]   mb     Reusable receive buffer, zeroed before first call,
+ *                     freed with clicon_msg_rcv_buf_reset
+ * @param[out]  msg    Received message, valid until the next call with the
+ *                     same mb. Free with free() only if it differs from
+ *                     mb->mb_buf (ie the one-shot case)
+ * @param[out]  eof    Set if eof encountered
+ * Note: caller must ensure that s is closed if eof is set after call.
+ * @see clicon_msg_rcv for the per-message allocating variant
+ */
+int
+clicon_msg_rcv_buf(int                 s,
+                   struct msg_rcv_buf *mb,
+                   struct clicon_msg **msg,
+                   int                *eof)
+{
+    int       retval = -1;
+    struct clicon_msg hdr;
+    int       hlen;
+    ssize_t   len2;
+    uint32_t  mlen;
+    int       bodyfd = -1;
+    int       fdpass = 0;
+
+    *eof = 0;
+    if ((hlen = msg_hdr_rcv(s, &hdr, sizeof(hdr), &bodyfd)) < 0){
+        clicon_err(OE_CFG, errno, "recvmsg");
+        goto done;
+    }
+    if (hlen == 0){
+        retval = 0;
+        *eof = 1;
+        goto done;
+    }
+    if (hlen != sizeof(hdr)){
+        clicon_err(OE_CFG, errno, "header too short (%d)", hlen);
+        goto done;
+    }
+    mlen = ntohl(hdr.op_len);
+    if (mlen & CLICON_MSG_FLAG_FDPASS){
+        mlen &= ~CLICON_MSG_FLAG_FDPASS;
+        fdpass = 1;
+        if (bodyfd == -1){
+            clicon_err(OE_CFG, 0, "out-of-band body announced but no descriptor passed");
+            goto done;
+        }
+    }
+    clicon_debug(2, "%s: rcv msg len=%d",
+                 __FUNCTION__, mlen);
+    CLIXON_PROBE2(msg_rcv, s, mlen);
+    if (mlen < sizeof(hdr)){
+        clicon_err(OE_PROTO, 0, "message length %u shorter than header", mlen);
+        goto done;
+    }
+    if (_msg_rcv_limit && mlen > _msg_rcv_limit){
+        /* a passed body lives in a descriptor closed below, only an inline
+         * body occupies the socket stream */
+        if (!fdpass && msg_body_drain(s, mlen - sizeof(hdr)) < 0){
+            clicon_err(OE_PROTO, errno, "read");
+            goto done;
+        }
+        clicon_err(OE_PROTO, EMSGSIZE, "message length %u exceeds limit %u",
+                   mlen, _msg_rcv_limit);
+        goto done;
+    }
+    if (mlen > MSG_RCV_KEEP_MAX){
+        if ((*msg = (struct clicon_msg *)malloc(mlen)) == NULL){
+            clicon_err(OE_CFG, errno, "malloc");
+            goto done;
+        }
+    }
+    else{
+        if (msg_rcv_buf_fit(mb, mlen) < 0)
+            goto done;
+        *msg = mb->mb_buf;
+        if (mlen > mb->mb_hwm)
+            mb->mb_hwm = mlen;
+        mb->mb_n++;
+    }
+    memcpy(*msg, &hdr, hlen);
+    (*msg)->op_len = htonl(mlen); /* callers never see the out-of-band flag */
+    if (fdpass){
+        if (lseek(bodyfd, 0, SEEK_SET) < 0){
+            clicon_err(OE_CFG, errno, "lseek");
+            goto done;
+        }
+        if ((len2 = atomicio(read, bodyfd, (*msg)->op_body, mlen - sizeof(hdr))) < 0){
+            clicon_err(OE_CFG, errno, "read");
+            goto done;
+        }
+    }
+    else if ((len2 = atomicio(read, s, (*msg)->op_body, mlen - sizeof(hdr))) < 0){
+        clicon_err(OE_CFG, errno, "read");
+        goto done;
+    }
+    if (len2 != mlen - sizeof(hdr)){
+        clicon_err(OE_CFG, errno, "body too short");
+        goto done;
+    }
+    if (clicon_debug_get() > 1)
+        msg_dump(*msg);
+    retval = 0;
+  done:
+    if (bodyfd != -1)
+        close(bodyfd);
+    return retval;
+}
+
+/*! Free a reusable receive buffer and reset it to its initial state
+ *
+ * @param[in,out] mb  Reusable receive buffer
+ * @retval        0   OK
+ * @see clicon_msg_rcv_buf
+ */
+int
+clicon_msg_rcv_buf_reset(struct msg_rcv_buf *mb)
+{
+    if (mb->mb_buf)
+        free(mb->mb_buf);
+    memset(mb, 0, sizeof(*mb));
+    return 0;
+}
+
 /*! Receive a message using plain NETCONF
  *
  * @param[in]   s      socket (unix or inet) to communicate with backend
@@ -632,6 +1110,50 @@ clicon_rpc(int                sock,
         goto done;
     if (clicon_msg_rcv(sock, &reply, eof) < 0)
         goto done;
+    clixon_trace_stage("ipc-reply");
+    if (*eof)
+        goto ok;
+    data = reply->op_body; /* assume string */
+    if (ret && data)
+        if ((*ret = strdup(data)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+ ok:
+    retval = 0;
+  done:
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+/*! Send a clicon_msg message from a cbuf and wait for result
+ *
+ * @param[in]  sock  Socket / file descriptor
+ * @param[in]  id    Session id of client
+ * @param[in]  cb    Message body, a NUL-terminated netconf string
+ * @param[out] ret   Return value, can be NULL. Free with free()
+ * @param[out] eof   Set if eof encountered
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clicon_rpc  for the pre-assembled clicon_msg variant
+ */
+int
+clicon_rpc_cbuf(int       sock,
+                uint32_t  id,
+                cbuf     *cb,
+                char    **ret,
+                int      *eof)
+{
+    int                retval = -1;
+    struct clicon_msg *reply = NULL;
+    char              *data = NULL;
+
+    if (clicon_msg_send_cbuf(sock, id, cb) < 0)
+        goto done;
+    if (clicon_msg_rcv(sock, &reply, eof) < 0)
+        goto done;
+    clixon_trace_stage("ipc-reply");
     if (*eof)
         goto ok;
     data = reply->op_body; /* assume string */
@@ -705,6 +1227,7 @@ send_msg_reply(int      s,
         goto done;
     memset(reply, 0, len);
     reply->op_len = htonl(len);
+    reply->op_tid = htonl(clixon_trace_id_get());
     if (datalen > 0)
       memcpy(reply->op_body, data, datalen);
     if (clicon_msg_send(s, reply) < 0)
@@ -716,30 +1239,142 @@ send_msg_reply(int      s,
     return retval;
 }
 
-/*! Send a clicon_msg NOTIFY message asynchronously to client
+/*! Write an iovec batch fully on a socket
  *
- * @param[in]  s       Socket to communicate with client
- * @param[in]  level
- * @param[in]  event
- * @retval     0       OK
- * @retval     -1      Error
- * @see send_msg_notify_xml
+ * Partial writes and IOV_MAX batching are handled here, cf atomicio.
+ * @param[in]  s    Socket to write on
+ * @param[in]  iov  Entries to write, trimmed in place on partial writes
+ * @param[in]  n    Number of entries
+ * @retval     0    OK
+ * @retval    -1    Error
  */
 static int
-send_msg_notify(int           s, 
-                char         *event)
+msg_writev(int           s,
+           struct iovec *iov,
+           int           n)
 {
-    int                retval = -1;
-    struct clicon_msg *msg = NULL;
+    int     retval = -1;
+    int     i;
+    ssize_t len;
 
-    if ((msg=clicon_msg_encode(0, "%s", event)) == NULL)
+    i = 0;
+    while (i < n){
+        if ((len = writev(s, &iov[i],
+                          (n-i) > IOV_MAX ? IOV_MAX : (n-i))) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_CFG, errno, "writev");
+            goto done;
+        }
+        /* Advance past fully written entries, trim a partial one */
+        while (i < n && len >= iov[i].iov_len){
+            len -= iov[i].iov_len;
+            i++;
+        }
+        if (i < n && len > 0){
+            iov[i].iov_base = (char*)iov[i].iov_base + len;
+            iov[i].iov_len -= len;
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Send a clicon_msg reply gathered from an iovec batch
+ *
+ * Same wire format as send_msg_reply but without first flattening the body
+ * into one contiguous buffer: the fixed header, the body vector and a
+ * terminating NUL are written with writev(2). Partial writes and IOV_MAX
+ * batching are handled here.
+ * @param[in]  s      Socket to communicate with client
+ * @param[in]  iov    Body as iovec batch
+ * @param[in]  iovcnt Number of body entries
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see send_msg_reply  for the contiguous variant
+ */
+int
+send_msg_reply_iov(int           s,
+                   struct iovec *iov,
+                   int           iovcnt)
+{
+    int               retval = -1;
+    struct clicon_msg hdr = {0,};
+    struct iovec     *iov2 = NULL;
+    int               i;
+    uint32_t          datalen = 0;
+    char              nul = '\0';
+
+    for (i = 0; i < iovcnt; i++)
+        datalen += iov[i].iov_len;
+    datalen += 1; /* body is a NUL-terminated string, see send_msg_reply */
+    hdr.op_len = htonl(sizeof(hdr) + datalen);
+    hdr.op_tid = htonl(clixon_trace_id_get());
+    if ((iov2 = calloc(iovcnt + 2, sizeof(*iov2))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    iov2[0].iov_base = &hdr;
+    iov2[0].iov_len = sizeof(hdr);
+    memcpy(&iov2[1], iov, iovcnt*sizeof(*iov));
+    iov2[iovcnt+1].iov_base = &nul;
+    iov2[iovcnt+1].iov_len = 1;
+    if (msg_writev(s, iov2, iovcnt + 2) < 0)
         goto done;
-    if (clicon_msg_send(s, msg) < 0)
+    retval = 0;
+  done:
+    if (iov2)
+        free(iov2);
+    return retval;
+}
+
+/*! Send a CLICON netconf message from a cbuf without assembly copy
+ *
+ * The fixed header is built on the stack and written together with the cbuf
+ * body by writev(2), instead of first copying header and body into one
+ * contiguous clicon_msg as clicon_msg_encode does. Large bodies are passed
+ * out-of-band as in clicon_msg_send.
+ * @param[in]  s   Socket (unix or inet) to communicate with peer
+ * @param[in]  id  Session id of client
+ * @param[in]  cb  Message body, a NUL-terminated netconf string
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see clicon_msg_send  for the pre-assembled variant
+ */
+int
+clicon_msg_send_cbuf(int      s,
+                     uint32_t id,
+                     cbuf    *cb)
+{
+    int               retval = -1;
+    struct clicon_msg hdr = {0,};
+    struct iovec      iov[2];
+    uint32_t          blen;
+    int               ret;
+
+    blen = cbuf_len(cb) + 1; /* body is a NUL-terminated string */
+    clicon_debug(2, "%s: send msg len=%lu",
+                 __FUNCTION__, (unsigned long)(sizeof(hdr) + blen));
+    if (blen >= CLICON_MSG_FDPASS_MIN){
+        if ((ret = msg_fdpass_body_send(s, id, cbuf_get(cb), blen, 0)) < 0)
+            goto done;
+        if (ret == 1){
+            retval = 0;
+            goto done;
+        } /* else fall through: send inline */
+    }
+    hdr.op_len = htonl(sizeof(hdr) + blen);
+    hdr.op_id = htonl(id);
+    hdr.op_tid = htonl(clixon_trace_id_get());
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = cbuf_get(cb); /* cligen bufs are NUL-terminated at cbuf_len */
+    iov[1].iov_len = blen;
+    if (msg_writev(s, iov, 2) < 0)
         goto done;
     retval = 0;
   done:
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -750,7 +1385,6 @@ send_msg_notify(int           s,
  * @param[in]  xev     Event as XML
  * @retval     0       OK
  * @retval     -1      Error
- * @see send_msg_notify XXX beauty contest
  */
 int
 send_msg_notify_xml(clicon_handle h,
@@ -766,7 +1400,7 @@ send_msg_notify_xml(clicon_handle h,
     }
     if (clixon_xml2cbuf(cb, xev, 0, 0, -1, 0) < 0)
         goto done;
-    if (send_msg_notify(s, cbuf_get(cb)) < 0)
+    if (clicon_msg_send_cbuf(s, 0, cb) < 0)
         goto done;
     retval = 0;
   done:
@@ -254,6 +254,129 @@ clicon_rpc_msg(clicon_handle      h,
     return retval;
 }
 
+/*! Connect to backend or use cached socket and send RPC from a cbuf
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  id      Session id of client
+ * @param[in]  cb      Message body, a NUL-terminated netconf string
+ * @param[out] retdata Returned data as string
+ * @param[out] eof     Set if eof encountered
+ * @param[out] sp      Socket
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clicon_rpc_msg_once  for the pre-assembled clicon_msg variant
+ */
+static int
+clicon_rpc_cbuf_once(clicon_handle h,
+                     uint32_t      id,
+                     cbuf         *cb,
+                     char        **retdata,
+                     int          *eof,
+                     int          *sp)
+{
+    int retval = -1;
+    int s;
+
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if (clicon_rpc_cbuf(s, id, cb, retdata, eof) < 0){
+        /* 2. check socket shutdown AFTER rpc */
+        close(s);
+        s = -1;
+        clicon_client_socket_set(h, -1);
+        goto done;
+    }
+    if (sp)
+        *sp = s;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Send internal netconf rpc from client to backend from a cbuf
+ *
+ * As clicon_rpc_msg, but the message body is sent straight from the cbuf it
+ * was serialized into: no intermediate contiguous clicon_msg is assembled,
+ * see clicon_msg_send_cbuf.
+ * @param[in]    h      CLICON handle
+ * @param[in]    id     Session id of client
+ * @param[in]    cb     Message body, a NUL-terminated netconf string
+ * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
+ * @retval       0      OK
+ * @retval      -1      Error
+ * @see clicon_rpc_msg  for the pre-assembled clicon_msg variant
+ */
+int
+clicon_rpc_msg_cbuf(clicon_handle h,
+                    uint32_t      id,
+                    cbuf         *cb,
+                    cxobj       **xret0)
+{
+    int     retval = -1;
+    char   *retdata = NULL;
+    cxobj  *xret = NULL;
+    int     s = -1;
+    int     eof = 0;
+
+#ifdef RPC_USERNAME_ASSERT
+    assert(strstr(cbuf_get(cb), "username")!=NULL); /* XXX */
+#endif
+    clicon_debug(2, "%s request:%s", __FUNCTION__, cbuf_get(cb));
+    /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
+    if (clicon_rpc_cbuf_once(h, id, cb, &retdata, &eof, &s) < 0)
+        goto done;
+    if (eof){
+        /* 2. check socket shutdown AFTER rpc */
+        close(s);
+        s = -1;
+        clicon_client_socket_set(h, -1);
+#ifdef PROTO_RESTART_RECONNECT
+        if (!clixon_exit_get()) { /* May be part of termination */
+            if (clicon_rpc_cbuf_once(h, id, cb, &retdata, &eof, NULL) < 0)
+                goto done;
+            if (eof){
+                close(s);
+                s = -1;
+                clicon_client_socket_set(h, -1);
+
+                clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+                goto done;
+            }
+            /* To disable this restart, unset PROTO_RESTART_RECONNECT */
+            clicon_session_id_del(h);
+            clicon_log(LOG_WARNING, "The backend was probably restarted and the client has reconnected to the backend. Any locks or candidate edits are lost.");
+
+        }
+#else
+        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+#endif
+    }
+    clicon_debug(2, "%s retdata:%s", __FUNCTION__, retdata);
+
+    if (retdata){
+        /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
+         * to reply.
+         */
+        if (clixon_xml_parse_string(retdata, YB_NONE, NULL, &xret, NULL) < 0)
+            goto done;
+    }
+    if (xret0){
+        *xret0 = xret;
+        xret = NULL;
+    }
+    retval = 0;
+ done:
+    if (retdata)
+        free(retdata);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
 /*! Send internal netconf rpc from client to backend and return a persistent socket
  *
  * @param[in]   h      CLICON handle
@@ -432,6 +555,11 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     cxobj     *xreply;
     yang_stmt *yspec;
     cxobj     *xerr = NULL;
+    uint32_t   session_id;
+    char      *enc = NULL;
+    char      *buf = NULL;
+    size_t     buflen = 0;
+    FILE      *f;
     int        ret;
 
     if ((cb = cbuf_new()) == NULL){
@@ -443,10 +571,38 @@ clicon_rpc_netconf_xml(clicon_handle  h,
         goto done;
     }
     rpcname = xml_name(xname); /* Store rpc name and use in yang binding after reply */
-    if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
-        goto done;
-    if (clicon_rpc_netconf(h, cbuf_get(cb), xret, sp) < 0)
-        goto done;
+    if (sp){
+        if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+            goto done;
+        if (clicon_rpc_netconf(h, cbuf_get(cb), xret, sp) < 0)
+            goto done;
+    }
+    else{ /* Send straight from the cbuf, no clicon_msg assembly copy */
+        if (session_id_check(h, &session_id) < 0)
+            goto done;
+        clicon_data_get(h, "backend-encoding", &enc); /* set after hello above */
+        if (enc && strcmp(enc, "binary") == 0){
+            /* Negotiated in the hello exchange: serialize the tree in binary so
+             * the backend materializes it without an XML parse, see clicon_msg_decode
+             */
+            if ((f = open_memstream(&buf, &buflen)) == NULL){
+                clicon_err(OE_UNIX, errno, "open_memstream");
+                goto done;
+            }
+            ret = clixon_xml2bin(f, xml, 0);
+            fclose(f);
+            if (ret < 0)
+                goto done;
+            if (cbuf_append_buf(cb, buf, buflen) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+        }
+        else if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+            goto done;
+        if (clicon_rpc_msg_cbuf(h, session_id, cb, xret) < 0)
+            goto done;
+    }
     if ((xreply = xml_find_type(*xret, NULL, "rpc-reply", CX_ELMNT)) != NULL &&
         xml_find_type(xreply, NULL, "rpc-error", CX_ELMNT) == NULL){
         yspec = clicon_dbspec_yang(h);
@@ -467,6 +623,8 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     }
     retval = 0;
  done:
+    if (buf)
+        free(buf);
     if (xerr)
         xml_free(xerr);
     if (cb)
@@ -474,6 +632,140 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     return retval;
 }
 
+/*! Send a netconf rpc to the backend without waiting for the reply
+ *
+ * Pipelining: several rpcs can be sent back-to-back on the cached backend
+ * socket and their replies collected afterwards with clicon_rpc_netconf_recv,
+ * paying one round-trip latency for the whole batch instead of one per rpc.
+ * The backend serves a session in message order, so replies arrive in send
+ * order. Do not issue synchronous rpc calls on the same handle until all
+ * outstanding replies have been collected.
+ * @param[in]  h       clicon handle
+ * @param[in]  xmlstr  XML netconf tree as string
+ * @retval     0       OK, rpc sent
+ * @retval    -1       Error
+ * @code
+ *   cxobj *xret = NULL;
+ *   for (i = 0; i < n; i++)
+ *      if (clicon_rpc_netconf_send(h, rpc[i]) < 0)
+ *         err;
+ *   for (i = 0; i < n; i++){
+ *      if (clicon_rpc_netconf_recv(h, &xret) < 0)
+ *         err;
+ *      // use xret
+ *      xml_free(xret);
+ *   }
+ * @endcode
+ * @see clicon_rpc_netconf       synchronous variant
+ * @see clicon_rpc_netconf_recv  which collects one reply
+ */
+int
+clicon_rpc_netconf_send(clicon_handle h,
+                        char         *xmlstr)
+{
+    int                retval = -1;
+    uint32_t           session_id;
+    struct clicon_msg *msg = NULL;
+    int                s;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((msg = clicon_msg_encode(session_id, "%s", xmlstr)) == NULL)
+        goto done;
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto done;
+        clicon_client_socket_set(h, s);
+    }
+    if (clicon_msg_send(s, msg) < 0){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Send a netconf rpc as xml tree to the backend without waiting for the reply
+ *
+ * @param[in]  h    clicon handle
+ * @param[in]  xml  XML netconf tree
+ * @retval     0    OK, rpc sent
+ * @retval    -1    Error
+ * @see clicon_rpc_netconf_send  for the pipelining pattern
+ */
+int
+clicon_rpc_netconf_xml_send(clicon_handle h,
+                            cxobj        *xml)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xml, 0, 0, -1, 0) < 0)
+        goto done;
+    if (clicon_rpc_netconf_send(h, cbuf_get(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Receive one outstanding rpc reply from the backend
+ *
+ * Replies to pipelined rpcs arrive in send order, see clicon_rpc_netconf_send.
+ * @param[in]  h     clicon handle
+ * @param[out] xret  Return XML netconf tree, error or OK (free with xml_free)
+ * @retval     0     OK
+ * @retval    -1     Error, eg backend closed the session
+ * @note The reply is not bound to yang since the rpc name is not known here;
+ *       callers needing a bound tree use xml_bind_yang_rpc_reply themselves
+ */
+int
+clicon_rpc_netconf_recv(clicon_handle h,
+                        cxobj       **xret)
+{
+    int                retval = -1;
+    int                s;
+    int                eof = 0;
+    struct clicon_msg *reply = NULL;
+    cxobj             *xr = NULL;
+
+    if ((s = clicon_client_socket_get(h)) < 0){
+        clicon_err(OE_PROTO, ENOTCONN, "No backend socket");
+        goto done;
+    }
+    if (clicon_msg_rcv(s, &reply, &eof) < 0)
+        goto done;
+    if (eof){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    if (clixon_xml_parse_string(reply->op_body, YB_NONE, NULL, &xr, NULL) < 0)
+        goto done;
+    if (xret){
+        *xret = xr;
+        xr = NULL;
+    }
+    retval = 0;
+ done:
+    if (reply)
+        free(reply);
+    if (xr)
+        xml_free(xr);
+    return retval;
+}
+
 /*! Get database configuration
  *
  * Same as clicon_proto_change just with a cvec instead of lvec
@@ -614,6 +906,175 @@ clicon_rpc_get_config(clicon_handle h,
     return retval;
 }
 
+/*! Get only the leaf values matching an xpath, typically list keys for completion
+ *
+ * Lighter alternative to clicon_rpc_get_config for CLI expand callbacks: the
+ * backend returns the matched values only, without copying the subtree or
+ * filling in defaults. Not all backends support the rpc (and it is refused
+ * with NACM enabled), so a 0 return means "fall back to get-config".
+ * @param[in]  h       CLICON handle
+ * @param[in]  db      Name of database, eg "candidate"
+ * @param[in]  xpath   XPath selecting the leafs, using prefixes in nsc
+ * @param[in]  nsc     Namespace context of xpath
+ * @param[out] values  Values in datastore order, appended as strings.
+ *                     Adjacent duplicates are already removed by the backend.
+ * @retval     1       OK, values appended
+ * @retval     0       Rpc not supported by backend, use get-config instead
+ * @retval    -1       Error
+ * @see clicon_rpc_get_config
+ * @see expand_dbvar
+ */
+int
+clicon_rpc_list_keys(clicon_handle h,
+                     char         *db,
+                     char         *xpath,
+                     cvec         *nsc,
+                     cvec         *values)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xd;
+    cxobj             *xv;
+    char              *body;
+    cg_var            *cv;
+    uint32_t           session_id;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    /* A default (NULL-prefix) namespace declaration on <xpath> would change
+     * the namespace of the element itself, use get-config in that case */
+    if (nsc && xml_nsctx_get(nsc, NULL) != NULL)
+        goto fallback;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\" %s>", NETCONF_BASE_NAMESPACE, NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cb, "<list-keys xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<datastore>%s</datastore>", db);
+    cprintf(cb, "<xpath");
+    if (xml_nsctx_cbuf(cb, nsc) < 0)
+        goto done;
+    cprintf(cb, ">");
+    if (xml_chardata_cbuf_append(cb, xpath) < 0)
+        goto done;
+    cprintf(cb, "</xpath>");
+    cprintf(cb, "</list-keys></rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    /* Any error (unknown rpc on old backend, NACM refusal) means fallback */
+    if (xpath_first(xret, NULL, "/rpc-reply/rpc-error") != NULL)
+        goto fallback;
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply")) == NULL)
+        goto fallback;
+    xv = NULL;
+    while ((xv = xml_child_each(xd, xv, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xv), "value") != 0)
+            continue;
+        if ((body = xml_body(xv)) == NULL)
+            body = "";
+        if ((cv = cvec_add(values, CGV_STRING)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_add");
+            goto done;
+        }
+        cv_string_set(cv, body);
+    }
+    retval = 1;
+  done:
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    if (msg)
+        free(msg);
+    return retval;
+  fallback:
+    retval = 0;
+    goto done;
+}
+
+/*! Get the delta between two datastores from the backend
+ *
+ * The backend computes the diff and returns only the differing subtrees of
+ * either side (with ancestors and list keys for context), so a small pending
+ * change does not require transferring two full configurations.
+ * Not all backends support the rpc (and it is refused with NACM enabled), so
+ * a 0 return means "fall back to get-config of both datastores".
+ * @param[in]  h     CLICON handle
+ * @param[in]  db1   Name of source datastore, eg "running"
+ * @param[in]  db2   Name of target datastore, eg "candidate"
+ * @param[out] xs1   Differing subtrees as in the source, on top <source-config>
+ * @param[out] xs2   Differing subtrees as in the target, on top <target-config>
+ * @retval     1     OK, xs1/xs2 set, free with xml_free
+ * @retval     0     Rpc not supported by backend, use get-config instead
+ * @retval    -1     Error
+ * @see compare_dbs  CLI user
+ */
+int
+clicon_rpc_datastore_diff(clicon_handle h,
+                          char         *db1,
+                          char         *db2,
+                          cxobj       **xs1,
+                          cxobj       **xs2)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *x1 = NULL;
+    cxobj             *x2 = NULL;
+    uint32_t           session_id;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\" %s>", NETCONF_BASE_NAMESPACE, NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cb, "<datastore-diff xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<source>%s</source><target>%s</target>", db1, db2);
+    cprintf(cb, "</datastore-diff></rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    /* Any error (unknown rpc on old backend, NACM refusal) means fallback */
+    if (xpath_first(xret, NULL, "/rpc-reply/rpc-error") != NULL)
+        goto fallback;
+    if ((x1 = xpath_first(xret, NULL, "/rpc-reply/source-config")) == NULL ||
+        (x2 = xpath_first(xret, NULL, "/rpc-reply/target-config")) == NULL)
+        goto fallback;
+    if (xml_rm(x1) < 0 || xml_rm(x2) < 0)
+        goto done;
+    *xs1 = x1;
+    x1 = NULL;
+    *xs2 = x2;
+    x2 = NULL;
+    retval = 1;
+  done:
+    if (retval != 1){ /* x1/x2 may have been removed from xret above */
+        if (x1 && xml_parent(x1) == NULL)
+            xml_free(x1);
+        if (x2 && xml_parent(x2) == NULL)
+            xml_free(x2);
+    }
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    if (msg)
+        free(msg);
+    return retval;
+  fallback:
+    retval = 0;
+    goto done;
+}
+
 /*! Send database entries as XML to backend daemon
  *
  * @param[in] h          CLICON handle
@@ -681,7 +1142,68 @@ clicon_rpc_edit_config(clicon_handle       h,
     return retval;
 }
 
-/*! Send a request to backend to copy a file from one location to another 
+/*! Send a batch of edit payloads to backend as one edit-config-batch rpc
+ *
+ * The edits are applied in order in a single pass with one datastore
+ * serialization at the end, see the clixon-lib edit-config-batch rpc.
+ * @param[in] h        CLICON handle
+ * @param[in] db       Name of database, eg "candidate"
+ * @param[in] editsxml XML string with one or more edit payloads on the form
+ *                     <edit><nr>0</nr><operation>none</operation><config>..</config></edit>
+ * @retval    0        OK
+ * @retval   -1        Error and logged to syslog
+ * @see clicon_rpc_edit_config  for a single payload
+ */
+int
+clicon_rpc_edit_config_batch(clicon_handle h,
+                             char         *db,
+                             char         *editsxml)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cbuf              *cb = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xerr;
+    char              *username;
+    uint32_t           session_id;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR);
+    cprintf(cb, "><edit-config-batch xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cb, "<target>%s</target>", db);
+    cprintf(cb, "%s", editsxml);
+    cprintf(cb, "</edit-config-batch></rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Editing configuration", NULL);
+        goto done;
+    }
+    retval = 0;
+  done:
+    if (xret)
+        xml_free(xret);
+    if (cb)
+        cbuf_free(cb);
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Send a request to backend to copy a file from one location to another
  *
  * Note this assumes the backend can access these files and (usually) assumes
  * clients and servers have the access to the same filesystem.
@@ -1684,6 +2206,73 @@ clicon_rpc_debug(clicon_handle h,
     return retval;
 }
 
+/*! Get running datastore generation from backend
+ * The generation is a counter bumped on every modification of running, so a
+ * poller can compare it between polls and skip re-reading unchanged data.
+ * @param[in]  h    CLICON handle
+ * @param[out] gen  Current generation
+ * @retval     0    OK
+ * @retval    -1    Error and logged to syslog
+ * @see from_client_generation
+ */
+int
+clicon_rpc_generation(clicon_handle h,
+                      uint64_t     *gen)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+    cxobj             *xret = NULL;
+    cxobj             *xerr;
+    cxobj             *x;
+    char              *body;
+    char              *username;
+    uint32_t           session_id;
+    cbuf              *cb = NULL;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<generation xmlns=\"%s\"/>", CLIXON_LIB_NS);
+    cprintf(cb, "</rpc>");
+    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    if (clicon_rpc_msg(h, msg, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Get generation", NULL);
+        goto done;
+    }
+    if ((x = xpath_first(xret, NULL, "//rpc-reply/generation")) == NULL ||
+        (body = xml_body(x)) == NULL){
+        clicon_err(OE_XML, 0, "No generation in rpc-reply");
+        goto done;
+    }
+    if (gen && parse_uint64(body, gen, NULL) < 1){
+        clicon_err(OE_XML, errno, "parse_uint64");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (msg)
+        free(msg);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
 /*! Send a debug request to backend server to set restconf debug
  * @param[in] h        CLICON handle
  * @param[in] level    Debug level
@@ -1825,8 +2414,45 @@ clicon_hello_req(clicon_handle h,
     }
     b = xml_body(x);
     if ((ret = parse_uint32(b, id, NULL)) <= 0){
-        clicon_err(OE_XML, errno, "parse_uint32"); 
-        goto done;
+        clicon_err(OE_XML, errno, "parse_uint32");
+        goto done;
+    }
+    /* If the backend accepts binary serialized payloads, remember it so
+     * that rpc:s with XML trees skip the print/parse hop, see clicon_rpc_netconf_xml
+     * The capability set is fingerprinted (FNV-1a): on reconnect to a backend
+     * advertising the same set, the scan and handle-data updates are skipped.
+     */
+    if ((x = xpath_first(xret, NULL, "hello/capabilities")) != NULL){
+        cxobj   *xcap = NULL;
+        uint32_t fp = 2166136261u; /* FNV-1a offset basis */
+        char     fpstr[16];
+        char    *prev = NULL;
+        size_t   i;
+        size_t   blen;
+
+        while ((xcap = xml_child_each(x, xcap, CX_ELMNT)) != NULL)
+            if ((b = xml_body(xcap)) != NULL){
+                blen = strlen(b);
+                for (i = 0; i <= blen; i++){ /* incl NUL separator */
+                    fp ^= (unsigned char)b[i];
+                    fp *= 16777619u;
+                }
+            }
+        snprintf(fpstr, sizeof(fpstr), "%08x", fp);
+        if (clicon_data_get(h, "backend-caps-fp", &prev) < 0 ||
+            prev == NULL ||
+            strcmp(prev, fpstr) != 0){
+            xcap = NULL;
+            while ((xcap = xml_child_each(x, xcap, CX_ELMNT)) != NULL)
+                if ((b = xml_body(xcap)) != NULL &&
+                    strcmp(b, CLIXON_BINARY_CAPABILITY) == 0){
+                    if (clicon_data_set(h, "backend-encoding", "binary") < 0)
+                        goto done;
+                    break;
+                }
+            if (clicon_data_set(h, "backend-caps-fp", fpstr) < 0)
+                goto done;
+        }
     }
     retval = 0;
  done:
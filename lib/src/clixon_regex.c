@@ -65,6 +65,25 @@
 #include "clixon_options.h"
 #include "clixon_regex.h"
 
+/*
+ * Local variables
+ */
+/* Process-wide cache of compiled patterns: "<mode> <pattern>" -> compiled regex.
+ * Yang modules reuse the same patterns (eg inet:ip-address) in many leafs and
+ * the same pattern was translated and compiled once per type statement. With
+ * this cache each unique pattern is compiled once per process and shared.
+ * The cache owns the compiled objects: callers of regex_compile must not free
+ * them, see regex_cache_free
+ */
+static clicon_hash_t *_regex_cache = NULL;
+
+/* Process-wide cache of XSD to POSIX pattern translations: pattern -> posix.
+ * Shared by the validation path (regex_compile) and autocli generation
+ * (yang2cli_var_pattern) so each unique pattern is translated once per
+ * process instead of once per leaf, see regexp_xsd2posix_shared
+ */
+static clicon_hash_t *_xsd2posix_cache = NULL;
+
 /*-------------------------- POSIX translation -------------------------*/
 
 /* parse 4 digit hexadecimal number */
@@ -366,6 +385,49 @@ regexp_xsd2posix(char  *xsd,
     return retval;
 }
 
+/*! As regexp_xsd2posix but return a shared translation from a process cache
+ *
+ * Yang modules repeat the same patterns (eg inet:ip-address) in many leafs:
+ * the character-by-character translation is done once per unique pattern and
+ * the result shared thereafter.
+ * @param[in]  xsd    Input regex string according XSD
+ * @param[out] posix  Translated string. Owned by the cache: do not free,
+ *                    valid until regex_cache_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see regexp_xsd2posix  for the translation itself
+ */
+int
+regexp_xsd2posix_shared(char  *xsd,
+                        char **posix)
+{
+    int    retval = -1;
+    char  *p0 = NULL;
+    char  *p;
+    size_t vlen;
+
+    if (_xsd2posix_cache == NULL &&
+        (_xsd2posix_cache = clicon_hash_init()) == NULL)
+        goto done;
+    if ((p = clicon_hash_value(_xsd2posix_cache, xsd, &vlen)) != NULL){
+        *posix = p;
+        retval = 0;
+        goto done;
+    }
+    if (regexp_xsd2posix(xsd, &p0) < 0)
+        goto done;
+    if (clicon_hash_add(_xsd2posix_cache, xsd, p0, strlen(p0)+1) == NULL)
+        goto done;
+    if ((p = clicon_hash_value(_xsd2posix_cache, xsd, &vlen)) == NULL)
+        goto done;
+    *posix = p;
+    retval = 0;
+ done:
+    if (p0)
+        free(p0);
+    return retval;
+}
+
 /*-------------------------- Generic API functions ------------------------*/
 
 /*! Compilation of regular expression / pattern
@@ -378,6 +440,8 @@ regexp_xsd2posix(char  *xsd,
  * @note Clixon supports Yang's XSD regexp only. But CLIgen can support both
  *       POSIX and XSD(using libxml2). But to use CLIgen's POSIX, Clixon must
  *       translate from XSD to POSIX.
+ * @note The returned object is shared and owned by a process-wide cache and
+ *       must not be freed by the caller, see regex_cache_free
  */
 int
 regex_compile(clicon_handle h,
@@ -385,11 +449,29 @@ regex_compile(clicon_handle h,
               void        **recomp)
 {
     int              retval = -1;
-    char            *posix = NULL;    /* Transform to posix regex */
-
-    switch (clicon_yang_regexp(h)){
+    char            *posix;           /* Transform to posix regex, cache-owned */
+    int              mode;
+    cbuf            *cb = NULL;
+    void           **rep;
+    size_t           vlen;
+
+    mode = clicon_yang_regexp(h);
+    if (_regex_cache == NULL &&
+        (_regex_cache = clicon_hash_init()) == NULL)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%d %s", mode, regexp);
+    if ((rep = clicon_hash_value(_regex_cache, cbuf_get(cb), &vlen)) != NULL){
+        *recomp = *rep; /* shared, cache-owned */
+        retval = 1;
+        goto done;
+    }
+    switch (mode){
     case REGEXP_POSIX:
-        if (regexp_xsd2posix(regexp, &posix) < 0)
+        if (regexp_xsd2posix_shared(regexp, &posix) < 0)
             goto done;
         retval = cligen_regex_posix_compile(posix, recomp);
         break;
@@ -397,13 +479,70 @@ regex_compile(clicon_handle h,
         retval = cligen_regex_libxml2_compile(regexp, recomp);
         break;
     default:
-        clicon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", clicon_yang_regexp(h));
+        clicon_err(OE_CFG, 0, "clicon_yang_regexp invalid value: %d", mode);
         break;
     }
     /* retval from fns above */
+    if (retval == 1 &&
+        clicon_hash_add(_regex_cache, cbuf_get(cb), recomp, sizeof(*recomp)) == NULL)
+        retval = -1;
  done:
-    if (posix)
-        free(posix);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Free all cached compiled regexps
+ *
+ * The cache is valid over the lifetime of the process: this is an explicit
+ * cleanup for embedding applications, eg to get clean memory leak checks.
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see regex_compile  where the cache is populated
+ */
+int
+regex_cache_free(void)
+{
+    int     retval = -1;
+    char  **keys = NULL;
+    size_t  klen = 0;
+    void  **rep;
+    size_t  vlen;
+    void   *p;
+    int     i;
+
+    if (_regex_cache == NULL){
+        retval = 0;
+        goto done;
+    }
+    if (clicon_hash_keys(_regex_cache, &keys, &klen) < 0)
+        goto done;
+    for (i=0; i<(int)klen; i++){
+        if ((rep = clicon_hash_value(_regex_cache, keys[i], &vlen)) == NULL)
+            continue;
+        switch (atoi(keys[i])){ /* key is "<mode> <pattern>" */
+        case REGEXP_POSIX:
+            cligen_regex_posix_free(*rep);
+            if ((p = *rep) != NULL)
+                free(p);
+            break;
+        case REGEXP_LIBXML2:
+            cligen_regex_libxml2_free(*rep);
+            break;
+        default:
+            break;
+        }
+    }
+    clicon_hash_free(_regex_cache);
+    _regex_cache = NULL;
+    retval = 0;
+ done:
+    if (_xsd2posix_cache){ /* values are inline string copies */
+        clicon_hash_free(_xsd2posix_cache);
+        _xsd2posix_cache = NULL;
+    }
+    if (keys)
+        free(keys);
     return retval;
 }
 
@@ -438,7 +577,9 @@ regex_exec(clicon_handle h,
 
 /*! Free of (pre-compiled) regular expression / pattern
  * @param[in]  h       Clicon handle
- * @param[in]  recomp  Compiled regular expression 
+ * @param[in]  recomp  Compiled regular expression
+ * @note Must not be used on objects returned by regex_compile: those are
+ *       shared and owned by the process-wide cache, see regex_cache_free
  */
 int
 regex_free(clicon_handle h,
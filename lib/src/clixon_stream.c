@@ -61,10 +61,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <errno.h>
 #include <inttypes.h>
 #include <syslog.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -90,6 +95,23 @@
 /* Go through and timeout subscription timers [s] */
 #define STREAM_TIMER_TIMEOUT_S 5
 
+/* Disk-backed replay: fixed-size record appended to the time index file and
+ * mmap'd on replay for binary search on <startTime>
+ */
+struct stream_logrec{
+    struct timeval lr_tv;  /* time index */
+    off_t          lr_off; /* offset of event in the event log file */
+    uint32_t       lr_len; /* length of event in the event log file */
+};
+
+/*
+ * Forward declarations
+ */
+static int stream_replay_buf_evict(struct stream_replay_buf *rb);
+static int stream_replay_buf_free(event_stream_t *es);
+static int stream_replay_log_close(event_stream_t *es);
+static int stream_replay_log_trim(event_stream_t *es, struct timeval *tret);
+
 /*! Find an event notification stream given name
  * @param[in]  h    Clicon handle
  * @param[in]  name Name of stream
@@ -146,6 +168,8 @@ stream_add(clicon_handle   h,
         goto done;
     }
     es->es_replay_enabled = replay_enabled;
+    es->es_logfd = -1;
+    es->es_idxfd = -1;
     if (retention)
         es->es_retention = *retention;
     clicon_stream_append(h, es);
@@ -163,11 +187,10 @@ int
 stream_delete_all(clicon_handle h,
                   int           force)
 {
-    struct stream_replay *r;
     struct stream_subscription *ss;
     event_stream_t       *es;
     event_stream_t       *head = clicon_stream(h);
-    
+
     while ((es = clicon_stream(h)) != NULL){
         DELQ(es, head, event_stream_t *);
         clicon_stream_set(h, head);
@@ -177,12 +200,8 @@ stream_delete_all(clicon_handle h,
             free(es->es_description);
         while ((ss = es->es_subscription) != NULL)
             stream_ss_rm(h, es, ss, force); /* XXX in some cases leaks memory due to DONT clause in stream_ss_rm() */
-        while ((r = es->es_replay) != NULL){
-            DELQ(r, es->es_replay, struct stream_replay *);
-            if (r->r_xml)
-                xml_free(r->r_xml);
-            free(r);
-        }
+        stream_replay_buf_free(es);
+        stream_replay_log_close(es);
         free(es);
     }
     return 0;
@@ -248,9 +267,8 @@ stream_timer_setup(int   fd,
     event_stream_t              *es;
     struct stream_subscription  *ss;
     struct stream_subscription  *ss1;
-    struct stream_replay        *r;
-    struct stream_replay        *r1;
-    
+    struct stream_replay_buf    *rb;
+
     clicon_debug(2, "%s", __FUNCTION__);
     /* Go thru callbacks and see if any have timed out, if so remove them 
      * Could also be done by a separate timer.
@@ -277,21 +295,18 @@ stream_timer_setup(int   fd,
                         ss = NEXTQ(struct stream_subscription *, ss);
                 } while (ss && ss != es->es_subscription);
   /* 2) Go throughreplay buffer and remove entries with passed retention time */
-            if (timerisset(&es->es_retention) &&
-                (r = es->es_replay) != NULL){
+            if (timerisset(&es->es_retention) && es->es_logfd != -1){
                 timersub(&now, &es->es_retention, &tret);
-                do {
-                    if (timercmp(&r->r_tv, &tret, <)){
-                        r1 = NEXTQ(struct stream_replay *, r);
-                        DELQ(r, es->es_replay, struct stream_replay *);
-                        if (r->r_xml)
-                            xml_free(r->r_xml);
-                        free(r);
-                        r = r1;
-                    }
-                    else
-                        r = NEXTQ(struct stream_replay *, r);
-                } while (r && r!=es->es_replay);
+                if (stream_replay_log_trim(es, &tret) < 0)
+                    goto done;
+            }
+            else if (timerisset(&es->es_retention) &&
+                (rb = es->es_replay) != NULL){
+                timersub(&now, &es->es_retention, &tret);
+                /* Entries are in time order: evict from the oldest end */
+                while (rb->rb_len &&
+                       timercmp(&rb->rb_ev[rb->rb_start].re_tv, &tret, <))
+                    stream_replay_buf_evict(rb);
             }
             es = NEXTQ(struct event_stream *, es);
         } while (es && es != clicon_stream(h));
@@ -319,6 +334,146 @@ stream_del()
 }
 #endif
 
+/*! Check that s[0..len) is a relative chain of unprefixed names: a/b/c
+ * @param[in] s    String, not necessarily NULL-terminated at len
+ * @param[in] len  Length of path part
+ * @retval    1    Valid
+ * @retval    0    Not valid
+ */
+static int
+filter_path_ok(char  *s,
+               size_t len)
+{
+    size_t i;
+
+    if (len == 0)
+        return 0;
+    for (i=0; i<len; i++){
+        if ((i == 0 || s[i-1] == '/') &&
+            !isalpha((int)s[i]) && s[i] != '_')
+            return 0;
+        if (!isalnum((int)s[i]) &&
+            s[i] != '-' && s[i] != '_' && s[i] != '.' && s[i] != '/')
+            return 0;
+        if (s[i] == '/' && (i == len-1 || s[i-1] == '/'))
+            return 0;
+    }
+    return 1;
+}
+
+/*! Classify a subscription filter at subscribe time
+ * @param[in] ss   Subscription with ss_xpath set
+ * @retval    0    OK, ss_fclass (and ss_fpath/ss_fleaf/ss_fval) set
+ * @retval    -1   Error
+ * Recognizes the common nodeset filter forms a/b and a/b[leaf='value'] with
+ * relative unprefixed names, which fanout matches directly against the event
+ * tree, see subscription_eq_match. Everything else keeps general xpath
+ * evaluation (via the compiled-xpath cache).
+ */
+static int
+subscription_filter_classify(struct stream_subscription *ss)
+{
+    char  *xp = ss->ss_xpath;
+    char  *lb;
+    char  *leaf;
+    char  *eq;
+    char  *v;
+    size_t vlen;
+    char   q;
+
+    if (xp == NULL || strlen(xp) == 0){
+        ss->ss_fclass = SS_FILTER_ALL;
+        goto ok;
+    }
+    ss->ss_fclass = SS_FILTER_XPATH;
+    if ((lb = strchr(xp, '[')) == NULL){ /* form: a/b */
+        if (!filter_path_ok(xp, strlen(xp)))
+            goto ok;
+        if ((ss->ss_fpath = strdup(xp)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            return -1;
+        }
+        ss->ss_fclass = SS_FILTER_EQ;
+        goto ok;
+    }
+    /* form: a/b[leaf='value'] */
+    if (!filter_path_ok(xp, lb-xp))
+        goto ok;
+    leaf = lb+1;
+    if ((eq = strchr(leaf, '=')) == NULL)
+        goto ok;
+    if (!filter_path_ok(leaf, eq-leaf) || memchr(leaf, '/', eq-leaf) != NULL)
+        goto ok;
+    v = eq+1;
+    vlen = strlen(v);
+    q = v[0];
+    if (q != '\'' && q != '\"')
+        goto ok;
+    if (vlen < 3 || v[vlen-1] != ']' || v[vlen-2] != q)
+        goto ok;
+    if (memchr(v+1, q, vlen-3) != NULL)
+        goto ok;
+    if ((ss->ss_fpath = strndup(xp, lb-xp)) == NULL ||
+        (ss->ss_fleaf = strndup(leaf, eq-leaf)) == NULL ||
+        (ss->ss_fval = strndup(v+1, vlen-3)) == NULL){
+        clicon_err(OE_UNIX, errno, "strndup");
+        return -1;
+    }
+    ss->ss_fclass = SS_FILTER_EQ;
+ ok:
+    return 0;
+}
+
+/*! Match a classified equality filter directly against an event tree
+ * @param[in] xn    Context node (event or recursion node)
+ * @param[in] path  Relative node path, see subscription_filter_classify
+ * @param[in] leaf  Predicate leaf name, or NULL for plain existence
+ * @param[in] val   Predicate literal
+ * @retval    1     Match
+ * @retval    0     No match
+ * Equivalent to xpath_first with nsc NULL on the recognized forms: names
+ * match on unprefixed nodes only, and the predicate is true if any child
+ * leaf has the given body.
+ */
+static int
+subscription_eq_match(cxobj *xn,
+                      char  *path,
+                      char  *leaf,
+                      char  *val)
+{
+    cxobj *x = NULL;
+    cxobj *xc;
+    char  *slash;
+    char  *body;
+    size_t len;
+
+    if ((slash = strchr(path, '/')) != NULL)
+        len = slash - path;
+    else
+        len = strlen(path);
+    while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL){
+        if (xml_prefix(x) != NULL)
+            continue;
+        if (strlen(xml_name(x)) != len || strncmp(xml_name(x), path, len) != 0)
+            continue;
+        if (slash){
+            if (subscription_eq_match(x, slash+1, leaf, val))
+                return 1;
+            continue;
+        }
+        if (leaf == NULL)
+            return 1;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+            if (xml_prefix(xc) != NULL || strcmp(xml_name(xc), leaf) != 0)
+                continue;
+            if ((body = xml_body(xc)) != NULL && strcmp(body, val) == 0)
+                return 1;
+        }
+    }
+    return 0;
+}
+
 /*! Add an event notification callback to a stream given a callback function
  * @param[in]  h        Clicon handle
  * @param[in]  stream   Name of stream
@@ -364,6 +519,9 @@ stream_ss_add(clicon_handle     h,
         clicon_err(OE_CFG, errno, "strdup");
         goto done;
     }
+    /* Compile/classify the filter once, fanout uses the result per event */
+    if (subscription_filter_classify(ss) < 0)
+        goto done;
     ss->ss_fn     = fn;
     ss->ss_arg    = arg;
     ADDQ(ss, es->es_subscription);
@@ -397,6 +555,12 @@ stream_ss_rm(clicon_handle                h,
             free(ss->ss_stream);
         if (ss->ss_xpath)
             free(ss->ss_xpath);
+        if (ss->ss_fpath)
+            free(ss->ss_fpath);
+        if (ss->ss_fleaf)
+            free(ss->ss_fleaf);
+        if (ss->ss_fval)
+            free(ss->ss_fval);
         free(ss);
     }
     clicon_debug(1, "%s retval: 0", __FUNCTION__);
@@ -493,16 +657,59 @@ stream_ss_delete(clicon_handle     h,
  * @see stream_notify
  * @see stream_ss_timeout where subscriptions are removed if stoptime<now
  */
+/* Single-serialization fanout state: the event being distributed by
+ * stream_notify1 and its shared XML encoding. Valid only during the
+ * subscriber loop; subscriber callbacks read it with stream_event_encoded()
+ * instead of serializing the same tree once per client.
+ */
+static cxobj   *_fanout_xev = NULL;
+static cbuf    *_fanout_cb  = NULL;
+static uint64_t _fanout_seq = 0;
+
+/*! Get the shared encoding of the event being distributed to subscribers
+ * @param[in]  xevent  Event as passed to the subscriber callback
+ * @param[out] seq     Distribution sequence number, differs between events
+ * @retval     str     Shared XML encoding, valid only during the callback
+ * @retval     NULL    Not inside an event fanout (eg replay)
+ * Use seq to detect whether a result derived from the encoding (eg an encoded
+ * message) can be reused for further subscribers of the same event.
+ * @see stream_notify1
+ */
+char *
+stream_event_encoded(cxobj    *xevent,
+                     uint64_t *seq)
+{
+    if (xevent == NULL || xevent != _fanout_xev || _fanout_cb == NULL)
+        return NULL;
+    if (seq)
+        *seq = _fanout_seq;
+    return cbuf_get(_fanout_cb);
+}
+
 static int
-stream_notify1(clicon_handle   h, 
+stream_notify1(clicon_handle   h,
                event_stream_t *es,
                struct timeval *tv,
                cxobj          *xevent)
 {
     int                         retval = -1;
     struct stream_subscription *ss;
-    
+    int                         match;
+
     clicon_debug(2, "%s", __FUNCTION__);
+    /* Serialize the event once and share it with all subscriber callbacks,
+     * see stream_event_encoded()
+     */
+    if (es->es_subscription != NULL){
+        if ((_fanout_cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(_fanout_cb, xevent, 0, 0, -1, 0) < 0)
+            goto done;
+        _fanout_xev = xevent;
+        _fanout_seq++;
+    }
     /* Go thru all subscriptions and find matches */
     if ((ss = es->es_subscription) != NULL)
         do {
@@ -515,10 +722,20 @@ stream_notify1(clicon_handle   h,
                     goto done;
                 ss = ss1;
             }
-            else{  /* xpath match */
-                if (ss->ss_xpath == NULL ||
-                    strlen(ss->ss_xpath)==0 ||
-                    xpath_first(xevent, NULL, "%s", ss->ss_xpath) != NULL)
+            else{  /* filter match, classified at subscribe time */
+                switch (ss->ss_fclass){
+                case SS_FILTER_ALL:
+                    match = 1;
+                    break;
+                case SS_FILTER_EQ:
+                    match = subscription_eq_match(xevent, ss->ss_fpath,
+                                                  ss->ss_fleaf, ss->ss_fval);
+                    break;
+                default: /* general xpath via the compiled-xpath cache */
+                    match = xpath_first(xevent, NULL, "%s", ss->ss_xpath) != NULL;
+                    break;
+                }
+                if (match)
                     if ((*ss->ss_fn)(h, 0, xevent, ss->ss_arg) < 0)
                         goto done;
                 ss = NEXTQ(struct stream_subscription *, ss);
@@ -526,6 +743,11 @@ stream_notify1(clicon_handle   h,
         } while (es->es_subscription && ss != es->es_subscription);
     retval = 0;
   done:
+    _fanout_xev = NULL;
+    if (_fanout_cb){
+        cbuf_free(_fanout_cb);
+        _fanout_cb = NULL;
+    }
     return retval;
 }
 
@@ -702,71 +924,521 @@ stream_notify_xml(clicon_handle h,
          the future are valid.  This parameter is of type dateTime and
          compliant to [RFC3339].  Implementations must support time
          zones.
-         
+
  * Assume no future sample timestamps.
  */
+/*! Replay from a disk-backed event log by index seek + sequential read
+ * @param[in] h    Clicon handle
+ * @param[in] es   Stream with disk-backed replay, see stream_replay_log
+ * @param[in] ss   Subscription with starttime set
+ * The time index is mmap'd and binary searched for <startTime>, then events
+ * are read from the log one at a time so replay memory stays bounded
+ * regardless of retention length.
+ */
+static int
+stream_replay_notify_log(clicon_handle               h,
+                         event_stream_t             *es,
+                         struct stream_subscription *ss)
+{
+    int                   retval = -1;
+    struct stream_logrec *lri = NULL; /* mmap'd time index */
+    struct stat           st;
+    size_t                n = 0;
+    size_t                lo;
+    size_t                hi;
+    size_t                mid;
+    size_t                i;
+    char                 *buf = NULL;
+    cxobj                *xev = NULL;
+
+    if (fstat(es->es_idxfd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", es->es_idxpath);
+        goto done;
+    }
+    if ((n = st.st_size/sizeof(*lri)) == 0)
+        goto ok; /* No samples to replay */
+    if ((lri = mmap(NULL, n*sizeof(*lri), PROT_READ, MAP_SHARED,
+                    es->es_idxfd, 0)) == MAP_FAILED){
+        clicon_err(OE_UNIX, errno, "mmap(%s)", es->es_idxpath);
+        lri = NULL;
+        goto done;
+    }
+    /* Binary search for first record with timestamp >= starttime */
+    lo = 0;
+    hi = n;
+    while (lo < hi){
+        mid = (lo + hi)/2;
+        if (timercmp(&lri[mid].lr_tv, &ss->ss_starttime, >=))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    /* Then notify until stop */
+    for (i=lo; i<n; i++){
+        if (timerisset(&ss->ss_stoptime) &&
+            timercmp(&lri[i].lr_tv, &ss->ss_stoptime, >))
+            break;
+        if ((buf = malloc(lri[i].lr_len + 1)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (pread(es->es_logfd, buf, lri[i].lr_len, lri[i].lr_off) !=
+            (ssize_t)lri[i].lr_len){
+            clicon_err(OE_UNIX, errno, "pread(%s)", es->es_logpath);
+            goto done;
+        }
+        buf[lri[i].lr_len] = '\0';
+        if (clixon_xml_parse_string(buf, YB_NONE, NULL, &xev, NULL) < 0)
+            goto done;
+        if (xml_rootchild(xev, 0, &xev) < 0)
+            goto done;
+        if ((*ss->ss_fn)(h, 0, xev, ss->ss_arg) < 0)
+            goto done;
+        xml_free(xev);
+        xev = NULL;
+        free(buf);
+        buf = NULL;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xev)
+        xml_free(xev);
+    if (buf)
+        free(buf);
+    if (lri)
+        munmap(lri, n*sizeof(*lri));
+    return retval;
+}
+
 static int
 stream_replay_notify(clicon_handle               h,
                      event_stream_t             *es,
                      struct stream_subscription *ss)
 {
-    int                   retval = -1;
-    struct stream_replay *r;
+    int                       retval = -1;
+    struct stream_replay_buf *rb;
+    struct stream_replay_ev  *re;
+    size_t                    lo;
+    size_t                    hi;
+    size_t                    mid;
+    size_t                    i;
 
     /* If <startTime> is not present, this is not a replay */
     if (!timerisset(&ss->ss_starttime))
         goto ok;
     if (!es->es_replay_enabled)
         goto ok;
-    /* Get replay linked list */
-    if ((r = es->es_replay) == NULL)
-        goto ok;
-    /* First loop to skip until start */
-    do {
-        if (timercmp(&r->r_tv, &ss->ss_starttime, >=))
-            break;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
-    if (r == NULL)
+    if (es->es_logfd != -1) /* Disk-backed replay log */
+        return stream_replay_notify_log(h, es, ss);
+    if ((rb = es->es_replay) == NULL || rb->rb_len == 0)
         goto ok; /* No samples to replay */
+    /* Binary search for first entry with timestamp >= starttime.
+     * Entries are stored in time order, oldest first.
+     */
+    lo = 0;
+    hi = rb->rb_len;
+    while (lo < hi){
+        mid = (lo + hi)/2;
+        re = &rb->rb_ev[(rb->rb_start + mid)%rb->rb_maxcount];
+        if (timercmp(&re->re_tv, &ss->ss_starttime, >=))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
     /* Then notify until stop */
-    do {
+    for (i=lo; i<rb->rb_len; i++){
+        re = &rb->rb_ev[(rb->rb_start + i)%rb->rb_maxcount];
         if (timerisset(&ss->ss_stoptime) &&
-            timercmp(&r->r_tv, &ss->ss_stoptime, >))
+            timercmp(&re->re_tv, &ss->ss_stoptime, >))
             break;
-        if ((*ss->ss_fn)(h, 0, r->r_xml, ss->ss_arg) < 0)
+        if ((*ss->ss_fn)(h, 0, re->re_xml, ss->ss_arg) < 0)
             goto done;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
+    }
  ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Evict the oldest event from a replay ring buffer
+ * @param[in] rb   Replay ring buffer
+ */
+static int
+stream_replay_buf_evict(struct stream_replay_buf *rb)
+{
+    struct stream_replay_ev *re;
+
+    if (rb == NULL || rb->rb_len == 0)
+        return 0;
+    re = &rb->rb_ev[rb->rb_start];
+    if (re->re_xml){
+        xml_free(re->re_xml);
+        re->re_xml = NULL;
+    }
+    rb->rb_bytes -= re->re_size;
+    re->re_size = 0;
+    rb->rb_start = (rb->rb_start + 1)%rb->rb_maxcount;
+    rb->rb_len--;
+    return 0;
+}
+
+/*! Free the replay ring buffer of a stream including all stored events
+ * @param[in] es   Stream
+ */
+static int
+stream_replay_buf_free(event_stream_t *es)
+{
+    struct stream_replay_buf *rb;
+
+    if ((rb = es->es_replay) == NULL)
+        return 0;
+    while (rb->rb_len)
+        stream_replay_buf_evict(rb);
+    if (rb->rb_ev)
+        free(rb->rb_ev);
+    free(rb);
+    es->es_replay = NULL;
+    return 0;
+}
+
+/*! Allocate a replay ring buffer for a stream with given bounds
+ * @param[in] es        Stream
+ * @param[in] maxcount  Count cap: max number of stored events
+ * @param[in] maxbytes  Byte cap: max total in-memory size, 0: no byte cap
+ * @retval    rb        New replay buffer, also assigned to es
+ * @retval    NULL      Error
+ */
+static struct stream_replay_buf *
+stream_replay_buf_new(event_stream_t *es,
+                      size_t          maxcount,
+                      size_t          maxbytes)
+{
+    struct stream_replay_buf *rb = NULL;
+
+    if ((rb = malloc(sizeof(*rb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(rb, 0, sizeof(*rb));
+    rb->rb_maxcount = maxcount;
+    rb->rb_maxbytes = maxbytes;
+    if ((rb->rb_ev = calloc(rb->rb_maxcount, sizeof(*rb->rb_ev))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        free(rb);
+        return NULL;
+    }
+    es->es_replay = rb;
+    return rb;
+}
+
+/*! Set replay buffer bounds of a stream
+ * @param[in] es        Stream
+ * @param[in] maxcount  Count cap: max number of stored events
+ * @param[in] maxbytes  Byte cap: max total in-memory size, 0: no byte cap
+ * @retval    0         OK
+ * @retval    -1        Error
+ * @note Replaces the replay buffer: already stored events are dropped
+ */
+int
+stream_replay_limits(event_stream_t *es,
+                     size_t          maxcount,
+                     size_t          maxbytes)
+{
+    int retval = -1;
+
+    if (maxcount == 0){
+        clicon_err(OE_CFG, EINVAL, "maxcount is zero");
+        goto done;
+    }
+    stream_replay_buf_free(es);
+    if (stream_replay_buf_new(es, maxcount, maxbytes) == NULL)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Enable disk-backed replay for a stream
+ * @param[in] h      Clicon handle
+ * @param[in] stream Name of stream
+ * @param[in] dir    Directory for the log files: <dir>/<stream>.log + .idx
+ * @retval    0      OK
+ * @retval    -1     Error
+ * Events are appended to <dir>/<stream>.log with a fixed-size record per
+ * event in <dir>/<stream>.idx for binary search on <startTime>. Existing log
+ * files are reused, so retained events survive a restart. The heap replay
+ * buffer is not used for a disk-backed stream. Retention trimming compacts
+ * the files, see stream_replay_log_trim.
+ */
+int
+stream_replay_log(clicon_handle h,
+                  char         *stream,
+                  char         *dir)
+{
+    int             retval = -1;
+    event_stream_t *es;
+    cbuf           *cb = NULL;
+    struct stat     st;
+
+    if ((es = stream_find(h, stream)) == NULL){
+        clicon_err(OE_CFG, ENOENT, "Stream %s not found", stream);
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    stream_replay_log_close(es); /* if re-configured */
+    cprintf(cb, "%s/%s.log", dir, stream);
+    if ((es->es_logpath = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    cbuf_reset(cb);
+    cprintf(cb, "%s/%s.idx", dir, stream);
+    if ((es->es_idxpath = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((es->es_logfd = open(es->es_logpath, O_RDWR|O_CREAT|O_APPEND,
+                             S_IRUSR|S_IWUSR)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", es->es_logpath);
+        goto done;
+    }
+    if (fstat(es->es_logfd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", es->es_logpath);
+        goto done;
+    }
+    es->es_logoff = st.st_size;
+    if ((es->es_idxfd = open(es->es_idxpath, O_RDWR|O_CREAT|O_APPEND,
+                             S_IRUSR|S_IWUSR)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", es->es_idxpath);
+        goto done;
+    }
+    stream_replay_buf_free(es);
+    es->es_replay_enabled = 1;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Close a disk-backed replay log, the files themselves are kept
+ * @param[in] es   Stream
+ */
+static int
+stream_replay_log_close(event_stream_t *es)
+{
+    if (es->es_logfd != -1){
+        close(es->es_logfd);
+        es->es_logfd = -1;
+    }
+    if (es->es_idxfd != -1){
+        close(es->es_idxfd);
+        es->es_idxfd = -1;
+    }
+    if (es->es_logpath){
+        free(es->es_logpath);
+        es->es_logpath = NULL;
+    }
+    if (es->es_idxpath){
+        free(es->es_idxpath);
+        es->es_idxpath = NULL;
+    }
+    es->es_logoff = 0;
+    return 0;
+}
+
+/*! Drop events older than the retention limit from a disk-backed replay log
+ * @param[in] es    Stream with disk-backed replay
+ * @param[in] tret  Events with timestamp before this are expired
+ * To keep trimming cheap, the files are only compacted when at least half of
+ * the stored events have expired: remaining events are copied to temp files
+ * which then replace the originals.
+ */
+static int
+stream_replay_log_trim(event_stream_t *es,
+                       struct timeval *tret)
+{
+    int                   retval = -1;
+    struct stream_logrec *lri = NULL; /* mmap'd time index */
+    struct stream_logrec  lr;
+    struct stat           st;
+    size_t                n = 0;
+    size_t                lo;
+    size_t                hi;
+    size_t                mid;
+    size_t                i;
+    char                 *buf = NULL;
+    cbuf                 *cblog = NULL;
+    cbuf                 *cbidx = NULL;
+    int                   newlog = -1;
+    int                   newidx = -1;
+    off_t                 off = 0;
+
+    if (fstat(es->es_idxfd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat(%s)", es->es_idxpath);
+        goto done;
+    }
+    if ((n = st.st_size/sizeof(*lri)) == 0)
+        goto ok;
+    if ((lri = mmap(NULL, n*sizeof(*lri), PROT_READ, MAP_SHARED,
+                    es->es_idxfd, 0)) == MAP_FAILED){
+        clicon_err(OE_UNIX, errno, "mmap(%s)", es->es_idxpath);
+        lri = NULL;
+        goto done;
+    }
+    /* Binary search for first record within retention */
+    lo = 0;
+    hi = n;
+    while (lo < hi){
+        mid = (lo + hi)/2;
+        if (timercmp(&lri[mid].lr_tv, tret, >=))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    if (lo*2 < n)
+        goto ok; /* Less than half expired: compact later */
+    if ((cblog = cbuf_new()) == NULL || (cbidx = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cblog, "%s.tmp", es->es_logpath);
+    cprintf(cbidx, "%s.tmp", es->es_idxpath);
+    if ((newlog = open(cbuf_get(cblog), O_RDWR|O_CREAT|O_TRUNC|O_APPEND,
+                       S_IRUSR|S_IWUSR)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cblog));
+        goto done;
+    }
+    if ((newidx = open(cbuf_get(cbidx), O_RDWR|O_CREAT|O_TRUNC|O_APPEND,
+                       S_IRUSR|S_IWUSR)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cbidx));
+        goto done;
+    }
+    for (i=lo; i<n; i++){
+        if ((buf = malloc(lri[i].lr_len)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if (pread(es->es_logfd, buf, lri[i].lr_len, lri[i].lr_off) !=
+            (ssize_t)lri[i].lr_len){
+            clicon_err(OE_UNIX, errno, "pread(%s)", es->es_logpath);
+            goto done;
+        }
+        if (write(newlog, buf, lri[i].lr_len) != (ssize_t)lri[i].lr_len){
+            clicon_err(OE_UNIX, errno, "write(%s)", cbuf_get(cblog));
+            goto done;
+        }
+        lr = lri[i];
+        lr.lr_off = off;
+        if (write(newidx, &lr, sizeof(lr)) != sizeof(lr)){
+            clicon_err(OE_UNIX, errno, "write(%s)", cbuf_get(cbidx));
+            goto done;
+        }
+        off += lri[i].lr_len;
+        free(buf);
+        buf = NULL;
+    }
+    if (rename(cbuf_get(cblog), es->es_logpath) < 0){
+        clicon_err(OE_UNIX, errno, "rename(%s)", es->es_logpath);
+        goto done;
+    }
+    if (rename(cbuf_get(cbidx), es->es_idxpath) < 0){
+        clicon_err(OE_UNIX, errno, "rename(%s)", es->es_idxpath);
+        goto done;
+    }
+    close(es->es_logfd);
+    close(es->es_idxfd);
+    es->es_logfd = newlog;
+    es->es_idxfd = newidx;
+    es->es_logoff = off;
+    newlog = -1;
+    newidx = -1;
+ ok:
+    retval = 0;
+ done:
+    if (buf)
+        free(buf);
+    if (newlog != -1)
+        close(newlog);
+    if (newidx != -1)
+        close(newidx);
+    if (lri)
+        munmap(lri, n*sizeof(*lri));
+    if (cblog)
+        cbuf_free(cblog);
+    if (cbidx)
+        cbuf_free(cbidx);
+    return retval;
+}
+
 /*! Add replay sample to stream with timestamp
  * @param[in] es   Stream
- * @param[in] tv   Timestamp
- * @param[in] xv   XML
+ * @param[in] tv   Timestamp, assumed >= already stored timestamps
+ * @param[in] xv   XML, consumed
+ * In heap mode the oldest events are evicted if the buffer count or byte cap
+ * is exceeded, the newest event is always kept. In disk-backed mode the event
+ * is appended to the log files, see stream_replay_log.
  */
 int
 stream_replay_add(event_stream_t *es,
                   struct timeval *tv,
                   cxobj          *xv)
 {
-    int                   retval = -1;
-    struct stream_replay *new;
+    int                       retval = -1;
+    struct stream_replay_buf *rb;
+    struct stream_replay_ev  *re;
+    struct stream_logrec      lr = {{0,},};
+    cbuf                     *cb = NULL;
+    uint64_t                  nr = 0;
+    size_t                    sz = 0;
 
-    if ((new = malloc(sizeof *new)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if (es->es_logfd != -1){ /* Disk-backed: append event and index record */
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cb, xv, 0, 0, -1, 0) < 0)
+            goto done;
+        lr.lr_tv = *tv;
+        lr.lr_off = es->es_logoff;
+        lr.lr_len = cbuf_len(cb);
+        if (write(es->es_logfd, cbuf_get(cb), lr.lr_len) != (ssize_t)lr.lr_len){
+            clicon_err(OE_UNIX, errno, "write(%s)", es->es_logpath);
+            goto done;
+        }
+        if (write(es->es_idxfd, &lr, sizeof(lr)) != sizeof(lr)){
+            clicon_err(OE_UNIX, errno, "write(%s)", es->es_idxpath);
+            goto done;
+        }
+        es->es_logoff += lr.lr_len;
+        xml_free(xv);
+        retval = 0;
         goto done;
     }
-    memset(new, 0, (sizeof *new));
-    new->r_tv = *tv;
-    new->r_xml = xv;
-    ADDQ(new, es->es_replay);
+    if ((rb = es->es_replay) == NULL &&
+        (rb = stream_replay_buf_new(es, STREAM_REPLAY_MAX_COUNT,
+                                    STREAM_REPLAY_MAX_BYTES)) == NULL)
+        goto done;
+    if (xml_stats(xv, &nr, &sz) < 0)
+        goto done;
+    if (rb->rb_len == rb->rb_maxcount)
+        stream_replay_buf_evict(rb);
+    re = &rb->rb_ev[(rb->rb_start + rb->rb_len)%rb->rb_maxcount];
+    re->re_tv = *tv;
+    re->re_xml = xv;
+    re->re_size = sz;
+    rb->rb_bytes += sz;
+    rb->rb_len++;
+    while (rb->rb_maxbytes && rb->rb_bytes > rb->rb_maxbytes && rb->rb_len > 1)
+        stream_replay_buf_evict(rb);
     retval = 0;
  done:
+    if (cb)
+        cbuf_free(cb);
     return retval;
 }
 
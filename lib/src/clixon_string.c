@@ -95,10 +95,12 @@ clicon_strsep(char *string,
     
     if ((s = string)==NULL)
         goto done;
-    while (*s){
-        if ((d = index(delim, *s)) != NULL)
-            nvec++;
-        s++;
+    /* Count delimiters with strpbrk which scans words/vectors in libc,
+     * instead of one index() call per input byte */
+    d = s;
+    while ((d = strpbrk(d, delim)) != NULL){
+        nvec++;
+        d++;
     }
     /* alloc vector and append copy of string */
     siz = (nvec+1)* sizeof(char*) + strlen(string)+1;
@@ -288,8 +290,10 @@ uri_percent_encode(char **encp,
     char   *enc = NULL;
     int     fmtlen;
     size_t  len;
-    int     i, j;
+    size_t  i, j;
+    size_t  run;
     va_list args;
+    static const char hexdig[] = "0123456789ABCDEF";
 
     /* Two steps: (1) read in the complete format string */
     va_start(args, fmt); /* dryrun */
@@ -314,13 +318,24 @@ uri_percent_encode(char **encp,
     }
     memset(enc, 0, len);
     len = strlen(str);
+    /* Copy runs of unreserved characters in one memcpy and expand the
+     * escapes from a hex table, instead of one snprintf per escaped byte */
+    i = 0;
     j = 0;
-    for (i=0; i<len; i++){
-        if (uri_unreserved(str[i]))
-            enc[j++] = str[i];
-        else{
-            snprintf(&enc[j], 4, "%%%02X", str[i]&0xff);
-            j += 3;
+    while (i < len){
+        run = 0;
+        while (i+run < len && uri_unreserved(str[i+run]))
+            run++;
+        if (run){
+            memcpy(&enc[j], &str[i], run);
+            j += run;
+            i += run;
+        }
+        if (i < len){
+            enc[j++] = '%';
+            enc[j++] = hexdig[(str[i]>>4)&0xf];
+            enc[j++] = hexdig[str[i]&0xf];
+            i++;
         }
     }
     *encp = enc;
@@ -347,10 +362,12 @@ uri_percent_decode(char  *enc,
 {
     int   retval = -1;
     char *str = NULL;
-    int   i, j;
+    size_t i, j;
+    size_t run;
     char  hstr[3];
     size_t len;
     char *ptr;
+    char *pct;
     
     if (enc == NULL){
         clicon_err(OE_UNIX, EINVAL, "enc is NULL");
@@ -364,19 +381,32 @@ uri_percent_decode(char  *enc,
     }
     memset(str, 0, len);
     len = strlen(enc);
+    /* Skip to the next escape with memchr which scans words/vectors in
+     * libc, and copy the literal run in between in one memcpy */
+    i = 0;
     j = 0;
-    for (i=0; i<len; i++){
-        if (enc[i] == '%' && strlen(enc)-i > 2 && 
+    while (i < len){
+        if ((pct = memchr(&enc[i], '%', len-i)) == NULL){
+            memcpy(&str[j], &enc[i], len-i);
+            j += len-i;
+            break;
+        }
+        run = pct - &enc[i];
+        if (run){
+            memcpy(&str[j], &enc[i], run);
+            j += run;
+            i += run;
+        }
+        if (len-i > 2 &&
             isxdigit(enc[i+1]) && isxdigit(enc[i+2])){
             hstr[0] = enc[i+1];
             hstr[1] = enc[i+2];
             hstr[2] = 0;
-            str[j] = strtoul(hstr, &ptr, 16);
-            i += 2;
+            str[j++] = strtoul(hstr, &ptr, 16);
+            i += 3;
         }
         else
-            str[j] = enc[i];
-        j++;
+            str[j++] = enc[i++];
     }
     str[j++] = '\0';
     *strp = str;
@@ -426,6 +456,7 @@ xml_chardata_encode(char      **escp,
     int     cdata; /* when set, skip encoding */
     va_list args;
     size_t  slen;
+    size_t  n;
     
     /* Two steps: (1) read in the complete format string */
     va_start(args, fmt); /* dryrun */
@@ -451,7 +482,13 @@ xml_chardata_encode(char      **escp,
                 cdata = 0;
             len++;
         }
-        else
+        else{
+            /* Count the whole run up to the next special character at once */
+            if ((n = xml_chardata_clean_run(&str[i], slen-i)) > 0){
+                len += n;
+                i += n-1;
+                continue;
+            }
             switch (str[i]){
             case '&':
                 len += strlen("&amp;");
@@ -470,6 +507,7 @@ xml_chardata_encode(char      **escp,
             default:
                 len++;
             }
+        }
     }
     len++; /* trailing \0 */
     /* We know length, allocate encoding buffer  */
@@ -491,7 +529,14 @@ xml_chardata_encode(char      **escp,
             }
             esc[j++] = str[i];
         }
-        else
+        else{
+        /* Bulk-copy the run up to the next special character */
+        if ((n = xml_chardata_clean_run(&str[i], slen-i)) > 0){
+            memcpy(&esc[j], &str[i], n);
+            j += n;
+            i += n-1;
+            continue;
+        }
         switch (str[i]){
         case '&':
             if ((l=snprintf(&esc[j], 6, "&amp;")) < 0){
@@ -522,6 +567,7 @@ xml_chardata_encode(char      **escp,
         default:
             esc[j++] = str[i];
         }
+        }
     }
     *escp = esc;
     retval = 0;
@@ -533,6 +579,100 @@ xml_chardata_encode(char      **escp,
     return retval;
 }
 
+/*
+ * cbuf pool
+ * cbuf_new/cbuf_free pairs are among the top allocation sites in request
+ * handling; a reset cbuf keeps its grown allocation, so recycling them
+ * makes steady-state handling hit malloc only while buffers are still
+ * growing toward their working size. The event loops are single-threaded,
+ * so like cbuf_alloc_set this is process-global state.
+ */
+#define CBUF_POOL_MAX 32 /* Cached cbufs; bounds idle memory to this many
+                            buffers at their high-water size */
+static cbuf *_cbuf_pool[CBUF_POOL_MAX];
+static int   _cbuf_pool_len = 0;
+
+/*! Get a cbuf from the pool, allocating one if the pool is empty
+ * @retval  cb    Empty cbuf, return with cbuf_pool_put
+ * @retval  NULL  Error
+ * @see cbuf_new
+ */
+cbuf *
+cbuf_pool_get(void)
+{
+    if (_cbuf_pool_len > 0)
+        return _cbuf_pool[--_cbuf_pool_len];
+    return cbuf_new();
+}
+
+/*! Return a cbuf to the pool, or free it if the pool is full
+ * @param[in]  cb  cbuf from cbuf_pool_get (or cbuf_new), may be NULL
+ * @retval     0   OK
+ */
+int
+cbuf_pool_put(cbuf *cb)
+{
+    if (cb == NULL)
+        return 0;
+    if (_cbuf_pool_len < CBUF_POOL_MAX){
+        cbuf_reset(cb); /* keeps the grown allocation */
+        _cbuf_pool[_cbuf_pool_len++] = cb;
+        return 0;
+    }
+    cbuf_free(cb);
+    return 0;
+}
+
+/*! Free all pooled cbufs, for exit or after a known memory-heavy phase
+ * @retval  0   OK
+ */
+int
+cbuf_pool_exit(void)
+{
+    while (_cbuf_pool_len > 0)
+        cbuf_free(_cbuf_pool[--_cbuf_pool_len]);
+    return 0;
+}
+
+/*! Length of leading run without XML-special characters, SWAR-accelerated
+ *
+ * Scans eight bytes per step with the classic "haszero" bit trick for each
+ * of & < >, then finishes byte-wise. Most chardata needs no escaping at
+ * all, so serialization can memcpy whole runs instead of inspecting and
+ * appending one byte at a time.
+ * @param[in]  str  Input string, need not be NUL-terminated
+ * @param[in]  len  Number of bytes to scan
+ * @retval     n    Length of prefix containing none of "&<>"
+ */
+size_t
+xml_chardata_clean_run(const char *str,
+                       size_t      len)
+{
+    size_t   i = 0;
+    uint64_t w;
+    uint64_t m;
+    /* (w - 0x01..01) & ~w & 0x80..80 is nonzero iff some byte of w is zero */
+#define SWAR_ONES  0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+#define SWAR_BCAST(c) (SWAR_ONES * (unsigned char)(c))
+
+    while (i + sizeof(w) <= len){
+        memcpy(&w, str + i, sizeof(w)); /* compiles to one unaligned load */
+        m  = ((w ^ SWAR_BCAST('&')) - SWAR_ONES) & ~(w ^ SWAR_BCAST('&')) & SWAR_HIGHS;
+        m |= ((w ^ SWAR_BCAST('<')) - SWAR_ONES) & ~(w ^ SWAR_BCAST('<')) & SWAR_HIGHS;
+        m |= ((w ^ SWAR_BCAST('>')) - SWAR_ONES) & ~(w ^ SWAR_BCAST('>')) & SWAR_HIGHS;
+        if (m != 0)
+            break;
+        i += sizeof(w);
+    }
+#undef SWAR_BCAST
+#undef SWAR_HIGHS
+#undef SWAR_ONES
+    while (i < len && str[i] != '&' && str[i] != '<' && str[i] != '>')
+        i++;
+    return i;
+}
+
 /*! Escape characters according to XML definition and append to cbuf
  * @param[in]   cb     CLIgen buf
  * @param[in]   str    Not-encoded input string
@@ -547,6 +687,7 @@ xml_chardata_cbuf_append(cbuf *cb,
     int  i;
     int  cdata; /* when set, skip encoding */
     size_t len;
+    size_t n;
 
     /* The orignal of this code is in xml_chardata_encode */
     /* Step: encode and expand str --> enc */
@@ -563,7 +704,17 @@ xml_chardata_cbuf_append(cbuf *cb,
             }
             cbuf_append(cb, str[i]);
         }
-        else
+        else{
+        /* Bulk-copy the run up to the next special character */
+        if ((n = xml_chardata_clean_run(&str[i], len-i)) > 0){
+            if (cbuf_append_buf(cb, &str[i], n) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+            i += n;
+            if (i >= len)
+                break;
+        }
         switch (str[i]){
         case '&':
             cbuf_append_str(cb, "&amp;");
@@ -582,9 +733,10 @@ xml_chardata_cbuf_append(cbuf *cb,
         default:
             cbuf_append(cb, str[i]);
         }
+        }
     }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -129,7 +129,6 @@ xml2txt1(cxobj            *xn,
     char      *value;
     cg_var    *cvi;
     cvec      *cvk = NULL; /* vector of index keys */
-    cbuf      *cb = NULL;
 #ifndef TEXT_SYNTAX_NOPREFIX
     yang_stmt *yp = NULL;
     yang_stmt *ymod;
@@ -184,19 +183,17 @@ xml2txt1(cxobj            *xn,
     if (children == 0){ /* If no children print line */
         switch (xml_type(xn)){
         case CX_BODY:{
-            if ((cb = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
             value = xml_value(xn);
+            if (*leafl)                            /* Skip keyword if leaflist */
+                (*fn)(f, "%*s", PRETTYPRINT_INDENT*level, "");
             if (index(value, ' ') != NULL)
-                cprintf(cb, "\"%s\"", value);
+                (*fn)(f, "\"%s\"", value);
             else
-                cprintf(cb, "%s", value);
-            if (*leafl)                            /* Skip keyword if leaflist */
-                (*fn)(f, "%*s%s\n", PRETTYPRINT_INDENT*level, "", cbuf_get(cb));
+                (*fn)(f, "%s", value);
+            if (*leafl)
+                (*fn)(f, "\n");
             else
-                (*fn)(f, "%s;\n", cbuf_get(cb));
+                (*fn)(f, ";\n");
             break;
         }
         case CX_ELMNT:
@@ -257,8 +254,6 @@ xml2txt1(cxobj            *xn,
  ok:
     retval = 0;
  done:
-    if (cb)
-        cbuf_free(cb);
     return retval;
 }
 
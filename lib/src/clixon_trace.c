@@ -0,0 +1,158 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Request tracing with correlation ids
+  *
+  * A frontend (restconf/netconf/cli) allocates a trace id when a request
+  * enters, the id rides on every clicon_msg header (op_tid) to the backend
+  * which adopts it for the duration of the dispatch. Stages along the way
+  * call clixon_trace_stage which fires the "trace_stage" USDT probe and,
+  * when the opt-in trace log is enabled (CLICON_LOG_TRACE), logs a
+  * timestamped line. Grouping the lines or probe hits on the id gives the
+  * per-stage latency breakdown of one request across processes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_trace.h"
+
+/* Current correlation id, 0 means untraced. Process-global: clixon handles
+ * one request at a time per process
+ */
+static uint32_t _trace_id = 0;
+
+/* Id allocator, frontends seed it from their pid so that ids from different
+ * processes on one device rarely collide, see clixon_trace_id_new
+ */
+static uint32_t _trace_id_seq = 0;
+
+/* Set if the opt-in trace log is enabled, see clixon_trace_log_enable */
+static int _trace_log = 0;
+
+/*! Allocate a fresh correlation id and make it current
+ *
+ * Called by a frontend when a request enters (eg one restconf request or one
+ * netconf rpc). Ids are only unique enough to group trace output: a pid seed
+ * plus a counter, never 0.
+ * @retval  tid  New current correlation id
+ */
+uint32_t
+clixon_trace_id_new(void)
+{
+    if (_trace_id_seq == 0)
+        _trace_id_seq = (uint32_t)getpid() << 16;
+    while (++_trace_id_seq == 0)
+        ;
+    _trace_id = _trace_id_seq;
+    return _trace_id;
+}
+
+/*! Get the current correlation id
+ * @retval  tid  Current correlation id, 0 if untraced
+ */
+uint32_t
+clixon_trace_id_get(void)
+{
+    return _trace_id;
+}
+
+/*! Set the current correlation id
+ *
+ * Called by the backend with the id received on the clicon_msg header so
+ * that backend stages and the reply carry the frontend's id.
+ * @param[in]  tid  Correlation id, 0 means untraced
+ * @retval     0    OK
+ */
+int
+clixon_trace_id_set(uint32_t tid)
+{
+    _trace_id = tid;
+    return 0;
+}
+
+/*! Enable or disable the opt-in trace log
+ *
+ * The "trace_stage" USDT probe always fires regardless of this setting, see
+ * clixon_trace_stage.
+ * @param[in]  enable  0 disables, non-zero enables
+ * @retval     0       OK
+ */
+int
+clixon_trace_log_enable(int enable)
+{
+    _trace_log = enable;
+    return 0;
+}
+
+/*! Record that the current request passed a stage
+ *
+ * Fires the "trace_stage" probe with the correlation id and stage name, and
+ * if the trace log is enabled logs a timestamped line. Cheap when disabled
+ * and no tracer is attached: a counter test and a nop.
+ * @param[in]  stage  Short stage name, eg "ipc-send" or "xmldb-put"
+ * @retval     0      OK
+ * @see clixon_trace_id_new  where a request's id is allocated
+ */
+int
+clixon_trace_stage(const char *stage)
+{
+    struct timeval tv;
+
+    CLIXON_PROBE2(trace_stage, _trace_id, stage);
+    if (!_trace_log || _trace_id == 0)
+        return 0;
+    gettimeofday(&tv, NULL);
+    clicon_log(LOG_INFO, "trace id=%u stage=%s t=%lu.%06u",
+               _trace_id, stage,
+               (unsigned long)tv.tv_sec, (unsigned)tv.tv_usec);
+    return 0;
+}
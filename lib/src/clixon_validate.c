@@ -46,10 +46,13 @@
 #include <errno.h>
 #include <ctype.h>
 #include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <arpa/inet.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -64,6 +67,7 @@
 #include "clixon_string.h"
 #include "clixon_err.h"
 #include "clixon_log.h"
+#include "clixon_trace.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
 #include "clixon_data.h"
@@ -81,6 +85,206 @@
 #include "clixon_validate_minmax.h"
 #include "clixon_validate.h"
 
+/*
+ * Validation profiling
+ * Per-check-category time and call accumulators answering "where does
+ * validation time go". Off by default: the begin/end probes cost one branch
+ * when disabled. Enabled by benchmark tools, see clixon_util_validate -p
+ */
+static const char *_vp_names[VP_CAT_MAX] = {
+    "when", "mandatory", "leafref", "identityref", "union", "must", "minmax/unique"
+};
+static int      _vp_enabled = 0;
+static uint64_t _vp_us[VP_CAT_MAX] = {0, };
+static uint64_t _vp_nr[VP_CAT_MAX] = {0, };
+
+/*! Enable or disable per-check-category validation profiling
+ * Also resets the accumulators
+ * @param[in]  enable  1: enable, 0: disable
+ * @retval     0       OK
+ */
+int
+xml_validate_profile(int enable)
+{
+    _vp_enabled = enable;
+    memset(_vp_us, 0, sizeof(_vp_us));
+    memset(_vp_nr, 0, sizeof(_vp_nr));
+    return 0;
+}
+
+/*! Start timing one validation check, if profiling is enabled
+ * @param[out] t0  Timestamp to pass to xml_validate_profile_end
+ * @retval     1   Profiling enabled, t0 set
+ * @retval     0   Profiling disabled
+ */
+int
+xml_validate_profile_begin(struct timeval *t0)
+{
+    if (!_vp_enabled)
+        return 0;
+    gettimeofday(t0, NULL);
+    return 1;
+}
+
+/*! Account elapsed time since t0 to a check category
+ * @param[in]  cat  Check category, see validate_profile_cat
+ * @param[in]  t0   Timestamp from xml_validate_profile_begin
+ * @retval     0    OK
+ */
+int
+xml_validate_profile_end(enum validate_profile_cat cat,
+                         struct timeval           *t0)
+{
+    struct timeval t1;
+
+    if (!_vp_enabled)
+        return 0;
+    gettimeofday(&t1, NULL);
+    _vp_us[cat] += (t1.tv_sec - t0->tv_sec)*1000000 + (t1.tv_usec - t0->tv_usec);
+    _vp_nr[cat]++;
+    return 0;
+}
+
+/*! Print the per-check-category validation time breakdown
+ * @param[in]  f  Output file
+ * @retval     0  OK
+ */
+int
+xml_validate_profile_report(FILE *f)
+{
+    int      i;
+    uint64_t total = 0;
+
+    for (i=0; i<VP_CAT_MAX; i++)
+        total += _vp_us[i];
+    for (i=0; i<VP_CAT_MAX; i++)
+        fprintf(f, "%-14s %10" PRIu64 " calls %10" PRIu64 " us %5.1f%%\n",
+                _vp_names[i], _vp_nr[i], _vp_us[i],
+                total ? 100.0*(double)_vp_us[i]/(double)total : 0.0);
+    fprintf(f, "%-14s %10s %12" PRIu64 " us\n", "total", "", total);
+    return 0;
+}
+
+/*! Per-validation-pass leafref target index
+ *
+ * validate_leafref evaluates the path xpath per referring leaf, which is a
+ * scan of the target list for every instance: O(n*m) when n leafrefs refer
+ * into an m-entry list. While the index is active (between
+ * xml_leafref_index_begin and xml_leafref_index_end, see generic_validate)
+ * the target value set of each absolute path is instead evaluated once,
+ * hashed, and probed per referring leaf.
+ * Keyed by the Y_PATH statement pointer: all instances of the same leafref
+ * leaf share path and namespace context. Relative paths depend on the
+ * context node and bypass the index.
+ * Only valid for one unmodified tree: callers must clear it before the tree
+ * changes.
+ */
+static struct {
+    int            li_active;  /* Set between begin/end */
+    cxobj         *li_root;    /* Tree the index was built over */
+    clicon_hash_t *li_paths;   /* Y_PATH ptr -> value set (clicon_hash_t*) */
+} _leafref_index = {0, NULL, NULL};
+
+/*! Activate the leafref target index for a validation pass over xroot
+ * @param[in] xroot  XML tree to be validated
+ * @retval    0      OK
+ * @see xml_leafref_index_end  which must be called before the tree changes
+ */
+int
+xml_leafref_index_begin(cxobj *xroot)
+{
+    xml_leafref_index_end(); /* in case of a previous unterminated pass */
+    _leafref_index.li_active = 1;
+    _leafref_index.li_root = xroot;
+    return 0;
+}
+
+/*! Deactivate and free the leafref target index
+ * @retval    0      OK (idempotent)
+ */
+int
+xml_leafref_index_end(void)
+{
+    clicon_hash_t *lh = _leafref_index.li_paths;
+    clicon_hash_t **hp;
+    char         **keys = NULL;
+    size_t         klen = 0;
+    int            i;
+
+    if (lh != NULL){
+        if (clicon_hash_keys(lh, &keys, &klen) == 0){
+            for (i = 0; i < (int)klen; i++)
+                if ((hp = (clicon_hash_t**)clicon_hash_value(lh, keys[i], NULL)) != NULL)
+                    clicon_hash_free(*hp);
+            free(keys);
+        }
+        clicon_hash_free(lh);
+        _leafref_index.li_paths = NULL;
+    }
+    _leafref_index.li_active = 0;
+    _leafref_index.li_root = NULL;
+    return 0;
+}
+
+/*! Probe the leafref target index, building the value set on first use
+ * @param[in]  xt        XML leaf node of type leafref (xpath context node)
+ * @param[in]  ypath     Y_PATH statement of the leafref type
+ * @param[in]  nsc       Namespace context of the referring leaf
+ * @param[in]  path_arg  Absolute path xpath
+ * @param[in]  body      Leafref value to look up
+ * @param[out] found     1 if a target instance with that value exists
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+leafref_index_probe(cxobj     *xt,
+                    yang_stmt *ypath,
+                    cvec      *nsc,
+                    char      *path_arg,
+                    char      *body,
+                    int       *found)
+{
+    int             retval = -1;
+    char            key[32];
+    clicon_hash_t **hp;
+    clicon_hash_t  *hv = NULL;
+    cxobj         **xvec = NULL;
+    size_t          xlen = 0;
+    char           *leafbody;
+    int             i;
+
+    snprintf(key, sizeof(key), "%p", ypath);
+    if (_leafref_index.li_paths == NULL &&
+        (_leafref_index.li_paths = clicon_hash_init()) == NULL)
+        goto done;
+    if ((hp = (clicon_hash_t**)clicon_hash_value(_leafref_index.li_paths, key, NULL)) == NULL){
+        /* First referring leaf of this path: evaluate once and hash the values */
+        if ((hv = clicon_hash_init()) == NULL)
+            goto done;
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0)
+            goto done;
+        for (i = 0; i < xlen; i++){
+            if ((leafbody = xml_body(xvec[i])) == NULL)
+                continue;
+            if (clicon_hash_add(hv, leafbody, NULL, 0) == NULL)
+                goto done;
+        }
+        if (clicon_hash_add(_leafref_index.li_paths, key, &hv, sizeof(hv)) == NULL)
+            goto done;
+    }
+    else
+        hv = *hp;
+    *found = (clicon_hash_lookup(hv, body) != NULL);
+    hv = NULL; /* owned by the index */
+    retval = 0;
+ done:
+    if (hv) /* only on error before handover to the index */
+        clicon_hash_free(hv);
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
  * @param[in]  xt    XML leaf node of type leafref
  * @param[in]  ys    Yang spec of leaf
@@ -134,7 +338,8 @@ validate_leafref(cxobj     *xt,
     yang_stmt   *ymod;
     cg_var      *cv;
     int          require_instance = 1;
-    
+    int          found = 0;
+
     /* require instance */
     if ((yreqi = yang_find(ytype, Y_REQUIRE_INSTANCE, NULL)) != NULL){
         if ((cv = yang_cv_get(yreqi)) != NULL) /* shouldnt happen */
@@ -163,16 +368,24 @@ validate_leafref(cxobj     *xt,
         goto ok;
     if (xml_nsctx_yang(ys, &nsc) < 0)
         goto done;
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0) 
-        goto done;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if ((leafbody = xml_body(x)) == NULL)
-            continue;
-        if (strcmp(leafbody, leafrefbody) == 0)
-            break;
+    if (_leafref_index.li_active && path_arg[0] == '/'){
+        /* Absolute path and an active pass index: probe the hashed value set */
+        if (leafref_index_probe(xt, ypath, nsc, path_arg, leafrefbody, &found) < 0)
+            goto done;
     }
-    if (i==xlen){
+    else {
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0)
+            goto done;
+        for (i = 0; i < xlen; i++) {
+            x = xvec[i];
+            if ((leafbody = xml_body(x)) == NULL)
+                continue;
+            if (strcmp(leafbody, leafrefbody) == 0)
+                break;
+        }
+        found = (i < xlen);
+    }
+    if (!found){
         if ((cberr = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
@@ -239,9 +452,9 @@ validate_identityref(cxobj     *xt,
     char       *id = NULL;
     cbuf       *cberr = NULL;
     cbuf       *cb = NULL;
-    cvec       *idrefvec; /* Derived identityref list: (module:id)**/
     yang_stmt  *ymod;
-    
+    int         ret;
+
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new"); 
         goto done;
@@ -289,12 +502,11 @@ validate_identityref(cxobj     *xt,
         goto fail;
     }
     cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-    idref = cbuf_get(cb);       
-    /* Here check if node is in the derived node list of the base identity 
-     * The derived node list is a cvec computed XXX
-     */
-    idrefvec = yang_cvec_get(ybaseid);
-    if (cvec_find(idrefvec, idref) == NULL){
+    idref = cbuf_get(cb);
+    /* Here check if node is in the derived node set of the base identity */
+    if ((ret = yang_identity_derived(ybaseid, idref)) < 0)
+        goto done;
+    if (ret == 0){
         cprintf(cberr, "Identityref validation failed, %s not derived from %s in %s.yang:%d", 
                 node,
                 yang_argument_get(ybaseid),
@@ -1006,8 +1218,12 @@ xml_yang_validate_add(clicon_handle h,
             /* validate value against ranges, etc */
             if ((cv0 = yang_cv_get(yt)) == NULL)
                 break;
-            if ((cv = cv_dup(cv0)) == NULL){
-                clicon_err(OE_UNIX, errno, "cv_dup");
+            /* Scratch copy of the yang prototype cv from the pool: one per
+             * leaf makes dup/free churn visible in full validations */
+            if ((cv = clixon_cv_pool_get(CGV_ERR)) == NULL)
+                goto done;
+            if (cv_cp(cv, cv0) < 0){
+                clicon_err(OE_UNIX, errno, "cv_cp");
                 goto done;
             }
             /* In the union and leafref case, value is parsed as generic REST type,
@@ -1052,8 +1268,7 @@ xml_yang_validate_add(clicon_handle h,
     }
     retval = 1;
  done:
-    if (cv)
-        cv_free(cv);
+    clixon_cv_pool_put(cv);
     if (reason)
         free(reason);
     return retval;
@@ -1161,29 +1376,25 @@ xml_yang_validate_leaf_union(clicon_handle h,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for all (not only added) entries
- * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
- * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+/*! Validate a single XML node against its yang spec, non-recursive
+ *
+ * Checks when conditionals, mandatory statements, leaf type restrictions
+ * including leafref/identityref/union, and must xpaths. Children and
+ * next-level constraints (unique, min/max) are the caller's responsibility,
+ * see xml_yang_validate_all / xml_yang_validate_changed.
+ * @param[in]  xt        XML node to be validated
+ * @param[out] skiptree  Set to 1 if the subtree below xt should not be descended
+ *                       (anyxml/anydata or unknown node treated as anydata)
+ * @param[out] xret      Error XML tree (if retval=0). Free with xml_free after use
  * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- *   xml_free(xret);
- * @endcode
- * @see xml_yang_validate_add
- * @see xml_yang_validate_rpc
  */
-int
-xml_yang_validate_all(clicon_handle h,
-                      cxobj        *xt, 
-                      cxobj       **xret)
+static int
+xml_yang_validate_node(clicon_handle h,
+                       cxobj        *xt,
+                       int          *skiptree,
+                       cxobj       **xret)
 {
     int        retval = -1;
     yang_stmt *yt;  /* yang node associated with xt */
@@ -1192,20 +1403,23 @@ xml_yang_validate_all(clicon_handle h,
     char      *xpath;
     int        nr;
     int        ret;
-    cxobj     *x;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
     cvec      *nsc = NULL;
+    xpath_tree *xptree;
     int        hit = 0;
+    int        vp;
+    struct timeval vt0;
 
-    /* if not given by argument (overide) use default link 
+    /* if not given by argument (overide) use default link
        and !Node has a config sub-statement and it is false */
     if ((yt = xml_spec(xt)) == NULL){
         if (clicon_option_bool(h, "CLICON_YANG_UNKNOWN_ANYDATA") == 1) {
             clicon_log(LOG_WARNING,
                        "%s: %d: No YANG spec for %s, validation skipped",
                        __FUNCTION__, __LINE__, xml_name(xt));
+            *skiptree = 1;
             goto ok;
         }
         if ((cb = cbuf_new()) == NULL){
@@ -1224,8 +1438,11 @@ xml_yang_validate_all(clicon_handle h,
         goto fail;
     }
     if (yang_config(yt) != 0){
+        vp = xml_validate_profile_begin(&vt0);
         if (yang_check_when_xpath(xt, xml_parent(xt), yt, &hit, &nr, &xpath) < 0)
             goto done;
+        if (vp)
+            xml_validate_profile_end(VP_WHEN, &vt0);
         if (hit && nr == 0){
             if ((cb = cbuf_new()) == NULL){
                 clicon_err(OE_UNIX, errno, "cbuf_new");
@@ -1240,14 +1457,18 @@ xml_yang_validate_all(clicon_handle h,
                 goto done;
             goto fail;
         }
+        vp = xml_validate_profile_begin(&vt0);
         if ((ret = check_mandatory(xt, yt, xret)) < 0)
             goto done;
+        if (vp)
+            xml_validate_profile_end(VP_MANDATORY, &vt0);
         if (ret == 0)
             goto fail;
         /* Node-specific validation */
         switch (yang_keyword_get(yt)){
         case Y_ANYXML:
         case Y_ANYDATA:
+            *skiptree = 1;
             goto ok;
             break;
         case Y_LEAF:
@@ -1260,20 +1481,29 @@ xml_yang_validate_all(clicon_handle h,
             if (yang_type_get(yt, NULL, &yc, NULL, NULL, NULL, NULL, NULL) < 0)
                 goto done;
             if (strcmp(yang_argument_get(yc), "leafref") == 0){
+                vp = xml_validate_profile_begin(&vt0);
                 if ((ret = validate_leafref(xt, yt, yc, xret)) < 0)
                     goto done;
+                if (vp)
+                    xml_validate_profile_end(VP_LEAFREF, &vt0);
                 if (ret == 0)
                     goto fail;
                 }
             else if (strcmp(yang_argument_get(yc), "identityref") == 0){
+                vp = xml_validate_profile_begin(&vt0);
                 if ((ret = validate_identityref(xt, yt, yc, xret)) < 0)
                     goto done;
+                if (vp)
+                    xml_validate_profile_end(VP_IDENTITYREF, &vt0);
                 if (ret == 0)
                     goto fail;
             }
             else if (strcmp("union", yang_argument_get(yc)) == 0){
+                vp = xml_validate_profile_begin(&vt0);
                 if ((ret = xml_yang_validate_leaf_union(h, xt, yt, yc, xret)) < 0)
                     goto done;
+                if (vp)
+                    xml_validate_profile_end(VP_UNION, &vt0);
                 if (ret == 0)
                     goto fail;
             }
@@ -1281,8 +1511,9 @@ xml_yang_validate_all(clicon_handle h,
         default:
             break;
         }
-        /* must sub-node RFC 7950 Sec 7.5.3. Can be several. 
+        /* must sub-node RFC 7950 Sec 7.5.3. Can be several.
          * XXX. use yang path instead? */
+        vp = xml_validate_profile_begin(&vt0);
         yc = NULL;
         while ((yc = yn_each(yt, yc)) != NULL) {
             if (yang_keyword_get(yc) != Y_MUST)
@@ -1294,7 +1525,11 @@ xml_yang_validate_all(clicon_handle h,
              */
            if (xml_nsctx_yang(yc, &nsc) < 0)
                goto done;
-            if ((nr = xpath_vec_bool(xt, nsc, "%s", xpath)) < 0)
+            if ((xptree = yang_xptree_get(yc)) != NULL)
+                nr = xpath_tree_bool(xt, nsc, xptree);
+            else /* Compiled at load, fallback if not */
+                nr = xpath_vec_bool(xt, nsc, "%s", xpath);
+            if (nr < 0)
                 goto done;
             if (!nr){
                 ye = yang_find(yc, Y_ERROR_MESSAGE, NULL);
@@ -1314,7 +1549,60 @@ xml_yang_validate_all(clicon_handle h,
                 nsc = NULL;
             }
         }
+        if (vp)
+            xml_validate_profile_end(VP_MUST, &vt0);
     }
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a single XML node with yang specification for all (not only added) entries
+ * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
+ * @param[in]  xt  XML node to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ *   xml_free(xret);
+ * @endcode
+ * @see xml_yang_validate_add
+ * @see xml_yang_validate_rpc
+ */
+int
+xml_yang_validate_all(clicon_handle h,
+                      cxobj        *xt,
+                      cxobj       **xret)
+{
+    int        retval = -1;
+    yang_stmt *yt;
+    int        ret;
+    cxobj     *x;
+    int        skiptree = 0;
+    int        vp;
+    struct timeval vt0;
+
+    if ((ret = xml_yang_validate_node(h, xt, &skiptree, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (skiptree)
+        goto ok;
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
@@ -1323,20 +1611,83 @@ xml_yang_validate_all(clicon_handle h,
             goto fail;
     }
     /* Check unique and min-max after choice test for example*/
-    if (yang_config(yt) != 0){
+    if ((yt = xml_spec(xt)) != NULL && yang_config(yt) != 0){
+        vp = xml_validate_profile_begin(&vt0);
         /* Checks if next level contains any unique list constraints */
         if ((ret = xml_yang_minmax_recurse(xt, xret)) < 0)
             goto done;
+        if (vp)
+            xml_validate_profile_end(VP_MINMAX, &vt0);
+        if (ret == 0)
+            goto fail;
+    }
+ ok:
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate only subtrees touched by a diff plus cross-referencing spines
+ *
+ * Incremental variant of xml_yang_validate_all: subtrees carrying none of
+ * XML_FLAG_ADD/DEL/CHANGE are skipped unless their yang subtree contains a
+ * when, must, leafref or instance-identifier (YANG_FLAG_XREF, set at schema
+ * load), since only such constructs can be invalidated by edits elsewhere.
+ * Unchanged self-contained subtrees were valid when committed and stay valid.
+ * @param[in]  xt    XML node to be validated, diff-flagged, see validate_common
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see xml_yang_validate_all  for the full walk
+ */
+int
+xml_yang_validate_changed(clicon_handle h,
+                          cxobj        *xt,
+                          cxobj       **xret)
+{
+    int        retval = -1;
+    yang_stmt *yt;
+    int        ret;
+    cxobj     *x;
+    int        skiptree = 0;
+    int        vp;
+    struct timeval vt0;
+
+    /* Untouched subtrees can only be invalidated through cross-references */
+    if ((yt = xml_spec(xt)) != NULL &&
+        xml_flag(xt, XML_FLAG_ADD|XML_FLAG_DEL|XML_FLAG_CHANGE) == 0 &&
+        yang_flag_get(yt, YANG_FLAG_XREF) == 0)
+        goto ok;
+    if ((ret = xml_yang_validate_node(h, xt, &skiptree, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (skiptree)
+        goto ok;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_changed(h, x, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    /* Check unique and min-max after choice test for example*/
+    if (yt != NULL && yang_config(yt) != 0){
+        vp = xml_validate_profile_begin(&vt0);
+        if ((ret = xml_yang_minmax_recurse(xt, xret)) < 0)
+            goto done;
+        if (vp)
+            xml_validate_profile_end(VP_MINMAX, &vt0);
         if (ret == 0)
             goto fail;
     }
  ok:
     retval = 1;
  done:
-    if (cb)
-        cbuf_free(cb);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
  fail:
     retval = 0;
@@ -1351,19 +1702,56 @@ xml_yang_validate_all(clicon_handle h,
  */
 int
 xml_yang_validate_all_top(clicon_handle h,
-                          cxobj        *xt, 
+                          cxobj        *xt,
                           cxobj       **xret)
 {
     int    ret;
     cxobj *x;
+    int    vp;
+    struct timeval vt0;
 
+    CLIXON_PROBE2(xml_yang_validate_all, xml_name(xt), xml_child_nr(xt));
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
             return ret;
     }
+    vp = xml_validate_profile_begin(&vt0);
+    if ((ret = xml_yang_minmax_recurse(xt, xret)) < 1)
+        return ret;
+    if (vp)
+        xml_validate_profile_end(VP_MINMAX, &vt0);
+    return 1;
+}
+
+/*! Incremental variant of xml_yang_validate_all_top
+ * @param[in]  xt    XML top node, children diff-flagged, see validate_common
+ * @param[out] xret  Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see xml_yang_validate_changed
+ */
+int
+xml_yang_validate_changed_top(clicon_handle h,
+                              cxobj        *xt,
+                              cxobj       **xret)
+{
+    int    ret;
+    cxobj *x;
+    int    vp;
+    struct timeval vt0;
+
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_changed(h, x, xret)) < 1)
+            return ret;
+    }
+    vp = xml_validate_profile_begin(&vt0);
     if ((ret = xml_yang_minmax_recurse(xt, xret)) < 1)
         return ret;
+    if (vp)
+        xml_validate_profile_end(VP_MINMAX, &vt0);
     return 1;
 }
 
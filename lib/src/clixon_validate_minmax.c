@@ -138,53 +138,6 @@ unique_search_xpath(cxobj  *x,
     goto done;
 }
 
-/*! New element last in list, return error if already exists 
- *
- * @param[in]  vec   Vector of existing entries (new is last)
- * @param[in]  i1    The new entry is placed at vec[i1]
- * @param[in]  vlen  Length of vec
- * @param[in]  sorted Sorted by system, ie sorted by key, otherwise no assumption
- * @retval     0     OK, entry is unique
- * @retval    -1     Duplicate detected
- * @note This is currently quadratic complexity. It could be improved by inserting new element sorted and binary search.
- */
-static int
-check_insert_duplicate(char **vec,
-                       int    i1,
-                       int    vlen,
-                       int    sorted)
-{
-    int i;
-    int v;
-    char *b;
-
-    if (sorted){
-        /* Just go look at previous element to see if it is duplicate (sorted by system) */
-        if (i1 == 0)
-            return 0;
-        i = i1-1;
-        for (v=0; v<vlen; v++){
-            b = vec[i*vlen+v];
-            if (b == NULL || strcmp(b, vec[i1*vlen+v]))
-                return 0;
-        }
-        /* here we have passed thru all keys of previous element and they are all equal */
-        return -1;
-    }
-    else{
-        for (i=0; i<i1; i++){
-            for (v=0; v<vlen; v++){
-                b = vec[i*vlen+v];
-                if (b == NULL || strcmp(b, vec[i1*vlen+v]))
-                    break;
-            }
-            if (v==vlen) /* duplicate */
-                break;
-        }
-        return i==i1?0:-1;
-    }
-}
-
 /*! Given a list with unique constraint, detect duplicates
  * @param[in]  x     The first element in the list (on return the last)
  * @param[in]  xt    The parent of x (a list)
@@ -209,49 +162,61 @@ check_insert_duplicate(char **vec,
  * when a list entry is created.
  */
 static int
-check_unique_list_direct(cxobj     *x, 
-                         cxobj     *xt, 
+check_unique_list_direct(cxobj     *x,
+                         cxobj     *xt,
                          yang_stmt *y,
                          yang_stmt *yu,
                          cxobj    **xret)
 {
-    int       retval = -1;
-    cg_var    *cvi; /* unique node name */
-    cxobj     *xi;
-    char     **vec = NULL; /* 2xmatrix */
-    int        clen;
-    int        i;
-    int        v;
-    char      *bi;
-    int        sorted;
-    char      *str;
-    cvec      *cvk;
+    int            retval = -1;
+    cg_var        *cvi; /* unique node name */
+    cxobj         *xi;
+    int            clen;
+    int            v;
+    char          *bi;
+    int            sorted;
+    char          *str;
+    cvec          *cvk;
+    char         **cur = NULL;   /* current entry tuple of body pointers */
+    char         **prev = NULL;  /* previous entry tuple (sorted case) */
+    clicon_hash_t *hdup = NULL;  /* set of seen tuples (unsorted case) */
+    cbuf          *cb = NULL;
+    int            dup;
 
-    cvk = yang_cvec_get(yu);
-    /* If list and is sorted by system, then it is assumed elements are in key-order which is optimized
-     * Other cases are "unique" constraint or list sorted by user which is quadratic in complexity
-     * This second case COULD be optimized if binary insert is made on the vec vector.
+    /* If list and is sorted by system, then it is assumed elements are in key-order:
+     * compare against the previous element only.
+     * Other cases are "unique" constraint or list sorted by user: a single pass
+     * inserting each key tuple into a hash set, failing on the first collision.
      */
     sorted = (yang_keyword_get(yu) == Y_LIST &&
-              yang_find(y, Y_ORDERED_BY, "user") == NULL);
+              !yang_ordered_by_user(y));
     cvk = yang_cvec_get(yu);
     /* nr of unique elements to check */
-    if ((clen = cvec_len(cvk)) == 0){ 
+    if ((clen = cvec_len(cvk)) == 0){
         /* No keys: no checks necessary */
         goto ok;
     }
-    if ((vec = calloc(clen*xml_child_nr(xt), sizeof(char*))) == NULL){
+    if ((cur = calloc(clen, sizeof(char*))) == NULL){
         clicon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
-    /* A vector is built with key-values, for each iteration check "backward" in the vector
-     * for duplicates
-     */
-    i = 0; /* x element index */
+    if (sorted){
+        if ((prev = calloc(clen, sizeof(char*))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
+    else{
+        if ((hdup = clicon_hash_init()) == NULL)
+            goto done;
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+    }
     do {
         cvi = NULL;
         v = 0; /* index in each tuple */
-        /* XXX Quadratic if clen > 1 */
         while ((cvi = cvec_each(cvk, cvi)) != NULL){
             /* RFC7950: Sec 7.8.3.1: entries that do not have value for all
              * referenced leafs are not taken into account */
@@ -264,25 +229,50 @@ check_unique_list_direct(cxobj     *x,
                 break;
             if ((bi = xml_body(xi)) == NULL)
                 break;
-            vec[i*clen + v++] = bi;
+            cur[v++] = bi;
         }
-        if (cvi==NULL){
-            /* Last element (i) is newly inserted, see if it is already there */
-            if (check_insert_duplicate(vec, i, clen, sorted) < 0){
+        if (cvi==NULL){ /* complete tuple: check for duplicate */
+            dup = 0;
+            if (sorted){
+                if (prev[0] != NULL){
+                    for (v=0; v<clen; v++)
+                        if (strcmp(prev[v], cur[v]))
+                            break;
+                    dup = (v == clen);
+                }
+                memcpy(prev, cur, clen*sizeof(char*));
+            }
+            else{
+                /* Length-prefixed concatenation is an unambiguous set key */
+                cbuf_reset(cb);
+                for (v=0; v<clen; v++)
+                    cprintf(cb, "%zu:%s", strlen(cur[v]), cur[v]);
+                if (clicon_hash_lookup(hdup, cbuf_get(cb)) != NULL)
+                    dup = 1;
+                else if (clicon_hash_add(hdup, cbuf_get(cb), NULL, 0) == NULL)
+                    goto done;
+            }
+            if (dup){
                 if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
                     goto done;
                 goto fail;
             }
         }
+        else if (sorted)
+            prev[0] = NULL; /* incomplete tuple: nothing to compare the next against */
         x = xml_child_each(xt, x, CX_ELMNT);
-        i++;
     } while (x && y == xml_spec(x));  /* stop if list ends, others may follow */
  ok:
-    /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
-    if (vec)
-        free(vec);
+    if (cur)
+        free(cur);
+    if (prev)
+        free(prev);
+    if (hdup)
+        clicon_hash_free(hdup);
+    if (cb)
+        cbuf_free(cb);
     return retval;
  fail:
     retval = 0;
@@ -83,16 +83,30 @@
  * Heurestics: if child is body only single child is expected, but element children may
  * have siblings
  */
-#define XML_CHILDVEC_SIZE_START 1        
-#define XML_CHILDVEC_SIZE_START_ELMNT 16 
+#define XML_CHILDVEC_SIZE_START 1
+#define XML_CHILDVEC_SIZE_START_ELMNT 16
 #define XML_CHILDVEC_SIZE_THRESHOLD 65536
 
-/* Intention of these macros is to guard against access of type-specific fields 
+/* Minimum number of children before xml_find_type builds a name->child hash
+ * index over a parent. Below this a linear scan is cheaper than maintaining
+ * the index.
+ */
+#define XML_FIND_INDEX_THRESHOLD 64
+
+/* Minimum number of children before xml_leaflist_pack compacts a homogeneous
+ * leaf-list into a packed value array. Below this the per-node overhead does
+ * not matter and packing would only cost materialization on first access.
+ */
+#define XML_LEAFLIST_PACK_MIN 64
+
+/* Intention of these macros is to guard against access of type-specific fields
  * As debug they can contain an assert.
  */
 #define is_element(x) (xml_type(x)==CX_ELMNT)
 #define is_bodyattr(x) (xml_type(x)==CX_BODY || xml_type(x)==CX_ATTR)
 
+static int xml_unpack(cxobj *xp);
+
 /*
  * Types
  */
@@ -165,6 +179,7 @@ struct xml{
     char             *x_name;       /* name of node */
     char             *x_prefix;     /* namespace localname N, called prefix */
     uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
+    uint32_t          x_gen;        /* Modification generation, see xml_gen_enable */
     struct xml       *x_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *x_up_candidate; /* Candidate parent node for special cases (when+xpath) */
@@ -181,13 +196,37 @@ struct xml{
     int               x_childvec_max;/* Length of allocated vector */
 
 
-    cvec             *x_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, 
                                        by reference, dont free */
-    cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp) */
+    struct xml_cold  *x_cold;       /* Rarely used fields, allocated on demand,
+                                       see struct xml_cold */
+};
+
+/* Cold extension of struct xml: fields most nodes never use, allocated on
+ * demand so tree walks touch fewer cache lines and leaf nodes stay small.
+ * @see struct xml  which holds the hot fields
+ */
+struct xml_cold{
+    cvec             *xc_ns_cache;  /* Cached vector of namespaces (set by bind-yang) */
+    cg_var           *xc_cv;        /* Cached value as cligen variable (set by xml_cmp) */
+    clicon_hash_t    *xc_find_index;/* Lazy name->first-child hash index, see xml_find_type.
+                                       Invalidated on any child vector mutation */
+    clicon_hash_t    *xc_key_index;  /* Lazy composite-key index over keyed list children,
+                                       packed key -> child, see xml_key_index_get.
+                                       Invalidated with xc_find_index */
 #ifdef XML_EXPLICIT_INDEX
-    struct search_index *x_search_index; /* explicit search index vectors */
+    struct search_index *xc_search_index; /* explicit search index vectors */
 #endif
+    uint64_t          xc_tree_hash; /* Cached subtree content hash, see xml_tree_hash */
+    uint32_t          xc_tree_hash_gen; /* x_gen + 1 when the hash was computed,
+                                           0 means no cached hash */
+    char             *xc_pack_val;  /* Packed leaf-list child values, NUL-separated,
+                                       see xml_leaflist_pack */
+    size_t            xc_pack_len;  /* Length of xc_pack_val in bytes */
+    int               xc_pack_nr;   /* Number of packed children */
+    char             *xc_pack_name; /* Name of the packed children */
+    char             *xc_pack_prefix; /* Prefix of the packed children or NULL */
+    yang_stmt        *xc_pack_spec; /* Yang leaf-list spec of the packed children */
 };
 
 /* Variant of struct xml for use by non-elements to save space
@@ -198,6 +237,7 @@ struct xmlbody{
     char             *xb_name;       /* name of node */
     char             *xb_prefix;     /* namespace localname N, called prefix */
     uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
+    uint32_t          xb_gen;        /* Modification generation, see xml_gen_enable */
     struct xml       *xb_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *xb_up_candidate; /* Candidate parent node for special cases (when+xpath) */
@@ -208,6 +248,24 @@ struct xmlbody{
     cbuf             *xb_value_cb;  /* attribute and body nodes have values */
 };
 
+/*! Get cold extension of an XML node, allocating it on first use
+ * @param[in]  x    XML node (must be element)
+ * @retval     xc   Cold extension struct
+ * @retval     NULL Error
+ */
+static struct xml_cold *
+xml_cold_ensure(cxobj *x)
+{
+    if (x->x_cold == NULL){
+        if ((x->x_cold = malloc(sizeof(struct xml_cold))) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x->x_cold, 0, sizeof(struct xml_cold));
+    }
+    return x->x_cold;
+}
+
 /*
  * Variables
  */
@@ -231,9 +289,565 @@ xml_type2str(enum cxobj_type type)
     return (char*)clicon_int2str(xsmap, type);
 }
 
+/* A single slab of an XML arena, carved into node structs by pointer bump
+ * @see struct xml_arena
+ */
+struct xml_arena_slab{
+    struct xml_arena_slab *as_next; /* Next (older) slab in arena */
+    size_t                 as_size; /* Usable size of as_mem */
+    size_t                 as_used; /* High-water mark into as_mem */
+    char                   as_mem[]; /* Slab memory, node structs carved from here */
+};
+
+/*! XML node arena: slab allocator for whole cxobj trees
+ * While an arena is made current with xml_arena_begin(), xml_new() carves node
+ * structs out of large slabs instead of individual malloc(3) calls. Nodes are
+ * tagged XML_FLAG_ARENA so that xml_free() skips free(3) of the struct itself;
+ * names, values and child vectors are still heap-allocated and freed as usual.
+ * Teardown of a large tree (eg a datastore read) is then xml_free() of the tree
+ * followed by a single xml_arena_free().
+ */
+struct xml_arena{
+    struct xml_arena_slab *xa_slabs;  /* Linked list of slabs, newest first */
+    size_t                 xa_slabsz; /* Default slab size in bytes */
+    uint64_t               xa_nrslabs;/* Number of slabs allocated */
+    uint64_t               xa_nrnodes;/* Number of nodes carved from arena */
+};
+
+/* Currently active arena used by xml_new, or NULL for regular malloc
+ * @see xml_arena_begin
+ */
+static struct xml_arena *_xml_arena_current = NULL;
+
 /* Stats */
 static uint64_t _stats_xml_nr = 0;
 
+/*! Create an XML node arena
+ * @param[in]  slabsz  Slab size in bytes, or 0 for default (1MB)
+ * @retval     xa      New arena
+ * @retval     NULL    Error
+ * @see xml_arena_begin  To direct xml_new allocations into the arena
+ * @see xml_arena_free
+ */
+xml_arena *
+xml_arena_create(size_t slabsz)
+{
+    struct xml_arena *xa;
+
+    if ((xa = malloc(sizeof(*xa))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(xa, 0, sizeof(*xa));
+    xa->xa_slabsz = slabsz ? slabsz : 1024*1024;
+    return xa;
+}
+
+/*! Free an XML arena and all its slabs
+ * All nodes carved from the arena become invalid: the tree(s) built from it
+ * must either be freed (xml_free) or abandoned before this call.
+ * @param[in]  xa   XML arena
+ * @retval     0    OK
+ */
+int
+xml_arena_free(xml_arena *xa)
+{
+    struct xml_arena_slab *as;
+
+    if (xa == NULL)
+        return 0;
+    while ((as = xa->xa_slabs) != NULL){
+        xa->xa_slabs = as->as_next;
+        free(as);
+    }
+    free(xa);
+    return 0;
+}
+
+/*! Allocate sz bytes from arena, bumping into current slab or adding a new one
+ * @param[in]  xa   XML arena
+ * @param[in]  sz   Bytes to allocate
+ * @retval     mem  Allocated memory, aligned
+ * @retval     NULL Error
+ */
+static void *
+xml_arena_alloc(struct xml_arena *xa,
+                size_t            sz)
+{
+    struct xml_arena_slab *as = xa->xa_slabs;
+    size_t                 slabsz;
+    void                  *mem;
+
+    sz = (sz + 15) & ~(size_t)15; /* keep slab carve-outs aligned */
+    if (as == NULL || as->as_size - as->as_used < sz){
+        slabsz = xa->xa_slabsz > sz ? xa->xa_slabsz : sz;
+        if ((as = malloc(sizeof(*as) + slabsz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        as->as_size = slabsz;
+        as->as_used = 0;
+        as->as_next = xa->xa_slabs;
+        xa->xa_slabs = as;
+        xa->xa_nrslabs++;
+    }
+    mem = as->as_mem + as->as_used;
+    as->as_used += sz;
+    return mem;
+}
+
+/*! Make arena current: subsequent xml_new() node structs are carved from it
+ * @param[in]  xa   XML arena
+ * @retval     0    OK
+ * @see xml_arena_end
+ */
+int
+xml_arena_begin(xml_arena *xa)
+{
+    _xml_arena_current = xa;
+    return 0;
+}
+
+/*! End arena allocation mode, xml_new() reverts to per-node malloc
+ * @retval     0    OK
+ * @see xml_arena_begin
+ */
+int
+xml_arena_end(void)
+{
+    _xml_arena_current = NULL;
+    return 0;
+}
+
+/*! Get occupancy statistics of an XML arena
+ * @param[in]   xa       XML arena
+ * @param[out]  nrslabs  Number of slabs (or NULL)
+ * @param[out]  used     Bytes carved out of slabs (or NULL)
+ * @param[out]  total    Bytes allocated for slabs (or NULL)
+ * @retval      0        OK
+ * @see xml_stats  For per-tree sizes
+ */
+int
+xml_arena_stats(xml_arena *xa,
+                uint64_t  *nrslabs,
+                size_t    *used,
+                size_t    *total)
+{
+    struct xml_arena_slab *as;
+    size_t                 u = 0;
+    size_t                 t = 0;
+
+    if (xa == NULL){
+        clicon_err(OE_XML, EINVAL, "arena is NULL");
+        return -1;
+    }
+    for (as = xa->xa_slabs; as; as = as->as_next){
+        u += as->as_used;
+        t += as->as_size;
+    }
+    if (nrslabs)
+        *nrslabs = xa->xa_nrslabs;
+    if (used)
+        *used = u;
+    if (total)
+        *total = t;
+    return 0;
+}
+
+/* Interned string table for element names and prefixes
+ * Configs typically have a few hundred distinct tag names repeated millions of
+ * times; interning makes x_name/x_prefix pointers into one shared pool instead
+ * of per-node strdup copies.
+ * Entries are never deleted so interned pointers stay valid for process lifetime.
+ */
+static clicon_hash_t *_xml_intern_tbl = NULL;
+static int            _xml_intern_enabled = 0;
+
+/*! Enable or disable interning of XML element names and prefixes
+ * When enabled, xml_name_set()/xml_prefix_set() store pointers into a shared
+ * string table instead of strdup:ing into every node, and such nodes are
+ * tagged XML_FLAG_INTERNED so xml_free() leaves the strings alone.
+ * @param[in]  enable  0 or 1
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xml_intern_exit
+ */
+int
+xml_intern_set(int enable)
+{
+    if (enable && _xml_intern_tbl == NULL)
+        if ((_xml_intern_tbl = clicon_hash_init()) == NULL)
+            return -1;
+    _xml_intern_enabled = enable;
+    return 0;
+}
+
+/*! Free the interned string table
+ * May only be called at process exit, after all XML trees with interned
+ * names have been freed.
+ * @retval     0    OK
+ */
+int
+xml_intern_exit(void)
+{
+    if (_xml_intern_tbl){
+        clicon_hash_free(_xml_intern_tbl);
+        _xml_intern_tbl = NULL;
+    }
+    _xml_intern_enabled = 0;
+    return 0;
+}
+
+/*! Intern a string, returning a pointer valid for process lifetime
+ * @param[in]  str  String to intern (copied on first occurrence)
+ * @retval     s    Shared interned copy of str
+ * @retval     NULL Error
+ */
+static char *
+xml_intern_str(char *str)
+{
+    clicon_hash_t h;
+
+    if ((h = clicon_hash_lookup(_xml_intern_tbl, str)) == NULL &&
+        (h = clicon_hash_add(_xml_intern_tbl, str, NULL, 0)) == NULL)
+        return NULL;
+    return h->h_key;
+}
+
+/* Generation tracking: monotonic counter bumped on tree modifications and
+ * propagated to ancestors, so that consumers (incremental validation, cached
+ * serialization) can skip subtrees whose generation is unchanged since a
+ * snapshot. Off by default since the ancestor walk costs O(depth) per edit.
+ */
+static uint32_t _xml_gen = 1;
+static int      _xml_gen_enabled = 0;
+
+/*! Enable or disable modification generation tracking
+ * @param[in]  enable  0 or 1
+ * @retval     0       OK
+ * @see xml_gen  To read a node generation
+ */
+int
+xml_gen_enable(int enable)
+{
+    _xml_gen_enabled = enable;
+    return 0;
+}
+
+/*! Get the current global generation counter
+ * Snapshot this before a pass; any node x with xml_gen(x) greater than the
+ * snapshot has been modified (or has a modified descendant) since.
+ * @retval     gen  Current generation
+ */
+uint32_t
+xml_gen_current(void)
+{
+    return _xml_gen;
+}
+
+/*! Get modification generation of a node
+ * A node generation is always >= that of all its descendants.
+ * @param[in]  x    XML node
+ * @retval     gen  Generation when x or a descendant was last modified
+ */
+uint32_t
+xml_gen(cxobj *x)
+{
+    return x ? x->x_gen : 0;
+}
+
+/*! Bump generation of node x and propagate to its ancestors
+ * @param[in]  x    Modified XML node
+ * @retval     0    OK
+ */
+static int
+xml_gen_bump(cxobj *x)
+{
+    uint32_t gen;
+
+    if (!_xml_gen_enabled)
+        return 0;
+    gen = ++_xml_gen;
+    while (x != NULL && x->x_gen != gen){
+        x->x_gen = gen;
+        x = x->x_up;
+    }
+    return 0;
+}
+
+#define TREE_HASH_OFFSET 0xcbf29ce484222325ULL
+#define TREE_HASH_PRIME  0x100000001b3ULL
+
+/*! Fold a string into a running FNV-1a hash, followed by a field separator
+ * @param[in]  h    Running hash
+ * @param[in]  s    String, may be NULL (folds as empty)
+ * @retval     h    Updated hash
+ */
+static uint64_t
+tree_hash_str(uint64_t    h,
+              const char *s)
+{
+    for (; s && *s; s++)
+        h = (h ^ (uint64_t)*s) * TREE_HASH_PRIME;
+    return (h ^ 0xffULL) * TREE_HASH_PRIME;
+}
+
+/*! Compute the hash of one packed leaf-list entry
+ *
+ * Must produce the same hash as the materialized form of the entry: an
+ * element named name/prefix with a single body child carrying value,
+ * see xml_tree_hash and xml_leaflist_pack.
+ * @param[in]  name    Entry name
+ * @param[in]  prefix  Entry prefix or NULL
+ * @param[in]  value   Entry body value
+ * @retval     h       Entry subtree hash
+ */
+static uint64_t
+tree_hash_packed_entry(const char *name,
+                       const char *prefix,
+                       const char *value)
+{
+    uint64_t he = TREE_HASH_OFFSET;
+    uint64_t hb = TREE_HASH_OFFSET;
+    char    *s;
+
+    he = (he ^ (uint64_t)CX_ELMNT) * TREE_HASH_PRIME;
+    he = tree_hash_str(he, name);
+    he = tree_hash_str(he, prefix);
+    hb = (hb ^ (uint64_t)CX_BODY) * TREE_HASH_PRIME;
+    hb = tree_hash_str(hb, "body");
+    hb = tree_hash_str(hb, NULL);
+    for (s = (char*)value; s && *s; s++)
+        hb = (hb ^ (uint64_t)*s) * TREE_HASH_PRIME;
+    return (he ^ hb) * TREE_HASH_PRIME;
+}
+
+/*! Compute a content hash over an XML subtree, cached per element
+ *
+ * FNV-1a over node type, name, prefix and value, folded with the child
+ * subtree hashes in order. XML flags are excluded: they are transient
+ * markings, not content. The hash is cached on element nodes and its
+ * validity is tracked with the modification generation (enabled on first
+ * call, as for the descendant index), so repeated comparisons of
+ * long-lived trees only rehash modified subtrees. Packed leaf-lists are
+ * hashed from their packed representation without materializing.
+ * Equal hashes are taken to mean equal subtree content; as with the
+ * datastore validation fingerprint this is probabilistic, but at 64 bits
+ * a collision is not a practical concern.
+ * @param[in]  x    XML node
+ * @param[out] hp   Subtree content hash
+ * @retval     0    OK
+ * @see xml_gen_enable  Invalidation mechanism
+ * @see xml_diff        Skips subtrees with equal hashes
+ */
+int
+xml_tree_hash(cxobj    *x,
+              uint64_t *hp)
+{
+    uint64_t         h = TREE_HASH_OFFSET;
+    struct xml_cold *xc;
+    char            *s;
+    char            *p;
+    cxobj           *xchild;
+    uint64_t         hc;
+    int              i;
+
+    if (x->x_type == CX_ELMNT &&
+        (xc = x->x_cold) != NULL &&
+        xc->xc_tree_hash_gen == x->x_gen + 1){
+        *hp = xc->xc_tree_hash;
+        return 0;
+    }
+    xml_gen_enable(1); /* cache validity depends on generation tracking */
+    h = (h ^ (uint64_t)x->x_type) * TREE_HASH_PRIME;
+    h = tree_hash_str(h, x->x_name);
+    h = tree_hash_str(h, x->x_prefix);
+    if (x->x_value_cb)
+        for (s = cbuf_get(x->x_value_cb); s && *s; s++)
+            h = (h ^ (uint64_t)*s) * TREE_HASH_PRIME;
+    if (x->x_type == CX_ELMNT){
+        if (x->x_flags & XML_FLAG_PACKED){
+            xc = x->x_cold;
+            p = xc->xc_pack_val;
+            for (i = 0; i < xc->xc_pack_nr; i++){
+                hc = tree_hash_packed_entry(xc->xc_pack_name, xc->xc_pack_prefix, p);
+                h = (h ^ hc) * TREE_HASH_PRIME;
+                p += strlen(p) + 1;
+            }
+        }
+        else for (i = 0; i < x->x_childvec_len; i++){
+            xchild = x->x_childvec[i];
+            if (xchild == NULL)
+                continue;
+            xml_tree_hash(xchild, &hc);
+            h = (h ^ hc) * TREE_HASH_PRIME;
+        }
+        /* cache on the element; best effort, hash is valid regardless */
+        if ((xc = xml_cold_ensure(x)) != NULL){
+            xc->xc_tree_hash = h;
+            xc->xc_tree_hash_gen = x->x_gen + 1;
+        }
+    }
+    *hp = h;
+    return 0;
+}
+
+/* Descendant element-name index
+ * Descendant (//) xpath steps walk the entire subtree per evaluation. For
+ * tree roots that are queried repeatedly (cached datastore trees, polled
+ * state trees) a lazy inverted index element-name -> vector of descendants
+ * is kept per root, built on first lookup of a name and consulted by the
+ * xpath evaluator. Validity is tracked with the modification generation
+ * (see xml_gen_enable, enabled on first index creation): if the root
+ * generation has moved, the index is dropped and rebuilt lazily.
+ * Only parentless roots are indexed so that xml_free of the root is the
+ * single point of invalidation.
+ */
+#define XML_DIDX_ROOTS 4
+
+struct didx_root{
+    cxobj         *dr_root;  /* tree top, no parent */
+    uint32_t       dr_gen;   /* root generation when the index was built */
+    clicon_hash_t *dr_idx;   /* element name -> clixon_xvec* of descendants */
+};
+static struct didx_root _didx[XML_DIDX_ROOTS] = {{0,}};
+static int _didx_nr = 0; /* Nr of active entries, cheap guard in xml_free */
+static int _didx_rr = 0; /* Round-robin eviction cursor */
+
+/*! Clear one descendant-index entry, freeing its name vectors
+ */
+static int
+xml_didx_clear(struct didx_root *dr)
+{
+    char       **keys = NULL;
+    size_t       klen = 0;
+    size_t       vlen;
+    void        *p;
+    clixon_xvec *xv;
+    int          i;
+
+    if (dr->dr_idx){
+        if (clicon_hash_keys(dr->dr_idx, &keys, &klen) == 0){
+            for (i=0; i<klen; i++){
+                if ((p = clicon_hash_value(dr->dr_idx, keys[i], &vlen)) != NULL){
+                    memcpy(&xv, p, sizeof(xv));
+                    clixon_xvec_free(xv);
+                }
+            }
+        }
+        if (keys)
+            free(keys);
+        clicon_hash_free(dr->dr_idx);
+        dr->dr_idx = NULL;
+    }
+    if (dr->dr_root){
+        dr->dr_root = NULL;
+        _didx_nr--;
+    }
+    return 0;
+}
+
+/*! Collect all descendants of x named name, in document order
+ */
+static int
+xml_didx_build(cxobj       *x,
+               const char  *name,
+               clixon_xvec *xvec)
+{
+    cxobj *xc = NULL;
+
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xc), name) == 0 &&
+            clixon_xvec_append(xvec, xc) < 0)
+            return -1;
+        if (xml_didx_build(xc, name, xvec) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Get the descendant vector of an element name under a tree root
+ *
+ * @param[in]  xt    XML tree root (no parent)
+ * @param[in]  name  Element name
+ * @param[out] xvp   Vector of descendants in document order, owned by the index
+ * @retval     1     Index hit, xvp set (possibly empty vector)
+ * @retval     0     Not applicable (not a root), use a regular traversal
+ * @retval    -1     Error
+ * The vector remains valid until the next modification of any tree.
+ */
+int
+xml_didx_get(cxobj        *xt,
+             const char   *name,
+             clixon_xvec **xvp)
+{
+    struct didx_root *dr = NULL;
+    clixon_xvec      *xv;
+    void             *p;
+    size_t            vlen;
+    int               i;
+
+    if (xml_parent(xt) != NULL || xml_type(xt) != CX_ELMNT)
+        return 0;
+    for (i=0; i<XML_DIDX_ROOTS; i++)
+        if (_didx[i].dr_root == xt){
+            dr = &_didx[i];
+            break;
+        }
+    if (dr && dr->dr_gen != xml_gen(xt)){ /* tree modified: rebuild lazily */
+        xml_didx_clear(dr);
+        dr = NULL;
+    }
+    if (dr == NULL){
+        for (i=0; i<XML_DIDX_ROOTS; i++)
+            if (_didx[i].dr_root == NULL){
+                dr = &_didx[i];
+                break;
+            }
+        if (dr == NULL){ /* all slots taken: evict round-robin */
+            dr = &_didx[_didx_rr++ % XML_DIDX_ROOTS];
+            xml_didx_clear(dr);
+        }
+        if ((dr->dr_idx = clicon_hash_init()) == NULL)
+            return -1;
+        xml_gen_enable(1); /* index validity depends on generation tracking */
+        dr->dr_root = xt;
+        dr->dr_gen = xml_gen(xt);
+        _didx_nr++;
+    }
+    if ((p = clicon_hash_value(dr->dr_idx, (char*)name, &vlen)) != NULL){
+        memcpy(&xv, p, sizeof(xv));
+        *xvp = xv;
+        return 1;
+    }
+    if ((xv = clixon_xvec_new()) == NULL)
+        return -1;
+    if (xml_didx_build(xt, name, xv) < 0){
+        clixon_xvec_free(xv);
+        return -1;
+    }
+    if (clicon_hash_add(dr->dr_idx, (char*)name, &xv, sizeof(xv)) == NULL){
+        clixon_xvec_free(xv);
+        return -1;
+    }
+    *xvp = xv;
+    return 1;
+}
+
+/*! Drop the descendant index of a root, if any
+ * @param[in]  x  XML node, typically a tree root about to be freed
+ */
+int
+xml_didx_invalidate(cxobj *x)
+{
+    int i;
+
+    for (i=0; i<XML_DIDX_ROOTS; i++)
+        if (_didx[i].dr_root == x)
+            xml_didx_clear(&_didx[i]);
+    return 0;
+}
+
 /*! Get global statistics about XML objects
  *
  * @param[out]  nr  Number of existing XML objects (created - freed)
@@ -258,28 +872,38 @@ xml_stats_one(cxobj    *x,
 {
     size_t sz = 0;
 
-    if (x->x_name)
+    if (x->x_name && (x->x_flags & XML_FLAG_INTERN_NAME) == 0)
         sz += strlen(x->x_name) + 1;
-    if (x->x_prefix)
+    if (x->x_prefix && (x->x_flags & XML_FLAG_INTERN_PREFIX) == 0)
         sz += strlen(x->x_prefix) + 1;
     switch (xml_type(x)){
     case CX_ELMNT:
         sz += sizeof(struct xml);
         sz += x->x_childvec_max*sizeof(struct xml*);
-        if (x->x_ns_cache)
-            sz += cvec_size(x->x_ns_cache);
-        if (x->x_cv)
-            sz += cv_size(x->x_cv);
+        if (x->x_cold){
+            sz += sizeof(struct xml_cold);
+            if (x->x_cold->xc_ns_cache &&
+                (x->x_flags & XML_FLAG_NS_SHARED) == 0)
+                sz += cvec_size(x->x_cold->xc_ns_cache);
+            if (x->x_cold->xc_cv)
+                sz += cv_size(x->x_cold->xc_cv);
+            if (x->x_cold->xc_pack_val){
+                sz += x->x_cold->xc_pack_len;
+                sz += strlen(x->x_cold->xc_pack_name) + 1;
+                if (x->x_cold->xc_pack_prefix)
+                    sz += strlen(x->x_cold->xc_pack_prefix) + 1;
+            }
 #ifdef XML_EXPLICIT_INDEX
-        if (x->x_search_index){
-            /* XXX: only one */
-            sz += sizeof(struct search_index);
-            if (x->x_search_index->si_name)
-                sz += strlen(x->x_search_index->si_name)+1;
-            if (x->x_search_index->si_xvec)
-                sz += clixon_xvec_len(x->x_search_index->si_xvec)*sizeof(struct cxobj*);
-        }
+            if (x->x_cold->xc_search_index){
+                /* XXX: only one */
+                sz += sizeof(struct search_index);
+                if (x->x_cold->xc_search_index->si_name)
+                    sz += strlen(x->x_cold->xc_search_index->si_name)+1;
+                if (x->x_cold->xc_search_index->si_xvec)
+                    sz += clixon_xvec_len(x->x_cold->xc_search_index->si_xvec)*sizeof(struct cxobj*);
+            }
 #endif
+        }
         break;
     case CX_BODY:
     case CX_ATTR:
@@ -358,11 +982,18 @@ xml_name_set(cxobj *xn,
              char  *name)
 {
     if (xn->x_name){
-        free(xn->x_name);
+        if ((xn->x_flags & XML_FLAG_INTERN_NAME) == 0)
+            free(xn->x_name);
         xn->x_name = NULL;
+        xn->x_flags &= ~XML_FLAG_INTERN_NAME;
     }
     if (name){
-        if ((xn->x_name = strdup(name)) == NULL){
+        if (_xml_intern_enabled){
+            if ((xn->x_name = xml_intern_str(name)) == NULL)
+                return -1;
+            xn->x_flags |= XML_FLAG_INTERN_NAME;
+        }
+        else if ((xn->x_name = strdup(name)) == NULL){
             clicon_err(OE_XML, errno, "strdup");
             return -1;
         }
@@ -391,11 +1022,18 @@ xml_prefix_set(cxobj *xn,
                char  *prefix)
 {
     if (xn->x_prefix){
-        free(xn->x_prefix);
+        if ((xn->x_flags & XML_FLAG_INTERN_PREFIX) == 0)
+            free(xn->x_prefix);
         xn->x_prefix = NULL;
+        xn->x_flags &= ~XML_FLAG_INTERN_PREFIX;
     }
     if (prefix){
-        if ((xn->x_prefix = strdup(prefix)) == NULL){
+        if (_xml_intern_enabled){
+            if ((xn->x_prefix = xml_intern_str(prefix)) == NULL)
+                return -1;
+            xn->x_flags |= XML_FLAG_INTERN_PREFIX;
+        }
+        else if ((xn->x_prefix = strdup(prefix)) == NULL){
             clicon_err(OE_XML, errno, "strdup");
             return -1;
         }
@@ -403,6 +1041,149 @@ xml_prefix_set(cxobj *xn,
     return 0;
 }
 
+/*
+ * Shared namespace-context pool
+ * A config tree typically uses only a handful of distinct prefix->namespace
+ * contexts, while the per-node cache duplicated one cvec per node. Contexts
+ * installed via nscache_replace are interned here and shared refcounted by
+ * all nodes with identical bindings; such nodes carry XML_FLAG_NS_SHARED.
+ * Incremental nscache_set on a shared context detaches to a private copy
+ * first (copy-on-write).
+ */
+struct nsctx_shared{
+    cvec     *ns_nsc;    /* Shared namespace context */
+    uint32_t  ns_refcnt; /* Number of nodes pointing at ns_nsc */
+};
+static clicon_hash_t *_nscache_shared_tbl = NULL;
+
+/*! Serialize a namespace context to a canonical pool key
+ * @param[out] cb   Key appended here
+ * @param[in]  nsc  Namespace context
+ * @retval     0    OK
+ */
+static int
+nscache_shared_key(cbuf *cb,
+                   cvec *nsc)
+{
+    cg_var *cv = NULL;
+
+    while ((cv = cvec_each(nsc, cv)) != NULL)
+        cprintf(cb, "%s=%s;",
+                cv_name_get(cv)?cv_name_get(cv):"",
+                cv_string_get(cv)?cv_string_get(cv):"");
+    return 0;
+}
+
+/*! Intern a namespace context in the shared pool
+ * @param[in]  nsc  Namespace context, consumed (freed if an equal pooled
+ *                  context exists, pooled otherwise)
+ * @retval     ptr  Pooled shared context, refcount incremented
+ * @retval     NULL Error
+ */
+static cvec *
+nscache_shared_intern(cvec *nsc)
+{
+    cvec               *retval = NULL;
+    cbuf               *cb = NULL;
+    struct nsctx_shared nse = {0,};
+    void               *p;
+
+    if (_nscache_shared_tbl == NULL &&
+        (_nscache_shared_tbl = clicon_hash_init()) == NULL)
+        goto done;
+    if ((cb = cbuf_pool_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_pool_get");
+        goto done;
+    }
+    if (nscache_shared_key(cb, nsc) < 0)
+        goto done;
+    if ((p = clicon_hash_value(_nscache_shared_tbl, cbuf_get(cb), NULL)) != NULL){
+        memcpy(&nse, p, sizeof(nse));
+        nse.ns_refcnt++;
+        memcpy(p, &nse, sizeof(nse));
+        xml_nsctx_free(nsc);
+        retval = nse.ns_nsc;
+        goto done;
+    }
+    nse.ns_nsc = nsc;
+    nse.ns_refcnt = 1;
+    if (clicon_hash_add(_nscache_shared_tbl, cbuf_get(cb), &nse, sizeof(nse)) == NULL)
+        goto done;
+    retval = nsc;
+ done:
+    if (cb)
+        cbuf_pool_put(cb);
+    return retval;
+}
+
+/*! Release one reference to a pooled shared namespace context
+ * @param[in]  nsc  Pooled context as returned by nscache_shared_intern
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+nscache_shared_deref(cvec *nsc)
+{
+    int                 retval = -1;
+    cbuf               *cb = NULL;
+    struct nsctx_shared nse;
+    void               *p;
+
+    if (_nscache_shared_tbl == NULL)
+        return 0; /* Pool already torn down */
+    if ((cb = cbuf_pool_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_pool_get");
+        goto done;
+    }
+    if (nscache_shared_key(cb, nsc) < 0)
+        goto done;
+    if ((p = clicon_hash_value(_nscache_shared_tbl, cbuf_get(cb), NULL)) != NULL){
+        memcpy(&nse, p, sizeof(nse));
+        if (--nse.ns_refcnt == 0){
+            xml_nsctx_free(nse.ns_nsc);
+            clicon_hash_del(_nscache_shared_tbl, cbuf_get(cb));
+        }
+        else
+            memcpy(p, &nse, sizeof(nse));
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_pool_put(cb);
+    return retval;
+}
+
+/*! Free the shared namespace-context pool, for unit-test and exit
+ * Nodes still flagged XML_FLAG_NS_SHARED keep dangling pointers; only call
+ * when no XML trees remain or at process exit.
+ * @retval    0    OK
+ * @see xml_intern_exit
+ */
+int
+nscache_shared_exit(void)
+{
+    clicon_hash_t      *tbl = _nscache_shared_tbl;
+    int                 i;
+    size_t              klen = 0;
+    char              **keys = NULL;
+    struct nsctx_shared nse;
+    void               *p;
+
+    _nscache_shared_tbl = NULL;
+    if (tbl == NULL)
+        return 0;
+    if (clicon_hash_keys(tbl, &keys, &klen) == 0 && keys != NULL){
+        for (i = 0; i < klen; i++)
+            if ((p = clicon_hash_value(tbl, keys[i], NULL)) != NULL){
+                memcpy(&nse, p, sizeof(nse));
+                xml_nsctx_free(nse.ns_nsc);
+            }
+        free(keys);
+    }
+    clicon_hash_free(tbl);
+    return 0;
+}
+
 /*! Get cached namespace (given prefix)
  * @param[in] x      XML node
  * @param[in] prefix Namespace prefix, or NULL for default
@@ -416,8 +1197,8 @@ nscache_get(cxobj *x,
 {
     if (!is_element(x))
         return NULL;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get(x->x_ns_cache, prefix);
+    if (x->x_cold != NULL && x->x_cold->xc_ns_cache != NULL)
+        return xml_nsctx_get(x->x_cold->xc_ns_cache, prefix);
     return NULL;
 }
 
@@ -435,8 +1216,8 @@ nscache_get_prefix(cxobj *x,
 {
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get_prefix(x->x_ns_cache, namespace, prefix);
+    if (x->x_cold != NULL && x->x_cold->xc_ns_cache != NULL)
+        return xml_nsctx_get_prefix(x->x_cold->xc_ns_cache, namespace, prefix);
     return 0;
 }
 
@@ -451,7 +1232,7 @@ nscache_get_all(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
-    return x->x_ns_cache;
+    return x->x_cold ? x->x_cold->xc_ns_cache : NULL;
 }
 
 /*! Set cached namespace for specific namespace. Replace if necessary
@@ -467,16 +1248,31 @@ nscache_set(cxobj *x,
             char  *prefix,
             char  *namespace)
 {
-    int     retval = -1;
+    int              retval = -1;
+    struct xml_cold *xc;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache == NULL){
-        if ((x->x_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
+    if ((xc = xml_cold_ensure(x)) == NULL)
+        goto done;
+    if (xc->xc_ns_cache == NULL){
+        if ((xc->xc_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
             goto done;
     }
-    else 
-        return xml_nsctx_add(x->x_ns_cache, prefix, namespace);
+    else{
+        if (x->x_flags & XML_FLAG_NS_SHARED){
+            /* Copy-on-write: detach from shared pool before mutating */
+            cvec *nsc;
+            if ((nsc = cvec_dup(xc->xc_ns_cache)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_dup");
+                goto done;
+            }
+            nscache_shared_deref(xc->xc_ns_cache);
+            xc->xc_ns_cache = nsc;
+            x->x_flags &= ~XML_FLAG_NS_SHARED;
+        }
+        return xml_nsctx_add(xc->xc_ns_cache, prefix, namespace);
+    }
     retval = 0;
  done:
     return retval;
@@ -493,17 +1289,26 @@ int
 nscache_replace(cxobj *x,
                 cvec  *nsc)
 {
-    int     retval = -1;
+    int              retval = -1;
+    struct xml_cold *xc;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if ((xc = xml_cold_ensure(x)) == NULL)
+        goto done;
+    if (xc->xc_ns_cache != NULL){
+        if (x->x_flags & XML_FLAG_NS_SHARED)
+            nscache_shared_deref(xc->xc_ns_cache);
+        else
+            xml_nsctx_free(xc->xc_ns_cache);
+        xc->xc_ns_cache = NULL;
+        x->x_flags &= ~XML_FLAG_NS_SHARED;
     }
-    x->x_ns_cache = nsc;
+    if ((xc->xc_ns_cache = nscache_shared_intern(nsc)) == NULL)
+        goto done;
+    x->x_flags |= XML_FLAG_NS_SHARED;
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -520,9 +1325,13 @@ nscache_clear(cxobj *x)
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if (x->x_cold != NULL && x->x_cold->xc_ns_cache != NULL){
+        if (x->x_flags & XML_FLAG_NS_SHARED)
+            nscache_shared_deref(x->x_cold->xc_ns_cache);
+        else
+            xml_nsctx_free(x->x_cold->xc_ns_cache);
+        x->x_cold->xc_ns_cache = NULL;
+        x->x_flags &= ~XML_FLAG_NS_SHARED;
     }
     return 0;
 }
@@ -658,6 +1467,7 @@ xml_value_set(cxobj *xn,
     else
         cbuf_reset(xn->x_value_cb);
     cbuf_append_str(xn->x_value_cb, val);
+    xml_gen_bump(xn);
     retval = 0;
  done:
     return retval;
@@ -693,6 +1503,7 @@ xml_value_append(cxobj *xn,
         clicon_err(OE_XML, errno, "cprintf");
         goto done;
     }
+    xml_gen_bump(xn);
     retval = 0;
  done:
     return retval;
@@ -740,6 +1551,8 @@ xml_child_nr(cxobj *xn)
     }
     if (!is_element(xn))
         return 0;
+    if (xn->x_flags & XML_FLAG_PACKED) /* counting needs no materialization */
+        return xn->x_cold->xc_pack_nr;
     return xn->x_childvec_len;
 }
 
@@ -804,6 +1617,8 @@ xml_child_i(cxobj *xn,
     }
     if (!is_element(xn))
         return NULL;
+    if ((xn->x_flags & XML_FLAG_PACKED) && xml_unpack(xn) < 0)
+        return NULL;
     if (i < xn->x_childvec_len)
         return xn->x_childvec[i];
     return NULL;
@@ -846,6 +1661,9 @@ xml_child_i_set(cxobj *xt,
 {
     if (!is_element(xt))
         return NULL;
+    if ((xt->x_flags & XML_FLAG_PACKED) && xml_unpack(xt) < 0)
+        return NULL;
+    xml_find_index_invalidate(xt);
     if (i < xt->x_childvec_len)
         xt->x_childvec[i] = xc;
     return 0;
@@ -921,6 +1739,8 @@ xml_child_each(cxobj           *xparent,
         return NULL;
     if (!is_element(xparent))
         return NULL;
+    if ((xparent->x_flags & XML_FLAG_PACKED) && xml_unpack(xparent) < 0)
+        return NULL;
     for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
         xn = xparent->x_childvec[i];
         if (xn == NULL)
@@ -949,7 +1769,11 @@ xml_child_append(cxobj *xp,
 
     if (!is_element(xp))
         return 0;
+    if ((xp->x_flags & XML_FLAG_PACKED) && xml_unpack(xp) < 0)
+        return -1;
     start = XML_CHILDVEC_SIZE_START;
+    xml_find_index_invalidate(xp);
+    xml_gen_bump(xp);
     /* Heurestics: if child is body only single child is expected, but element children may
      * have siblings
      */
@@ -985,6 +1809,10 @@ xml_child_insert_pos(cxobj *xp,
    
     if (!is_element(xp))
         return 0;
+    if ((xp->x_flags & XML_FLAG_PACKED) && xml_unpack(xp) < 0)
+        return -1;
+    xml_find_index_invalidate(xp);
+    xml_gen_bump(xp);
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
@@ -1016,6 +1844,9 @@ xml_childvec_set(cxobj *x,
 {
     if (!is_element(x))
         return 0;
+    if ((x->x_flags & XML_FLAG_PACKED) && xml_unpack(x) < 0)
+        return -1;
+    xml_find_index_invalidate(x);
     x->x_childvec_len = len;
     x->x_childvec_max = len;
     if (x->x_childvec)
@@ -1034,6 +1865,8 @@ xml_childvec_get(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
+    if ((x->x_flags & XML_FLAG_PACKED) && xml_unpack(x) < 0)
+        return NULL;
     return x->x_childvec;
 }
 
@@ -1063,6 +1896,273 @@ clixon_child_xvec_append(cxobj       *xn,
     return retval;
 }
 
+/*! Bulk-move a contiguous range of children from one parent to another
+ *
+ * Adopt n children of xfrom starting at position i and append them at the end
+ * of xto:s child vector. The destination vector is grown once, the source
+ * range is closed with a single memmove, and each child only gets its parent
+ * pointer rewritten; compare per-child xml_child_rm()/xml_addsub() which
+ * shifts the vectors for every move.
+ * Note that the moved children are appended unsorted: the caller is expected
+ * to do a single xml_sort(xto) (or insert in yang-order) afterwards if xto is
+ * sorted.
+ * @param[in]  xfrom  Source XML parent node
+ * @param[in]  i      Start position of range in xfrom
+ * @param[in]  n      Number of children to move
+ * @param[in]  xto    Destination XML parent node
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see clixon_child_xvec_append  For appending from an xvec
+ * @see xml_addsub                For single-child adoption incl ns checks
+ */
+int
+clixon_child_splice(cxobj *xfrom,
+                    int    i,
+                    int    n,
+                    cxobj *xto)
+{
+    int    retval = -1;
+    cxobj *xc;
+    int    len1;
+    int    j;
+
+    if (!is_element(xfrom) || !is_element(xto)){
+        clicon_err(OE_XML, EINVAL, "source or destination not element");
+        goto done;
+    }
+    if ((xfrom->x_flags & XML_FLAG_PACKED) && xml_unpack(xfrom) < 0)
+        goto done;
+    if ((xto->x_flags & XML_FLAG_PACKED) && xml_unpack(xto) < 0)
+        goto done;
+    if (i < 0 || n < 0 || i + n > xfrom->x_childvec_len){
+        clicon_err(OE_XML, EINVAL, "range [%d..%d] outside child vector", i, i+n);
+        goto done;
+    }
+    if (n == 0)
+        goto ok;
+    xml_find_index_invalidate(xfrom);
+    xml_find_index_invalidate(xto);
+    /* Grow destination vector once to fit all adopted children */
+    len1 = xto->x_childvec_len + n;
+    if (len1 > xto->x_childvec_max){
+        while (xto->x_childvec_max < len1){
+            if (xto->x_childvec_max < XML_CHILDVEC_SIZE_THRESHOLD)
+                xto->x_childvec_max = xto->x_childvec_max?2*xto->x_childvec_max:XML_CHILDVEC_SIZE_START_ELMNT;
+            else
+                xto->x_childvec_max += XML_CHILDVEC_SIZE_THRESHOLD;
+        }
+        if ((xto->x_childvec = realloc(xto->x_childvec, xto->x_childvec_max*sizeof(cxobj*))) == NULL){
+            clicon_err(OE_XML, errno, "realloc");
+            goto done;
+        }
+    }
+    memcpy(&xto->x_childvec[xto->x_childvec_len], &xfrom->x_childvec[i], n*sizeof(cxobj*));
+    xto->x_childvec_len = len1;
+    for (j=0; j<n; j++){
+        xc = xto->x_childvec[xto->x_childvec_len - n + j];
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_type(xc) == CX_ELMNT && xml_search_index_p(xc))
+            xml_search_child_rm(xfrom, xc);
+#endif
+        xml_parent_set(xc, xto);
+    }
+    /* Close the hole in the source vector with one move */
+    if (i + n < xfrom->x_childvec_len)
+        memmove(&xfrom->x_childvec[i], &xfrom->x_childvec[i+n],
+                (xfrom->x_childvec_len - i - n)*sizeof(cxobj*));
+    xfrom->x_childvec_len -= n;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Pack homogeneous leaf-list children into a compact value array
+ *
+ * A leaf-list with many entries costs three allocations per entry (element
+ * struct, body struct, value buffer) plus a child vector slot. When every
+ * child of xp is an entry of the same yang leaf-list, carries no marking
+ * flags, no attributes and a single body, the children are replaced by one
+ * NUL-separated value array on xp, keeping child order. Any later access to
+ * the children through the child accessors materializes them again
+ * transparently, so packing pays off for read-mostly trees such as the
+ * datastore cache; xml_child_nr and xml_tree_hash answer from the packed
+ * form without materializing.
+ * @param[in]  xp   XML parent node
+ * @retval     1    Packed
+ * @retval     0    Not applicable (too few or non-homogeneous children)
+ * @retval    -1    Error
+ * @see xml_leaflist_pack_recurse  Apply to a whole tree
+ */
+int
+xml_leaflist_pack(cxobj *xp)
+{
+    struct xml_cold *xcold;
+    cxobj           *x;
+    cxobj           *xb;
+    yang_stmt       *yc = NULL;
+    char            *name = NULL;
+    char            *prefix = NULL;
+    char            *blob = NULL;
+    char            *pname = NULL;
+    char            *pprefix = NULL;
+    size_t           len = 0;
+    size_t           off;
+    size_t           vlen;
+    int              nr;
+    int              i;
+
+    if (!is_element(xp) || (xp->x_flags & XML_FLAG_PACKED))
+        return 0;
+    nr = xp->x_childvec_len;
+    if (nr < XML_LEAFLIST_PACK_MIN)
+        return 0;
+    for (i = 0; i < nr; i++){
+        if ((x = xp->x_childvec[i]) == NULL || x->x_type != CX_ELMNT)
+            return 0;
+        if (i == 0){
+            name = x->x_name;
+            prefix = x->x_prefix;
+            if ((yc = x->x_spec) == NULL || yang_keyword_get(yc) != Y_LEAF_LIST)
+                return 0;
+        }
+        else if (x->x_spec != yc ||
+                 strcmp(x->x_name, name) != 0 ||
+                 (x->x_prefix == NULL) != (prefix == NULL) ||
+                 (prefix && strcmp(x->x_prefix, prefix) != 0))
+            return 0;
+        /* entry flags carry semantics (defaults, commit marks): leave such trees alone */
+        if (x->x_flags & ~(XML_FLAG_ARENA|XML_FLAG_INTERN_NAME|XML_FLAG_INTERN_PREFIX))
+            return 0;
+        if (x->x_childvec_len != 1 ||
+            (xb = x->x_childvec[0]) == NULL ||
+            xb->x_type != CX_BODY ||
+            xb->x_value_cb == NULL ||
+            strcmp(xb->x_name, "body") != 0)
+            return 0;
+        if (xb->x_flags & ~(XML_FLAG_ARENA|XML_FLAG_INTERN_NAME))
+            return 0;
+        len += cbuf_len(xb->x_value_cb) + 1;
+    }
+    if ((blob = malloc(len)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto err;
+    }
+    off = 0;
+    for (i = 0; i < nr; i++){
+        xb = xp->x_childvec[i]->x_childvec[0];
+        vlen = cbuf_len(xb->x_value_cb) + 1;
+        memcpy(blob + off, cbuf_get(xb->x_value_cb), vlen);
+        off += vlen;
+    }
+    if ((pname = strdup(name)) == NULL){
+        clicon_err(OE_XML, errno, "strdup");
+        goto err;
+    }
+    if (prefix && (pprefix = strdup(prefix)) == NULL){
+        clicon_err(OE_XML, errno, "strdup");
+        goto err;
+    }
+    if ((xcold = xml_cold_ensure(xp)) == NULL)
+        goto err;
+    xcold->xc_pack_val = blob;
+    xcold->xc_pack_len = len;
+    xcold->xc_pack_nr = nr;
+    xcold->xc_pack_name = pname;
+    xcold->xc_pack_prefix = pprefix;
+    xcold->xc_pack_spec = yc;
+    xml_find_index_invalidate(xp);
+    for (i = 0; i < nr; i++)
+        xml_free(xp->x_childvec[i]);
+    free(xp->x_childvec);
+    xp->x_childvec = NULL;
+    xp->x_childvec_len = 0;
+    xp->x_childvec_max = 0;
+    xp->x_flags |= XML_FLAG_PACKED;
+    return 1;
+ err:
+    if (blob)
+        free(blob);
+    if (pname)
+        free(pname);
+    if (pprefix)
+        free(pprefix);
+    return -1;
+}
+
+/*! Pack all packable leaf-lists in a tree
+ * @param[in]  xt   XML tree root
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_leaflist_pack
+ */
+int
+xml_leaflist_pack_recurse(cxobj *xt)
+{
+    cxobj *x;
+    int    i;
+
+    if (!is_element(xt) || (xt->x_flags & XML_FLAG_PACKED))
+        return 0;
+    for (i = 0; i < xt->x_childvec_len; i++){
+        if ((x = xt->x_childvec[i]) == NULL || x->x_type != CX_ELMNT)
+            continue;
+        if (xml_leaflist_pack_recurse(x) < 0)
+            return -1;
+    }
+    if (xml_leaflist_pack(xt) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Materialize packed leaf-list children back into regular child nodes
+ *
+ * Inverse of xml_leaflist_pack, called from the child accessors when a
+ * packed parent is about to be read or modified. Entries are recreated in
+ * their packed (original) order, so a sorted tree stays sorted.
+ * @param[in]  xp   XML parent node with XML_FLAG_PACKED set
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_unpack(cxobj *xp)
+{
+    struct xml_cold *xcold = xp->x_cold;
+    char            *p;
+    cxobj           *x;
+    cxobj           *xb;
+    int              i;
+
+    /* clear first: xml_new/xml_value_set below go through the accessors */
+    xp->x_flags &= ~XML_FLAG_PACKED;
+    p = xcold->xc_pack_val;
+    for (i = 0; i < xcold->xc_pack_nr; i++){
+        if ((x = xml_new(xcold->xc_pack_name, xp, CX_ELMNT)) == NULL)
+            return -1;
+        if (xcold->xc_pack_prefix &&
+            xml_prefix_set(x, xcold->xc_pack_prefix) < 0)
+            return -1;
+        xml_spec_set(x, xcold->xc_pack_spec);
+        if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+            return -1;
+        if (xml_value_set(xb, p) < 0)
+            return -1;
+        p += strlen(p) + 1;
+    }
+    free(xcold->xc_pack_val);
+    xcold->xc_pack_val = NULL;
+    xcold->xc_pack_len = 0;
+    xcold->xc_pack_nr = 0;
+    free(xcold->xc_pack_name);
+    xcold->xc_pack_name = NULL;
+    if (xcold->xc_pack_prefix){
+        free(xcold->xc_pack_prefix);
+        xcold->xc_pack_prefix = NULL;
+    }
+    xcold->xc_pack_spec = NULL;
+    return 0;
+}
+
 /*! Create new xml node given a name and parent. Free with xml_free().
  *
  * @param[in]  name      Name of XML node
@@ -1101,11 +2201,20 @@ xml_new(char           *name,
         return NULL;
         break;
     }
-    if ((x = malloc(sz)) == NULL){
-        clicon_err(OE_XML, errno, "malloc");
-        return NULL;
+    if (_xml_arena_current != NULL){
+        if ((x = xml_arena_alloc(_xml_arena_current, sz)) == NULL)
+            return NULL;
+        memset(x, 0, sz);
+        x->x_flags = XML_FLAG_ARENA;
+        _xml_arena_current->xa_nrnodes++;
+    }
+    else {
+        if ((x = malloc(sz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x, 0, sz);
     }
-    memset(x, 0, sz);
     xml_type_set(x, type);
     if (name && (xml_name_set(x, name)) < 0)
         return NULL;
@@ -1190,7 +2299,7 @@ xml_cv(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
-    return x->x_cv;
+    return x->x_cold ? x->x_cold->xc_cv : NULL;
 }
 
 /*! Set (cached) cligen variable value of xml node
@@ -1205,11 +2314,15 @@ int
 xml_cv_set(cxobj  *x, 
            cg_var *cv)
 {
+    struct xml_cold *xc;
+
     if (!is_element(x))
         return 0;
-    if (x->x_cv)
-        cv_free(x->x_cv);
-    x->x_cv = cv;
+    if ((xc = xml_cold_ensure(x)) == NULL)
+        return -1;
+    if (xc->xc_cv)
+        cv_free(xc->xc_cv);
+    xc->xc_cv = cv;
     return 0;
 }
 
@@ -1326,6 +2439,8 @@ xml_wrap_all(cxobj *xp,
 
     if (!is_element(xp))
         return NULL;
+    if ((xp->x_flags & XML_FLAG_PACKED) && xml_unpack(xp) < 0)
+        return NULL;
     if ((xw = xml_new(tag, NULL, CX_ELMNT)) == NULL)
         goto done;
     while (xp->x_childvec_len)
@@ -1418,6 +2533,8 @@ xml_child_rm(cxobj *xp,
         clicon_err(OE_XML, 0, "Child not found");
         goto done;
     }
+    xml_find_index_invalidate(xp);
+    xml_gen_bump(xp);
     xml_parent_set(xc, NULL);
     xp->x_childvec[i] = NULL;
     xp->x_childvec_len--;
@@ -1712,6 +2829,121 @@ xml_find_type_value(cxobj           *xt,
     return NULL;
 }
 
+/*! Invalidate the lazy name->child hash index of an XML node
+ * Called on any mutation of the child vector; the index is rebuilt on the
+ * next qualifying xml_find_type() lookup.
+ * @param[in]  x    XML node (noop for non-elements)
+ * @retval     0    OK
+ */
+int
+xml_find_index_invalidate(cxobj *x)
+{
+    if (x == NULL || !is_element(x))
+        return 0;
+    if (x->x_cold && x->x_cold->xc_find_index){
+        clicon_hash_free(x->x_cold->xc_find_index);
+        x->x_cold->xc_find_index = NULL;
+    }
+    if (x->x_cold && x->x_cold->xc_key_index){
+        clicon_hash_free(x->x_cold->xc_key_index);
+        x->x_cold->xc_key_index = NULL;
+    }
+    return 0;
+}
+
+/*! Check if a composite-key index exists on this parent
+ * @param[in]  xp   XML parent node
+ * @retval     1    Index exists
+ * @retval     0    No index
+ */
+int
+xml_key_index_p(cxobj *xp)
+{
+    return is_element(xp) && xp->x_cold != NULL && xp->x_cold->xc_key_index != NULL;
+}
+
+/*! Add one packed-key entry to the composite-key index of xp
+ *
+ * The packed key is an opaque string produced by the caller, typically the
+ * list name followed by all key leaf values, see clixon_xml_sort.c. The index
+ * is created on first add; on duplicate packed keys the first child is kept
+ * (first match semantics).
+ * @param[in]  xp   XML parent node
+ * @param[in]  key  Packed key string
+ * @param[in]  xc   Child to associate with key
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_find_index_invalidate  Which drops the index on child mutations
+ */
+int
+xml_key_index_set(cxobj *xp,
+                  char  *key,
+                  cxobj *xc)
+{
+    struct xml_cold *xcold;
+
+    if ((xcold = xml_cold_ensure(xp)) == NULL)
+        return -1;
+    if (xcold->xc_key_index == NULL &&
+        (xcold->xc_key_index = clicon_hash_init()) == NULL)
+        return -1;
+    if (clicon_hash_lookup(xcold->xc_key_index, key) != NULL)
+        return 0; /* keep first */
+    if (clicon_hash_add(xcold->xc_key_index, key, &xc, sizeof(xc)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Look up a child by packed composite key
+ * @param[in]  xp   XML parent node
+ * @param[in]  key  Packed key string as given to xml_key_index_set
+ * @param[out] xcp  Matching child, or NULL for authoritative miss
+ * @retval     1    Index exists, see xcp
+ * @retval     0    No index on this parent
+ */
+int
+xml_key_index_get(cxobj  *xp,
+                  char   *key,
+                  cxobj **xcp)
+{
+    void *p;
+
+    *xcp = NULL;
+    if (!xml_key_index_p(xp))
+        return 0;
+    if ((p = clicon_hash_value(xp->x_cold->xc_key_index, key, NULL)) != NULL)
+        memcpy(xcp, p, sizeof(*xcp));
+    return 1;
+}
+
+/*! Build name->first-child hash index over the element children of xt
+ * @param[in]  xt   XML parent node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_find_index_build(cxobj *xt)
+{
+    clicon_hash_t   *tbl;
+    cxobj           *x = NULL;
+    struct xml_cold *xc;
+
+    if ((xc = xml_cold_ensure(xt)) == NULL)
+        return -1;
+    if ((tbl = clicon_hash_init()) == NULL)
+        return -1;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        if (clicon_hash_lookup(tbl, xml_name(x)) != NULL)
+            continue; /* keep first occurrence in child order */
+        if (clicon_hash_add(tbl, xml_name(x), &x, sizeof(x)) == NULL){
+            clicon_hash_free(tbl);
+            return -1;
+        }
+    }
+    xc->xc_find_index = tbl;
+    return 0;
+}
+
 /*! Find and return the xml child of specific type given prefix and name
  *
  * The value can be of an attribute only
@@ -1728,7 +2960,7 @@ xml_find_type_value(cxobj           *xt,
  * @see xml_find_value where a body can be found as well
  */
 cxobj *
-xml_find_type(cxobj           *xt, 
+xml_find_type(cxobj           *xt,
               const char      *prefix,
               const char      *name,
               enum cxobj_type  type)
@@ -1736,9 +2968,25 @@ xml_find_type(cxobj           *xt,
     cxobj *x = NULL;
     int    pmatch;  /* prefix match */
     char  *xprefix; /* xprefix */
-    
+
     if (!is_element(xt))
         return NULL;
+    /* Large parents: use (or lazily build) a hash index over element children,
+     * making repeated membership lookups O(1) instead of a linear scan
+     */
+    if (prefix == NULL && name != NULL && type == CX_ELMNT &&
+        xml_child_nr(xt) >= XML_FIND_INDEX_THRESHOLD){
+        void *p;
+
+        if ((xt->x_cold && xt->x_cold->xc_find_index != NULL) ||
+            xml_find_index_build(xt) == 0){
+            x = NULL;
+            if ((p = clicon_hash_value(xt->x_cold->xc_find_index, (char*)name, NULL)) != NULL)
+                memcpy(&x, p, sizeof(x));
+            return x;
+        }
+        x = NULL; /* index build failed: fall through to linear scan */
+    }
     while ((x = xml_child_each(xt, x, type)) != NULL) {
         if (prefix){
             xprefix = xml_prefix(x);
@@ -1746,7 +2994,9 @@ xml_find_type(cxobj           *xt,
         }
         else
             pmatch = 1;
-        if (pmatch && (name==NULL || strcmp(name, xml_name(x)) == 0))
+        if (pmatch && (name==NULL ||
+                       name == xml_name(x) || /* interned names: pointer equality */
+                       strcmp(name, xml_name(x)) == 0))
             return x;
     }
     return NULL;
@@ -1854,9 +3104,11 @@ xml_free(cxobj *x)
     if (x == NULL){
         return 0;
     }
-    if (x->x_name)
+    if (_didx_nr && x->x_up == NULL) /* tree roots may carry a descendant index */
+        xml_didx_invalidate(x);
+    if (x->x_name && (x->x_flags & XML_FLAG_INTERN_NAME) == 0)
         free(x->x_name);
-    if (x->x_prefix)
+    if (x->x_prefix && (x->x_flags & XML_FLAG_INTERN_PREFIX) == 0)
         free(x->x_prefix);
     switch (xml_type(x)){
     case CX_ELMNT:
@@ -1868,13 +3120,28 @@ xml_free(cxobj *x)
         }
         if (x->x_childvec)
             free(x->x_childvec);
-        if (x->x_cv)
-            cv_free(x->x_cv);
-        if (x->x_ns_cache)
-            xml_nsctx_free(x->x_ns_cache);
+        if (x->x_cold){
+            if (x->x_cold->xc_cv)
+                cv_free(x->x_cold->xc_cv);
+            if (x->x_cold->xc_ns_cache){
+                if (x->x_flags & XML_FLAG_NS_SHARED)
+                    nscache_shared_deref(x->x_cold->xc_ns_cache);
+                else
+                    xml_nsctx_free(x->x_cold->xc_ns_cache);
+            }
+            xml_find_index_invalidate(x);
 #ifdef XML_EXPLICIT_INDEX
-        xml_search_index_free(x);
+            xml_search_index_free(x);
 #endif
+            if (x->x_cold->xc_pack_val)
+                free(x->x_cold->xc_pack_val);
+            if (x->x_cold->xc_pack_name)
+                free(x->x_cold->xc_pack_name);
+            if (x->x_cold->xc_pack_prefix)
+                free(x->x_cold->xc_pack_prefix);
+            free(x->x_cold);
+            x->x_cold = NULL;
+        }
         break;
     case CX_BODY:
     case CX_ATTR:
@@ -1884,7 +3151,8 @@ xml_free(cxobj *x)
     default:
         break;
     }
-    free(x);
+    if ((x->x_flags & XML_FLAG_ARENA) == 0) /* arena-carved structs are freed with the arena */
+        free(x);
     _stats_xml_nr--;
     return 0;
 }
@@ -1959,6 +3227,34 @@ xml_copy(cxobj *x0,
 
     if (xml_copy_one(x0, x1) <0)
         goto done;
+    /* copy packed leaf-list children in packed form: both trees stay compact */
+    if ((x0->x_flags & XML_FLAG_PACKED) && xml_child_nr(x1) == 0){
+        struct xml_cold *c0 = x0->x_cold;
+        struct xml_cold *c1;
+
+        if ((c1 = xml_cold_ensure(x1)) == NULL)
+            goto done;
+        if ((c1->xc_pack_val = malloc(c0->xc_pack_len)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        memcpy(c1->xc_pack_val, c0->xc_pack_val, c0->xc_pack_len);
+        if ((c1->xc_pack_name = strdup(c0->xc_pack_name)) == NULL){
+            clicon_err(OE_XML, errno, "strdup");
+            goto done;
+        }
+        if (c0->xc_pack_prefix &&
+            (c1->xc_pack_prefix = strdup(c0->xc_pack_prefix)) == NULL){
+            clicon_err(OE_XML, errno, "strdup");
+            goto done;
+        }
+        c1->xc_pack_len = c0->xc_pack_len;
+        c1->xc_pack_nr = c0->xc_pack_nr;
+        c1->xc_pack_spec = c0->xc_pack_spec;
+        x1->x_flags |= XML_FLAG_PACKED;
+        retval = 0;
+        goto done;
+    }
     x = NULL;
     while ((x = xml_child_each(x0, x, -1)) != NULL) {
         if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
@@ -2543,8 +3839,10 @@ xml_search_index_free(cxobj *x)
 {
     struct search_index *si;
 
-    while ((si = x->x_search_index) != NULL) {
-        DELQ(si, x->x_search_index, struct search_index *);
+    if (x->x_cold == NULL)
+        return 0;
+    while ((si = x->x_cold->xc_search_index) != NULL) {
+        DELQ(si, x->x_cold->xc_search_index, struct search_index *);
         if (si->si_name)
             free(si->si_name);
         if (si->si_xvec)
@@ -2565,7 +3863,10 @@ xml_search_index_add(cxobj *x,
                      char  *name)
 {
     struct search_index *si = NULL;
+    struct xml_cold     *xc;
 
+    if ((xc = xml_cold_ensure(x)) == NULL)
+        goto done;
     if ((si = malloc(sizeof(struct search_index))) == NULL){
         clicon_err(OE_XML, errno, "malloc");
         goto done;
@@ -2583,7 +3884,7 @@ xml_search_index_add(cxobj *x,
         si = NULL;
         goto done;
     }
-    ADDQ(si, x->x_search_index);
+    ADDQ(si, xc->xc_search_index);
  done:
     return si;
 }
@@ -2600,14 +3901,14 @@ xml_search_index_get(cxobj *x,
 {
     struct search_index *si = NULL;
 
-    if ((si = x->x_search_index) != NULL) {
+    if (x->x_cold && (si = x->x_cold->xc_search_index) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 goto done;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != x->x_search_index);
+        } while (si && si != x->x_cold->xc_search_index);
     }
  done:
     return si;
@@ -2629,14 +3930,14 @@ xml_search_vector_get(cxobj        *xp,
     struct search_index *si;
 
     *xvec = NULL;
-    if ((si = xp->x_search_index) != NULL) {
+    if (xp->x_cold && (si = xp->x_cold->xc_search_index) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 *xvec = si->si_xvec;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != xp->x_search_index);
+        } while (si && si != xp->x_cold->xc_search_index);
     }
     return 0;
 }
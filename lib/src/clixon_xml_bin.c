@@ -0,0 +1,519 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Clixon XML binary serialization
+ *
+ * Versioned binary cxobj tree format, directly materializable without
+ * lexing. Layout (all integers big-endian uint32 unless noted):
+ *
+ *   magic     4 bytes "CXB" + version byte
+ *   strtab    count, then per string: length + bytes (no NUL)
+ *             Names and prefixes are deduplicated here; with a config of
+ *             repeated lists the table is a few hundred entries.
+ *   tree      count of root nodes, then per node recursively:
+ *               uint8 node type (enum cxobj_type)
+ *               name index into strtab, or CXB_NONE
+ *               prefix index into strtab, or CXB_NONE
+ *               value length + bytes, length CXB_NONE if no value
+ *               child count, then child nodes
+ *
+ * Selected as datastore format with CLICON_XMLDB_FORMAT "binary".
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_string.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_bin.h"
+
+#define CXB_MAGIC   "CXB"    /* 3 byte magic, followed by version */
+#define CXB_VERSION 1        /* Bump on incompatible format change */
+#define CXB_NONE    0xffffffffu /* No name/prefix/value */
+
+/*! String table built during encoding: deduplicated names and prefixes
+ */
+struct cxb_strtab{
+    clicon_hash_t *st_hash; /* string -> uint32 index */
+    char         **st_vec;  /* index -> string (borrowed from tree) */
+    uint32_t       st_len;
+    uint32_t       st_max;
+};
+
+/*! Intern a string in the encoder string table
+ * @param[in]  st   String table
+ * @param[in]  str  String, borrowed, must outlive the table
+ * @param[out] idx  Table index of str, or CXB_NONE if str is NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+cxb_strtab_add(struct cxb_strtab *st,
+               char              *str,
+               uint32_t          *idx)
+{
+    void   *p;
+    char  **vec;
+    uint32_t i;
+
+    if (str == NULL){
+        *idx = CXB_NONE;
+        return 0;
+    }
+    if ((p = clicon_hash_value(st->st_hash, str, NULL)) != NULL){
+        memcpy(idx, p, sizeof(*idx));
+        return 0;
+    }
+    if (st->st_len == st->st_max){
+        if ((vec = realloc(st->st_vec, (st->st_max+256)*sizeof(*vec))) == NULL){
+            clicon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+        st->st_vec = vec;
+        st->st_max += 256;
+    }
+    i = st->st_len;
+    if (clicon_hash_add(st->st_hash, str, &i, sizeof(i)) == NULL)
+        return -1;
+    st->st_vec[i] = str;
+    st->st_len++;
+    *idx = i;
+    return 0;
+}
+
+/*! Collect names and prefixes of a subtree into the string table
+ */
+static int
+cxb_strtab_collect(struct cxb_strtab *st,
+                   cxobj             *x)
+{
+    cxobj   *xc;
+    uint32_t idx;
+
+    if (cxb_strtab_add(st, xml_name(x), &idx) < 0)
+        return -1;
+    if (cxb_strtab_add(st, xml_prefix(x), &idx) < 0)
+        return -1;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, -1)) != NULL)
+        if (cxb_strtab_collect(st, xc) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Write one big-endian uint32
+ */
+static int
+cxb_put32(FILE    *f,
+          uint32_t u)
+{
+    uint32_t n = htonl(u);
+
+    if (fwrite(&n, sizeof(n), 1, f) != 1){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Emit one node record recursively
+ */
+static int
+cxb_encode_node(FILE              *f,
+                struct cxb_strtab *st,
+                cxobj             *x)
+{
+    uint8_t  type = (uint8_t)xml_type(x);
+    uint32_t idx;
+    char    *val;
+    cxobj   *xc;
+
+    if (fwrite(&type, 1, 1, f) != 1){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        return -1;
+    }
+    if (cxb_strtab_add(st, xml_name(x), &idx) < 0)
+        return -1;
+    if (cxb_put32(f, idx) < 0)
+        return -1;
+    if (cxb_strtab_add(st, xml_prefix(x), &idx) < 0)
+        return -1;
+    if (cxb_put32(f, idx) < 0)
+        return -1;
+    if ((val = xml_value(x)) != NULL){
+        if (cxb_put32(f, strlen(val)) < 0)
+            return -1;
+        if (strlen(val) &&
+            fwrite(val, strlen(val), 1, f) != 1){
+            clicon_err(OE_UNIX, errno, "fwrite");
+            return -1;
+        }
+    }
+    else if (cxb_put32(f, CXB_NONE) < 0)
+        return -1;
+    if (cxb_put32(f, xml_child_nr(x)) < 0)
+        return -1;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, -1)) != NULL)
+        if (cxb_encode_node(f, st, xc) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Check if a buffer starts with the binary serialization magic
+ *
+ * @param[in]  buf  Buffer, eg an IPC message body
+ * @param[in]  len  Length of buf
+ * @retval     1    Yes, buf is binary serialized with the supported version
+ * @retval     0    No
+ * @see clicon_msg_decode  which uses this to sniff the payload encoding
+ */
+int
+clixon_bin_detect(const char *buf,
+                  size_t      len)
+{
+    return buf != NULL && len >= 4 &&
+        memcmp(buf, CXB_MAGIC, 3) == 0 &&
+        (uint8_t)buf[3] == CXB_VERSION;
+}
+
+/*! Write an XML tree in binary serialization format to a file
+ *
+ * @param[in]  f       File to print to (assume open)
+ * @param[in]  xn      Top-level xml object
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_bin2xml  for reading it back
+ * @see clixon_xml2file for the text format
+ */
+int
+clixon_xml2bin(FILE  *f,
+               cxobj *xn,
+               int    skiptop)
+{
+    int               retval = -1;
+    struct cxb_strtab st = {0,};
+    cxobj            *xc;
+    uint32_t          i;
+    uint8_t           magic[4] = CXB_MAGIC;
+
+    magic[3] = CXB_VERSION;
+    if ((st.st_hash = clicon_hash_init()) == NULL)
+        goto done;
+    /* Pass 1: collect names and prefixes so the table precedes the tree */
+    if (skiptop){
+        xc = NULL;
+        while ((xc = xml_child_each(xn, xc, -1)) != NULL)
+            if (cxb_strtab_collect(&st, xc) < 0)
+                goto done;
+    }
+    else if (cxb_strtab_collect(&st, xn) < 0)
+        goto done;
+    if (fwrite(magic, sizeof(magic), 1, f) != 1){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    if (cxb_put32(f, st.st_len) < 0)
+        goto done;
+    for (i = 0; i < st.st_len; i++){
+        if (cxb_put32(f, strlen(st.st_vec[i])) < 0)
+            goto done;
+        if (strlen(st.st_vec[i]) &&
+            fwrite(st.st_vec[i], strlen(st.st_vec[i]), 1, f) != 1){
+            clicon_err(OE_UNIX, errno, "fwrite");
+            goto done;
+        }
+    }
+    /* Pass 2: emit the tree, table lookups only hit existing entries */
+    if (skiptop){
+        if (cxb_put32(f, xml_child_nr(xn)) < 0)
+            goto done;
+        xc = NULL;
+        while ((xc = xml_child_each(xn, xc, -1)) != NULL)
+            if (cxb_encode_node(f, &st, xc) < 0)
+                goto done;
+    }
+    else{
+        if (cxb_put32(f, 1) < 0)
+            goto done;
+        if (cxb_encode_node(f, &st, xn) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (st.st_hash)
+        clicon_hash_free(st.st_hash);
+    if (st.st_vec)
+        free(st.st_vec);
+    return retval;
+}
+
+/*! Decoder cursor over an in-memory buffer
+ */
+struct cxb_dec{
+    const uint8_t *d_buf;
+    size_t         d_len;
+    size_t         d_pos;
+    char         **d_strtab; /* Owned NUL-terminated copies */
+    uint32_t       d_strlen;
+};
+
+/*! Read one big-endian uint32 with bounds check
+ */
+static int
+cxb_get32(struct cxb_dec *d,
+          uint32_t       *u)
+{
+    uint32_t n;
+
+    if (d->d_pos + sizeof(n) > d->d_len){
+        clicon_err(OE_XML, 0, "Truncated binary XML input");
+        return -1;
+    }
+    memcpy(&n, d->d_buf + d->d_pos, sizeof(n));
+    d->d_pos += sizeof(n);
+    *u = ntohl(n);
+    return 0;
+}
+
+/*! Resolve a string table index, or NULL for CXB_NONE
+ */
+static int
+cxb_dec_str(struct cxb_dec *d,
+            uint32_t        idx,
+            char          **str)
+{
+    if (idx == CXB_NONE){
+        *str = NULL;
+        return 0;
+    }
+    if (idx >= d->d_strlen){
+        clicon_err(OE_XML, 0, "Binary XML string index %u out of range", idx);
+        return -1;
+    }
+    *str = d->d_strtab[idx];
+    return 0;
+}
+
+/*! Materialize one node record recursively under parent xp
+ */
+static int
+cxb_decode_node(struct cxb_dec *d,
+                cxobj          *xp)
+{
+    uint8_t  type;
+    uint32_t idx;
+    uint32_t len;
+    uint32_t nchild;
+    uint32_t i;
+    char    *name;
+    char    *prefix;
+    char    *val = NULL;
+    cxobj   *x = NULL;
+
+    if (d->d_pos + 1 > d->d_len){
+        clicon_err(OE_XML, 0, "Truncated binary XML input");
+        return -1;
+    }
+    type = d->d_buf[d->d_pos++];
+    if (type != CX_ELMNT && type != CX_ATTR && type != CX_BODY){
+        clicon_err(OE_XML, 0, "Invalid binary XML node type %u", type);
+        return -1;
+    }
+    if (cxb_get32(d, &idx) < 0)
+        return -1;
+    if (cxb_dec_str(d, idx, &name) < 0)
+        return -1;
+    if (cxb_get32(d, &idx) < 0)
+        return -1;
+    if (cxb_dec_str(d, idx, &prefix) < 0)
+        return -1;
+    if ((x = xml_new(name?name:"", xp, type)) == NULL)
+        return -1;
+    if (prefix && xml_prefix_set(x, prefix) < 0)
+        return -1;
+    if (cxb_get32(d, &len) < 0)
+        return -1;
+    if (len != CXB_NONE){
+        if (d->d_pos + len > d->d_len){
+            clicon_err(OE_XML, 0, "Truncated binary XML input");
+            return -1;
+        }
+        if ((val = malloc(len+1)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            return -1;
+        }
+        memcpy(val, d->d_buf + d->d_pos, len);
+        val[len] = '\0';
+        d->d_pos += len;
+        if (xml_value_set(x, val) < 0){
+            free(val);
+            return -1;
+        }
+        free(val);
+    }
+    if (cxb_get32(d, &nchild) < 0)
+        return -1;
+    for (i = 0; i < nchild; i++)
+        if (cxb_decode_node(d, x) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Read and materialize an XML tree from binary serialization format
+ *
+ * @param[in]     f    File descriptor to read from (ie already open)
+ * @param[in,out] xt   Top of tree, decoded roots added under here,
+ *                     created as XML_TOP_SYMBOL if NULL on entry
+ * @retval        1    OK
+ * @retval        0    Invalid or truncated input
+ * @retval       -1    Error
+ * @see clixon_xml2bin
+ */
+int
+clixon_bin2xml(FILE   *f,
+               cxobj **xt)
+{
+    int            retval = -1;
+    struct cxb_dec d = {0,};
+    uint8_t       *buf = NULL;
+    size_t         buflen = 0;
+    size_t         bufmax = 0;
+    size_t         n;
+    uint8_t       *b;
+    uint32_t       nstr;
+    uint32_t       len;
+    uint32_t       nroot;
+    uint32_t       i;
+
+    if (xt == NULL || f == NULL){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    /* Slurp the file: records are not self-delimiting on a stream */
+    bufmax = 8192;
+    if ((buf = malloc(bufmax)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    while ((n = fread(buf+buflen, 1, bufmax-buflen, f)) > 0){
+        buflen += n;
+        if (buflen == bufmax){
+            if ((b = realloc(buf, bufmax*2)) == NULL){
+                clicon_err(OE_XML, errno, "realloc");
+                goto done;
+            }
+            buf = b;
+            bufmax *= 2;
+        }
+    }
+    if (ferror(f)){
+        clicon_err(OE_UNIX, errno, "fread");
+        goto done;
+    }
+    d.d_buf = buf;
+    d.d_len = buflen;
+    if (buflen < 4 ||
+        memcmp(buf, CXB_MAGIC, 3) != 0 ||
+        buf[3] != CXB_VERSION){
+        clicon_err(OE_XML, 0, "Invalid binary XML magic or version");
+        goto fail;
+    }
+    d.d_pos = 4;
+    if (cxb_get32(&d, &nstr) < 0)
+        goto fail;
+    if ((d.d_strtab = calloc(nstr?nstr:1, sizeof(char*))) == NULL){
+        clicon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    for (i = 0; i < nstr; i++){
+        if (cxb_get32(&d, &len) < 0)
+            goto fail;
+        if (d.d_pos + len > d.d_len){
+            clicon_err(OE_XML, 0, "Truncated binary XML input");
+            goto fail;
+        }
+        if ((d.d_strtab[i] = malloc(len+1)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        memcpy(d.d_strtab[i], d.d_buf + d.d_pos, len);
+        d.d_strtab[i][len] = '\0';
+        d.d_pos += len;
+        d.d_strlen = i+1;
+    }
+    if (*xt == NULL &&
+        (*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (cxb_get32(&d, &nroot) < 0)
+        goto fail;
+    for (i = 0; i < nroot; i++)
+        if (cxb_decode_node(&d, *xt) < 0)
+            goto fail;
+    retval = 1;
+ done:
+    if (d.d_strtab){
+        for (i = 0; i < d.d_strlen; i++)
+            free(d.d_strtab[i]);
+        free(d.d_strtab);
+    }
+    if (buf)
+        free(buf);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
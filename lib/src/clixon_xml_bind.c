@@ -366,20 +366,48 @@ populate_self_top(cxobj     *xt,
  * @see xml_bind_yang_rpc     for incoming rpc 
  * @see xml_bind_yang0        If the calling xml object should also be populated
  */
+static int xml_bind_yang0_opt(cxobj *xt, yang_bind yb, cxobj *xsibling, cxobj **xerr);
+
 int
-xml_bind_yang(cxobj     *xt, 
+xml_bind_yang(cxobj     *xt,
               yang_bind  yb,
               yang_stmt *yspec,
               cxobj    **xerr)
 {
-    int    retval = -1;
-    cxobj *xc;         /* xml child */
-    int    ret;
+    int        retval = -1;
+    cxobj     *xc;         /* xml child */
+    int        ret;
+    yang_stmt *yc0 = NULL;
+    cxobj     *xc0 = NULL;
+    char      *name0 = NULL;
+    char      *prefix0 = NULL;
+    char      *name;
+    char      *prefix;
 
     strip_body_objects(xt);
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
-        if ((ret = xml_bind_yang0(xc, yb, yspec, xerr)) < 0)
+        /* Reuse the previous sibling as role model when name and prefix
+         * repeat (massive lists), skipping namespace resolution and yang
+         * lookup per entry, see populate_self_parent
+         */
+        if (yb == YB_PARENT){
+            name = xml_name(xc);
+            prefix = xml_prefix(xc);
+            if (yc0 != NULL &&
+                clicon_strcmp(name0, name) == 0 &&
+                clicon_strcmp(prefix0, prefix) == 0)
+                ret = xml_bind_yang0_opt(xc, YB_PARENT, xc0, xerr);
+            else
+                ret = xml_bind_yang0_opt(xc, YB_PARENT, NULL, xerr);
+            if (ret < 0)
+                goto done;
+            xc0 = xc;
+            yc0 = xml_spec(xc); /* cache */
+            name0 = xml_name(xc);
+            prefix0 = xml_prefix(xc);
+        }
+        else if ((ret = xml_bind_yang0(xc, yb, yspec, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -459,6 +487,54 @@ xml_bind_yang0_opt(cxobj     *xt,
     goto done;
 }
 
+/*! Bind a single XML node to its yang spec, no recursion into children
+ *
+ * Single-node primitive for callers that drive their own tree walk and want to
+ * combine binding with other per-node work in one pass, eg JSON post-parse
+ * processing. Strips whitespace bodies of bound containers/lists like the
+ * recursive variants.
+ * @param[in]   xt       XML tree node
+ * @param[in]   yb       How to bind: YB_MODULE, YB_PARENT or YB_NONE
+ * @param[in]   yspec    Yang spec (for YB_MODULE)
+ * @param[in]   xsibling Optional already-bound sibling with same name/prefix
+ *                       used as role model, skipping the yang lookup
+ * @param[out]  xerr     Reason for failure, or NULL
+ * @retval      2        OK, not bound: parent is anyxml/anydata, do not descend
+ * @retval      1        OK, yang assignment made
+ * @retval      0        Yang assignment not made and xerr set
+ * @retval     -1        Error
+ * @see xml_bind_yang0  Recursive variant
+ */
+int
+xml_bind_yang_one(cxobj     *xt,
+                  yang_bind  yb,
+                  yang_stmt *yspec,
+                  cxobj     *xsibling,
+                  cxobj    **xerr)
+{
+    int ret;
+
+    switch (yb){
+    case YB_MODULE:
+        if ((ret = populate_self_top(xt, yspec, xerr)) < 0)
+            return -1;
+        break;
+    case YB_PARENT:
+        if ((ret = populate_self_parent(xt, xsibling, xerr)) < 0)
+            return -1;
+        break;
+    case YB_NONE:
+        ret = 1;
+        break;
+    default:
+        clicon_err(OE_XML, EINVAL, "Invalid yang binding: %d", yb);
+        return -1;
+    }
+    if (ret == 1)
+        strip_body_objects(xt);
+    return ret;
+}
+
 /*! Find yang spec association of tree of XML nodes
  *
  * @param[in]   xt     XML tree node
@@ -472,7 +548,7 @@ xml_bind_yang0_opt(cxobj     *xt,
  * @see xml_bind_yang  If only children of xt should be populated, not xt itself
  */
 int
-xml_bind_yang0(cxobj     *xt, 
+xml_bind_yang0(cxobj     *xt,
                yang_bind  yb,
                yang_stmt *yspec,
                cxobj    **xerr)
@@ -480,6 +556,12 @@ xml_bind_yang0(cxobj     *xt,
     int        retval = -1;
     cxobj     *xc;           /* xml child */
     int        ret;
+    yang_stmt *yc0 = NULL;
+    cxobj     *xc0 = NULL;
+    char      *name0 = NULL;
+    char      *prefix0 = NULL;
+    char      *name;
+    char      *prefix;
 
     switch (yb){
     case YB_MODULE:
@@ -505,10 +587,25 @@ xml_bind_yang0(cxobj     *xt,
     strip_body_objects(xt);
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
-        if ((ret = xml_bind_yang0_opt(xc, YB_PARENT, NULL, xerr)) < 0)
+        /* Reuse the previous sibling as role model when name and prefix
+         * repeat (massive lists), see the same cache in xml_bind_yang0_opt
+         */
+        name = xml_name(xc);
+        prefix = xml_prefix(xc);
+        if (yc0 != NULL &&
+            clicon_strcmp(name0, name) == 0 &&
+            clicon_strcmp(prefix0, prefix) == 0){
+            if ((ret = xml_bind_yang0_opt(xc, YB_PARENT, xc0, xerr)) < 0)
+                goto done;
+        }
+        else if ((ret = xml_bind_yang0_opt(xc, YB_PARENT, NULL, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
+        xc0 = xc;
+        yc0 = xml_spec(xc); /* cache */
+        name0 = xml_name(xc);
+        prefix0 = xml_prefix(xc);
     }
  ok:
     retval = 1;
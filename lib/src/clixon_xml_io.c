@@ -49,6 +49,8 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <errno.h>
 #include <string.h>
 #include <limits.h>
@@ -728,6 +730,501 @@ clixon_xml_parse_file(FILE      *fp,
     return retval;
 }
 
+/*! Streaming (SAX-like) parse of an XML string through an element callback
+ *
+ * Shares lexer and grammar with the DOM parser but hands each completed
+ * element to cb as soon as its end tag is seen. If cb returns 1 the element is
+ * pruned from the tree immediately, so documents of any size can be processed
+ * in memory bounded by tree depth times subtree size rather than document
+ * size. Typical uses are counting list entries, extracting single leaves or
+ * computing a digest of a large datastore file.
+ * @param[in]     str   String containing XML definition
+ * @param[in]     cb    Element callback, see clixon_xml_stream_cb
+ * @param[in]     arg   Callback argument
+ * @param[in,out] xt    Pointer to XML parse tree, if empty will be created.
+ *                      On return holds top-level skeleton incl non-pruned nodes
+ * @retval        0     OK
+ * @retval       -1     Error with clicon_err called. Includes parse error
+ * @see clixon_xml_parse_string  DOM variant with yang binding
+ * @note No yang binding or sorting is done in streaming mode
+ */
+int
+clixon_xml_parse_string_stream(const char           *str,
+                               clixon_xml_stream_cb *cb,
+                               void                 *arg,
+                               cxobj               **xt)
+{
+    int             retval = -1;
+    clixon_xml_yacc xy = {0,};
+    cxobj          *x;
+
+    if (str == NULL || cb == NULL || xt == NULL){
+        clicon_err(OE_XML, EINVAL, "str, cb or xt is NULL");
+        return -1;
+    }
+    if (strlen(str) == 0)
+        return 0;
+    if (*xt == NULL &&
+        (*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        return -1;
+    if ((xy.xy_parse_string = strdup(str)) == NULL){
+        clicon_err(OE_XML, errno, "strdup");
+        return -1;
+    }
+    xy.xy_xtop = *xt;
+    xy.xy_xparent = *xt;
+    xy.xy_stream_cb = cb;
+    xy.xy_stream_arg = arg;
+    if (clixon_xml_parsel_init(&xy) < 0)
+        goto done;
+    if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
+        goto done;
+    /* Purge all top-level body objects */
+    x = NULL;
+    while ((x = xml_find_type(*xt, NULL, "body", CX_BODY)) != NULL)
+        xml_purge(x);
+    retval = 0;
+  done:
+    clixon_xml_parsel_exit(&xy);
+    if (xy.xy_parse_string != NULL)
+        free(xy.xy_parse_string);
+    if (xy.xy_xvec)
+        free(xy.xy_xvec);
+    return retval;
+}
+
+/*
+ * Incremental push parser
+ * Feed bytes as they arrive from a nonblocking socket; complete top-level
+ * elements are detected with a cheap lexical scan and parsed as soon as
+ * their end tag arrives, so parsing overlaps transfer and peak buffering is
+ * one top-level element rather than the whole message.
+ */
+
+/*! Lexical scanner states of the push parser boundary detector */
+enum xml_push_state{
+    XPS_TEXT = 0, /* outside markup */
+    XPS_LT,       /* just seen '<' */
+    XPS_TAG,      /* inside start-, end- or empty-element tag */
+    XPS_BANG,     /* seen "<!", disambiguating comment/CDATA/decl */
+    XPS_COMMENT,  /* inside comment, looking for "-->" */
+    XPS_CDATA,    /* inside CDATA section, looking for "]]>" */
+    XPS_PI,       /* inside processing instruction, looking for "?>" */
+};
+
+struct clixon_xml_push{
+    cbuf                 *xp_buf;     /* Unconsumed input */
+    size_t                xp_scanned; /* Scan position in xp_buf */
+    int                   xp_depth;   /* Element nesting depth */
+    enum xml_push_state   xp_state;
+    int                   xp_endtag;  /* Current tag is an end tag */
+    int                   xp_empty;   /* Last tag char was '/', empty element */
+    char                  xp_quote;   /* In-tag quote char, or 0 */
+    char                  xp_prev;    /* Previous byte, for multi-char delimiters */
+    char                  xp_prev2;   /* Byte before that, for "-->" and "]]>" */
+    clixon_xml_stream_cb *xp_cb;      /* Per-element callback, or NULL */
+    void                 *xp_arg;     /* Callback argument */
+    cxobj                *xp_xt;      /* Accumulated tree of kept elements */
+};
+
+/*! Default push callback: keep everything
+ */
+static int
+xml_push_keep_cb(cxobj *x,
+                 void  *arg)
+{
+    return 0;
+}
+
+/*! Create an incremental XML push parser
+ * @param[in]  cb   Called for each completed top-level element, on return 1
+ *                  the element is pruned after the call (bounded memory);
+ *                  NULL keeps all elements in the tree, see clixon_xml_push_done
+ * @param[in]  arg  Callback argument
+ * @retval     xp   Push parser handle
+ * @retval     NULL Error
+ * @see clixon_xml_push_feed
+ */
+clixon_xml_push *
+clixon_xml_push_new(clixon_xml_stream_cb *cb,
+                    void                 *arg)
+{
+    struct clixon_xml_push *xp;
+
+    if ((xp = malloc(sizeof(*xp))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(xp, 0, sizeof(*xp));
+    if ((xp->xp_buf = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        free(xp);
+        return NULL;
+    }
+    xp->xp_cb = cb ? cb : xml_push_keep_cb;
+    xp->xp_arg = arg;
+    return xp;
+}
+
+/*! Parse the complete element slice [0..end) of the buffer and consume it
+ */
+static int
+xml_push_parse_slice(struct clixon_xml_push *xp,
+                     size_t                  end)
+{
+    int    retval = -1;
+    char  *b = cbuf_get(xp->xp_buf);
+    size_t len = cbuf_len(xp->xp_buf);
+    char   save;
+    int    ret;
+
+    /* NUL-terminate the slice in place, restored below */
+    save = b[end];
+    b[end] = '\0';
+    ret = clixon_xml_parse_string_stream(b, xp->xp_cb, xp->xp_arg, &xp->xp_xt);
+    b[end] = save;
+    if (ret < 0)
+        goto done;
+    /* Drop the consumed prefix, keep any bytes of the next element */
+    if (end < len){
+        char *rest;
+
+        if ((rest = malloc(len-end)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        memcpy(rest, b+end, len-end);
+        cbuf_reset(xp->xp_buf);
+        if (cbuf_append_buf(xp->xp_buf, rest, len-end) < 0){
+            clicon_err(OE_XML, errno, "cbuf_append_buf");
+            free(rest);
+            goto done;
+        }
+        free(rest);
+    }
+    else
+        cbuf_reset(xp->xp_buf);
+    xp->xp_scanned = 0;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Feed a chunk of bytes to the push parser
+ *
+ * Bytes are appended to the internal buffer; every top-level element whose
+ * end tag is now present is parsed and delivered immediately.
+ * @param[in]  xp   Push parser handle
+ * @param[in]  buf  Input bytes, need not align with any XML structure
+ * @param[in]  len  Number of bytes
+ * @retval     0    OK
+ * @retval    -1    Error (parse error or callback abort)
+ * @note NUL bytes in the input terminate the current slice early; XML
+ *       cannot contain them
+ */
+int
+clixon_xml_push_feed(clixon_xml_push *xp,
+                     const char      *buf,
+                     size_t           len)
+{
+    int    retval = -1;
+    char  *b;
+    size_t i;
+    char   c;
+
+    if (xp == NULL){
+        clicon_err(OE_XML, EINVAL, "xp is NULL");
+        return -1;
+    }
+    if (len > 0 && cbuf_append_buf(xp->xp_buf, (void*)buf, len) < 0){
+        clicon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    /* Scan forward from where the last feed stopped */
+    i = xp->xp_scanned;
+    while (i < cbuf_len(xp->xp_buf)){
+        b = cbuf_get(xp->xp_buf);
+        c = b[i];
+        switch (xp->xp_state){
+        case XPS_TEXT:
+            if (c == '<'){
+                xp->xp_state = XPS_LT;
+                xp->xp_endtag = 0;
+                xp->xp_empty = 0;
+            }
+            break;
+        case XPS_LT:
+            if (c == '!')
+                xp->xp_state = XPS_BANG;
+            else if (c == '?')
+                xp->xp_state = XPS_PI;
+            else{
+                xp->xp_state = XPS_TAG;
+                xp->xp_endtag = (c == '/');
+            }
+            break;
+        case XPS_TAG:
+            if (xp->xp_quote){
+                if (c == xp->xp_quote)
+                    xp->xp_quote = 0;
+            }
+            else if (c == '\'' || c == '"')
+                xp->xp_quote = c;
+            else if (c == '>'){
+                if (xp->xp_endtag)
+                    xp->xp_depth--;
+                else if (xp->xp_prev != '/')
+                    xp->xp_depth++;
+                xp->xp_state = XPS_TEXT;
+                if (xp->xp_depth == 0){
+                    /* Top-level element complete: parse and consume it */
+                    if (xml_push_parse_slice(xp, i+1) < 0)
+                        goto done;
+                    i = 0;
+                    continue;
+                }
+            }
+            break;
+        case XPS_BANG:
+            /* Comment "<!--", CDATA "<![", other decl handled as tag */
+            if (c == '-' && xp->xp_prev == '-')
+                xp->xp_state = XPS_COMMENT;
+            else if (c == '[' && xp->xp_prev == '!')
+                xp->xp_state = XPS_CDATA;
+            else if (c == '>')
+                xp->xp_state = XPS_TEXT;
+            break;
+        case XPS_COMMENT:
+            if (c == '>' && xp->xp_prev == '-' && xp->xp_prev2 == '-')
+                xp->xp_state = XPS_TEXT;
+            break;
+        case XPS_CDATA:
+            if (c == '>' && xp->xp_prev == ']' && xp->xp_prev2 == ']')
+                xp->xp_state = XPS_TEXT;
+            break;
+        case XPS_PI:
+            if (c == '>' && xp->xp_prev == '?')
+                xp->xp_state = XPS_TEXT;
+            break;
+        }
+        xp->xp_prev2 = xp->xp_prev;
+        xp->xp_prev = c;
+        i++;
+    }
+    xp->xp_scanned = i;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Finish push parsing and take over the accumulated tree
+ *
+ * Any buffered remainder (prolog, comments, trailing whitespace) is parsed
+ * as-is; an incomplete element at this point is a parse error.
+ * @param[in]  xp   Push parser handle
+ * @param[out] xt   Accumulated tree of kept elements, or NULL if none;
+ *                  caller owns it. NULL if not wanted
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+clixon_xml_push_done(clixon_xml_push *xp,
+                     cxobj          **xt)
+{
+    int retval = -1;
+
+    if (xp == NULL){
+        clicon_err(OE_XML, EINVAL, "xp is NULL");
+        return -1;
+    }
+    if (cbuf_len(xp->xp_buf) > 0 &&
+        clixon_xml_parse_string_stream(cbuf_get(xp->xp_buf), xp->xp_cb,
+                                       xp->xp_arg, &xp->xp_xt) < 0)
+        goto done;
+    cbuf_reset(xp->xp_buf);
+    xp->xp_scanned = 0;
+    if (xt){
+        *xt = xp->xp_xt;
+        xp->xp_xt = NULL;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free an XML push parser and any undelivered tree
+ * @param[in]  xp   Push parser handle
+ * @retval     0    OK
+ */
+int
+clixon_xml_push_free(clixon_xml_push *xp)
+{
+    if (xp == NULL)
+        return 0;
+    if (xp->xp_buf)
+        cbuf_free(xp->xp_buf);
+    if (xp->xp_xt)
+        xml_free(xp->xp_xt);
+    free(xp);
+    return 0;
+}
+
+/*! Read and parse an XML definition from a file descriptor via mmap
+ *
+ * The file is mapped read-only and parsed in place, avoiding the
+ * byte-at-a-time read and buffer doubling of clixon_xml_parse_file. The
+ * parser still allocates owned strings for names and values (interned when
+ * enabled, see xml_intern_set), so the mapping is dropped before return.
+ * Falls back to one bulk read(2) when the file size is an exact multiple of
+ * the page size, since the in-place parse relies on the zero fill of the
+ * last page for NUL termination.
+ * @param[in]     fd    File descriptor positioned at start (eg fileno(fp))
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification, or NULL
+ * @param[in,out] xt    Top of XML parse tree, parsed XML is added under here
+ * @param[out]    xerr  Reason for invalid returned as netconf err msg
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial)
+ * @retval       -1     Error with clicon_err called
+ * @see clixon_xml_parse_file  for the FILE* based variant
+ */
+int
+clixon_xml_parse_mmap(int        fd,
+                      yang_bind  yb,
+                      yang_stmt *yspec,
+                      cxobj    **xt,
+                      cxobj    **xerr)
+{
+    int         retval = -1;
+    struct stat st;
+    char       *map = MAP_FAILED;
+    char       *buf = NULL;
+    const char *str = "";
+    size_t      len;
+    ssize_t     n;
+    size_t      off;
+    long        pagesize;
+    int         ret;
+
+    if (xt==NULL || fd < 0){
+        clicon_err(OE_XML, EINVAL, "arg is NULL");
+        return -1;
+    }
+    if (yb == YB_MODULE && yspec == NULL){
+        clicon_err(OE_XML, EINVAL, "yspec is required if yb == YB_MODULE");
+        return -1;
+    }
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat");
+        goto done;
+    }
+    len = st.st_size;
+    if ((pagesize = sysconf(_SC_PAGESIZE)) <= 0)
+        pagesize = 4096;
+    if (len > 0 && (len % pagesize) != 0){
+        /* Last page zero fill gives NUL termination for in-place parse */
+        if ((map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+            clicon_err(OE_UNIX, errno, "mmap");
+            goto done;
+        }
+#ifdef MADV_SEQUENTIAL
+        madvise(map, len, MADV_SEQUENTIAL);
+#endif
+        str = map;
+    }
+    else if (len > 0){
+        if ((buf = malloc(len+1)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        off = 0;
+        while (off < len){
+            if ((n = read(fd, buf+off, len-off)) < 0){
+                if (errno == EINTR)
+                    continue;
+                clicon_err(OE_UNIX, errno, "read");
+                goto done;
+            }
+            if (n == 0)
+                break; /* truncated under our feet, parse what we got */
+            off += n;
+        }
+        buf[off] = '\0';
+        str = buf;
+    }
+    if (*xt == NULL)
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    if ((ret = _xml_parse(str, yb, yspec, *xt, xerr)) < 0)
+        goto done;
+    retval = ret;
+ done:
+    if (map != MAP_FAILED)
+        munmap(map, len);
+    if (buf)
+        free(buf);
+    if (retval < 0 && xt && *xt){
+        free(*xt);
+        *xt = NULL;
+    }
+    return retval;
+}
+
+/*! Streaming (SAX-like) parse of an XML file through an element callback
+ *
+ * @param[in]     fp    File descriptor to the XML file (as ASCII characters)
+ * @param[in]     cb    Element callback, see clixon_xml_stream_cb
+ * @param[in]     arg   Callback argument
+ * @param[in,out] xt    Pointer to XML parse tree, if empty will be created
+ * @retval        0     OK
+ * @retval       -1     Error with clicon_err called. Includes parse error
+ * @see clixon_xml_parse_string_stream
+ * @note The raw input is still buffered in memory, only the tree is bounded
+ */
+int
+clixon_xml_parse_file_stream(FILE                 *fp,
+                             clixon_xml_stream_cb *cb,
+                             void                 *arg,
+                             cxobj               **xt)
+{
+    int     retval = -1;
+    char   *buf = NULL;
+    size_t  len = 0;
+    size_t  buflen = BUFLEN;
+    size_t  ret;
+
+    if (fp == NULL || cb == NULL || xt == NULL){
+        clicon_err(OE_XML, EINVAL, "fp, cb or xt is NULL");
+        return -1;
+    }
+    if ((buf = malloc(buflen)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    while ((ret = fread(buf+len, 1, buflen-len-1, fp)) > 0){
+        len += ret;
+        if (len >= buflen-1){
+            buflen *= 2;
+            if ((buf = realloc(buf, buflen)) == NULL){
+                clicon_err(OE_XML, errno, "realloc");
+                goto done;
+            }
+        }
+    }
+    if (ferror(fp)){
+        clicon_err(OE_XML, errno, "fread");
+        goto done;
+    }
+    buf[len] = '\0';
+    if (clixon_xml_parse_string_stream(buf, cb, arg, xt) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (buf)
+        free(buf);
+    return retval;
+}
+
 /*! Read an XML definition from string and parse it into a parse-tree, advanced API
  *
  * @param[in]     str   String containing XML definition. 
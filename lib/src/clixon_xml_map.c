@@ -42,6 +42,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <errno.h>
 #include <ctype.h>
@@ -315,6 +316,8 @@ xml_diff1(cxobj     *x0,
     char      *b1;
     char      *b2;
     int        eq;
+    uint64_t   h0;
+    uint64_t   h1;
 
     /* Traverse x0 and x1 in lock-step */
     x0c = x1c = NULL;    
@@ -378,11 +381,21 @@ xml_diff1(cxobj     *x0,
                             goto done;
                     }
                 }
-                else if (xml_diff1(x0c, x1c,   
-                                   x0vec, x0veclen, 
-                                   x1vec, x1veclen, 
-                                   changed_x0, changed_x1, changedlen)< 0)
-                    goto done;
+                else {
+                    /* Equal subtree content hashes: nothing to diff below.
+                     * Hashes are cached on long-lived trees (eg the datastore
+                     * cache) and invalidated by generation tracking, so
+                     * repeated diffs descend only into what changed */
+                    if (xml_tree_hash(x0c, &h0) < 0 ||
+                        xml_tree_hash(x1c, &h1) < 0)
+                        goto done;
+                    if (h0 != h1 &&
+                        xml_diff1(x0c, x1c,
+                                  x0vec, x0veclen,
+                                  x1vec, x1veclen,
+                                  changed_x0, changed_x1, changedlen) < 0)
+                        goto done;
+                }
         }
         x0c = xml_child_each(x0, x0c, CX_ELMNT);
         x1c = xml_child_each(x1, x1c, CX_ELMNT);
@@ -421,9 +434,9 @@ xml_diff(yang_stmt *yspec,
     int retval = -1;
 
     *firstlen = 0;
-    *secondlen = 0;    
+    *secondlen = 0;
     *changedlen = 0;
-    if (x0 == NULL && x1 == NULL)
+    if (x0 == x1) /* Includes both NULL, and shared (copy-on-write) trees */
         return 0;
     if (x1 == NULL){
         if (cxvec_append(x0, first, firstlen) < 0) 
@@ -436,8 +449,8 @@ xml_diff(yang_stmt *yspec,
         goto ok;
     }
     if (xml_diff1(x0, x1,
-                  first, firstlen, 
-                  second, secondlen, 
+                  first, firstlen,
+                  second, secondlen,
                   changed_x0, changed_x1, changedlen) < 0)
         goto done;
  ok:
@@ -446,6 +459,176 @@ xml_diff(yang_stmt *yspec,
     return retval;
 }
 
+/*! qsort comparator: order paths by recorded depth, ancestors first
+ * @see xml_diff_paths
+ */
+static int
+diff_path_depth_cmp(const void *a,
+                    const void *b)
+{
+    cg_var *cva = *(cg_var **)a;
+    cg_var *cvb = *(cg_var **)b;
+
+    return cv_int32_get(cva) - cv_int32_get(cvb);
+}
+
+/*! Compute differences between two xml trees restricted to a set of paths
+ *
+ * Same output contract as xml_diff but only the subtrees at the given paths
+ * are compared, for the case where the caller knows where edits were applied,
+ * see xmldb_touched_get. Paths are diffed ancestors first (by the depth
+ * recorded with each path) and paths inside an already diffed subtree are
+ * skipped, so overlapping records do not yield duplicate entries. A recorded
+ * path that does not parse as xpath is an error: absent in both trees is a
+ * legitimate outcome (created then deleted), a broken path is not.
+ * @param[in]  yspec      Yang specification
+ * @param[in]  x0         First XML tree
+ * @param[in]  x1         Second XML tree
+ * @param[in]  paths      Paths to compare: names are xpaths, values are depths
+ * @param[out] first      Pointervector to XML nodes existing in only first tree
+ * @param[out] firstlen   Length of first vector
+ * @param[out] second     Pointervector to XML nodes existing in only second tree
+ * @param[out] secondlen  Length of second vector
+ * @param[out] changed_x0 Pointervector to XML nodes changed orig value
+ * @param[out] changed_x1 Pointervector to XML nodes changed wanted value
+ * @param[out] changedlen Length of changed vector
+ * All xml vectors should be freed after use.
+ * @see xml_diff  for the full-tree variant
+ */
+int
+xml_diff_paths(yang_stmt *yspec,
+               cxobj     *x0,
+               cxobj     *x1,
+               cvec      *paths,
+               cxobj   ***first,
+               int       *firstlen,
+               cxobj   ***second,
+               int       *secondlen,
+               cxobj   ***changed_x0,
+               cxobj   ***changed_x1,
+               int       *changedlen)
+{
+    int        retval = -1;
+    cg_var   **cvv = NULL;
+    cg_var    *cv;
+    cxobj    **marked = NULL;
+    int        markedlen = 0;
+    cxobj    **vec = NULL;
+    size_t     veclen = 0;
+    cxobj     *x0n;
+    cxobj     *x1n;
+    cxobj     *xa;
+    yang_stmt *y;
+    char      *b0;
+    char      *b1;
+    int        n;
+    int        i;
+    int        skip;
+
+    *firstlen = 0;
+    *secondlen = 0;
+    *changedlen = 0;
+    if (x0 == x1) /* Includes both NULL, and shared (copy-on-write) trees */
+        return 0;
+    if ((n = cvec_len(paths)) == 0)
+        return 0;
+    if ((cvv = calloc(n, sizeof(*cvv))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i = 0;
+    cv = NULL;
+    while ((cv = cvec_each(paths, cv)) != NULL)
+        cvv[i++] = cv;
+    qsort(cvv, n, sizeof(*cvv), diff_path_depth_cmp);
+    for (i = 0; i < n; i++){
+        /* Use xpath_vec rather than xpath_first: a recorded path that does
+         * not parse must be an error, not mistaken for created-then-deleted
+         */
+        x0n = NULL;
+        if (x0){
+            if (xpath_vec(x0, NULL, "%s", &vec, &veclen, cv_name_get(cvv[i])) < 0)
+                goto done;
+            if (veclen)
+                x0n = vec[0];
+            free(vec);
+            vec = NULL;
+        }
+        x1n = NULL;
+        if (x1){
+            if (xpath_vec(x1, NULL, "%s", &vec, &veclen, cv_name_get(cvv[i])) < 0)
+                goto done;
+            if (veclen)
+                x1n = vec[0];
+            free(vec);
+            vec = NULL;
+        }
+        if (x0n == NULL && x1n == NULL)
+            continue;
+        /* Skip paths inside an already diffed subtree */
+        skip = 0;
+        for (xa = x0n; xa && !skip; xa = xml_parent(xa))
+            if (xml_flag(xa, XML_FLAG_MARK))
+                skip = 1;
+        for (xa = x1n; xa && !skip; xa = xml_parent(xa))
+            if (xml_flag(xa, XML_FLAG_MARK))
+                skip = 1;
+        if (skip)
+            continue;
+        if (x0n){
+            xml_flag_set(x0n, XML_FLAG_MARK);
+            if (cxvec_append(x0n, &marked, &markedlen) < 0)
+                goto done;
+        }
+        if (x1n){
+            xml_flag_set(x1n, XML_FLAG_MARK);
+            if (cxvec_append(x1n, &marked, &markedlen) < 0)
+                goto done;
+        }
+        if (x1n == NULL){ /* Only in first tree: removed */
+            if (cxvec_append(x0n, first, firstlen) < 0)
+                goto done;
+            continue;
+        }
+        if (x0n == NULL){ /* Only in second tree: added */
+            if (cxvec_append(x1n, second, secondlen) < 0)
+                goto done;
+            continue;
+        }
+        y = xml_spec(x0n);
+        if (y && yang_keyword_get(y) == Y_LEAF){
+            b0 = xml_body(x0n);
+            b1 = xml_body(x1n);
+            if (b0 == NULL && b1 == NULL)
+                ;
+            else if (b0 == NULL || b1 == NULL
+                     || strcmp(b0, b1) != 0){
+                if (cxvec_append(x0n, changed_x0, changedlen) < 0)
+                    goto done;
+                (*changedlen)--; /* append two vectors */
+                if (cxvec_append(x1n, changed_x1, changedlen) < 0)
+                    goto done;
+            }
+        }
+        else if (xml_diff1(x0n, x1n,
+                           first, firstlen,
+                           second, secondlen,
+                           changed_x0, changed_x1, changedlen) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    for (i = 0; i < markedlen; i++)
+        xml_flag_reset(marked[i], XML_FLAG_MARK);
+    if (marked)
+        free(marked);
+    if (vec)
+        free(vec);
+    if (cvv)
+        free(cvv);
+    return retval;
+}
+
 /*! Prune everything that does not pass test or have at least a child* does not
  *
  * @param[in]   xt      XML tree with some node marked
@@ -732,11 +915,35 @@ xml_non_config_data(cxobj  *xt,
     return retval;
 }
 
+/*! Print a value as an XPath string literal of a key predicate
+ *
+ * XPath 1.0 string literals have no escape mechanism: a value containing a
+ * double quote is printed single-quoted instead. A value containing both
+ * quote characters cannot be represented as a literal at all.
+ * @param[out] cb  XPath string as cbuf, the literal is appended
+ * @param[in]  b   Value to print, NULL prints as the empty literal
+ * @retval     1   OK
+ * @retval     0   Value cannot be represented as an XPath literal
+ */
+static int
+xpath_literal_print(cbuf *cb,
+                    char *b)
+{
+    if (b == NULL || index(b, '"') == NULL)
+        cprintf(cb, "\"%s\"", b?b:"");
+    else if (index(b, '\'') == NULL)
+        cprintf(cb, "'%s'", b);
+    else
+        return 0;
+    return 1;
+}
+
 /*! Given an XML node, build an xpath  recursively to root, internal function
  * @param[in]  x      XML object
  * @param[in]  nsc    Namespace context
  * @param[out] cb     XPath string as cbuf.
- * @retval     0      OK
+ * @retval     1      OK
+ * @retval     0      A key or leaf-list value cannot be represented in XPath
  * @retval    -1      Error. eg XML malformed
  */
 static int
@@ -756,11 +963,14 @@ xml2xpath1(cxobj *x,
     enum rfc_6020 keyword;
     char         *prefix = NULL;
     char         *namespace;
-    
+    int           ret;
+
     if ((xp = xml_parent(x)) == NULL)
         goto ok;
-    if (xml2xpath1(xp, nsc, cb) < 0)
+    if ((ret = xml2xpath1(xp, nsc, cb)) < 0)
         goto done;
+    if (ret == 0)
+        goto fail;
     if (nsc){
         if (xml2ns(x, xml_prefix(x), &namespace) < 0)
             goto done;
@@ -782,10 +992,11 @@ xml2xpath1(cxobj *x,
         keyword = yang_keyword_get(y);
         switch (keyword){
         case Y_LEAF_LIST:
-            if ((b = xml_body(x)) != NULL)
-                cprintf(cb, "[.=\"%s\"]", b);
-            else
-                cprintf(cb, "[.=\"\"]");
+            b = xml_body(x);
+            cprintf(cb, "[.=");
+            if (xpath_literal_print(cb, b) == 0)
+                goto fail;
+            cprintf(cb, "]");
             break;
         case Y_LIST:
             cvk = yang_cvec_get(y);
@@ -800,7 +1011,10 @@ xml2xpath1(cxobj *x,
                 cprintf(cb, "[");
                 if (prefix)
                     cprintf(cb, "%s:", prefix);
-                cprintf(cb, "%s=\"%s\"]", keyname, b?b:"");
+                cprintf(cb, "%s=", keyname);
+                if (xpath_literal_print(cb, b) == 0)
+                    goto fail;
+                cprintf(cb, "]");
             }
             break;
         default:
@@ -808,9 +1022,12 @@ xml2xpath1(cxobj *x,
         }
     }
  ok:
-    retval = 0;
+    retval = 1;
  done:
     return retval;
+ fail:
+    retval = 0;
+    goto done;
 }
 
 /*! Given an XML node, build an xpath to root
@@ -823,7 +1040,11 @@ xml2xpath1(cxobj *x,
  * @param[in]  x      XML object
  * @param[in]  nsc    Namespace context
  * @param[out] xpath  Malloced xpath string. Need to free() after use
- * @retval     0      OK
+ * @retval     1      OK
+ * @retval     0      A key or leaf-list value cannot be represented in XPath.
+ *                    XPath string literals have no escapes: a value containing
+ *                    both quote characters has no literal form. The returned
+ *                    xpath is truncated at the offending predicate.
  * @retval    -1      Error. (eg XML malformed)
  * @note x needs to be bound to YANG, see eg xml_bind_yang()
  */
@@ -835,12 +1056,13 @@ xml2xpath(cxobj *x,
     int   retval = -1;
     cbuf *cb;
     char *xpath = NULL;
+    int   ret;
 
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
-    if (xml2xpath1(x, nsc, cb) < 0)
+    if ((ret = xml2xpath1(x, nsc, cb)) < 0)
         goto done;
     /* XXX: see xpath in test statement,.. */
     xpath = cbuf_get(cb);
@@ -851,7 +1073,7 @@ xml2xpath(cxobj *x,
         }
         xpath = NULL;
     }
-    retval = 0;
+    retval = ret;
  done:
     if (cb)
         cbuf_free(cb);
@@ -1094,6 +1316,90 @@ assign_namespace_body(cxobj *x0, /* source */
     return retval;
 }
 
+/* Cursor state for the sorted-merge join over list runs, see merge_match_child */
+struct merge_cursor {
+    yang_stmt *mc_yc;     /* Yang spec of the active run, NULL if none */
+    int        mc_x0i;    /* Index in base child vector of last match */
+    cxobj     *mc_x1prev; /* Previous modification child of the run */
+};
+
+/*! Find base counterpart of modification child x1c, joining sorted list runs linearly
+ *
+ * Children on both sides are yang-sorted, so consecutive entries of the same
+ * ordered-by-system list or leaf-list can be matched by advancing a cursor in
+ * the base child vector linearly: a two-pointer sorted join costing O(n0+n1)
+ * compares overall instead of one search per modification child.
+ * Falls back to match_base_child at run starts, for ordered-by-user lists
+ * (stored in user order, not key order) and if the modification run turns out
+ * not to be sorted.
+ * @param[in]     x0    Base tree node
+ * @param[in]     x1c   Modification tree child
+ * @param[in]     yc    Yang spec of modification tree child
+ * @param[in,out] mc    Join cursor, zeroed by caller before the first child
+ * @param[out]    x0cp  Matching base tree child (if any)
+ * @retval        0     OK
+ * @retval       -1     Error
+ * @see match_base_child  for what "match" means here
+ */
+static int
+merge_match_child(cxobj               *x0,
+                  cxobj               *x1c,
+                  yang_stmt           *yc,
+                  struct merge_cursor *mc,
+                  cxobj              **x0cp)
+{
+    int           retval = -1;
+    int           joinable;
+    int           cmp;
+    cxobj        *x0c;
+    enum rfc_6020 kw;
+
+    *x0cp = NULL;
+    kw = yang_keyword_get(yc);
+    joinable = (kw == Y_LIST || kw == Y_LEAF_LIST) &&
+        yang_ordered_by_user(yc) == 0
+#ifndef STATE_ORDERED_BY_SYSTEM
+        && yang_config(yc) != 0 /* State data keeps arrival order, see xml_cmp */
+#endif
+        ;
+    if (joinable && kw == Y_LEAF_LIST && xml_body(x1c) == NULL)
+        joinable = 0; /* Empty leaf-list body: never matches, see match_base_child */
+    if (joinable && yc == mc->mc_yc){
+        if (xml_cmp(mc->mc_x1prev, x1c, 0, 0, NULL) > 0)
+            mc->mc_yc = NULL; /* Modification run not sorted: fall back to search */
+        else {
+            mc->mc_x1prev = x1c;
+            for (; mc->mc_x0i < xml_child_nr(x0); mc->mc_x0i++){
+                x0c = xml_child_i(x0, mc->mc_x0i);
+                if (xml_type(x0c) != CX_ELMNT)
+                    continue;
+                if (xml_spec(x0c) != yc)
+                    break; /* Base run exhausted: remaining children are adds */
+                if ((cmp = xml_cmp(x0c, x1c, 0, 0, NULL)) < 0)
+                    continue;
+                if (cmp == 0) /* Keep cursor on first match: keys may repeat in x1 */
+                    *x0cp = x0c;
+                break;
+            }
+            goto ok;
+        }
+    }
+    /* Run start, non-list child or fallback: one search, then anchor the cursor */
+    if (match_base_child(x0, x1c, yc, x0cp) < 0)
+        goto done;
+    if (joinable && *x0cp != NULL &&
+        (mc->mc_x0i = xml_child_order(x0, *x0cp)) >= 0){
+        mc->mc_yc = yc;
+        mc->mc_x1prev = x1c;
+    }
+    else
+        mc->mc_yc = NULL;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Merge a base tree x0 with x1 with yang spec y
  * @param[in]  x0  Base xml tree (can be NULL in add scenarios)
  * @param[in]  y0  Yang spec corresponding to xml-node x0. NULL if x0 is NULL
@@ -1124,6 +1430,7 @@ xml_merge1(cxobj              *x0,  /* the target */
     int             i;
     merge_twophase *twophase = NULL;
     int             twophase_len;
+    struct merge_cursor mcur = {0,};
     cvec           *nsc = NULL;
     cg_var         *cv;
     char           *ns;
@@ -1209,7 +1516,7 @@ xml_merge1(cxobj              *x0,  /* the target */
             }
             /* See if there is a corresponding node in the base tree */
             x0c = NULL;
-            if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
+            if (yc && merge_match_child(x0, x1c, yc, &mcur, &x0c) < 0)
                 goto done;
             /* If x0 already has a value, do not replace it with a default value in x1 */
             if (x0c && xml_flag(x1c, XML_FLAG_DEFAULT))
@@ -1281,6 +1588,7 @@ xml_merge(cxobj     *x0,
     int        i;
     merge_twophase *twophase = NULL;
     int        twophase_len;
+    struct merge_cursor mcur = {0,};
     int        ret;
 
     if (x0 == NULL || x1 == NULL){
@@ -1324,7 +1632,7 @@ xml_merge(cxobj     *x0,
         }
         x0c = NULL;
         /* See if there is a corresponding node (x1c) in the base tree (x0) */
-        if (yc && match_base_child(x0, x1c, yc, &x0c) < 0)
+        if (yc && merge_match_child(x0, x1c, yc, &mcur, &x0c) < 0)
             goto done;
         /* If x0 already has a value, do not replace it with a default value in x1 */
         if (x0c && xml_flag(x1c, XML_FLAG_DEFAULT))
@@ -1338,19 +1646,28 @@ xml_merge(cxobj     *x0,
         i++;
     }
     twophase_len = i; /* Inital length included non-elements */
-    /* Second run where actual merging is done 
-     * Loop through children of the modification tree */
+    /* Second run where actual merging is done
+     * Loop through children of the modification tree.
+     * Inserted subtrees are appended unsorted and the tree sorted once at the
+     * end, instead of one sorted insert (binary search + vector shift) each */
+    xml_sort_defer_begin();
     for (i=0; i<twophase_len; i++){
         assert(twophase[i].mt_x1c);
         if ((ret = xml_merge1(twophase[i].mt_x0c,
                               twophase[i].mt_yc,
                               x0,
                               twophase[i].mt_x1c,
-                              reason)) < 0)
+                              reason)) < 0){
+            xml_sort_defer_end(x0); /* leave tree sorted also on error */
             goto done;
-        if (ret == 0)
+        }
+        if (ret == 0){
+            xml_sort_defer_end(x0);
             goto fail;
+        }
     }
+    if (xml_sort_defer_end(x0) < 0)
+        goto done;
     retval = 1; /* OK */
  done:
     if (twophase)
@@ -1596,6 +1913,8 @@ yang_check_when_xpath(cxobj        *xn,
 {
     int        retval = 1;
     yang_stmt *yc;
+    yang_stmt *yx = NULL;     /* yang node carrying the when xpath */
+    xpath_tree *xptree;
     char      *xpath = NULL;
     cxobj     *x = NULL;
     int        nr = 0;
@@ -1607,6 +1926,7 @@ yang_check_when_xpath(cxobj        *xn,
     if ((xpath = yang_when_xpath_get(yn)) != NULL){
         x = xp;
         nsc = yang_when_nsc_get(yn);
+        yx = yn;
         *hit = 1;
     }
     /* Second variant */
@@ -1624,12 +1944,17 @@ yang_check_when_xpath(cxobj        *xn,
         if (xml_nsctx_yang(yn, &nsc) < 0)
             goto done;
         nscmalloc++;
+        yx = yc;
         *hit = 1;
     }
     else
         *hit = 0;
     if (x && xpath){
-        if ((nr = xpath_vec_bool(x, nsc, "%s", xpath)) < 0)
+        if ((xptree = yang_xptree_get(yx)) != NULL)
+            nr = xpath_tree_bool(x, nsc, xptree);
+        else /* Compiled at load, fallback if not */
+            nr = xpath_vec_bool(x, nsc, "%s", xpath);
+        if (nr < 0)
             goto done;
     }
     if (nrp)
@@ -1647,6 +1972,10 @@ yang_check_when_xpath(cxobj        *xn,
 
 /*! Check if node is (recursively) mandatory also checking when conditional
  *
+ * When no when-conditional participates in the decision the result is
+ * instance-independent and cached as flag bits on ys, so repeated instances
+ * of the same schema shape (eg large lists) skip the per-instance walk and
+ * its dummy-node allocation, see YANG_FLAG_MAND_CACHE.
  * @param[in]  xn  Optional XML node
  * @param[in]  xp  XML parent
  * @param[in]  ys  YANG node
@@ -1674,46 +2003,63 @@ yang_xml_mandatory(cxobj     *xt,
     yang_stmt    *yc;
     int           hit;
     int           nr;
+    int           dynamic = 0;
 
+    if (yang_flag_get(ys, YANG_FLAG_MAND_CACHE))
+        return yang_flag_get(ys, YANG_FLAG_MAND_VALUE)?1:0;
     /* Create dummy xs if not exist */
     if ((xs = xml_new(yang_argument_get(ys), xt, CX_ELMNT)) == NULL)
         goto done;
     xml_spec_set(xs, ys);
     if (yang_check_when_xpath(xs, xt, ys, &hit, &nr, NULL) < 0)
         goto done;
-    if (hit && !nr){
-        retval = 0;
-        goto done;
+    if (hit){
+        dynamic = 1; /* when-conditional: instance-dependent, do not cache */
+        if (!nr){
+            retval = 0;
+            goto done;
+        }
     }
     keyw = yang_keyword_get(ys);
     if (keyw == Y_LEAF || keyw == Y_CHOICE || keyw == Y_ANYDATA || keyw == Y_ANYXML){
         if ((ym = yang_find(ys, Y_MANDATORY, NULL)) != NULL){
             if ((cv = yang_cv_get(ym)) != NULL){ /* shouldnt happen */
-                retval = cv_bool_get(cv);
-                goto done;
+                if (cv_bool_get(cv))
+                    goto mandatory;
+                goto nomandatory;
             }
         }
     }
     /* 3) A container node without a "presence" statement and that has at
      *    least one mandatory node as a child. */
-    else if (keyw == Y_CONTAINER && 
+    else if (keyw == Y_CONTAINER &&
              yang_find(ys, Y_PRESENCE, NULL) == NULL){
         yc = NULL;
         while ((yc = yn_each(ys, yc)) != NULL) {
             if ((ret = yang_xml_mandatory(xs, yc)) < 0)
                 goto done;
+            if (yang_flag_get(yc, YANG_FLAG_MAND_CACHE) == 0)
+                dynamic = 1;
             if (ret == 1)
                 goto mandatory;
         }
     }
+ nomandatory:
     retval = 0; /* Does not contain mandatory node */
+    goto cache;
+ mandatory:
+    retval = 1;
+ cache:
+    if (!dynamic){
+        yang_flag_reset(ys, YANG_FLAG_MAND_VALUE);
+        if (retval == 1)
+            yang_flag_set(ys, YANG_FLAG_MAND_VALUE);
+        yang_flag_set(ys, YANG_FLAG_MAND_CACHE);
+    }
  done:
     if (xs != NULL)
         xml_purge(xs);
     return retval;
- mandatory:
-    retval = 1;
-    goto done;
 }
 
 /*! Is XML node (ie under <rpc>) an action, ie name action and belong to YANG_XML_NAMESPACE?
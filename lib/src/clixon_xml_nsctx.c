@@ -530,35 +530,97 @@ xml2ns(cxobj *x,
     return retval;
 }
 
-/*! Recursively check prefix / namespaces (and populate ns cache)
- * @retval     1          OK
- * @retval     0          (Some) prefix not found
- * @retval    -1          Error
+/*! Recursion of xml2ns_recurse carrying an explicit namespace-context stack
+ *
+ * nsc holds all prefix:namespace bindings in scope at xt, so resolving a
+ * child prefix is a lookup in nsc instead of an ancestor walk per node.
+ * The context is duplicated (pushed) only where a node carries its own
+ * xmlns declarations, which in practice is the top of the tree.
+ * @param[in]  xt   XML parent
+ * @param[in]  nsc  Namespace context in scope at xt
+ * @retval     0    OK
+ * @retval    -1    Error
  */
-int
-xml2ns_recurse(cxobj *xt)
+static int
+xml2ns_recurse1(cxobj *xt,
+                cvec  *nsc)
 {
     int    retval = -1;
     cxobj *x;
+    cxobj *xa;
+    cvec  *nsc1 = NULL; /* extended context, only if x declares namespaces */
     char  *prefix;
     char  *namespace;
 
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        /* Push: extend context if x has xmlns declarations of its own */
+        xa = NULL;
+        while ((xa = xml_child_each(x, xa, CX_ATTR)) != NULL){
+            prefix = xml_prefix(xa);
+            if ((prefix == NULL && strcmp(xml_name(xa), "xmlns") == 0) ||
+                (prefix != NULL && strcmp(prefix, "xmlns") == 0)){
+                if (nsc1 == NULL &&
+                    (nsc1 = cvec_dup(nsc)) == NULL){
+                    clicon_err(OE_XML, errno, "cvec_dup");
+                    goto done;
+                }
+                if (xml_nsctx_add(nsc1,
+                                  prefix?xml_name(xa):NULL,
+                                  xml_value(xa)) < 0)
+                    goto done;
+            }
+        }
         if ((prefix = xml_prefix(x)) != NULL){
-            namespace = NULL;
-            if (xml2ns(x, prefix, &namespace) < 0)
-                goto done;
-            if (namespace == NULL){
+            if ((namespace = xml_nsctx_get(nsc1?nsc1:nsc, prefix)) == NULL){
                 clicon_err(OE_XML, ENOENT, "No namespace associated with %s:%s", prefix, xml_name(x));
                 goto done;
-            }       
+            }
+            /* Populate the per-node cache as xml2ns would, used by later
+             * lookups outside this walk */
+            if (xml_child_nr(x) > 1 &&
+                nscache_set(x, prefix, namespace) < 0)
+                goto done;
         }
-        if (xml2ns_recurse(x) < 0)
+        if (xml2ns_recurse1(x, nsc1?nsc1:nsc) < 0)
             goto done;
+        if (nsc1){
+            xml_nsctx_free(nsc1);
+            nsc1 = NULL;
+        }
     }
     retval = 0;
  done:
+    if (nsc1)
+        xml_nsctx_free(nsc1);
+    return retval;
+}
+
+/*! Recursively check prefix / namespaces (and populate ns cache)
+ *
+ * The bindings in scope are carried in a namespace-context stack during the
+ * walk, so each prefixed node costs one context lookup. The previous variant
+ * resolved via xml2ns ancestor walks, which was quadratic on deep trees
+ * whose nodes lack a populated nscache (leaves never cache).
+ * @param[in]  xt   XML parent, its element children are checked
+ * @retval     0    OK
+ * @retval    -1    Error, some prefix not found, clicon_err called
+ */
+int
+xml2ns_recurse(cxobj *xt)
+{
+    int   retval = -1;
+    cvec *nsc = NULL;
+
+    /* Bindings in scope at xt: xt's own declarations and ancestors */
+    if (xml_nsctx_node(xt, &nsc) < 0)
+        goto done;
+    if (xml2ns_recurse1(xt, nsc) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
     return retval;
 }
 
@@ -55,6 +55,9 @@ struct clixon_xml_parse_yacc {
     int         xy_lex_state;    /* lex return state */
     cxobj     **xy_xvec;         /* Vector of created top-level nodes (to know which are created) */
     int         xy_xlen;         /* Length of xy_xvec */
+    int       (*xy_stream_cb)(cxobj *x, void *arg); /* If set, streaming parse: called for each
+                                    completed element, see clixon_xml_stream_cb */
+    void       *xy_stream_arg;   /* Streaming callback argument */
 };
 typedef struct clixon_xml_parse_yacc clixon_xml_yacc;
 
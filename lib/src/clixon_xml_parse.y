@@ -274,6 +274,34 @@ xml_parse_endslash_post(clixon_xml_yacc *xy)
     return 0;
 }
 
+/*! Emit a completed element to the streaming callback, if one is registered
+ *
+ * Used by the streaming (SAX-like) parse mode: the callback sees each element
+ * once all its attributes, bodies and (non-pruned) children are in place, and
+ * may return 1 to have the element pruned from the tree so that arbitrarily
+ * large documents can be processed in bounded tree memory.
+ * @param[in] xy  XML parser yacc handler struct
+ * @param[in] x   Completed element
+ * @retval    0   OK
+ * @retval   -1   Error (callback error is propagated as parse error)
+ */
+static int
+xml_parse_stream_emit(clixon_xml_yacc *xy,
+                      cxobj           *x)
+{
+    int ret;
+
+    if (xy->xy_stream_cb == NULL || x == NULL)
+        return 0;
+    if ((ret = xy->xy_stream_cb(x, xy->xy_stream_arg)) < 0)
+        return -1;
+    /* Top-level elements stay: they are tracked in xy_xvec */
+    if (ret == 1 && xml_parent(x) != xy->xy_xtop)
+        if (xml_purge(x) < 0)
+            return -1;
+    return 0;
+}
+
 /*! A content terminated by <name>...</name> or <prefix:name>...</prefix:name> is ready
  *
  * Any whitespace between the subelements to a non-leaf is
@@ -320,6 +348,8 @@ xml_parse_bslash(clixon_xml_yacc *xy,
         if (xml_rm_children(x, CX_BODY) < 0) /* remove all bodies */
             goto done;
     }
+    if (xml_parse_stream_emit(xy, x) < 0)
+        goto done;
     retval = 0;
   done:
     if (prefix)
@@ -426,7 +456,8 @@ qname       : NAME           { if (xml_parse_prefixed_name(_XY, NULL, $1) < 0) Y
                                 _PARSE_DEBUG("qname -> NAME : NAME");}
             ;
 
-element1    :  ESLASH         {_XY->xy_xelement = NULL; 
+element1    :  ESLASH         { if (xml_parse_stream_emit(_XY, _XY->xy_xelement) < 0) YYABORT;
+                               _XY->xy_xelement = NULL; 
                                _PARSE_DEBUG("element1 -> />");} 
             | '>'             { xml_parse_endslash_pre(_XY); }
               elist           { xml_parse_endslash_mid(_XY); }
@@ -270,11 +270,11 @@ xml_cmp(cxobj  *x1,
      * existing list.
      */
     if (same &&
-        (
+        (yang_ordered_by_user(y1)
 #ifndef STATE_ORDERED_BY_SYSTEM
-         yang_config(y1)==0 ||
+         || yang_config(y1)==0
 #endif
-         yang_find(y1, Y_ORDERED_BY, "user") != NULL)){
+         )){
             equal = nr1-nr2;
             goto done; /* Ordered by user or state data : maintain existing order */
         }
@@ -419,6 +419,47 @@ xml_sort(cxobj *x)
 #endif
     xml_enumerate_children(x); /* This is to make sorting "stable", ie not change existing order */
     qsort(xml_childvec_get(x), xml_child_nr(x), sizeof(cxobj *), xml_cmp_qsort);
+    xml_find_index_invalidate(x); /* child order changed: first-match index is stale */
+    return 0;
+}
+
+/* Deferred sorting for bulk tree construction: while >0, xml_insert appends
+ * INS_LAST children unsorted and relies on one qsort pass per parent at
+ * the end (classic build-then-sort) instead of per-insert binary search plus
+ * vector shifting. Covers ordered-by user lists as well since the final sort
+ * keeps arrival order among same-spec user-ordered entries.
+ * @see xml_sort_defer_begin
+ */
+static int _xml_sort_defer = 0;
+
+/*! Enter deferred (bulk-load) sorting mode
+ *
+ * Subsequent xml_insert() calls with INS_LAST append children last instead
+ * of inserting in sorted position. May be nested.
+ * @retval     0    OK
+ * @see xml_sort_defer_end  Which restores sorted order
+ */
+int
+xml_sort_defer_begin(void)
+{
+    _xml_sort_defer++;
+    return 0;
+}
+
+/*! Leave deferred sorting mode and restore sort order of tree xt
+ * @param[in]  xt   Tree to sort recursively, or NULL to just leave the mode
+ *                  (eg on error cleanup when the tree is discarded)
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_sort_defer_begin
+ */
+int
+xml_sort_defer_end(cxobj *xt)
+{
+    if (_xml_sort_defer > 0)
+        _xml_sort_defer--;
+    if (_xml_sort_defer == 0 && xt != NULL)
+        return xml_sort_recurse(xt);
     return 0;
 }
 
@@ -845,7 +886,7 @@ xml_search_yang(cxobj       *xp,
     else
 #endif
         if (yang_keyword_get(yc) == Y_LIST || yang_keyword_get(yc) == Y_LEAF_LIST)
-            sorted = (yang_find(yc, Y_ORDERED_BY, "user") == NULL);
+            sorted = !yang_ordered_by_user(yc);
     if ((yangi = yang_order(yc)) < -1)
         goto done;
     if (xml_search_binary(xp, x1, sorted, yangi, low, upper, skip1, indexvar, xvec) < 0)
@@ -1093,7 +1134,21 @@ xml_insert(cxobj           *xp,
     else
 #endif
         if (yang_keyword_get(y) == Y_LIST || yang_keyword_get(y) == Y_LEAF_LIST)
-            userorder = (yang_find(y, Y_ORDERED_BY, "user") != NULL);
+            userorder = yang_ordered_by_user(y);
+    if (_xml_sort_defer && ins == INS_LAST){
+        /* Bulk-load mode: append now, one sort pass in xml_sort_defer_end.
+         * Also safe for ordered-by user: xml_cmp breaks ties between
+         * same-spec user-ordered entries on current enumeration, so the
+         * final qsort pass moves appended entries to their yang-order slot
+         * while keeping arrival order among them, which is INS_LAST.
+         * Explicit yang:insert first/before/after still position per entry
+         */
+        if (xml_child_append(xp, xi) < 0)
+            goto done;
+        xml_parent_set(xi, xp);
+        retval = 0;
+        goto done;
+    }
     if ((yi = yang_order(y)) < -1)
         goto done;
     if ((i = xml_insert2(xp, xi, y, yi,
@@ -1150,6 +1205,83 @@ xml_sort_verify(cxobj *x0,
     return retval;
 }
 
+/*! Threshold: number of children where a composite-key index pays off for list matching */
+#define XML_KEY_INDEX_THRESHOLD 64
+
+/*! Pack list name and key leaf values of xc into a composite-key string
+ *
+ * Key values are length-prefixed so that the packed form is unambiguous
+ * regardless of value contents.
+ * @param[out] cb   Packed key appended here
+ * @param[in]  xc   List entry whose key leafs are read
+ * @param[in]  name List name
+ * @param[in]  cvk  Vector of key names, see yang_cvec_get
+ * @retval     1    OK, all keys present and packed
+ * @retval     0    Some key leaf missing in xc
+ */
+static int
+xml_key_index_pack(cbuf  *cb,
+                   cxobj *xc,
+                   char  *name,
+                   cvec  *cvk)
+{
+    cg_var *cvi;
+    cxobj  *xb;
+    char   *body;
+
+    cprintf(cb, "%s", name);
+    cvi = NULL;
+    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
+        if ((xb = xml_find(xc, cv_string_get(cvi))) == NULL)
+            return 0;
+        if ((body = xml_body(xb)) == NULL)
+            body = "";
+        cprintf(cb, "[%zu]%s", strlen(body), body);
+    }
+    return 1;
+}
+
+/*! Build composite-key index over keyed list children of x0
+ *
+ * One pass over the children; thereafter lookups of list entries by key are
+ * O(1) instead of one binary search with per-probe key comparisons each.
+ * The index is dropped on any child mutation, see xml_find_index_invalidate.
+ * @param[in]  x0   Base tree parent
+ * @param[in]  name List name
+ * @param[in]  cvk  Vector of key names
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_key_index_build(cxobj *x0,
+                    char  *name,
+                    cvec  *cvk)
+{
+    int    retval = -1;
+    cxobj *xc;
+    cbuf  *cb = NULL;
+
+    if ((cb = cbuf_pool_get()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_pool_get");
+        goto done;
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(x0, xc, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xc), name) != 0)
+            continue;
+        cbuf_reset(cb);
+        if (xml_key_index_pack(cb, xc, name, cvk) == 0)
+            continue; /* malformed entry wo keys: leave to linear/binary path */
+        if (xml_key_index_set(x0, cbuf_get(cb), xc) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_pool_put(cb);
+    return retval;
+}
+
 /*! Given child tree x1c, find (first) matching child in base tree x0 and return as x0cp
  * @param[in]  x0      Base tree node
  * @param[in]  x1c     Modification tree child
@@ -1172,7 +1304,9 @@ match_base_child(cxobj      *x0,
     cxobj       *xb;
     char        *keyname;
     clixon_xvec *xvec = NULL;
-    
+    cbuf        *cb = NULL;
+    cxobj       *xm;
+
     *x0cp = NULL; /* init return value */
     /* Revert to simple xml lookup if no yang */
     if (yc == NULL){ 
@@ -1195,6 +1329,30 @@ match_base_child(cxobj      *x0,
             if ((xb = xml_find(x1c, keyname)) == NULL)
                 goto ok;
         }
+        /* Large lists: one composite-key hash lookup instead of a binary
+         * search where every probe re-reads the key leafs via xml_find */
+        if (cvec_len(cvk) > 0 &&
+            xml_child_nr_type(x0, CX_ELMNT) >= XML_KEY_INDEX_THRESHOLD){
+            if ((cb = cbuf_pool_get()) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_pool_get");
+                goto done;
+            }
+            /* Per-list-name marker: "=<name>" cannot collide with packed keys
+             * since XML names cannot start with '='. Needed since two keyed
+             * lists may share a parent but are indexed one name at a time. */
+            cprintf(cb, "=%s", xml_name(x1c));
+            if (xml_key_index_get(x0, cbuf_get(cb), &xm) == 0 || xm == NULL){
+                if (xml_key_index_build(x0, xml_name(x1c), cvk) < 0)
+                    goto done;
+                if (xml_key_index_set(x0, cbuf_get(cb), x0) < 0)
+                    goto done;
+            }
+            cbuf_reset(cb);
+            if (xml_key_index_pack(cb, x1c, xml_name(x1c), cvk) == 0)
+                goto ok; /* cannot happen: keys checked present above */
+            if (xml_key_index_get(x0, cbuf_get(cb), x0cp) == 1)
+                goto ok; /* authoritative: miss means no such entry */
+        }
     default:
         break;
     }
@@ -1208,6 +1366,8 @@ match_base_child(cxobj      *x0,
  ok:
     retval = 0;
  done:
+    if (cb)
+        cbuf_pool_put(cb);
     if (xvec)
         clixon_xvec_free(xvec);
     return retval;
@@ -71,13 +71,21 @@
 #define XVEC_MAX_DEFAULT 4      /* start value */
 #define XVEC_MAX_THRESHOLD 1024 /* exponential growth to here, then linear */
 
+/* Number of object slots stored inline in the xvec struct itself. Most vectors
+ * (xpath nodeset results, key vectors) hold only a handful of entries and then
+ * never touch malloc for the element array.
+ */
+#define XVEC_INLINE_SIZE 4
+
 /*! Clixon xml vector concrete implementaion of the abstract clixon_xvec type
  * Contiguous vector (not linked list) so that binary search can be done by direct index access
  */
 struct clixon_xml_vec {
     cxobj **xv_vec;   /* Sorted vector of xml object pointers */
     int     xv_len;   /* Length of vector */
-    int     xv_max;   /* Vector allocation */    
+    int     xv_max;   /* Vector allocation */
+    cxobj  *xv_inline[XVEC_INLINE_SIZE]; /* Small-vector storage, xv_vec points
+                                            here until it outgrows it */
 };
 
 /*! Increment cxobj vector in an XML object vector 
@@ -100,7 +108,15 @@ clixon_xvec_inc(clixon_xvec *xv)
             xv->xv_max *= 2;                  /* Double the space - exponential */
         else
             xv->xv_max += XVEC_MAX_THRESHOLD; /* Add - linear growth */
-        if ((xv->xv_vec = realloc(xv->xv_vec, sizeof(cxobj *) * xv->xv_max)) == NULL){
+        if (xv->xv_vec == xv->xv_inline){
+            /* Spill inline storage to heap */
+            if ((xv->xv_vec = malloc(sizeof(cxobj *) * xv->xv_max)) == NULL){
+                clicon_err(OE_XML, errno, "malloc");
+                goto done;
+            }
+            memcpy(xv->xv_vec, xv->xv_inline, sizeof(cxobj *) * (xv->xv_len-1));
+        }
+        else if ((xv->xv_vec = realloc(xv->xv_vec, sizeof(cxobj *) * xv->xv_max)) == NULL){
             clicon_err(OE_XML, errno, "realloc");
             goto done;
         }
@@ -128,7 +144,8 @@ clixon_xvec_new(void)
     }
     memset(xv, 0, sizeof(*xv));
     xv->xv_len = 0;
-    xv->xv_max = 0;
+    xv->xv_max = XVEC_INLINE_SIZE;
+    xv->xv_vec = xv->xv_inline;
 
  done:
     return xv;
@@ -148,15 +165,19 @@ clixon_xvec_dup(clixon_xvec *xv0)
     if ((xv1 = clixon_xvec_new()) == NULL)
         goto done;
     *xv1 = *xv0;
-    xv1->xv_vec = NULL;
-    if (xv1->xv_max &&
-        (xv1->xv_vec = calloc(xv1->xv_max, sizeof(cxobj*))) == NULL){
-        clicon_err(OE_UNIX, errno, "calloc");
-        free(xv1);
-        xv1 = NULL;
-        goto done;
+    if (xv0->xv_vec == xv0->xv_inline)
+        xv1->xv_vec = xv1->xv_inline;
+    else {
+        xv1->xv_vec = NULL;
+        if (xv1->xv_max &&
+            (xv1->xv_vec = calloc(xv1->xv_max, sizeof(cxobj*))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            free(xv1);
+            xv1 = NULL;
+            goto done;
+        }
+        memcpy(xv1->xv_vec, xv0->xv_vec, xv0->xv_len*sizeof(cxobj*));
     }
-    memcpy(xv1->xv_vec, xv0->xv_vec, xv0->xv_len*sizeof(cxobj*));
  done:
     return xv1;
 }
@@ -166,7 +187,7 @@ clixon_xvec_dup(clixon_xvec *xv0)
 int
 clixon_xvec_free(clixon_xvec *xv)
 {
-    if (xv->xv_vec)
+    if (xv->xv_vec && xv->xv_vec != xv->xv_inline)
         free(xv->xv_vec);
     if (xv)
         free(xv);
@@ -220,7 +241,16 @@ clixon_xvec_extract(clixon_xvec *xv,
         clicon_err(OE_XML, EINVAL, "xv is NULL");
         goto done;
     }
-    *xvec = xv->xv_vec;
+    if (xv->xv_vec == xv->xv_inline){
+        /* Inline storage cannot outlive the xvec: hand out a heap copy */
+        if ((*xvec = malloc(sizeof(cxobj *) * xv->xv_max)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        memcpy(*xvec, xv->xv_inline, sizeof(cxobj *) * xv->xv_len);
+    }
+    else
+        *xvec = xv->xv_vec;
     *xlen = xv->xv_len;
     if (xmax)
         *xmax = xv->xv_max;
@@ -83,6 +83,7 @@
 /* clicon */
 #include "clixon_err.h"
 #include "clixon_log.h"
+#include "clixon_trace.h"
 #include "clixon_string.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
@@ -95,6 +96,7 @@
 #include "clixon_xpath.h"
 #include "clixon_xpath_parse.h"
 #include "clixon_xpath_eval.h"
+#include "clixon_xpath_optimize.h"
 
 /*
  * Variables
@@ -560,6 +562,9 @@ xpath_parse(const char  *xpath,
     }
     xpath_parse_exit(&xpy);
     xpath_scan_exit(&xpy);
+    /* One-time compile passes on the tree, see xpath_optimize_predicates */
+    if (xpath_optimize_predicates(xpy.xpy_top) < 0)
+        goto done;
     if (xptree){
         *xptree = xpy.xpy_top;
         xpy.xpy_top = NULL;
@@ -573,7 +578,123 @@ xpath_parse(const char  *xpath,
     return retval;
 }
 
-/*! Given XML tree and xpath, parse xpath, eval it and return xpath context, 
+/*
+ * Compiled-XPath cache
+ * The same xpath expressions (when/must conditions, NACM paths, RESTCONF
+ * queries) are evaluated over and over, and each evaluation re-runs the yacc
+ * parser. Cache the parsed trees keyed by expression string with LRU
+ * eviction. The parse is independent of the namespace context: prefixes are
+ * resolved at eval time, so the string alone is a sufficient key. The trees
+ * are shared read-only: xp_eval does not modify them. Entries are pinned
+ * while an evaluation uses them so that a nested evaluation cannot evict the
+ * tree of an outer one.
+ */
+#define XPATH_CACHE_NR 64
+
+struct xpath_cache_ent{
+    char       *xe_str;   /* xpath expression string (copy), NULL if free slot */
+    xpath_tree *xe_tree;  /* parsed tree, shared read-only */
+    uint64_t    xe_tick;  /* last use, for LRU eviction */
+    int         xe_inuse; /* nr of ongoing evaluations, do not evict if > 0 */
+};
+static struct xpath_cache_ent _xpath_cache[XPATH_CACHE_NR] = {{0,},};
+static uint64_t _xpath_cache_tick = 0;
+
+/*! Parse an xpath via the compiled-xpath cache
+ *
+ * @param[in]  xpath  String with XPATH 1.0 syntax
+ * @param[out] xtp    Parsed xpath tree
+ * @param[out] xep    Cache entry if *xtp is shared, NULL if caller owns *xtp
+ * @retval     0      OK
+ * @retval    -1      Error
+ * On a hit the cached tree is returned pinned and *xep is set: the caller
+ * must release it with xpath_cache_put and must not free the tree. On a miss
+ * the expression is parsed and inserted, evicting the least recently used
+ * unpinned entry. If every entry is pinned (pathological nesting) the tree
+ * is not inserted, *xep is NULL and the caller owns it as with xpath_parse.
+ */
+static int
+xpath_cache_get(const char              *xpath,
+                xpath_tree             **xtp,
+                struct xpath_cache_ent **xep)
+{
+    int                     retval = -1;
+    struct xpath_cache_ent *xe;
+    xpath_tree             *xt = NULL;
+    char                   *str = NULL;
+    int                     victim = -1;
+    int                     i;
+
+    *xep = NULL;
+    for (i=0; i<XPATH_CACHE_NR; i++){
+        xe = &_xpath_cache[i];
+        if (xe->xe_str == NULL){
+            if (victim < 0)
+                victim = i;
+            continue;
+        }
+        if (strcmp(xe->xe_str, xpath) == 0){
+            xe->xe_tick = ++_xpath_cache_tick;
+            xe->xe_inuse++;
+            *xtp = xe->xe_tree;
+            *xep = xe;
+            retval = 0;
+            goto done;
+        }
+        if (xe->xe_inuse > 0)
+            continue;
+        if (victim < 0 ||
+            (_xpath_cache[victim].xe_str != NULL &&
+             xe->xe_tick < _xpath_cache[victim].xe_tick))
+            victim = i;
+    }
+    if (xpath_parse(xpath, &xt) < 0)
+        goto done;
+    if (victim < 0){ /* all entries pinned: hand the tree to the caller */
+        *xtp = xt;
+        xt = NULL;
+        retval = 0;
+        goto done;
+    }
+    if ((str = strdup(xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    xe = &_xpath_cache[victim];
+    if (xe->xe_str){
+        free(xe->xe_str);
+        xpath_tree_free(xe->xe_tree);
+    }
+    xe->xe_str = str;
+    str = NULL;
+    xe->xe_tree = xt;
+    xe->xe_tick = ++_xpath_cache_tick;
+    xe->xe_inuse = 1;
+    *xtp = xt;
+    xt = NULL;
+    *xep = xe;
+    retval = 0;
+ done:
+    if (str)
+        free(str);
+    if (xt)
+        xpath_tree_free(xt);
+    return retval;
+}
+
+/*! Release a pinned compiled-xpath cache entry
+ * @param[in]  xe  Cache entry from xpath_cache_get, or NULL
+ * @see xpath_cache_get
+ */
+static int
+xpath_cache_put(struct xpath_cache_ent *xe)
+{
+    if (xe)
+        xe->xe_inuse--;
+    return 0;
+}
+
+/*! Given XML tree and xpath, parse xpath, eval it and return xpath context,
  * This is a raw form of xpath where you can do type conversion of the return
  * value, etc, not just a nodeset.
  * @param[in]  xcur   XML-tree where to search
@@ -598,12 +719,13 @@ xpath_vec_ctx(cxobj      *xcur,
               int         localonly,
               xp_ctx    **xrp)
 {
-    int         retval = -1;
-    xpath_tree *xptree = NULL;
-    xp_ctx      xc = {0,};
-    
+    int                     retval = -1;
+    xpath_tree             *xptree = NULL;
+    struct xpath_cache_ent *xe = NULL;
+    xp_ctx                  xc = {0,};
+
     clicon_debug(2, "%s", __FUNCTION__);
-    if (xpath_parse(xpath, &xptree) < 0)
+    if (xpath_cache_get(xpath, &xptree, &xe) < 0)
         goto done;
     xc.xc_type = XT_NODESET;
     xc.xc_node = xcur;
@@ -618,7 +740,9 @@ xpath_vec_ctx(cxobj      *xcur,
         free(xc.xc_nodeset);
         xc.xc_nodeset = NULL;
     }
-    if (xptree)
+    if (xe)
+        xpath_cache_put(xe);
+    else if (xptree)
         xpath_tree_free(xptree);
     return retval;
 }
@@ -804,6 +928,7 @@ xpath_vec(cxobj      *xcur,
         xr->xc_nodeset = NULL;
         *veclen = xr->xc_size;
     }
+    CLIXON_PROBE2(xpath_vec, xpath, *veclen);
     retval = 0;
  done:
     if (xr)
@@ -941,6 +1066,47 @@ xpath_vec_bool(cxobj      *xcur,
     return retval;
 }
 
+/*! Given XML tree and a pre-compiled xpath tree, returns boolean
+ *
+ * Same as xpath_vec_bool but evaluates an already parsed xpath, skipping the
+ * per-call parse step. Used for when/must conditions where the xpath is compiled
+ * once at yang load time, see yang_xptree_get.
+ * @param[in]  xcur     xml-tree where to search
+ * @param[in]  nsc      External XML namespace context, or NULL
+ * @param[in]  xptree   Compiled xpath parse tree, see xpath_parse
+ * @retval     1        True
+ * @retval     0        False
+ * @retval    -1        Error
+ * @see xpath_vec_bool
+ */
+int
+xpath_tree_bool(cxobj      *xcur,
+                cvec       *nsc,
+                xpath_tree *xptree)
+{
+    int     retval = -1;
+    xp_ctx  xc = {0,};
+    xp_ctx *xr = NULL;
+
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xcur;
+    xc.xc_initial = xcur;
+    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xptree, nsc, 0, &xr) < 0)
+        goto done;
+    if (xr)
+        retval = ctx2boolean(xr);
+ done:
+    if (xc.xc_nodeset){
+        free(xc.xc_nodeset);
+        xc.xc_nodeset = NULL;
+    }
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
+
 /*! Translate an xpath/nsc pair to a "canonical" form using yang prefixes
  *
  * @param[in]  xs      Parsed xpath - xpath_tree
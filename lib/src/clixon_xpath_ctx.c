@@ -74,37 +74,123 @@ const map_str2int ctxmap[] = {
     {NULL,        -1}
 };
 
+/* Free-list of xpath contexts, recycled with their nodeset buffers
+ * An xpath evaluation allocates and frees a context per step in the parse
+ * tree; recycling the contexts (and their scratch nodeset buffers, see
+ * ctx_nodeset_append) keeps the inner evaluation loop off malloc.
+ */
+#define CTX_POOL_NR 128
+static xp_ctx *_ctx_pool[CTX_POOL_NR];
+static int     _ctx_pool_nr = 0;
+
+/*! Allocate a new zeroed xpath context
+ *
+ * Taken from the free-list if possible, in which case the nodeset buffer of
+ * the recycled context is kept as scratch (xc_alloc set, xc_size zero).
+ * @retval  xc    XPATH context
+ * @retval  NULL  Error
+ * @see ctx_free
+ */
+xp_ctx *
+ctx_new(void)
+{
+    xp_ctx *xc;
+    cxobj **nodeset;
+    int     alloc;
+
+    if (_ctx_pool_nr > 0){
+        xc = _ctx_pool[--_ctx_pool_nr];
+        nodeset = xc->xc_nodeset;
+        alloc = xc->xc_alloc;
+        memset(xc, 0, sizeof(*xc));
+        xc->xc_nodeset = nodeset;
+        xc->xc_alloc = alloc;
+        return xc;
+    }
+    if ((xc = malloc(sizeof(*xc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(xc, 0, sizeof(*xc));
+    return xc;
+}
+
 /*! Free xpath context */
 int
 ctx_free(xp_ctx *xc)
 {
-    if (xc->xc_nodeset)
-        free(xc->xc_nodeset);
     if (xc->xc_string)
         free(xc->xc_string);
+    if (_ctx_pool_nr < CTX_POOL_NR){
+        xc->xc_string = NULL;
+        xc->xc_size = 0;
+        if (xc->xc_nodeset == NULL) /* nodeset may have been handed over to a caller */
+            xc->xc_alloc = 0;
+        _ctx_pool[_ctx_pool_nr++] = xc;
+        return 0;
+    }
+    if (xc->xc_nodeset)
+        free(xc->xc_nodeset);
     free(xc);
     return 0;
 }
 
+/*! Append a node to the nodeset of an XPATH context with amortized growth
+ *
+ * Unlike cxvec_append which reallocs per element, the buffer is grown
+ * geometrically using xc_alloc, so building a large nodeset is linear.
+ * @param[in]  xc  XPATH context
+ * @param[in]  x   XML node to append to nodeset
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+ctx_nodeset_append(xp_ctx *xc,
+                   cxobj  *x)
+{
+    cxobj **vec;
+    int     alloc;
+
+    if (xc->xc_size >= xc->xc_alloc){
+        alloc = xc->xc_alloc ? 2*xc->xc_alloc : 64;
+        if (alloc < xc->xc_size + 1)
+            alloc = xc->xc_size + 1;
+        if ((vec = realloc(xc->xc_nodeset, alloc*sizeof(cxobj*))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        xc->xc_nodeset = vec;
+        xc->xc_alloc = alloc;
+    }
+    xc->xc_nodeset[xc->xc_size++] = x;
+    return 0;
+}
+
 /*! Duplicate xpath context */
 xp_ctx *
 ctx_dup(xp_ctx *xc0)
 {
     xp_ctx *xc = NULL;
-    
-    if ((xc = malloc(sizeof(*xc))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    cxobj **nodeset;
+    int     alloc;
+
+    if ((xc = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xc, 0, sizeof(*xc));
+    nodeset = xc->xc_nodeset; /* keep recycled scratch buffer, see ctx_new */
+    alloc = xc->xc_alloc;
     *xc = *xc0;
-    if (xc0->xc_size){
-        if ((xc->xc_nodeset = calloc(xc0->xc_size, sizeof(cxobj*))) == NULL){
-            clicon_err(OE_UNIX, errno, "calloc");
+    xc->xc_string = NULL;
+    if (xc0->xc_size > alloc){
+        if ((nodeset = realloc(nodeset, xc0->xc_size*sizeof(cxobj*))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
             goto done;
         }
-        memcpy(xc->xc_nodeset, xc0->xc_nodeset, xc->xc_size*sizeof(cxobj*));
+        alloc = xc0->xc_size;
     }
+    xc->xc_nodeset = nodeset;
+    xc->xc_alloc = alloc;
+    if (xc0->xc_size)
+        memcpy(xc->xc_nodeset, xc0->xc_nodeset, xc0->xc_size*sizeof(cxobj*));
     if (xc0->xc_string)
         if ((xc->xc_string = strdup(xc0->xc_string)) == NULL){
             clicon_err(OE_UNIX, errno, "strdup");
@@ -321,6 +407,7 @@ ctx_nodeset_replace(xp_ctx   *xc,
         free(xc->xc_nodeset);
     xc->xc_nodeset = vec;
     xc->xc_size = veclen;
+    xc->xc_alloc = veclen;
     return 0;
 }
 
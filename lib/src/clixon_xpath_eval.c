@@ -83,6 +83,7 @@
 #include "clixon_yang.h"
 #include "clixon_yang_type.h"
 #include "clixon_xml.h"
+#include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
 #include "clixon_xml_nsctx.h"
 #include "clixon_xpath_ctx.h"
@@ -293,6 +294,51 @@ nodetest_recursive(cxobj      *xn,
     return retval;
 }
 
+/*! Descendant step via the per-root element-name index, if applicable
+ *
+ * @param[in]  xn        XML node to search descendants of
+ * @param[in]  nodetest  XPATH nodetest
+ * @param[in]  nsc       XML Namespace context
+ * @param[in]  localonly Skip prefix and namespace tests (non-standard)
+ * @param[out] vec0      Array of found nodes
+ * @param[out] vec0len   Len of vec0
+ * @retval     1         Index used, results appended to vec0
+ * @retval     0         No index, use nodetest_recursive
+ * @retval    -1         Error
+ * Only simple named nodetests on a tree root qualify, see xml_didx_get. The
+ * index is name-only, so the full nodetest (prefix/namespace) is re-evaluated
+ * on the name matches; document order is preserved.
+ */
+static int
+nodetest_didx(cxobj      *xn,
+              xpath_tree *nodetest,
+              cvec       *nsc,
+              int         localonly,
+              cxobj    ***vec0,
+              int        *vec0len)
+{
+    clixon_xvec *xvec = NULL;
+    cxobj       *x;
+    int          ret;
+    int          i;
+
+    if (nodetest == NULL ||
+        nodetest->xs_type != XP_NODE ||
+        nodetest->xs_s1 == NULL)
+        return 0;
+    if ((ret = xml_didx_get(xn, nodetest->xs_s1, &xvec)) < 0)
+        return -1;
+    if (ret == 0)
+        return 0;
+    for (i=0; i<clixon_xvec_len(xvec); i++){
+        x = clixon_xvec_i(xvec, i);
+        if (nodetest_eval(x, nodetest, nsc, localonly) == 1)
+            if (cxvec_append(x, vec0, vec0len) < 0)
+                return -1;
+    }
+    return 1;
+}
+
 /*! Evaluate xpath step rule of an XML tree
  *
  * @param[in]  xc0  Incoming context
@@ -339,7 +385,10 @@ xp_eval_step(xp_ctx     *xc0,
         if (xc->xc_descendant){
             for (i=0; i<xc->xc_size; i++){
                 xv = xc->xc_nodeset[i];
-                if (nodetest_recursive(xv, nodetest, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
+                if ((ret = nodetest_didx(xv, nodetest, nsc, localonly, &vec, &veclen)) < 0)
+                    goto done;
+                if (ret == 0 &&
+                    nodetest_recursive(xv, nodetest, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                     goto done;
             }
             xc->xc_descendant = 0;
@@ -367,12 +416,15 @@ xp_eval_step(xp_ctx     *xc0,
     case A_DESCENDANT_OR_SELF:
         for (i=0; i<xc->xc_size; i++){
             xv = xc->xc_nodeset[i];
-            if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
+            if ((ret = nodetest_didx(xv, xs->xs_c0, nsc, localonly, &vec, &veclen)) < 0)
+                goto done;
+            if (ret == 0 &&
+                nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
         for (i=0; i<veclen; i++){
             x = vec[i];
-            if (cxvec_append(x, &xc->xc_nodeset, &xc->xc_size) < 0)
+            if (ctx_nodeset_append(xc, x) < 0)
                 goto done;
         }
         if (vec){
@@ -383,7 +435,10 @@ xp_eval_step(xp_ctx     *xc0,
     case A_DESCENDANT:
         for (i=0; i<xc->xc_size; i++){
             xv = xc->xc_nodeset[i];
-            if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
+            if ((ret = nodetest_didx(xv, xs->xs_c0, nsc, localonly, &vec, &veclen)) < 0)
+                goto done;
+            if (ret == 0 &&
+                nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
         ctx_nodeset_replace(xc, vec, veclen);
@@ -399,6 +454,7 @@ xp_eval_step(xp_ctx     *xc0,
         vec = xc->xc_nodeset;
         xc->xc_size = 0;
         xc->xc_nodeset = NULL;
+        xc->xc_alloc = 0;
         for (i=0; i<veclen; i++){
             x = vec[i];
             if ((xp = xml_parent(x)) != NULL
@@ -407,7 +463,7 @@ xp_eval_step(xp_ctx     *xc0,
                 || (xp = xml_parent_candidate(x)) != NULL
 #endif /* XML_PARENT_CANDIDATE */
                 )
-                if (cxvec_append(xp, &xc->xc_nodeset, &xc->xc_size) < 0)
+                if (ctx_nodeset_append(xc, xp) < 0)
                     goto done;
         }
         if (vec){
@@ -497,50 +553,47 @@ xp_eval_predicate(xp_ctx     *xc,
         /* Loop over each node in the nodeset 
          * XXX: alt to check xr0 is nodeset: set new var nodeset to NULL
          */
-        if ((xr1 = malloc(sizeof(*xr1))) == NULL){
-            clicon_err(OE_UNIX, errno, "malloc");
+        if ((xr1 = ctx_new()) == NULL)
             goto done;
-        }
-        memset(xr1, 0, sizeof(*xr1));
         xr1->xc_type = XT_NODESET;
         xr1->xc_node = xc->xc_node;
         xr1->xc_initial = xc->xc_initial;
+        /* One single-node context is reused over the whole nodeset: xp_eval
+         * does not modify its input context, so only the node, position and
+         * nodeset content need resetting per iteration */
+        if ((xcc = ctx_new()) == NULL)
+            goto done;
+        xcc->xc_type = XT_NODESET;
+        xcc->xc_initial = xc->xc_initial;
         for (i=0; i<xr0->xc_size; i++){
             x = xr0->xc_nodeset[i];
-            /* Create new context */
-            if ((xcc = malloc(sizeof(*xcc))) == NULL){
-                clicon_err(OE_XML, errno, "malloc");
-                goto done;
-            }
-            memset(xcc, 0, sizeof(*xcc));
-            xcc->xc_type = XT_NODESET;
-            xcc->xc_initial = xc->xc_initial;
             xcc->xc_node = x;
             xcc->xc_position = i;
+            xcc->xc_size = 0; /* keeps the allocated nodeset buffer */
             /* For each node in the node-set to be filtered, the PredicateExpr is
              * evaluated with that node as the context node */
-            if (cxvec_append(x, &xcc->xc_nodeset, &xcc->xc_size) < 0)
+            if (ctx_nodeset_append(xcc, x) < 0)
                 goto done;
             if (xp_eval(xcc, xs->xs_c1, nsc, localonly, &xrc) < 0)
                 goto done;
-            ctx_free(xcc);
-            xcc = NULL;
             if (xrc->xc_type == XT_NUMBER){
                 /* If the result is a number, the result will be converted to true
                    if the number is equal to the context position */
                 if ((int)xrc->xc_number == i)
-                    if (cxvec_append(x, &xr1->xc_nodeset, &xr1->xc_size) < 0)
+                    if (ctx_nodeset_append(xr1, x) < 0)
                         goto done;                  
             }
             else {
                 /* if PredicateExpr evaluates to true for that node, the node is 
                    included in the new node-set */
                 if (ctx2boolean(xrc))
-                    if (cxvec_append(x, &xr1->xc_nodeset, &xr1->xc_size) < 0)
+                    if (ctx_nodeset_append(xr1, x) < 0)
                         goto done;                  
             }
-            if (xrc)
+            if (xrc){
                 ctx_free(xrc);
+                xrc = NULL;
+            }
         }
     }
     if (xr0 == NULL && xr1 == NULL){
@@ -586,11 +639,8 @@ xp_logop(xp_ctx    *xc1,
     int     b1;
     int     b2;
     
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_initial = xc1->xc_initial;
     xr->xc_type = XT_BOOL;
     if ((b1 = ctx2boolean(xc1)) < 0)
@@ -636,11 +686,8 @@ xp_numop(xp_ctx    *xc1,
     double  n1;
     double  n2;
     
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_initial = xc1->xc_initial;
     xr->xc_type = XT_NUMBER;
     if (ctx2number(xc1, &n1) < 0)
@@ -747,8 +794,60 @@ xml_cv_cache(cxobj   *x,
     return retval;
 }
 
+/*! Convert a numeric cligen variable to double
+ *
+ * @param[in]  cv  Cligen variable
+ * @param[out] np  Numeric value of cv
+ * @retval     1   OK, cv is numeric, value in np
+ * @retval     0   cv is not of numeric type
+ * @see xml_cv_cache  which decodes the body string once per node
+ */
+static int
+cv2double(cg_var *cv,
+          double *np)
+{
+    int     i;
+    double  d;
+
+    switch (cv_type_get(cv)){
+    case CGV_INT8:
+        *np = cv_int8_get(cv);
+        break;
+    case CGV_INT16:
+        *np = cv_int16_get(cv);
+        break;
+    case CGV_INT32:
+        *np = cv_int32_get(cv);
+        break;
+    case CGV_INT64:
+        *np = cv_int64_get(cv);
+        break;
+    case CGV_UINT8:
+        *np = cv_uint8_get(cv);
+        break;
+    case CGV_UINT16:
+        *np = cv_uint16_get(cv);
+        break;
+    case CGV_UINT32:
+        *np = cv_uint32_get(cv);
+        break;
+    case CGV_UINT64:
+        *np = cv_uint64_get(cv);
+        break;
+    case CGV_DEC64:
+        d = (double)cv_int64_get(cv);
+        for (i = 0; i < cv_dec64_n_get(cv); i++)
+            d /= 10.0;
+        *np = d;
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+
 /*! Given two XPATH contexts, eval relational operations: <>=
- * A RelationalExpr is evaluated by comparing the objects that result from 
+ * A RelationalExpr is evaluated by comparing the objects that result from
  * evaluating the two operands.
  * This is covered:
  * (a) Both are INTs, BOOLs, STRINGs. Result type is boolean
@@ -794,11 +893,8 @@ xp_relop(xp_ctx    *xc1,
         clicon_err(OE_UNIX, EINVAL, "xc1 or xc2 NULL");
         goto done;
     }
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_initial = xc1->xc_initial;
     xr->xc_type = XT_BOOL;
     if (xc1->xc_type == xc2->xc_type){ /* cases (2-3) above */
@@ -1007,10 +1103,21 @@ xp_relop(xp_ctx    *xc1,
         case XT_NUMBER:
             for (i=0; i<xc1->xc_size; i++){
                 /* node in nodeset */
-                if ((x1 = xc1->xc_nodeset[i]) == NULL ||
-                    (xb = xml_body(x1)) == NULL ||
-                    sscanf(xb, "%lf", &n1) != 1)
-                    n1 = NAN;
+                n1 = NAN;
+                if ((x1 = xc1->xc_nodeset[i]) != NULL){
+                    /* YANG-bound leaf of numeric type: use the decoded cv
+                     * cache so the body is parsed once per node, not strtod:ed
+                     * on every comparison */
+                    cv1 = NULL;
+                    if (xml_spec(x1) != NULL &&
+                        xml_cv_cache(x1, &cv1) < 0)
+                        goto done;
+                    if (cv1 == NULL || cv2double(cv1, &n1) == 0){
+                        if ((xb = xml_body(x1)) == NULL ||
+                            sscanf(xb, "%lf", &n1) != 1)
+                            n1 = NAN;
+                    }
+                }
                 n2 = xc2->xc_number;
                 switch(op){
                 case XO_EQ:
@@ -1057,6 +1164,21 @@ xp_relop(xp_ctx    *xc1,
     return retval;
 }
 
+/* Linear duplicate scan is used for union results below this size, a pointer
+ * hash set above it, see xp_union
+ */
+#define XP_DEDUP_HASH_MIN 128
+
+/*! Hash an xml node pointer into a power-of-two sized table
+ * Fibonacci hashing on the pointer bits
+ */
+static inline uint32_t
+xp_ptr_hash(cxobj   *x,
+            uint32_t mask)
+{
+    return (uint32_t)(((uintptr_t)x * 2654435761UL) >> 4) & mask;
+}
+
 /*! Given two XPATH contexts, eval union operation
  * Both operands must be nodesets, otherwise empty nodeset is returned
  * @param[in]  xc1  Context of operand1
@@ -1065,6 +1187,10 @@ xp_relop(xp_ctx    *xc1,
  * @param[out] xrp  Result context
  * @retval     0    OK
  * @retval    -1    Error
+ * A nodeset is a set: a node occurring in both operands (or twice in one, eg
+ * via overlapping descendant steps) is included once. Small results use a
+ * linear duplicate scan; large ones an open-addressing pointer hash set so
+ * the union stays linear in the number of nodes.
  */
 static int
 xp_union(xp_ctx    *xc1,
@@ -1072,33 +1198,65 @@ xp_union(xp_ctx    *xc1,
          enum xp_op op,
          xp_ctx   **xrp)
 {
-    int     retval = -1;
-    xp_ctx *xr = NULL;
-    int     i;
-    
+    int      retval = -1;
+    xp_ctx  *xr = NULL;
+    cxobj  **ht = NULL;
+    uint32_t mask = 0;
+    uint32_t nslots;
+    uint32_t h;
+    cxobj   *x;
+    int      nr;
+    int      i;
+    int      j;
+
     if (op != XO_UNION){
         clicon_err(OE_UNIX, errno, "%s:Invalid operator %s in this context",
                    __FUNCTION__, clicon_int2str(xpopmap,op));
         goto done;
     }
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_initial = xc1->xc_initial;
     xr->xc_type = XT_NODESET;
-
-    for (i=0; i<xc1->xc_size; i++)
-        if (cxvec_append(xc1->xc_nodeset[i], &xr->xc_nodeset, &xr->xc_size) < 0)
+    nr = xc1->xc_size + xc2->xc_size;
+    if (nr >= XP_DEDUP_HASH_MIN){
+        /* Slot count: smallest power of two >= 2*nr, load factor <= 0.5 */
+        for (nslots = 2; nslots < 2*(uint32_t)nr; nslots *= 2)
+            ;
+        mask = nslots - 1;
+        if ((ht = calloc(nslots, sizeof(cxobj*))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
             goto done;
-    for (i=0; i<xc2->xc_size; i++){
-        if (cxvec_append(xc2->xc_nodeset[i], &xr->xc_nodeset, &xr->xc_size) < 0)
+        }
+    }
+    for (i=0; i<nr; i++){
+        x = i < xc1->xc_size ? xc1->xc_nodeset[i] : xc2->xc_nodeset[i - xc1->xc_size];
+        if (ht){
+            for (h = xp_ptr_hash(x, mask); ht[h]; h = (h+1) & mask)
+                if (ht[h] == x)
+                    break;
+            if (ht[h] == x)
+                continue; /* duplicate */
+            ht[h] = x;
+        }
+        else{
+            for (j=0; j<xr->xc_size; j++)
+                if (xr->xc_nodeset[j] == x)
+                    break;
+            if (j < xr->xc_size)
+                continue; /* duplicate */
+        }
+        if (ctx_nodeset_append(xr, x) < 0)
             goto done;
     }
     *xrp = xr;
+    xr = NULL;
     retval = 0;
  done:
+    if (ht)
+        free(ht);
+    if (xr)
+        ctx_free(xr);
     return retval;
 }
 
@@ -1272,16 +1430,13 @@ xp_eval(xp_ctx     *xc,
         use_xr0++;
         /* Special case, no c0 or c1, single "/" */
         if (xs->xs_c0 == NULL){
-            if ((xr0 = malloc(sizeof(*xr0))) == NULL){
-                clicon_err(OE_UNIX, errno, "malloc");
+            if ((xr0 = ctx_new()) == NULL)
                 goto done;
-            }
-            memset(xr0, 0, sizeof(*xr0));
             xr0->xc_initial = xc->xc_initial;
             xr0->xc_type = XT_NODESET;
             x = NULL;
             while ((x = xml_child_each(xc->xc_node, x, CX_ELMNT)) != NULL) {
-                if (cxvec_append(x, &xr0->xc_nodeset, &xr0->xc_size) < 0)
+                if (ctx_nodeset_append(xr0, x) < 0)
                     goto done;
             }
         }
@@ -1298,21 +1453,15 @@ xp_eval(xp_ctx     *xc,
     case XP_PRI0:
         break;
     case XP_PRIME_NR: /* primaryexpr -> [<number>] */
-        if ((xr0 = malloc(sizeof(*xr0))) == NULL){
-            clicon_err(OE_UNIX, errno, "malloc");
+        if ((xr0 = ctx_new()) == NULL)
             goto done;
-        }
-        memset(xr0, 0, sizeof(*xr0));
         xr0->xc_initial = xc->xc_initial;
         xr0->xc_type = XT_NUMBER;
         xr0->xc_number = xs->xs_double;
         break;
     case XP_PRIME_STR:
-        if ((xr0 = malloc(sizeof(*xr0))) == NULL){
-            clicon_err(OE_UNIX, errno, "malloc");
+        if ((xr0 = ctx_new()) == NULL)
             goto done;
-        }
-        memset(xr0, 0, sizeof(*xr0));
         xr0->xc_initial = xc->xc_initial;
         xr0->xc_type = XT_STRING;
         xr0->xc_string = xs->xs_s0?strdup(xs->xs_s0):NULL;
@@ -228,12 +228,12 @@ derived_from_one(char  *baseidentity,
     yang_stmt *ytype;
     yang_stmt *ybaseid;
     yang_stmt *ymod;
-    cvec      *idrefvec; /* Derived identityref list: (module:id)**/
     char      *node = NULL;
     char      *prefix = NULL;
     char      *id = NULL;
     cbuf      *cb = NULL;
     char      *baseid = NULL;
+    int        ret;
 
     /* Split baseidentity to get its id (w/o prefix) */
     if (nodeid_split(baseidentity, NULL, &baseid) < 0)
@@ -256,8 +256,6 @@ derived_from_one(char  *baseidentity,
     /* Just get the object corresponding to the base identity */
     if ((ybaseid = yang_find_identity_nsc(ys_spec(yleaf), baseidentity, nsc)) == NULL)
         goto nomatch;
-    /* Get its list of derived identities  */
-    idrefvec = yang_cvec_get(ybaseid);
     /* Get and split the leaf id reference */
     if ((node = xml_body(xleaf)) == NULL) /* It may not be empty */
         goto nomatch;
@@ -284,7 +282,9 @@ derived_from_one(char  *baseidentity,
             goto done;
         }
         cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-        if (cvec_find(idrefvec, cbuf_get(cb)) == NULL)
+        if ((ret = yang_identity_derived(ybaseid, cbuf_get(cb))) < 0)
+            goto done;
+        if (ret == 0)
             goto nomatch;
     }
     retval = 1;
@@ -350,11 +350,8 @@ xp_function_derived_from(xp_ctx            *xc,
     if (ctx2string(xr1, &identity) < 0)
         goto done;
     /* Allocate a return struct of type boolean */
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
     /* ANY node is an identityref and its value an identity that is derived ... */
     for (i=0; i<xr0->xc_size; i++){
@@ -424,11 +421,8 @@ xp_function_bit_is_set(xp_ctx            *xc,
         goto done;
     if (ctx2string(xr1, &s1) < 0)
         goto done;
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
     /* The first node in document order in the argument "nodes" 
      * is a node of type "bits") and # NOT IMPLEMENTED
@@ -472,11 +466,8 @@ xp_function_position(xp_ctx            *xc,
     int         retval = -1;
     xp_ctx     *xr = NULL;
     
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_initial = xc->xc_initial;
     xr->xc_type = XT_NUMBER;
     xr->xc_number = xc->xc_position;
@@ -507,11 +498,8 @@ xp_function_count(xp_ctx            *xc,
     }
     if (xp_eval(xc, xs->xs_c0, nsc, localonly, &xr0) < 0)       
         goto done;
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_NUMBER;
     xr->xc_number = xr0->xc_size;
     *xrp = xr;
@@ -549,11 +537,8 @@ xp_function_name(xp_ctx            *xc,
     }
     if (xp_eval(xc, xs->xs_c0, nsc, localonly, &xr0) < 0)       
         goto done;
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_STRING;
     for (i=0; i<xr0->xc_size; i++){
         if ((x = xr0->xc_nodeset[i]) == NULL)
@@ -611,11 +596,8 @@ xp_function_contains(xp_ctx            *xc,
         goto done;
     if (ctx2string(xr1, &s1) < 0)
         goto done;
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
     xr->xc_bool = (strstr(s0, s1) != NULL);
     *xrp = xr;
@@ -662,11 +644,8 @@ xp_function_boolean(xp_ctx            *xc,
     if (xp_eval(xc, xs->xs_c0, nsc, localonly, &xr0) < 0)       
         goto done;
     bool = ctx2boolean(xr0);
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
     xr->xc_bool = bool;
     *xrp = xr;
@@ -708,11 +687,8 @@ xp_function_true(xp_ctx            *xc,
     int         retval = -1;
     xp_ctx     *xr = NULL;
     
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
     xr->xc_bool = 1;
     *xrp = xr;
@@ -735,11 +711,8 @@ xp_function_false(xp_ctx            *xc,
     int         retval = -1;
     xp_ctx     *xr = NULL;
     
-    if ((xr = malloc(sizeof(*xr))) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if ((xr = ctx_new()) == NULL)
         goto done;
-    }
-    memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
     xr->xc_bool = 0;
     *xrp = xr;
@@ -68,6 +68,7 @@
 #include "clixon_xml_sort.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_xpath_function.h"
 #include "clixon_xpath_optimize.h"
 
 #ifdef XPATH_LIST_OPTIMIZE
@@ -212,6 +213,30 @@ loop_preds(xpath_tree *xt,
     goto done;
 }
 
+/*! Return the numeric node of a single position predicate, eg x[3]
+ *
+ * @param[in]  xtp  XPath tree of type PRED
+ * @retval     xt   The XP_PRIME_NR node
+ * @retval     NULL Not a single position predicate
+ * The expression tree of a plain number is a chain of single-child
+ * expression nodes down to the XP_PRIME_NR leaf: descend as long as there is
+ * no second child.
+ */
+static xpath_tree *
+xpath_pred_position(xpath_tree *xtp)
+{
+    xpath_tree *xt;
+
+    if (xtp->xs_type != XP_PRED || xtp->xs_c0 != NULL)
+        return NULL; /* several predicates */
+    xt = xtp->xs_c1;
+    while (xt && xt->xs_c0 && xt->xs_c1 == NULL)
+        xt = xt->xs_c0;
+    if (xt && xt->xs_type == XP_PRIME_NR && xt->xs_c0 == NULL && xt->xs_c1 == NULL)
+        return xt;
+    return NULL;
+}
+
 /*! Pattern matching to find fastpath
  *
  * @param[in]  xt     XPath tree
@@ -225,6 +250,7 @@ loop_preds(xpath_tree *xt,
  * @retval     1      Match
  *  XPath:
  *  y[k=3] # corresponds to: <name>[<keyname>=<keyval>]
+ *  also multiple keys y[k1=1][k2=2], in-order key prefixes, and position y[3]
  */
 static int
 xpath_list_optimize_fn(xpath_tree  *xt,
@@ -245,23 +271,20 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     cvec        *cvk = NULL; /* vector of index keys */
     cg_var      *cvi;
     int          i;
-    yang_stmt   *ypp;
-    
+    xpath_tree  *xtn;
+
     /* revert to non-optimized if no yang */
     if ((yp = xml_spec(xv)) == NULL)
         goto ok;
     /* or if not config data (state data should not be ordered) */
     if (yang_config_ancestor(yp) == 0)
         goto ok;
-    /* Check that there is no "outer" list. */
-    ypp = yp;
-    do {
-        if (yang_keyword_get(ypp) == Y_LIST)
-            goto ok;
-    } while((ypp = yang_parent_get(ypp)) != NULL);
-    /* Check yang and that only a list with key as index is a special case can do bin search 
-     * That is, ONLY check optimize cases of this type:_x[_y='_z']
-     * Should we extend this simple example and have more cases (all cases?)
+    /* Check yang and that only a list with key as index is a special case can do bin search
+     * The checked cases are _x[_y='_z'] with one or more key predicates (an in-order
+     * prefix of the list keys suffices), and a single position predicate _x[NR].
+     * An "outer" list is no hindrance: the sort order of a list only depends on its own
+     * parent, so nested lists resolve with one search per step, and the search functions
+     * themselves fall back to linear scan for ordered-by user.
      */
     xpath_optimize_init(&xm, &xem);
     /* Here is where pattern is checked for equality and where variable binding is made (if
@@ -273,26 +296,37 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     if (veclen != 2)
         goto ok;
     name = vec[0]->xs_s1;
+    xtp = vec[1];
+    /* Single position predicate, eg x[3]: direct position lookup */
+    if ((xtn = xpath_pred_position(xtp)) != NULL){
+        if ((yc = yang_find_datanode(yp, name)) == NULL)
+            goto ok;
+        if (clixon_xml_find_pos(xv, yc, (uint32_t)xtn->xs_double, xvec) < 0)
+            goto done;
+        retval = 1; /* match */
+        goto done;
+    }
     /* Extract variables */
     if ((yc = yang_find(yp, Y_LIST, name)) == NULL)
 #ifdef NOTYET /* leaf-list is not detected by xpath optimize detection */
         if ((yc = yang_find(yp, Y_LEAF_LIST, name)) == NULL) /* XXX */
 #endif
-            goto ok; 
+            goto ok;
     /* Validate keys */
     if ((cvv = yang_cvec_get(yc)) == NULL)
         goto ok;
-    xtp = vec[1];
     if ((cvk = cvec_new(0)) == NULL){
-        clicon_err(OE_YANG, errno, "cvec_new"); 
+        clicon_err(OE_YANG, errno, "cvec_new");
         goto done;
     }
     if ((ret = loop_preds(xtp, xem, cvk)) < 0)
         goto done;
     if (ret == 0)
         goto ok;
-
-    if (cvec_len(cvv) != cvec_len(cvk))
+    /* The predicate keys must be an in-order prefix of the list keys: a full set
+     * finds one entry, a prefix binary-searches a matching range
+     */
+    if (cvec_len(cvk) < 1 || cvec_len(cvk) > cvec_len(cvv))
         goto ok;
     i = 0;
     cvi = NULL;
@@ -317,6 +351,139 @@ xpath_list_optimize_fn(xpath_tree  *xt,
 }
 #endif /* XPATH_LIST_OPTIMIZE */
 
+/* Max number of predicates on a single step considered for cost reordering */
+#define XPATH_PRED_REORDER_MAX 8
+
+/*! Estimate static evaluation cost of a predicate expression subtree
+ *
+ * Rough weights: a location step costs 2, a comparison 1, an absolute path 4
+ * and a function call 8, so a key equality [k='v'] ranks below a nested path
+ * [a/b='v'] which ranks below a function call.
+ * @param[in]     xt     XPath expression tree (predicate expr)
+ * @param[in,out] costp  Accumulated cost
+ * @retval        0      OK, cost in costp
+ * @retval        1      Unsafe to reorder: cost depends on context position
+ */
+static int
+xpath_pred_cost(xpath_tree *xt,
+                int        *costp)
+{
+    int fn;
+
+    if (xt == NULL)
+        return 0;
+    switch (xt->xs_type){
+    case XP_PRIME_FN:
+        fn = xp_fnname_str2int(xt->xs_s0);
+        if (fn == XPATHFN_POSITION || fn == XPATHFN_LAST)
+            return 1; /* result depends on evaluation order */
+        *costp += 8;
+        break;
+    case XP_ABSPATH:
+        *costp += 4;
+        break;
+    case XP_STEP:
+        *costp += 2;
+        break;
+    case XP_RELEX:
+        *costp += 1;
+        break;
+    default:
+        break;
+    }
+    if (xpath_pred_cost(xt->xs_c0, costp))
+        return 1;
+    return xpath_pred_cost(xt->xs_c1, costp);
+}
+
+/*! Reorder one predicate chain so that cheap predicates are evaluated first
+ *
+ * Predicates of a step are evaluated in written order, see xp_eval_predicate,
+ * so an expensive predicate written before a cheap selective one is paid for
+ * every candidate node. Permute the expressions within the XP_PRED chain so
+ * the cheapest filters run first; ties keep written order so key predicates
+ * still appear in yang key order (see xpath_list_optimize_fn).
+ * Skipped if any predicate is positional (a bare number, position() or
+ * last()) since predicate order then affects the result.
+ * @param[in]  xtp  XPath tree of type XP_PRED (chain head)
+ * @retval     0    OK, chain possibly reordered
+ */
+static int
+xpath_optimize_preds(xpath_tree *xtp)
+{
+    xpath_tree *preds[XPATH_PRED_REORDER_MAX]; /* chain nodes, head first */
+    xpath_tree *exprs[XPATH_PRED_REORDER_MAX]; /* exprs in written order */
+    int         cost[XPATH_PRED_REORDER_MAX];
+    xpath_tree *xt;
+    xpath_tree *xe;
+    int         nr = 0;
+    int         c;
+    int         i;
+    int         j;
+
+    for (xt = xtp; xt && xt->xs_type == XP_PRED; xt = xt->xs_c0){
+        if (xt->xs_c1 == NULL)
+            continue; /* chain terminator */
+        if (nr >= XPATH_PRED_REORDER_MAX)
+            return 0;
+        preds[nr++] = xt;
+    }
+    if (nr < 2)
+        return 0;
+    /* preds[] is head-first, ie reverse written order: collect exprs and costs
+     * in written order */
+    for (i = 0; i < nr; i++){
+        xe = preds[nr-1-i]->xs_c1;
+        /* A plain number predicate is a single-child chain down to a
+         * XP_PRIME_NR leaf: positional, do not reorder */
+        while (xe && xe->xs_c0 && xe->xs_c1 == NULL)
+            xe = xe->xs_c0;
+        if (xe && xe->xs_type == XP_PRIME_NR)
+            return 0;
+        exprs[i] = preds[nr-1-i]->xs_c1;
+        cost[i] = 0;
+        if (xpath_pred_cost(exprs[i], &cost[i]))
+            return 0;
+    }
+    /* Stable insertion sort on cost, written order kept among equals */
+    for (i = 1; i < nr; i++){
+        xe = exprs[i];
+        c = cost[i];
+        for (j = i; j > 0 && cost[j-1] > c; j--){
+            exprs[j] = exprs[j-1];
+            cost[j] = cost[j-1];
+        }
+        exprs[j] = xe;
+        cost[j] = c;
+    }
+    for (i = 0; i < nr; i++)
+        preds[nr-1-i]->xs_c1 = exprs[i];
+    return 0;
+}
+
+/*! Reorder multi-predicate steps of a compiled xpath, cheap predicates first
+ *
+ * Called once per compiled tree from xpath_parse, so the cost estimate is not
+ * paid per evaluation and shared cached trees are never mutated during eval.
+ * @param[in]  xt  XPath parse tree
+ * @retval     0   OK
+ * @see xpath_optimize_preds
+ */
+int
+xpath_optimize_predicates(xpath_tree *xt)
+{
+    if (xt == NULL)
+        return 0;
+    if (xt->xs_type == XP_STEP &&
+        xt->xs_c1 && xt->xs_c1->xs_type == XP_PRED){
+        if (xpath_optimize_preds(xt->xs_c1) < 0)
+            return -1;
+    }
+    if (xpath_optimize_predicates(xt->xs_c0) < 0)
+        return -1;
+    return xpath_optimize_predicates(xt->xs_c1);
+}
+
 /*! Identify XPATH special cases and if match, use binary search.
  *
  * @retval -1  Error
@@ -75,6 +75,8 @@
 #include "clixon_hash.h"
 #include "clixon_xml.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_data.h"
@@ -234,16 +236,71 @@ yang_argument_get(yang_stmt *ys)
  *  2c. identity types: derived instances: identityrefs, save <module>:<idref>
  *  2d. type: leafref types: derived instances.
  */
-/*! Set yang argument, not not copied
+/* Interned string table for yang statement arguments
+ * Yang modules repeat the same identifiers, type names and text bodies
+ * thousands of times; interning stores one shared copy per distinct string.
+ * Entries are never deleted so interned pointers stay valid for process
+ * lifetime, also over yspec reloads.
+ * @see xml_intern_set  Same mechanism for XML element names
+ */
+static clicon_hash_t *_yang_intern_tbl = NULL;
+
+/*! Intern a string, returning a pointer valid for process lifetime
+ * @param[in]  str  String to intern (copied on first occurrence)
+ * @retval     s    Shared interned copy of str
+ * @retval     NULL Error
+ */
+static char *
+yang_intern_str(char *str)
+{
+    clicon_hash_t h;
+
+    if (_yang_intern_tbl == NULL &&
+        (_yang_intern_tbl = clicon_hash_init()) == NULL)
+        return NULL;
+    if ((h = clicon_hash_lookup(_yang_intern_tbl, str)) == NULL &&
+        (h = clicon_hash_add(_yang_intern_tbl, str, NULL, 0)) == NULL)
+        return NULL;
+    return h->h_key;
+}
+
+/*! Free the interned argument table
+ * May only be called at process exit, after all yang specs have been freed.
+ * @retval     0    OK
+ * @see xml_intern_exit
+ */
+int
+yang_intern_exit(void)
+{
+    if (_yang_intern_tbl){
+        clicon_hash_free(_yang_intern_tbl);
+        _yang_intern_tbl = NULL;
+    }
+    return 0;
+}
+
+/*! Set yang argument to shared interned copy, consumes arg
  * @param[in] ys   Yang statement node
- * @param[in] arg  Argument
- * Typically only done at parsing / initiation
+ * @param[in] arg  Argument, malloced, consumed here
+ * @retval    0    OK
+ * @retval   -1    Error
+ * Typically only done at parsing / initiation.
+ * The statement points into the process-wide interned argument table, so it is
+ * not freed in ys_free1, see yang_intern_exit
  */
 int
 yang_argument_set(yang_stmt *ys,
                   char      *arg)
 {
-    ys->ys_argument = arg; /* not strdup/copied */
+    char *istr;
+
+    if (arg != NULL){
+        if ((istr = yang_intern_str(arg)) == NULL)
+            return -1;
+        free(arg); /* consumed: replaced by the shared interned copy */
+        arg = istr;
+    }
+    ys->ys_argument = arg;
     return 0;
 }
 
@@ -416,6 +473,41 @@ yang_when_nsc_set(yang_stmt *ys,
     return retval;
 }
 
+/*! Get compiled xpath tree of a when/must condition, compile and cache on first call
+ *
+ * For Y_WHEN and Y_MUST the statement argument is the xpath, for other nodes the
+ * "when"-associated augment/uses xpath is used, see yang_when_xpath_get.
+ * The yang schema is immutable after load so the compiled tree is computed once and
+ * kept on the yang statement for its lifetime, avoiding re-parsing the same xpath
+ * string on every validation pass.
+ * @param[in]  ys     Yang statement
+ * @retval     xptree Compiled xpath parse tree, owned by ys, caller must not free
+ * @retval     NULL   No xpath associated with ys, or parse error
+ * @see xpath_parse
+ */
+xpath_tree *
+yang_xptree_get(yang_stmt *ys)
+{
+    char *xpath;
+
+    if (ys->ys_xptree != NULL)
+        return (xpath_tree *)ys->ys_xptree;
+    switch (yang_keyword_get(ys)){
+    case Y_WHEN:
+    case Y_MUST:
+        xpath = yang_argument_get(ys);
+        break;
+    default:
+        xpath = yang_when_xpath_get(ys);
+        break;
+    }
+    if (xpath == NULL)
+        return NULL;
+    if (xpath_parse(xpath, (xpath_tree **)&ys->ys_xptree) < 0)
+        return NULL;
+    return (xpath_tree *)ys->ys_xptree;
+}
+
 /*! Get yang filename for error/debug purpose
  *
  * @param[in]  ys       Yang statement
@@ -476,6 +568,22 @@ yang_linenum_set(yang_stmt *ys,
 /* Stats */
 static uint64_t _stats_yang_nr = 0;
 
+/* Yang spec generation: bumped whenever a yang specification is freed, so
+ * that caches holding resolved yang_stmt pointers can detect a schema
+ * reload and drop stale entries, see eg the parsed-path cache in
+ * clixon_path.c
+ */
+static uint64_t _yspec_generation = 0;
+
+/*! Get the yang spec generation
+ * @retval gen  Current generation, bumped each time a yang spec is freed
+ */
+uint64_t
+yspec_generation_get(void)
+{
+    return _yspec_generation;
+}
+
 /*! Get global statistics about YANG statements: created - freed
  *
  * @param[out]  nr  Number of existing YANG objects (created - freed)
@@ -628,8 +736,12 @@ ys_free1(yang_stmt *ys,
     cg_var         *cv;
     rpc_callback_t *rc;
 
+    if (self && ys->ys_keyword == Y_SPEC)
+        _yspec_generation++; /* invalidate caches of resolved yang pointers */
     if (ys->ys_argument){
-        free(ys->ys_argument);
+        /* Interned: shared pointer into the process-wide argument table,
+         * not freed here, see yang_argument_set / yang_intern_exit
+         */
         ys->ys_argument = NULL;
     }
     if ((cv = yang_cv_get(ys)) != NULL){
@@ -648,6 +760,15 @@ ys_free1(yang_stmt *ys,
         free(ys->ys_when_xpath);
     if (ys->ys_when_nsc)
         cvec_free(ys->ys_when_nsc);
+    if (ys->ys_xptree){
+        xpath_tree_free((xpath_tree *)ys->ys_xptree);
+        ys->ys_xptree = NULL;
+    }
+    ys_find_hash_clear(ys);
+    if (ys->ys_id_hash){
+        clicon_hash_free(ys->ys_id_hash);
+        ys->ys_id_hash = NULL;
+    }
     if (ys->ys_stmt)
         free(ys->ys_stmt);
     if (ys->ys_filename)
@@ -685,6 +806,7 @@ ys_prune(yang_stmt *yp,
     
     if (i >= yp->ys_len)
         goto done;
+    ys_find_hash_clear(yp); /* child vector changes */
     yc = yp->ys_stmt[i];
     if (i < yp->ys_len - 1){
         size = (yp->ys_len - i - 1)*sizeof(struct yang_stmt *);
@@ -742,6 +864,7 @@ ys_freechildren(yang_stmt *ys)
     int i;
     yang_stmt *yc;
     
+    ys_find_hash_clear(ys);
     for (i=0; i<ys->ys_len; i++){
         if ((yc = ys->ys_stmt[i]) != NULL)
             ys_free(yc);
@@ -768,9 +891,10 @@ ys_free(yang_stmt *ys)
 }
 
 /*! Allocate larger yang statement vector adding empty field last */
-static int 
+static int
 yn_realloc(yang_stmt *yn)
 {
+    ys_find_hash_clear(yn); /* child vector changes */
     yn->ys_len++;
 
     if ((yn->ys_stmt = realloc(yn->ys_stmt, (yn->ys_len)*sizeof(yang_stmt *))) == 0){
@@ -811,11 +935,9 @@ ys_cp(yang_stmt *ynew,
             clicon_err(OE_YANG, errno, "calloc");
             goto done;
         }
-    if (yold->ys_argument)
-        if ((ynew->ys_argument = strdup(yold->ys_argument)) == NULL){
-            clicon_err(OE_YANG, errno, "strdup");
-            goto done;
-        }
+    /* ys_argument pointer from memcpy is kept: interned arguments are shared,
+     * see yang_argument_set
+     */
     yang_cv_set(ynew, NULL);
     if ((cvo = yang_cv_get(yold)) != NULL){
         if ((cvn = cv_dup(cvo)) == NULL){
@@ -834,6 +956,10 @@ ys_cp(yang_stmt *ynew,
         if (yang_type_cache_cp(ynew, yold) < 0)
             goto done;
     }
+    ynew->ys_xptree = NULL;    /* Recompiled lazily, see yang_xptree_get */
+    ynew->ys_find_hash = NULL; /* Rebuilt lazily, see yang_find */
+    ynew->ys_id_hash = NULL;   /* Rebuilt lazily, see yang_identity_derived */
+    ynew->ys_union_mru = NULL; /* Points into the old tree, relearnt on first validation */
     if (yold->ys_when_xpath)
         if ((ynew->ys_when_xpath = strdup(yold->ys_when_xpath)) == NULL){
             clicon_err(OE_YANG, errno, "strdup");
@@ -998,6 +1124,106 @@ yn_each(yang_stmt *yparent,
     return yc;
 }
 
+/*
+ * Hashed child lookup for yang_find
+ * Nodes with many children (modules with hundreds of top-level statements,
+ * big containers) are scanned linearly by yang_find, which is called per XML
+ * node from xml_bind_yang and from type resolution. For such nodes a
+ * (keyword,argument)->child hash is built lazily on first lookup and cleared
+ * whenever the child vector changes.
+ */
+#define YANG_FIND_HASH_MIN 16  /* Build/use the hash at this nr of children */
+
+/*! Format the (keyword,argument) hash key into buf
+ *
+ * @retval     1    OK
+ * @retval     0    Key does not fit in buf: caller falls back to linear scan
+ */
+static int
+ys_find_hash_key(int         keyword,
+                 const char *argument,
+                 char       *buf,
+                 size_t      buflen)
+{
+    if (snprintf(buf, buflen, "%d %s", keyword, argument) >= (int)buflen)
+        return 0;
+    return 1;
+}
+
+/*! Clear the child-derived caches of a yang statement
+ *
+ * Must be called whenever the child vector of ys is modified: insert, prune,
+ * reorder, or a child changing keyword or argument. Clears the child lookup
+ * hash and the cached sub-statement properties (ordered-by, config,
+ * mandatory).
+ * @param[in]  ys   Yang statement (NULL is ok)
+ * @retval     0    OK
+ */
+int
+ys_find_hash_clear(yang_stmt *ys)
+{
+    if (ys == NULL)
+        return 0;
+    if (ys->ys_find_hash){
+        clicon_hash_free(ys->ys_find_hash);
+        ys->ys_find_hash = NULL;
+    }
+    ys->ys_union_mru = NULL;
+    yang_flag_reset(ys, YANG_FLAG_ORDER_CACHE|YANG_FLAG_ORDER_USER);
+#ifdef USE_CONFIG_FLAG_CACHE
+    yang_flag_reset(ys, YANG_FLAG_MYCONFIG_CACHE|YANG_FLAG_MYCONFIG_VALUE);
+#endif
+    yang_flag_reset(ys, YANG_FLAG_MAND_CACHE|YANG_FLAG_MAND_VALUE);
+    return 0;
+}
+
+/*! Look up a child by (keyword,argument) via the lazy hash
+ *
+ * Builds the hash on first use. Children sharing a key keep the first in
+ * child order, matching the linear scan in yang_find.
+ * @param[in]  yn       Yang node whose children are searched
+ * @param[in]  keyword  Child keyword, must not be 0
+ * @param[in]  argument Child argument, must not be NULL
+ * @param[out] usable   1: the returned value is authoritative, 0: fall back
+ *                      to a linear scan (key too long or hash build failed)
+ * @retval     ys       Matching child
+ * @retval     NULL     No match (only authoritative if usable is 1)
+ */
+static yang_stmt *
+ys_find_hash_get(yang_stmt  *yn,
+                 int         keyword,
+                 const char *argument,
+                 int        *usable)
+{
+    char       key[256];
+    int        i;
+    yang_stmt *ys;
+    void      *p;
+
+    *usable = 0;
+    if (yn->ys_find_hash == NULL){
+        if ((yn->ys_find_hash = clicon_hash_init()) == NULL)
+            return NULL;
+        for (i=0; i<yn->ys_len; i++){
+            ys = yn->ys_stmt[i];
+            if (ys->ys_argument == NULL)
+                continue;
+            if (!ys_find_hash_key(ys->ys_keyword, ys->ys_argument, key, sizeof(key)))
+                continue; /* a too-long key can never match a fitting lookup */
+            if (clicon_hash_value(yn->ys_find_hash, key, NULL) != NULL)
+                continue; /* keep first match */
+            if (clicon_hash_add(yn->ys_find_hash, key, &ys, sizeof(ys)) == NULL)
+                return NULL;
+        }
+    }
+    if (!ys_find_hash_key(keyword, argument, key, sizeof(key)))
+        return NULL;
+    *usable = 1;
+    if ((p = clicon_hash_value(yn->ys_find_hash, key, NULL)) == NULL)
+        return NULL;
+    return *(yang_stmt **)p;
+}
+
 /*! Find first child yang_stmt with matching keyword and argument
  *
  * @param[in]  yn         Yang node, current context node.
@@ -1020,17 +1246,25 @@ yang_find(yang_stmt  *yn,
     char      *name;
     yang_stmt *yspec;
     yang_stmt *ym;
+    int        hashed = 0;
 
-    for (i=0; i<yn->ys_len; i++){
-        ys = yn->ys_stmt[i];
-        if (keyword == 0 || ys->ys_keyword == keyword){
-            if (argument == NULL ||
-                (ys->ys_argument && strcmp(argument, ys->ys_argument) == 0)){
-                yret = ys;
-                break;
+    if (keyword != 0 && argument != NULL && yn->ys_len >= YANG_FIND_HASH_MIN)
+        yret = ys_find_hash_get(yn, keyword, argument, &hashed);
+    if (!hashed)
+        for (i=0; i<yn->ys_len; i++){
+            ys = yn->ys_stmt[i];
+            if (keyword == 0 || ys->ys_keyword == keyword){
+                /* Pointer equality catches interned arguments, eg when the caller
+                 * passes yang_argument_get() of another statement
+                 */
+                if (argument == NULL ||
+                    ys->ys_argument == argument ||
+                    (ys->ys_argument && strcmp(argument, ys->ys_argument) == 0)){
+                    yret = ys;
+                    break;
+                }
             }
         }
-    }
     /* Special case: if not match and yang node is module or submodule, extend
      * search to include submodules */
     if (yret == NULL &&
@@ -2533,6 +2767,10 @@ ys_populate_identity(clicon_handle h,
         /* add prefix */
         cv_name_set(cv, idref);
         cvec_append_var(idrefvec, cv); /* cv copied */
+        if (ybaseid->ys_id_hash){ /* invalidate flattened set, see yang_identity_derived */
+            clicon_hash_free(ybaseid->ys_id_hash);
+            ybaseid->ys_id_hash = NULL;
+        }
         if (cv){
             cv_free(cv);
             cv = NULL;
@@ -2552,6 +2790,40 @@ ys_populate_identity(clicon_handle h,
     return retval;
 }
 
+/*! Check if an identity reference is in the derived set of a base identity
+ *
+ * The transitive derived set is kept as a cvec on the base identity, see
+ * ys_populate_identity. Linear lookup there shows up in commit profiles of
+ * configs with many identityref leaves, so the set is flattened into a hash
+ * on first use and probed in constant time after that.
+ * @param[in]  ybaseid  Base identity yang statement
+ * @param[in]  idref    Identity reference on canonical form <module>:<id>
+ * @retval     1        idref is derived from ybaseid
+ * @retval     0        Not derived
+ * @retval    -1        Error
+ * @see validate_identityref
+ */
+int
+yang_identity_derived(yang_stmt *ybaseid,
+                      char      *idref)
+{
+    int     retval = -1;
+    cvec   *idrefvec;
+    cg_var *cv = NULL;
+
+    if (ybaseid->ys_id_hash == NULL){
+        if ((ybaseid->ys_id_hash = clicon_hash_init()) == NULL)
+            goto done;
+        idrefvec = yang_cvec_get(ybaseid);
+        while ((cv = cvec_each(idrefvec, cv)) != NULL)
+            if (clicon_hash_add(ybaseid->ys_id_hash, cv_name_get(cv), NULL, 0) == NULL)
+                goto done;
+    }
+    retval = (clicon_hash_lookup(ybaseid->ys_id_hash, idref) != NULL) ? 1 : 0;
+ done:
+    return retval;
+}
+
 /*! Return 1 if feature is enabled, 0 if not using the populated yang tree
  *
  * @param[in] yspec   yang specification
@@ -2925,6 +3197,7 @@ yang_features(clicon_handle h,
                 case 0: /* disabled: remove ys */
                     /* Change datanodes YANG to ANYDATA, other nodes are removed
                      */
+                    ys_find_hash_clear(yt); /* child removed or rekeyed */
                     if (yang_datanode(ys) && yang_config_ancestor(ys)){
                         ys->ys_keyword = Y_ANYDATA;
                         ys_freechildren(ys);
@@ -3298,13 +3571,23 @@ int
 yang_config(yang_stmt *ys)
 {
     yang_stmt *ym;
+    int        val = 1;
 
-    if ((ym = yang_find(ys, Y_CONFIG, NULL)) != NULL){
-        if (yang_cv_get(ym) == NULL) /* shouldnt happen */
-            return 1; 
-        return cv_bool_get(yang_cv_get(ym));
-    }
-    return 1;
+#ifdef USE_CONFIG_FLAG_CACHE
+    if (yang_flag_get(ys, YANG_FLAG_MYCONFIG_CACHE))
+        return yang_flag_get(ys, YANG_FLAG_MYCONFIG_VALUE)?1:0;
+#endif
+    if ((ym = yang_find(ys, Y_CONFIG, NULL)) != NULL &&
+        yang_cv_get(ym) != NULL) /* NULL cv shouldnt happen */
+        val = cv_bool_get(yang_cv_get(ym));
+#ifdef USE_CONFIG_FLAG_CACHE
+    yang_flag_set(ys, YANG_FLAG_MYCONFIG_CACHE);
+    if (val)
+        yang_flag_set(ys, YANG_FLAG_MYCONFIG_VALUE);
+    else
+        yang_flag_reset(ys, YANG_FLAG_MYCONFIG_VALUE);
+#endif
+    return val;
 }
 
 /*! Return config state of this node taking parents/ancestors into account
@@ -3347,6 +3630,30 @@ yang_config_ancestor(yang_stmt *ys)
     return 1;
 }
 
+/*! Return whether a list or leaf-list is ordered-by user
+ *
+ * The result is cached in the node's flags on first use: the sort code asks
+ * once per comparison and the linear child scan of yang_find dominates
+ * bulk-sort profiles otherwise. The cache is cleared whenever the child
+ * vector changes, see ys_find_hash_clear.
+ * @param[in] ys  Yang statement, typically Y_LIST or Y_LEAF_LIST
+ * @retval    1   Node has an ordered-by user sub-statement
+ * @retval    0   Node is ordered-by system (the default)
+ * @see xml_cmp  hot caller
+ */
+int
+yang_ordered_by_user(yang_stmt *ys)
+{
+    if (yang_flag_get(ys, YANG_FLAG_ORDER_CACHE))
+        return yang_flag_get(ys, YANG_FLAG_ORDER_USER)?1:0;
+    yang_flag_set(ys, YANG_FLAG_ORDER_CACHE);
+    if (yang_find(ys, Y_ORDERED_BY, "user") != NULL){
+        yang_flag_set(ys, YANG_FLAG_ORDER_USER);
+        return 1;
+    }
+    return 0;
+}
+
 /*! Given a yang node, translate the argument string to a cv vector
  *
  * @param[in]  ys         Yang statement 
@@ -3565,6 +3872,79 @@ yang_type_cache_get(yang_stmt   *ytype,
     return retval;
 }
 
+/*! Get shared pointers into yang type cache, no copying
+ *
+ * Same as yang_type_cache_get except patterns and regexps are returned as direct
+ * pointers into the cache instead of being copied into caller-allocated cvecs.
+ * The returned cvecs are owned by the cache, may be NULL, and must be treated
+ * as read-only by the caller.
+ * @param[out] patterns Cached regexp pattern strings, or NULL
+ * @param[out] regexps  Cached _compiled_ regexps, or NULL if not yet compiled
+ * @retval    -1        Error
+ * @retval     0        No cache
+ * @retval     1        OK
+ * @see yang_type_cache_get  Copying variant
+ */
+int
+yang_type_cache_get2(yang_stmt   *ytype,
+                     yang_stmt  **resolved,
+                     int         *options,
+                     cvec       **cvv,
+                     cvec       **patterns,
+                     int         *rxmode,
+                     cvec       **regexps,
+                     uint8_t     *fraction)
+{
+    yang_type_cache *ycache;
+
+    if ((ycache = ytype->ys_typecache) == NULL)
+        return 0;
+    if (resolved)
+        *resolved = ycache->yc_resolved;
+    if (options)
+        *options  = ycache->yc_options;
+    if (cvv)
+        *cvv      = ycache->yc_cvv;
+    if (patterns)
+        *patterns = ycache->yc_patterns;
+    if (regexps)
+        *regexps  = ycache->yc_regexps;
+    if (rxmode)
+        *rxmode   = ycache->yc_rxmode;
+    if (fraction)
+        *fraction = ycache->yc_fraction;
+    return 1;
+}
+
+/*! Get the union member type that matched the most recently validated value
+ *
+ * @param[in]  ytype  Yang type statement (resolved union)
+ * @retval     ys     Member Y_TYPE statement, or NULL if none recorded
+ * @see ys_cv_validate_union  which tries this member first
+ */
+yang_stmt *
+yang_union_mru_get(yang_stmt *ytype)
+{
+    return ytype->ys_union_mru;
+}
+
+/*! Record the union member type that matched a validated value
+ *
+ * Values of a union-typed leaf-list or repeated leaf tend to match the same
+ * member, so remembering the last hit and trying it first makes bulk
+ * validation effectively one member trial per value.
+ * @param[in]  ytype   Yang type statement (resolved union)
+ * @param[in]  ymember Member Y_TYPE statement of ytype that matched
+ * @retval     0       OK
+ */
+int
+yang_union_mru_set(yang_stmt *ytype,
+                   yang_stmt *ymember)
+{
+    ytype->ys_union_mru = ymember;
+    return 0;
+}
+
 /*! Copy yang type cache
  */
 static int
@@ -3604,39 +3984,16 @@ yang_type_cache_cp(yang_stmt *ynew,
 static int
 yang_type_cache_free(yang_type_cache *ycache)
 {
-    cg_var *cv;
-    void   *p;
-    
     if (ycache->yc_cvv)
         cvec_free(ycache->yc_cvv);
     if (ycache->yc_patterns)
         cvec_free(ycache->yc_patterns);
-    if (ycache->yc_regexps){
-        cv = NULL;
-        while ((cv = cvec_each(ycache->yc_regexps, cv)) != NULL){
-            /* need to store mode since clicon_handle is not available */
-            switch (ycache->yc_rxmode){
-            case REGEXP_POSIX:
-                cligen_regex_posix_free(cv_void_get(cv));
-                if ((p = cv_void_get(cv)) != NULL){
-                    free(p);
-                    cv_void_set(cv, NULL);
-                }
-                break;
-            case REGEXP_LIBXML2:
-                cligen_regex_libxml2_free(cv_void_get(cv));
-                /* Note, already freed in libxml2 case */
-                if ((p = cv_void_get(cv)) != NULL){
-                    cv_void_set(cv, NULL);
-                }
-                break;
-            default:
-                break;
-            }
-
-        }
+    if (ycache->yc_regexps)
+        /* The compiled regexp objects are shared between type caches and owned
+         * by the process-wide regex cache, see regex_compile/regex_cache_free.
+         * Only the cvec of pointers is freed here.
+         */
         cvec_free(ycache->yc_regexps);
-    }
     free(ycache);
     return 0;
 }
@@ -3788,6 +4145,7 @@ yang_sort_subelements(yang_stmt *ys)
         /* This enumerates _ys_vector_i in ys->ys_stmt vector */
         while ((yc = yn_each(ys, yc)) != NULL) ;
         qsort(ys->ys_stmt, ys->ys_len, sizeof(ys), yang_sort_subelements_fn);
+        ys_find_hash_clear(ys); /* first-match order may change */
     }
     retval = 0;
     // done:
@@ -3797,6 +4155,9 @@ yang_sort_subelements(yang_stmt *ys)
 int
 yang_init(clicon_handle h)
 {
+    /* Enable the compiled-yang cache if a cache dir is configured */
+    if (yang_cache_dir_set(clicon_option_str(h, "CLICON_YANG_CACHE_DIR")) < 0)
+        return -1;
     return yang_cardinality_init(h);
 }
 
@@ -69,7 +69,9 @@ struct yang_stmt{
     struct yang_stmt  *ys_parent;    /* Backpointer to parent: yang-stmt or yang-spec */
     enum rfc_6020      ys_keyword;   /*  */
 
-    char              *ys_argument;  /* String / argument depending on keyword */   
+    char              *ys_argument;  /* String / argument depending on keyword.
+                                        Interned: shared pointer into a process-wide
+                                        table, see yang_argument_set */
     uint16_t           ys_flags;     /* Flags according to YANG_FLAG_MARK and others */
     yang_stmt         *ys_mymodule;  /* Shortcut to "my" module. Used by:
                                         1) Augmented nodes "belong" to the module where the 
@@ -97,8 +99,17 @@ struct yang_stmt{
                                         Y_UNIQUE: vector of descendant schema node ids
                                      */
     yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
+    yang_stmt         *ys_union_mru; /* Y_TYPE "union": member type that matched the most recently
+                                        validated value, tried first on the next validation,
+                                        see ys_cv_validate_union. Not owned, reset on child changes */
     char              *ys_when_xpath; /* Special conditional for a "when"-associated augment/uses xpath */
     cvec              *ys_when_nsc;   /* Special conditional for a "when"-associated augment/uses namespace ctx */
+    struct xpath_tree *ys_xptree;     /* Compiled xpath of Y_WHEN/Y_MUST argument, or of ys_when_xpath,
+                                         set lazily, see yang_xptree_get */
+    clicon_hash_t     *ys_find_hash;  /* Lazy (keyword,argument)->child lookup hash, see yang_find.
+                                         Cleared whenever the child vector changes, see ys_find_hash_clear */
+    clicon_hash_t     *ys_id_hash;    /* Y_IDENTITY: lazy hash set over the derived-identity cvec,
+                                         see yang_identity_derived */
     char              *ys_filename;   /* For debug/errors: filename (only (sub)modules) */
     int                ys_linenum;    /* For debug/errors: line number (in ys_filename) */
     rpc_callback_t    *ys_action_cb;  /* Action callback list, only for Y_ACTION */
@@ -106,5 +117,10 @@ struct yang_stmt{
     int               _ys_vector_i;   /* internal use: yn_each */
 };
 
+/*
+ * Internal prototypes (shared by clixon_yang.c and clixon_yang_parse_lib.c only)
+ */
+int ys_find_hash_clear(yang_stmt *ys);
+
 #endif  /* _CLIXON_YANG_INTERNAL_H_ */
 
@@ -57,6 +57,8 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <limits.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <ctype.h>
 #include <unistd.h>
 #include <string.h>
@@ -64,6 +66,7 @@
 #include <regex.h>
 #include <dirent.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <fcntl.h>
 #include <syslog.h>
 #include <sys/stat.h>
@@ -584,6 +587,7 @@ yang_expand_uses_node(yang_stmt *yn,
      * yn is parent: the children of ygrouping replaces ys.
      * Is there a case when glen == 0?  YES AND THIS BREAKS
      */
+    ys_find_hash_clear(yn); /* child vector is rewritten below */
     if (glen != 1){
         size = (yang_len_get(yn) - i - 1)*sizeof(struct yang_stmt *);
         yn->ys_len += glen - 1;
@@ -824,36 +828,39 @@ yang_parse_file(FILE       *fp,
                 yang_stmt  *yspec)
 {
     char         *buf = NULL;
-    int           i;
-    char          c;
-    int           len;
+    size_t        i;
+    size_t        len;
+    size_t        nr;
+    struct stat   st;
     yang_stmt    *ymod = NULL;
-    int           ret;
 
+    /* Read in blocks, use the file size as buffer hint when available so that
+     * a regular file is read in a single fread without realloc (fp can also
+     * be a pipe or socket, then fall back on doubling)
+     */
     len = BUFLEN; /* any number is fine */
+    if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        len = (size_t)st.st_size + 2;
     if ((buf = malloc(len)) == NULL){
         clicon_err(OE_XML, errno, "malloc");
         goto done;
     }
-    memset(buf, 0, len);
     i = 0; /* position in buf */
-    while (1){ /* read the whole file */
-        if ((ret = fread(&c, 1, 1, fp)) < 0){
-            clicon_err(OE_XML, errno, "read");
-            break;
-        }
-        if (ret == 0)
-            break; /* eof */
+    while ((nr = fread(buf+i, 1, len-1-i, fp)) > 0){ /* read the whole file */
+        i += nr;
         if (i == len-1){
             if ((buf = realloc(buf, 2*len)) == NULL){
                 clicon_err(OE_XML, errno, "realloc");
                 goto done;
-            }       
-            memset(buf+len, 0, len);
+            }
             len *= 2;
         }
-        buf[i++] = (char)(c&0xff);
-    } /* read a line */
+    }
+    if (ferror(fp)){
+        clicon_err(OE_XML, errno, "fread");
+        goto done;
+    }
+    buf[i] = '\0';
     if ((ymod = yang_parse_str(buf, name, yspec)) < 0)
         goto done;
   done:
@@ -900,7 +907,161 @@ filename2revision(const char *filename,
     return retval;
 }
 
-/*! No specific revision give. Match a yang file given module 
+/* Yang directory listing cache
+ * yang_parse_find_match() resolves each module@revision by scanning every
+ * configured yang directory; with many modules and search dirs this adds up
+ * to thousands of directory walks and failed stat() calls at startup, which
+ * is costly on networked file systems. Instead scan each directory once into
+ * a <filename,path> vector and resolve against that, revalidated by a single
+ * stat() of the directory mtime per lookup.
+ * @note for recursive CLICON_YANG_DIR trees only the top directory mtime is
+ *       checked: a change in a subdirectory alone is not detected by a
+ *       running process (touch the top directory to force a rescan).
+ */
+struct yang_dir_cache {
+    struct yang_dir_cache *yd_next;
+    char                  *yd_dir;       /* Directory path */
+    int                    yd_recursive; /* Set if scanned recursively */
+    struct timespec        yd_mtime;     /* Directory mtime at scan */
+    cvec                  *yd_files;     /* <filename, path> of all yang files */
+};
+static struct yang_dir_cache *_yang_dir_cache = NULL;
+
+/*! Get cached <filename,path> listing of yang files under dir, rescan if changed
+ *
+ * @param[in]  dir       Directory path
+ * @param[in]  recursive If set, include files in subdirectories
+ * @param[out] cvvp      Listing on the form (filename, path)*. Owned by the
+ *                       cache: do not free. NULL if dir does not exist.
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+yang_dir_cache_get(const char *dir,
+                   int         recursive,
+                   cvec      **cvvp)
+{
+    int                    retval = -1;
+    struct stat            st;
+    struct yang_dir_cache *yd;
+    struct dirent         *dp = NULL;
+    int                    ndp;
+    int                    i;
+    char                   path[MAXPATHLEN];
+
+    *cvvp = NULL;
+    if (stat(dir, &st) < 0){
+        if (errno == ENOENT)
+            goto ok; /* Missing dir: no matches, as the uncached scan */
+        clicon_err(OE_UNIX, errno, "stat(%s)", dir);
+        goto done;
+    }
+    for (yd = _yang_dir_cache; yd; yd = yd->yd_next)
+        if (yd->yd_recursive == recursive &&
+            strcmp(yd->yd_dir, dir) == 0)
+            break;
+    if (yd != NULL &&
+        yd->yd_mtime.tv_sec == st.st_mtim.tv_sec &&
+        yd->yd_mtime.tv_nsec == st.st_mtim.tv_nsec){
+        *cvvp = yd->yd_files; /* cache hit */
+        goto ok;
+    }
+    if (yd == NULL){
+        if ((yd = calloc(1, sizeof(*yd))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((yd->yd_dir = strdup(dir)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            free(yd);
+            goto done;
+        }
+        yd->yd_recursive = recursive;
+        yd->yd_next = _yang_dir_cache;
+        _yang_dir_cache = yd;
+    }
+    else if (yd->yd_files){ /* stale: rescan */
+        cvec_free(yd->yd_files);
+        yd->yd_files = NULL;
+    }
+    if ((yd->yd_files = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (recursive){
+        if (clicon_files_recursive(dir, "(\\.yang)$", yd->yd_files) < 0)
+            goto done;
+    }
+    else{
+        if ((ndp = clicon_file_dirent(dir, &dp, "(\\.yang)$", S_IFREG)) < 0)
+            goto done;
+        for (i=0; i<ndp; i++){
+            snprintf(path, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
+            if (cvec_add_string(yd->yd_files, dp[i].d_name, path) < 0){
+                clicon_err(OE_UNIX, errno, "cvec_add_string");
+                goto done;
+            }
+        }
+    }
+    yd->yd_mtime.tv_sec = st.st_mtim.tv_sec;
+    yd->yd_mtime.tv_nsec = st.st_mtim.tv_nsec;
+    *cvvp = yd->yd_files;
+ ok:
+    retval = 0;
+ done:
+    if (dp)
+        free(dp);
+    return retval;
+}
+
+/*! Match a yang filename against a module name and optional revision
+ *
+ * RFC 6020: The name of the file SHOULD be of the form:
+ * module-or-submodule-name ['@' revision-date] ( '.yang' / '.yin' )
+ * revision-date ::= 4DIGIT "-" 2DIGIT "-" 2DIGIT
+ * @param[in]  name     Yang filename (without directory part)
+ * @param[in]  module   Name of YANG module
+ * @param[in]  revision Revision or NULL for any
+ * @retval     1        Match
+ * @retval     0        No match
+ */
+static int
+yang_filename_match(const char *name,
+                    const char *module,
+                    const char *revision)
+{
+    size_t      mlen;
+    size_t      rlen;
+    const char *p;
+    int         i;
+
+    mlen = strlen(module);
+    if (strncmp(name, module, mlen) != 0)
+        return 0;
+    p = name + mlen;
+    if (revision != NULL){
+        rlen = strlen(revision);
+        return p[0] == '@' &&
+            strncmp(p+1, revision, rlen) == 0 &&
+            strcmp(p+1+rlen, ".yang") == 0;
+    }
+    if (strcmp(p, ".yang") == 0)
+        return 1;
+    if (p[0] != '@')
+        return 0;
+    p++;
+    for (i=0; i<10; i++){ /* revision-date */
+        if (i==4 || i==7){
+            if (p[i] != '-')
+                return 0;
+        }
+        else if (!isdigit((unsigned char)p[i]))
+            return 0;
+    }
+    return strcmp(p+10, ".yang") == 0;
+}
+
+/*! No specific revision give. Match a yang file given module
  * @param[in]  h        CLICON handle
  * @param[in]  module   Name of main YANG module. 
  * @param[in]  revision Revision or NULL
@@ -919,10 +1080,10 @@ yang_parse_find_match(clicon_handle h,
                       cbuf         *fbuf)    
 {
     int           retval = -1;
-    cbuf         *regex = NULL;
     cxobj        *x;
     cxobj        *xc;
     char         *dir;
+    int           recursive;
     cvec         *cvv = NULL;
     cg_var       *cv = NULL;
     cg_var       *bestcv = NULL;
@@ -930,86 +1091,371 @@ yang_parse_find_match(clicon_handle h,
     /* get clicon config file in xml form */
     if ((x = clicon_conf_xml(h)) == NULL)
         goto ok;
-    if ((regex = cbuf_new()) == NULL){
-        clicon_err(OE_YANG, errno, "cbuf_new");
-        goto done;
-    }
-    /* RFC 6020: The name of the file SHOULD be of the form:
-     * module-or-submodule-name ['@' revision-date] ( '.yang' / '.yin' )
-     * revision-date ::= 4DIGIT "-" 2DIGIT "-" 2DIGIT
-     */
-    if (revision)
-        cprintf(regex, "^%s@%s(.yang)$", module, revision);
-    else
-        cprintf(regex, "^%s(@[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9])?(.yang)$",
-                module);
     xc = NULL;
-
     while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
-        if (strcmp(xml_name(xc), "CLICON_YANG_MAIN_DIR") == 0){
-            struct dirent *dp = NULL;
-            int ndp;
-
-            dir = xml_body(xc);
-            /* get all matching files in this directory */
-            if ((ndp = clicon_file_dirent(dir, 
-                                          &dp, 
-                                          cbuf_get(regex),
-                                          S_IFREG)) < 0)
-                goto done;
-            /* Entries are sorted, last entry should be most recent date 
-             */
-            if (ndp != 0){
-                cprintf(fbuf, "%s/%s", dir, dp[ndp-1].d_name);
-                if (dp)
-                    free(dp);
-                retval = 1;
-                goto done;
-            }
-            if (dp)
-                free(dp);
+        if (strcmp(xml_name(xc), "CLICON_YANG_MAIN_DIR") == 0)
+            recursive = 0;
+        else if (strcmp(xml_name(xc), "CLICON_YANG_DIR") == 0)
+            recursive = 1;
+        else
+            continue;
+        if ((dir = xml_body(xc)) == NULL)
+            continue;
+        /* Resolve against the cached directory listing, see yang_dir_cache_get.
+         * Entries are not sorted: find latest matching name, use path as
+         * return value */
+        if (yang_dir_cache_get(dir, recursive, &cvv) < 0)
+            goto done;
+        if (cvv == NULL)
+            continue;
+        bestcv = NULL;
+        cv = NULL;
+        while ((cv = cvec_each(cvv, cv)) != NULL){
+            if (yang_filename_match(cv_name_get(cv), module, revision) == 0)
+                continue;
+            if (bestcv == NULL ||
+                strcoll(cv_name_get(cv), cv_name_get(bestcv)) > 0)
+                bestcv = cv;
         }
-        else if (strcmp(xml_name(xc), "CLICON_YANG_DIR") == 0 &&
-                 (dir = xml_body(xc)) != NULL){
-            /* get all matching files in this directory recursively */
-            if ((cvv = cvec_new(0)) == NULL){
-                clicon_err(OE_UNIX, errno, "cvec_new");
-                goto done;
-            }
-            if (clicon_files_recursive(dir, cbuf_get(regex), cvv) < 0)
-                goto done;
-
-            /* Entries are not sorted and come in a vector: <name,path>.
-             * Find latest name and use path as return value
-             */
-            bestcv = NULL;
-            while ((cv = cvec_each(cvv, cv)) != NULL){
-                if (bestcv == NULL)
-                    bestcv = cv;
-                else if (strcoll(cv_name_get(cv), cv_name_get(bestcv)) > 0)
-                    bestcv = cv;
-            }
-            if (bestcv){
-                cprintf(fbuf, "%s", cv_string_get(bestcv));      /* file path */
-                retval = 1; /* found */
-                goto done;
-            }
-            if (cvv){
-                cvec_free(cvv);
-                cvv = NULL;
-            }
+        if (bestcv){
+            cprintf(fbuf, "%s", cv_string_get(bestcv));      /* file path */
+            retval = 1; /* found */
+            goto done;
         }
     }
 ok:
     retval = 0;
 done:
-    if (cvv)
-        cvec_free(cvv);
-    if (regex)
-        cbuf_free(regex);
     return retval;
 }
 
+/*
+ * Compiled-yang cache
+ * Every process (backend, cli, netconf, restconf) lex+yacc:s every .yang file
+ * at startup. When a cache dir is configured (CLICON_YANG_CACHE_DIR, see
+ * yang_cache_dir_set) the statement tree of each parsed file is written as a
+ * binary image and subsequent starts rebuild the tree from it without running
+ * the scanner/parser. Per-statement sub-parsing (ys_parse_sub) and all later
+ * resolve/populate passes still run, so semantics are identical to a parse.
+ * An entry is keyed by source file size and mtime and carries a format
+ * version; any mismatch falls back to a normal parse and rewrites the entry.
+ */
+#define YANG_CACHE_MAGIC   0x43594e47 /* "CYNG" */
+#define YANG_CACHE_VERSION 1
+
+struct yang_cache_hdr{
+    uint32_t ych_magic;
+    uint32_t ych_version;
+    uint64_t ych_size;   /* source file size */
+    uint64_t ych_mtime;  /* source file modification time (seconds) */
+};
+
+static char *_yang_cache_dir = NULL;
+
+/*! Set (or disable) the directory for the compiled-yang cache
+ *
+ * Global setting, no handle in the yang parse functions, see
+ * xpath_list_optimize_set for precedent.
+ * @param[in]  dir  Cache directory, or NULL to disable
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+yang_cache_dir_set(const char *dir)
+{
+    if (_yang_cache_dir){
+        free(_yang_cache_dir);
+        _yang_cache_dir = NULL;
+    }
+    if (dir && (_yang_cache_dir = strdup(dir)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Map a yang source filename to its cache filename
+ *
+ * The full source path is mangled ('/' -> '%') so files with the same
+ * basename in different yang dirs get distinct entries.
+ */
+static int
+yang_cache_filename(const char *filename,
+                    cbuf      **cbp)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *p;
+    int   start;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/", _yang_cache_dir);
+    start = cbuf_len(cb);
+    cprintf(cb, "%s.yc", filename);
+    for (p = cbuf_get(cb)+start; *p; p++)
+        if (*p == '/')
+            *p = '%';
+    *cbp = cb;
+    cb = NULL;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Write a length-prefixed string to the cache file, NULL is encoded as ~0 */
+static int
+yang_cache_put_str(FILE       *f,
+                   const char *s)
+{
+    uint32_t len;
+
+    len = s ? (uint32_t)strlen(s) : UINT32_MAX;
+    if (fwrite(&len, sizeof(len), 1, f) != 1)
+        return -1;
+    if (s && len && fwrite(s, 1, len, f) != len)
+        return -1;
+    return 0;
+}
+
+/*! Read a length-prefixed string from the cache file, malloced, NULL if encoded so */
+static int
+yang_cache_get_str(FILE  *f,
+                   char **sp)
+{
+    uint32_t len;
+    char    *s;
+
+    *sp = NULL;
+    if (fread(&len, sizeof(len), 1, f) != 1)
+        return -1;
+    if (len == UINT32_MAX)
+        return 0;
+    if (len > UINT32_MAX/2) /* sanity: corrupt entry */
+        return -1;
+    if ((s = malloc(len+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    if (len && fread(s, 1, len, f) != len){
+        free(s);
+        return -1;
+    }
+    s[len] = '\0';
+    *sp = s;
+    return 0;
+}
+
+/*! Write one yang statement and its sub-statements to the cache file
+ *
+ * Per node: keyword, line number, number of children, argument, and for
+ * unknown statements the extra argument string kept in the cv (see
+ * ys_parse_sub), then the children recursively in order.
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_cache_put_node(FILE      *f,
+                    yang_stmt *ys)
+{
+    uint16_t   kw;
+    uint32_t   linenum;
+    uint32_t   nr = 0;
+    yang_stmt *yc = NULL;
+    char      *extra = NULL;
+    cg_var    *cv;
+
+    kw = (uint16_t)yang_keyword_get(ys);
+    linenum = (uint32_t)yang_linenum_get(ys);
+    while ((yc = yn_each(ys, yc)) != NULL)
+        nr++;
+    if (fwrite(&kw, sizeof(kw), 1, f) != 1 ||
+        fwrite(&linenum, sizeof(linenum), 1, f) != 1 ||
+        fwrite(&nr, sizeof(nr), 1, f) != 1)
+        return -1;
+    if (yang_cache_put_str(f, yang_argument_get(ys)) < 0)
+        return -1;
+    if (yang_keyword_get(ys) == Y_UNKNOWN &&
+        (cv = yang_cv_get(ys)) != NULL)
+        extra = cv_string_get(cv);
+    if (yang_cache_put_str(f, extra) < 0)
+        return -1;
+    yc = NULL;
+    while ((yc = yn_each(ys, yc)) != NULL)
+        if (yang_cache_put_node(f, yc) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Read one yang statement and its sub-statements from the cache file
+ *
+ * Rebuilds the node under yp the same way ysp_add does from the parser:
+ * create, set argument and line number, insert under parent, then run the
+ * per-statement checks (ys_parse_sub) before the children are read.
+ * @param[in]  f        Cache file positioned at a node
+ * @param[in]  yp       Parent yang node to insert under
+ * @param[in]  filename Source yang filename, for errors
+ * @retval     ys       Created yang statement
+ * @retval     NULL     Error or corrupt entry, partial node removed
+ */
+static yang_stmt *
+yang_cache_get_node(FILE       *f,
+                    yang_stmt  *yp,
+                    const char *filename)
+{
+    yang_stmt *ys = NULL;
+    uint16_t   kw;
+    uint32_t   linenum;
+    uint32_t   nr;
+    uint32_t   i;
+    char      *arg = NULL;
+    char      *extra = NULL;
+
+    if (fread(&kw, sizeof(kw), 1, f) != 1 ||
+        fread(&linenum, sizeof(linenum), 1, f) != 1 ||
+        fread(&nr, sizeof(nr), 1, f) != 1)
+        goto fail;
+    if (yang_cache_get_str(f, &arg) < 0 ||
+        yang_cache_get_str(f, &extra) < 0)
+        goto fail;
+    if ((ys = ys_new(kw)) == NULL)
+        goto fail;
+    yang_argument_set(ys, arg); /* consumed */
+    arg = NULL;
+    yang_linenum_set(ys, linenum);
+    if (yn_insert(yp, ys) < 0)
+        goto fail;
+    if (ys_parse_sub(ys, filename, extra) < 0){ /* frees extra */
+        extra = NULL;
+        goto fail;
+    }
+    extra = NULL;
+    for (i = 0; i < nr; i++)
+        if (yang_cache_get_node(f, ys, filename) == NULL)
+            goto fail;
+    return ys;
+ fail:
+    if (ys){
+        ys_prune_self(ys);
+        ys_free(ys);
+    }
+    if (arg)
+        free(arg);
+    if (extra)
+        free(extra);
+    return NULL;
+}
+
+/*! Try to load a yang file from the compiled cache
+ *
+ * @param[in]  filename Source yang filename
+ * @param[in]  st       Stat of the source file, for the cache key
+ * @param[in]  yspec    Yang specification to insert the module under
+ * @retval     ymod     Top-level yang (sub)module rebuilt from the cache
+ * @retval     NULL     Cache miss, stale or corrupt entry: caller parses
+ */
+static yang_stmt *
+yang_cache_load(const char  *filename,
+                struct stat *st,
+                yang_stmt   *yspec)
+{
+    yang_stmt            *ymod = NULL;
+    cbuf                 *cb = NULL;
+    FILE                 *f = NULL;
+    struct yang_cache_hdr hdr;
+
+    if (yang_cache_filename(filename, &cb) < 0)
+        goto done;
+    if ((f = fopen(cbuf_get(cb), "r")) == NULL)
+        goto done; /* miss */
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        hdr.ych_magic != YANG_CACHE_MAGIC ||
+        hdr.ych_version != YANG_CACHE_VERSION ||
+        hdr.ych_size != (uint64_t)st->st_size ||
+        hdr.ych_mtime != (uint64_t)st->st_mtime)
+        goto done; /* stale or foreign entry */
+    if ((ymod = yang_cache_get_node(f, yspec, filename)) == NULL){
+        clicon_log(LOG_NOTICE, "Corrupt yang cache entry %s: reparsing", cbuf_get(cb));
+        goto done;
+    }
+    if (yang_filename_set(ymod, filename) < 0){
+        ys_prune_self(ymod);
+        ys_free(ymod);
+        ymod = NULL;
+        goto done;
+    }
+    clicon_debug(1, "%s %s: yang cache hit", __FUNCTION__, filename);
+ done:
+    if (f)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    return ymod;
+}
+
+/*! Write the statement tree of a parsed yang file to the compiled cache
+ *
+ * Best effort: failure to write is logged and ignored, the tree in memory is
+ * complete regardless. Written via a temp file and rename so a concurrently
+ * starting process never sees a half-written entry.
+ * @param[in]  filename Source yang filename
+ * @param[in]  st       Stat of the source file, for the cache key
+ * @param[in]  ymod     Parsed top-level yang (sub)module
+ * @retval     0        OK (including ignored write failure)
+ */
+static int
+yang_cache_store(const char  *filename,
+                 struct stat *st,
+                 yang_stmt   *ymod)
+{
+    cbuf                 *cb = NULL;
+    cbuf                 *cbtmp = NULL;
+    FILE                 *f = NULL;
+    struct yang_cache_hdr hdr = {0,};
+
+    if (yang_cache_filename(filename, &cb) < 0)
+        goto done;
+    if ((cbtmp = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbtmp, "%s.%u", cbuf_get(cb), getpid());
+    if ((f = fopen(cbuf_get(cbtmp), "w")) == NULL){
+        clicon_log(LOG_NOTICE, "yang cache: fopen(%s): %s", cbuf_get(cbtmp), strerror(errno));
+        goto done;
+    }
+    hdr.ych_magic = YANG_CACHE_MAGIC;
+    hdr.ych_version = YANG_CACHE_VERSION;
+    hdr.ych_size = (uint64_t)st->st_size;
+    hdr.ych_mtime = (uint64_t)st->st_mtime;
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+        yang_cache_put_node(f, ymod) < 0){
+        clicon_log(LOG_NOTICE, "yang cache: write %s failed", cbuf_get(cbtmp));
+        fclose(f);
+        f = NULL;
+        unlink(cbuf_get(cbtmp));
+        goto done;
+    }
+    fclose(f);
+    f = NULL;
+    if (rename(cbuf_get(cbtmp), cbuf_get(cb)) < 0){
+        clicon_log(LOG_NOTICE, "yang cache: rename(%s): %s", cbuf_get(cb), strerror(errno));
+        unlink(cbuf_get(cbtmp));
+    }
+ done:
+    if (f)
+        fclose(f);
+    if (cbtmp)
+        cbuf_free(cbtmp);
+    if (cb)
+        cbuf_free(cb);
+    return 0;
+}
+
 /*! Open a file, read into a string and invoke yang parsing
  *
  * Similar to clicon_yang_str(), just read a file first
@@ -1034,12 +1480,17 @@ yang_parse_filename(const char *filename,
         clicon_err(OE_YANG, errno, "%s not found", filename);
         goto done;
     }
+    if (_yang_cache_dir &&
+        (ymod = yang_cache_load(filename, &st, yspec)) != NULL)
+        goto done; /* rebuilt from compiled cache, no lex/yacc */
     if ((fp = fopen(filename, "r")) == NULL){
-        clicon_err(OE_YANG, errno, "fopen(%s)", filename);      
+        clicon_err(OE_YANG, errno, "fopen(%s)", filename);
         goto done;
     }
     if ((ymod = yang_parse_file(fp, filename, yspec)) < 0)
         goto done;
+    if (_yang_cache_dir && ymod != NULL)
+        yang_cache_store(filename, &st, ymod); /* best effort */
   done:
     if (fp)
         fclose(fp);
@@ -1437,6 +1888,247 @@ yang_sort_modules(yang_stmt          *yspec,
     return retval;
 }
 
+/*! Recursively prune documentation-only statements from a yang tree
+ *
+ * Removes description, reference, organization and contact statements, which
+ * dominate the memory footprint of a resolved spec but have no runtime
+ * semantics for backend/netconf/restconf processes. Must not be enabled for
+ * CLI processes: the autocli generates help texts from descriptions.
+ * @param[in]  yn  Yang statement, pruned recursively
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see yang_parse_post  where this runs as a last pass when enabled
+ */
+static int
+yang_prune_doc(yang_stmt *yn)
+{
+    yang_stmt *yc;
+    int        i;
+
+    for (i = 0; i < yang_len_get(yn); ){
+        yc = yang_child_i(yn, i);
+        switch (yang_keyword_get(yc)){
+        case Y_DESCRIPTION:
+        case Y_REFERENCE:
+        case Y_ORGANIZATION:
+        case Y_CONTACT:
+            ys_prune(yn, i);
+            ys_free(yc);
+            continue; /* same index now holds the next child */
+        default:
+            break;
+        }
+        if (yang_prune_doc(yc) < 0)
+            return -1;
+        i++;
+    }
+    return 0;
+}
+
+/*! Check if a yang subtree contains a typedef anywhere
+ *
+ * Resolved type caches hold direct pointers to type statements, which may sit
+ * inside typedefs in grouping bodies, see yang_type_cache_set. Such subtrees
+ * must stay resident even after the grouping has been expanded.
+ * @param[in]  ys  Yang statement
+ * @retval     1   ys or a descendant is a typedef
+ * @retval     0   No typedef in the subtree
+ */
+static int
+yang_subtree_has_typedef(yang_stmt *ys)
+{
+    int i;
+
+    if (yang_keyword_get(ys) == Y_TYPEDEF)
+        return 1;
+    for (i = 0; i < yang_len_get(ys); i++)
+        if (yang_subtree_has_typedef(yang_child_i(ys, i)))
+            return 1;
+    return 0;
+}
+
+/*! Recursively drop expanded grouping bodies
+ *
+ * After yang_expand_grouping all uses statements hold their own copy of the
+ * grouping body, so the original body is dead weight. The grouping shell and
+ * any subtree containing typedefs are kept: the shell since cardinality
+ * requires it, typedefs since type caches point into them,
+ * see yang_subtree_has_typedef.
+ * @param[in]  yn  Yang statement, recursed
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+yang_compact1(yang_stmt *yn)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    int        i;
+    int        j;
+
+    for (i = 0; i < yang_len_get(yn); i++){
+        ys = yang_child_i(yn, i);
+        if (yang_keyword_get(ys) == Y_GROUPING){
+            for (j = 0; j < yang_len_get(ys); ){
+                yc = yang_child_i(ys, j);
+                if (yang_subtree_has_typedef(yc)){
+                    j++;
+                    continue;
+                }
+                ys_prune(ys, j);
+                ys_free(yc);
+            }
+            continue;
+        }
+        if (yang_compact1(ys) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Compact a fully loaded yang specification to reduce resident memory
+ *
+ * Drops statement subtrees that no runtime path reads:
+ * - documentation statements, see yang_prune_doc
+ * - revision history except the newest revision, which module-state,
+ *   capabilities and the xmldb modstate code still read
+ * - expanded grouping bodies, see yang_compact1
+ * May only be called when module loading is complete: later loaded modules
+ * could otherwise expand uses against an emptied grouping. For the same reason
+ * this is not run from yang_parse_post, which is invoked once per module batch.
+ * Not for CLI processes: the autocli generates help texts from descriptions.
+ * @param[in]  h      Clicon handle
+ * @param[in]  yspec  Yang specification
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see yang_prune_doc  Option CLICON_YANG_PRUNE_DOC for doc statements only
+ */
+int
+yang_compact(clicon_handle h,
+             yang_stmt    *yspec)
+{
+    int        retval = -1;
+    yang_stmt *ym = NULL;
+    yang_stmt *ys;
+    int        i;
+    int        revisions;
+
+    while ((ym = yn_each(yspec, ym)) != NULL){
+        if (yang_prune_doc(ym) < 0)
+            goto done;
+        revisions = 0;
+        for (i = 0; i < yang_len_get(ym); ){
+            ys = yang_child_i(ym, i);
+            if (yang_keyword_get(ys) == Y_REVISION &&
+                revisions++ > 0){ /* keep the newest == first */
+                ys_prune(ym, i);
+                ys_free(ys);
+                continue;
+            }
+            i++;
+        }
+        if (yang_compact1(ym) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check whether an xpath can only reference the context node's own subtree
+ *
+ * Conservative textual test used by the cross-reference analysis: an xpath
+ * is self-contained if it cannot escape the subtree of its context node.
+ * Anything absolute, climbing (..), using explicit axes, current() or
+ * deref() is treated as escaping. False negatives only cost extra
+ * validation.
+ * @param[in] xpath  Xpath string, NULL means no expression (self-contained)
+ * @retval    1      Xpath stays within the context node's subtree
+ * @retval    0      Xpath may reference other parts of the tree
+ */
+static int
+xpath_self_contained(char *xpath)
+{
+    if (xpath == NULL)
+        return 1;
+    if (*xpath == '/')
+        return 0;
+    if (strstr(xpath, "..") != NULL ||
+        strstr(xpath, "::") != NULL ||
+        strstr(xpath, "current(") != NULL ||
+        strstr(xpath, "deref(") != NULL)
+        return 0;
+    return 1;
+}
+
+/*! Mark yang subtrees containing cross-referencing constructs
+ *
+ * Sets YANG_FLAG_XREF on every node whose subtree contains a construct that
+ * can reference data outside the subtree: a when (including the augment/uses
+ * associated when, see yang_when_xpath_get) or must whose xpath is not
+ * self-contained, a leafref, or an instance-identifier. Only such subtrees
+ * can be invalidated by edits made elsewhere in the tree, which is what
+ * incremental validation relies on, see xml_yang_validate_changed.
+ * When/must xpaths that cannot escape their context node (no leading /, no
+ * .., no axes or deref/current) are excluded: their result only depends on
+ * the subtree whose change already flags the ancestors.
+ * Run over the complete spec after augment/deviation since those move and
+ * remove statements. A deviation deleting a must may leave a stale flag,
+ * which only costs extra validation.
+ * @param[in] ys   Yang statement
+ * @retval    1    Subtree contains a cross-referencing construct (flag set)
+ * @retval    0    Subtree is self-contained
+ * @retval   -1    Error
+ */
+static int
+yang_xref_mark(yang_stmt *ys)
+{
+    int           xref = 0;
+    int           ret;
+    yang_stmt    *yc = NULL;
+    yang_stmt    *yrestype = NULL;
+    enum rfc_6020 kw;
+
+    kw = yang_keyword_get(ys);
+    if (kw == Y_WHEN || kw == Y_MUST)
+        xref = !xpath_self_contained(yang_argument_get(ys));
+    else if (kw == Y_LEAF || kw == Y_LEAF_LIST){
+        if (yang_type_get(ys, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+            return -1;
+        if (yrestype &&
+            (strcmp(yang_argument_get(yrestype), "leafref") == 0 ||
+             strcmp(yang_argument_get(yrestype), "instance-identifier") == 0))
+            xref = 1;
+    }
+    /* The when-condition of an augment/uses is hooked onto the data nodes and
+     * is evaluated in the parent context, so it escapes the node's own subtree
+     * even when textually relative: always a cross-reference
+     */
+    if (xref == 0 && yang_when_xpath_get(ys) != NULL)
+        xref = 1;
+    while ((yc = yn_each(ys, yc)) != NULL){
+        if ((ret = yang_xref_mark(yc)) < 0)
+            return -1;
+        if (ret == 1)
+            xref = 1;
+    }
+    if (xref)
+        yang_flag_set(ys, YANG_FLAG_XREF);
+    return xref;
+}
+
+/*! Microseconds between two timestamps, helper for the phase report in yang_parse_post
+ */
+static uint64_t
+tv_us(struct timeval *t0,
+      struct timeval *t1)
+{
+    struct timeval td;
+
+    timersub(t1, t0, &td);
+    return td.tv_sec*1000000 + td.tv_usec;
+}
+
 /*! Parse top yang module including all its sub-modules. Expand and populate yang tree
  *
  * Perform secondary actions after yang parsing. These actions cannot be made at
@@ -1452,7 +2144,9 @@ yang_sort_modules(yang_stmt          *yspec,
  * Therefore, after full loading, a topological sort is made to ensure the modules are 
  * non-circular (a DAG) and that the rest of the operations are made in the topology order.
  * The loading order of the yang models (under yang spec) is kept.
- * 
+ * Per-phase wallclock timings are logged at debug level 1, see clixon_util_yang
+ * for a benchmark driver.
+ *
  * @param[in] h      CLICON handle
  * @param[in] yspec  Yang specification. 
  * @param[in] modmin Perform checks after this number, prior are already complete
@@ -1469,15 +2163,18 @@ yang_parse_post(clicon_handle h,
     int                modmax;
     struct yang_stmt **ylist = NULL; /* Topology sorted modules */
     int                ylen = 0;     /* Length of ylist */
-    
-    /* 1: Parse from text to yang parse-tree. 
+    struct timeval     tvv[7];       /* Phase timestamps, logged at debug level 1 */
+
+    gettimeofday(&tvv[0], NULL);
+    /* 1: Parse from text to yang parse-tree.
      * Iterate through modules and detect module/submodules to parse
      * NOTE: the list may grow on each iteration */
     for (i=modmin; i<yang_len_get(yspec); i++)
         if (yang_parse_recurse(h, yang_child_i(yspec, i), yspec) < 0)
             goto done;
-    
+
     modmax = yang_len_get(yspec);
+    gettimeofday(&tvv[1], NULL);
     /* The set of modules [modmin..maxmax] is here complete wrt imports/includes and is a DAG
      * Example: A imports B, C and D, and C and D imports B
      * In some operations below (eg augment) need to be in topology order, eg B first.
@@ -1501,6 +2198,7 @@ yang_parse_post(clicon_handle h,
         if (yang_apply(yang_child_i(yspec, i), -1, ys_populate, 0, (void*)h) < 0)
             goto done;
     }
+    gettimeofday(&tvv[2], NULL);
 
     /* 5: Resolve all types: populate type caches. Requires eg length/range cvecs
      * from ys_populate step.
@@ -1509,8 +2207,9 @@ yang_parse_post(clicon_handle h,
     for (i=modmin; i<modmax; i++)
         if (yang_apply(yang_child_i(yspec, i), Y_TYPE, ys_resolve_type, 1, h) < 0)
             goto done;
+    gettimeofday(&tvv[3], NULL);
 
-    /* Up to here resolving is made in the context they are defined, rather 
+    /* Up to here resolving is made in the context they are defined, rather
      * than the context they are used (except for submodules being merged w 
      * modules). Like static scoping. 
      * After this we expand all grouping/uses and unfold all macros into a
@@ -1523,8 +2222,9 @@ yang_parse_post(clicon_handle h,
             goto done;
         yang_apply(ylist[i], -1, (yang_applyfn_t*)yang_flag_reset, 1, (void*)YANG_FLAG_MARK);
     }
+    gettimeofday(&tvv[4], NULL);
 
-    /* 7: Top-level augmentation of all modules. 
+    /* 7: Top-level augmentation of all modules.
      * Note: Clixon does not implement augment in USES 
      * Note: There is an ordering problem, where an augment in one module depends on an augment in
      * another module not yet augmented.
@@ -1532,8 +2232,9 @@ yang_parse_post(clicon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_augment_module(h, ylist[i]) < 0)
             goto done;
+    gettimeofday(&tvv[5], NULL);
 
-    /* 8: Check deviations: not-supported add/delete/replace statements 
+    /* 8: Check deviations: not-supported add/delete/replace statements
      *    done late since eg groups must be expanded
      */
     for (i=modmin; i<modmax; i++) /* Really only under (sub)modules no need to traverse whole tree */
@@ -1562,6 +2263,26 @@ yang_parse_post(clicon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+    /* 11b. Mark cross-referencing subtrees for incremental validation.
+     *      Over the whole spec since augments may target earlier modules
+     */
+    for (i=0; i<yang_len_get(yspec); i++)
+        if (yang_xref_mark(yang_child_i(yspec, i)) < 0)
+            goto done;
+    /* 12. Optionally prune documentation-only statements to reduce the
+     *     resident size of the resolved spec, see CLICON_YANG_PRUNE_DOC */
+    if (clicon_option_bool(h, "CLICON_YANG_PRUNE_DOC"))
+        for (i=0; i<ylen; i++)
+            if (yang_prune_doc(ylist[i]) < 0)
+                goto done;
+    gettimeofday(&tvv[6], NULL);
+    clicon_debug(1, "%s: modules:%d us parse:%" PRIu64 " populate:%" PRIu64
+                 " resolve:%" PRIu64 " expand:%" PRIu64 " augment:%" PRIu64
+                 " post:%" PRIu64,
+                 __FUNCTION__, modmax-modmin,
+                 tv_us(&tvv[0], &tvv[1]), tv_us(&tvv[1], &tvv[2]),
+                 tv_us(&tvv[2], &tvv[3]), tv_us(&tvv[3], &tvv[4]),
+                 tv_us(&tvv[4], &tvv[5]), tv_us(&tvv[5], &tvv[6]));
     retval = 0;
  done:
     if (ylist)
@@ -1927,7 +2648,9 @@ ys_parse_sub(yang_stmt  *ys,
         break;
     case Y_MUST:
     case Y_WHEN:
-        if (xpath_parse(yang_argument_get(ys), NULL) < 0)
+        /* Compile the xpath once and cache it on ys, reused at validation,
+         * see yang_xptree_get. Doubles as syntax check. */
+        if (yang_xptree_get(ys) == NULL)
             goto done;
         break;
     case Y_REVISION:
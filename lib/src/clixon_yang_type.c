@@ -57,9 +57,8 @@
  * 2) Cache of regex is set in ys_cv_validate - not in ys_reolve_parse
  *    This is because trees are copied in yang_parse_post after ys_reolve_type
  *    is called, and regexps (void*) cannot be copied (COMPLEX)
- * 3) We know I think when cache is set and when it is not set in the calls
- *    to yang_type_resolve. maybe we should make code easier by a separate
- *    yang_type_resolve_cache() call?
+ * 3) Resolution is memoized inside yang_type_resolve at first full resolution,
+ *    so a type statement never re-walks its typedef chain once resolved
  */
 
 #ifdef HAVE_CONFIG_H
@@ -161,6 +160,59 @@ static const map_str2int ytmap2[] = {
     {NULL,         -1}
 };
 
+/*
+ * Scratch cv pool
+ * Leaf validation duplicates or creates a cg_var per validated value and
+ * frees it immediately after: one malloc/free pair per leaf, millions in a
+ * full validation of a large datastore. Keep a small free list of cg_var
+ * objects that are reset and reused instead. Clixon is single-threaded (one
+ * event loop) so a process-global pool needs no locking; the pool depth is
+ * bounded by leafref/union validation recursion.
+ */
+#define CV_POOL_NR 8
+static cg_var *_cv_pool[CV_POOL_NR] = {0,};
+static int     _cv_pool_len = 0;
+
+/*! Get a scratch cg_var from the pool
+ * @param[in] type  cv type, use CGV_ERR if overwritten with cv_cp afterwards
+ * @retval    cv    Scratch variable, release with clixon_cv_pool_put
+ * @retval    NULL  Error
+ * @see clixon_cv_pool_put
+ */
+cg_var *
+clixon_cv_pool_get(enum cv_type type)
+{
+    cg_var *cv;
+
+    if (_cv_pool_len > 0){
+        cv = _cv_pool[--_cv_pool_len];
+        cv_type_set(cv, type);
+    }
+    else if ((cv = cv_new(type)) == NULL)
+        clicon_err(OE_UNIX, errno, "cv_new");
+    return cv;
+}
+
+/*! Return a scratch cg_var to the pool
+ * The variable is reset, which frees malloced values but keeps the object
+ * for reuse. Frees the object if the pool is full.
+ * @param[in] cv  Scratch variable from clixon_cv_pool_get, or NULL
+ * @retval    0   OK
+ * @see clixon_cv_pool_get
+ */
+int
+clixon_cv_pool_put(cg_var *cv)
+{
+    if (cv == NULL)
+        return 0;
+    cv_reset(cv);
+    if (_cv_pool_len < CV_POOL_NR)
+        _cv_pool[_cv_pool_len++] = cv;
+    else
+        cv_free(cv);
+    return 0;
+}
+
 /* return 1 if built-in, 0 if not */
 static int
 yang_builtin(char *type)
@@ -246,8 +298,11 @@ ys_resolve_type(yang_stmt    *ys,
        clicon_err(OE_UNIX, errno, "cvec_new");
        goto done;
     }
-    /* Recursively resolve ys -> resolve with restrictions(options, etc) 
+    /* Recursively resolve ys -> resolve with restrictions(options, etc)
      * Note that the resolved type could be ys itself.
+     * The resolution is memoized on ys as a side-effect since all outputs are
+     * requested, see yang_type_resolve. Compiled regexps are still added later
+     * at first validation since compiling needs a clicon_handle.
      */
     if (yang_type_resolve(yang_parent_get(ys), yang_parent_get(ys),
                           ys, &resolved,
@@ -257,12 +312,6 @@ ys_resolve_type(yang_stmt    *ys,
         clicon_err(OE_YANG, 0, "result-type should not be NULL");
         goto done;
     }
-    /* Cache the type resolving locally. Only place where this is done. 
-     * Why not do it in yang_type_resolve? (compile regexps needs clicon_handle)
-     */
-    if (yang_type_cache_set(ys, resolved, options, cvv,
-                            patterns, fraction) < 0)
-        goto done;
     retval = 0;
  done:
     if (patterns)
@@ -556,7 +605,6 @@ cv_validate1(clicon_handle h,
     cg_var         *cv1;
     cg_var         *cv2;
     int             ret;
-    yang_stmt      *yi = NULL;
     char           *str = NULL;
     int             found;
     char          **vec = NULL;
@@ -668,17 +716,11 @@ cv_validate1(clicon_handle h,
         if (restype){
             if (strcmp(restype, "enumeration") == 0){
                 found = 0;
-                yi = NULL;
                 if (str != NULL) {
                     //              str = clixon_trim2(str, " \t\n"); /* May be misplaced, strip earlier? */
-                    while ((yi = yn_each(yrestype, yi)) != NULL){
-                        if (yang_keyword_get(yi) != Y_ENUM)
-                            continue;
-                        if (strcmp(yang_argument_get(yi), str) == 0){
-                            found++;
-                            break;
-                        }
-                    }
+                    /* Hash probe for large enumerations, see ys_find_hash_get */
+                    if (yang_find(yrestype, Y_ENUM, str) != NULL)
+                        found++;
                 }
                 if (!found){
                     if (reason)
@@ -699,15 +741,8 @@ cv_validate1(clicon_handle h,
                     if ((v = vec[i]) == NULL || !strlen(v))
                         continue;
                     found = 0;
-                    yi = NULL;
-                    while ((yi = yn_each(yrestype, yi)) != NULL){
-                        if (yang_keyword_get(yi) != Y_BIT)
-                            continue;
-                        if (strcmp(yang_argument_get(yi), v) == 0){
-                            found++;
-                            break;
-                        }
-                    }
+                    if (yang_find(yrestype, Y_BIT, v) != NULL)
+                        found++;
                     if (!found){
                         if (reason)
                             *reason = cligen_reason("'%s' does not match enumeration", v);
@@ -778,9 +813,11 @@ ys_cv_validate_leafref(clicon_handle h,
         clicon_err(OE_YANG, 0, "No referred YANG node found for leafref path %s", path_arg);
         goto done;
     }
-    /* reparse cv with new type */
-    if ((cv = cv_dup(yang_cv_get(yref))) == NULL){
-        clicon_err(OE_UNIX, errno, "cv_dup");
+    /* reparse cv with new type, scratch copy from the pool */
+    if ((cv = clixon_cv_pool_get(CGV_ERR)) == NULL)
+        goto done;
+    if (cv_cp(cv, yang_cv_get(yref)) < 0){
+        clicon_err(OE_UNIX, errno, "cv_cp");
         goto done;
     }
     if ((ret = cv_parse1(body, cv, reason)) < 0){
@@ -792,8 +829,7 @@ ys_cv_validate_leafref(clicon_handle h,
     /* Recursive call to this function, but using refererred YANG node */
     retval = ys_cv_validate(h, cv, yref, ysub, reason);
  done:
-    if (cv)
-        cv_free(cv);
+    clixon_cv_pool_put(cv);
     return retval;
  fail:
     retval = 0;
@@ -823,25 +859,36 @@ ys_cv_validate_union_one(clicon_handle h,
     yang_stmt   *yrestype;      /* union subtype */
     int          options = 0;
     cvec        *cvv = NULL;
-    cvec        *regexps = NULL;
-    cvec        *patterns = NULL;
-    uint8_t      fraction = 0; 
+    cvec        *regexps = NULL;   /* shared with type cache on cache hit */
+    cvec        *patterns = NULL;  /* shared with type cache on cache hit */
+    cvec        *regexps0 = NULL;  /* local fallback/compile buffer, freed here */
+    cvec        *patterns0 = NULL; /* local fallback, freed here */
+    uint8_t      fraction = 0;
     char        *restype;
     enum cv_type cvtype;
     cg_var      *cvt=NULL;
     yang_stmt   *ysubt = NULL;
+    int          ret;
 
-    if ((regexps = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
-        goto done;
-    }
-    if ((patterns = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
+    /* Fast path: member type data memoized on the type statement and shared, no copying */
+    if ((ret = yang_type_cache_get2(yt, &yrestype, &options, &cvv,
+                                    &patterns, NULL, &regexps, &fraction)) < 0)
         goto done;
+    if (ret == 0){ /* No cache: resolve from scratch which memoizes it, see yang_type_resolve */
+        if ((regexps0 = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((patterns0 = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if (yang_type_resolve(ys, ys, yt, &yrestype, &options, &cvv, patterns0, regexps0,
+                              &fraction) < 0)
+            goto done;
+        patterns = patterns0;
+        regexps = regexps0;
     }
-    if (yang_type_resolve(ys, ys, yt, &yrestype, &options, &cvv, patterns, regexps,
-                          &fraction) < 0)
-        goto done;
     if (yrestype == NULL){
         clicon_err(OE_YANG, 0, "result-type should not be NULL");
         goto done;
@@ -859,11 +906,9 @@ ys_cv_validate_union_one(clicon_handle h,
     else {
         if (clicon_type2cv(type, restype, ys, &cvtype) < 0)
             goto done;
-        /* reparse value with the new type */
-        if ((cvt = cv_new(cvtype)) == NULL){
-            clicon_err(OE_UNIX, errno, "cv_new");
+        /* reparse value with the new type, scratch cv from the pool */
+        if ((cvt = clixon_cv_pool_get(cvtype)) == NULL)
             goto done;
-        }
         if (cvtype == CGV_DEC64)
             cv_dec64_n_set(cvt, fraction);
         if (val == NULL){ /* Fail validation on NULL */
@@ -876,28 +921,33 @@ ys_cv_validate_union_one(clicon_handle h,
         }
         if (retval == 0)
             goto done;
-        /* The regexp cache may be invalidated, in that case re-compile
-         * eg due to copying
+        /* The regexp cache may be invalidated or not yet compiled, in that case
+         * compile here and extend the cache, shared by later validations
          */
-        if (cvec_len(patterns)!=0 && cvec_len(regexps)==0){
-            if (compile_pattern2regexp(h, patterns, regexps) < 1)
+        if (patterns && cvec_len(patterns) != 0 &&
+            (regexps == NULL || cvec_len(regexps) == 0)){
+            if (regexps0 == NULL && (regexps0 = cvec_new(0)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_new");
+                goto done;
+            }
+            if (compile_pattern2regexp(h, patterns, regexps0) < 1)
                 goto done;
             if (yang_type_cache_regexp_set(yt,
                                            clicon_yang_regexp(h),
-                                           regexps) < 0)
+                                           regexps0) < 0)
                 goto done;
+            regexps = regexps0;
         }
-        if ((retval = cv_validate1(h, cvt, cvtype, options, cvv, 
+        if ((retval = cv_validate1(h, cvt, cvtype, options, cvv,
                                    regexps, yrestype, restype, reason)) < 0)
             goto done;
     }
  done:
-    if (patterns)
-        cvec_free(patterns);
-    if (regexps)
-        cvec_free(regexps);
-    if (cvt)
-        cv_free(cvt);
+    if (patterns0)
+        cvec_free(patterns0);
+    if (regexps0)
+        cvec_free(regexps0);
+    clixon_cv_pool_put(cvt);
     return retval;
 }
 
@@ -924,11 +974,31 @@ ys_cv_validate_union(clicon_handle h,
 {
     int        retval = 1; /* valid */
     yang_stmt *yt = NULL;
+    yang_stmt *ymru;
     char      *reason1 = NULL;  /* saved reason */
 
+    /* Consecutive values of the same union type tend to match the same member
+     * (eg ip-address), try the most recently matched member first so bulk
+     * validation is one member trial per value instead of a full member scan.
+     */
+    if ((ymru = yang_union_mru_get(yrestype)) != NULL){
+        if ((retval = ys_cv_validate_union_one(h, ys, reason, ymru, type, val)) < 0)
+            goto done;
+        if (retval == 1){
+            if (ysubp)
+                *ysubp = ymru;
+            goto done;
+        }
+        if (retval == 0 && reason && *reason != NULL){
+            reason1 = *reason;
+            *reason = NULL;
+        }
+    }
     while ((yt = yn_each(yrestype, yt)) != NULL){
         if (yang_keyword_get(yt) != Y_TYPE)
             continue;
+        if (yt == ymru) /* Already tried above */
+            continue;
         if ((retval = ys_cv_validate_union_one(h, ys, reason, yt, type, val)) < 0)
             goto done;
         /* If validation failed, save reason, reset error and continue,
@@ -943,6 +1013,7 @@ ys_cv_validate_union(clicon_handle h,
         /* Enough that one type validates value, return that value
          */
         if (retval == 1) {
+            yang_union_mru_set(yrestype, yt);
             if (ysubp)
                 *ysubp = yt;
             break;
@@ -979,18 +1050,22 @@ ys_cv_validate(clicon_handle h,
                yang_stmt   **ysub, 
                char        **reason)
 {
-    int             retval = -1; 
-    cg_var         *ycv;        /* cv of yang-statement */  
+    int             retval = -1;
+    cg_var         *ycv;        /* cv of yang-statement */
     int             options = 0;
     cvec           *cvv = NULL;
-    cvec           *patterns = NULL;
-    cvec           *regexps = NULL;
+    cvec           *patterns = NULL;  /* shared with type cache on cache hit */
+    cvec           *regexps = NULL;   /* shared with type cache on cache hit */
+    cvec           *patterns0 = NULL; /* local fallback, freed here */
+    cvec           *regexps0 = NULL;  /* local fallback/compile buffer, freed here */
     enum cv_type    cvtype;
     char           *origtype = NULL;  /* orig type */
+    yang_stmt      *ytype;    /* type */
     yang_stmt      *yrestype; /* resolved type */
     char           *restype;
-    uint8_t         fraction = 0; 
+    uint8_t         fraction = 0;
     int             retval2;
+    int             ret;
     char           *val;
     cg_var         *cvt=NULL;
 
@@ -1001,19 +1076,35 @@ ys_cv_validate(clicon_handle h,
         goto done;
     }
     ycv = yang_cv_get(ys);
-    if ((regexps = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
+    if ((ytype = yang_find(ys, Y_TYPE, NULL)) == NULL){
+        clicon_err(OE_DB, ENOENT, "mandatory type object is not found");
         goto done;
     }
-    if ((patterns = cvec_new(0)) == NULL){
-        clicon_err(OE_UNIX, errno, "cvec_new");
+    /* Fast path: all type data memoized on the type statement and shared, no copying */
+    if ((ret = yang_type_cache_get2(ytype, &yrestype, &options, &cvv,
+                                    &patterns, NULL, &regexps, &fraction)) < 0)
         goto done;
+    if (ret == 1){
+        if (nodeid_split(yang_argument_get(ytype), NULL, &origtype) < 0)
+            goto done;
+    }
+    else { /* No cache: resolve from scratch which memoizes it, see yang_type_resolve */
+        if ((regexps0 = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if ((patterns0 = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if (yang_type_get(ys, &origtype, &yrestype,
+                          &options, &cvv,
+                          patterns0, regexps0,
+                          &fraction) < 0)
+            goto done;
+        patterns = patterns0;
+        regexps = regexps0;
     }
-    if (yang_type_get(ys, &origtype, &yrestype, 
-                      &options, &cvv,
-                      patterns, regexps,
-                      &fraction) < 0)
-        goto done;
     restype = yrestype?yang_argument_get(yrestype):NULL;
     if (clicon_type2cv(origtype, restype, ys, &cvtype) < 0)
         goto done;
@@ -1044,20 +1135,24 @@ ys_cv_validate(clicon_handle h,
         retval = retval2; /* invalid (0) with latest reason or valid 1 */
     }
     else{
-        /* The regexp cache may be invalidated, in that case re-compile
-         * eg due to copying
+        /* The regexp cache may be invalidated or not yet compiled, in that case
+         * compile here and extend the cache, shared by later validations
          */
-        if (cvec_len(patterns)!=0 && cvec_len(regexps)==0){
-            yang_stmt      *yt;
-            if (compile_pattern2regexp(h, patterns, regexps) < 1)
+        if (patterns && cvec_len(patterns) != 0 &&
+            (regexps == NULL || cvec_len(regexps) == 0)){
+            if (regexps0 == NULL && (regexps0 = cvec_new(0)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_new");
                 goto done;
-            yt = yang_find(ys, Y_TYPE, NULL);
-            if (yang_type_cache_regexp_set(yt,
+            }
+            if (compile_pattern2regexp(h, patterns, regexps0) < 1)
+                goto done;
+            if (yang_type_cache_regexp_set(ytype,
                                            clicon_yang_regexp(h),
-                                           regexps) < 0)
+                                           regexps0) < 0)
                 goto done;
+            regexps = regexps0;
         }
-        /* Leafref needs to resolve referred node for type information 
+        /* Leafref needs to resolve referred node for type information
          * From rfc7950 Sec 9.9:
          * The leafref built-in type is restricted to the value space of some
          * leaf or leaf-list node in the schema tree and optionally further
@@ -1088,17 +1183,17 @@ ys_cv_validate(clicon_handle h,
   done:
     if (origtype)
         free(origtype);
-    if (regexps)
-        cvec_free(regexps);
-    if (patterns)
-        cvec_free(patterns);
+    if (regexps0)
+        cvec_free(regexps0);
+    if (patterns0)
+        cvec_free(patterns0);
     if (cvt)
         cv_free(cvt);
     return retval;
 }
 
 /*
- * a typedef can be under module, submodule, container, list, grouping, rpc, 
+ * a typedef can be under module, submodule, container, list, grouping, rpc,
  * input, output, notification
  */
 static inline int
@@ -1326,23 +1421,14 @@ yang_type_resolve(yang_stmt   *yorig,
         *options = 0x0;
     *yrestype    = NULL; /* Initialization of resolved type that may not be necessary */
 
-    if (nodeid_split(yang_argument_get(ytype), &prefix, &type) < 0)
-        goto done;
-    /* Cache does not work for eg string length 32? */
-#if 1
+    /* Cache check before nodeid_split: a hit avoids the prefix/type mallocs */
     if ((ret = yang_type_cache_get(ytype, yrestype,
                                    options, cvv, patterns, NULL, regexps, fraction)) < 0)
         goto done;
     if (ret == 1)
         goto ok;
-#else
-    if (ytype->ys_typecache != NULL){
-        if (yang_type_cache_get(ytype, yrestype,
-                                options, cvv, patterns, NULL, regexps, fraction) < 0)
-            goto done;
-        goto ok;
-    }
-#endif
+    if (nodeid_split(yang_argument_get(ytype), &prefix, &type) < 0)
+        goto done;
     /* Check if type is basic type. If so, return that */
     if ((prefix == NULL && yang_builtin(type))){
         *yrestype = ytype; 
@@ -1399,6 +1485,15 @@ yang_type_resolve(yang_stmt   *yorig,
             goto done;
     }
   ok:
+    /* Memoize the resolution on ytype at first full resolution so that later calls
+     * never re-walk the typedef chain. Only done when all outputs are requested,
+     * otherwise the cache would be incomplete.
+     * Compiled regexps are added later at first validation, see yang_type_cache_regexp_set
+     */
+    if (ret == 0 && *yrestype != NULL &&
+        options && cvv && patterns && fraction &&
+        yang_type_cache_set(ytype, *yrestype, *options, *cvv, patterns, *fraction) < 0)
+        goto done;
     retval = 0;
   done:
 #if 1
@@ -1477,12 +1572,11 @@ yang_type_get(yang_stmt    *ys,
         goto done;
     }
     /* XXX: here we seem to have some problems if type is union */
-    if (nodeid_split(yang_argument_get(ytype), NULL, &type) < 0)
-        goto done;
-    if (origtype &&
-        (*origtype = strdup(type)) == NULL){
-        clicon_err(OE_XML, errno, "stdup");
-        goto done;
+    if (origtype){
+        if (nodeid_split(yang_argument_get(ytype), NULL, &type) < 0)
+            goto done;
+        *origtype = type; /* handover */
+        type = NULL;
     }
     if (yang_type_resolve(ys, ys, ytype, yrestype, 
                           options, cvv, patterns, regexps, fraction) < 0)
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# Test of the binary datastore format (CLICON_XMLDB_FORMAT=binary).
+# Round-trip a config with lists and leaf-lists through edit/commit, verify
+# the datastore file is actually binary (CXB magic), restart the backend from
+# the file and check the config survives, and compare get-config output
+# against the same config stored in the xml format.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/binfmt.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>init</CLICON_STARTUP_MODE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module binfmt {
+    yang-version 1.1;
+    namespace "urn:example:binfmt";
+    prefix bf;
+    container table {
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+            leaf-list array{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Config with a list, a leaf-list and characters that need XML escaping
+CONFIG='<table xmlns="urn:example:binfmt"><parameter><name>a</name><value>x&amp;y&lt;z</value><array>one</array><array>two</array><array>three</array></parameter><parameter><name>b</name><value>42</value></parameter></table>'
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -o CLICON_XMLDB_FORMAT=binary"
+    start_backend -s init -f $cfg -o CLICON_XMLDB_FORMAT=binary
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_XMLDB_FORMAT=binary" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$CONFIG</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_XMLDB_FORMAT=binary" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running_db file is binary (CXB magic)"
+magic=$(head -c 3 $dir/running_db)
+if [ "$magic" != "CXB" ]; then
+    err "CXB" "$magic"
+fi
+
+new "get-config of running from binary file"
+expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_XMLDB_FORMAT=binary" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$CONFIG</data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "restart backend -s running (decode binary datastore)"
+    stop_backend -f $cfg
+    start_backend -s running -f $cfg -o CLICON_XMLDB_FORMAT=binary
+
+    new "wait backend"
+    wait_backend
+
+    new "get-config of running after restart"
+    expecteof_netconf "$clixon_netconf -qf $cfg -o CLICON_XMLDB_FORMAT=binary" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$CONFIG</data></rpc-reply>"
+
+    new "Kill backend"
+    stop_backend -f $cfg
+
+    # Same config through the xml format must give the same get-config reply
+    new "start backend -s init -f $cfg (xml format)"
+    start_backend -s init -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "netconf edit-config (xml format)"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config>$CONFIG</config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit (xml format)"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get-config identical to the binary round-trip"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data>$CONFIG</data></rpc-reply>"
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+# Test: open-addressing hash table (clixon_hash.c)
+# Run the clixon_util_hash stress harness: add/delete/re-add cycles against
+# a shadow model, across rehashes and tombstone creation/reuse, verifying
+# every key's presence and value after each phase.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_hash:="clixon_util_hash"}
+
+new "hash small table, many rounds (tombstone reuse)"
+expectpart "$($clixon_util_hash -n 10 -r 100)" 0 "^$"
+
+new "hash grow across rehashes"
+expectpart "$($clixon_util_hash -n 10000 -r 3)" 0 "^$"
+
+new "hash default stress"
+expectpart "$($clixon_util_hash)" 0 "^$"
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,121 @@
+#!/usr/bin/env bash
+# Test of packed leaf-lists: leaf-lists with >= 64 uniform entries are
+# collapsed to a compact in-memory form in the datastore cache and
+# materialized transparently on access (see xml_leaflist_pack). Round-trip a
+# 100-entry leaf-list through edit/commit/get and a backend restart (the
+# restart re-reads and packs the file) and verify the output is identical
+# before and after packing, and that edits into the packed list work.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/llpack.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>init</CLICON_STARTUP_MODE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module llpack {
+    yang-version 1.1;
+    namespace "urn:example:llpack";
+    prefix lp;
+    container table {
+        leaf-list array{
+            type string;
+        }
+        leaf other{
+            type string;
+        }
+    }
+}
+EOF
+
+# 100 entries, above the 64-entry packing threshold; zero-padded so the
+# sorted order is the generation order
+ENTRIES=""
+for (( i=0; i<100; i++ )); do
+    ENTRIES+="<array>v$(printf %03d $i)</array>"
+done
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config: 100-entry leaf-list"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:llpack\">$ENTRIES<other>x</other></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config of running before packing (unpacked cache)"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:llpack\">$ENTRIES<other>x</other></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "restart backend -s running (file re-read, leaf-list packed in cache)"
+    stop_backend -f $cfg
+    start_backend -s running -f $cfg
+
+    new "wait backend"
+    wait_backend
+fi
+
+new "get-config of running after packing, identical output"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:llpack\">$ENTRIES<other>x</other></table></data></rpc-reply>"
+
+new "get with xpath into sibling of packed list"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/lp:table/lp:other\" xmlns:lp=\"urn:example:llpack\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:llpack\"><other>x</other></table></data></rpc-reply>"
+
+new "edit into the packed list: delete one entry, add one"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:llpack\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><array nc:operation=\"delete\">v000</array><array>v999</array></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+# Expected after edit: v000 gone, v999 appended at sorted end
+ENTRIES2=""
+for (( i=1; i<100; i++ )); do
+    ENTRIES2+="<array>v$(printf %03d $i)</array>"
+done
+ENTRIES2+="<array>v999</array>"
+
+new "get-config after edit into packed list"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:llpack\">$ENTRIES2<other>x</other></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
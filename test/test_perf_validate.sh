@@ -0,0 +1,112 @@
+#!/usr/bin/env bash
+# Validation performance benchmark using clixon_util_validate.
+# Generates a config with controllable counts of leafrefs, uniques, whens and
+# musts and runs timed repeated validation with a per-check-category time
+# breakdown (-p) to show where validation time goes.
+# No backend is started: clixon_util_validate validates the candidate db
+# directly against the generated YANG.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_validate:=clixon_util_validate}
+
+# Number of entries per constraint category
+: ${perfnr:=10000}
+# Number of validation laps
+: ${perflaps:=3}
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/valperf.yang
+
+cat <<EOF > $fyang
+module valperf{
+   yang-version 1.1;
+   namespace "urn:example:valperf";
+   prefix vp;
+   container servers {
+      list server {
+         key "name";
+         unique "addr port";
+         leaf name {
+            type string;
+         }
+         leaf addr {
+            type string;
+         }
+         leaf port {
+            type uint16;
+         }
+         leaf enabled {
+            type boolean;
+         }
+         container limits {
+            when "../enabled = 'true'";
+            leaf conns {
+               type uint32;
+               must ". > 0";
+            }
+         }
+      }
+   }
+   container clients {
+      list client {
+         key "name";
+         leaf name {
+            type string;
+         }
+         leaf server {
+            type leafref {
+               path "/vp:servers/vp:server/vp:name";
+            }
+         }
+      }
+   }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+# Generate candidate db: perfnr servers (each with unique tuple, when and
+# must constraints) and perfnr clients with leafrefs into the server list
+new "generate candidate with $perfnr servers and $perfnr leafref clients"
+candidate=$dir/candidate_db
+echo -n "<config><servers xmlns=\"urn:example:valperf\">" > $candidate
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<server><name>srv$i</name><addr>10.0.$((i/256)).$((i%256))</addr><port>$((i%60000))</port><enabled>true</enabled><limits><conns>$((i+1))</conns></limits></server>" >> $candidate
+done
+echo -n "</servers><clients xmlns=\"urn:example:valperf\">" >> $candidate
+for (( i=0; i<$perfnr; i++ )); do
+    echo -n "<client><name>cli$i</name><server>srv$((i%perfnr))</server></client>" >> $candidate
+done
+echo "</clients></config>" >> $candidate
+
+new "validate $perflaps laps with timing and per-check-category breakdown"
+expectpart "$($clixon_util_validate -f $cfg -d candidate -n $perflaps -t -p -s)" 0 "validate lap 0" "leafref" "must" "minmax/unique" "maxrss" "OK"
+
+new "validate with incremental option (full pass: no diff flags set)"
+expectpart "$($clixon_util_validate -f $cfg -d candidate -o CLICON_VALIDATE_INCREMENTAL=true)" 0 "OK"
+
+new "introduce duplicate unique tuple, expect validation failure"
+sed -i "s|<addr>10.0.0.1</addr><port>1</port>|<addr>10.0.0.0</addr><port>0</port>|" $candidate
+ret=$($clixon_util_validate -f $cfg -d candidate 2>&1)
+if [ $? -eq 0 ]; then
+    err "validation failure" "$ret"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
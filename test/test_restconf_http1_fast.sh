@@ -0,0 +1,164 @@
+#!/usr/bin/env bash
+# Test of the HTTP/1 fast-path parser (http1_parse_fast): well-formed
+# requests are parsed in a single allocation-free pass, anything the fast
+# path cannot prove byte-identical to the flex/yacc grammar (many headers,
+# whitespace runs in header values, unusual encodings) falls back to the
+# grammar with the buffer untouched. Verify both paths give identical
+# responses for the same resource, and that fallback requests still work.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# The fast path sits in the native HTTP/1 parser
+if [ "${WITH_RESTCONF}" = "fcgi" ]; then
+    echo "...skipped: Must run with --with-restconf=native"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+if ! ${HAVE_HTTP1}; then
+    echo "...skipped: Must run with http/1"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+# Force HTTP/1.1 regardless of nghttp2 support
+CURLOPTS="-Ssik --http1.1"
+# Without -i for byte-comparing replies (the Date header changes per second)
+CURLOPTS2="-Ssk --http1.1"
+HVER=1.1
+
+cfg=$dir/conf.xml
+fyang=$dir/h1fast.yang
+
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_RESTCONF_DIR>/usr/local/lib/$APPNAME/restconf</CLICON_RESTCONF_DIR>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>init</CLICON_STARTUP_MODE>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module h1fast {
+    yang-version 1.1;
+    namespace "urn:example:h1fast";
+    prefix hf;
+    container table {
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf PUT config (fast path, body byte-exact)"
+expectpart "$(curl $CURLOPTS -X PUT -H 'Content-Type: application/yang-data+json' -d '{"h1fast:table":{"parameter":[{"name":"a","value":"x y z"},{"name":"b","value":"42"}]}}' $RCPROTO://localhost/restconf/data/h1fast:table)" 0 "HTTP/$HVER 201"
+
+new "restconf GET reference reply (fast path)"
+expectpart "$(curl $CURLOPTS -X GET -H 'Accept: application/yang-data+json' $RCPROTO://localhost/restconf/data/h1fast:table)" 0 "HTTP/$HVER 200"
+ref=$(curl $CURLOPTS2 -X GET -H 'Accept: application/yang-data+json' $RCPROTO://localhost/restconf/data/h1fast:table)
+expectpart "$ref" 0 '{"h1fast:table":{"parameter":\[{"name":"a","value":"x y z"},{"name":"b","value":"42"}\]}}'
+
+new "trailing slash stripped on fast path, identical reply"
+ret=$(curl $CURLOPTS2 -X GET -H 'Accept: application/yang-data+json' $RCPROTO://localhost/restconf/data/h1fast:table/)
+if [ "$ret" != "$ref" ]; then
+    err "$ref" "$ret"
+fi
+
+new "header value with whitespace run forces grammar fallback, identical reply"
+ret=$(curl $CURLOPTS2 -X GET -H 'Accept: application/yang-data+json' -H 'X-Pad: a  b' $RCPROTO://localhost/restconf/data/h1fast:table)
+if [ "$ret" != "$ref" ]; then
+    err "$ref" "$ret"
+fi
+
+new "more than 64 headers forces grammar fallback, identical reply"
+hdrs=()
+for (( i=0; i<70; i++ )); do
+    hdrs+=(-H "X-Pad$i: v$i")
+done
+ret=$(curl $CURLOPTS2 -X GET -H 'Accept: application/yang-data+json' "${hdrs[@]}" $RCPROTO://localhost/restconf/data/h1fast:table)
+if [ "$ret" != "$ref" ]; then
+    err "$ref" "$ret"
+fi
+
+new "percent-encoded list key on fast path"
+expectpart "$(curl $CURLOPTS -X GET -H 'Accept: application/yang-data+json' $RCPROTO://localhost/restconf/data/h1fast:table/parameter=a/value)" 0 "HTTP/$HVER 200" '{"h1fast:value":"x y z"}'
+
+new "query parameters on fast path"
+expectpart "$(curl $CURLOPTS -X GET -H 'Accept: application/yang-data+json' "$RCPROTO://localhost/restconf/data/h1fast:table?content=config")" 0 "HTTP/$HVER 200" '"name":"a"'
+
+new "not found identical on fast path and fallback"
+ref=$(curl $CURLOPTS2 -X GET -H 'Accept: application/yang-data+json' $RCPROTO://localhost/restconf/data/h1fast:nosuch)
+ret=$(curl $CURLOPTS2 -X GET -H 'Accept: application/yang-data+json' -H 'X-Pad: a  b' $RCPROTO://localhost/restconf/data/h1fast:nosuch)
+expectpart "$ref" 0 "ietf-restconf:errors"
+if [ "$ret" != "$ref" ]; then
+    err "$ref" "$ret"
+fi
+
+new "bad percent-encoding is rejected (grammar fallback path)"
+expectpart "$(curl $CURLOPTS -X GET --path-as-is "$RCPROTO://localhost/restconf/data/h1fast:table/parameter=%zz")" 0 "HTTP/$HVER 400"
+
+if [ $RC -ne 0 ]; then
+    new "Kill restconf daemon"
+    stop_restconf
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
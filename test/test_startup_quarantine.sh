@@ -0,0 +1,112 @@
+#!/usr/bin/env bash
+# Test of CLICON_STARTUP_QUARANTINE: when the startup db fails validation as
+# a whole, each top-level subtree is re-validated on its own; failing
+# subtrees are moved to a 'broken' datastore and the rest is committed to
+# running, so one bad subtree does not force failsafe mode.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/quar.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>startup</CLICON_STARTUP_MODE>
+  <CLICON_STARTUP_QUARANTINE>true</CLICON_STARTUP_QUARANTINE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module quar {
+    yang-version 1.1;
+    namespace "urn:example:quar";
+    prefix qr;
+    container table {
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Startup db: one valid subtree, one subtree with no matching YANG module
+cat <<EOF > $dir/startup_db
+<config>
+   <table xmlns="urn:example:quar">
+      <parameter>
+         <name>a</name>
+         <value>42</value>
+      </parameter>
+   </table>
+   <nosuch xmlns="urn:example:nosuch">
+      <x>1</x>
+   </nosuch>
+</config>
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg (boots despite invalid subtree)"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "get-config of running: valid subtree committed, invalid one absent"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:quar\"><parameter><name>a</name><value>42</value></parameter></table></data></rpc-reply>"
+
+new "broken db holds the quarantined subtree"
+if ! grep -q "nosuch" $dir/broken_db; then
+    err "nosuch subtree in broken_db" "$(ls $dir)"
+fi
+
+new "broken db does not hold the valid subtree"
+if grep -q "urn:example:quar" $dir/broken_db; then
+    err "only invalid subtree in broken_db" "valid subtree present"
+fi
+
+new "backend is operational: edit and commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:quar\"><parameter><name>b</name><value>43</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config after commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:quar\"><parameter><name>a</name><value>42</value></parameter><parameter><name>b</name><value>43</value></parameter></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
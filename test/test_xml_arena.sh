@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# Test: XML arena allocation mode (clixon_util_xml -a)
+# Parse with node structs carved from an xml_arena and verify the resulting
+# tree behaves exactly like a malloc-allocated one: same output, same errors.
+# The tree is xml_free:d before the arena is released, see xml_arena_free
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+new "xml arena parse simple"
+expecteof "$clixon_util_xml -a -o" 0 "<a><b/></a>" "^<a><b/></a>$"
+
+new "xml arena parse attributes and bodies"
+expecteof "$clixon_util_xml -a -o" 0 '<x a="1"><y>foo</y><z/></x>' '^<x a="1"><y>foo</y><z/></x>$'
+
+new "xml arena parse error exits nonzero"
+expecteof "$clixon_util_xml -a -o" 255 "<a><b></a>" ""
+
+# Large document spanning several arena slabs
+f=$dir/big.xml
+echo -n "<c>" > $f
+for (( i=0; i<5000; i++ )); do
+    echo -n "<e><k>$i</k><v>value$i</v></e>" >> $f
+done
+echo -n "</c>" >> $f
+
+new "xml arena large doc matches malloc parse"
+r0=$($clixon_util_xml -o -f $f)
+r1=$($clixon_util_xml -a -o -f $f)
+if [ "$r0" != "$r1" ]; then
+    err "$r0" "$r1"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
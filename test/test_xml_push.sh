@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Test: incremental push XML parse (clixon_util_xml -c <sz>)
+# Feed documents to the push parser in small chunks so that tags, attributes,
+# comments and CDATA sections are split across feed calls, and verify the
+# resulting tree is identical to the one-shot DOM parse.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+f=$dir/doc.xml
+cat <<'EOF' > $f
+<r a="1 > 0" b='quoted "<" lt'><!-- comment with <tags> inside --><x><y>foo</y><y>bar &amp; baz</y></x><data><![CDATA[raw < > & stuff]]></data><?pi with < inside ?><z/></r>
+EOF
+
+new "push parse reference DOM output"
+ref=$($clixon_util_xml -o -f $f)
+if [ -z "$ref" ]; then
+    err "DOM output" "$ref"
+fi
+
+# Chunk sizes chosen so element/end tags, quotes, "-->" and "]]>" delimiters
+# are split across feed boundaries
+for c in 1 2 3 7 64 100000; do
+    new "push parse chunk size $c matches DOM"
+    ret=$($clixon_util_xml -c $c -o -f $f)
+    if [ "$ret" != "$ref" ]; then
+        err "$ref" "$ret"
+    fi
+done
+
+new "push parse unbalanced doc exits nonzero"
+expecteof "$clixon_util_xml -c 3 -o" 255 "<a><b></a>" ""
+
+# Large document: many top-level-complete elements over many feeds
+f=$dir/big.xml
+echo -n "<c>" > $f
+for (( i=0; i<1000; i++ )); do
+    echo -n "<e><k>$i</k></e>" >> $f
+done
+echo -n "</c>" >> $f
+
+new "push parse large doc chunk size 13 matches DOM"
+ref=$($clixon_util_xml -o -f $f)
+ret=$($clixon_util_xml -c 13 -o -f $f)
+if [ "$ret" != "$ref" ]; then
+    err "$ref" "$ret"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
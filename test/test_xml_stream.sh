@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+# Test: streaming (SAX-like) XML parse mode (clixon_util_xml -s)
+# The streaming parser delivers one event per element as its end tag is
+# seen, pruning the element for bounded memory. Compare the event stream
+# against the DOM parse of the same documents: post-order event sequence
+# on small documents, element counts on a large one.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+LF='
+'
+
+new "stream events simple, end-tag (post-) order"
+ret=$(echo "<a><b/></a>" | $clixon_util_xml -s)
+if [ "$ret" != "2 b${LF}1 a" ]; then
+    err "2 b; 1 a" "$ret"
+fi
+
+new "stream events siblings and nesting"
+ret=$(echo "<r><x><y>foo</y></x><z/></r>" | $clixon_util_xml -s)
+if [ "$ret" != "3 y${LF}2 x${LF}2 z${LF}1 r" ]; then
+    err "3 y; 2 x; 2 z; 1 r" "$ret"
+fi
+
+new "stream parse error exits nonzero"
+expecteof "$clixon_util_xml -s" 255 "<a><b></a>" ""
+
+# Large document: stream events must agree with the DOM parse
+f=$dir/big.xml
+echo -n "<c>" > $f
+for (( i=0; i<2000; i++ )); do
+    echo -n "<e><k>$i</k></e>" >> $f
+done
+echo -n "</c>" >> $f
+
+new "stream event count matches DOM element count"
+ndom=$($clixon_util_xml -o -f $f | grep -o "<e>" | wc -l)
+nstream=$($clixon_util_xml -s -f $f | grep -c "^2 e$")
+if [ "$ndom" != "$nstream" ]; then
+    err "$ndom" "$nstream"
+fi
+
+new "stream leaf events"
+nstream=$($clixon_util_xml -s -f $f | grep -c "^3 k$")
+if [ "$nstream" != "2000" ]; then
+    err "2000" "$nstream"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,127 @@
+#!/usr/bin/env bash
+# Test of CLICON_XMLDB_JOURNAL: datastore edits are appended to a <db>_journal
+# file and the snapshot rewrite is deferred. Verify that journaled state
+# survives a simulated crash (kill -9): after restart the journal is replayed
+# on top of the snapshot, which on disk does not yet contain the last edits.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/journal.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>init</CLICON_STARTUP_MODE>
+  <CLICON_XMLDB_JOURNAL>true</CLICON_XMLDB_JOURNAL>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module journal {
+    yang-version 1.1;
+    namespace "urn:example:journal";
+    prefix jn;
+    container table {
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# This test requires a real backend to kill and restart
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with real backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "netconf edit-config (journaled)"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:journal\"><parameter><name>a</name><value>journalvalue42</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "candidate journal file exists and holds the edit"
+if ! grep -q "journalvalue42" $dir/candidate_db_journal; then
+    err "journalvalue42 in candidate_db_journal" "$(ls $dir)"
+fi
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running snapshot not rewritten, edit only in the journal"
+if grep -q "journalvalue42" $dir/running_db; then
+    err "journalvalue42 absent from running_db snapshot" "present"
+fi
+if ! grep -q "journalvalue42" $dir/running_db_journal; then
+    err "journalvalue42 in running_db_journal" "$(ls $dir)"
+fi
+
+new "simulated crash: kill -9 backend"
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend pid" ""
+fi
+sudo kill -9 $pid
+sudo rm -f $dir/$APPNAME.pidfile
+
+new "restart backend -s running (journal replay)"
+start_backend -s running -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "get-config of running after crash sees the journaled commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:journal\"><parameter><name>a</name><value>journalvalue42</value></parameter></table></data></rpc-reply>"
+
+new "second edit and commit after replay"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:journal\"><parameter><name>b</name><value>43</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "simulated crash again"
+pid=$(pgrep -u root -f clixon_backend)
+sudo kill -9 $pid
+sudo rm -f $dir/$APPNAME.pidfile
+
+new "restart backend -s running"
+start_backend -s running -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "both commits present after second replay"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:journal\"><parameter><name>a</name><value>journalvalue42</value></parameter><parameter><name>b</name><value>43</value></parameter></table></data></rpc-reply>"
+
+new "Kill backend"
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,117 @@
+#!/usr/bin/env bash
+# Test of commit delta journal records (CLICON_XMLDB_JOURNAL): commit
+# persists the computed diff as journal records against the previous running
+# snapshot, one merge record for added/changed nodes and one remove record
+# for deleted nodes, instead of rewriting the snapshot. Verify change and
+# delete deltas replay correctly, in order, across a simulated crash.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/jdelta.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_STARTUP_MODE>init</CLICON_STARTUP_MODE>
+  <CLICON_XMLDB_JOURNAL>true</CLICON_XMLDB_JOURNAL>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module jdelta {
+    yang-version 1.1;
+    namespace "urn:example:jdelta";
+    prefix jd;
+    container table {
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# This test requires a real backend to kill and restart
+if [ $BE -eq 0 ]; then
+    echo "...skipped: must run with real backend"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+new "test params: -f $cfg"
+
+new "kill old backend"
+sudo clixon_backend -zf $cfg
+if [ $? -ne 0 ]; then
+    err
+fi
+new "start backend -s init -f $cfg"
+start_backend -s init -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "commit 1: create three entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:jdelta\"><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>2</value></parameter><parameter><name>c</name><value>3</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit 2: change one leaf, delete one entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:jdelta\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><parameter><name>b</name><value>22</value></parameter><parameter nc:operation=\"delete\"><name>c</name></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running journal carries the deltas, snapshot does not"
+if ! grep -q "remove" $dir/running_db_journal; then
+    err "remove record in running_db_journal" "$(cat $dir/running_db_journal)"
+fi
+if grep -q "22" $dir/running_db; then
+    err "changed value only in journal, not in running_db snapshot" "present"
+fi
+
+new "get-config reflects change and delete"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:jdelta\"><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>22</value></parameter></table></data></rpc-reply>"
+
+new "simulated crash: kill -9 backend"
+pid=$(pgrep -u root -f clixon_backend)
+if [ -z "$pid" ]; then
+    err "backend pid" ""
+fi
+sudo kill -9 $pid
+sudo rm -f $dir/$APPNAME.pidfile
+
+new "restart backend -s running (replay both commit deltas)"
+start_backend -s running -f $cfg
+
+new "wait backend"
+wait_backend
+
+new "replayed config matches: entry deleted, leaf changed, rest intact"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:jdelta\"><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>22</value></parameter></table></data></rpc-reply>"
+
+new "commit 3 after replay: re-create the deleted entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:jdelta\"><parameter><name>c</name><value>33</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "get-config after re-create"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:jdelta\"><parameter><name>a</name><value>1</value></parameter><parameter><name>b</name><value>22</value></parameter><parameter><name>c</name><value>33</value></parameter></table></data></rpc-reply>"
+
+new "Kill backend"
+stop_backend -f $cfg
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -50,7 +50,9 @@
 #include <time.h>
 #include <signal.h>
 #include <syslog.h>
+#include <inttypes.h>
 #include <sys/time.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/param.h>
 #include <sys/types.h>
@@ -66,7 +68,7 @@
 #include <clixon/clixon.h>
 
 /* Command line options to be passed to getopt(3) */
-#define DATASTORE_OPTS "hDd:b:f:x:y:Y:"
+#define DATASTORE_OPTS "hDd:b:f:x:y:Y:C:"
 
 /*! usage
  */
@@ -83,11 +85,13 @@ usage(char *argv0)
             "\t-x <xml>\tXML file. Alternative to put <xml> argument\n"
             "\t-y <file>\tYang file. Mandatory\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
+            "\t-C <cache>\tDatastore cache: nocache, cache (default), cache-zerocopy\n"
             "and command is either:\n"
             "\tget [<xpath>]\n"
             "\tmget <nr> [<xpath>]\n"
             "\tput (merge|replace|create|delete|remove) [<xml>]\n"
             "\tcopy <todb>\n"
+            "\tbench <nr> <iter> [<leaflen>]\n"
             "\tlock <pid>\n"
             "\tunlock\n"
             "\tunlock_all <pid>\n"
@@ -101,6 +105,107 @@ usage(char *argv0)
     exit(0);
 }
 
+/*! Generate a synthetic config tree of parameterized shape for benchmarking
+ *
+ * The shape follows the "scaling" module used by the test/test_perf_* scripts:
+ *   module scaling{
+ *     namespace "urn:example:clixon"; prefix sc;
+ *     container x{ list y{ key a; leaf a{ type int32; } leaf b{ type string; }}}
+ *   }
+ * which must be the yang given with -y.
+ * @param[in]  yspec    Yang spec
+ * @param[in]  nr       Number of list entries
+ * @param[in]  leaflen  Length of the non-key leaf value
+ * @param[out] xtp      Generated tree named "config", free with xml_free
+ * @retval     0        OK
+ * @retval    -1        Error, eg yang does not match the generated shape
+ */
+static int
+bench_generate(yang_stmt *yspec,
+               int        nr,
+               int        leaflen,
+               cxobj    **xtp)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    char  *val = NULL;
+    cxobj *xt = NULL;
+    cxobj *xerr = NULL;
+    int    i;
+    int    ret;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if ((val = malloc(leaflen+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(val, 'v', leaflen);
+    val[leaflen] = '\0';
+    cprintf(cb, "<x xmlns=\"urn:example:clixon\">");
+    for (i = 0; i < nr; i++)
+        cprintf(cb, "<y><a>%d</a><b>%s</b></y>", i, val);
+    cprintf(cb, "</x>");
+    if ((ret = clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xt, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        xml_print(stderr, xerr);
+        goto done;
+    }
+    if (xml_name_set(xt, NETCONF_INPUT_CONFIG) < 0)
+        goto done;
+    *xtp = xt;
+    xt = NULL;
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (xerr)
+        xml_free(xerr);
+    if (val)
+        free(val);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! qsort compare of two uint64 latencies
+ */
+static int
+bench_lat_cmp(const void *a,
+              const void *b)
+{
+    uint64_t la = *(const uint64_t*)a;
+    uint64_t lb = *(const uint64_t*)b;
+
+    return la < lb ? -1 : la > lb ? 1 : 0;
+}
+
+/*! Sort latency samples and print throughput and percentiles for one benchmark
+ * @param[in]     name  Benchmark name
+ * @param[in,out] lat   Latency samples in us, sorted on return
+ * @param[in]     n     Number of samples
+ */
+static void
+bench_report(const char *name,
+             uint64_t   *lat,
+             int         n)
+{
+    uint64_t sum = 0;
+    int      i;
+
+    qsort(lat, n, sizeof(*lat), bench_lat_cmp);
+    for (i = 0; i < n; i++)
+        sum += lat[i];
+    fprintf(stdout, "%-6s %6d ops %10.1f ops/s lat-us p50:%" PRIu64
+            " p90:%" PRIu64 " p99:%" PRIu64 " max:%" PRIu64 "\n",
+            name, n,
+            sum ? n/(sum/1000000.0) : 0.0,
+            lat[n/2], lat[(n*9)/10], lat[(n*99)/100], lat[n-1]);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -176,6 +281,11 @@ main(int argc, char **argv)
             if (clicon_option_add(h, "CLICON_YANG_DIR", optarg) < 0)
                 goto done;
             break;
+        case 'C': /* datastore cache behaviour */
+            if (!optarg)
+                usage(argv0);
+            clicon_option_str_set(h, "CLICON_DATASTORE_CACHE", optarg);
+            break;
         }
     /* 
      * Logs, error and debug to stderr, set debug level
@@ -297,6 +407,96 @@ main(int argc, char **argv)
         if (xmldb_copy(h, db, argv[1]) < 0)
             goto done;
     }
+    else if (strcmp(cmd, "bench")==0){
+        int           nr;
+        int           iter;
+        int           leaflen = 16;
+        cxobj        *xb = NULL;
+        cxobj        *xput = NULL;
+        uint64_t     *lat = NULL;
+        uint64_t      nrnodes = 0;
+        size_t        sz = 0;
+        struct timeval t0;
+        struct timeval t1;
+        struct timeval td;
+        struct rusage ru;
+
+        if (argc != 3 && argc != 4)
+            usage(argv0);
+        nr = atoi(argv[1]);
+        iter = atoi(argv[2]);
+        if (argc == 4)
+            leaflen = atoi(argv[3]);
+        if (nr < 1 || iter < 1 || leaflen < 1)
+            usage(argv0);
+        if (bench_generate(yspec, nr, leaflen, &xb) < 0)
+            goto done;
+        if (xml_stats(xb, &nrnodes, &sz) < 0)
+            goto done;
+        fprintf(stdout, "bench: %d entries, leaflen %d: %" PRIu64 " nodes, %zu bytes in-memory\n",
+                nr, leaflen, nrnodes, sz);
+        if ((lat = calloc(iter, sizeof(*lat))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((cbret = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        /* Replace whole config each lap. The dup is outside the timer since
+         * xmldb_put strips operation attributes from its input tree
+         */
+        for (i = 0; i < iter; i++){
+            if ((xput = xml_dup(xb)) == NULL)
+                goto done;
+            gettimeofday(&t0, NULL);
+            ret = xmldb_put(h, db, OP_REPLACE, xput, NULL, cbret);
+            gettimeofday(&t1, NULL);
+            if (ret < 0)
+                goto done;
+            if (ret == 0){
+                fprintf(stderr, "%s\n", cbuf_get(cbret));
+                goto done;
+            }
+            timersub(&t1, &t0, &td);
+            lat[i] = td.tv_sec*1000000 + td.tv_usec;
+            xml_free(xput);
+            xput = NULL;
+            cbuf_reset(cbret);
+        }
+        bench_report("put", lat, iter);
+        /* Full-config reads, cold on first lap when the cache is off */
+        for (i = 0; i < iter; i++){
+            gettimeofday(&t0, NULL);
+            ret = xmldb_get(h, db, NULL, "/", &xt);
+            gettimeofday(&t1, NULL);
+            if (ret < 0)
+                goto done;
+            timersub(&t1, &t0, &td);
+            lat[i] = td.tv_sec*1000000 + td.tv_usec;
+            xml_free(xt);
+            xt = NULL;
+        }
+        bench_report("get", lat, iter);
+        /* Datastore-to-datastore copy, cache and file */
+        for (i = 0; i < iter; i++){
+            gettimeofday(&t0, NULL);
+            ret = xmldb_copy(h, db, "tmp");
+            gettimeofday(&t1, NULL);
+            if (ret < 0)
+                goto done;
+            timersub(&t1, &t0, &td);
+            lat[i] = td.tv_sec*1000000 + td.tv_usec;
+        }
+        bench_report("copy", lat, iter);
+        if (getrusage(RUSAGE_SELF, &ru) < 0){
+            clicon_err(OE_UNIX, errno, "getrusage");
+            goto done;
+        }
+        fprintf(stdout, "maxrss: %ld kB\n", ru.ru_maxrss);
+        free(lat);
+        xml_free(xb);
+    }
     else if (strcmp(cmd, "lock")==0){
         if (argc != 2)
             usage(argv0);
@@ -0,0 +1,246 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Stress harness for the open-addressing hash table (clixon_hash.c).
+  * Runs add/delete/re-add cycles against a flat shadow model and verifies
+  * every key's presence and value after each phase, driving the table
+  * through rehashes and tombstone creation/reuse.
+  * On success, nothing is printed and exitcode 0.
+  * On failure, an error is printed on stderr and exitcode != 0.
+  */
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+/* Command line options passed to getopt(3) */
+#define UTIL_HASH_OPTS "hD:n:r:"
+
+/* Shadow model: val[i] >= 0 means key i is present with that value */
+static int *_model = NULL;
+static int  _nkeys = 0;
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level> \tDebug\n"
+            "\t-n <nr> \tNumber of distinct keys (default 1000)\n"
+            "\t-r <nr> \tNumber of add/del/re-add rounds (default 10)\n",
+            argv0);
+    exit(0);
+}
+
+static void
+mkkey(int   i,
+      char *buf,
+      size_t len)
+{
+    snprintf(buf, len, "key-%d-pad-to-spread-hash", i);
+}
+
+/*! Check every key in the model against the table
+ * @retval  0  OK
+ * @retval -1  Mismatch, printed on stderr
+ */
+static int
+check_all(clicon_hash_t *hash)
+{
+    char    key[64];
+    int     i;
+    int    *val;
+    size_t  vlen;
+
+    for (i = 0; i < _nkeys; i++){
+        mkkey(i, key, sizeof(key));
+        val = (int*)clicon_hash_value(hash, key, &vlen);
+        if (_model[i] < 0){
+            if (val != NULL){
+                fprintf(stderr, "key %s: expected absent, found %d\n", key, *val);
+                return -1;
+            }
+        }
+        else {
+            if (val == NULL){
+                fprintf(stderr, "key %s: expected %d, not found\n", key, _model[i]);
+                return -1;
+            }
+            if (vlen != sizeof(int) || *val != _model[i]){
+                fprintf(stderr, "key %s: expected %d, found %d\n", key, _model[i], *val);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int            retval = -1;
+    clicon_hash_t *hash = NULL;
+    char           key[64];
+    int            c;
+    int            nkeys = 1000;
+    int            rounds = 10;
+    int            dbg = 0;
+    int            r;
+    int            i;
+    int            v;
+
+    clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR);
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, UTIL_HASH_OPTS)) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv[0]);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv[0]);
+            break;
+        case 'n':
+            if (sscanf(optarg, "%d", &nkeys) != 1 || nkeys < 1)
+                usage(argv[0]);
+            break;
+        case 'r':
+            if (sscanf(optarg, "%d", &rounds) != 1 || rounds < 1)
+                usage(argv[0]);
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_debug_init(dbg, NULL);
+    _nkeys = nkeys;
+    if ((_model = malloc(nkeys * sizeof(int))) == NULL){
+        perror("malloc");
+        goto done;
+    }
+    for (i = 0; i < nkeys; i++)
+        _model[i] = -1;
+    if ((hash = clicon_hash_init()) == NULL)
+        goto done;
+    srandom(4711); /* deterministic */
+    /* Phase 1: grow through several rehashes */
+    for (i = 0; i < nkeys; i++){
+        mkkey(i, key, sizeof(key));
+        v = i;
+        if (clicon_hash_add(hash, key, &v, sizeof(v)) == NULL)
+            goto done;
+        _model[i] = v;
+    }
+    if (check_all(hash) < 0)
+        goto done;
+    /* Phase 2: rounds of random delete (tombstones), re-add (tombstone
+     * reuse), and overwrite, checking the whole model each round. Deleting
+     * half the keys keeps load high enough that adds keep triggering
+     * rehashes over live entries and tombstones.
+     */
+    for (r = 0; r < rounds; r++){
+        for (i = 0; i < nkeys/2; i++){
+            int k = random() % nkeys;
+
+            mkkey(k, key, sizeof(key));
+            if (_model[k] >= 0){
+                if (clicon_hash_del(hash, key) < 0){
+                    fprintf(stderr, "del %s: unexpected failure\n", key);
+                    goto done;
+                }
+                _model[k] = -1;
+            }
+            else {
+                v = r*nkeys + k;
+                if (clicon_hash_add(hash, key, &v, sizeof(v)) == NULL)
+                    goto done;
+                _model[k] = v;
+            }
+        }
+        if (check_all(hash) < 0)
+            goto done;
+    }
+    /* Phase 3: delete everything, re-add everything (maximal tombstone
+     * reuse), check, and verify a deleted key stays deleted
+     */
+    for (i = 0; i < nkeys; i++){
+        if (_model[i] < 0)
+            continue;
+        mkkey(i, key, sizeof(key));
+        if (clicon_hash_del(hash, key) < 0){
+            fprintf(stderr, "del %s: unexpected failure\n", key);
+            goto done;
+        }
+        _model[i] = -1;
+    }
+    if (check_all(hash) < 0)
+        goto done;
+    for (i = 0; i < nkeys; i++){
+        mkkey(i, key, sizeof(key));
+        v = 2*nkeys + i;
+        if (clicon_hash_add(hash, key, &v, sizeof(v)) == NULL)
+            goto done;
+        _model[i] = v;
+    }
+    mkkey(0, key, sizeof(key));
+    if (clicon_hash_del(hash, key) < 0){
+        fprintf(stderr, "del %s: unexpected failure\n", key);
+        goto done;
+    }
+    _model[0] = -1;
+    if (check_all(hash) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (hash)
+        clicon_hash_free(hash);
+    if (_model)
+        free(_model);
+    return retval;
+}
@@ -0,0 +1,356 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Benchmark for NACM data node access decisions.
+  * Generates a NACM config with parameterized numbers of groups, rule-lists
+  * and rules, and a data tree of parameterized size, then runs read or write
+  * decision workloads and reports decisions/second and memory growth, so that
+  * regressions in the rule matching path show up as numbers rather than in
+  * production profiles.
+  * Example:
+  *   clixon_util_nacm_bench -n 100 -e 1000 -g 200 -r 200
+  *   clixon_util_nacm_bench -n 100 -e 1000 -w -d deny -a permit
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <syslog.h>
+#include <signal.h>
+#include <time.h>
+#include <malloc.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+/* Yang module bound to the generated data tree */
+static const char *bench_yang =
+    "module nacm-bench {\n"
+    "   namespace \"urn:example:nacm-bench\";\n"
+    "   prefix nb;\n"
+    "   container table {\n"
+    "      list entry {\n"
+    "         key name;\n"
+    "         leaf name { type string; }\n"
+    "         leaf value { type string; }\n"
+    "      }\n"
+    "   }\n"
+    "}\n";
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level> \tDebug\n"
+            "\t-n <nr> \tNumber of laps (default 100)\n"
+            "\t-e <nr> \tNumber of list entries in the data tree (default 1000)\n"
+            "\t-g <nr> \tNumber of groups, user is member of all (default 10)\n"
+            "\t-r <nr> \tNumber of rule-lists with one rule each (default 10)\n"
+            "\t-a <action> \tRule action: permit or deny (default permit)\n"
+            "\t-d <action> \tread/write-default: permit or deny (default deny)\n"
+            "\t-w \t\tWrite workload (default read)\n"
+            "\t-c \t\tClear decision/group caches between laps (cold path)\n"
+            ,
+            argv0);
+    exit(0);
+}
+
+/*! Monotonic clock as seconds
+ */
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+/*! xml_apply callback counting element nodes
+ */
+static int
+bench_count_node(cxobj *x,
+                 void  *arg)
+{
+    (*(uint64_t*)arg)++;
+    return 0;
+}
+
+/*! Heap bytes currently in use, 0 if not available
+ */
+static size_t
+bench_heap_inuse(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+
+    return mi.uordblks;
+#else
+    return 0;
+#endif
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int            retval = -1;
+    int            c;
+    int            dbg = 0;
+    int            laps = 100;
+    int            entries = 1000;
+    int            groups = 10;
+    int            rules = 10;
+    int            writemode = 0;
+    int            cold = 0;
+    char          *action = "permit";
+    char          *defaction = "deny";
+    clicon_handle  h = NULL;
+    yang_stmt     *yspec = NULL;
+    cbuf          *cb = NULL;
+    cbuf          *cbret = NULL;
+    cxobj         *xdata = NULL;  /* generated data tree */
+    cxobj         *xntop = NULL;  /* parse top holding xnacm */
+    cxobj         *xnacm = NULL;
+    cxobj         *xdup = NULL;
+    cxobj         *xerr = NULL;
+    char           yangfile[] = "/tmp/nacm_bench_yang_XXXXXX";
+    int            fd = -1;
+    FILE          *f = NULL;
+    int            i;
+    int            lap;
+    int            ret;
+    uint64_t       nodes = 0;
+    double         t0;
+    double         t1;
+    size_t         heap0;
+    size_t         heap1;
+    struct rusage  ru = {{0,},};
+
+    clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR);
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, "hD:n:e:g:r:a:d:wc")) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv[0]);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv[0]);
+            break;
+        case 'n':
+            if ((laps = atoi(optarg)) < 1)
+                usage(argv[0]);
+            break;
+        case 'e':
+            if ((entries = atoi(optarg)) < 1)
+                usage(argv[0]);
+            break;
+        case 'g':
+            if ((groups = atoi(optarg)) < 1)
+                usage(argv[0]);
+            break;
+        case 'r':
+            if ((rules = atoi(optarg)) < 1)
+                usage(argv[0]);
+            break;
+        case 'a':
+            action = optarg;
+            break;
+        case 'd':
+            defaction = optarg;
+            break;
+        case 'w':
+            writemode = 1;
+            break;
+        case 'c':
+            cold = 1;
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_debug_init(dbg, NULL);
+    yang_init(h);
+    if (strcmp(action, "permit") != 0 && strcmp(action, "deny") != 0)
+        usage(argv[0]);
+    if (strcmp(defaction, "permit") != 0 && strcmp(defaction, "deny") != 0)
+        usage(argv[0]);
+    /* Write the benchmark yang module to a temp file and load it fully */
+    if ((fd = mkstemp(yangfile)) < 0){
+        clicon_err(OE_UNIX, errno, "mkstemp");
+        goto done;
+    }
+    if ((f = fdopen(fd, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fdopen");
+        goto done;
+    }
+    if (fputs(bench_yang, f) < 0){
+        clicon_err(OE_UNIX, errno, "fputs");
+        goto done;
+    }
+    fclose(f);
+    f = NULL;
+    fd = -1;
+    if ((yspec = yspec_new()) == NULL)
+        goto done;
+    clicon_dbspec_yang_set(h, yspec);
+    if (yang_spec_parse_file(h, yangfile, yspec) < 0)
+        goto done;
+    /* Generate the data tree */
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<table xmlns=\"urn:example:nacm-bench\">");
+    for (i=0; i<entries; i++)
+        cprintf(cb, "<entry><name>e%d</name><value>v%d</value></entry>", i, i);
+    cprintf(cb, "</table>");
+    if ((ret = clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xdata, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_XML, 0, "Generated data tree failed yang binding");
+        goto done;
+    }
+    /* Generate the NACM config: user "bench" member of all groups, each
+     * rule-list bound to one group with one wildcard-module rule
+     */
+    cbuf_reset(cb);
+    cprintf(cb, "<nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\">");
+    cprintf(cb, "<enable-nacm>true</enable-nacm>");
+    cprintf(cb, "<read-default>%s</read-default>", defaction);
+    cprintf(cb, "<write-default>%s</write-default>", defaction);
+    cprintf(cb, "<exec-default>permit</exec-default>");
+    cprintf(cb, "<groups>");
+    for (i=0; i<groups; i++)
+        cprintf(cb, "<group><name>g%d</name><user-name>bench</user-name></group>", i);
+    cprintf(cb, "</groups>");
+    for (i=0; i<rules; i++){
+        cprintf(cb, "<rule-list><name>rl%d</name><group>g%d</group>", i, i%groups);
+        cprintf(cb, "<rule><name>r%d</name><module-name>*</module-name>"
+                "<access-operations>*</access-operations><action>%s</action></rule>",
+                i, action);
+        cprintf(cb, "</rule-list>");
+    }
+    cprintf(cb, "</nacm>");
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xntop, NULL) < 0)
+        goto done;
+    if ((xnacm = xpath_first(xntop, NULL, "nacm")) == NULL){
+        clicon_err(OE_XML, 0, "No nacm node in generated config");
+        goto done;
+    }
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* One decision per element node per lap */
+    if (xml_apply(xdata, CX_ELMNT, bench_count_node, &nodes) < 0)
+        goto done;
+    heap0 = bench_heap_inuse();
+    t0 = bench_now();
+    for (lap = 0; lap < laps; lap++){
+        if (cold)
+            nacm_decision_cache_invalidate();
+        /* Each lap works on a fresh copy, as request handling does */
+        if ((xdup = xml_dup(xdata)) == NULL)
+            goto done;
+        if (writemode){
+            cbuf_reset(cbret);
+            if (nacm_datanode_write(h, xdup, xdup, NACM_UPDATE, "bench",
+                                    xnacm, cbret) < 0)
+                goto done;
+        }
+        else if (nacm_datanode_read(h, xdup, NULL, 0, "bench", xnacm) < 0)
+            goto done;
+        xml_free(xdup);
+        xdup = NULL;
+    }
+    t1 = bench_now();
+    heap1 = bench_heap_inuse();
+    fprintf(stdout, "workload:   %s %s-rules %s-default%s\n",
+            writemode ? "write" : "read", action, defaction,
+            cold ? " cold" : "");
+    fprintf(stdout, "laps:       %d nodes/lap: %" PRIu64 "\n", laps, nodes);
+    fprintf(stdout, "time:       %.3f s\n", t1 - t0);
+    fprintf(stdout, "decisions/s: %.0f\n", (double)(nodes*laps)/(t1 - t0));
+    if (heap1 || heap0)
+        fprintf(stdout, "heap growth: %zd bytes (%.1f/decision)\n",
+                (ssize_t)(heap1 - heap0),
+                (double)((ssize_t)(heap1 - heap0))/(double)(nodes*laps));
+    getrusage(RUSAGE_SELF, &ru);
+    fprintf(stdout, "maxrss:     %ld kB\n", ru.ru_maxrss);
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    else if (fd != -1)
+        close(fd);
+    unlink(yangfile);
+    if (xdup)
+        xml_free(xdup);
+    if (xdata)
+        xml_free(xdata);
+    if (xntop)
+        xml_free(xntop);
+    if (xerr)
+        xml_free(xerr);
+    if (cbret)
+        cbuf_free(cbret);
+    if (cb)
+        cbuf_free(cb);
+    if (yspec)
+        ys_free(yspec);
+    return retval;
+}
@@ -0,0 +1,337 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC (Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Benchmark for the clicon_msg IPC transport: framing, copy and parse.
+  * Two modes:
+  * - Loopback (default): fork a child echoing clicon_msg frames over a
+  *   socketpair, measuring the encode/frame/read stack in isolation
+  * - Backend (-s <sockpath>): send clixon-lib <ping> rpc:s to a running
+  *   backend, measuring the full request/reply path
+  * Reports msgs/s, MB/s, p50/p99 round-trip latency and the time split
+  * between message encode, transport (send+receive) and reply parse (-P).
+  * Example:
+  *   clixon_util_proto_bench -n 10000 -b 1024 -p 8 -P
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <syslog.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level> \tDebug\n"
+            "\t-s <sockpath> \tBackend unix socket (default: loopback echo child)\n"
+            "\t-a <family>\tSocket address family with -s (default UNIX)\n"
+            "\t-n <nr> \tNumber of messages (default 1000)\n"
+            "\t-b <bytes> \tPayload padding, loopback mode only (default 0)\n"
+            "\t-p <depth> \tPipeline depth: outstanding requests (default 1)\n"
+            "\t-P \t\tParse replies as XML (adds parse to the measured path)\n"
+            ,
+            argv0);
+    exit(0);
+}
+
+/*! Monotonic clock as seconds
+ */
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+/*! qsort comparator for latency samples
+ */
+static int
+bench_dcmp(const void *a,
+           const void *b)
+{
+    double d = *(const double*)a - *(const double*)b;
+
+    return d < 0.0 ? -1 : d > 0.0 ? 1 : 0;
+}
+
+/*! Child loop of loopback mode: echo clicon_msg frames until eof
+ */
+static int
+bench_echo_child(int s)
+{
+    struct clicon_msg *msg = NULL;
+    int                eof = 0;
+
+    while (1){
+        if (clicon_msg_rcv(s, &msg, &eof) < 0)
+            return -1;
+        if (eof)
+            break;
+        if (clicon_msg_send(s, msg) < 0)
+            return -1;
+        free(msg);
+        msg = NULL;
+    }
+    if (msg)
+        free(msg);
+    return 0;
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int                retval = -1;
+    int                c;
+    int                dbg = 0;
+    char              *sockpath = NULL;
+    char              *family = "UNIX";
+    int                nr = 1000;
+    int                padding = 0;
+    int                depth = 1;
+    int                parse = 0;
+    clicon_handle      h = NULL;
+    cbuf              *cb = NULL;
+    struct clicon_msg *msg = NULL;
+    struct clicon_msg *reply = NULL;
+    cxobj             *xt = NULL;
+    double            *lat = NULL;
+    double            *sendt = NULL;
+    int                s = -1;
+    int                sp[2] = {-1, -1};
+    int                pid = 0;
+    int                eof = 0;
+    int                sent;
+    int                rcvd;
+    int                i;
+    double             t0, t1, t2, tdone;
+    double             t_encode = 0.0;
+    double             t_transport = 0.0;
+    double             t_parse = 0.0;
+    double             mbytes;
+    size_t             msglen;
+
+    clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR);
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, "hD:s:a:n:b:p:P")) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv[0]);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv[0]);
+            break;
+        case 's':
+            sockpath = optarg;
+            break;
+        case 'a':
+            family = optarg;
+            break;
+        case 'n':
+            if (sscanf(optarg, "%d", &nr) != 1 || nr < 1)
+                usage(argv[0]);
+            break;
+        case 'b':
+            if (sscanf(optarg, "%d", &padding) != 1 || padding < 0)
+                usage(argv[0]);
+            break;
+        case 'p':
+            if (sscanf(optarg, "%d", &depth) != 1 || depth < 1)
+                usage(argv[0]);
+            break;
+        case 'P':
+            parse++;
+            break;
+        default:
+            usage(argv[0]);
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+    if (depth > nr)
+        depth = nr;
+    /* Build the message once: same payload is sent nr times */
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (sockpath){
+        /* A real rpc the backend answers cheaply */
+        cprintf(cb, "<rpc xmlns=\"%s\" %s><ping xmlns=\"%s\"/></rpc>",
+                NETCONF_BASE_NAMESPACE, NETCONF_MESSAGE_ID_ATTR, CLIXON_LIB_NS);
+        if (padding)
+            fprintf(stderr, "Note: -b ignored in backend mode\n");
+    }
+    else{
+        cprintf(cb, "<rpc xmlns=\"%s\" %s><bench>",
+                NETCONF_BASE_NAMESPACE, NETCONF_MESSAGE_ID_ATTR);
+        for (i=0; i<padding; i++)
+            cprintf(cb, "%c", 'a' + i%26);
+        cprintf(cb, "</bench></rpc>");
+    }
+    t0 = bench_now();
+    if ((msg = clicon_msg_encode(getpid(), "%s", cbuf_get(cb))) == NULL)
+        goto done;
+    t_encode += bench_now() - t0;
+    msglen = ntohl(msg->op_len) & ~CLICON_MSG_FLAG_FDPASS;
+    /* Set up the peer */
+    if (sockpath){
+        if (strcmp(family, "UNIX") == 0){
+            if (clicon_rpc_connect_unix(h, sockpath, &s) < 0)
+                goto done;
+        }
+        else
+            if (clicon_rpc_connect_inet(h, sockpath, 4535, &s) < 0)
+                goto done;
+    }
+    else{
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sp) < 0){
+            clicon_err(OE_UNIX, errno, "socketpair");
+            goto done;
+        }
+        if ((pid = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pid == 0){ /* child: echo */
+            close(sp[0]);
+            bench_echo_child(sp[1]);
+            _exit(0);
+        }
+        close(sp[1]);
+        sp[1] = -1;
+        s = sp[0];
+    }
+    if ((lat = calloc(nr, sizeof(double))) == NULL ||
+        (sendt = calloc(nr, sizeof(double))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Sliding window: keep up to <depth> requests outstanding. Replies come
+     * back in send order on this transport, so latency i matches reply i.
+     */
+    sent = 0;
+    rcvd = 0;
+    t0 = bench_now();
+    while (rcvd < nr){
+        while (sent < nr && sent - rcvd < depth){
+            sendt[sent] = bench_now();
+            if (clicon_msg_send(s, msg) < 0)
+                goto done;
+            sent++;
+        }
+        t1 = bench_now();
+        if (clicon_msg_rcv(s, &reply, &eof) < 0)
+            goto done;
+        if (eof){
+            clicon_err(OE_PROTO, 0, "Unexpected eof after %d replies", rcvd);
+            goto done;
+        }
+        t2 = bench_now();
+        t_transport += t2 - t1;
+        lat[rcvd] = t2 - sendt[rcvd];
+        if (parse){
+            if (clixon_xml_parse_string(reply->op_body, YB_NONE, NULL, &xt, NULL) < 0)
+                goto done;
+            xml_free(xt);
+            xt = NULL;
+            t_parse += bench_now() - t2;
+        }
+        free(reply);
+        reply = NULL;
+        rcvd++;
+    }
+    tdone = bench_now() - t0;
+    /* Report */
+    qsort(lat, nr, sizeof(double), bench_dcmp);
+    mbytes = 2.0*nr*msglen/(1024.0*1024.0); /* sent + received */
+    fprintf(stdout, "mode:       %s\n", sockpath?"backend":"loopback");
+    fprintf(stdout, "messages:   %d x %zu bytes, pipeline %d%s\n",
+            nr, msglen, depth, parse?", parsed":"");
+    fprintf(stdout, "elapsed:    %.3f s\n", tdone);
+    fprintf(stdout, "throughput: %.0f msgs/s, %.2f MB/s\n", nr/tdone, mbytes/tdone);
+    fprintf(stdout, "latency:    p50 %.1f us, p99 %.1f us\n",
+            lat[nr/2]*1e6, lat[(int)(nr*0.99)]*1e6);
+    fprintf(stdout, "time split: encode %.1f%%, transport %.1f%%, parse %.1f%%\n",
+            100.0*t_encode/tdone, 100.0*t_transport/tdone, 100.0*t_parse/tdone);
+    retval = 0;
+ done:
+    if (s >= 0)
+        close(s);
+    if (pid > 0)
+        waitpid(pid, NULL, 0);
+    if (lat)
+        free(lat);
+    if (sendt)
+        free(sendt);
+    if (xt)
+        xml_free(xt);
+    if (reply)
+        free(reply);
+    if (msg)
+        free(msg);
+    if (cb)
+        cbuf_free(cb);
+    if (h)
+        clicon_handle_exit(h);
+    return retval;
+}
@@ -38,6 +38,10 @@
   * Example:
   * 1) validate foo_db using a tmp dbdir
   * ./clixon_util_validate -f /usr/local/etc/example.xml -d foo -o  CLICON_XMLDB_DIR=/tmp
+  * Also a validation benchmark harness: -n repeats the validation with per-lap
+  * wallclock time, -p prints a per-check-category time breakdown (when, must,
+  * leafref, etc) and -s memory statistics. Generated configs with controllable
+  * constraint counts are driven from test/test_perf_validate.sh
  */
 
 #ifdef HAVE_CONFIG_H
@@ -51,11 +55,13 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <sys/time.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -67,7 +73,7 @@
 #include "clixon/clixon_backend.h"
 
 /* Command line options passed to getopt(3) */
-#define UTIL_COMMIT_OPTS "hD:f:cd:o:"
+#define UTIL_COMMIT_OPTS "hD:f:cd:o:n:tps"
 
 static int
 usage(char *argv0)
@@ -79,7 +85,11 @@ usage(char *argv0)
             "\t-f <file>\tClixon config file\n"
             "\t-d <file>\tDatabase name (if not candidate, must be in XMLDBDIR)\n"
             "\t-c \t\tValidate + commit, otherwise only validate\n"
-            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n",
+            "\t-o \"<option>=<value>\"\tGive configuration option overriding config file (see clixon-config.yang)\n"
+            "\t-n <nr>\t\tBenchmark: repeat the validation <nr> times\n"
+            "\t-t \t\tBenchmark: print wallclock time per validation lap\n"
+            "\t-p \t\tBenchmark: print per-check-category validation time breakdown\n"
+            "\t-s \t\tBenchmark: print memory statistics\n",
             argv0);
     exit(0);
 }
@@ -99,6 +109,15 @@ main(int    argc,
     char         *str;
     int           ret;
     cbuf         *cb = NULL;
+    int           laps = 1;
+    int           lap;
+    int           timing = 0;
+    int           profile = 0;
+    int           stats = 0;
+    struct timeval tv0;
+    struct timeval tv1;
+    struct rusage ru = {{0,},};
+    uint64_t      nr;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -128,6 +147,10 @@ main(int    argc,
         case 'c': /* commit (otherwise only validate) */
         case 'd': /* candidate database (if not candidate) */
         case 'o': /* Configuration option */
+        case 'n': /* benchmark laps */
+        case 't': /* lap timing */
+        case 'p': /* per-check-category breakdown */
+        case 's': /* memory statistics */
             break; /* see next getopt */
         default:
             usage(argv[0]);
@@ -165,6 +188,19 @@ main(int    argc,
                 goto done;
             break;
         }
+        case 'n': /* benchmark laps */
+            if (sscanf(optarg, "%d", &laps) != 1 || laps < 1)
+                usage(argv[0]);
+            break;
+        case 't': /* lap timing */
+            timing++;
+            break;
+        case 'p': /* per-check-category breakdown */
+            profile++;
+            break;
+        case 's': /* memory statistics */
+            stats++;
+            break;
         default:
             usage(argv[0]);
             break;
@@ -226,17 +262,42 @@ main(int    argc,
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    if (commit){
-        if ((ret = candidate_commit(h, NULL, database, cb)) < 0)
-            goto done;
-    }
-    else{
-        if ((ret = candidate_validate(h, database, cb)) < 0)
+    if (profile)
+        xml_validate_profile(1);
+    for (lap = 0; lap < laps; lap++){
+        gettimeofday(&tv0, NULL);
+        if (commit){
+            if ((ret = candidate_commit(h, NULL, database, cb)) < 0)
+                goto done;
+        }
+        else{
+            if ((ret = candidate_validate(h, database, cb)) < 0)
+                goto done;
+        }
+        gettimeofday(&tv1, NULL);
+        if (ret == 0){
+            clicon_err(OE_DB, 0, " Failed: %s", cbuf_get(cb));
             goto done;
+        }
+        if (timing || laps > 1){
+            timersub(&tv1, &tv0, &tv1);
+            fprintf(stdout, "%s lap %d: %ld.%06ld s\n",
+                    commit ? "commit" : "validate",
+                    lap, (long)tv1.tv_sec, (long)tv1.tv_usec);
+        }
+        cbuf_reset(cb);
     }
-    if (ret == 0){
-        clicon_err(OE_DB, 0, " Failed: %s", cbuf_get(cb));
-        goto done;
+    if (profile)
+        xml_validate_profile_report(stdout);
+    if (stats){
+        nr = 0;
+        xml_stats_global(&nr);
+        fprintf(stdout, "%-14s %10" PRIu64 "\n", "xml objects", nr);
+        nr = 0;
+        yang_stats_global(&nr);
+        fprintf(stdout, "%-14s %10" PRIu64 "\n", "yang objects", nr);
+        getrusage(RUSAGE_SELF, &ru);
+        fprintf(stdout, "%-14s %10ld kB\n", "maxrss", ru.ru_maxrss);
     }
     fprintf(stdout, "OK\n");
     retval = 0;
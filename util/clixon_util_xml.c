@@ -67,7 +67,7 @@
 #include "clixon/clixon.h"
 
 /* Command line options passed to getopt(3) */
-#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:u"
+#define UTIL_XML_OPTS "hD:f:JjXl:pvoy:Y:t:T:uasc:"
 
 static int
 validate_tree(clicon_handle h,
@@ -108,6 +108,26 @@ validate_tree(clicon_handle h,
     return retval;
 }
 
+/*! Streaming parse callback: print one event line per completed element
+ *
+ * Events arrive in end-tag order; ancestors are still in place so the depth
+ * can be computed, pruned children are already gone. Returning 1 prunes the
+ * element so tree memory stays bounded, see clixon_xml_stream_cb
+ */
+static int
+stream_print_cb(cxobj *x,
+                void  *arg)
+{
+    FILE  *f = (FILE *)arg;
+    cxobj *xp;
+    int    depth = 0;
+
+    for (xp = xml_parent(x); xp; xp = xml_parent(xp))
+        depth++;
+    fprintf(f, "%d %s\n", depth, xml_name(x));
+    return 1;
+}
+
 static int
 usage(char *argv0)
 {
@@ -128,6 +148,9 @@ usage(char *argv0)
             "\t-t <file>\tXML top input file (where base tree is pasted to)\n"
             "\t-T <path>\tXPath to where in top input file base should be pasted\n"
             "\t-u \t\tTreat unknown XML as anydata\n"
+            "\t-a \t\tAllocate parsed nodes from an XML arena (see xml_arena_create)\n"
+            "\t-s \t\tStreaming parse: print \"<depth> <name>\" per element end, prune\n"
+            "\t-c <sz>\t\tIncremental push parse fed <sz> bytes at a time (see clixon_xml_push_new)\n"
             ,
             argv0);
     exit(0);
@@ -163,9 +186,16 @@ main(int    argc,
     cxobj        *xtop = NULL; /* Top tree if any */
     char         *top_path = NULL;
     cxobj        *xbot;        /* Place in xtop where base cxobj is parsed */
-    cvec         *nsc = NULL; 
+    cvec         *nsc = NULL;
     yang_bind     yb;
     int           dbg = 0;
+    int           arena = 0;
+    xml_arena    *xa = NULL;
+    int           stream = 0;
+    int           chunksz = 0;
+    clixon_xml_push *xp = NULL;
+    char         *fbuf = NULL;
+    size_t        n;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR); 
@@ -232,6 +262,16 @@ main(int    argc,
                 goto done;
             xml_bind_yang_unknown_anydata(1);
             break;
+        case 'a':
+            arena++;
+            break;
+        case 's':
+            stream++;
+            break;
+        case 'c':
+            if (sscanf(optarg, "%d", &chunksz) != 1 || chunksz < 1)
+                usage(argv[0]);
+            break;
         default:
             usage(argv[0]);
             break;
@@ -244,6 +284,14 @@ main(int    argc,
         fprintf(stderr, "-t requires -T\n");
         usage(argv[0]);
     }
+    if (stream && (jsonin || validate || top_input_filename)){
+        fprintf(stderr, "-s is XML-only, no validation or top file\n");
+        usage(argv[0]);
+    }
+    if (chunksz && (jsonin || validate || top_input_filename || stream)){
+        fprintf(stderr, "-c is XML-only, no validation, top file or -s\n");
+        usage(argv[0]);
+    }
     clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, logdst);
     clicon_debug_init(dbg, NULL);
     yang_init(h);
@@ -300,8 +348,45 @@ main(int    argc,
             goto done;
         }
     }
+    /* Node structs of the parsed tree are carved from an arena slab allocator,
+     * names/values are still heap-allocated, see xml_arena_create */
+    if (arena){
+        if ((xa = xml_arena_create(0)) == NULL)
+            goto done;
+        xml_arena_begin(xa);
+    }
+    /* Streaming parse: one event line per element, pruned as delivered */
+    if (stream){
+        if (clixon_xml_parse_file_stream(fp, stream_print_cb, stdout, &xt) < 0){
+            fprintf(stderr, "xml parse error: %s\n", clicon_err_reason);
+            goto done;
+        }
+        retval = 0;
+        goto done;
+    }
     /* 2. Parse data (xml/json) */
-    if (jsonin){
+    if (chunksz){ /* Incremental push parse, fed chunksz bytes at a time */
+        if ((xp = clixon_xml_push_new(NULL, NULL)) == NULL)
+            goto done;
+        if ((fbuf = malloc(chunksz)) == NULL){
+            clicon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        while ((n = fread(fbuf, 1, chunksz, fp)) > 0)
+            if (clixon_xml_push_feed(xp, fbuf, n) < 0){
+                fprintf(stderr, "xml parse error: %s\n", clicon_err_reason);
+                goto done;
+            }
+        if (ferror(fp)){
+            clicon_err(OE_XML, errno, "fread");
+            goto done;
+        }
+        if (clixon_xml_push_done(xp, &xt) < 0){
+            fprintf(stderr, "xml parse error: %s\n", clicon_err_reason);
+            goto done;
+        }
+    }
+    else if (jsonin){
         if ((ret = clixon_json_parse_file(fp, 1, top_input_filename?YB_PARENT:YB_MODULE, yspec, &xt, &xerr)) < 0)
             goto done;
         if (ret == 0){
@@ -325,6 +410,8 @@ main(int    argc,
             goto done;
         }
     }
+    if (arena)
+        xml_arena_end();
 
     /* 3. Validate data (if yspec) */
     if (validate){
@@ -364,6 +451,14 @@ main(int    argc,
         xml_free(xtop);
     else if (xt)
         xml_free(xt);
+    if (xa){ /* After xml_free of all trees with arena nodes */
+        xml_arena_end();
+        xml_arena_free(xa);
+    }
+    if (xp)
+        clixon_xml_push_free(xp);
+    if (fbuf)
+        free(fbuf);
     if (cb)
         cbuf_free(cb);
     return retval;
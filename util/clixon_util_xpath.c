@@ -48,9 +48,11 @@ See https://www.w3.org/TR/xpath/
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/stat.h>
 
 /* cligen */
@@ -60,7 +62,7 @@ See https://www.w3.org/TR/xpath/
 #include "clixon/clixon.h"
 
 /* Command line options to be passed to getopt(3) */
-#define XPATH_OPTS "hD:f:p:i:In:cl:y:Y:"
+#define XPATH_OPTS "hD:f:p:i:In:cl:y:Y:B:N:"
 
 static int
 usage(char *argv0)
@@ -78,6 +80,8 @@ usage(char *argv0)
             "\t-l <s|e|o|f<file>> \tLog on (s)yslog, std(e)rr, std(o)ut or (f)ile (stderr is default)\n"
             "\t-y <filename> \tYang filename or dir (load all files)\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
+            "\t-B <file> \tBenchmark: file of XPATH expressions, one per line, # is comment\n"
+            "\t-N <nr> \tBenchmark: evaluations per expression (default 1000)\n"
             "and the following extra rules:\n"
             "\tif -f is not given, XML input is expected on stdin\n"
             "\tif -p is not given, <xpath> is expected as the first line on stdin\n"
@@ -118,6 +122,78 @@ ctx_print2(cbuf   *cb,
     return retval;
 }
 
+/*! Benchmark: evaluate a file of xpath expressions nr times each, report timing
+ *
+ * Reports per expression: ns/eval, resulting nodeset size (or context type),
+ * and list-optimizer hits over the run, see xpath_list_optimize_stats.
+ * Used to validate the xpath optimizer/cache work and catch eval regressions.
+ * @param[in]  x     XML context node to evaluate against
+ * @param[in]  nsc   XML namespace context, or NULL
+ * @param[in]  filename File with one xpath expression per line, # is comment
+ * @param[in]  nr    Number of evaluations per expression
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xpath_bench(cxobj      *x,
+            cvec       *nsc,
+            const char *filename,
+            int         nr)
+{
+    int             retval = -1;
+    FILE           *fe = NULL;
+    char           *line = NULL;
+    size_t          linesize = 0;
+    ssize_t         linelen;
+    xp_ctx         *xc = NULL;
+    struct timespec t0;
+    struct timespec t1;
+    uint64_t        ns;
+    int             hits;
+    int             nodes;
+    int             i;
+
+    if ((fe = fopen(filename, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    fprintf(stdout, "%-50s %12s %8s %8s\n", "xpath", "ns/eval", "nodes", "opt-hits");
+    while ((linelen = getline(&line, &linesize, fe)) > 0){
+        if (line[linelen-1] == '\n')
+            line[linelen-1] = '\0';
+        if (line[0] == '\0' || line[0] == '#')
+            continue;
+        xpath_list_optimize_stats(&hits); /* read and reset */
+        nodes = 0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (i = 0; i < nr; i++){
+            if (xpath_vec_ctx(x, nsc, line, 0, &xc) < 0)
+                goto done;
+            if (xc){
+                if (xc->xc_type == XT_NODESET)
+                    nodes = xc->xc_size;
+                ctx_free(xc);
+                xc = NULL;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        xpath_list_optimize_stats(&hits);
+        ns = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000000ULL +
+            (t1.tv_nsec - t0.tv_nsec);
+        fprintf(stdout, "%-50s %12" PRIu64 " %8d %8d\n",
+                line, ns/nr, nodes, hits);
+    }
+    retval = 0;
+ done:
+    if (xc)
+        ctx_free(xc);
+    if (line)
+        free(line);
+    if (fe)
+        fclose(fe);
+    return retval;
+}
+
 int
 main(int    argc,
      char **argv)
@@ -149,6 +225,8 @@ main(int    argc,
     int         logdst = CLICON_LOG_STDERR;
     int         dbg = 0;
     int         xpath_inverse = 0;
+    char       *benchfile = NULL;
+    int         benchnr = 1000;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init("xpath", LOG_DEBUG, logdst); 
@@ -222,6 +300,13 @@ main(int    argc,
         case 'y':
             yang_file_dir = optarg;
             break;
+        case 'B': /* Benchmark expression file */
+            benchfile = optarg;
+            break;
+        case 'N': /* Benchmark evaluations per expression */
+            if (sscanf(optarg, "%d", &benchnr) != 1 || benchnr < 1)
+                usage(argv0);
+            break;
         case 'Y':
             if (clicon_option_add(h, "CLICON_YANG_DIR", optarg) < 0)
                 goto done;
@@ -256,7 +341,7 @@ main(int    argc,
         }
     }
 
-    if (xpath==NULL){
+    if (xpath==NULL && benchfile==NULL){
         /* First read xpath */
         len = 1024; /* any number is fine */
         if ((buf = malloc(len)) == NULL){
@@ -367,6 +452,11 @@ main(int    argc,
     }
     else
         x = x0;
+    if (benchfile){
+        if (xpath_bench(x, nsc, benchfile, benchnr) < 0)
+            goto done;
+        goto ok;
+    }
 #if 0 // filter syntax errors
     {
         xpath_tree *xptree = NULL;
@@ -32,8 +32,14 @@
 
   ***** END LICENSE BLOCK *****
 
-  * Parse a SINGLE yang file - no dependencies - utility function only useful
+  * Yang parse and benchmark utility.
+  * Default: parse a SINGLE yang file on stdin - no dependencies - only useful
   * for basic syntactic checks.
+  * With -f <file> or -m <module> (and -y <dir>) a complete spec including
+  * imports is loaded, with optional load timing (-t), repeat laps (-n) for
+  * the compiled yang cache (-c), and per-module statement/memory stats (-s).
+  * Per-phase timings (parse/populate/resolve/expand/augment) are logged by
+  * yang_parse_post at debug level 1, ie -D 1.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -45,8 +51,11 @@
 #include <errno.h>
 #include <unistd.h>
 #include <limits.h>
+#include <inttypes.h>
 #include <ctype.h>
 #include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #include <arpa/inet.h>
 #include <regex.h>
 #include <dirent.h>
@@ -67,26 +76,78 @@
 static int
 usage(char *argv0)
 {
-    fprintf(stderr, "usage:%s [options] # input yang spec on stdin\n"
+    fprintf(stderr, "usage:%s [options] # input yang spec on stdin unless -f/-m\n"
             "where options are\n"
             "\t-h \t\tHelp\n"
-            "\t-D <level> \tDebug\n"
-            "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n",
+            "\t-D <level> \tDebug. Level 1 logs per-phase load timings\n"
+            "\t-l <s|e|o> \tLog on (s)yslog, std(e)rr, std(o)ut (stderr is default)\n"
+            "\t-f <file> \tLoad spec from yang file, including imports (see -y)\n"
+            "\t-m <module> \tLoad spec given module name, including imports (see -y)\n"
+            "\t-y <dir> \tYang import/include search dir (can be several)\n"
+            "\t-c <dir> \tCompiled yang cache dir (see CLICON_YANG_CACHE_DIR)\n"
+            "\t-n <nr> \tLoad the spec <nr> times, report time per lap\n"
+            "\t-t \t\tReport spec load time\n"
+            "\t-s \t\tReport per-module and total statement counts and bytes\n"
+            "\t-p \t\tPrint the loaded spec (default in stdin mode)\n",
             argv0);
     exit(0);
 }
 
+/*! Report per-module and total yang statement counts and in-memory bytes
+ * @param[in] yspec  Top-level yang spec
+ */
+static int
+yang_stats_report(yang_stmt *yspec)
+{
+    yang_stmt    *ym = NULL;
+    uint64_t      nr;
+    size_t        sz;
+    uint64_t      nrtot = 0;
+    size_t        sztot = 0;
+    struct rusage ru;
+
+    while ((ym = yn_each(yspec, ym)) != NULL){
+        nr = 0;
+        sz = 0;
+        if (yang_stats(ym, &nr, &sz) < 0)
+            return -1;
+        fprintf(stdout, "%-40s %8" PRIu64 " stmts %10zu bytes\n",
+                yang_argument_get(ym), nr, sz);
+        nrtot += nr;
+        sztot += sz;
+    }
+    fprintf(stdout, "%-40s %8" PRIu64 " stmts %10zu bytes\n",
+            "total", nrtot, sztot);
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        fprintf(stdout, "%-40s %19ld kB\n", "maxrss", ru.ru_maxrss);
+    return 0;
+}
+
 int
 main(int argc, char **argv)
 {
-    yang_stmt *yspec = NULL;
-    int        c;
-    int        logdst = CLICON_LOG_STDERR;
-    int        dbg = 0;
-    
+    yang_stmt     *yspec = NULL;
+    int            c;
+    int            logdst = CLICON_LOG_STDERR;
+    int            dbg = 0;
+    clicon_handle  h = NULL;
+    char          *filename = NULL;
+    char          *module = NULL;
+    int            laps = 1;
+    int            timing = 0;
+    int            stats = 0;
+    int            print = 0;
+    int            i;
+    int            retval = -1;
+    struct timeval t0;
+    struct timeval t1;
+    struct timeval td;
+
     optind = 1;
     opterr = 0;
-    while ((c = getopt(argc, argv, "hD:l:")) != -1)
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
+    while ((c = getopt(argc, argv, "hD:l:f:m:y:c:n:tsp")) != -1)
         switch (c) {
         case 'h':
             usage(argv[0]);
@@ -99,22 +160,86 @@ main(int argc, char **argv)
             if ((logdst = clicon_log_opt(optarg[0])) < 0)
                 usage(argv[0]);
             break;
+        case 'f':
+            filename = optarg;
+            break;
+        case 'm':
+            module = optarg;
+            break;
+        case 'y':
+            if (clicon_option_add(h, "CLICON_YANG_DIR", optarg) < 0)
+                goto done;
+            break;
+        case 'c':
+            if (yang_cache_dir_set(optarg) < 0)
+                goto done;
+            break;
+        case 'n':
+            if ((laps = atoi(optarg)) < 1)
+                usage(argv[0]);
+            break;
+        case 't':
+            timing = 1;
+            break;
+        case 's':
+            stats = 1;
+            break;
+        case 'p':
+            print = 1;
+            break;
         default:
             usage(argv[0]);
             break;
         }
     clicon_log_init("clixon_util_yang", dbg?LOG_DEBUG:LOG_INFO, logdst);
     clicon_debug_init(dbg, NULL);
-    if ((yspec = yspec_new()) == NULL)
-        goto done;
-    if (yang_parse_file(stdin, "yang test", yspec) == NULL){
-        fprintf(stderr, "yang parse error %s\n", clicon_err_reason);
-        return -1;
+    if (filename == NULL && module == NULL){
+        /* Single file on stdin, no dependencies, print unless suppressed */
+        if ((yspec = yspec_new()) == NULL)
+            goto done;
+        if (yang_parse_file(stdin, "yang test", yspec) == NULL){
+            fprintf(stderr, "yang parse error %s\n", clicon_err_reason);
+            goto done;
+        }
+        yang_print(stdout, yspec);
+    }
+    else {
+        /* Full spec load with imports. With -c, lap 2.. (or a re-run) reads
+         * the compiled yang cache instead of parsing
+         */
+        for (i = 0; i < laps; i++){
+            if (yspec){
+                ys_free(yspec);
+                yspec = NULL;
+            }
+            if ((yspec = yspec_new()) == NULL)
+                goto done;
+            gettimeofday(&t0, NULL);
+            if (filename){
+                if (yang_spec_parse_file(h, filename, yspec) < 0)
+                    goto done;
+            }
+            else if (yang_spec_parse_module(h, module, NULL, yspec) < 0)
+                goto done;
+            gettimeofday(&t1, NULL);
+            if (timing || laps > 1){
+                timersub(&t1, &t0, &td);
+                fprintf(stdout, "load lap %d: %ld.%06ld s\n",
+                        i, (long)td.tv_sec, (long)td.tv_usec);
+            }
+        }
+        if (stats &&
+            yang_stats_report(yspec) < 0)
+            goto done;
+        if (print)
+            yang_print(stdout, yspec);
     }
-    yang_print(stdout, yspec);
+    retval = 0;
  done:
     if (yspec)
         ys_free(yspec);
-     return 0;
+    if (h)
+        clicon_handle_exit(h);
+    return retval;
 }
 